@@ -49,7 +49,8 @@
 
 //  If the user requested making the entire C++ standard library available
 //  via module import (incl. via -pure-cpp2) or header include, do that
-#if defined(CPP2_IMPORT_STD) || defined(CPP2_INCLUDE_STD)
+//  (unless cppfront #includes just the headers used, see below)
+#if (defined(CPP2_IMPORT_STD) || defined(CPP2_INCLUDE_STD)) && !defined(CPP2_INCLUDE_USED_STD)
 
     //  If C++23 'import std;' was requested but isn't available, fall back
     //  to the 'include std' path
@@ -241,6 +242,11 @@
         #include <vector>
     #endif
 
+//  If cppfront found all the std:: names the file uses, it #includes just
+//  their headers after this one when 'import std;' isn't available
+#elif defined(CPP2_IMPORT_STD) && defined(__cpp_lib_modules)
+    import std.compat;
+
 //  Otherwise, just #include the facilities used in this header
 #else
     #ifdef _MSC_VER
@@ -253,6 +259,7 @@
     #include <cstddef>
     #include <cstdint>
     #include <cstdio>
+    #include <cstring>
     #ifndef CPP2_NO_EXCEPTIONS
         #include <exception>
     #endif
@@ -270,6 +277,7 @@
     #include <new>
     #include <random>
     #include <optional>
+    #include <shared_mutex>
     #if defined(CPP2_USE_SOURCE_LOCATION)
         #include <source_location>
     #endif
@@ -285,6 +293,14 @@
     #include <utility>
     #include <variant>
     #include <vector>
+    #ifdef CPP2_SAMPLE_ALLOCATIONS
+        #include <atomic>
+        #include <cmath>
+        #include <cstdlib>
+        #include <iomanip>
+        #include <mutex>
+        #include <unordered_map>
+    #endif
 #endif
 
 
@@ -317,6 +333,18 @@
     #define CPP2_CONSTEXPR constexpr
 #endif
 
+// For cppfront -mark-purity: a const function's result depends only on its
+// argument values, a pure function's may also depend on memory it reads, and
+// neither has other effects or throws. The nothrow matters: GCC won't reuse
+// one call's result for another across translation units without it
+#if defined(__GNUC__) || defined(__clang__)
+    #define CPP2_CONST_FUNCTION [[gnu::const, gnu::nothrow]]
+    #define CPP2_PURE_FUNCTION  [[gnu::pure, gnu::nothrow]]
+#else
+    #define CPP2_CONST_FUNCTION
+    #define CPP2_PURE_FUNCTION
+#endif
+
 
 namespace cpp2 {
 
@@ -525,18 +553,105 @@ auto pointer_eq(T const* a, T const* b) {
 //-----------------------------------------------------------------------
 //
 
-#ifdef CPP2_USE_SOURCE_LOCATION
+//  A source site is a check site that cppfront gave a compile-time ID
+//  with -source-sites, and listed in a per-TU table (see source_site_at).
+//  An ID is only unique within its file, so a check also passes its file's
+//  impl::file_sites type, which makes each file's instantiations distinct
+//
+using site_id = std::uint32_t;
+
+struct source_site
+{
+    site_id             id        = 0;
+    char const*         file      = "";
+    std::uint_least32_t line_no   = 0;
+    std::uint_least32_t column_no = 0;
+    char const*         function  = "";
+
+    //  The same interface as std::source_location
+    constexpr auto file_name    () const noexcept -> char const*         { return file; }
+    constexpr auto function_name() const noexcept -> char const*         { return function; }
+    constexpr auto line         () const noexcept -> std::uint_least32_t { return line_no; }
+    constexpr auto column       () const noexcept -> std::uint_least32_t { return column_no; }
+};
+
+//  The check helpers that can take a site ID (assert_not_null and
+//  assert_in_bounds) use CPP2_SOURCE_SITE_PARAM/ARG instead, so that with
+//  -source-sites the only things a check passes are its Site and File
+//  template arguments
+//
+#if defined(CPP2_USE_SOURCE_SITES)
+    #define CPP2_SOURCE_LOCATION_PARAM              , cpp2::source_site const& where
+    #define CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT , cpp2::source_site const& where = {}
+    #define CPP2_SOURCE_LOCATION_PARAM_SOLO         cpp2::source_site const& where
+    #define CPP2_SOURCE_LOCATION_ARG                , where
+    #define CPP2_SOURCE_SITE_PARAM
+    #define CPP2_SOURCE_SITE_ARG                    , cpp2::impl::source_site_at<File>(Site)
+#elif defined(CPP2_USE_SOURCE_LOCATION)
     #define CPP2_SOURCE_LOCATION_PARAM              , std::source_location where
     #define CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT , std::source_location where = std::source_location::current()
     #define CPP2_SOURCE_LOCATION_PARAM_SOLO         std::source_location where
     #define CPP2_SOURCE_LOCATION_ARG                , where
+    #define CPP2_SOURCE_SITE_PARAM                  CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT
+    #define CPP2_SOURCE_SITE_ARG                    CPP2_SOURCE_LOCATION_ARG
 #else
     #define CPP2_SOURCE_LOCATION_PARAM
     #define CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT
     #define CPP2_SOURCE_LOCATION_PARAM_SOLO
     #define CPP2_SOURCE_LOCATION_ARG
+    #define CPP2_SOURCE_SITE_PARAM
+    #define CPP2_SOURCE_SITE_ARG
+#endif
+
+//  For functions only called on a violation path
+#if defined(_MSC_VER) && !defined(__clang__)
+    #define CPP2_COLD __declspec(noinline)
+#else
+    #define CPP2_COLD __attribute__((noinline, cold))
+#endif
+
+namespace impl {
+
+//  The type of the file's own site table that a -source-sites check passes
+//  as its File template argument. Naming the table through the template
+//  argument (not directly) keeps the shared templates the same in every
+//  file, and a File in an unnamed namespace keeps each file's
+//  instantiations apart, so a check never reports another file's site
+#ifdef CPP2_USE_SOURCE_SITES
+namespace {
+
+struct file_sites {
+    //  Defined at the end of each Cpp1 file that cppfront emits with
+    //  -source-sites, as that file's table of sites sorted by ID
+    static auto table() -> std::span<source_site const>;
+};
+
+}
 #endif
 
+template<typename File>
+CPP2_COLD auto source_site_at(site_id id) -> source_site const&
+{
+    static constexpr auto unknown = source_site{};
+    if constexpr (std::is_void_v<File>) {
+        return unknown;
+    }
+    else {
+        auto table = File::table();
+        auto site  = std::ranges::lower_bound(table, id, {}, &source_site::id);
+        if (
+            site != table.end()
+            && site->id == id
+            )
+        {
+            return *site;
+        }
+        return unknown;
+    }
+}
+
+}
+
 //  For C++23: make this std::string_view and drop the macro
 //      Before C++23 std::string_view was not guaranteed to be trivially copyable,
 //      and so in<T> will pass it by const& and really it should be by value
@@ -563,13 +678,16 @@ private:
 };
 
 [[noreturn]] inline auto report_and_terminate(std::string_view group, CPP2_MESSAGE_PARAM msg = "" CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT) noexcept -> void {
-    std::cerr
-#ifdef CPP2_USE_SOURCE_LOCATION
-        << where.file_name() << "("
-        << where.line() << ") "
-        << where.function_name() << ": "
+#if defined(CPP2_USE_SOURCE_LOCATION) || defined(CPP2_USE_SOURCE_SITES)
+    //  Line 0 is a check that has no source site
+    if (where.line() != 0) {
+        std::cerr
+            << where.file_name() << "("
+            << where.line() << ") "
+            << where.function_name() << ": ";
+    }
 #endif
-        << group << " violation";
+    std::cerr << group << " violation";
     if (msg && msg[0] != '\0') {
         std::cerr << ": " << msg;
     }
@@ -635,35 +753,36 @@ concept Expected = std::is_same_v<T, std::expected<typename T::value_type, typen
 
 #endif
 
-auto assert_not_null(auto&& arg CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT) -> decltype(auto)
+template<site_id Site = 0, typename File = void>
+auto assert_not_null(auto&& arg CPP2_SOURCE_SITE_PARAM) -> decltype(auto)
 {
     //  NOTE: This "!= T{}" test may or may not work for STL iterators. The standard
     //        doesn't guarantee that using == and != will reliably report whether an
     //        STL iterator has the default-constructed value. So use it only for raw *...
     if constexpr (std::is_pointer_v<CPP2_TYPEOF(arg)>) {
         if (arg == CPP2_TYPEOF(arg){}) {
-            null_safety.report_violation("dynamic null dereference attempt detected" CPP2_SOURCE_LOCATION_ARG);
+            null_safety.report_violation("dynamic null dereference attempt detected" CPP2_SOURCE_SITE_ARG);
         };
     }
     else if constexpr (UniquePtr<CPP2_TYPEOF(arg)>) {
         if (!arg) {
-            null_safety.report_violation("std::unique_ptr is empty" CPP2_SOURCE_LOCATION_ARG);
+            null_safety.report_violation("std::unique_ptr is empty" CPP2_SOURCE_SITE_ARG);
         }
     }
     else if constexpr (SharedPtr<CPP2_TYPEOF(arg)>) {
         if (!arg) {
-            null_safety.report_violation("std::shared_ptr is empty" CPP2_SOURCE_LOCATION_ARG);
+            null_safety.report_violation("std::shared_ptr is empty" CPP2_SOURCE_SITE_ARG);
         }
     }
     else if constexpr (Optional<CPP2_TYPEOF(arg)>) {
         if (!arg.has_value()) {
-            null_safety.report_violation("std::optional does not contain a value" CPP2_SOURCE_LOCATION_ARG);
+            null_safety.report_violation("std::optional does not contain a value" CPP2_SOURCE_SITE_ARG);
         }
     }
 #ifdef __cpp_lib_expected
     else if constexpr (Expected<CPP2_TYPEOF(arg)>) {
         if (!arg.has_value()) {
-            null_safety.report_violation("std::expected has an unexpected value" CPP2_SOURCE_LOCATION_ARG);
+            null_safety.report_violation("std::expected has an unexpected value" CPP2_SOURCE_SITE_ARG);
         }
     }
 #endif
@@ -673,6 +792,21 @@ auto assert_not_null(auto&& arg CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT) -> decl
 
 //  Subscript bounds checking
 //
+//  The violation path, out of line so that each checked subscript (and each
+//  -source-sites instantiation) is only the comparison and a call
+template<typename Arg, typename Max>
+CPP2_COLD auto report_out_of_bounds(Arg arg, Max max CPP2_SOURCE_LOCATION_PARAM) -> void
+{
+    auto msg = "out of bounds access attempt detected - attempted access at index " + std::to_string(arg) + ", ";
+    if (max > 0 ) {
+        msg += "[min,max] range is [0," + std::to_string(max-1) + "]";
+    }
+    else {
+        msg += "but container is empty";
+    }
+    bounds_safety.report_violation(msg.c_str()  CPP2_SOURCE_LOCATION_ARG);
+}
+
 #define CPP2_ASSERT_IN_BOUNDS_IMPL \
     requires (std::is_integral_v<CPP2_TYPEOF(arg)> && \
              requires { std::size(x); std::ssize(x); x[arg]; std::begin(x) + 2; }) \
@@ -681,39 +815,36 @@ auto assert_not_null(auto&& arg CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT) -> decl
         if constexpr (std::is_signed_v<CPP2_TYPEOF(arg)>) { return std::ssize(x); } \
         else { return std::size(x); } \
     }; \
-    auto msg = "out of bounds access attempt detected - attempted access at index " + std::to_string(arg) + ", "; \
-    if (max() > 0 ) { \
-        msg += "[min,max] range is [0," + std::to_string(max()-1) + "]"; \
-    } \
-    else { \
-        msg += "but container is empty"; \
-    } \
     if (!(0 <= arg && arg < max())) { \
-        bounds_safety.report_violation(msg.c_str()  CPP2_SOURCE_LOCATION_ARG); \
+        report_out_of_bounds(arg, max()  CPP2_SOURCE_SITE_ARG); \
     } \
     return CPP2_FORWARD(x) [ arg ]; \
 }
 
-template<auto arg>
-auto assert_in_bounds(auto&& x CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT) -> decltype(auto)
+template<auto arg, site_id Site = 0, typename File = void>
+auto assert_in_bounds(auto&& x CPP2_SOURCE_SITE_PARAM) -> decltype(auto)
     CPP2_ASSERT_IN_BOUNDS_IMPL
 
-auto assert_in_bounds(auto&& x, auto&& arg CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT) -> decltype(auto)
+template<site_id Site = 0, typename File = void>
+auto assert_in_bounds(auto&& x, auto&& arg CPP2_SOURCE_SITE_PARAM) -> decltype(auto)
     CPP2_ASSERT_IN_BOUNDS_IMPL
 
-template<auto arg>
-auto assert_in_bounds(auto&& x CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT) -> decltype(auto)
+template<auto arg, site_id Site = 0, typename File = void>
+auto assert_in_bounds(auto&& x CPP2_SOURCE_SITE_PARAM) -> decltype(auto)
 {
     return CPP2_FORWARD(x) [ arg ];
 }
 
-auto assert_in_bounds(auto&& x, auto&& arg CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT) -> decltype(auto)
+template<site_id Site = 0, typename File = void>
+auto assert_in_bounds(auto&& x, auto&& arg CPP2_SOURCE_SITE_PARAM) -> decltype(auto)
 {
     return CPP2_FORWARD(x) [ CPP2_FORWARD(arg) ];
 }
 
-#define CPP2_ASSERT_IN_BOUNDS(x,arg)         (cpp2::impl::assert_in_bounds((x),(arg)))
-#define CPP2_ASSERT_IN_BOUNDS_LITERAL(x,arg) (cpp2::impl::assert_in_bounds<(arg)>(x))
+#define CPP2_ASSERT_IN_BOUNDS(x,arg)                 (cpp2::impl::assert_in_bounds((x),(arg)))
+#define CPP2_ASSERT_IN_BOUNDS_LITERAL(x,arg)         (cpp2::impl::assert_in_bounds<(arg)>(x))
+#define CPP2_ASSERT_IN_BOUNDS_AT(site,x,arg)         (cpp2::impl::assert_in_bounds<(site), cpp2::impl::file_sites>((x),(arg)))
+#define CPP2_ASSERT_IN_BOUNDS_LITERAL_AT(site,x,arg) (cpp2::impl::assert_in_bounds<(arg),(site), cpp2::impl::file_sites>(x))
 
 #ifdef CPP2_NO_RTTI
 // Compile-Time type name deduction for -fno-rtti builds
@@ -835,6 +966,253 @@ auto Typeid( [[maybe_unused]] auto&& x ) -> decltype(auto) {
 } // impl
 
 
+//-----------------------------------------------------------------------
+//
+//  Allocation sampling for unique.new and shared.new
+//
+//-----------------------------------------------------------------------
+//
+//  With CPP2_SAMPLE_ALLOCATIONS defined, unique.new and shared.new sample
+//  the bytes they allocate the way tcmalloc does: each thread counts down
+//  a random number of bytes drawn from an exponential distribution with
+//  mean interval(), so the samples are a Poisson process over the bytes
+//  allocated, and the allocation that takes the count below zero is
+//  sampled. A sample of n bytes stands for 1/p allocations, where p is the
+//  chance that an n-byte allocation is sampled, which makes the per-site
+//  estimates unbiased.
+//
+//  With -source-sites, each unique.new and shared.new call passes its site
+//  ID, so the samples are totaled per call site. A shared.new sample's
+//  deleter also tracks the live bytes; a unique.new sample's free can't be
+//  seen, because its std::unique_ptr uses std::default_delete.
+//
+//  Without CPP2_SAMPLE_ALLOCATIONS, nothing here is compiled.
+//
+#ifdef CPP2_SAMPLE_ALLOCATIONS
+
+namespace impl {
+
+//  The bytes left before this thread's next sample. It starts at 0, so a
+//  thread's first allocation takes the slow path to draw its first interval
+inline thread_local std::int64_t bytes_until_sample = 0;
+
+}
+
+class allocation_sampler
+{
+public:
+    struct site_stats {
+        source_site const* site        = {};    // null if the call has no site
+        std::int64_t       samples     = 0;
+        double             allocations = 0;     // estimated
+        double             bytes       = 0;     // estimated
+        bool               tracks_live = false; // for shared.new
+        double             live_bytes  = 0;     // estimated, if tracks_live
+    };
+
+    //  Never destroyed, so that a shared.new sample freed during static
+    //  destruction can still be released, and the exit report printed
+    static auto instance() -> allocation_sampler& {
+        static auto* sampler = new allocation_sampler;
+        return *sampler;
+    }
+
+    //  The mean number of bytes between samples, or 0 to stop sampling
+    auto set_interval(std::int64_t bytes) -> void { interval_.store(std::max(bytes, std::int64_t{0}), std::memory_order_relaxed); }
+    auto interval() const -> std::int64_t         { return interval_.load(std::memory_order_relaxed); }
+
+    //  Whether to print() to std::cerr at exit if there were any samples
+    auto set_print_at_exit(bool b) -> void        { print_at_exit.store(b, std::memory_order_relaxed); }
+
+    //  The statistics for each site, most estimated bytes first
+    auto stats() const
+        -> std::vector<site_stats>
+    {
+        auto ret = std::vector<site_stats>{};
+        {
+            auto lock = std::scoped_lock{ mutex };
+            for (auto const& [site, s] : sites) {
+                ret.push_back(s);
+            }
+        }
+        std::ranges::sort(ret, std::greater<>{}, &site_stats::bytes);
+        return ret;
+    }
+
+    auto print(std::ostream& o) const
+        -> void
+    {
+        o << "Sampled unique.new/shared.new allocations (mean interval " << interval() << " bytes):\n"
+          << "     est. bytes  est. allocations  est. live bytes   samples  site\n";
+        for (auto const& s : stats()) {
+            o << std::setw(15) << std::llround(s.bytes)
+              << std::setw(18) << std::llround(s.allocations);
+            if (s.tracks_live) {
+                o << std::setw(17) << std::llround(s.live_bytes);
+            }
+            else {
+                o << std::setw(17) << "-";
+            }
+            o << std::setw(10) << s.samples << "  ";
+            if (
+                s.site
+                && s.site->line() != 0
+                )
+            {
+                o << s.site->file_name() << "(" << s.site->line() << ") " << s.site->function_name() << "\n";
+            }
+            else {
+                o << "(no site - translate with -source-sites)\n";
+            }
+        }
+    }
+
+    //  Called when this thread's countdown goes below zero after an
+    //  allocation of n bytes: draw the next interval, and return the sample's
+    //  weight (the number of allocations it stands for), or 0 if this
+    //  allocation isn't sampled
+    //
+    auto sample(std::int64_t n)
+        -> double
+    {
+        thread_local auto started = false;
+        auto mean = interval();
+        if (mean == 0) {
+            //  Look again after another MB, in case sampling is restarted
+            impl::bytes_until_sample = 1 << 20;
+            started = false;
+            return 0;
+        }
+
+        //  A thread's first (or restarted) countdown wasn't drawn, so draw
+        //  one as if it had been, instead of always sampling this allocation
+        if (!started) {
+            started = true;
+            impl::bytes_until_sample = next_interval(mean) - n;
+            if (impl::bytes_until_sample >= 0) {
+                return 0;
+            }
+        }
+
+        impl::bytes_until_sample = next_interval(mean);
+        return 1 / -std::expm1(-static_cast<double>(n) / static_cast<double>(mean));
+    }
+
+    auto record(
+        source_site const* site,
+        std::int64_t       n,
+        double             weight,
+        bool               tracks_live
+    )
+        -> void
+    {
+        {
+            auto  lock = std::scoped_lock{ mutex };
+            auto& s    = sites[site];
+            s.site         = site;
+            s.samples     += 1;
+            s.allocations += weight;
+            s.bytes       += weight * static_cast<double>(n);
+            s.tracks_live  = s.tracks_live || tracks_live;
+            if (tracks_live) {
+                s.live_bytes += weight * static_cast<double>(n);
+            }
+        }
+        std::call_once(exit_report, []{
+            std::atexit([]{
+                auto& sampler = instance();
+                if (sampler.print_at_exit.load(std::memory_order_relaxed)) {
+                    sampler.print(std::cerr);
+                }
+            });
+        });
+    }
+
+    auto release(
+        source_site const* site,
+        std::int64_t       n,
+        double             weight
+    )
+        -> void
+    {
+        auto lock = std::scoped_lock{ mutex };
+        sites[site].live_bytes -= weight * static_cast<double>(n);
+    }
+
+private:
+    allocation_sampler() = default;
+
+    //  An exponentially distributed number of bytes with the given mean,
+    //  from a per-thread xorshift generator
+    static auto next_interval(std::int64_t mean)
+        -> std::int64_t
+    {
+        thread_local auto state = std::uint64_t{0};
+        if (state == 0) {
+            state = (std::uint64_t{std::random_device{}()} << 32) | std::random_device{}() | 1;
+        }
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        auto u = static_cast<double>((state * 2685821657736338717ull) >> 11) * 0x1.0p-53;   // [0,1)
+        return static_cast<std::int64_t>(-std::log1p(-u) * static_cast<double>(mean)) + 1;
+    }
+
+    std::atomic<std::int64_t> interval_     = 512 * 1024;
+    std::atomic<bool>         print_at_exit = true;
+    std::once_flag            exit_report;
+    mutable std::mutex        mutex;
+    std::unordered_map<source_site const*, site_stats> sites;
+};
+
+namespace impl {
+
+//  The site for a unique.new/shared.new call's Site ID in File
+template<site_id Site, typename File>
+auto allocation_site() -> source_site const*
+{
+    if constexpr (Site != 0 && !std::is_void_v<File>) {
+        return &source_site_at<File>(Site);
+    }
+    return nullptr;
+}
+
+struct allocation_sample {
+    source_site const* site   = {};
+    double             weight = 0;      // 0 if not sampled
+};
+
+//  The slow path, out of line so that each unique.new/shared.new is only
+//  a thread-local subtraction and a branch
+template<site_id Site, typename File>
+CPP2_COLD auto sample_allocation(std::int64_t n, bool tracks_live) -> allocation_sample
+{
+    auto& sampler = allocation_sampler::instance();
+    auto  weight  = sampler.sample(n);
+    if (weight == 0) {
+        return {};
+    }
+    auto site = allocation_site<Site, File>();
+    sampler.record(site, n, weight, tracks_live);
+    return { site, weight };
+}
+
+//  A sampled shared.new object's deleter, to track its live bytes
+template<typename T>
+struct sampled_delete {
+    allocation_sample sample;
+
+    auto operator()(T* p) const -> void {
+        delete p;
+        allocation_sampler::instance().release(sample.site, sizeof(T), sample.weight);
+    }
+};
+
+}
+
+#endif
+
+
 //-----------------------------------------------------------------------
 //
 //  Arena objects for std::allocators
@@ -842,27 +1220,55 @@ auto Typeid( [[maybe_unused]] auto&& x ) -> decltype(auto) {
 //  Note: cppfront translates "new" to "cpp2_new", so in Cpp2 code
 //        these are invoked by simply "unique.new<T>" etc.
 //
+//        With -source-sites, cppfront also passes the call's site ID and
+//        file (see source_site) as the Site and File template arguments,
+//        for CPP2_SAMPLE_ALLOCATIONS
+//
 //-----------------------------------------------------------------------
 //
+namespace impl {
+
+template<typename T>
+[[nodiscard]] auto new_unique(auto&& ...args) -> std::unique_ptr<T> {
+    //  Prefer { } to ( ) so that initializing a vector<int> with
+    //  (10), (10, 20), and (10, 20, 30) is consistent
+    if constexpr (requires { T{CPP2_FORWARD(args)...}; }) {
+        //  This is because apparently make_unique can't deal with list
+        //  initialization of aggregates, even after P0960
+        return std::unique_ptr<T>( new T{CPP2_FORWARD(args)...} );
+    }
+    else {
+        return std::make_unique<T>(CPP2_FORWARD(args)...);
+    }
+}
+
+}
+
 struct {
-    template<typename T>
+    template<typename T, site_id Site = 0, typename File = void>
     [[nodiscard]] auto cpp2_new(auto&& ...args) const -> std::unique_ptr<T> {
-        //  Prefer { } to ( ) so that initializing a vector<int> with
-        //  (10), (10, 20), and (10, 20, 30) is consistent
-        if constexpr (requires { T{CPP2_FORWARD(args)...}; }) {
-            //  This is because apparently make_unique can't deal with list
-            //  initialization of aggregates, even after P0960
-            return std::unique_ptr<T>( new T{CPP2_FORWARD(args)...} );
-        }
-        else {
-            return std::make_unique<T>(CPP2_FORWARD(args)...);
+#ifdef CPP2_SAMPLE_ALLOCATIONS
+        if ((impl::bytes_until_sample -= sizeof(T)) < 0) {
+            impl::sample_allocation<Site, File>(sizeof(T), false);
         }
+#endif
+        return impl::new_unique<T>(CPP2_FORWARD(args)...);
     }
 } inline unique;
 
 [[maybe_unused]] struct {
-    template<typename T>
+    template<typename T, site_id Site = 0, typename File = void>
     [[nodiscard]] auto cpp2_new(auto&& ...args) const -> std::shared_ptr<T> {
+#ifdef CPP2_SAMPLE_ALLOCATIONS
+        if ((impl::bytes_until_sample -= sizeof(T)) < 0) {
+            if (auto sample = impl::sample_allocation<Site, File>(sizeof(T), true); sample.weight != 0) {
+                return std::shared_ptr<T>(
+                    impl::new_unique<T>(CPP2_FORWARD(args)...).release(),
+                    impl::sampled_delete<T>{ sample }
+                );
+            }
+        }
+#endif
         //  Prefer { } to ( ) as noted for unique.new
         //
         //  Note this does mean we don't get the make_shared optimization a lot
@@ -876,11 +1282,11 @@ struct {
         //  restore the make_shared optimization as soon as make_shared supports
         //  list init, but I don't think it's all that important AFAIK
         if constexpr (requires { T{CPP2_FORWARD(args)...}; }) {
-            //  Why this calls 'unique.new': The workaround to use { } initialization
+            //  Why this calls 'new_unique': The workaround to use { } initialization
             //  requires calling naked 'new' to allocate the object separately anyway,
             //  so reuse the unique.new path that already does that (less code
             //  duplication, plus encapsulate the naked 'new' in one place)
-            return unique.cpp2_new<T>(CPP2_FORWARD(args)...);
+            return impl::new_unique<T>(CPP2_FORWARD(args)...);
         }
         else {
             return std::make_shared<T>(CPP2_FORWARD(args)...);
@@ -888,9 +1294,9 @@ struct {
     }
 } inline shared;
 
-template<typename T>
+template<typename T, site_id Site = 0, typename File = void>
 [[nodiscard]] auto cpp2_new(auto&& ...args) -> std::unique_ptr<T> {
-    return unique.cpp2_new<T>(CPP2_FORWARD(args)...);
+    return unique.cpp2_new<T, Site, File>(CPP2_FORWARD(args)...);
 }
 
 
@@ -1309,6 +1715,24 @@ inline auto to_string(auto&& value, std::string_view) -> std::string
 
 namespace impl {
 
+//  String interpolation with a :formatter suffix lowers to a call to this, where
+//  the format string is always a literal -- so when the library supports
+//  std::format_string (P2216), it is checked and parsed at compile time instead
+//  of being re-parsed by std::vformat on every call
+#if defined(__cpp_lib_format) && __cpp_lib_format >= 202106L
+template<typename T>
+inline auto format(std::format_string<T> fmt, T&& value) -> std::string
+{
+    return std::format(fmt, CPP2_FORWARD(value));
+}
+#else
+template<typename T>
+inline auto format(std::string_view fmt, T&& value) -> std::string
+{
+    return cpp2::to_string(CPP2_FORWARD(value), fmt);
+}
+#endif
+
 //-----------------------------------------------------------------------
 //
 //  is and as
@@ -1947,7 +2371,7 @@ class finally_presuccess
 public:
     finally_presuccess() = default;
 
-    auto add(const auto& f) { fs.push_back(f); }
+    auto add(auto&& f) { fs.push_back(CPP2_FORWARD(f)); }
 
     //  In compiled Cpp2 code, this function will be called
     //  immediately before 'return' (both explicit and implicit)
@@ -1990,100 +2414,1140 @@ constexpr auto unsafe_narrow( X&& x ) noexcept -> decltype(auto)
 
 //-----------------------------------------------------------------------
 //
-//  args: see main() arguments as a container of string_views
+//  as_range: Checked bulk conversion of a contiguous range of numbers
 //
-//  Does not perform any dynamic memory allocation - each string_view
-//  is directly bound to the string provided by the host environment
+//  as_range<To>(from, to) converts each value in 'from' (for example a
+//  std::span<From const>) to To and stores it at the same position in
+//  'to' (for example a std::span<To>), which must be at least as long
+//
+//  Only the value range is checked, so a floating point value keeps its
+//  usual rounding or truncation. A value that is out of To's range
+//  (including a NaN converted to an integer type) is a type_safety
+//  violation that reports its index, and the values from that index on
+//  are left unconverted
+//
+//  The values are processed in blocks that are first checked with a
+//  branch-free reduction and then converted, which compilers vectorize
 //
 //-----------------------------------------------------------------------
 //
-struct args_t
+namespace impl {
+
+template <typename To, typename From>
+struct as_range_limits
 {
-    args_t(int c, char** v) : argc{c}, argv{v} {}
+    using from_limits = std::numeric_limits<From>;
+    using to_limits   = std::numeric_limits<To>;
 
-    class iterator {
-    public:
-        iterator(int c, char** v, int start) : argc{c}, argv{v}, curr{start} {}
+    //  2^to_limits::digits, the first integer value that doesn't fit in To
+    static constexpr auto int_end() -> From
+        requires std::is_floating_point_v<From> && std::is_integral_v<To>
+    {
+        return From{2} * static_cast<From>(std::uint64_t{1} << (to_limits::digits - 1));
+    }
 
-        auto operator*() const {
-            if (curr < argc) { return std::string_view{ argv[curr] }; }
-            else             { return std::string_view{}; }
-        }
+    static constexpr auto check_low =
+        std::is_integral_v<From> && std::is_integral_v<To>
+            ? std::is_signed_v<From> && (!std::is_signed_v<To> || to_limits::digits < from_limits::digits)
+            : std::is_floating_point_v<From> && std::is_integral_v<To>;
 
-        auto operator+(int i) -> iterator  {
-            if (i > 0) { return { argc, argv, std::min(curr+i, argc) }; }
-            else       { return { argc, argv, std::max(curr+i, 0   ) }; }
+    static constexpr auto check_high =
+        std::is_integral_v<From> && std::is_integral_v<To>
+            ? to_limits::digits < from_limits::digits
+            : std::is_floating_point_v<From>
+                && (std::is_integral_v<To> || static_cast<long double>(to_limits::max()) < static_cast<long double>(from_limits::max()));
+
+    //  Uses '|' rather than '||' so that the checking loop has no branches
+    static constexpr auto out_of_range(From x) -> bool
+    {
+        auto bad = false;
+        if constexpr (std::is_floating_point_v<From> && std::is_floating_point_v<To>) {
+            //  Infinities and NaNs convert to themselves
+            if constexpr (check_high) {
+                auto magnitude = x < From{} ? -x : x;
+                bad = (magnitude > static_cast<From>(to_limits::max())) & (magnitude < from_limits::infinity());
+            }
         }
-        auto operator-(int i) -> iterator  { return operator+(-i); }
-        auto operator++()     -> iterator& { curr = std::min(curr+1, argc);  return *this; }
-        auto operator--()     -> iterator& { curr = std::max(curr-1, 0   );  return *this; }
-        auto operator++(int)  -> iterator  { auto old = *this;  ++*this;  return old; }
-        auto operator--(int)  -> iterator  { auto old = *this;  ++*this;  return old; }
+        else if constexpr (std::is_floating_point_v<From>) {
+            //  Written so that a NaN fails both
+            bad = !(x >= (std::is_signed_v<To> ? -int_end() : From{})) | !(x < int_end());
+        }
+        else {
+            if constexpr (check_low) {
+                bad |= x < (std::is_signed_v<To> ? static_cast<From>(to_limits::lowest()) : From{});
+            }
+            if constexpr (check_high) {
+                bad |= x > static_cast<From>(to_limits::max());
+            }
+        }
+        return bad;
+    }
+};
 
-        auto operator<=>(iterator const&) const = default;
+}
 
-    private:
-        int    argc;
-        char** argv;
-        int    curr;
-    };
+template <typename To>
+auto as_range(
+    auto const& from,
+    auto&&      to
+    CPP2_SOURCE_LOCATION_PARAM_WITH_DEFAULT
+)
+    -> void
+    requires (
+        requires {
+            std::data(from);
+            std::size(from);
+            { std::data(to) } -> std::same_as<To*>;
+            std::size(to);
+        }
+        && std::is_arithmetic_v<To> && !std::is_same_v<To, bool>
+        && std::is_arithmetic_v<CPP2_TYPEOF(*std::data(from))> && !std::is_same_v<CPP2_TYPEOF(*std::data(from)), bool>
+    )
+{
+    using from_type = CPP2_TYPEOF(*std::data(from));
+    using limits    = impl::as_range_limits<To, from_type>;
 
-    auto begin()  const -> iterator    { return iterator{ argc, argv, 0    }; }
-    auto end()    const -> iterator    { return iterator{ argc, argv, argc }; }
-    auto cbegin() const -> iterator    { return begin(); }
-    auto cend()   const -> iterator    { return end(); }
-    auto size()   const -> std::size_t { return cpp2::unsafe_narrow<std::size_t>(argc); }
-    auto ssize()  const -> int         { return argc; }
+    auto const src  = std::data(from);
+    auto const dst  = std::data(to);
+    auto const size = std::size(from);
 
-    auto operator[](int i) const {
-        if (0 <= i && i < argc) { return std::string_view{ argv[i] }; }
-        else                    { return std::string_view{}; }
+    if (std::size(to) < size) {
+        bounds_safety.report_violation("as_range target is smaller than the source" CPP2_SOURCE_LOCATION_ARG);
+        return;
     }
 
-    mutable int        argc = 0;        //  mutable for compatibility with frameworks that take 'int& argc'
-    char**             argv = nullptr;
-};
-
-inline auto make_args(int argc, char** argv) -> args_t
-{
-    return args_t{argc, argv};
-}
+    constexpr auto block = std::size_t{1024};
+    for (auto first = std::size_t{}; first < size; first += block)
+    {
+        auto const last = std::min(size, first + block);
 
+        if constexpr (limits::check_low || limits::check_high) {
+            //  An int accumulator, because compilers don't vectorize a bool one
+            auto bad = 0;
+            for (auto i = first; i < last; ++i) {
+                bad |= limits::out_of_range(src[i]);
+            }
+            if (bad) {
+                auto i = first;
+                for ( ; !limits::out_of_range(src[i]); ++i) {
+                    dst[i] = static_cast<To>(src[i]);
+                }
+                auto msg = "as_range value at index " + std::to_string(i) + " is out of range for the target type";
+                type_safety.report_violation(msg.c_str() CPP2_SOURCE_LOCATION_ARG);
+                return;
+            }
+        }
 
-//-----------------------------------------------------------------------
-//
-//  alien_memory: memory typed as T but that is outside C++ and that the
-//                compiler may not assume it knows anything at all about
-//
-//-----------------------------------------------------------------------
-//
-template<typename T>
-using alien_memory = T volatile;
+        for (auto i = first; i < last; ++i) {
+            dst[i] = static_cast<To>(src[i]);
+        }
+    }
+}
 
 
 //-----------------------------------------------------------------------
 //
-//  has_flags:  query whether a flag_enum value has all flags in 'flags' set
+//  Trivial relocation
 //
-//  flags       set of flags to check
+//  Relocating an object moves it to new storage and ends its lifetime in
+//  the old storage. A type is trivially relocatable if that's the same as
+//  copying its bytes, because nothing points into the object itself -- so
+//  a container can grow by memcpy instead of moving and destroying each
+//  element. Copying the bytes is enough for every trivially copyable type,
+//  for the std:: types specialized below, and for a type that applies
+//  @trivially_relocatable (which checks that its bases and members are)
 //
-//  Returns a function object that takes a 'value' of the same type as
-//  'flags', and evaluates to true if and only if 'value' has set all of
-//  the bits set in 'flags'
+//  relocate(from, to)                  relocate one object into the
+//                                      uninitialized storage at 'to'
+//  uninitialized_relocate(f, l, out)   relocate [f, l) into the
+//                                      uninitialized storage at 'out'
+//  relocating_vector<T>                a vector that grows by relocating
 //
 //-----------------------------------------------------------------------
 //
 template <typename T>
-auto has_flags(T flags)
-{
-    return [=](T value) { return (value & flags) == flags; };
-}
+struct is_trivially_relocatable
+    : std::bool_constant<std::is_trivially_copyable_v<T>>
+{ };
 
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<std::remove_cv_t<T>>::value;
 
-//-----------------------------------------------------------------------
-//
-//  Speculative: RAII wrapping for the C standard library
-//
+//  A type that applies @trivially_relocatable names itself as this member,
+//  which a derived type inherits but doesn't name itself with
+template <typename T>
+    requires std::is_same_v<typename T::_trivially_relocatable, T>
+struct is_trivially_relocatable<T> : std::true_type { };
+
+//  These own their state through a pointer, on all major implementations
+template <typename T, typename D>
+struct is_trivially_relocatable<std::unique_ptr<T, D>> : is_trivially_relocatable<D> { };
+
+template <typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type { };
+
+template <typename T>
+struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type { };
+
+template <typename T>
+struct is_trivially_relocatable<std::optional<T>> : is_trivially_relocatable<T> { };
+
+template <typename T, typename U>
+struct is_trivially_relocatable<std::pair<T, U>>
+    : std::bool_constant<is_trivially_relocatable_v<T> && is_trivially_relocatable_v<U>>
+{ };
+
+//  Except when checked iterators register themselves with the vector
+#if !defined(_GLIBCXX_DEBUG) && !(defined(_ITERATOR_DEBUG_LEVEL) && _ITERATOR_DEBUG_LEVEL != 0)
+template <typename T>
+struct is_trivially_relocatable<std::vector<T>> : std::true_type { };
+#endif
+
+namespace impl {
+
+//  What @trivially_relocatable adds to a type as _trivially_relocatable
+template <typename T, typename... Members>
+struct trivially_relocatable_members
+{
+    static_assert(
+        (is_trivially_relocatable_v<Members> && ...),
+        "@trivially_relocatable requires every base and data member to be trivially relocatable: a trivially copyable type, std::unique_ptr, std::shared_ptr, std::weak_ptr, std::vector, or std::optional or std::pair of those, or a type that applies @trivially_relocatable"
+    );
+    using type = T;
+};
+
+}
+
+template <typename T, typename... Members>
+using trivially_relocatable_tag = typename impl::trivially_relocatable_members<T, Members...>::type;
+
+
+template <typename T>
+auto relocate(T* from, T* to)
+    noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)
+    -> T*
+{
+    if constexpr (is_trivially_relocatable_v<T>) {
+        std::memcpy(static_cast<void*>(to), static_cast<void const*>(from), sizeof(T));
+        return std::launder(to);
+    }
+    else {
+        auto ret = std::construct_at(to, std::move(*from));
+        std::destroy_at(from);
+        return ret;
+    }
+}
+
+//  For a type that isn't trivially relocatable, this moves (or copies, if
+//  moving could throw) the objects and then destroys the originals, so if
+//  an exception is thrown they're left as they were
+template <typename T>
+auto uninitialized_relocate(T* first, T* last, T* out)
+    -> T*
+{
+    if constexpr (is_trivially_relocatable_v<T>) {
+        if (first != last) {
+            std::memcpy(static_cast<void*>(out), static_cast<void const*>(first), (last - first) * sizeof(T));
+        }
+        return out + (last - first);
+    }
+    else {
+        auto ret = out;
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            ret = std::uninitialized_move(first, last, out);
+        }
+        else {
+            ret = std::uninitialized_copy(first, last, out);
+        }
+        std::destroy(first, last);
+        return ret;
+    }
+}
+
+
+template <typename T>
+class relocating_vector
+{
+    T*          elems = nullptr;
+    std::size_t count = 0;
+    std::size_t cap   = 0;
+
+    auto relocate_to_new_buffer(std::size_t new_cap)
+        -> void
+    {
+        auto buffer  = std::allocator<T>{}.allocate(new_cap);
+        auto cleanup = finally([&]{ if (buffer) { std::allocator<T>{}.deallocate(buffer, new_cap); } });
+        uninitialized_relocate(elems, elems + count, buffer);
+        replace_buffer(std::exchange(buffer, nullptr), new_cap);
+    }
+
+    template <typename... Args>
+    auto grow_and_emplace_back(Args&&... args)
+        -> T&
+    {
+        //  Construct the new element before relocating the others,
+        //  in case the arguments refer to one of them
+        auto new_cap = cap < 4 ? std::size_t{4} : 2 * cap;
+        auto buffer  = std::allocator<T>{}.allocate(new_cap);
+        auto cleanup = finally([&]{ if (buffer) { std::allocator<T>{}.deallocate(buffer, new_cap); } });
+        std::construct_at(buffer + count, CPP2_FORWARD(args)...);
+        auto cleanup_element = finally([&]{ if (buffer) { std::destroy_at(buffer + count); } });
+        uninitialized_relocate(elems, elems + count, buffer);
+        replace_buffer(std::exchange(buffer, nullptr), new_cap);
+        return elems[count++];
+    }
+
+    auto replace_buffer(T* buffer, std::size_t new_cap) noexcept
+        -> void
+    {
+        if (elems) {
+            std::allocator<T>{}.deallocate(elems, cap);
+        }
+        elems = buffer;
+        cap   = new_cap;
+    }
+
+public:
+    using value_type     = T;
+    using size_type      = std::size_t;
+    using iterator       = T*;
+    using const_iterator = T const*;
+
+    relocating_vector() = default;
+
+    relocating_vector(relocating_vector&& that) noexcept
+        : elems{std::exchange(that.elems, nullptr)}
+        , count{std::exchange(that.count, 0)}
+        , cap  {std::exchange(that.cap,   0)}
+    { }
+
+    relocating_vector(relocating_vector const& that)
+        requires std::is_copy_constructible_v<T>
+    {
+        reserve(that.count);
+        for (auto const& x : that) {
+            emplace_back(x);
+        }
+    }
+
+    auto operator=(relocating_vector&& that) noexcept
+        -> relocating_vector&
+    {
+        auto tmp = std::move(that);
+        swap(tmp);
+        return *this;
+    }
+
+    auto operator=(relocating_vector const& that)
+        -> relocating_vector&
+        requires std::is_copy_constructible_v<T>
+    {
+        auto tmp = that;
+        swap(tmp);
+        return *this;
+    }
+
+    ~relocating_vector() noexcept
+    {
+        clear();
+        replace_buffer(nullptr, 0);
+    }
+
+    auto swap(relocating_vector& that) noexcept
+        -> void
+    {
+        std::swap(elems, that.elems);
+        std::swap(count, that.count);
+        std::swap(cap,   that.cap  );
+    }
+
+    auto size    () const -> std::size_t    { return count; }
+    auto ssize   () const -> std::ptrdiff_t { return static_cast<std::ptrdiff_t>(count); }
+    auto capacity() const -> std::size_t    { return cap; }
+    auto empty   () const -> bool           { return count == 0; }
+
+    auto data ()       -> T*       { return elems; }
+    auto data () const -> T const* { return elems; }
+    auto begin()       -> T*       { return elems; }
+    auto begin() const -> T const* { return elems; }
+    auto end  ()       -> T*       { return elems + count; }
+    auto end  () const -> T const* { return elems + count; }
+
+    auto operator[](std::size_t i)       -> T&       { return elems[i]; }
+    auto operator[](std::size_t i) const -> T const& { return elems[i]; }
+    auto front()       -> T&       { return elems[0]; }
+    auto front() const -> T const& { return elems[0]; }
+    auto back ()       -> T&       { return elems[count-1]; }
+    auto back () const -> T const& { return elems[count-1]; }
+
+    auto reserve(std::size_t n)
+        -> void
+    {
+        if (n > cap) {
+            relocate_to_new_buffer(n);
+        }
+    }
+
+    template <typename... Args>
+    auto emplace_back(Args&&... args)
+        -> T&
+    {
+        if (count == cap) {
+            return grow_and_emplace_back(CPP2_FORWARD(args)...);
+        }
+        std::construct_at(elems + count, CPP2_FORWARD(args)...);
+        return elems[count++];
+    }
+
+    auto push_back(T const& x) -> void { emplace_back(x); }
+    auto push_back(T&& x)      -> void { emplace_back(std::move(x)); }
+
+    auto pop_back() noexcept
+        -> void
+    {
+        std::destroy_at(elems + --count);
+    }
+
+    auto clear() noexcept
+        -> void
+    {
+        std::destroy(elems, elems + count);
+        count = 0;
+    }
+};
+
+
+//-----------------------------------------------------------------------
+//
+//  slot_map: dense storage addressed by generational handles
+//
+//  slot_handle<T>   a 32-bit slot index + 32-bit generation; a
+//                   default-constructed handle is null
+//  slot_map<T>      owns T objects contiguously, so iteration runs
+//                   over dense storage, and gives out handles to them
+//
+//  Looking up a handle is O(1) and checked: a null handle is a
+//  null_safety violation, and a handle whose element was erased (or
+//  that came from another slot_map) is a bounds_safety violation.
+//  Erasing moves the last element into the hole, so T must be movable.
+//
+//  @slot_map adds these for a type as its 'slots' and 'handle' members
+//
+//-----------------------------------------------------------------------
+//
+template <typename T>
+class slot_map;
+
+template <typename T>
+class slot_handle
+{
+    std::uint32_t index      = 0;
+    std::uint32_t generation = 0;   // live slots' generations are never 0
+
+    constexpr slot_handle(std::uint32_t i, std::uint32_t g) noexcept : index{i}, generation{g} { }
+    friend class slot_map<T>;
+
+public:
+    constexpr slot_handle() noexcept = default;
+
+    constexpr auto is_null() const noexcept -> bool { return generation == 0; }
+    friend constexpr auto operator==(slot_handle const&, slot_handle const&) -> bool = default;
+};
+
+template <typename T>
+class slot_map
+{
+    //  For a live slot, 'next' is the element's index in 'values';
+    //  for a free slot, it's the next free slot's index
+    struct slot {
+        std::uint32_t next;
+        std::uint32_t generation;
+    };
+
+    static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<T>             values;
+    std::vector<std::uint32_t> value_slots;     // each value's slot index
+    std::vector<slot>          slots;
+    std::uint32_t              free_head = none;
+
+    //  A live slot's generation is never 0, so this also rejects null
+    auto check(slot_handle<T> h) const
+        -> std::uint32_t
+    {
+        if (!contains(h)) {
+            report_invalid(h);
+        }
+        return slots[h.index].next;
+    }
+
+    CPP2_COLD static auto report_invalid(slot_handle<T> h)
+        -> void
+    {
+        if (h.is_null()) {
+            null_safety.report_violation("slot_map handle is null");
+        }
+        else {
+            bounds_safety.report_violation("slot_map handle does not refer to a live element - was it erased?");
+        }
+    }
+
+    auto next_generation(slot& s) noexcept
+        -> void
+    {
+        if (++s.generation == 0) {
+            s.generation = 1;
+        }
+    }
+
+public:
+    using value_type = T;
+    using handle     = slot_handle<T>;
+    using iterator       = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    auto size () const -> std::size_t    { return values.size(); }
+    auto ssize() const -> std::ptrdiff_t { return std::ssize(values); }
+    auto empty() const -> bool           { return values.empty(); }
+
+    auto data ()       -> T*             { return values.data(); }
+    auto data () const -> T const*       { return values.data(); }
+    auto begin()       -> iterator       { return values.begin(); }
+    auto begin() const -> const_iterator { return values.begin(); }
+    auto end  ()       -> iterator       { return values.end(); }
+    auto end  () const -> const_iterator { return values.end(); }
+
+    //  The handle of the element at position i of the dense storage
+    auto handle_at(std::size_t i) const
+        -> handle
+    {
+        auto s = value_slots[i];
+        return { s, slots[s].generation };
+    }
+
+    auto reserve(std::size_t n)
+        -> void
+    {
+        values.reserve(n);
+        value_slots.reserve(n);
+        slots.reserve(n);
+    }
+
+    template <typename... Args>
+    auto emplace(Args&&... args)
+        -> handle
+    {
+        if (free_head == none) {
+            bounds_safety.enforce(slots.size() < none, "slot_map is full");
+            slots.push_back({none, 1});
+            free_head = static_cast<std::uint32_t>(slots.size() - 1);
+        }
+
+        value_slots.push_back(free_head);
+        auto undo = finally([&]{ if (value_slots.size() > values.size()) { value_slots.pop_back(); } });
+        values.emplace_back(CPP2_FORWARD(args)...);
+
+        auto index = free_head;
+        auto& s    = slots[index];
+        free_head  = s.next;
+        s.next     = static_cast<std::uint32_t>(values.size() - 1);
+        return { index, s.generation };
+    }
+
+    auto insert(T const& x) -> handle { return emplace(x); }
+    auto insert(T&& x)      -> handle { return emplace(std::move(x)); }
+
+    //  A free slot can have the handle's generation too, if the handle
+    //  came from another slot_map, so also check that the slot is live
+    auto contains(handle h) const noexcept
+        -> bool
+    {
+        if (h.index >= slots.size()) {
+            return false;
+        }
+        auto& s = slots[h.index];
+        return s.generation == h.generation
+            && s.next < value_slots.size()
+            && value_slots[s.next] == h.index;
+    }
+
+    auto operator[](handle h)       -> T&       { return values[check(h)]; }
+    auto operator[](handle h) const -> T const& { return values[check(h)]; }
+
+    auto erase(handle h)
+        -> void
+    {
+        auto pos  = check(h);
+        auto last = values.size() - 1;
+        if (pos != last) {
+            values[pos]      = std::move(values[last]);
+            value_slots[pos] = value_slots[last];
+            slots[value_slots[pos]].next = pos;
+        }
+        values.pop_back();
+        value_slots.pop_back();
+
+        auto& s   = slots[h.index];
+        next_generation(s);
+        s.next    = free_head;
+        free_head = h.index;
+    }
+
+    auto clear() noexcept
+        -> void
+    {
+        for (auto index : value_slots) {
+            auto& s   = slots[index];
+            next_generation(s);
+            s.next    = free_head;
+            free_head = index;
+        }
+        values.clear();
+        value_slots.clear();
+    }
+};
+
+
+//-----------------------------------------------------------------------
+//
+//  bits<N>, signed_bits<N>: the smallest integer type that holds an
+//  N-bit value, used to declare the members of a @bitpacked type
+//
+//-----------------------------------------------------------------------
+//
+template <int N>
+    requires (1 <= N && N <= 64)
+using bits =
+    std::conditional_t<N <=  8, std::uint8_t,
+    std::conditional_t<N <= 16, std::uint16_t,
+    std::conditional_t<N <= 32, std::uint32_t,
+                                std::uint64_t>>>;
+
+template <int N>
+    requires (1 <= N && N <= 64)
+using signed_bits =
+    std::conditional_t<N <=  8, std::int8_t,
+    std::conditional_t<N <= 16, std::int16_t,
+    std::conditional_t<N <= 32, std::int32_t,
+                                std::int64_t>>>;
+
+
+//-----------------------------------------------------------------------
+//
+//  Elementwise kernels, used by the 'batch' type that @simd_vector
+//  generates for structure-of-arrays storage
+//
+//  simd_element<T>                 T, which must be an arithmetic type
+//  abs_value(x)                    |x| for signed and unsigned types
+//  elementwise(n, op, out, in...)  out[i] = op(in[i]...) for i in [0, n),
+//                                  where each 'in' is an array, or a
+//                                  single value used for every i
+//  multiply_add                    an 'op' that computes a + b * c
+//
+//  With GCC/Clang vector extensions, elementwise applies op to a 16-byte
+//  vector of elements at a time (so op should only use arithmetic
+//  operators, like std::plus()), and to one element at a time otherwise
+//
+//-----------------------------------------------------------------------
+//
+template <typename T>
+    requires std::is_arithmetic_v<T>
+using simd_element = T;
+
+template <typename T>
+constexpr auto abs_value(T x)
+    -> T
+{
+    if constexpr (std::is_signed_v<T>) {
+        return x < 0 ? static_cast<T>(-x) : x;
+    }
+    else {
+        return x;
+    }
+}
+
+inline constexpr auto multiply_add = [](auto const& a, auto const& b, auto const& c) { return a + b * c; };
+
+template <typename T, typename Op, typename... In>
+    requires ((std::is_convertible_v<In, T const*> || std::is_same_v<In, T>) && ...)
+auto elementwise(std::size_t n, Op op, T* out, In... in)
+    -> void
+{
+    auto i = std::size_t{0};
+
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+        typedef T vec __attribute__((vector_size(16)));
+        constexpr auto lanes = sizeof(vec) / sizeof(T);
+        auto load = [&i]<typename X>(X x) {
+            if constexpr (std::is_same_v<X, T>) {
+                return x;   // a scalar operand of a vector operation is broadcast
+            }
+            else {
+                vec v;
+                std::memcpy(&v, x + i, sizeof(vec));
+                return v;
+            }
+        };
+
+        for (; i + lanes <= n; i += lanes) {
+            vec result = op(load(in)...);
+            std::memcpy(out + i, &result, sizeof(vec));
+        }
+    }
+#endif
+
+    auto at = [&i]<typename X>(X x) -> T {
+        if constexpr (std::is_same_v<X, T>) { return x; }
+        else                                { return x[i]; }
+    };
+    for (; i < n; ++i) {
+        out[i] = static_cast<T>(op(at(in)...));
+    }
+}
+
+
+//-----------------------------------------------------------------------
+//
+//  Interning: one shared immutable object per distinct value
+//
+//  interned<T>             a pointer-sized handle to the canonical object
+//                          for a value; == and hash() look only at the
+//                          address, and <=> uses T's <=> for handles to
+//                          different values; a default-constructed
+//                          handle is null
+//  intern_table<T, Mutex>  the canonical objects, which live until the
+//                          program ends; intern(x) returns the handle for
+//                          x's value, adding a copy of x if it's new
+//  hash_combine(seed, x)   mixes std::hash of x into seed
+//
+//  T must provide == and 'hash() const -> std::size_t'. Mutex must be
+//  shared-lockable (e.g., std::shared_mutex) -- interning a value that
+//  is already in the table only takes a shared lock
+//
+//  @interned adds these for a type as its 'handle' member and 'intern'
+//  function
+//
+//-----------------------------------------------------------------------
+//
+template <typename T>
+auto hash_combine(std::size_t seed, T const& x)
+    -> std::size_t
+{
+    return seed ^ (std::hash<T>()(x) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+template <typename T, typename Mutex>
+class intern_table;
+
+template <typename T>
+class interned
+{
+    T const* p = nullptr;
+
+    constexpr explicit interned(T const* p_) noexcept : p{p_} { }
+    template <typename, typename> friend class intern_table;
+
+public:
+    constexpr interned() noexcept = default;
+
+    constexpr auto is_null() const noexcept -> bool { return p == nullptr; }
+
+    auto get() const
+        -> T const&
+    {
+        if (is_null()) {
+            null_safety.report_violation("interned handle is null");
+        }
+        return *p;
+    }
+
+    auto operator* () const -> T const& { return get(); }
+    auto operator->() const -> T const* { return &get(); }
+
+    auto hash() const noexcept -> std::size_t { return std::hash<T const*>()(p); }
+
+    friend constexpr auto operator==(interned, interned) -> bool = default;
+
+    //  A template, so that the return type is only formed for a T that
+    //  has <=>, not whenever interned<T> is instantiated
+    template <typename U = T>
+        requires std::three_way_comparable<U>
+    friend auto operator<=>(interned a, interned b)
+        -> std::compare_three_way_result_t<U>
+    {
+        if (a.p == b.p) {
+            return std::compare_three_way_result_t<U>::equivalent;
+        }
+        if (a.is_null() || b.is_null()) {
+            return b.is_null() <=> a.is_null();     // null sorts first
+        }
+        return *a.p <=> *b.p;
+    }
+};
+
+template <typename T, typename Mutex>
+class intern_table
+{
+    //  An open-addressing index; a bucket with a null value is empty
+    struct bucket {
+        std::size_t hash  = 0;
+        T const*    value = nullptr;
+    };
+
+    std::vector<std::unique_ptr<T const>> values;
+    std::vector<bucket>                   buckets = std::vector<bucket>(64);
+    mutable Mutex                         mutex;
+
+    auto find(T const& x, std::size_t h) const
+        -> T const*
+    {
+        auto mask = buckets.size() - 1;
+        for (auto i = h & mask; buckets[i].value; i = (i + 1) & mask) {
+            if (buckets[i].hash == h && *buckets[i].value == x) {
+                return buckets[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    auto place(bucket b)
+        -> void
+    {
+        auto mask = buckets.size() - 1;
+        auto i    = b.hash & mask;
+        while (buckets[i].value) {
+            i = (i + 1) & mask;
+        }
+        buckets[i] = b;
+    }
+
+public:
+    static auto instance()
+        -> intern_table&
+    {
+        static auto table = intern_table{};
+        return table;
+    }
+
+    auto intern(T const& x)
+        -> interned<T>
+    {
+        auto h = x.hash();
+        {
+            mutex.lock_shared();
+            auto unlock = finally([&]{ mutex.unlock_shared(); });
+            if (auto p = find(x, h)) {
+                return interned<T>{p};
+            }
+        }
+
+        mutex.lock();
+        auto unlock = finally([&]{ mutex.unlock(); });
+        if (auto p = find(x, h)) {  // another thread may have added it
+            return interned<T>{p};
+        }
+
+        //  Keep the load factor at most 1/2
+        if ((values.size() + 1) * 2 > buckets.size()) {
+            auto old = std::exchange(buckets, std::vector<bucket>(buckets.size() * 2));
+            for (auto b : old) {
+                if (b.value) {
+                    place(b);
+                }
+            }
+        }
+        values.push_back(std::make_unique<T const>(x));
+        place({h, values.back().get()});
+        return interned<T>{values.back().get()};
+    }
+
+    auto size() const
+        -> std::size_t
+    {
+        mutex.lock_shared();
+        auto unlock = finally([&]{ mutex.unlock_shared(); });
+        return values.size();
+    }
+};
+
+
+//-----------------------------------------------------------------------
+//
+//  Key comparisons: the operator<=> and operator== that @ordered
+//  generates for a type whose data members are all unsigned integers or
+//  arrays of bytes, given std::tie of each object's members
+//
+//  key_compare(a, b)       a <=> b, computed by packing each side's
+//                          members in order into big-endian 64-bit
+//                          words, and comparing the words
+//  key_equal(x, y, a, b)   compares x's and y's bytes with memcmp when
+//                          the members fill all of T without padding,
+//                          and otherwise compares the members
+//  packed_key_equal(...)   the same, but compares the packed words
+//                          instead of the members
+//
+//  key_compare and packed_key_equal are for @ordered<packed>
+//
+//  If a member turns out not to qualify (e.g., because a type alias
+//  named it), these just compare the tuples
+//
+//-----------------------------------------------------------------------
+//
+template <typename T>
+constexpr bool is_key_byte_v =
+    std::is_same_v<T, unsigned char> || std::is_same_v<T, std::byte> || std::is_same_v<T, char8_t>;
+
+template <typename T>
+concept key_part =
+    std::is_unsigned_v<T>
+    || is_key_byte_v<T>
+    || requires {
+        requires is_key_byte_v<std::remove_cv_t<typename T::value_type>>;
+        requires sizeof(T) == std::tuple_size<T>::value;
+    };
+
+template <key_part... Ts>
+class key_words
+{
+    //  Calls f(bytes) for each part of a T: the whole value of an
+    //  integer, or each 8 bytes of an array
+    template <typename T>
+    static constexpr auto for_each_part_size(auto f)
+        -> void
+    {
+        if constexpr (std::is_unsigned_v<T> || is_key_byte_v<T>) {
+            f(sizeof(T));
+        }
+        else {
+            for (auto i = std::size_t{0}; i < sizeof(T); i += 8) {
+                f(std::min(sizeof(T) - i, std::size_t{8}));
+            }
+        }
+    }
+
+    //  A part that doesn't fit in the rest of the current word starts
+    //  the next one, so that parts never straddle words
+    static constexpr auto count = []{
+        auto words = std::size_t{1};
+        auto used  = std::size_t{0};
+        (for_each_part_size<Ts>([&](std::size_t bytes) {
+            if (used + bytes > 8) { ++words; used = 0; }
+            used += bytes;
+        }), ...);
+        return words;
+    }();
+
+    std::uint64_t words[count] = {};
+
+    struct cursor {
+        std::size_t word = 0;
+        std::size_t used = 0;
+    };
+
+    CPP2_FORCE_INLINE constexpr auto add(cursor& at, std::uint64_t value, std::size_t bytes)
+        -> void
+    {
+        if (at.used + bytes > 8) {
+            ++at.word;
+            at.used = 0;
+        }
+        words[at.word] = bytes == 8 ? value : (words[at.word] << (8 * bytes)) | value;
+        at.used += bytes;
+    }
+
+    template <typename T>
+    CPP2_FORCE_INLINE constexpr auto add_member(cursor& at, T const& x)
+        -> void
+    {
+        if constexpr (std::is_unsigned_v<T>) {
+            add(at, x, sizeof(T));
+        }
+        else if constexpr (is_key_byte_v<T>) {
+            add(at, static_cast<unsigned char>(x), 1);
+        }
+        else {
+            for (auto i = std::size_t{0}; i < sizeof(T); i += 8) {
+                auto bytes = std::min(sizeof(T) - i, std::size_t{8});
+                auto value = std::uint64_t{0};
+                for (auto j = i; j < i + bytes; ++j) {
+                    value = (value << 8) | static_cast<unsigned char>(x[j]);
+                }
+                add(at, value, bytes);
+            }
+        }
+    }
+
+    template <typename Tuple, std::size_t... I>
+    CPP2_FORCE_INLINE constexpr auto add_members(Tuple const& members, std::index_sequence<I...>)
+        -> void
+    {
+        auto at = cursor{};
+        (add_member(at, std::get<I>(members)), ...);
+    }
+
+public:
+    template <typename Tuple>
+    CPP2_FORCE_INLINE constexpr explicit key_words(Tuple const& members)
+    {
+        add_members(members, std::index_sequence_for<Ts...>{});
+    }
+
+    friend constexpr auto operator==(key_words const& a, key_words const& b) -> bool = default;
+
+    CPP2_FORCE_INLINE friend constexpr auto operator<=>(key_words const& a, key_words const& b)
+        -> std::strong_ordering
+    {
+        for (auto i = std::size_t{0}; i < count - 1; ++i) {
+            if (a.words[i] != b.words[i]) {
+                return a.words[i] <=> b.words[i];
+            }
+        }
+        return a.words[count - 1] <=> b.words[count - 1];
+    }
+};
+
+template <typename... Ts>
+CPP2_FORCE_INLINE constexpr auto key_compare(std::tuple<Ts&...> const& a, std::tuple<Ts&...> const& b)
+    -> decltype(auto)
+{
+    if constexpr ((key_part<std::remove_cv_t<Ts>> && ...)) {
+        return key_words<std::remove_cv_t<Ts>...>(a) <=> key_words<std::remove_cv_t<Ts>...>(b);
+    }
+    else {
+        return a <=> b;
+    }
+}
+
+template <typename T, typename... Ts>
+constexpr bool is_key_without_padding_v =
+    sizeof(T) == (sizeof(Ts) + ...)
+    && (std::has_unique_object_representations_v<std::remove_cv_t<Ts>> && ...);
+
+template <typename T, typename... Ts>
+auto key_equal(T const& x, T const& y, std::tuple<Ts&...> const& a, std::tuple<Ts&...> const& b)
+    -> bool
+{
+    if constexpr (is_key_without_padding_v<T, Ts...>) {
+        return std::memcmp(std::addressof(x), std::addressof(y), sizeof(T)) == 0;
+    }
+    else {
+        return a == b;
+    }
+}
+
+template <typename T, typename... Ts>
+auto packed_key_equal(T const& x, T const& y, std::tuple<Ts&...> const& a, std::tuple<Ts&...> const& b)
+    -> bool
+{
+    if constexpr (is_key_without_padding_v<T, Ts...>) {
+        return std::memcmp(std::addressof(x), std::addressof(y), sizeof(T)) == 0;
+    }
+    else if constexpr ((key_part<std::remove_cv_t<Ts>> && ...)) {
+        return key_words<std::remove_cv_t<Ts>...>(a) == key_words<std::remove_cv_t<Ts>...>(b);
+    }
+    else {
+        return a == b;
+    }
+}
+
+
+//-----------------------------------------------------------------------
+//
+//  args: see main() arguments as a container of string_views
+//
+//  Does not perform any dynamic memory allocation - each string_view
+//  is directly bound to the string provided by the host environment
+//
+//-----------------------------------------------------------------------
+//
+struct args_t
+{
+    args_t(int c, char** v) : argc{c}, argv{v} {}
+
+    class iterator {
+    public:
+        iterator(int c, char** v, int start) : argc{c}, argv{v}, curr{start} {}
+
+        auto operator*() const {
+            if (curr < argc) { return std::string_view{ argv[curr] }; }
+            else             { return std::string_view{}; }
+        }
+
+        auto operator+(int i) -> iterator  {
+            if (i > 0) { return { argc, argv, std::min(curr+i, argc) }; }
+            else       { return { argc, argv, std::max(curr+i, 0   ) }; }
+        }
+        auto operator-(int i) -> iterator  { return operator+(-i); }
+        auto operator++()     -> iterator& { curr = std::min(curr+1, argc);  return *this; }
+        auto operator--()     -> iterator& { curr = std::max(curr-1, 0   );  return *this; }
+        auto operator++(int)  -> iterator  { auto old = *this;  ++*this;  return old; }
+        auto operator--(int)  -> iterator  { auto old = *this;  ++*this;  return old; }
+
+        auto operator<=>(iterator const&) const = default;
+
+    private:
+        int    argc;
+        char** argv;
+        int    curr;
+    };
+
+    auto begin()  const -> iterator    { return iterator{ argc, argv, 0    }; }
+    auto end()    const -> iterator    { return iterator{ argc, argv, argc }; }
+    auto cbegin() const -> iterator    { return begin(); }
+    auto cend()   const -> iterator    { return end(); }
+    auto size()   const -> std::size_t { return cpp2::unsafe_narrow<std::size_t>(argc); }
+    auto ssize()  const -> int         { return argc; }
+
+    auto operator[](int i) const {
+        if (0 <= i && i < argc) { return std::string_view{ argv[i] }; }
+        else                    { return std::string_view{}; }
+    }
+
+    mutable int        argc = 0;        //  mutable for compatibility with frameworks that take 'int& argc'
+    char**             argv = nullptr;
+};
+
+inline auto make_args(int argc, char** argv) -> args_t
+{
+    return args_t{argc, argv};
+}
+
+
+//-----------------------------------------------------------------------
+//
+//  alien_memory: memory typed as T but that is outside C++ and that the
+//                compiler may not assume it knows anything at all about
+//
+//-----------------------------------------------------------------------
+//
+template<typename T>
+using alien_memory = T volatile;
+
+
+//-----------------------------------------------------------------------
+//
+//  has_flags:  query whether a flag_enum value has all flags in 'flags' set
+//
+//  flags       set of flags to check
+//
+//  Returns a function object that takes a 'value' of the same type as
+//  'flags', and evaluates to true if and only if 'value' has set all of
+//  the bits set in 'flags'
+//
+//-----------------------------------------------------------------------
+//
+template <typename T>
+auto has_flags(T flags)
+{
+    return [=](T value) { return (value & flags) == flags; };
+}
+
+
+//-----------------------------------------------------------------------
+//
+//  Speculative: RAII wrapping for the C standard library
+//
 //  As part of embracing compatibility while also reducing what we have to
 //  teach and learn about C++ (which includes the C standard library), I
 //  was curious to see if we can improve use of the C standard library
@@ -2314,6 +3778,12 @@ inline constexpr auto as_() -> decltype(auto)
 }
 
 
+template <typename T>
+struct std::hash<cpp2::interned<T>>
+{
+    auto operator()(cpp2::interned<T> h) const noexcept -> std::size_t { return h.hash(); }
+};
+
 using cpp2::cpp2_new;
 
 
@@ -252,6 +252,14 @@ for test_file in $tests; do
         descr="pure Cpp2 code"
         opt="-p"
     fi
+    # Using naming convention to test -string-view-params
+    if [[ $test_name == *"-string-view-params"* ]]; then
+        opt="$opt -string-view-params"
+    fi
+    # Using naming convention to test -source-sites
+    if [[ $test_name == *"-source-sites"* ]]; then
+        opt="$opt -source-sites"
+    fi
     echo "    Testing $descr: $test_name.cpp2"
 
     ########
@@ -265,6 +273,19 @@ for test_file in $tests; do
     # The C++1 generation output has to exist and to be tracked by git
     check_file "$expected_output" "Cpp1 generation output file"
 
+    ########
+    # A test can have a .h2 of the same name, which is translated with
+    # -pure-cpp2 to the .h and .hpp that the test's .cpp includes
+    header_file="$test_name.h2"
+    expected_h="$expected_results_dir/$test_name.h"
+    if [[ -f "$header_file" ]]; then
+        echo "        Generating Cpp1 code for $header_file"
+        ./"$cppfront_cmd" "$header_file" -o "$expected_h" -p > "$expected_results_dir/$header_file.output" 2>&1
+        check_file "$expected_results_dir/$header_file.output" "Cpp1 generation output file"
+        check_file "$expected_h" "generated Cpp1 header file"
+        check_file "${expected_h}pp" "generated Cpp1 header file"
+    fi
+
     ########
     # Check the generated code
     if [ -f "$expected_src" ]; then
@@ -280,14 +301,19 @@ for test_file in $tests; do
         
         # For some tests the binary needs to be placed in "$exec_out_dir"
         # For that reason the compilation is done directly in that dir
-        # The source is temporarily copied to avoid issues with bash paths in cl.exe
+        # The source is temporarily copied to avoid issues with bash paths in cl.exe,
+        # along with the test's .h and .hpp if it has them
         (cd $exec_out_dir; \
          cp ../../$expected_src $generated_cpp_name;
+         if [[ -f "../../$header_file" ]]; then cp ../../$expected_h ../../${expected_h}pp .; fi;
          $compiler_cmd"$test_bin" $regression_test_link_obj \
                         $generated_cpp_name \
                         > $generated_cpp_name.output 2>&1)
         compilation_result=$?
         rm $exec_out_dir/$generated_cpp_name
+        if [[ -f "$header_file" ]]; then
+            rm $exec_out_dir/$test_name.h $exec_out_dir/$test_name.hpp
+        fi
 
         if [ -f "$expected_src_compil_out" ]; then
             # Check for local compiler issues
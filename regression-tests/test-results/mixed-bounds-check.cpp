@@ -14,8 +14,6 @@
 
 #include <vector>
 
-#line 4 "mixed-bounds-check.cpp2"
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -12,9 +12,6 @@
 
 #line 1 "mixed-bounds-safety-with-assert-2.cpp2"
 
-#line 2 "mixed-bounds-safety-with-assert-2.cpp2"
-[[nodiscard]] auto main() -> int;
-
 #line 10 "mixed-bounds-safety-with-assert-2.cpp2"
 auto add_42_to_subrange(auto& rng, cpp2::impl::in<int> start, cpp2::impl::in<int> end) -> void;
 #line 23 "mixed-bounds-safety-with-assert-2.cpp2"
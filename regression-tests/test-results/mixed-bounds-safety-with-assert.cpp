@@ -12,9 +12,6 @@
 
 #line 1 "mixed-bounds-safety-with-assert.cpp2"
 
-#line 2 "mixed-bounds-safety-with-assert.cpp2"
-[[nodiscard]] auto main() -> int;
-
 #line 9 "mixed-bounds-safety-with-assert.cpp2"
 auto print_subrange(auto const& rng, cpp2::impl::in<int> start, cpp2::impl::in<int> end) -> void;
 #line 21 "mixed-bounds-safety-with-assert.cpp2"
@@ -15,14 +15,9 @@
 #include <algorithm>
 #include <vector>
 
-#line 5 "mixed-captures-in-expressions-and-postconditions.cpp2"
-[[nodiscard]] auto main() -> int;
-
 #line 17 "mixed-captures-in-expressions-and-postconditions.cpp2"
 extern std::vector<int> vec;
 
-auto insert_at(cpp2::impl::in<int> where, cpp2::impl::in<int> val) -> void;
-
 //=== Cpp2 function definitions =================================================
 
 #line 1 "mixed-captures-in-expressions-and-postconditions.cpp2"
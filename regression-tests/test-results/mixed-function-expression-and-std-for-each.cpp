@@ -17,8 +17,6 @@
 #include <algorithm>
 #include <iostream>
 
-#line 7 "mixed-function-expression-and-std-for-each.cpp2"
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
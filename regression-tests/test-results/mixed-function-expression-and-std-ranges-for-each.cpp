@@ -18,8 +18,6 @@
 #include <algorithm>
 #include <iostream>
 
-#line 8 "mixed-function-expression-and-std-ranges-for-each.cpp2"
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -15,9 +15,6 @@
 #include <string>
 #include <vector>
 
-#line 5 "mixed-initialization-safety-3.cpp2"
-[[nodiscard]] auto main() -> int;
-
 #line 16 "mixed-initialization-safety-3.cpp2"
 auto fill(
     cpp2::impl::out<std::string> x, 
@@ -0,0 +1,72 @@
+
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "mixed-interned-without-ordered.cpp2"
+
+#line 6 "mixed-interned-without-ordered.cpp2"
+class point;
+    
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "mixed-interned-without-ordered.cpp2"
+#include <iostream>
+#include <string>
+
+//  An @interned type with no <=>, in a file that doesn't import or
+//  include the whole standard library
+#line 6 "mixed-interned-without-ordered.cpp2"
+class point {
+    public: cpp2::i32 const x; 
+    public: cpp2::i32 const y; 
+
+    public: explicit point(cpp2::impl::in<cpp2::i32> a, cpp2::impl::in<cpp2::i32> b);
+    public: [[nodiscard]] auto hash() const& -> std::size_t;
+public: [[nodiscard]] auto operator==(point const& that) const& -> bool = default;
+public: using handle = cpp2::interned<point>;
+public: [[nodiscard]] auto intern() const& -> handle;
+
+
+#line 14 "mixed-interned-without-ordered.cpp2"
+};
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "mixed-interned-without-ordered.cpp2"
+
+#line 10 "mixed-interned-without-ordered.cpp2"
+    point::point(cpp2::impl::in<cpp2::i32> a, cpp2::impl::in<cpp2::i32> b)
+        : x{ a }
+        , y{ b }{
+
+#line 13 "mixed-interned-without-ordered.cpp2"
+    }
+
+    [[nodiscard]] auto point::hash() const& -> std::size_t{
+
+    std::size_t ret {0}; 
+    ret = cpp2::hash_combine(ret, x);
+    ret = cpp2::hash_combine(ret, y);
+    return ret; 
+    }
+
+
+
+    [[nodiscard]] auto point::intern() const& -> handle { return CPP2_UFCS(intern)(cpp2::intern_table<point,std::shared_mutex>::instance(), (*this)); }
+
+#line 16 "mixed-interned-without-ordered.cpp2"
+auto main() -> int{
+    auto p {CPP2_UFCS(intern)(point(1, 2))}; 
+    auto q {CPP2_UFCS(intern)(point(1, 2))}; 
+    auto r {CPP2_UFCS(intern)(point(2, 1))}; 
+
+    std::cout << ("p == q: " + cpp2::to_string(p == q) + ", p == r: " + cpp2::to_string(p == r) + "\n");
+    std::cout << (cpp2::to_string((*cpp2::impl::assert_not_null(p)).x) + "," + cpp2::to_string((*cpp2::impl::assert_not_null(p)).y) + " " + cpp2::to_string((*cpp2::impl::assert_not_null(r)).x) + "," + cpp2::to_string((*cpp2::impl::assert_not_null(r)).y) + "\n");
+    std::cout << ("same hash: " + cpp2::to_string(CPP2_UFCS(hash)(cpp2::move(p)) == CPP2_UFCS(hash)(cpp2::move(q))) + "\n");
+}
+
@@ -11,9 +11,6 @@
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "mixed-intro-for-with-counter-include-last.cpp2"
-
-#line 2 "mixed-intro-for-with-counter-include-last.cpp2"
-[[nodiscard]] auto main() -> int;
 #line 10 "mixed-intro-for-with-counter-include-last.cpp2"
 
 #include <vector>
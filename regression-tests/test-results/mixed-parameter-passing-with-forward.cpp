@@ -16,22 +16,6 @@
 #include <cstdlib>
 #include <ctime>
 
-#line 6 "mixed-parameter-passing-with-forward.cpp2"
-auto copy_from([[maybe_unused]] auto unnamed_param_1) -> void;
-
-auto parameter_styles(
-    [[maybe_unused]] cpp2::impl::in<std::string> unnamed_param_1, // "in" is default
-    std::string b, 
-    [[maybe_unused]] std::string& unnamed_param_3, 
-    std::string&& d, 
-    auto&& e
-    ) -> void
-CPP2_REQUIRES (std::is_same_v<std::string, CPP2_TYPEOF(e)>) 
-#line 8 "mixed-parameter-passing-with-forward.cpp2"
-;
-
-#line 42 "mixed-parameter-passing-with-forward.cpp2"
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -42,7 +26,7 @@ auto copy_from([[maybe_unused]] auto unnamed_param_1) -> void{}
 
 #line 8 "mixed-parameter-passing-with-forward.cpp2"
 auto parameter_styles(
-    [[maybe_unused]] cpp2::impl::in<std::string> unnamed_param_1, 
+    [[maybe_unused]] cpp2::impl::in<std::string> unnamed_param_1, // "in" is default
     std::string b, 
     [[maybe_unused]] std::string& unnamed_param_3, 
     std::string&& d, 
@@ -0,0 +1,42 @@
+
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "mixed-pimpl-header.cpp2"
+
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "mixed-pimpl-header.cpp2"
+
+//  Only the .h, with no data members
+#include "mixed-pimpl-header.h"
+#line 19 "mixed-pimpl-header.cpp2"
+
+//  The definitions, which one file of the program includes
+#include "mixed-pimpl-header.hpp"
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "mixed-pimpl-header.cpp2"
+
+#line 5 "mixed-pimpl-header.cpp2"
+auto main() -> int{
+    counter a {"a"}; 
+    CPP2_UFCS(add)(a, 1);
+    CPP2_UFCS(add)(a, 2);
+
+    auto b {a}; 
+    CPP2_UFCS(add)(b, 10);
+    std::cout << CPP2_UFCS(describe)(cpp2::move(a)) << "\n";
+    std::cout << CPP2_UFCS(describe)(b) << "\n";
+
+    auto c {cpp2::move(b)}; // last use, so this moves
+    CPP2_UFCS(add)(c, 100);
+    std::cout << CPP2_UFCS(describe)(cpp2::move(c)) << "\n";
+}
+
@@ -0,0 +1,46 @@
+
+#ifndef TEST_RESULTS_MIXED_PIMPL_HEADER_H_CPP2
+#define TEST_RESULTS_MIXED_PIMPL_HEADER_H_CPP2
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "mixed-pimpl-header.h2"
+
+#line 7 "mixed-pimpl-header.h2"
+class counter;
+
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "mixed-pimpl-header.h2"
+
+//  The data members and the function definitions go in the .hpp, so
+//  code that includes only the .h doesn't depend on them
+//
+//  @copyable comes first, so the operator= it adds copies the data
+//  members, and then @pimpl makes copying copy the implementation
+#line 7 "mixed-pimpl-header.h2"
+class counter {
+private: class _impl;
+public: explicit counter(cpp2::impl::in<std::string> n);
+
+public: auto operator=(cpp2::impl::in<std::string> n) -> counter& ;
+public: auto add(cpp2::impl::in<int> x) & -> void;
+public: [[nodiscard]] auto total() const& -> int;
+public: [[nodiscard]] auto describe() const& -> std::string;
+public: counter(counter const& that);
+public: auto operator=(counter const& that) -> counter& ;
+public: counter(counter&& that) noexcept;
+public: auto operator=(counter&& that) noexcept -> counter& ;
+public: ~counter() noexcept;
+private: std::unique_ptr<_impl> _pimpl {}; 
+#line 28 "mixed-pimpl-header.h2"
+};
+
+#endif
@@ -0,0 +1,85 @@
+
+#ifndef TEST_RESULTS_MIXED_PIMPL_HEADER_H_CPP2
+#error This file is part of a '.h2' header compiled to be consumed from another -pure-cpp2 file. To use this file, write '#include "test-results/mixed-pimpl-header.h2"' in a '.h2' or '.cpp2' file compiled with -pure-cpp2.
+#endif
+
+#ifndef TEST_RESULTS_MIXED_PIMPL_HEADER_HPP_CPP2
+#define TEST_RESULTS_MIXED_PIMPL_HEADER_HPP_CPP2
+
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "mixed-pimpl-header.h2"
+#line 11 "mixed-pimpl-header.h2"
+
+class counter::_impl {private: std::string name {}; private: std::vector<int> counts {}; public: explicit _impl(cpp2::impl::in<std::string> n);public: auto operator=(cpp2::impl::in<std::string> n) -> _impl& ;public: auto add(cpp2::impl::in<int> x) & -> void;public: [[nodiscard]] auto total() const& -> int;public: [[nodiscard]] auto describe() const& -> std::string;public: _impl(_impl const& that);public: auto operator=(_impl const& that) -> _impl& ;public: _impl(_impl&& that) noexcept;public: auto operator=(_impl&& that) noexcept -> _impl& ;};
+
+#line 11 "mixed-pimpl-header.h2"
+    counter::_impl::_impl(cpp2::impl::in<std::string> n)
+        : name{ n }{
+
+#line 13 "mixed-pimpl-header.h2"
+    }
+#line 11 "mixed-pimpl-header.h2"
+    auto counter::_impl::operator=(cpp2::impl::in<std::string> n) -> _impl& {
+        name = n;
+        counts = {};
+        return *this;
+
+#line 13 "mixed-pimpl-header.h2"
+    }
+
+#line 15 "mixed-pimpl-header.h2"
+    auto counter::_impl::add(cpp2::impl::in<int> x) & -> void{
+        CPP2_UFCS(push_back)(counts, x);
+    }
+
+#line 19 "mixed-pimpl-header.h2"
+    [[nodiscard]] auto counter::_impl::total() const& -> int{
+        auto sum {0}; 
+        for ( auto const& x : counts ) {
+            sum += x;
+        }
+        return sum; 
+    }
+
+#line 27 "mixed-pimpl-header.h2"
+    [[nodiscard]] auto counter::_impl::describe() const& -> std::string { return name + ": " + std::to_string(CPP2_UFCS(ssize)(counts)) + " counts, total " + std::to_string(total());  }
+
+    counter::_impl::_impl(_impl const& that)
+                                : name{ that.name }
+                                , counts{ that.counts }{}
+
+auto counter::_impl::operator=(_impl const& that) -> _impl& {
+                                name = that.name;
+                                counts = that.counts;
+                                return *this;}
+counter::_impl::_impl(_impl&& that) noexcept
+                                : name{ std::move(that).name }
+                                , counts{ std::move(that).counts }{}
+auto counter::_impl::operator=(_impl&& that) noexcept -> _impl& {
+                                name = std::move(that).name;
+                                counts = std::move(that).counts;
+                                return *this;}
+counter::counter(cpp2::impl::in<std::string> n)
+                                                  : _pimpl{ CPP2_UFCS_TEMPLATE_NONLOCAL(cpp2_new<_impl>)(cpp2::unique, n) }{}
+auto counter::operator=(cpp2::impl::in<std::string> n) -> counter& {
+                                                  _pimpl = CPP2_UFCS_TEMPLATE_NONLOCAL(cpp2_new<_impl>)(cpp2::unique, n);
+                                                  return *this;}
+auto counter::add(cpp2::impl::in<int> x) & -> void { CPP2_UFCS(add)((*cpp2::impl::assert_not_null(_pimpl)), x); }
+[[nodiscard]] auto counter::total() const& -> int { return CPP2_UFCS(total)((*cpp2::impl::assert_not_null(_pimpl))); }
+[[nodiscard]] auto counter::describe() const& -> std::string { return CPP2_UFCS(describe)((*cpp2::impl::assert_not_null(_pimpl))); }
+counter::counter(counter const& that)
+                                        : _pimpl{ CPP2_UFCS_TEMPLATE_NONLOCAL(cpp2_new<_impl>)(cpp2::unique, *cpp2::impl::assert_not_null(that._pimpl)) }{}
+auto counter::operator=(counter const& that) -> counter& {
+                                        _pimpl = CPP2_UFCS_TEMPLATE_NONLOCAL(cpp2_new<_impl>)(cpp2::unique, *cpp2::impl::assert_not_null(that._pimpl));
+                                        return *this;}
+counter::counter(counter&& that) noexcept
+                                         : _pimpl{ cpp2::move(that)._pimpl }{}
+auto counter::operator=(counter&& that) noexcept -> counter& {
+                                         _pimpl = cpp2::move(that)._pimpl;
+                                         return *this;}
+counter::~counter() noexcept{}
+
+#endif
@@ -18,9 +18,6 @@
 #include <algorithm>
 #include <iostream>
 
-#line 8 "mixed-postexpression-with-capture.cpp2"
-[[nodiscard]] auto main() -> int;
-
 #line 14 "mixed-postexpression-with-capture.cpp2"
 extern std::vector<int> vec;
 
@@ -0,0 +1,73 @@
+
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "mixed-string-view-params-address-taken.cpp2"
+
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "mixed-string-view-params-address-taken.cpp2"
+#include <iostream>
+#include <string>
+#include <vector>
+
+//  With -string-view-params, a function whose name is used other than
+//  to call it directly keeps its signature, because that use could
+//  depend on it
+
+#line 9 "mixed-string-view-params-address-taken.cpp2"
+[[nodiscard]] auto is_key(cpp2::impl::in<std::string> s) -> bool;
+[[nodiscard]] auto has_digit(cpp2::impl::in<std::string> s) -> bool;
+[[nodiscard]] auto ends_in_x(cpp2::impl::in<std::string> s) -> bool;
+
+//  Its address is taken, then it's called through the pointer
+[[nodiscard]] auto count_digits(cpp2::impl::in<std::vector<std::string>> words) -> int;
+
+#line 23 "mixed-string-view-params-address-taken.cpp2"
+//  It's called as a member, through UFCS
+[[nodiscard]] auto count_x(cpp2::impl::in<std::vector<std::string>> words) -> int;
+#line 31 "mixed-string-view-params-address-taken.cpp2"
+
+auto main() -> int {
+    //  Its address is taken as a Cpp1 function pointer of the exact type
+    bool (*p)(std::string const&) = &is_key;
+    std::cout << std::boolalpha << p("key1") << "\n";
+    std::cout << count_digits({"a1", "b", "c3"}) << "\n";
+    std::cout << count_x({"box", "fox", "cat"}) << "\n";
+}
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "mixed-string-view-params-address-taken.cpp2"
+
+#line 9 "mixed-string-view-params-address-taken.cpp2"
+[[nodiscard]] auto is_key(cpp2::impl::in<std::string> s) -> bool { return CPP2_UFCS(starts_with)(s, "key");  }
+#line 10 "mixed-string-view-params-address-taken.cpp2"
+[[nodiscard]] auto has_digit(cpp2::impl::in<std::string> s) -> bool { return CPP2_UFCS(find_first_of)(s, "0123456789") != std::string::npos;  }
+#line 11 "mixed-string-view-params-address-taken.cpp2"
+[[nodiscard]] auto ends_in_x(cpp2::impl::in<std::string> s) -> bool { return CPP2_UFCS(ends_with)(s, "x");  }
+
+#line 14 "mixed-string-view-params-address-taken.cpp2"
+[[nodiscard]] auto count_digits(cpp2::impl::in<std::vector<std::string>> words) -> int{
+    auto pred {&has_digit}; 
+    auto count {0}; 
+    for ( auto const& w : words ) {
+        if (pred(w)) {++count; }
+    }
+    return count; 
+}
+
+#line 24 "mixed-string-view-params-address-taken.cpp2"
+[[nodiscard]] auto count_x(cpp2::impl::in<std::vector<std::string>> words) -> int{
+    auto count {0}; 
+    for ( auto const& w : words ) {
+        if (CPP2_UFCS(ends_in_x)(w)) {++count; }
+    }
+    return count; 
+}
+
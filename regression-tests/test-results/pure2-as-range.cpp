@@ -0,0 +1,99 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#ifndef __cpp_lib_modules
+#ifdef __cpp_lib_print
+    #include <print>
+#endif
+#include <ranges>
+#endif
+
+#line 1 "pure2-as-range.cpp2"
+
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-as-range.cpp2"
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-as-range.cpp2"
+auto main() -> int{
+#line 2 "pure2-as-range.cpp2"
+    CPP2_UFCS(set_handler)(cpp2::type_safety, [](char const* msg) mutable -> void { std::cout << ("type_safety violation: " + cpp2::to_string(msg) + "\n");  });
+    CPP2_UFCS(set_handler)(cpp2::bounds_safety, [](char const* msg) mutable -> void { std::cout << ("bounds_safety violation: " + cpp2::to_string(msg) + "\n");  });
+
+    auto print {[](auto const& v) mutable -> void{
+        for ( auto const& x : v ) {std::cout << x << " "; }
+        std::cout << "\n";
+    }}; 
+
+    //  Narrowing integers
+    std::vector<cpp2::i64> big {1, -2, 3, 2'147'483'647, -2'147'483'648}; 
+    std::vector<cpp2::i32> small {}; 
+    CPP2_UFCS(resize)(small, CPP2_UFCS(size)(big));
+    cpp2::as_range<cpp2::i32>(big, small);
+    print(small);
+
+    //  ... with a value out of range: the values before it are still converted
+    static_cast<void>(CPP2_UFCS(insert)(big, CPP2_UFCS(begin)(big) + 2, 2'147'483'648));
+    CPP2_UFCS(resize)(small, CPP2_UFCS(size)(big));
+    std::ranges::fill(small, 0);
+    cpp2::as_range<cpp2::i32>(cpp2::move(big), small);
+    print(cpp2::move(small));
+
+    //  Narrowing floating point, via spans
+    std::vector<double> d {1.5, -2.25, 4.0}; 
+    std::vector<float> f {}; 
+    CPP2_UFCS(resize)(f, CPP2_UFCS(size)(d));
+    cpp2::as_range<float>(std::span<double const>(d), std::span<float>(f));
+    print(f);
+
+    CPP2_UFCS(push_back)(d, 1e300);
+    CPP2_UFCS(push_back)(d, std::numeric_limits<double>::infinity());
+    CPP2_UFCS(resize)(f, CPP2_UFCS(size)(d));
+    cpp2::as_range<float>(cpp2::move(d), cpp2::move(f));
+
+    //  Widening is never checked
+    std::vector<cpp2::u16> u {0, 1, 65535}; 
+    std::vector<float> fu {}; 
+    CPP2_UFCS(resize)(fu, CPP2_UFCS(size)(u));
+    cpp2::as_range<float>(cpp2::move(u), fu);
+    cpp2::move(print)(cpp2::move(fu));
+
+    //  Floating point to integer, including NaN
+    std::vector<double> n {0.0, 255.9, 256.0}; 
+    std::vector<cpp2::u8> nu {}; 
+    CPP2_UFCS(resize)(nu, CPP2_UFCS(size)(n));
+    cpp2::as_range<cpp2::u8>(n, nu);
+    std::cout << (cpp2::impl::as_<int>(CPP2_ASSERT_IN_BOUNDS_LITERAL(nu, 1))) << "\n";
+    n = { 0.0, std::numeric_limits<double>::quiet_NaN() };
+    cpp2::as_range<cpp2::u8>(cpp2::move(n), cpp2::move(nu));
+
+    //  Signed to unsigned
+    std::vector<cpp2::i32> s {1, 2, -1}; 
+    std::vector<cpp2::u32> su {}; 
+    CPP2_UFCS(resize)(su, CPP2_UFCS(size)(s));
+    cpp2::as_range<cpp2::u32>(s, su);
+
+    //  A value out of range past the first block
+    std::vector<cpp2::i64> many {}; 
+    CPP2_UFCS(resize)(many, 3000, 7);
+    CPP2_ASSERT_IN_BOUNDS_LITERAL(many, 2500) = -1;
+    std::vector<cpp2::u8> many_out {}; 
+    CPP2_UFCS(resize)(many_out, CPP2_UFCS(size)(many));
+    cpp2::as_range<cpp2::u8>(cpp2::move(many), many_out);
+    std::cout << (cpp2::impl::as_<int>(CPP2_ASSERT_IN_BOUNDS_LITERAL(many_out, 2499))) << " " << (cpp2::impl::as_<int>(CPP2_ASSERT_IN_BOUNDS_LITERAL(many_out, 2500))) << "\n";
+
+    //  Target too small
+    CPP2_UFCS(resize)(su, 2);
+    cpp2::as_range<cpp2::u32>(cpp2::move(s), cpp2::move(su));
+}
+
@@ -1,11 +1,16 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <cstdlib>
+#endif
+
 #line 1 "pure2-assert-expected-not-null.cpp2"
 
 
@@ -13,14 +18,6 @@
 
 #line 1 "pure2-assert-expected-not-null.cpp2"
 
-#line 2 "pure2-assert-expected-not-null.cpp2"
-[[nodiscard]] auto fine() -> int;
-
-#line 12 "pure2-assert-expected-not-null.cpp2"
-[[nodiscard]] auto bad_expected_access() -> int;
-
-#line 18 "pure2-assert-expected-not-null.cpp2"
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -0,0 +1,206 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#ifndef __cpp_lib_modules
+#include <array>
+#endif
+
+#line 1 "pure2-bitpacked.cpp2"
+
+#line 2 "pure2-bitpacked.cpp2"
+class record;
+    
+
+#line 9 "pure2-bitpacked.cpp2"
+class wide;
+    
+
+#line 15 "pure2-bitpacked.cpp2"
+class flags;
+
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-bitpacked.cpp2"
+
+#line 2 "pure2-bitpacked.cpp2"
+class record {
+private: cpp2::u32 _bits {134217728u}; public: [[nodiscard]] constexpr auto dirty() const& -> bool;
+public: constexpr auto set_dirty(cpp2::impl::in<bool> value) & -> void;
+public: [[nodiscard]] constexpr auto kind() const& -> cpp2::bits<3>;
+public: constexpr auto set_kind(cpp2::impl::in<cpp2::bits<3>> value) & -> void;
+public: [[nodiscard]] constexpr auto delta() const& -> cpp2::signed_bits<5>;
+public: constexpr auto set_delta(cpp2::impl::in<cpp2::signed_bits<5>> value) & -> void;
+public: [[nodiscard]] constexpr auto count() const& -> cpp2::bits<12>;
+public: constexpr auto set_count(cpp2::impl::in<cpp2::bits<12>> value) & -> void;
+public: explicit record();
+public: record(record const& that);
+
+public: auto operator=(record const& that) -> record& ;
+public: record(record&& that) noexcept;
+public: auto operator=(record&& that) noexcept -> record& ;
+public: [[nodiscard]] auto operator<=>(record const& that) const& -> std::strong_ordering;
+public: [[nodiscard]] auto operator==(record const& that) const& -> bool;
+
+#line 7 "pure2-bitpacked.cpp2"
+};
+
+class wide {
+private: std::array<cpp2::u64,2> _bits {0u, 9223372036854775808u}; public: [[nodiscard]] constexpr auto a() const& -> cpp2::bits<40>;
+public: constexpr auto set_a(cpp2::impl::in<cpp2::bits<40>> value) & -> void;
+public: [[nodiscard]] constexpr auto b() const& -> cpp2::signed_bits<40>;
+public: constexpr auto set_b(cpp2::impl::in<cpp2::signed_bits<40>> value) & -> void;
+public: [[nodiscard]] constexpr auto c() const& -> bool;
+public: constexpr auto set_c(cpp2::impl::in<bool> value) & -> void;
+public: explicit wide();
+public: wide(wide const& that);
+
+public: auto operator=(wide const& that) -> wide& ;
+public: wide(wide&& that) noexcept;
+public: auto operator=(wide&& that) noexcept -> wide& ;
+public: [[nodiscard]] auto operator<=>(wide const& that) const& -> std::strong_ordering;
+public: [[nodiscard]] auto operator==(wide const& that) const& -> bool;
+
+#line 13 "pure2-bitpacked.cpp2"
+};
+
+class flags {
+private: cpp2::u8 _bits {8u}; public: [[nodiscard]] constexpr auto k() const& -> cpp2::bits<3>;
+public: constexpr auto set_k(cpp2::impl::in<cpp2::bits<3>> value) & -> void;
+public: [[nodiscard]] constexpr auto flag() const& -> cpp2::bits<1>;
+public: constexpr auto set_flag(cpp2::impl::in<cpp2::bits<1>> value) & -> void;
+public: [[nodiscard]] constexpr auto sflag() const& -> cpp2::signed_bits<1>;
+public: constexpr auto set_sflag(cpp2::impl::in<cpp2::signed_bits<1>> value) & -> void;
+public: [[nodiscard]] constexpr auto next() const& -> cpp2::bits<3>;
+public: constexpr auto set_next(cpp2::impl::in<cpp2::bits<3>> value) & -> void;
+public: explicit flags();
+public: flags(flags const& that);
+
+public: auto operator=(flags const& that) -> flags& ;
+public: flags(flags&& that) noexcept;
+public: auto operator=(flags&& that) noexcept -> flags& ;
+public: [[nodiscard]] auto operator<=>(flags const& that) const& -> std::strong_ordering;
+public: [[nodiscard]] auto operator==(flags const& that) const& -> bool;
+
+#line 20 "pure2-bitpacked.cpp2"
+};
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-bitpacked.cpp2"
+
+#line 1 "pure2-bitpacked.cpp2"
+
+[[nodiscard]] constexpr auto record::dirty() const& -> bool { return ((cpp2::impl::as_<cpp2::u64>(_bits) >> 31u) & 1u) != 0u; }
+constexpr auto record::set_dirty(cpp2::impl::in<bool> value) & -> void{_bits = cpp2::unsafe_narrow<cpp2::u32>((cpp2::impl::as_<cpp2::u64>(_bits) & 18446744071562067967u) | (cpp2::unsafe_narrow<cpp2::u64>(value) << 31u));}
+[[nodiscard]] constexpr auto record::kind() const& -> cpp2::bits<3> { return cpp2::unsafe_narrow<cpp2::bits<3>>(((cpp2::impl::as_<cpp2::u64>(_bits) >> 28u) & 7u)); }
+constexpr auto record::set_kind(cpp2::impl::in<cpp2::bits<3>> value) & -> void{
+                                                                                                                                                 if (cpp2::type_safety.is_active() && !(cpp2::impl::cmp_less_eq(value,7u)) ) { cpp2::type_safety.report_violation(CPP2_CONTRACT_MSG("value is out of range for the 3-bit member 'kind'")); }_bits = cpp2::unsafe_narrow<cpp2::u32>((cpp2::impl::as_<cpp2::u64>(_bits) & 18446744071830503423u) | (((cpp2::impl::as_<cpp2::u64>(value)) & 7u) << 28u));}
+[[nodiscard]] constexpr auto record::delta() const& -> cpp2::signed_bits<5> { return cpp2::unsafe_narrow<cpp2::signed_bits<5>>(cpp2::unsafe_narrow<cpp2::i64>(((cpp2::impl::as_<cpp2::u64>(_bits) >> 23u) & 31u) - 16u)); }
+constexpr auto record::set_delta(cpp2::impl::in<cpp2::signed_bits<5>> value) & -> void{
+                                                                                                                                                                                 if (cpp2::type_safety.is_active() && !(cpp2::impl::cmp_less_eq(-16,value) && cpp2::impl::cmp_less_eq(value,15)) ) { cpp2::type_safety.report_violation(CPP2_CONTRACT_MSG("value is out of range for the 5-bit signed member 'delta'")); }_bits = cpp2::unsafe_narrow<cpp2::u32>((cpp2::impl::as_<cpp2::u64>(_bits) & 18446744073449504767u) | (((cpp2::unsafe_narrow<cpp2::u64>(value) + 16u) & 31u) << 23u));}
+[[nodiscard]] constexpr auto record::count() const& -> cpp2::bits<12> { return cpp2::unsafe_narrow<cpp2::bits<12>>(((cpp2::impl::as_<cpp2::u64>(_bits) >> 11u) & 4095u)); }
+constexpr auto record::set_count(cpp2::impl::in<cpp2::bits<12>> value) & -> void{
+                                                                                                                                                        if (cpp2::type_safety.is_active() && !(cpp2::impl::cmp_less_eq(value,4095u)) ) { cpp2::type_safety.report_violation(CPP2_CONTRACT_MSG("value is out of range for the 12-bit member 'count'")); }_bits = cpp2::unsafe_narrow<cpp2::u32>((cpp2::impl::as_<cpp2::u64>(_bits) & 18446744073701165055u) | (((cpp2::impl::as_<cpp2::u64>(value)) & 4095u) << 11u));}
+record::record(){set_dirty(true);set_delta(-3);set_count(100);}
+record::record(record const& that)
+                                : _bits{ that._bits }{}
+auto record::operator=(record const& that) -> record& {
+                                _bits = that._bits;
+                                return *this;}
+record::record(record&& that) noexcept
+                                : _bits{ std::move(that)._bits }{}
+auto record::operator=(record&& that) noexcept -> record& {
+                                _bits = std::move(that)._bits;
+                                return *this;}
+[[nodiscard]] auto record::operator<=>(record const& that) const& -> std::strong_ordering { return _bits <=> that._bits; }
+[[nodiscard]] auto record::operator==(record const& that) const& -> bool { return _bits == that._bits; }
+[[nodiscard]] constexpr auto wide::a() const& -> cpp2::bits<40> { return cpp2::unsafe_narrow<cpp2::bits<40>>(((cpp2::impl::as_<cpp2::u64>(std::get<0>(_bits)) >> 24u) & 1099511627775u)); }
+constexpr auto wide::set_a(cpp2::impl::in<cpp2::bits<40>> value) & -> void{
+                                                                                                                                                         if (cpp2::type_safety.is_active() && !(cpp2::impl::cmp_less_eq(value,1099511627775u)) ) { cpp2::type_safety.report_violation(CPP2_CONTRACT_MSG("value is out of range for the 40-bit member 'a'")); }std::get<0>(_bits) = cpp2::unsafe_narrow<cpp2::u64>((cpp2::impl::as_<cpp2::u64>(std::get<0>(_bits)) & 16777215u) | (((cpp2::impl::as_<cpp2::u64>(value)) & 1099511627775u) << 24u));}
+[[nodiscard]] constexpr auto wide::b() const& -> cpp2::signed_bits<40> { return cpp2::unsafe_narrow<cpp2::signed_bits<40>>(cpp2::unsafe_narrow<cpp2::i64>(((cpp2::impl::as_<cpp2::u64>(std::get<1>(_bits)) >> 24u) & 1099511627775u) - 549755813888u)); }
+constexpr auto wide::set_b(cpp2::impl::in<cpp2::signed_bits<40>> value) & -> void{
+                                                                                                                                                                                               if (cpp2::type_safety.is_active() && !(cpp2::impl::cmp_less_eq(-549755813888,value) && cpp2::impl::cmp_less_eq(value,549755813887)) ) { cpp2::type_safety.report_violation(CPP2_CONTRACT_MSG("value is out of range for the 40-bit signed member 'b'")); }std::get<1>(_bits) = cpp2::unsafe_narrow<cpp2::u64>((cpp2::impl::as_<cpp2::u64>(std::get<1>(_bits)) & 16777215u) | (((cpp2::unsafe_narrow<cpp2::u64>(value) + 549755813888u) & 1099511627775u) << 24u));}
+[[nodiscard]] constexpr auto wide::c() const& -> bool { return ((cpp2::impl::as_<cpp2::u64>(std::get<1>(_bits)) >> 23u) & 1u) != 0u; }
+constexpr auto wide::set_c(cpp2::impl::in<bool> value) & -> void{std::get<1>(_bits) = cpp2::unsafe_narrow<cpp2::u64>((cpp2::impl::as_<cpp2::u64>(std::get<1>(_bits)) & 18446744073701163007u) | (cpp2::unsafe_narrow<cpp2::u64>(value) << 23u));}
+wide::wide(){}
+wide::wide(wide const& that)
+                                : _bits{ that._bits }{}
+auto wide::operator=(wide const& that) -> wide& {
+                                _bits = that._bits;
+                                return *this;}
+wide::wide(wide&& that) noexcept
+                                : _bits{ std::move(that)._bits }{}
+auto wide::operator=(wide&& that) noexcept -> wide& {
+                                _bits = std::move(that)._bits;
+                                return *this;}
+[[nodiscard]] auto wide::operator<=>(wide const& that) const& -> std::strong_ordering { return _bits <=> that._bits; }
+[[nodiscard]] auto wide::operator==(wide const& that) const& -> bool { return _bits == that._bits; }
+[[nodiscard]] constexpr auto flags::k() const& -> cpp2::bits<3> { return cpp2::unsafe_narrow<cpp2::bits<3>>(((cpp2::impl::as_<cpp2::u64>(_bits) >> 5u) & 7u)); }
+constexpr auto flags::set_k(cpp2::impl::in<cpp2::bits<3>> value) & -> void{
+                                                                                                                                           if (cpp2::type_safety.is_active() && !(cpp2::impl::cmp_less_eq(value,7u)) ) { cpp2::type_safety.report_violation(CPP2_CONTRACT_MSG("value is out of range for the 3-bit member 'k'")); }_bits = cpp2::unsafe_narrow<cpp2::u8>((cpp2::impl::as_<cpp2::u64>(_bits) & 18446744073709551391u) | (((cpp2::impl::as_<cpp2::u64>(value)) & 7u) << 5u));}
+[[nodiscard]] constexpr auto flags::flag() const& -> cpp2::bits<1> { return cpp2::unsafe_narrow<cpp2::bits<1>>(((cpp2::impl::as_<cpp2::u64>(_bits) >> 4u) & 1u)); }
+constexpr auto flags::set_flag(cpp2::impl::in<cpp2::bits<1>> value) & -> void{
+                                                                                                                                                 if (cpp2::type_safety.is_active() && !(cpp2::impl::cmp_less_eq(value,1u)) ) { cpp2::type_safety.report_violation(CPP2_CONTRACT_MSG("value is out of range for the 1-bit member 'flag'")); }_bits = cpp2::unsafe_narrow<cpp2::u8>((cpp2::impl::as_<cpp2::u64>(_bits) & 18446744073709551599u) | (((cpp2::impl::as_<cpp2::u64>(value)) & 1u) << 4u));}
+[[nodiscard]] constexpr auto flags::sflag() const& -> cpp2::signed_bits<1> { return cpp2::unsafe_narrow<cpp2::signed_bits<1>>(cpp2::unsafe_narrow<cpp2::i64>(((cpp2::impl::as_<cpp2::u64>(_bits) >> 3u) & 1u) - 1u)); }
+constexpr auto flags::set_sflag(cpp2::impl::in<cpp2::signed_bits<1>> value) & -> void{
+                                                                                                                                                                               if (cpp2::type_safety.is_active() && !(cpp2::impl::cmp_less_eq(-1,value) && cpp2::impl::cmp_less_eq(value,0)) ) { cpp2::type_safety.report_violation(CPP2_CONTRACT_MSG("value is out of range for the 1-bit signed member 'sflag'")); }_bits = cpp2::unsafe_narrow<cpp2::u8>((cpp2::impl::as_<cpp2::u64>(_bits) & 18446744073709551607u) | (((cpp2::unsafe_narrow<cpp2::u64>(value) + 1u) & 1u) << 3u));}
+[[nodiscard]] constexpr auto flags::next() const& -> cpp2::bits<3> { return cpp2::unsafe_narrow<cpp2::bits<3>>(((cpp2::impl::as_<cpp2::u64>(_bits) >> 0u) & 7u)); }
+constexpr auto flags::set_next(cpp2::impl::in<cpp2::bits<3>> value) & -> void{
+                                                                                                                                                 if (cpp2::type_safety.is_active() && !(cpp2::impl::cmp_less_eq(value,7u)) ) { cpp2::type_safety.report_violation(CPP2_CONTRACT_MSG("value is out of range for the 3-bit member 'next'")); }_bits = cpp2::unsafe_narrow<cpp2::u8>((cpp2::impl::as_<cpp2::u64>(_bits) & 18446744073709551608u) | (((cpp2::impl::as_<cpp2::u64>(value)) & 7u) << 0u));}
+flags::flags(){}
+flags::flags(flags const& that)
+                                : _bits{ that._bits }{}
+auto flags::operator=(flags const& that) -> flags& {
+                                _bits = that._bits;
+                                return *this;}
+flags::flags(flags&& that) noexcept
+                                : _bits{ std::move(that)._bits }{}
+auto flags::operator=(flags&& that) noexcept -> flags& {
+                                _bits = std::move(that)._bits;
+                                return *this;}
+[[nodiscard]] auto flags::operator<=>(flags const& that) const& -> std::strong_ordering { return _bits <=> that._bits; }
+[[nodiscard]] auto flags::operator==(flags const& that) const& -> bool { return _bits == that._bits; }
+#line 22 "pure2-bitpacked.cpp2"
+auto main() -> int{
+    CPP2_UFCS(set_handler)(cpp2::type_safety, [](char const* msg) mutable -> void { std::cout << ("type_safety violation: " + cpp2::to_string(msg) + "\n");  });
+
+    record r {}; 
+    std::cout << ("sizeof(record) is " + cpp2::to_string(sizeof(record)) + "\n");
+    std::cout << ("dirty " + cpp2::to_string(CPP2_UFCS(dirty)(r)) + ", kind " + cpp2::to_string(CPP2_UFCS(kind)(r)) + ", delta " + cpp2::to_string(CPP2_UFCS(delta)(r)) + ", count " + cpp2::to_string(CPP2_UFCS(count)(r)) + "\n");
+
+    CPP2_UFCS(set_dirty)(r, false);
+    CPP2_UFCS(set_kind)(r, 7u);
+    CPP2_UFCS(set_delta)(r, -16);
+    CPP2_UFCS(set_count)(r, 4095u);
+    std::cout << ("dirty " + cpp2::to_string(CPP2_UFCS(dirty)(r)) + ", kind " + cpp2::to_string(CPP2_UFCS(kind)(r)) + ", delta " + cpp2::to_string(CPP2_UFCS(delta)(r)) + ", count " + cpp2::to_string(CPP2_UFCS(count)(r)) + "\n");
+
+    //  Comparing compares the members in declaration order
+    auto s {r}; 
+    CPP2_UFCS(set_delta)(s, 15);
+    std::cout << ("r == r: " + cpp2::to_string(r == r) + ", r < s: " + cpp2::to_string(cpp2::impl::cmp_less(r,s)) + ", s.kind() == r.kind(): " + cpp2::to_string(CPP2_UFCS(kind)(s) == CPP2_UFCS(kind)(r)) + "\n");
+
+    wide w {}; 
+    CPP2_UFCS(set_a)(w, 1099511627775u);
+    CPP2_UFCS(set_b)(w, -549755813888);
+    CPP2_UFCS(set_c)(w, true);
+    std::cout << ("sizeof(wide) is " + cpp2::to_string(sizeof(wide)) + ": " + cpp2::to_string(CPP2_UFCS(a)(w)) + " " + cpp2::to_string(CPP2_UFCS(b)(w)) + " " + cpp2::to_string(CPP2_UFCS(c)(w)) + "\n");
+
+    //  A 1-bit member is range-checked, and an out-of-range value can't
+    //  spill into its neighbours
+    flags f {}; 
+    CPP2_UFCS(set_flag)(f, 1u);
+    CPP2_UFCS(set_sflag)(f, -1);
+    std::cout << ("k " + cpp2::to_string(CPP2_UFCS(k)(f)) + ", flag " + cpp2::to_string(CPP2_UFCS(flag)(f)) + ", sflag " + cpp2::to_string(CPP2_UFCS(sflag)(f)) + ", next " + cpp2::to_string(CPP2_UFCS(next)(f)) + "\n");
+    CPP2_UFCS(set_flag)(f, 3u);
+    CPP2_UFCS(set_sflag)(f, 1);
+    std::cout << ("k " + cpp2::to_string(CPP2_UFCS(k)(f)) + ", flag " + cpp2::to_string(CPP2_UFCS(flag)(f)) + ", sflag " + cpp2::to_string(CPP2_UFCS(sflag)(f)) + ", next " + cpp2::to_string(CPP2_UFCS(next)(f)) + "\n");
+}
+
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -13,9 +14,6 @@
 
 #line 1 "pure2-bounds-safety-span.cpp2"
 
-#line 2 "pure2-bounds-safety-span.cpp2"
-[[nodiscard]] auto main() -> int;
-
 #line 15 "pure2-bounds-safety-span.cpp2"
 auto print_and_decorate(auto const& thing) -> void;
 #line 17 "pure2-bounds-safety-span.cpp2"
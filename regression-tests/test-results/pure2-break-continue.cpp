@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -13,9 +14,6 @@
 
 #line 1 "pure2-break-continue.cpp2"
 
-#line 2 "pure2-break-continue.cpp2"
-[[nodiscard]] auto main() -> int;
-
 #line 20 "pure2-break-continue.cpp2"
 auto while_continue_inner() -> void;
 
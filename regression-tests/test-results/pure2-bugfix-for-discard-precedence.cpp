@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -27,7 +28,6 @@ class quantity {
 #line 5 "pure2-bugfix-for-discard-precedence.cpp2"
 };
 
-auto main(int const argc_, char** argv_) -> int;
 
 //=== Cpp2 function definitions =================================================
 
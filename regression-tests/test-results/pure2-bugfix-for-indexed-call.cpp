@@ -1,20 +1,23 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <array>
+#endif
+
 #line 1 "pure2-bugfix-for-indexed-call.cpp2"
 
 
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-bugfix-for-indexed-call.cpp2"
-auto f([[maybe_unused]] cpp2::impl::in<cpp2::i32> unnamed_param_1) -> void;
-#line 2 "pure2-bugfix-for-indexed-call.cpp2"
-auto main() -> int;
+
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -14,7 +15,7 @@
 #line 1 "pure2-bugfix-for-max-munch.cpp2"
 template<typename T> auto inline constexpr v = 0;
 #line 2 "pure2-bugfix-for-max-munch.cpp2"
-auto main() -> int;
+
 
 //=== Cpp2 function definitions =================================================
 
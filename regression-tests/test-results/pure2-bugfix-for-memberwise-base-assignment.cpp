@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -40,7 +41,6 @@ class Derived: public Base {
   public: auto operator=(Derived&& that) noexcept -> Derived& ;
 };
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -14,10 +15,7 @@
 #line 1 "pure2-bugfix-for-name-lookup-and-value-decoration.cpp2"
 
 using vals_ret = int;
-[[nodiscard]] auto vals() -> vals_ret;
-
-#line 6 "pure2-bugfix-for-name-lookup-and-value-decoration.cpp2"
-[[nodiscard]] auto main() -> int;
+#line 1 "pure2-bugfix-for-name-lookup-and-value-decoration.cpp2"
 
 //=== Cpp2 function definitions =================================================
 
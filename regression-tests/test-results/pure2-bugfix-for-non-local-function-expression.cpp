@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -28,7 +29,6 @@ class t: public std::type_identity_t<decltype([]() mutable -> void{})> {
 
 };
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
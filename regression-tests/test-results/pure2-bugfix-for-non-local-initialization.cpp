@@ -1,11 +1,16 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <array>
+#endif
+
 #line 1 "pure2-bugfix-for-non-local-initialization.cpp2"
 
 #line 2 "pure2-bugfix-for-non-local-initialization.cpp2"
@@ -20,7 +25,7 @@ using u = std::array<cpp2::i32,2>;
 class t: public std::integral_constant<u,u{17, 29}> {
 
 };
-auto main() -> int;
+
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -13,8 +14,6 @@
 
 #line 1 "pure2-bugfix-for-optional-template-argument-list.cpp2"
 extern std::plus<> const plus;
-#line 2 "pure2-bugfix-for-optional-template-argument-list.cpp2"
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -27,7 +28,7 @@ CPP2_REQUIRES_ (std::is_same_v<std::string, CPP2_TYPEOF(n)>) ;
 
 #line 4 "pure2-bugfix-for-requires-clause-in-forward-declaration.cpp2"
 };
-auto main() -> int;
+
 
 //=== Cpp2 function definitions =================================================
 
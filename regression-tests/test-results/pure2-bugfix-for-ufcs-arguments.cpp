@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -62,8 +63,6 @@ extern cpp2::i32 auto_16;
 extern cpp2::i32 auto_17;
 extern cpp2::i32 auto_18;
 
-auto main() -> int;
-
 #line 55 "pure2-bugfix-for-ufcs-arguments.cpp2"
 // _: i32 = 0.std::min<int>(0);
 extern cpp2::i32 auto_19;
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -41,12 +42,6 @@ namespace ns {
 [[nodiscard]] constexpr auto f([[maybe_unused]] auto const& unnamed_param_1) -> int;
 } // namespace ns
 
-// v: @struct type = {
-//   f :== :(_) 0; // Pending on #706.
-//   g: (i) i.f();
-// }
-
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -64,6 +59,11 @@ namespace ns {
 [[nodiscard]] constexpr auto f([[maybe_unused]] auto const& unnamed_param_1) -> int { return 1;  }
 }
 
+// v: @struct type = {
+//   f :== :(_) 0; // Pending on #706.
+//   g: (i) i.f();
+// }
+
 #line 20 "pure2-bugfix-for-ufcs-name-lookup.cpp2"
 auto main() -> int{
   {
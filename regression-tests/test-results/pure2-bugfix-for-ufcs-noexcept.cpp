@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -23,7 +24,7 @@ class t {
 
 #line 3 "pure2-bugfix-for-ufcs-noexcept.cpp2"
 };
-auto main() -> int;
+
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -15,7 +16,6 @@ class B;
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-bugfix-for-ufcs-sfinae.cpp2"
-template<typename T> [[nodiscard]] auto f() -> std::type_identity_t<decltype(CPP2_UFCS_NONLOCAL(a)(T()))>;
 
 #line 3 "pure2-bugfix-for-ufcs-sfinae.cpp2"
 class B {
@@ -25,7 +25,6 @@ class B {
 };
 #line 4 "pure2-bugfix-for-ufcs-sfinae.cpp2"
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
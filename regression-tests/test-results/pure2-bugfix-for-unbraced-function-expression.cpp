@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -24,8 +25,6 @@ class t {
 #line 3 "pure2-bugfix-for-unbraced-function-expression.cpp2"
 };
 
-[[nodiscard]] auto main() -> int;
-
 #line 14 "pure2-bugfix-for-unbraced-function-expression.cpp2"
 auto inline constexpr x = cpp2::i32{0};
 extern cpp2::i32 y;
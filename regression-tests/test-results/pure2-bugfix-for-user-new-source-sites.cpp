@@ -0,0 +1,87 @@
+
+#define CPP2_USE_SOURCE_SITES    Yes
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "pure2-bugfix-for-user-new-source-sites.cpp2"
+
+#line 5 "pure2-bugfix-for-user-new-source-sites.cpp2"
+class arena;
+    
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-bugfix-for-user-new-source-sites.cpp2"
+
+//  With -source-sites, only Cpp2's own unique.new, shared.new, and new
+//  get their call site -- a user-defined new<T> is called as written
+
+#line 5 "pure2-bugfix-for-user-new-source-sites.cpp2"
+class arena {
+    public: int count {0}; 
+
+    public: template<typename T> [[nodiscard]] auto cpp2_new() & -> T;
+
+#line 13 "pure2-bugfix-for-user-new-source-sites.cpp2"
+    public: template<typename T> [[nodiscard]] auto new_twice() & -> T;
+    public: arena() = default;
+    public: arena(arena const&) = delete; /* No 'that' constructor, suppress copy */
+    public: auto operator=(arena const&) -> void = delete;
+
+
+#line 17 "pure2-bugfix-for-user-new-source-sites.cpp2"
+};
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-bugfix-for-user-new-source-sites.cpp2"
+
+#line 8 "pure2-bugfix-for-user-new-source-sites.cpp2"
+    template<typename T> [[nodiscard]] auto arena::cpp2_new() & -> T{
+        ++count;
+        return T(); 
+    }
+
+#line 13 "pure2-bugfix-for-user-new-source-sites.cpp2"
+    template<typename T> [[nodiscard]] auto arena::new_twice() & -> T{
+        static_cast<void>(cpp2_new<T>());
+        return CPP2_UFCS_TEMPLATE(cpp2_new<T>)((*this)); 
+    }
+
+#line 19 "pure2-bugfix-for-user-new-source-sites.cpp2"
+auto main() -> int{
+    arena a {}; 
+    auto x {CPP2_UFCS_TEMPLATE(cpp2_new<int>)(a)}; 
+    auto y {CPP2_UFCS_TEMPLATE(new_twice<int>)(a)}; 
+
+    auto u {CPP2_UFCS_TEMPLATE(cpp2_new<int, 98321, cpp2::impl::file_sites>)(cpp2::unique, 1)}; 
+    auto s {CPP2_UFCS_TEMPLATE(cpp2_new<int, 102417, cpp2::impl::file_sites>)(cpp2::shared, 2)}; 
+    auto c {CPP2_UFCS_TEMPLATE(cpp2_new<int, 106519, cpp2::impl::file_sites>)(cpp2::unique, 3)}; 
+    auto f {cpp2_new<int, 110602, cpp2::impl::file_sites>(4)}; 
+
+    std::cout << ("arena allocations: " + cpp2::to_string(cpp2::move(a).count) + "\n");
+    std::cout << ("values: " + cpp2::to_string(cpp2::move(x)) + " " + cpp2::to_string(cpp2::move(y)) + " " + cpp2::to_string(*(cpp2::impl::assert_not_null<122983, cpp2::impl::file_sites>)(cpp2::move(u))) + " " + cpp2::to_string(*(cpp2::impl::assert_not_null<123011, cpp2::impl::file_sites>)(cpp2::move(s))) + " " + cpp2::to_string(*(cpp2::impl::assert_not_null<123039, cpp2::impl::file_sites>)(cpp2::move(c))) + " " + cpp2::to_string(*(cpp2::impl::assert_not_null<123067, cpp2::impl::file_sites>)(cpp2::move(f))) + "\n");
+}
+//=== Cpp2 source sites =========================================================
+
+namespace cpp2::impl { namespace {
+constexpr source_site source_sites[] = {
+    { 98321, "pure2-bugfix-for-user-new-source-sites.cpp2", 24, 17, "main" },
+    { 102417, "pure2-bugfix-for-user-new-source-sites.cpp2", 25, 17, "main" },
+    { 106519, "pure2-bugfix-for-user-new-source-sites.cpp2", 26, 23, "main" },
+    { 110602, "pure2-bugfix-for-user-new-source-sites.cpp2", 27, 10, "main" },
+    { 122983, "pure2-bugfix-for-user-new-source-sites.cpp2", 30, 103, "main" },
+    { 123011, "pure2-bugfix-for-user-new-source-sites.cpp2", 30, 131, "main" },
+    { 123039, "pure2-bugfix-for-user-new-source-sites.cpp2", 30, 159, "main" },
+    { 123067, "pure2-bugfix-for-user-new-source-sites.cpp2", 30, 187, "main" },
+};
+auto file_sites::table() -> std::span<source_site const> { return source_sites; }
+} }
+
+
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -12,7 +13,7 @@
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-chained-comparisons.cpp2"
-[[nodiscard]] auto main() -> int;
+
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -13,8 +14,6 @@
 
 #line 1 "pure2-concept-definition.cpp2"
 template<typename T> concept arithmetic = std::integral<T> || std::floating_point<T>; 
-#line 2 "pure2-concept-definition.cpp2"
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -12,13 +13,10 @@
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-contracts.cpp2"
-[[nodiscard]] auto test_condition_evaluation(auto const& tag) -> bool;
 
 #line 3 "pure2-contracts.cpp2"
 extern bool audit;
 
-auto main() -> int;
-
 //=== Cpp2 function definitions =================================================
 
 #line 1 "pure2-contracts.cpp2"
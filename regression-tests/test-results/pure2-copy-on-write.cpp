@@ -0,0 +1,166 @@
+
+#define CPP2_IMPORT_STD          Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "pure2-copy-on-write.cpp2"
+class document;
+#line 2 "pure2-copy-on-write.cpp2"
+    
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-copy-on-write.cpp2"
+class document {
+private: class _data {
+#line 2 "pure2-copy-on-write.cpp2"
+    private: std::string title {}; 
+    private: std::vector<std::string> lines {}; 
+
+    public: explicit _data(cpp2::impl::in<std::string> t);
+#line 5 "pure2-copy-on-write.cpp2"
+    public: auto operator=(cpp2::impl::in<std::string> t) -> _data& ;
+
+#line 9 "pure2-copy-on-write.cpp2"
+    public: auto add_line(cpp2::impl::in<std::string> line) & -> void;
+    public: auto set_title(cpp2::impl::in<std::string> t) & -> void;
+    public: [[nodiscard]] auto line_count() const& -> cpp2::i64;
+    public: [[nodiscard]] auto get_title() const& -> std::string const&;
+
+    //  Whether two documents share their data (for the test only)
+    public: [[nodiscard]] auto shares_with(_data const& that) const& -> bool;
+    public: [[nodiscard]] auto operator<=>(_data const& that) const& -> std::strong_ordering = default;
+public: _data(_data const& that);
+
+public: auto operator=(_data const& that) -> _data& ;
+public: _data(_data&& that) noexcept;
+public: auto operator=(_data&& that) noexcept -> _data& ;
+public: explicit _data();
+};
+public: explicit document(cpp2::impl::in<std::string> t);
+public: auto operator=(cpp2::impl::in<std::string> t) -> document& ;
+public: auto add_line(cpp2::impl::in<std::string> line) & -> void;
+public: auto set_title(cpp2::impl::in<std::string> t) & -> void;
+public: [[nodiscard]] auto line_count() const& -> cpp2::i64;
+public: [[nodiscard]] auto get_title() const& -> std::string const&;
+public: [[nodiscard]] auto shares_with(document const& that) const& -> bool;
+public: [[nodiscard]] auto operator<=>(document const& that) const& -> std::strong_ordering;
+public: [[nodiscard]] auto operator==(document const& that) const& -> bool;
+private: std::shared_ptr<_data> _cow {CPP2_UFCS_TEMPLATE(cpp2_new<_data>)(cpp2::shared)}; private: [[nodiscard]] auto _write() & -> _data&;
+public: document(document const& that);
+public: auto operator=(document const& that) -> document& ;
+public: document(document&& that) noexcept;
+public: auto operator=(document&& that) noexcept -> document& ;
+public: explicit document();
+
+#line 16 "pure2-copy-on-write.cpp2"
+};
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-copy-on-write.cpp2"
+
+
+#line 5 "pure2-copy-on-write.cpp2"
+    document::_data::_data(cpp2::impl::in<std::string> t)
+        : title{ t }{
+
+#line 7 "pure2-copy-on-write.cpp2"
+    }
+#line 5 "pure2-copy-on-write.cpp2"
+    auto document::_data::operator=(cpp2::impl::in<std::string> t) -> _data& {
+        title = t;
+        lines = {};
+        return *this;
+
+#line 7 "pure2-copy-on-write.cpp2"
+    }
+
+#line 9 "pure2-copy-on-write.cpp2"
+    auto document::_data::add_line(cpp2::impl::in<std::string> line) & -> void { CPP2_UFCS(push_back)(lines, line); }
+#line 10 "pure2-copy-on-write.cpp2"
+    auto document::_data::set_title(cpp2::impl::in<std::string> t) & -> void{title = t; }
+#line 11 "pure2-copy-on-write.cpp2"
+    [[nodiscard]] auto document::_data::line_count() const& -> cpp2::i64 { return CPP2_UFCS(ssize)(lines);  }
+#line 12 "pure2-copy-on-write.cpp2"
+    [[nodiscard]] auto document::_data::get_title() const& -> std::string const& { return title;  }
+
+#line 15 "pure2-copy-on-write.cpp2"
+    [[nodiscard]] auto document::_data::shares_with(_data const& that) const& -> bool { return &(*this) == &that;  }
+
+
+    document::_data::_data(_data const& that)
+                                : title{ that.title }
+                                , lines{ that.lines }{}
+
+auto document::_data::operator=(_data const& that) -> _data& {
+                                title = that.title;
+                                lines = that.lines;
+                                return *this;}
+document::_data::_data(_data&& that) noexcept
+                                : title{ std::move(that).title }
+                                , lines{ std::move(that).lines }{}
+auto document::_data::operator=(_data&& that) noexcept -> _data& {
+                                title = std::move(that).title;
+                                lines = std::move(that).lines;
+                                return *this;}
+document::_data::_data(){}
+document::document(cpp2::impl::in<std::string> t)
+                                                  : _cow{ CPP2_UFCS_TEMPLATE_NONLOCAL(cpp2_new<_data>)(cpp2::shared, t) }{}
+auto document::operator=(cpp2::impl::in<std::string> t) -> document& {
+                                                  _cow = CPP2_UFCS_TEMPLATE_NONLOCAL(cpp2_new<_data>)(cpp2::shared, t);
+                                                  return *this;}
+auto document::add_line(cpp2::impl::in<std::string> line) & -> void { CPP2_UFCS(add_line)(_write(), line); }
+auto document::set_title(cpp2::impl::in<std::string> t) & -> void { CPP2_UFCS(set_title)(_write(), t); }
+[[nodiscard]] auto document::line_count() const& -> cpp2::i64 { return CPP2_UFCS(line_count)((*cpp2::impl::assert_not_null(_cow))); }
+[[nodiscard]] auto document::get_title() const& -> std::string const& { return CPP2_UFCS(get_title)((*cpp2::impl::assert_not_null(_cow))); }
+[[nodiscard]] auto document::shares_with(document const& that) const& -> bool { return CPP2_UFCS(shares_with)((*cpp2::impl::assert_not_null(_cow)), *cpp2::impl::assert_not_null(that._cow)); }
+[[nodiscard]] auto document::operator<=>(document const& that) const& -> std::strong_ordering { return CPP2_UFCS(operator<=>)((*cpp2::impl::assert_not_null(_cow)), *cpp2::impl::assert_not_null(that._cow)); }
+[[nodiscard]] auto document::operator==(document const& that) const& -> bool { return *cpp2::impl::assert_not_null(_cow) == *cpp2::impl::assert_not_null(that._cow); }
+[[nodiscard]] auto document::_write() & -> _data&{
+    if (CPP2_UFCS(use_count)(_cow) == 1) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    else {
+    _cow = CPP2_UFCS_TEMPLATE(cpp2_new<_data>)(cpp2::shared, *cpp2::impl::assert_not_null(_cow));
+    }
+    return *cpp2::impl::assert_not_null(_cow); 
+    }
+
+    document::document(document const& that)
+                                : _cow{ that._cow }{}
+auto document::operator=(document const& that) -> document& {
+                                _cow = that._cow;
+                                return *this;}
+document::document(document&& that) noexcept
+                                : _cow{ std::move(that)._cow }{}
+auto document::operator=(document&& that) noexcept -> document& {
+                                _cow = std::move(that)._cow;
+                                return *this;}
+document::document(){}
+#line 18 "pure2-copy-on-write.cpp2"
+auto main() -> int{
+    document a {"draft"}; 
+    CPP2_UFCS(add_line)(a, "one");
+
+    auto b {a}; 
+    std::cout << ("after copying, a and b share: " + cpp2::to_string(CPP2_UFCS(shares_with)(a, b)) + "\n");
+
+    CPP2_UFCS(add_line)(b, "two");
+    std::cout << ("after changing b, a and b share: " + cpp2::to_string(CPP2_UFCS(shares_with)(a, b)) + "\n");
+    std::cout << ("a: " + cpp2::to_string(CPP2_UFCS(get_title)(a)) + " " + cpp2::to_string(CPP2_UFCS(line_count)(a)) + ", b: " + cpp2::to_string(CPP2_UFCS(get_title)(b)) + " " + cpp2::to_string(CPP2_UFCS(line_count)(b)) + "\n");
+
+    auto c {b}; 
+    CPP2_UFCS(set_title)(c, "final");
+    std::cout << ("b: " + cpp2::to_string(CPP2_UFCS(get_title)(b)) + ", c: " + cpp2::to_string(CPP2_UFCS(get_title)(cpp2::move(c))) + "\n");
+
+    std::cout << ("a < b: " + cpp2::to_string(cpp2::impl::cmp_less(a,b)) + ", a == copy of a: " + cpp2::to_string(a == document(a)) + ", a == b: " + cpp2::to_string(a == b) + "\n");
+
+    document e {}; 
+    std::cout << ("default: '" + cpp2::to_string(CPP2_UFCS(get_title)(e)) + "' " + cpp2::to_string(CPP2_UFCS(line_count)(e)) + "\n");
+}
+
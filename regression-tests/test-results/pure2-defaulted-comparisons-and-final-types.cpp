@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -34,7 +35,6 @@ class widget final
 #line 11 "pure2-defaulted-comparisons-and-final-types.cpp2"
 };
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,11 +1,16 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <set>
+#endif
+
 #line 1 "pure2-enum.cpp2"
 
 #line 2 "pure2-enum.cpp2"
@@ -108,7 +113,6 @@ public: [[nodiscard]] auto to_string() const& -> std::string;
 #line 26 "pure2-enum.cpp2"
 };
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,21 +1,23 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <array>
+#endif
+
 #line 1 "pure2-for-loop-range-with-lambda.cpp2"
 
 
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-for-loop-range-with-lambda.cpp2"
-[[nodiscard]] auto first(auto&& f, [[maybe_unused]] auto&& ...unnamed_param_2) -> auto&&;
 
-#line 3 "pure2-for-loop-range-with-lambda.cpp2"
-auto main(int const argc_, char** argv_) -> int;
 
 //=== Cpp2 function definitions =================================================
 
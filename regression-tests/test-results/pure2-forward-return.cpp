@@ -1,11 +1,16 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <ostream>
+#endif
+
 #line 1 "pure2-forward-return.cpp2"
 
 
@@ -13,14 +18,8 @@
 
 #line 1 "pure2-forward-return.cpp2"
 
-#line 2 "pure2-forward-return.cpp2"
-[[nodiscard]] auto first(auto&& rng) -> auto&&;
-
 #line 7 "pure2-forward-return.cpp2"
 extern int const global;
-[[nodiscard]] auto f() -> int const&;
-
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
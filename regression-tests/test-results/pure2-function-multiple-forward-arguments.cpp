@@ -1,22 +1,23 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <ostream>
+#endif
+
 #line 1 "pure2-function-multiple-forward-arguments.cpp2"
 
 
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-function-multiple-forward-arguments.cpp2"
-auto fun(auto&& s1, auto&& s2, auto&& s3) -> void
-CPP2_REQUIRES (std::is_same_v<std::string, CPP2_TYPEOF(s1)> && std::is_same_v<std::string, CPP2_TYPEOF(s2)> && std::is_same_v<std::string, CPP2_TYPEOF(s3)>) ;
 
-#line 5 "pure2-function-multiple-forward-arguments.cpp2"
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
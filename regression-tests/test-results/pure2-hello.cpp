@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -13,9 +14,6 @@
 
 #line 1 "pure2-hello.cpp2"
 
-#line 2 "pure2-hello.cpp2"
-[[nodiscard]] auto main() -> int;
-
 #line 6 "pure2-hello.cpp2"
 [[nodiscard]] auto name() -> std::string;
 
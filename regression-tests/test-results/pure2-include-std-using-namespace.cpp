@@ -0,0 +1,35 @@
+
+#define CPP2_IMPORT_STD          Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "pure2-include-std-using-namespace.cpp2"
+
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-include-std-using-namespace.cpp2"
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-include-std-using-namespace.cpp2"
+
+//  A using-directive makes std names usable unqualified, so the
+//  generated file can't include only the std headers it names
+#line 4 "pure2-include-std-using-namespace.cpp2"
+auto main() -> int{
+    using namespace std;
+    deque<int> v {}; 
+    CPP2_UFCS(push_back)(v, 1);
+    CPP2_UFCS(push_back)(v, 2);
+    cout << CPP2_UFCS(ssize)(cpp2::move(v)) << "\n";
+
+    using std::chrono::duration;
+    duration<double> d {1.5}; 
+    cout << CPP2_UFCS(count)(cpp2::move(d)) << "\n";
+}
+
@@ -0,0 +1,187 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "pure2-initialization-safety-many-locals.cpp2"
+
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-initialization-safety-many-locals.cpp2"
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-initialization-safety-many-locals.cpp2"
+//  Many deferred-initialized locals in one function, each initialized
+//  on every path of its own selection statements, in declaration order
+
+#line 4 "pure2-initialization-safety-many-locals.cpp2"
+auto main(int const argc_, char** argv_) -> int{
+    auto const args = cpp2::make_args(argc_, argv_); 
+#line 5 "pure2-initialization-safety-many-locals.cpp2"
+    auto mode {CPP2_UFCS(ssize)(args)}; 
+
+    cpp2::impl::deferred_init<int> s00; 
+    cpp2::impl::deferred_init<int> s01; 
+    cpp2::impl::deferred_init<int> s02; 
+    cpp2::impl::deferred_init<int> s03; 
+    cpp2::impl::deferred_init<int> s04; 
+    cpp2::impl::deferred_init<int> s05; 
+    cpp2::impl::deferred_init<int> s06; 
+    cpp2::impl::deferred_init<int> s07; 
+    cpp2::impl::deferred_init<int> s08; 
+    cpp2::impl::deferred_init<int> s09; 
+    cpp2::impl::deferred_init<int> s10; 
+    cpp2::impl::deferred_init<int> s11; 
+    cpp2::impl::deferred_init<int> s12; 
+    cpp2::impl::deferred_init<int> s13; 
+    cpp2::impl::deferred_init<int> s14; 
+    cpp2::impl::deferred_init<int> s15; 
+    cpp2::impl::deferred_init<int> s16; 
+    cpp2::impl::deferred_init<int> s17; 
+    cpp2::impl::deferred_init<int> s18; 
+    cpp2::impl::deferred_init<int> s19; 
+    cpp2::impl::deferred_init<int> s20; 
+    cpp2::impl::deferred_init<int> s21; 
+    cpp2::impl::deferred_init<int> s22; 
+    cpp2::impl::deferred_init<int> s23; 
+
+    s00.construct(0);
+    if (mode == 1) {
+        s01.construct(-1);
+    }else {if (cpp2::impl::cmp_greater(mode,1)) {
+        s01.construct(s00.value() + 1);
+    }else {
+        s01.construct(s00.value() * 2);
+    }}
+    if (mode % 2 == 0) {
+        if (mode == 0) {s02.construct(0); }else {s02.construct(2); }
+    }else {
+        s02.construct(s00.value() + s01.value());
+    }
+    s03.construct(3);
+    if (mode == 4) {
+        s04.construct(-4);
+    }else {if (cpp2::impl::cmp_greater(mode,4)) {
+        s04.construct(s03.value() + 1);
+    }else {
+        s04.construct(s03.value() * 2);
+    }}
+    if (mode % 2 == 0) {
+        if (mode == 0) {s05.construct(0); }else {s05.construct(5); }
+    }else {
+        s05.construct(s03.value() + s04.value());
+    }
+    s06.construct(6);
+    if (mode == 7) {
+        s07.construct(-7);
+    }else {if (cpp2::impl::cmp_greater(mode,7)) {
+        s07.construct(s06.value() + 1);
+    }else {
+        s07.construct(s06.value() * 2);
+    }}
+    if (mode % 2 == 0) {
+        if (mode == 0) {s08.construct(0); }else {s08.construct(8); }
+    }else {
+        s08.construct(s06.value() + s07.value());
+    }
+    s09.construct(9);
+    if (mode == 10) {
+        s10.construct(-10);
+    }else {if (cpp2::impl::cmp_greater(mode,10)) {
+        s10.construct(s09.value() + 1);
+    }else {
+        s10.construct(s09.value() * 2);
+    }}
+    if (mode % 2 == 0) {
+        if (mode == 0) {s11.construct(0); }else {s11.construct(11); }
+    }else {
+        s11.construct(s09.value() + s10.value());
+    }
+    s12.construct(12);
+    if (mode == 13) {
+        s13.construct(-13);
+    }else {if (cpp2::impl::cmp_greater(mode,13)) {
+        s13.construct(s12.value() + 1);
+    }else {
+        s13.construct(s12.value() * 2);
+    }}
+    if (mode % 2 == 0) {
+        if (mode == 0) {s14.construct(0); }else {s14.construct(14); }
+    }else {
+        s14.construct(s12.value() + s13.value());
+    }
+    s15.construct(15);
+    if (mode == 16) {
+        s16.construct(-16);
+    }else {if (cpp2::impl::cmp_greater(mode,16)) {
+        s16.construct(s15.value() + 1);
+    }else {
+        s16.construct(s15.value() * 2);
+    }}
+    if (mode % 2 == 0) {
+        if (mode == 0) {s17.construct(0); }else {s17.construct(17); }
+    }else {
+        s17.construct(s15.value() + s16.value());
+    }
+    s18.construct(18);
+    if (mode == 19) {
+        s19.construct(-19);
+    }else {if (cpp2::impl::cmp_greater(mode,19)) {
+        s19.construct(s18.value() + 1);
+    }else {
+        s19.construct(s18.value() * 2);
+    }}
+    if (mode % 2 == 0) {
+        if (mode == 0) {s20.construct(0); }else {s20.construct(20); }
+    }else {
+        s20.construct(s18.value() + s19.value());
+    }
+    s21.construct(21);
+    if (mode == 22) {
+        s22.construct(-22);
+    }else {if (cpp2::impl::cmp_greater(mode,22)) {
+        s22.construct(s21.value() + 1);
+    }else {
+        s22.construct(s21.value() * 2);
+    }}
+    if (mode % 2 == 0) {
+        if (cpp2::move(mode) == 0) {s23.construct(0); }else {s23.construct(23); }
+    }else {
+        s23.construct(s21.value() + s22.value());
+    }
+
+    auto sum {0}; 
+    sum += cpp2::move(s00.value());
+    sum += cpp2::move(s01.value());
+    sum += cpp2::move(s02.value());
+    sum += cpp2::move(s03.value());
+    sum += cpp2::move(s04.value());
+    sum += cpp2::move(s05.value());
+    sum += cpp2::move(s06.value());
+    sum += cpp2::move(s07.value());
+    sum += cpp2::move(s08.value());
+    sum += cpp2::move(s09.value());
+    sum += cpp2::move(s10.value());
+    sum += cpp2::move(s11.value());
+    sum += cpp2::move(s12.value());
+    sum += cpp2::move(s13.value());
+    sum += cpp2::move(s14.value());
+    sum += cpp2::move(s15.value());
+    sum += cpp2::move(s16.value());
+    sum += cpp2::move(s17.value());
+    sum += cpp2::move(s18.value());
+    sum += cpp2::move(s19.value());
+    sum += cpp2::move(s20.value());
+    sum += cpp2::move(s21.value());
+    sum += cpp2::move(s22.value());
+    sum += cpp2::move(s23.value());
+    std::cout << ("sum: " + cpp2::to_string(cpp2::move(sum)) + "\n");
+}
+
@@ -1,18 +1,22 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <iomanip>
+#endif
+
 #line 1 "pure2-inspect-expression-with-as-in-generic-function.cpp2"
 
 
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-inspect-expression-with-as-in-generic-function.cpp2"
-[[nodiscard]] auto main() -> int;
 
 #line 7 "pure2-inspect-expression-with-as-in-generic-function.cpp2"
 auto print_an_int(auto const& x) -> void;
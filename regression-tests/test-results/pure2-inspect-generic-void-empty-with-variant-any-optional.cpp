@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -13,9 +14,6 @@
 
 #line 1 "pure2-inspect-generic-void-empty-with-variant-any-optional.cpp2"
 
-#line 2 "pure2-inspect-generic-void-empty-with-variant-any-optional.cpp2"
-[[nodiscard]] auto main() -> int;
-
 #line 18 "pure2-inspect-generic-void-empty-with-variant-any-optional.cpp2"
 auto test_generic(auto const& x, auto const& msg) -> void;
 
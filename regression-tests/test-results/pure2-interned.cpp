@@ -0,0 +1,85 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#ifndef __cpp_lib_modules
+#include <shared_mutex>
+#include <unordered_map>
+#endif
+
+#line 1 "pure2-interned.cpp2"
+class symbol;
+#line 2 "pure2-interned.cpp2"
+    
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-interned.cpp2"
+class symbol {
+#line 2 "pure2-interned.cpp2"
+    public: std::string const name; 
+    public: cpp2::i32 const arity; 
+
+    public: explicit symbol(cpp2::impl::in<std::string> n, cpp2::impl::in<cpp2::i32> a);
+    public: [[nodiscard]] auto operator<=>(symbol const& that) const& -> std::strong_ordering = default;
+public: [[nodiscard]] auto hash() const& -> std::size_t;
+public: [[nodiscard]] auto operator==(symbol const& that) const& -> bool = default;
+public: using handle = cpp2::interned<symbol>;
+public: [[nodiscard]] auto intern() const& -> handle;
+
+
+#line 9 "pure2-interned.cpp2"
+};
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-interned.cpp2"
+
+#line 5 "pure2-interned.cpp2"
+    symbol::symbol(cpp2::impl::in<std::string> n, cpp2::impl::in<cpp2::i32> a)
+        : name{ n }
+        , arity{ a }{
+
+#line 8 "pure2-interned.cpp2"
+    }
+
+
+    [[nodiscard]] auto symbol::hash() const& -> std::size_t{
+
+    std::size_t ret {0}; 
+    ret = cpp2::hash_combine(ret, name);
+    ret = cpp2::hash_combine(ret, arity);
+    return ret; 
+    }
+
+
+
+    [[nodiscard]] auto symbol::intern() const& -> handle { return CPP2_UFCS(intern)(cpp2::intern_table<symbol,std::shared_mutex>::instance(), (*this)); }
+
+#line 11 "pure2-interned.cpp2"
+auto main() -> int{
+    auto f1 {CPP2_UFCS(intern)(symbol("f", 2))}; 
+    auto g {CPP2_UFCS(intern)(symbol("g", 1))}; 
+    auto f2 {CPP2_UFCS(intern)(symbol("f", 2))}; 
+    auto f3 {CPP2_UFCS(intern)(symbol("f", 3))}; 
+
+    std::cout << ("f1 == f2: " + cpp2::to_string(f1 == f2) + ", same object: " + cpp2::to_string(&*cpp2::impl::assert_not_null(f1) == &*cpp2::impl::assert_not_null(f2)) + ", f1 == f3: " + cpp2::to_string(f1 == f3) + "\n");
+    std::cout << ("f1 < g: " + cpp2::to_string(cpp2::impl::cmp_less(f1,g)) + ", f1 < f3: " + cpp2::to_string(cpp2::impl::cmp_less(f1,f3)) + ", g > f3: " + cpp2::to_string(cpp2::impl::cmp_greater(g,f3)) + "\n");
+    std::cout << (cpp2::to_string((*cpp2::impl::assert_not_null(f1)).name) + "/" + cpp2::to_string((*cpp2::impl::assert_not_null(f1)).arity) + " " + cpp2::to_string((*cpp2::impl::assert_not_null(g)).name) + "/" + cpp2::to_string((*cpp2::impl::assert_not_null(g)).arity) + "\n");
+    std::cout << ("distinct values: " + cpp2::to_string(CPP2_UFCS(size)(cpp2::intern_table<symbol,std::shared_mutex>::instance())) + "\n");
+
+    std::unordered_map<symbol::handle,cpp2::i32> arities {}; 
+    CPP2_ASSERT_IN_BOUNDS(arities, f1) = (*cpp2::impl::assert_not_null(f1)).arity;
+    CPP2_ASSERT_IN_BOUNDS(arities, g) = (*cpp2::impl::assert_not_null(g)).arity;
+    std::cout << ("lookup by an equal handle: " + cpp2::to_string(CPP2_ASSERT_IN_BOUNDS(arities, cpp2::move(f2))) + ", size " + cpp2::to_string(CPP2_UFCS(ssize)(arities)) + "\n");
+
+    symbol::handle none {}; 
+    std::cout << ("null handle: " + cpp2::to_string(CPP2_UFCS(is_null)(none)) + ", sorts first: " + cpp2::to_string(cpp2::impl::cmp_less(none,cpp2::move(f1))) + "\n");
+}
+
@@ -1,11 +1,17 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <iomanip>
+#include <ios>
+#endif
+
 #line 1 "pure2-interpolation.cpp2"
 
 #line 2 "pure2-interpolation.cpp2"
@@ -24,7 +30,6 @@ class item {
     public: [[nodiscard]] auto count() const& -> int;
 };
 
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -66,7 +71,7 @@ auto const& x{item()};
     {
         std::cout << std::left << std::setw(20) << CPP2_UFCS(name)(x) << " color " << std::left << std::setw(10) << CPP2_UFCS(color)(x) << " price " << std::setw(10) << std::setprecision(3) << CPP2_UFCS(price)(x) << " in stock = " << std::boolalpha << (cpp2::impl::cmp_greater(CPP2_UFCS(count)(x),0)) << "\n";
 
-        std::cout << (cpp2::to_string(CPP2_UFCS(name)(x), "{:20}") + " color " + cpp2::to_string(CPP2_UFCS(color)(x), "{:10}") + " price " + cpp2::to_string(CPP2_UFCS(price)(x), "{: <10.2f}") + " in stock = " + cpp2::to_string(cpp2::impl::cmp_greater(CPP2_UFCS(count)(x),0)) + "\n");
+        std::cout << (cpp2::impl::format("{:20}", CPP2_UFCS(name)(x)) + " color " + cpp2::impl::format("{:10}", CPP2_UFCS(color)(x)) + " price " + cpp2::impl::format("{: <10.2f}", CPP2_UFCS(price)(x)) + " in stock = " + cpp2::to_string(cpp2::impl::cmp_greater(CPP2_UFCS(count)(x),0)) + "\n");
     }
 }
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -12,7 +13,6 @@
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-intro-example-hello-2022.cpp2"
-[[nodiscard]] auto main() -> int;
 
 #line 11 "pure2-intro-example-hello-2022.cpp2"
 [[nodiscard]] auto decorate(auto& thing) -> int;
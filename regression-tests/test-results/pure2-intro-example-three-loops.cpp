@@ -1,26 +1,25 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <iomanip>
+#ifdef __cpp_lib_print
+    #include <print>
+#endif
+#endif
+
 #line 1 "pure2-intro-example-three-loops.cpp2"
 
 
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-intro-example-three-loops.cpp2"
-
-#line 2 "pure2-intro-example-three-loops.cpp2"
-auto print(auto const& thing) -> void;
-
-#line 5 "pure2-intro-example-three-loops.cpp2"
-auto decorate_and_print(auto& thing) -> void;
-
-#line 10 "pure2-intro-example-three-loops.cpp2"
-[[nodiscard]] auto main() -> int;
 #line 30 "pure2-intro-example-three-loops.cpp2"
 
 #line 1 "pure2-intro-example-three-loops.cpp2"
@@ -1,11 +1,16 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <ostream>
+#endif
+
 #line 1 "pure2-is-with-variable-and-value.cpp2"
 
 #line 26 "pure2-is-with-variable-and-value.cpp2"
@@ -23,10 +28,6 @@ class Cmp;
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-is-with-variable-and-value.cpp2"
-auto fun(auto const& name, auto const& v) -> void;
-
-#line 14 "pure2-is-with-variable-and-value.cpp2"
-[[nodiscard]] auto main() -> int;
 
 #line 26 "pure2-is-with-variable-and-value.cpp2"
 class WithOp {
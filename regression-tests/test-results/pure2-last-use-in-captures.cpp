@@ -0,0 +1,174 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "pure2-last-use-in-captures.cpp2"
+
+#line 3 "pure2-last-use-in-captures.cpp2"
+class payload;
+    
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-last-use-in-captures.cpp2"
+extern int copies;
+
+#line 3 "pure2-last-use-in-captures.cpp2"
+class payload {
+    public: std::vector<int> data {}; 
+    public: explicit payload(cpp2::impl::in<int> size);
+#line 5 "pure2-last-use-in-captures.cpp2"
+    public: auto operator=(cpp2::impl::in<int> size) -> payload& ;
+    public: payload(payload const& that);
+#line 6 "pure2-last-use-in-captures.cpp2"
+    public: auto operator=(payload const& that) -> payload& ;
+    public: payload(payload&& that) noexcept;
+#line 7 "pure2-last-use-in-captures.cpp2"
+    public: auto operator=(payload&& that) noexcept -> payload& ;
+};
+
+using post_capture_ret = cpp2::i64;
+
+using post_capture_then_use_ret = cpp2::i64;
+
+using post_capture_and_read_ret = cpp2::i64;
+
+using post_read_after_body_ret = cpp2::i64;
+#line 1 "pure2-last-use-in-captures.cpp2"
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-last-use-in-captures.cpp2"
+int copies {0}; 
+
+#line 5 "pure2-last-use-in-captures.cpp2"
+    payload::payload(cpp2::impl::in<int> size)
+                                         : data{ std::vector<int>(size, 42) }{}
+#line 5 "pure2-last-use-in-captures.cpp2"
+    auto payload::operator=(cpp2::impl::in<int> size) -> payload& {
+                                         data = std::vector<int>(size, 42);
+                                         return *this; }
+#line 6 "pure2-last-use-in-captures.cpp2"
+    payload::payload(payload const& that)
+                                    : data{ that.data }{++copies; }
+#line 6 "pure2-last-use-in-captures.cpp2"
+    auto payload::operator=(payload const& that) -> payload& {
+                                    data = that.data; ++copies;
+                                    return *this; }
+#line 7 "pure2-last-use-in-captures.cpp2"
+    payload::payload(payload&& that) noexcept
+                                         : data{ cpp2::move(that).data }{}
+#line 7 "pure2-last-use-in-captures.cpp2"
+    auto payload::operator=(payload&& that) noexcept -> payload& {
+                                         data = cpp2::move(that).data;
+                                         return *this; }
+
+#line 10 "pure2-last-use-in-captures.cpp2"
+auto run(auto&& f) -> void { CPP2_FORWARD(f)();  }
+
+//  Capture is the last use of a copy parameter: moved into the closure
+#line 13 "pure2-last-use-in-captures.cpp2"
+auto hand_off_param(payload p) -> void{
+    run([_0 = cpp2::move(p)]() mutable -> void { std::cout << ("param: " + cpp2::to_string(CPP2_UFCS(ssize)(_0.data)) + "\n");  });
+}
+
+//  Capture is the last use of a local: moved into the closure
+#line 18 "pure2-last-use-in-captures.cpp2"
+auto hand_off_local() -> void{
+    payload p {1000}; 
+    run([_0 = cpp2::move(p)]() mutable -> void { std::cout << ("local: " + cpp2::to_string(CPP2_UFCS(ssize)(_0.data)) + "\n");  });
+}
+
+//  Capture is followed by another use: copied into the closure
+#line 24 "pure2-last-use-in-captures.cpp2"
+auto hand_off_then_use() -> void{
+    payload p {1000}; 
+    run([_0 = p]() mutable -> void { std::cout << ("copied: " + cpp2::to_string(CPP2_UFCS(ssize)(_0.data)) + "\n");  });
+    std::cout << ("still here: " + cpp2::to_string(CPP2_UFCS(ssize)(cpp2::move(p).data)) + "\n");
+}
+
+//  Postcondition capture is the last use: moved into the closure
+#line 31 "pure2-last-use-in-captures.cpp2"
+[[nodiscard]] auto post_capture(payload p) -> post_capture_ret
+
+{
+    cpp2::finally_presuccess cpp2_finally_presuccess;
+        cpp2::impl::deferred_init<cpp2::i64> r;
+    cpp2_finally_presuccess.add([&, _1 = cpp2::move(p)]{if (cpp2::cpp2_default.is_active() && !(CPP2_UFCS(ssize)(_1.data) == 1000) ) { cpp2::cpp2_default.report_violation(""); }} );
+#line 34 "pure2-last-use-in-captures.cpp2"
+    r.construct(1000);
+cpp2_finally_presuccess.run(); return std::move(r.value()); }
+
+//  Postcondition capture followed by a use in the body: copied into the closure
+#line 38 "pure2-last-use-in-captures.cpp2"
+[[nodiscard]] auto post_capture_then_use(payload p) -> post_capture_then_use_ret
+
+{
+    cpp2::finally_presuccess cpp2_finally_presuccess;
+        cpp2::impl::deferred_init<cpp2::i64> r;
+    cpp2_finally_presuccess.add([&, _1 = p]{if (cpp2::cpp2_default.is_active() && !(CPP2_UFCS(ssize)(_1.data) == 1000) ) { cpp2::cpp2_default.report_violation(""); }} );
+#line 41 "pure2-last-use-in-captures.cpp2"
+    r.construct(CPP2_UFCS(ssize)(cpp2::move(p).data));
+cpp2_finally_presuccess.run(); return std::move(r.value()); }
+
+//  Postcondition also reads the parameter on exit: nothing can be moved
+#line 45 "pure2-last-use-in-captures.cpp2"
+[[nodiscard]] auto post_capture_and_read(payload p) -> post_capture_and_read_ret
+
+{
+    cpp2::finally_presuccess cpp2_finally_presuccess;
+        cpp2::impl::deferred_init<cpp2::i64> r;
+    cpp2_finally_presuccess.add([&, _1 = p]{if (cpp2::cpp2_default.is_active() && !(CPP2_UFCS(ssize)(p.data) == CPP2_UFCS(ssize)(_1.data)) ) { cpp2::cpp2_default.report_violation(""); }} );
+#line 48 "pure2-last-use-in-captures.cpp2"
+    r.construct(CPP2_UFCS(ssize)(p.data));
+cpp2_finally_presuccess.run(); return std::move(r.value()); }
+
+#line 51 "pure2-last-use-in-captures.cpp2"
+[[nodiscard]] auto take(payload p) -> cpp2::i64 { return CPP2_UFCS(ssize)(cpp2::move(p).data);  }
+
+//  Postcondition reads the parameter on exit: the body can't move from it
+#line 54 "pure2-last-use-in-captures.cpp2"
+[[nodiscard]] auto post_read_after_body(payload p) -> post_read_after_body_ret
+
+{
+    cpp2::finally_presuccess cpp2_finally_presuccess;
+        cpp2::impl::deferred_init<cpp2::i64> r;
+    cpp2_finally_presuccess.add([&]{if (cpp2::cpp2_default.is_active() && !(CPP2_UFCS(ssize)(p.data) == 1000) ) { cpp2::cpp2_default.report_violation(""); }} );
+#line 57 "pure2-last-use-in-captures.cpp2"
+    r.construct(take(p));
+cpp2_finally_presuccess.run(); return std::move(r.value()); }
+
+#line 60 "pure2-last-use-in-captures.cpp2"
+auto main() -> int{
+    auto report {[](auto const& what) mutable -> void{
+        std::cout << (cpp2::to_string(what) + " made " + cpp2::to_string(copies) + " copies\n");
+        copies = 0;
+    }}; 
+
+    hand_off_param(payload(1000));
+    report("hand_off_param");
+
+    hand_off_local();
+    report("hand_off_local");
+
+    hand_off_then_use();
+    report("hand_off_then_use");
+
+    static_cast<void>(post_capture(payload(1000)));
+    report("post_capture");
+
+    static_cast<void>(post_capture_then_use(payload(1000)));
+    report("post_capture_then_use");
+
+    static_cast<void>(post_capture_and_read(payload(1000)));
+    report("post_capture_and_read");
+
+    static_cast<void>(post_read_after_body(payload(1000)));
+    cpp2::move(report)("post_read_after_body");
+}
+
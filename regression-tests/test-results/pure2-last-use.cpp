@@ -83,8 +83,8 @@ class types;
 auto f_inout([[maybe_unused]] auto& unnamed_param_1) -> void;
 #line 2 "pure2-last-use.cpp2"
 auto f_copy([[maybe_unused]] auto ...unnamed_param_1) -> void;
-[[nodiscard]] auto pred([[maybe_unused]] auto const& ...unnamed_param_1) -> auto;
-[[nodiscard]] auto pred_copy([[maybe_unused]] auto ...unnamed_param_1) -> auto;
+
+#line 5 "pure2-last-use.cpp2"
 template<typename T> [[nodiscard]] constexpr auto identity(T&& x) -> auto&&
 CPP2_REQUIRES (std::is_reference_v<T>) ;
 #line 6 "pure2-last-use.cpp2"
@@ -94,64 +94,6 @@ CPP2_REQUIRES (std::copyable<decltype(x)>) ;
 [[nodiscard]] auto identity_copy(auto&& x) -> auto
 CPP2_REQUIRES (!(std::copyable<decltype(x)>)) ;
 
-#line 9 "pure2-last-use.cpp2"
-auto issue_313() -> void;
-
-#line 73 "pure2-last-use.cpp2"
-auto issue_313_1(std::unique_ptr<int> x) -> void;
-
-auto issue_350() -> void;
-
-#line 86 "pure2-last-use.cpp2"
-/*
-issue_440_0: () -> int = {
-  i: int;
-  if true {
-    i = 1;
-    return i;
-  }
-  i = 2;
-  return i;
-}
-
-issue_440_1: () -> (i: int) = {
-  if true {
-    i = 1;
-    return;
-  }
-  i = 2;
-}
-*/
-auto issue_683(auto const& args) -> void;
-
-#line 114 "pure2-last-use.cpp2"
-auto issue_825() -> void;
-
-#line 120 "pure2-last-use.cpp2"
-auto issue_832() -> void;
-
-#line 125 "pure2-last-use.cpp2"
-[[nodiscard]] auto make_copy(auto x) -> auto;
-
-auto issue_847_4(std::vector<int> v) -> void;
-
-#line 133 "pure2-last-use.cpp2"
-auto issue_847_0(std::vector<std::unique_ptr<int>> v) -> void;
-
-#line 139 "pure2-last-use.cpp2"
-auto issue_847_1(std::vector<std::unique_ptr<int>>&& v) -> void;
-
-#line 145 "pure2-last-use.cpp2"
-auto issue_847_5(auto&& v) -> void;
-
-#line 151 "pure2-last-use.cpp2"
-auto issue_847_2(auto&& v) -> void;
-
-#line 156 "pure2-last-use.cpp2"
-auto issue_847_3(int x) -> void;
-
-auto issue_850() -> void;
-
 #line 169 "pure2-last-use.cpp2"
 class issue_857 {
   private: std::unique_ptr<int> a; 
@@ -394,35 +336,6 @@ public: auto operator=(issue_869_1&& that) noexcept -> issue_869_1& ;
 };
 
 using issue_869_2_ret = issue_869_1;
-[[nodiscard]] auto issue_869_2() -> issue_869_2_ret;
-
-#line 380 "pure2-last-use.cpp2"
-auto issue_884() -> void;
-
-#line 777 "pure2-last-use.cpp2"
-auto issue_888_0(std::string r, int size) -> void;
-
-#line 780 "pure2-last-use.cpp2"
-auto issue_888_1([[maybe_unused]] std::string unnamed_param_1, move_only_function<int(int)> size) -> void;
-
-#line 784 "pure2-last-use.cpp2"
-auto issue_890() -> void;
-
-#line 790 "pure2-last-use.cpp2"
-auto issue_962(cpp2::impl::in<::std::string> s) -> void;
-
-#line 795 "pure2-last-use.cpp2"
-auto draw() -> void;
-
-#line 801 "pure2-last-use.cpp2"
-auto enum_0() -> void;
-
-#line 806 "pure2-last-use.cpp2"
-auto enum_1() -> void;
-
-#line 834 "pure2-last-use.cpp2"
-auto enum_2() -> void;
-
 #line 844 "pure2-last-use.cpp2"
 class cpp2_union {
   public: auto destroy() & -> void;
@@ -441,22 +354,8 @@ class my_string {
 };
 
 using no_pessimizing_move_ret = std::unique_ptr<int>;
-#line 857 "pure2-last-use.cpp2"
-[[nodiscard]] auto no_pessimizing_move() -> no_pessimizing_move_ret;
 
-auto deferred_non_copyable_0() -> void;
-
-#line 865 "pure2-last-use.cpp2"
-[[nodiscard]] auto deferred_non_copyable_1() -> auto;
 using deferred_non_copyable_2_ret = std::unique_ptr<int>;
-
-
-#line 871 "pure2-last-use.cpp2"
-[[nodiscard]] auto deferred_non_copyable_2() -> deferred_non_copyable_2_ret;
-
-#line 875 "pure2-last-use.cpp2"
-auto loops() -> void;
-
 #line 911 "pure2-last-use.cpp2"
 namespace captures {
 
@@ -479,8 +378,6 @@ auto g() -> void;
 #line 954 "pure2-last-use.cpp2"
 }
 
-auto loops_and_captures() -> void;
-
 #line 984 "pure2-last-use.cpp2"
 class types {
   public: std::unique_ptr<int> x; 
@@ -492,10 +389,6 @@ class types {
 //   }
 };
 
-auto skip_hidden_names() -> void;
-
-#line 1044 "pure2-last-use.cpp2"
-auto main(int const argc_, char** argv_) -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -598,7 +491,25 @@ auto issue_350() -> void{
 
     ++x;
 }
+/*
+issue_440_0: () -> int = {
+  i: int;
+  if true {
+    i = 1;
+    return i;
+  }
+  i = 2;
+  return i;
+}
 
+issue_440_1: () -> (i: int) = {
+  if true {
+    i = 1;
+    return;
+  }
+  i = 2;
+}
+*/
 #line 105 "pure2-last-use.cpp2"
 auto issue_683(auto const& args) -> void{
     for ( auto const& n : args ) {
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -14,16 +15,9 @@
 #line 1 "pure2-look-up-parameter-across-unnamed-function.cpp2"
 
 using f_ret = int;
-#line 2 "pure2-look-up-parameter-across-unnamed-function.cpp2"
-[[nodiscard]] auto f() -> f_ret;
-using g_ret = int;
-
-
-#line 9 "pure2-look-up-parameter-across-unnamed-function.cpp2"
-[[nodiscard]] auto g() -> g_ret;
 
-#line 17 "pure2-look-up-parameter-across-unnamed-function.cpp2"
-[[nodiscard]] auto main() -> int;
+using g_ret = int;
+#line 1 "pure2-look-up-parameter-across-unnamed-function.cpp2"
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -13,10 +14,6 @@
 
 #line 1 "pure2-more-wildcards.cpp2"
 
-#line 2 "pure2-more-wildcards.cpp2"
-[[nodiscard]] auto less_than(auto const& value) -> auto;
-
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -0,0 +1,321 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#ifndef __cpp_lib_modules
+#include <array>
+#endif
+
+#line 1 "pure2-ordered-key-compare.cpp2"
+
+#line 3 "pure2-ordered-key-compare.cpp2"
+class small;
+    
+
+#line 11 "pure2-ordered-key-compare.cpp2"
+class wide;
+    
+
+#line 22 "pure2-ordered-key-compare.cpp2"
+class wide_unpacked;
+    
+
+#line 32 "pure2-ordered-key-compare.cpp2"
+class mixed;
+    
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-ordered-key-compare.cpp2"
+//  Members that fit in one word (with padding after 'a'), compared as
+//  a packed key
+#line 3 "pure2-ordered-key-compare.cpp2"
+class small {
+    public: cpp2::u8 a {0}; 
+    public: cpp2::u16 b {0}; 
+    public: bool c {false}; 
+    public: std::array<cpp2::u8,3> d {}; 
+    public: [[nodiscard]] auto operator<=>(small const& that) const& -> std::strong_ordering;
+public: [[nodiscard]] auto operator==(small const& that) const& -> bool;
+public: small(small const& that);
+
+public: auto operator=(small const& that) -> small& ;
+public: small(small&& that) noexcept;
+public: auto operator=(small&& that) noexcept -> small& ;
+public: explicit small();
+
+#line 8 "pure2-ordered-key-compare.cpp2"
+};
+
+//  Two words, with no padding, compared as a packed key
+class wide {
+    public: cpp2::u16 a {0}; 
+    public: std::array<std::byte,6> b {}; 
+    public: cpp2::u32 c {0}; 
+    public: cpp2::u16 d {0}; 
+    public: cpp2::u8 e {0}; 
+    public: cpp2::u8 f {0}; 
+    public: [[nodiscard]] auto operator<=>(wide const& that) const& -> std::strong_ordering;
+public: [[nodiscard]] auto operator==(wide const& that) const& -> bool;
+public: wide(wide const& that);
+
+public: auto operator=(wide const& that) -> wide& ;
+public: wide(wide&& that) noexcept;
+public: auto operator=(wide&& that) noexcept -> wide& ;
+public: explicit wide();
+
+#line 18 "pure2-ordered-key-compare.cpp2"
+};
+
+//  The same members without 'packed': <=> stays defaulted, and == compares
+//  the bytes
+class wide_unpacked {
+    public: cpp2::u16 a {0}; 
+    public: std::array<std::byte,6> b {}; 
+    public: cpp2::u32 c {0}; 
+    public: cpp2::u16 d {0}; 
+    public: cpp2::u8 e {0}; 
+    public: cpp2::u8 f {0}; 
+    public: [[nodiscard]] auto operator<=>(wide_unpacked const& that) const& -> std::strong_ordering = default;
+public: [[nodiscard]] auto operator==(wide_unpacked const& that) const& -> bool;
+public: wide_unpacked(wide_unpacked const& that);
+
+public: auto operator=(wide_unpacked const& that) -> wide_unpacked& ;
+public: wide_unpacked(wide_unpacked&& that) noexcept;
+public: auto operator=(wide_unpacked&& that) noexcept -> wide_unpacked& ;
+public: explicit wide_unpacked();
+
+#line 29 "pure2-ordered-key-compare.cpp2"
+};
+
+//  A signed member isn't part of a key, so <=> stays defaulted
+class mixed {
+    public: cpp2::u8 a {0}; 
+    public: cpp2::i8 b {0}; 
+    public: [[nodiscard]] auto operator<=>(mixed const& that) const& -> std::strong_ordering = default;
+public: mixed(mixed const& that);
+
+public: auto operator=(mixed const& that) -> mixed& ;
+public: mixed(mixed&& that) noexcept;
+public: auto operator=(mixed&& that) noexcept -> mixed& ;
+public: explicit mixed();
+
+#line 35 "pure2-ordered-key-compare.cpp2"
+};
+
+[[nodiscard]] auto members(cpp2::impl::in<small> x) -> auto;
+[[nodiscard]] auto members(cpp2::impl::in<wide> x) -> auto;
+[[nodiscard]] auto members(cpp2::impl::in<wide_unpacked> x) -> auto;
+[[nodiscard]] auto members(cpp2::impl::in<mixed> x) -> auto;
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-ordered-key-compare.cpp2"
+
+
+[[nodiscard]] auto small::operator<=>(small const& that) const& -> std::strong_ordering { return cpp2::key_compare(std::tie(a, b, c, d), std::tie(that.a, that.b, that.c, that.d)); }
+[[nodiscard]] auto small::operator==(small const& that) const& -> bool { return cpp2::packed_key_equal((*this), that, std::tie(a, b, c, d), std::tie(that.a, that.b, that.c, that.d)); }
+small::small(small const& that)
+                                : a{ that.a }
+                                , b{ that.b }
+                                , c{ that.c }
+                                , d{ that.d }{}
+auto small::operator=(small const& that) -> small& {
+                                a = that.a;
+                                b = that.b;
+                                c = that.c;
+                                d = that.d;
+                                return *this;}
+small::small(small&& that) noexcept
+                                : a{ std::move(that).a }
+                                , b{ std::move(that).b }
+                                , c{ std::move(that).c }
+                                , d{ std::move(that).d }{}
+auto small::operator=(small&& that) noexcept -> small& {
+                                a = std::move(that).a;
+                                b = std::move(that).b;
+                                c = std::move(that).c;
+                                d = std::move(that).d;
+                                return *this;}
+small::small(){}
+[[nodiscard]] auto wide::operator<=>(wide const& that) const& -> std::strong_ordering { return cpp2::key_compare(std::tie(a, b, c, d, e, f), std::tie(that.a, that.b, that.c, that.d, that.e, that.f)); }
+[[nodiscard]] auto wide::operator==(wide const& that) const& -> bool { return cpp2::packed_key_equal((*this), that, std::tie(a, b, c, d, e, f), std::tie(that.a, that.b, that.c, that.d, that.e, that.f)); }
+wide::wide(wide const& that)
+                                : a{ that.a }
+                                , b{ that.b }
+                                , c{ that.c }
+                                , d{ that.d }
+                                , e{ that.e }
+                                , f{ that.f }{}
+auto wide::operator=(wide const& that) -> wide& {
+                                a = that.a;
+                                b = that.b;
+                                c = that.c;
+                                d = that.d;
+                                e = that.e;
+                                f = that.f;
+                                return *this;}
+wide::wide(wide&& that) noexcept
+                                : a{ std::move(that).a }
+                                , b{ std::move(that).b }
+                                , c{ std::move(that).c }
+                                , d{ std::move(that).d }
+                                , e{ std::move(that).e }
+                                , f{ std::move(that).f }{}
+auto wide::operator=(wide&& that) noexcept -> wide& {
+                                a = std::move(that).a;
+                                b = std::move(that).b;
+                                c = std::move(that).c;
+                                d = std::move(that).d;
+                                e = std::move(that).e;
+                                f = std::move(that).f;
+                                return *this;}
+wide::wide(){}
+[[nodiscard]] auto wide_unpacked::operator==(wide_unpacked const& that) const& -> bool { return cpp2::key_equal((*this), that, std::tie(a, b, c, d, e, f), std::tie(that.a, that.b, that.c, that.d, that.e, that.f)); }
+wide_unpacked::wide_unpacked(wide_unpacked const& that)
+                                : a{ that.a }
+                                , b{ that.b }
+                                , c{ that.c }
+                                , d{ that.d }
+                                , e{ that.e }
+                                , f{ that.f }{}
+auto wide_unpacked::operator=(wide_unpacked const& that) -> wide_unpacked& {
+                                a = that.a;
+                                b = that.b;
+                                c = that.c;
+                                d = that.d;
+                                e = that.e;
+                                f = that.f;
+                                return *this;}
+wide_unpacked::wide_unpacked(wide_unpacked&& that) noexcept
+                                : a{ std::move(that).a }
+                                , b{ std::move(that).b }
+                                , c{ std::move(that).c }
+                                , d{ std::move(that).d }
+                                , e{ std::move(that).e }
+                                , f{ std::move(that).f }{}
+auto wide_unpacked::operator=(wide_unpacked&& that) noexcept -> wide_unpacked& {
+                                a = std::move(that).a;
+                                b = std::move(that).b;
+                                c = std::move(that).c;
+                                d = std::move(that).d;
+                                e = std::move(that).e;
+                                f = std::move(that).f;
+                                return *this;}
+wide_unpacked::wide_unpacked(){}
+mixed::mixed(mixed const& that)
+                                : a{ that.a }
+                                , b{ that.b }{}
+auto mixed::operator=(mixed const& that) -> mixed& {
+                                a = that.a;
+                                b = that.b;
+                                return *this;}
+mixed::mixed(mixed&& that) noexcept
+                                : a{ std::move(that).a }
+                                , b{ std::move(that).b }{}
+auto mixed::operator=(mixed&& that) noexcept -> mixed& {
+                                a = std::move(that).a;
+                                b = std::move(that).b;
+                                return *this;}
+mixed::mixed(){}
+#line 37 "pure2-ordered-key-compare.cpp2"
+[[nodiscard]] auto members(cpp2::impl::in<small> x) -> auto { return std::tie(x.a, x.b, x.c, x.d);  }
+#line 38 "pure2-ordered-key-compare.cpp2"
+[[nodiscard]] auto members(cpp2::impl::in<wide> x) -> auto { return std::tie(x.a, x.b, x.c, x.d, x.e, x.f);  }
+#line 39 "pure2-ordered-key-compare.cpp2"
+[[nodiscard]] auto members(cpp2::impl::in<wide_unpacked> x) -> auto { return std::tie(x.a, x.b, x.c, x.d, x.e, x.f);  }
+#line 40 "pure2-ordered-key-compare.cpp2"
+[[nodiscard]] auto members(cpp2::impl::in<mixed> x) -> auto { return std::tie(x.a, x.b);  }
+
+//  Check <=> and == against comparing the members in order, for every pair
+#line 43 "pure2-ordered-key-compare.cpp2"
+template<typename T> auto check(cpp2::impl::in<std::string_view> name, std::vector<T> const& values) -> void{
+    auto mismatches {0}; 
+    for ( auto const& x : values ) {
+        for ( auto const& y : values ) {
+            if ( (x <=> y) != (members(x) <=> members(y)) 
+                || (x == y) != (members(x) == members(y))) 
+            {
+                ++mismatches;
+            }
+        }
+    }
+    std::cout << (cpp2::to_string(name) + ": " + cpp2::to_string(CPP2_UFCS(ssize)(values) * CPP2_UFCS(ssize)(values)) + " pairs, " + cpp2::to_string(cpp2::move(mismatches)) + " mismatches\n");
+}
+
+#line 57 "pure2-ordered-key-compare.cpp2"
+auto main() -> int{
+    std::vector<small> smalls {}; 
+    for ( auto const& a : { 0u, 1u, 0x7fu, 0x80u, 0xffu } ) {
+        for ( auto const& b : { 0u, 1u, 0xffu, 0x100u, 0xffffu } ) {
+            for ( auto const& c : { false, true } ) {
+                for ( auto const& d : { 0x000000u, 0x000001u, 0x000100u, 0x010000u, 0x800000u, 0xffffffu } ) {
+                    small x {}; 
+                    x.a = cpp2::unsafe_narrow<cpp2::u8>(a);
+                    x.b = cpp2::unsafe_narrow<cpp2::u16>(b);
+                    x.c = c;
+                    x.d = { cpp2::unsafe_narrow<cpp2::u8>(d >> 16), cpp2::unsafe_narrow<cpp2::u8>(d >> 8), cpp2::unsafe_narrow<cpp2::u8>(d) };
+                    CPP2_UFCS(push_back)(smalls, cpp2::move(x));
+                }
+            }
+        }
+    }
+    check("small", cpp2::move(smalls));
+
+    std::vector<wide> wides {}; 
+    for ( auto const& a : { 0u, 1u, 0x8000u, 0xffffu } ) {
+        for ( auto const& b : { -1, 0, 5, 6 } ) {
+            for ( auto const& c : { 0u, 1u, 0x80000000u, 0xffffffffu } ) {
+                for ( auto const& d : { 0u, 0xffffu } ) {
+                    for ( auto const& e : { 0u, 0xffu } ) {
+                        for ( auto const& f : { 0u, 0xffu } ) {
+                            wide x {}; 
+                            x.a = cpp2::unsafe_narrow<cpp2::u16>(a);
+                            auto i {0}; 
+                            for ( auto& byte : x.b ) {
+                                byte = cpp2::impl::as_<std::byte>((b == -1 || b == i));
+                                ++i;
+                            }
+                            x.c = c;
+                            x.d = cpp2::unsafe_narrow<cpp2::u16>(d);
+                            x.e = cpp2::unsafe_narrow<cpp2::u8>(e);
+                            x.f = cpp2::unsafe_narrow<cpp2::u8>(f);
+                            CPP2_UFCS(push_back)(wides, cpp2::move(x));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    check("wide", wides);
+
+    std::vector<wide_unpacked> wide_unpackeds {}; 
+    for ( auto const& w : cpp2::move(wides) ) {
+        wide_unpacked x {}; 
+        x.a = w.a;
+        x.b = w.b;
+        x.c = w.c;
+        x.d = w.d;
+        x.e = w.e;
+        x.f = w.f;
+        CPP2_UFCS(push_back)(wide_unpackeds, cpp2::move(x));
+    }
+    check("wide_unpacked", cpp2::move(wide_unpackeds));
+
+    std::vector<mixed> mixeds {}; 
+    for ( auto const& a : { 0u, 1u, 0xffu } ) {
+        for ( auto const& b : { -128, -1, 0, 1, 127 } ) {
+            mixed x {}; 
+            x.a = cpp2::unsafe_narrow<cpp2::u8>(a);
+            x.b = cpp2::unsafe_narrow<cpp2::i8>(b);
+            CPP2_UFCS(push_back)(mixeds, cpp2::move(x));
+        }
+    }
+    check("mixed", cpp2::move(mixeds));
+}
+
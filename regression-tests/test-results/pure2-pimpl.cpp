@@ -0,0 +1,172 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#ifndef __cpp_lib_modules
+#include <map>
+#endif
+
+#line 1 "pure2-pimpl.cpp2"
+
+#line 3 "pure2-pimpl.cpp2"
+class inventory;
+    
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-pimpl.cpp2"
+
+//  The members and the functions that use them are behind a pointer
+#line 3 "pure2-pimpl.cpp2"
+class inventory {
+
+                                               // by item
+
+#line 43 "pure2-pimpl.cpp2"
+    public: [[nodiscard]] static auto make(cpp2::impl::in<std::string> item) -> inventory;
+    private: class _impl;
+public: explicit inventory();
+public: inventory(inventory const& that);
+
+public: auto operator=(inventory const& that) -> inventory& ;
+public: auto add(cpp2::impl::in<std::string> item, cpp2::impl::in<int> n) & -> void;
+public: [[nodiscard]] auto count(cpp2::impl::in<std::string> item) const& -> int;
+public: auto take_all(cpp2::impl::out<std::vector<std::string>> result) & -> void;
+public: [[nodiscard]] auto size() const& -> int;
+public: [[nodiscard]] auto operator==(inventory const& that) const& -> bool;
+public: inventory(inventory&& that) noexcept;
+public: auto operator=(inventory&& that) noexcept -> inventory& ;
+public: ~inventory() noexcept;
+private: std::unique_ptr<_impl> _pimpl {}; 
+#line 48 "pure2-pimpl.cpp2"
+};
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-pimpl.cpp2"
+#line 8 "pure2-pimpl.cpp2"
+
+class inventory::_impl {private: std::vector<std::string> items {}; private: std::map<std::string,int> counts {}; public: explicit _impl();public: _impl(_impl const& that);public: auto operator=(_impl const& that) -> _impl& ;public: _impl(_impl&& that) noexcept;public: auto operator=(_impl&& that) noexcept -> _impl& ;public: auto add(cpp2::impl::in<std::string> item, cpp2::impl::in<int> n) & -> void;public: [[nodiscard]] auto count(cpp2::impl::in<std::string> item) const& -> int;public: auto take_all(cpp2::impl::out<std::vector<std::string>> result) & -> void;public: [[nodiscard]] auto size() const& -> int;public: [[nodiscard]] auto operator==(_impl const& that) const& -> bool;private: auto check() const& -> void;};
+#line 7 "pure2-pimpl.cpp2"
+    inventory::_impl::_impl(){}
+#line 8 "pure2-pimpl.cpp2"
+    inventory::_impl::_impl(_impl const& that)
+        : items{ that.items }
+        , counts{ that.counts }{
+
+#line 11 "pure2-pimpl.cpp2"
+    }
+#line 8 "pure2-pimpl.cpp2"
+    auto inventory::_impl::operator=(_impl const& that) -> _impl& {
+        items = that.items;
+        counts = that.counts;
+        return *this;
+
+#line 11 "pure2-pimpl.cpp2"
+    }
+#line 8 "pure2-pimpl.cpp2"
+    inventory::_impl::_impl(_impl&& that) noexcept
+        : items{ cpp2::move(that).items }
+        , counts{ cpp2::move(that).counts }{
+
+#line 11 "pure2-pimpl.cpp2"
+    }
+#line 8 "pure2-pimpl.cpp2"
+    auto inventory::_impl::operator=(_impl&& that) noexcept -> _impl& {
+        items = cpp2::move(that).items;
+        counts = cpp2::move(that).counts;
+        return *this;
+
+#line 11 "pure2-pimpl.cpp2"
+    }
+
+#line 13 "pure2-pimpl.cpp2"
+    auto inventory::_impl::add(cpp2::impl::in<std::string> item, cpp2::impl::in<int> n) & -> void{
+        if (!(CPP2_UFCS(contains)(counts, item))) {
+            CPP2_UFCS(push_back)(items, item);
+        }
+        CPP2_ASSERT_IN_BOUNDS(counts, item) += n;
+        check();
+    }
+
+#line 21 "pure2-pimpl.cpp2"
+    [[nodiscard]] auto inventory::_impl::count(cpp2::impl::in<std::string> item) const& -> int{
+        //  Not there is zero
+        if (CPP2_UFCS(contains)(counts, item)) {
+            return CPP2_UFCS(at)(counts, item); 
+        }
+        return 0; 
+    }
+
+#line 29 "pure2-pimpl.cpp2"
+    auto inventory::_impl::take_all(cpp2::impl::out<std::vector<std::string>> result) & -> void{
+        result.construct(items);
+        CPP2_UFCS(clear)(items);
+        CPP2_UFCS(clear)(counts);
+    }
+
+#line 35 "pure2-pimpl.cpp2"
+    [[nodiscard]] auto inventory::_impl::size() const& -> int { return CPP2_UFCS(ssize)(items);  }
+
+#line 37 "pure2-pimpl.cpp2"
+    [[nodiscard]] auto inventory::_impl::operator==(_impl const& that) const& -> bool { return counts == that.counts;  }
+
+#line 39 "pure2-pimpl.cpp2"
+    auto inventory::_impl::check() const& -> void{
+        if (cpp2::cpp2_default.is_active() && !(CPP2_UFCS(ssize)(items) == CPP2_UFCS(ssize)(counts)) ) { cpp2::cpp2_default.report_violation(""); }
+    }
+
+#line 43 "pure2-pimpl.cpp2"
+    [[nodiscard]] auto inventory::make(cpp2::impl::in<std::string> item) -> inventory{
+        inventory ret {}; 
+        CPP2_UFCS(add)(ret, item, 1);
+        return ret; 
+    }
+
+    inventory::inventory()
+                             : _pimpl{ CPP2_UFCS_TEMPLATE_NONLOCAL(cpp2_new<_impl>)(cpp2::unique) }{}
+inventory::inventory(inventory const& that)
+                                        : _pimpl{ CPP2_UFCS_TEMPLATE_NONLOCAL(cpp2_new<_impl>)(cpp2::unique, *cpp2::impl::assert_not_null(that._pimpl)) }{}
+
+auto inventory::operator=(inventory const& that) -> inventory& {
+                                        _pimpl = CPP2_UFCS_TEMPLATE_NONLOCAL(cpp2_new<_impl>)(cpp2::unique, *cpp2::impl::assert_not_null(that._pimpl));
+                                        return *this;}
+auto inventory::add(cpp2::impl::in<std::string> item, cpp2::impl::in<int> n) & -> void { CPP2_UFCS(add)((*cpp2::impl::assert_not_null(_pimpl)), item, n); }
+[[nodiscard]] auto inventory::count(cpp2::impl::in<std::string> item) const& -> int { return CPP2_UFCS(count)((*cpp2::impl::assert_not_null(_pimpl)), item); }
+auto inventory::take_all(cpp2::impl::out<std::vector<std::string>> result) & -> void { CPP2_UFCS(take_all)((*cpp2::impl::assert_not_null(_pimpl)), cpp2::impl::out(&result)); }
+[[nodiscard]] auto inventory::size() const& -> int { return CPP2_UFCS(size)((*cpp2::impl::assert_not_null(_pimpl))); }
+[[nodiscard]] auto inventory::operator==(inventory const& that) const& -> bool { return CPP2_UFCS(operator==)((*cpp2::impl::assert_not_null(_pimpl)), *cpp2::impl::assert_not_null(that._pimpl)); }
+inventory::inventory(inventory&& that) noexcept
+                                         : _pimpl{ cpp2::move(that)._pimpl }{}
+auto inventory::operator=(inventory&& that) noexcept -> inventory& {
+                                         _pimpl = cpp2::move(that)._pimpl;
+                                         return *this;}
+inventory::~inventory() noexcept{}
+
+#line 50 "pure2-pimpl.cpp2"
+auto main() -> int{
+    auto a {inventory::make("apple")}; 
+    CPP2_UFCS(add)(a, "pear", 3);
+    CPP2_UFCS(add)(a, "apple", 2);
+
+    auto b {a}; 
+    CPP2_UFCS(add)(b, "plum", 1);
+    std::cout << ("a has " + cpp2::to_string(CPP2_UFCS(size)(a)) + " items, " + cpp2::to_string(CPP2_UFCS(count)(a, "apple")) + " apples\n");
+    std::cout << ("b has " + cpp2::to_string(CPP2_UFCS(size)(b)) + " items, " + cpp2::to_string(CPP2_UFCS(count)(b, "plum")) + " plums\n");
+    std::cout << ("a == b is " + cpp2::to_string(cpp2::move(a) == b) + "\n");
+
+    auto c {cpp2::move(b)}; // last use, so this moves
+    cpp2::impl::deferred_init<std::vector<std::string>> all; 
+    CPP2_UFCS(take_all)(c, cpp2::impl::out(&all));
+    for ( auto const& item : cpp2::move(all.value()) ) {
+        std::cout << item << " ";
+    }
+    std::cout << ("\nc has " + cpp2::to_string(CPP2_UFCS(size)(cpp2::move(c))) + " items\n");
+}
+
@@ -78,7 +78,6 @@ CPP2_REQUIRES_ (cpp2::impl::cmp_greater_eq(sizeof...(Args),0u)) ;
 #line 103 "pure2-print.cpp2"
 };
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,18 +1,24 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <map>
+#include <ostream>
+#endif
+
 #line 1 "pure2-raw-string-literal-and-interpolation.cpp2"
 
 
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-raw-string-literal-and-interpolation.cpp2"
-[[nodiscard]] auto main() -> int;
+
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,25 +1,23 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <ostream>
+#endif
+
 #line 1 "pure2-repeated-call.cpp2"
 
 
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-repeated-call.cpp2"
-[[nodiscard]] auto f0() -> auto;
-#line 2 "pure2-repeated-call.cpp2"
-[[nodiscard]] auto f1() -> auto;
-[[nodiscard]] auto f2() -> auto;
-[[nodiscard]] auto f3() -> auto;
-[[nodiscard]] auto f4() -> auto;
 
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -45,9 +46,6 @@ CPP2_REQUIRES (true) ;
 template<typename T> 
 CPP2_REQUIRES_ (std::same_as<T,cpp2::i32>) extern T const v;
 
-#line 22 "pure2-requires-clauses.cpp2"
-auto main() -> int;
-
 //=== Cpp2 function definitions =================================================
 
 #line 1 "pure2-requires-clauses.cpp2"
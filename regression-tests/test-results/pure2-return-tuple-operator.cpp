@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -43,8 +44,6 @@ struct operator_subscript_ret { int x; int y; };
 #line 18 "pure2-return-tuple-operator.cpp2"
 };
 
-#line 21 "pure2-return-tuple-operator.cpp2"
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -0,0 +1,507 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#ifndef __cpp_lib_modules
+#include <cmath>
+#ifdef __cpp_lib_print
+    #include <print>
+#endif
+#include <set>
+#endif
+
+#line 1 "pure2-simd-vector.cpp2"
+
+#line 2 "pure2-simd-vector.cpp2"
+class vec3;
+    
+
+#line 8 "pure2-simd-vector.cpp2"
+class rgba;
+    
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-simd-vector.cpp2"
+
+#line 2 "pure2-simd-vector.cpp2"
+class vec3 {
+    public: float x {0}; 
+    public: float y {0}; 
+    public: float z {0}; 
+    public: using value_type = cpp2::simd_element<float>;
+public: auto operator+=(vec3 const& that) & -> void;
+public: [[nodiscard]] auto operator+(vec3 const& that) const& -> vec3;
+public: auto operator-=(vec3 const& that) & -> void;
+public: [[nodiscard]] auto operator-(vec3 const& that) const& -> vec3;
+public: auto operator*=(vec3 const& that) & -> void;
+public: [[nodiscard]] auto operator*(vec3 const& that) const& -> vec3;
+public: auto operator/=(vec3 const& that) & -> void;
+public: [[nodiscard]] auto operator/(vec3 const& that) const& -> vec3;
+public: auto operator*=(cpp2::impl::in<value_type> s) & -> void;
+public: [[nodiscard]] auto operator*(cpp2::impl::in<value_type> s) const& -> vec3;
+public: auto operator/=(cpp2::impl::in<value_type> s) & -> void;
+public: [[nodiscard]] auto operator/(cpp2::impl::in<value_type> s) const& -> vec3;
+public: [[nodiscard]] auto operator-() const& -> vec3;
+public: [[nodiscard]] auto dot(vec3 const& that) const& -> value_type;
+public: [[nodiscard]] auto min(vec3 const& that) const& -> vec3;
+public: [[nodiscard]] auto max(vec3 const& that) const& -> vec3;
+public: [[nodiscard]] auto abs() const& -> vec3;
+public: class batch {
+    public: std::vector<value_type> x {}; 
+    public: std::vector<value_type> y {}; 
+    public: std::vector<value_type> z {}; 
+    public: [[nodiscard]] auto size() const& -> std::size_t;
+
+    public: [[nodiscard]] auto ssize() const& -> std::ptrdiff_t;
+
+    public: auto resize(cpp2::impl::in<std::size_t> n) & -> void;
+
+    public: auto reserve(cpp2::impl::in<std::size_t> n) & -> void;
+
+    public: auto push_back(cpp2::impl::in<vec3> v) & -> void;
+
+    public: [[nodiscard]] auto get(cpp2::impl::in<std::ptrdiff_t> i) const& -> vec3;
+
+    public: auto set(cpp2::impl::in<std::ptrdiff_t> i, cpp2::impl::in<vec3> v) & -> void;
+
+    public: auto operator+=(batch const& that) & -> void;
+
+    public: auto operator-=(batch const& that) & -> void;
+
+    public: auto operator*=(batch const& that) & -> void;
+
+    public: auto operator/=(batch const& that) & -> void;
+
+    public: auto operator*=(cpp2::impl::in<value_type> s) & -> void;
+
+    public: auto operator/=(cpp2::impl::in<value_type> s) & -> void;
+
+    public: auto add_scaled(cpp2::impl::in<batch> other, cpp2::impl::in<value_type> s) & -> void;
+
+          public: batch() = default;
+          public: batch(batch const&) = delete; /* No 'that' constructor, suppress copy */
+          public: auto operator=(batch const&) -> void = delete;
+
+    };
+
+#line 6 "pure2-simd-vector.cpp2"
+};
+
+class rgba {
+    public: cpp2::u8 r {0}; 
+    public: cpp2::u8 g {0}; 
+    public: cpp2::u8 b {0}; 
+    public: cpp2::u8 a {0}; 
+    public: using value_type = cpp2::simd_element<cpp2::u8>;
+public: auto operator+=(rgba const& that) & -> void;
+public: [[nodiscard]] auto operator+(rgba const& that) const& -> rgba;
+public: auto operator-=(rgba const& that) & -> void;
+public: [[nodiscard]] auto operator-(rgba const& that) const& -> rgba;
+public: auto operator*=(rgba const& that) & -> void;
+public: [[nodiscard]] auto operator*(rgba const& that) const& -> rgba;
+public: auto operator/=(rgba const& that) & -> void;
+public: [[nodiscard]] auto operator/(rgba const& that) const& -> rgba;
+public: auto operator*=(cpp2::impl::in<value_type> s) & -> void;
+public: [[nodiscard]] auto operator*(cpp2::impl::in<value_type> s) const& -> rgba;
+public: auto operator/=(cpp2::impl::in<value_type> s) & -> void;
+public: [[nodiscard]] auto operator/(cpp2::impl::in<value_type> s) const& -> rgba;
+public: [[nodiscard]] auto operator-() const& -> rgba;
+public: [[nodiscard]] auto dot(rgba const& that) const& -> value_type;
+public: [[nodiscard]] auto min(rgba const& that) const& -> rgba;
+public: [[nodiscard]] auto max(rgba const& that) const& -> rgba;
+public: [[nodiscard]] auto abs() const& -> rgba;
+public: class batch {
+    public: std::vector<value_type> r {}; 
+    public: std::vector<value_type> g {}; 
+    public: std::vector<value_type> b {}; 
+    public: std::vector<value_type> a {}; 
+    public: [[nodiscard]] auto size() const& -> std::size_t;
+
+    public: [[nodiscard]] auto ssize() const& -> std::ptrdiff_t;
+
+    public: auto resize(cpp2::impl::in<std::size_t> n) & -> void;
+
+    public: auto reserve(cpp2::impl::in<std::size_t> n) & -> void;
+
+    public: auto push_back(cpp2::impl::in<rgba> v) & -> void;
+
+    public: [[nodiscard]] auto get(cpp2::impl::in<std::ptrdiff_t> i) const& -> rgba;
+
+    public: auto set(cpp2::impl::in<std::ptrdiff_t> i, cpp2::impl::in<rgba> v) & -> void;
+
+    public: auto operator+=(batch const& that) & -> void;
+
+    public: auto operator-=(batch const& that) & -> void;
+
+    public: auto operator*=(batch const& that) & -> void;
+
+    public: auto operator/=(batch const& that) & -> void;
+
+    public: auto operator*=(cpp2::impl::in<value_type> s) & -> void;
+
+    public: auto operator/=(cpp2::impl::in<value_type> s) & -> void;
+
+    public: auto add_scaled(cpp2::impl::in<batch> other, cpp2::impl::in<value_type> s) & -> void;
+
+          public: batch() = default;
+          public: batch(batch const&) = delete; /* No 'that' constructor, suppress copy */
+          public: auto operator=(batch const&) -> void = delete;
+
+    };
+
+#line 13 "pure2-simd-vector.cpp2"
+};
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-simd-vector.cpp2"
+
+#line 1 "pure2-simd-vector.cpp2"
+
+auto vec3::operator+=(vec3 const& that) & -> void{
+x += that.x;
+y += that.y;
+z += that.z;}
+
+[[nodiscard]] auto vec3::operator+(vec3 const& that) const& -> vec3{
+vec3 ret {(*this)}; ret += that;return ret; }
+auto vec3::operator-=(vec3 const& that) & -> void{
+x -= that.x;
+y -= that.y;
+z -= that.z;}
+
+[[nodiscard]] auto vec3::operator-(vec3 const& that) const& -> vec3{
+vec3 ret {(*this)}; ret -= that;return ret; }
+auto vec3::operator*=(vec3 const& that) & -> void{
+x *= that.x;
+y *= that.y;
+z *= that.z;}
+
+[[nodiscard]] auto vec3::operator*(vec3 const& that) const& -> vec3{
+vec3 ret {(*this)}; ret *= that;return ret; }
+auto vec3::operator/=(vec3 const& that) & -> void{
+x /= that.x;
+y /= that.y;
+z /= that.z;}
+
+[[nodiscard]] auto vec3::operator/(vec3 const& that) const& -> vec3{
+vec3 ret {(*this)}; ret /= that;return ret; }
+auto vec3::operator*=(cpp2::impl::in<value_type> s) & -> void{
+x *= s;
+y *= s;
+z *= s;}
+
+[[nodiscard]] auto vec3::operator*(cpp2::impl::in<value_type> s) const& -> vec3{
+vec3 ret {(*this)}; ret *= s;return ret; }
+auto vec3::operator/=(cpp2::impl::in<value_type> s) & -> void{
+x /= s;
+y /= s;
+z /= s;}
+
+[[nodiscard]] auto vec3::operator/(cpp2::impl::in<value_type> s) const& -> vec3{
+vec3 ret {(*this)}; ret /= s;return ret; }
+[[nodiscard]] auto vec3::operator-() const& -> vec3{
+vec3 ret {(*this)}; 
+ret.x = -x;
+ret.y = -y;
+ret.z = -z;return ret; }
+
+[[nodiscard]] auto vec3::dot(vec3 const& that) const& -> value_type { return value_type() + x * that.x + y * that.y + z * that.z; }
+[[nodiscard]] auto vec3::min(vec3 const& that) const& -> vec3{
+vec3 ret {(*this)}; 
+ret.x = std::min(x, that.x);
+ret.y = std::min(y, that.y);
+ret.z = std::min(z, that.z);return ret; }
+
+[[nodiscard]] auto vec3::max(vec3 const& that) const& -> vec3{
+vec3 ret {(*this)}; 
+ret.x = std::max(x, that.x);
+ret.y = std::max(y, that.y);
+ret.z = std::max(z, that.z);return ret; }
+
+[[nodiscard]] auto vec3::abs() const& -> vec3{
+vec3 ret {(*this)}; 
+ret.x = cpp2::abs_value(x);
+ret.y = cpp2::abs_value(y);
+ret.z = cpp2::abs_value(z);return ret; }
+#line 1 "pure2-simd-vector.cpp2"
+
+[[nodiscard]] auto vec3::batch::size() const& -> std::size_t { return CPP2_UFCS(size)(x); }
+
+[[nodiscard]] auto vec3::batch::ssize() const& -> std::ptrdiff_t { return std::ssize(x); }
+
+auto vec3::batch::resize(cpp2::impl::in<std::size_t> n) & -> void{
+CPP2_UFCS(resize)(x, n);
+CPP2_UFCS(resize)(y, n);
+CPP2_UFCS(resize)(z, n);}
+
+auto vec3::batch::reserve(cpp2::impl::in<std::size_t> n) & -> void{
+CPP2_UFCS(reserve)(x, n);
+CPP2_UFCS(reserve)(y, n);
+CPP2_UFCS(reserve)(z, n);}
+
+auto vec3::batch::push_back(cpp2::impl::in<vec3> v) & -> void{
+CPP2_UFCS(push_back)(x, v.x);
+CPP2_UFCS(push_back)(y, v.y);
+CPP2_UFCS(push_back)(z, v.z);}
+
+[[nodiscard]] auto vec3::batch::get(cpp2::impl::in<std::ptrdiff_t> i) const& -> vec3{
+vec3 ret {}; 
+ret.x = CPP2_ASSERT_IN_BOUNDS(x, i);
+ret.y = CPP2_ASSERT_IN_BOUNDS(y, i);
+ret.z = CPP2_ASSERT_IN_BOUNDS(z, i);return ret; }
+
+auto vec3::batch::set(cpp2::impl::in<std::ptrdiff_t> i, cpp2::impl::in<vec3> v) & -> void{
+CPP2_ASSERT_IN_BOUNDS(x, i) = v.x;
+CPP2_ASSERT_IN_BOUNDS(y, i) = v.y;
+CPP2_ASSERT_IN_BOUNDS(z, i) = v.z;}
+
+auto vec3::batch::operator+=(batch const& that) & -> void{
+            if (cpp2::bounds_safety.is_active() && !(CPP2_UFCS(size)(that) == size()) ) { cpp2::bounds_safety.report_violation(""); }
+cpp2::elementwise(CPP2_UFCS(size)(x), std::plus(), CPP2_UFCS(data)(x), CPP2_UFCS(data)(x), CPP2_UFCS(data)(that.x));
+cpp2::elementwise(CPP2_UFCS(size)(y), std::plus(), CPP2_UFCS(data)(y), CPP2_UFCS(data)(y), CPP2_UFCS(data)(that.y));
+cpp2::elementwise(CPP2_UFCS(size)(z), std::plus(), CPP2_UFCS(data)(z), CPP2_UFCS(data)(z), CPP2_UFCS(data)(that.z));}
+
+auto vec3::batch::operator-=(batch const& that) & -> void{
+            if (cpp2::bounds_safety.is_active() && !(CPP2_UFCS(size)(that) == size()) ) { cpp2::bounds_safety.report_violation(""); }
+cpp2::elementwise(CPP2_UFCS(size)(x), std::minus(), CPP2_UFCS(data)(x), CPP2_UFCS(data)(x), CPP2_UFCS(data)(that.x));
+cpp2::elementwise(CPP2_UFCS(size)(y), std::minus(), CPP2_UFCS(data)(y), CPP2_UFCS(data)(y), CPP2_UFCS(data)(that.y));
+cpp2::elementwise(CPP2_UFCS(size)(z), std::minus(), CPP2_UFCS(data)(z), CPP2_UFCS(data)(z), CPP2_UFCS(data)(that.z));}
+
+auto vec3::batch::operator*=(batch const& that) & -> void{
+            if (cpp2::bounds_safety.is_active() && !(CPP2_UFCS(size)(that) == size()) ) { cpp2::bounds_safety.report_violation(""); }
+cpp2::elementwise(CPP2_UFCS(size)(x), std::multiplies(), CPP2_UFCS(data)(x), CPP2_UFCS(data)(x), CPP2_UFCS(data)(that.x));
+cpp2::elementwise(CPP2_UFCS(size)(y), std::multiplies(), CPP2_UFCS(data)(y), CPP2_UFCS(data)(y), CPP2_UFCS(data)(that.y));
+cpp2::elementwise(CPP2_UFCS(size)(z), std::multiplies(), CPP2_UFCS(data)(z), CPP2_UFCS(data)(z), CPP2_UFCS(data)(that.z));}
+
+auto vec3::batch::operator/=(batch const& that) & -> void{
+            if (cpp2::bounds_safety.is_active() && !(CPP2_UFCS(size)(that) == size()) ) { cpp2::bounds_safety.report_violation(""); }
+cpp2::elementwise(CPP2_UFCS(size)(x), std::divides(), CPP2_UFCS(data)(x), CPP2_UFCS(data)(x), CPP2_UFCS(data)(that.x));
+cpp2::elementwise(CPP2_UFCS(size)(y), std::divides(), CPP2_UFCS(data)(y), CPP2_UFCS(data)(y), CPP2_UFCS(data)(that.y));
+cpp2::elementwise(CPP2_UFCS(size)(z), std::divides(), CPP2_UFCS(data)(z), CPP2_UFCS(data)(z), CPP2_UFCS(data)(that.z));}
+
+auto vec3::batch::operator*=(cpp2::impl::in<value_type> s) & -> void{
+cpp2::elementwise(CPP2_UFCS(size)(x), std::multiplies(), CPP2_UFCS(data)(x), CPP2_UFCS(data)(x), s);
+cpp2::elementwise(CPP2_UFCS(size)(y), std::multiplies(), CPP2_UFCS(data)(y), CPP2_UFCS(data)(y), s);
+cpp2::elementwise(CPP2_UFCS(size)(z), std::multiplies(), CPP2_UFCS(data)(z), CPP2_UFCS(data)(z), s);}
+
+auto vec3::batch::operator/=(cpp2::impl::in<value_type> s) & -> void{
+cpp2::elementwise(CPP2_UFCS(size)(x), std::divides(), CPP2_UFCS(data)(x), CPP2_UFCS(data)(x), s);
+cpp2::elementwise(CPP2_UFCS(size)(y), std::divides(), CPP2_UFCS(data)(y), CPP2_UFCS(data)(y), s);
+cpp2::elementwise(CPP2_UFCS(size)(z), std::divides(), CPP2_UFCS(data)(z), CPP2_UFCS(data)(z), s);}
+
+auto vec3::batch::add_scaled(cpp2::impl::in<batch> other, cpp2::impl::in<value_type> s) & -> void{
+            if (cpp2::bounds_safety.is_active() && !(CPP2_UFCS(size)(other) == size()) ) { cpp2::bounds_safety.report_violation(""); }
+cpp2::elementwise(CPP2_UFCS(size)(x), cpp2::multiply_add, CPP2_UFCS(data)(x), CPP2_UFCS(data)(x), CPP2_UFCS(data)(other.x), s);
+cpp2::elementwise(CPP2_UFCS(size)(y), cpp2::multiply_add, CPP2_UFCS(data)(y), CPP2_UFCS(data)(y), CPP2_UFCS(data)(other.y), s);
+cpp2::elementwise(CPP2_UFCS(size)(z), cpp2::multiply_add, CPP2_UFCS(data)(z), CPP2_UFCS(data)(z), CPP2_UFCS(data)(other.z), s);}
+#line 1 "pure2-simd-vector.cpp2"
+
+auto rgba::operator+=(rgba const& that) & -> void{
+r += that.r;
+g += that.g;
+b += that.b;
+a += that.a;}
+
+[[nodiscard]] auto rgba::operator+(rgba const& that) const& -> rgba{
+rgba ret {(*this)}; ret += that;return ret; }
+auto rgba::operator-=(rgba const& that) & -> void{
+r -= that.r;
+g -= that.g;
+b -= that.b;
+a -= that.a;}
+
+[[nodiscard]] auto rgba::operator-(rgba const& that) const& -> rgba{
+rgba ret {(*this)}; ret -= that;return ret; }
+auto rgba::operator*=(rgba const& that) & -> void{
+r *= that.r;
+g *= that.g;
+b *= that.b;
+a *= that.a;}
+
+[[nodiscard]] auto rgba::operator*(rgba const& that) const& -> rgba{
+rgba ret {(*this)}; ret *= that;return ret; }
+auto rgba::operator/=(rgba const& that) & -> void{
+r /= that.r;
+g /= that.g;
+b /= that.b;
+a /= that.a;}
+
+[[nodiscard]] auto rgba::operator/(rgba const& that) const& -> rgba{
+rgba ret {(*this)}; ret /= that;return ret; }
+auto rgba::operator*=(cpp2::impl::in<value_type> s) & -> void{
+r *= s;
+g *= s;
+b *= s;
+a *= s;}
+
+[[nodiscard]] auto rgba::operator*(cpp2::impl::in<value_type> s) const& -> rgba{
+rgba ret {(*this)}; ret *= s;return ret; }
+auto rgba::operator/=(cpp2::impl::in<value_type> s) & -> void{
+r /= s;
+g /= s;
+b /= s;
+a /= s;}
+
+[[nodiscard]] auto rgba::operator/(cpp2::impl::in<value_type> s) const& -> rgba{
+rgba ret {(*this)}; ret /= s;return ret; }
+[[nodiscard]] auto rgba::operator-() const& -> rgba{
+rgba ret {(*this)}; 
+ret.r = -r;
+ret.g = -g;
+ret.b = -b;
+ret.a = -a;return ret; }
+
+[[nodiscard]] auto rgba::dot(rgba const& that) const& -> value_type { return value_type() + r * that.r + g * that.g + b * that.b + a * that.a; }
+[[nodiscard]] auto rgba::min(rgba const& that) const& -> rgba{
+rgba ret {(*this)}; 
+ret.r = std::min(r, that.r);
+ret.g = std::min(g, that.g);
+ret.b = std::min(b, that.b);
+ret.a = std::min(a, that.a);return ret; }
+
+[[nodiscard]] auto rgba::max(rgba const& that) const& -> rgba{
+rgba ret {(*this)}; 
+ret.r = std::max(r, that.r);
+ret.g = std::max(g, that.g);
+ret.b = std::max(b, that.b);
+ret.a = std::max(a, that.a);return ret; }
+
+[[nodiscard]] auto rgba::abs() const& -> rgba{
+rgba ret {(*this)}; 
+ret.r = cpp2::abs_value(r);
+ret.g = cpp2::abs_value(g);
+ret.b = cpp2::abs_value(b);
+ret.a = cpp2::abs_value(a);return ret; }
+#line 1 "pure2-simd-vector.cpp2"
+
+[[nodiscard]] auto rgba::batch::size() const& -> std::size_t { return CPP2_UFCS(size)(r); }
+
+[[nodiscard]] auto rgba::batch::ssize() const& -> std::ptrdiff_t { return std::ssize(r); }
+
+auto rgba::batch::resize(cpp2::impl::in<std::size_t> n) & -> void{
+CPP2_UFCS(resize)(r, n);
+CPP2_UFCS(resize)(g, n);
+CPP2_UFCS(resize)(b, n);
+CPP2_UFCS(resize)(a, n);}
+
+auto rgba::batch::reserve(cpp2::impl::in<std::size_t> n) & -> void{
+CPP2_UFCS(reserve)(r, n);
+CPP2_UFCS(reserve)(g, n);
+CPP2_UFCS(reserve)(b, n);
+CPP2_UFCS(reserve)(a, n);}
+
+auto rgba::batch::push_back(cpp2::impl::in<rgba> v) & -> void{
+CPP2_UFCS(push_back)(r, v.r);
+CPP2_UFCS(push_back)(g, v.g);
+CPP2_UFCS(push_back)(b, v.b);
+CPP2_UFCS(push_back)(a, v.a);}
+
+[[nodiscard]] auto rgba::batch::get(cpp2::impl::in<std::ptrdiff_t> i) const& -> rgba{
+rgba ret {}; 
+ret.r = CPP2_ASSERT_IN_BOUNDS(r, i);
+ret.g = CPP2_ASSERT_IN_BOUNDS(g, i);
+ret.b = CPP2_ASSERT_IN_BOUNDS(b, i);
+ret.a = CPP2_ASSERT_IN_BOUNDS(a, i);return ret; }
+
+auto rgba::batch::set(cpp2::impl::in<std::ptrdiff_t> i, cpp2::impl::in<rgba> v) & -> void{
+CPP2_ASSERT_IN_BOUNDS(r, i) = v.r;
+CPP2_ASSERT_IN_BOUNDS(g, i) = v.g;
+CPP2_ASSERT_IN_BOUNDS(b, i) = v.b;
+CPP2_ASSERT_IN_BOUNDS(a, i) = v.a;}
+
+auto rgba::batch::operator+=(batch const& that) & -> void{
+            if (cpp2::bounds_safety.is_active() && !(CPP2_UFCS(size)(that) == size()) ) { cpp2::bounds_safety.report_violation(""); }
+cpp2::elementwise(CPP2_UFCS(size)(r), std::plus(), CPP2_UFCS(data)(r), CPP2_UFCS(data)(r), CPP2_UFCS(data)(that.r));
+cpp2::elementwise(CPP2_UFCS(size)(g), std::plus(), CPP2_UFCS(data)(g), CPP2_UFCS(data)(g), CPP2_UFCS(data)(that.g));
+cpp2::elementwise(CPP2_UFCS(size)(b), std::plus(), CPP2_UFCS(data)(b), CPP2_UFCS(data)(b), CPP2_UFCS(data)(that.b));
+cpp2::elementwise(CPP2_UFCS(size)(a), std::plus(), CPP2_UFCS(data)(a), CPP2_UFCS(data)(a), CPP2_UFCS(data)(that.a));}
+
+auto rgba::batch::operator-=(batch const& that) & -> void{
+            if (cpp2::bounds_safety.is_active() && !(CPP2_UFCS(size)(that) == size()) ) { cpp2::bounds_safety.report_violation(""); }
+cpp2::elementwise(CPP2_UFCS(size)(r), std::minus(), CPP2_UFCS(data)(r), CPP2_UFCS(data)(r), CPP2_UFCS(data)(that.r));
+cpp2::elementwise(CPP2_UFCS(size)(g), std::minus(), CPP2_UFCS(data)(g), CPP2_UFCS(data)(g), CPP2_UFCS(data)(that.g));
+cpp2::elementwise(CPP2_UFCS(size)(b), std::minus(), CPP2_UFCS(data)(b), CPP2_UFCS(data)(b), CPP2_UFCS(data)(that.b));
+cpp2::elementwise(CPP2_UFCS(size)(a), std::minus(), CPP2_UFCS(data)(a), CPP2_UFCS(data)(a), CPP2_UFCS(data)(that.a));}
+
+auto rgba::batch::operator*=(batch const& that) & -> void{
+            if (cpp2::bounds_safety.is_active() && !(CPP2_UFCS(size)(that) == size()) ) { cpp2::bounds_safety.report_violation(""); }
+cpp2::elementwise(CPP2_UFCS(size)(r), std::multiplies(), CPP2_UFCS(data)(r), CPP2_UFCS(data)(r), CPP2_UFCS(data)(that.r));
+cpp2::elementwise(CPP2_UFCS(size)(g), std::multiplies(), CPP2_UFCS(data)(g), CPP2_UFCS(data)(g), CPP2_UFCS(data)(that.g));
+cpp2::elementwise(CPP2_UFCS(size)(b), std::multiplies(), CPP2_UFCS(data)(b), CPP2_UFCS(data)(b), CPP2_UFCS(data)(that.b));
+cpp2::elementwise(CPP2_UFCS(size)(a), std::multiplies(), CPP2_UFCS(data)(a), CPP2_UFCS(data)(a), CPP2_UFCS(data)(that.a));}
+
+auto rgba::batch::operator/=(batch const& that) & -> void{
+            if (cpp2::bounds_safety.is_active() && !(CPP2_UFCS(size)(that) == size()) ) { cpp2::bounds_safety.report_violation(""); }
+cpp2::elementwise(CPP2_UFCS(size)(r), std::divides(), CPP2_UFCS(data)(r), CPP2_UFCS(data)(r), CPP2_UFCS(data)(that.r));
+cpp2::elementwise(CPP2_UFCS(size)(g), std::divides(), CPP2_UFCS(data)(g), CPP2_UFCS(data)(g), CPP2_UFCS(data)(that.g));
+cpp2::elementwise(CPP2_UFCS(size)(b), std::divides(), CPP2_UFCS(data)(b), CPP2_UFCS(data)(b), CPP2_UFCS(data)(that.b));
+cpp2::elementwise(CPP2_UFCS(size)(a), std::divides(), CPP2_UFCS(data)(a), CPP2_UFCS(data)(a), CPP2_UFCS(data)(that.a));}
+
+auto rgba::batch::operator*=(cpp2::impl::in<value_type> s) & -> void{
+cpp2::elementwise(CPP2_UFCS(size)(r), std::multiplies(), CPP2_UFCS(data)(r), CPP2_UFCS(data)(r), s);
+cpp2::elementwise(CPP2_UFCS(size)(g), std::multiplies(), CPP2_UFCS(data)(g), CPP2_UFCS(data)(g), s);
+cpp2::elementwise(CPP2_UFCS(size)(b), std::multiplies(), CPP2_UFCS(data)(b), CPP2_UFCS(data)(b), s);
+cpp2::elementwise(CPP2_UFCS(size)(a), std::multiplies(), CPP2_UFCS(data)(a), CPP2_UFCS(data)(a), s);}
+
+auto rgba::batch::operator/=(cpp2::impl::in<value_type> s) & -> void{
+cpp2::elementwise(CPP2_UFCS(size)(r), std::divides(), CPP2_UFCS(data)(r), CPP2_UFCS(data)(r), s);
+cpp2::elementwise(CPP2_UFCS(size)(g), std::divides(), CPP2_UFCS(data)(g), CPP2_UFCS(data)(g), s);
+cpp2::elementwise(CPP2_UFCS(size)(b), std::divides(), CPP2_UFCS(data)(b), CPP2_UFCS(data)(b), s);
+cpp2::elementwise(CPP2_UFCS(size)(a), std::divides(), CPP2_UFCS(data)(a), CPP2_UFCS(data)(a), s);}
+
+auto rgba::batch::add_scaled(cpp2::impl::in<batch> other, cpp2::impl::in<value_type> s) & -> void{
+            if (cpp2::bounds_safety.is_active() && !(CPP2_UFCS(size)(other) == size()) ) { cpp2::bounds_safety.report_violation(""); }
+cpp2::elementwise(CPP2_UFCS(size)(r), cpp2::multiply_add, CPP2_UFCS(data)(r), CPP2_UFCS(data)(r), CPP2_UFCS(data)(other.r), s);
+cpp2::elementwise(CPP2_UFCS(size)(g), cpp2::multiply_add, CPP2_UFCS(data)(g), CPP2_UFCS(data)(g), CPP2_UFCS(data)(other.g), s);
+cpp2::elementwise(CPP2_UFCS(size)(b), cpp2::multiply_add, CPP2_UFCS(data)(b), CPP2_UFCS(data)(b), CPP2_UFCS(data)(other.b), s);
+cpp2::elementwise(CPP2_UFCS(size)(a), cpp2::multiply_add, CPP2_UFCS(data)(a), CPP2_UFCS(data)(a), CPP2_UFCS(data)(other.a), s);}
+#line 15 "pure2-simd-vector.cpp2"
+auto print(cpp2::impl::in<vec3> v) -> void { std::cout << ("(" + cpp2::to_string(v.x) + ", " + cpp2::to_string(v.y) + ", " + cpp2::to_string(v.z) + ")\n");  }
+
+#line 17 "pure2-simd-vector.cpp2"
+auto main() -> int{
+    vec3 a {1.0f, -2.0f, 3.0f}; 
+    vec3 b {4.0f, 5.0f, -6.0f}; 
+
+    auto c {a + b * 2.0f}; 
+    c -= a;
+    print(cpp2::move(c));
+    print(-a / 2.0f);
+    print(CPP2_UFCS(abs)(CPP2_UFCS(min)(a, b)));
+    print(CPP2_UFCS(max)(a, b));
+    std::cout << ("a dot b is " + cpp2::to_string(CPP2_UFCS(dot)(a, b)) + "\n");
+
+    //  Structure-of-arrays particles
+    vec3::batch pos {}; 
+    vec3::batch vel {}; 
+{
+auto i{0};
+#line 32 "pure2-simd-vector.cpp2"
+    for( ; cpp2::impl::cmp_less(i,10); ++i ) {
+        CPP2_UFCS(push_back)(pos, a);
+        CPP2_UFCS(push_back)(vel, b);
+    }
+}
+#line 36 "pure2-simd-vector.cpp2"
+    CPP2_UFCS(add_scaled)(pos, vel, 0.5f);
+    pos *= 2.0f;
+    pos += cpp2::move(vel);
+    std::cout << (cpp2::to_string(CPP2_UFCS(ssize)(pos)) + " particles, the last is at ");
+    print(CPP2_UFCS(get)(cpp2::move(pos), 9));
+
+    rgba::batch colors {}; 
+    CPP2_UFCS(resize)(colors, 20u);
+    CPP2_UFCS(set)(colors, 19, rgba{10u, 20u, 30u, 255u});
+    colors += colors;
+    auto last {CPP2_UFCS(get)(cpp2::move(colors), 19)}; 
+    std::cout << ("last color is (" + cpp2::to_string(cpp2::impl::as_<int>(last.r)) + ", " + cpp2::to_string(cpp2::impl::as_<int>(last.g)) + ", " + cpp2::to_string(cpp2::impl::as_<int>(last.b)) + ", " + cpp2::to_string(cpp2::impl::as_<int>(last.a)) + ")\n");
+}
+
@@ -0,0 +1,91 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "pure2-slot-map.cpp2"
+
+#line 2 "pure2-slot-map.cpp2"
+class entity;
+    
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-slot-map.cpp2"
+
+#line 2 "pure2-slot-map.cpp2"
+class entity {
+    public: std::string name {}; 
+    public: cpp2::i32 hp {0}; 
+
+    public: explicit entity(cpp2::impl::in<std::string> n, cpp2::impl::in<cpp2::i32> h);
+    public: entity(entity&& that) noexcept;
+
+public: auto operator=(entity&& that) noexcept -> entity& ;
+public: using slots = cpp2::slot_map<entity>;
+public: using handle = cpp2::slot_handle<entity>;
+
+#line 10 "pure2-slot-map.cpp2"
+};
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-slot-map.cpp2"
+
+#line 6 "pure2-slot-map.cpp2"
+    entity::entity(cpp2::impl::in<std::string> n, cpp2::impl::in<cpp2::i32> h)
+        : name{ n }
+        , hp{ h }{
+
+#line 9 "pure2-slot-map.cpp2"
+    }
+
+    entity::entity(entity&& that) noexcept
+                                     : name{ std::move(that).name }
+                                     , hp{ std::move(that).hp }{}
+
+auto entity::operator=(entity&& that) noexcept -> entity& {
+                                     name = std::move(that).name;
+                                     hp = std::move(that).hp;
+                                     return *this;}
+
+#line 12 "pure2-slot-map.cpp2"
+auto main() -> int{
+    entity::slots world {}; 
+    auto orc {CPP2_UFCS(emplace)(world, "orc", 10)}; 
+    auto elf {CPP2_UFCS(emplace)(world, "elf", 20)}; 
+    auto troll {CPP2_UFCS(emplace)(world, "troll", 30)}; 
+
+    CPP2_ASSERT_IN_BOUNDS(world, elf).hp += 5;
+    CPP2_UFCS(erase)(world, orc);
+    std::cout << ("contains orc: " + cpp2::to_string(CPP2_UFCS(contains)(world, orc)) + ", elf: " + cpp2::to_string(CPP2_UFCS(contains)(world, cpp2::move(elf))) + "\n");
+
+    //  The erased slot is reused, with a new generation
+    auto goblin {CPP2_UFCS(emplace)(world, "goblin", 40)}; 
+    std::cout << ("orc == goblin: " + cpp2::to_string(orc == goblin) + ", contains orc: " + cpp2::to_string(CPP2_UFCS(contains)(world, orc)) + "\n");
+
+    for ( auto const& e : world ) {
+        std::cout << (cpp2::to_string(e.name) + " " + cpp2::to_string(e.hp) + "\n");
+    }
+
+    entity::handle none {}; 
+    std::cout << ("null handle: " + cpp2::to_string(CPP2_UFCS(is_null)(none)) + ", contains: " + cpp2::to_string(CPP2_UFCS(contains)(world, none)) + "\n");
+
+    //  A handle from another slot_map isn't contained, even when it
+    //  names a free slot that has the same generation
+    entity::slots other {}; 
+    CPP2_UFCS(erase)(other, CPP2_UFCS(emplace)(other, "imp", 1));
+    auto imp {CPP2_UFCS(emplace)(other, "imp", 2)}; 
+    entity::slots scratch {}; 
+    CPP2_UFCS(erase)(scratch, CPP2_UFCS(emplace)(scratch, "bat", 3));
+    std::cout << ("scratch contains imp: " + cpp2::to_string(CPP2_UFCS(contains)(cpp2::move(scratch), imp)) + ", other contains imp: " + cpp2::to_string(CPP2_UFCS(contains)(cpp2::move(other), imp)) + "\n");
+
+    CPP2_UFCS(clear)(world);
+    std::cout << ("after clear: size " + cpp2::to_string(CPP2_UFCS(ssize)(world)) + ", contains troll: " + cpp2::to_string(CPP2_UFCS(contains)(world, cpp2::move(troll))) + ", goblin: " + cpp2::to_string(CPP2_UFCS(contains)(world, cpp2::move(goblin))) + "\n");
+}
+
@@ -1,11 +1,16 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <chrono>
+#endif
+
 #line 1 "pure2-statement-scope-parameters.cpp2"
 
 
@@ -13,8 +18,6 @@
 
 #line 1 "pure2-statement-scope-parameters.cpp2"
 
-#line 2 "pure2-statement-scope-parameters.cpp2"
-auto main(int const argc_, char** argv_) -> int;
 
 //=== Cpp2 function definitions =================================================
 
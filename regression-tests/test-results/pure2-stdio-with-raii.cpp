@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -13,15 +14,13 @@
 
 #line 1 "pure2-stdio-with-raii.cpp2"
 
-//  "A better C than C" ... ?
-//
-#line 4 "pure2-stdio-with-raii.cpp2"
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
 #line 1 "pure2-stdio-with-raii.cpp2"
 
+//  "A better C than C" ... ?
+//
 #line 4 "pure2-stdio-with-raii.cpp2"
 [[nodiscard]] auto main() -> int{
     std::string s {"Fred"}; 
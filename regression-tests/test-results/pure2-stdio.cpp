@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -12,11 +13,6 @@
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-stdio.cpp2"
-
-//  "A better C than C" ... ?
-//
-#line 4 "pure2-stdio.cpp2"
-[[nodiscard]] auto main() -> int;
 #line 10 "pure2-stdio.cpp2"
 
 #line 1 "pure2-stdio.cpp2"
@@ -25,6 +21,8 @@
 
 #line 1 "pure2-stdio.cpp2"
 
+//  "A better C than C" ... ?
+//
 #line 4 "pure2-stdio.cpp2"
 [[nodiscard]] auto main() -> int{
     std::string s {"Fred"}; 
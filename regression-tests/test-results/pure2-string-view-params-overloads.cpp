@@ -0,0 +1,47 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#ifndef __cpp_lib_modules
+#include <ios>
+#endif
+
+#line 1 "pure2-string-view-params-overloads.cpp2"
+
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-string-view-params-overloads.cpp2"
+
+//  With -string-view-params, an overload set keeps its signatures:
+//  changing the first one to take a std::string_view would redeclare
+//  the second one
+#line 5 "pure2-string-view-params-overloads.cpp2"
+[[nodiscard]] auto describe(cpp2::impl::in<std::string> s) -> std::string;
+[[nodiscard]] auto describe(cpp2::impl::in<std::string_view> s) -> std::string;
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-string-view-params-overloads.cpp2"
+
+#line 5 "pure2-string-view-params-overloads.cpp2"
+[[nodiscard]] auto describe(cpp2::impl::in<std::string> s) -> std::string { return "string of size " + std::to_string(CPP2_UFCS(size)(s));  }
+#line 6 "pure2-string-view-params-overloads.cpp2"
+[[nodiscard]] auto describe(cpp2::impl::in<std::string_view> s) -> std::string { return "view of size " + std::to_string(CPP2_UFCS(size)(s));  }
+
+//  Not overloaded and only called directly, so this one does become a view
+#line 9 "pure2-string-view-params-overloads.cpp2"
+[[nodiscard]] auto has_prefix(cpp2::impl::in<std::string_view> s, cpp2::impl::in<std::string_view> prefix) -> bool { return CPP2_UFCS(starts_with)(s, prefix);  }
+
+#line 11 "pure2-string-view-params-overloads.cpp2"
+auto main() -> int{
+    std::cout << describe(std::string("hello")) << "\n";
+    std::cout << describe(std::string_view("hi")) << "\n";
+    std::cout << std::boolalpha << has_prefix("cppfront", "cpp") << "\n";
+}
+
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -12,10 +13,7 @@
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-synthesize-rightshift-and-rightshifteq.cpp2"
-[[nodiscard]] auto f(cpp2::impl::in<int> a, cpp2::impl::in<int> b) -> int;
 
-#line 7 "pure2-synthesize-rightshift-and-rightshifteq.cpp2"
-[[nodiscard]] auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
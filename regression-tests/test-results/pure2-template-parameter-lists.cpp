@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -13,13 +14,6 @@
 
 #line 1 "pure2-template-parameter-lists.cpp2"
 
-#line 2 "pure2-template-parameter-lists.cpp2"
-template<typename T, typename U> [[nodiscard]] auto f1(T const& t, U const& u) -> auto;
-template<typename T, typename U> [[nodiscard]] auto f2(T const& t, U const& u) -> auto;
-template<auto T, auto U> [[nodiscard]] auto f3() -> auto;
-template<cpp2::i8 T, cpp2::i16 U> [[nodiscard]] auto f4() -> auto;
-
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,11 +1,16 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <array>
+#endif
+
 #line 1 "pure2-trailing-commas.cpp2"
 
 #line 9 "pure2-trailing-commas.cpp2"
@@ -15,20 +20,11 @@ class vals;
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-trailing-commas.cpp2"
-[[nodiscard]] auto f(auto const& a, auto const& b) -> auto;
 
-#line 3 "pure2-trailing-commas.cpp2"
-template<typename T, typename U> [[nodiscard]] auto g(T const& a, U const& b) -> auto;
 using doubler_ret = int;
-
-
-#line 5 "pure2-trailing-commas.cpp2"
-[[nodiscard]] auto doubler(cpp2::impl::in<int> a) -> doubler_ret;
-
 #line 9 "pure2-trailing-commas.cpp2"
 class vals {public: int i; };
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
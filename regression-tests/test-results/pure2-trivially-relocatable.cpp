@@ -0,0 +1,116 @@
+
+#define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
+
+//=== Cpp2 type declarations ====================================================
+
+
+#include "cpp2util.h"
+
+#line 1 "pure2-trivially-relocatable.cpp2"
+
+#line 2 "pure2-trivially-relocatable.cpp2"
+class base;
+    
+
+#line 7 "pure2-trivially-relocatable.cpp2"
+class widget;
+    
+
+//=== Cpp2 type definitions and function declarations ===========================
+
+#line 1 "pure2-trivially-relocatable.cpp2"
+
+#line 2 "pure2-trivially-relocatable.cpp2"
+class base {
+    public: cpp2::i32 id {0}; 
+    public: explicit base(cpp2::impl::in<cpp2::i32> i);
+#line 4 "pure2-trivially-relocatable.cpp2"
+    public: auto operator=(cpp2::impl::in<cpp2::i32> i) -> base& ;
+    public: base(base const& that);
+
+public: auto operator=(base const& that) -> base& ;
+public: base(base&& that) noexcept;
+public: auto operator=(base&& that) noexcept -> base& ;
+public: using _trivially_relocatable = cpp2::trivially_relocatable_tag<base,cpp2::i32>;
+
+#line 5 "pure2-trivially-relocatable.cpp2"
+};
+
+class widget: public base {
+
+    public: std::unique_ptr<std::string> name; 
+    public: std::vector<cpp2::i32> parts {}; 
+
+    public: explicit widget(cpp2::impl::in<cpp2::i32> i, cpp2::impl::in<std::string> n);
+    public: using _trivially_relocatable = cpp2::trivially_relocatable_tag<widget,base,std::unique_ptr<std::string>,std::vector<cpp2::i32>>;
+
+    public: widget(widget const&) = delete; /* No 'that' constructor, suppress copy */
+    public: auto operator=(widget const&) -> void = delete;
+
+
+#line 17 "pure2-trivially-relocatable.cpp2"
+};
+
+
+//=== Cpp2 function definitions =================================================
+
+#line 1 "pure2-trivially-relocatable.cpp2"
+
+#line 4 "pure2-trivially-relocatable.cpp2"
+    base::base(cpp2::impl::in<cpp2::i32> i)
+                                      : id{ i }{}
+#line 4 "pure2-trivially-relocatable.cpp2"
+    auto base::operator=(cpp2::impl::in<cpp2::i32> i) -> base& {
+                                      id = i;
+                                      return *this; }
+
+    base::base(base const& that)
+                                : id{ that.id }{}
+
+auto base::operator=(base const& that) -> base& {
+                                id = that.id;
+                                return *this;}
+base::base(base&& that) noexcept
+                                : id{ std::move(that).id }{}
+auto base::operator=(base&& that) noexcept -> base& {
+                                id = std::move(that).id;
+                                return *this;}
+
+#line 12 "pure2-trivially-relocatable.cpp2"
+    widget::widget(cpp2::impl::in<cpp2::i32> i, cpp2::impl::in<std::string> n)
+        : base{ i }
+        , name{ CPP2_UFCS_TEMPLATE_NONLOCAL(cpp2_new<std::string>)(cpp2::unique, n) }{
+
+#line 15 "pure2-trivially-relocatable.cpp2"
+        CPP2_UFCS(push_back)(parts, i);
+    }
+
+
+#line 19 "pure2-trivially-relocatable.cpp2"
+auto main() -> int{
+    static_assert(cpp2::is_trivially_relocatable_v<base>);
+    static_assert(cpp2::is_trivially_relocatable_v<widget>);
+    static_assert(!(cpp2::is_trivially_relocatable_v<std::string>));
+
+    cpp2::relocating_vector<widget> v {}; 
+    for ( auto const& i : { 1, 2, 3, 4, 5, 6, 7, 8, 9 } ) {
+        static_cast<void>(CPP2_UFCS(emplace_back)(v, i, ("widget " + cpp2::to_string(i))));
+    }
+    std::cout << ("size " + cpp2::to_string(CPP2_UFCS(size)(v)) + ", capacity " + cpp2::to_string(CPP2_UFCS(capacity)(v)) + "\n");
+    for ( auto const& w : v ) {
+        std::cout << (cpp2::to_string(w.id) + ": " + cpp2::to_string(*cpp2::impl::assert_not_null(w.name)) + ", " + cpp2::to_string(CPP2_UFCS(size)(w.parts)) + " part(s)\n");
+    }
+
+    CPP2_UFCS(pop_back)(v);
+    std::cout << ("after pop_back, last is " + cpp2::to_string(*cpp2::impl::assert_not_null(CPP2_UFCS(back)(cpp2::move(v)).name)) + "\n");
+
+    cpp2::relocating_vector<base> bases {}; 
+    for ( auto const& i : { 10, 20, 30, 40, 50 } ) {
+        static_cast<void>(CPP2_UFCS(emplace_back)(bases, i));
+    }
+    auto copy {bases}; 
+    CPP2_UFCS(clear)(cpp2::move(bases));
+    std::cout << ("copied " + cpp2::to_string(CPP2_UFCS(ssize)(copy)) + " bases, last is " + cpp2::to_string(CPP2_ASSERT_IN_BOUNDS_LITERAL(copy, 4).id) + "\n");
+}
+
@@ -46,8 +46,6 @@ class myclass {
 
 namespace N3 = ::std::literals;
 
-auto myfunc() -> void;
-
 #line 25 "pure2-type-and-namespace-aliases.cpp2"
 template<typename T> class myclass2 {
     public: static const int value;
@@ -58,7 +56,6 @@ template<typename T> class myclass2 {
 };
 #line 28 "pure2-type-and-namespace-aliases.cpp2"
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
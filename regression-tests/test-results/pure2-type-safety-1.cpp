@@ -1,11 +1,19 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <iomanip>
+#ifdef __cpp_lib_print
+    #include <print>
+#endif
+#endif
+
 #line 1 "pure2-type-safety-1.cpp2"
 
 
@@ -13,9 +21,6 @@
 
 #line 1 "pure2-type-safety-1.cpp2"
 
-#line 2 "pure2-type-safety-1.cpp2"
-[[nodiscard]] auto main() -> int;
-
 #line 24 "pure2-type-safety-1.cpp2"
 auto test_generic(auto const& x, auto const& msg) -> void;
 
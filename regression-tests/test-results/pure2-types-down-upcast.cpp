@@ -1,11 +1,16 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <ostream>
+#endif
+
 #line 1 "pure2-types-down-upcast.cpp2"
 class A;
 #line 2 "pure2-types-down-upcast.cpp2"
@@ -46,20 +51,6 @@ auto func_mut(B& b) -> void;
 auto func_const(cpp2::impl::in<A> a) -> void;
 auto func_const(cpp2::impl::in<B> b) -> void;
 
-auto test_const_foo() -> void;
-
-#line 29 "pure2-types-down-upcast.cpp2"
-auto test_mut_foo() -> void;
-
-#line 36 "pure2-types-down-upcast.cpp2"
-auto test_up() -> void;
-
-#line 55 "pure2-types-down-upcast.cpp2"
-auto test_down() -> void;
-
-#line 77 "pure2-types-down-upcast.cpp2"
-[[nodiscard]] auto main() -> int;
-
 //=== Cpp2 function definitions =================================================
 
 #line 1 "pure2-types-down-upcast.cpp2"
@@ -1,11 +1,18 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#ifdef __cpp_lib_print
+    #include <print>
+#endif
+#endif
+
 #line 1 "pure2-types-inheritance.cpp2"
 
 #line 2 "pure2-types-inheritance.cpp2"
@@ -78,13 +85,6 @@ class Cyborg: public Cyborg_name_as_base, public Human, public Cyborg_address_as
 #line 36 "pure2-types-inheritance.cpp2"
 };
 
-auto make_speak(cpp2::impl::in<Human> h) -> void;
-
-#line 43 "pure2-types-inheritance.cpp2"
-auto do_work(cpp2::impl::in<N::Machine<99>> m) -> void;
-
-#line 48 "pure2-types-inheritance.cpp2"
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -99,9 +100,6 @@ template<typename T, typename U> class A {
 
 }
 
-//  Mainline - gratuitous comment just to check that this comment
-//  stays on the function declaration when lowering
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -179,6 +177,8 @@ namespace M {
 
 }
 
+//  Mainline - gratuitous comment just to check that this comment
+//  stays on the function declaration when lowering
 #line 70 "pure2-types-order-independence-and-nesting.cpp2"
 auto main() -> int
 {
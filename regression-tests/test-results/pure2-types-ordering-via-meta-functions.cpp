@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -72,7 +73,6 @@ class mystruct {
     public: int val {0}; 
 };
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
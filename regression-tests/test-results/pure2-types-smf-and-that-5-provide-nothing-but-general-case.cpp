@@ -1,11 +1,18 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#ifdef __cpp_lib_print
+    #include <print>
+#endif
+#endif
+
 #line 1 "pure2-types-smf-and-that-5-provide-nothing-but-general-case.cpp2"
 
 #line 2 "pure2-types-smf-and-that-5-provide-nothing-but-general-case.cpp2"
@@ -59,7 +66,6 @@ class myclass {
 #line 37 "pure2-types-smf-and-that-5-provide-nothing-but-general-case.cpp2"
 };
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
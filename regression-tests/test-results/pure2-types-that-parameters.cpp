@@ -1,11 +1,18 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#ifdef __cpp_lib_print
+    #include <print>
+#endif
+#endif
+
 #line 1 "pure2-types-that-parameters.cpp2"
 
 #line 2 "pure2-types-that-parameters.cpp2"
@@ -39,7 +46,6 @@ class myclass {
 
 };
 
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
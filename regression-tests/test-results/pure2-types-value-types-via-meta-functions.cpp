@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -73,8 +74,6 @@ public: explicit p_widget();
 #line 15 "pure2-types-value-types-via-meta-functions.cpp2"
 };
 
-auto main() -> int;
-
 #line 23 "pure2-types-value-types-via-meta-functions.cpp2"
 template<typename T> auto test() -> void;
 
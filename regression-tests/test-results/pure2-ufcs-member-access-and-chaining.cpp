@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -12,7 +13,6 @@
 //=== Cpp2 type definitions and function declarations ===========================
 
 #line 1 "pure2-ufcs-member-access-and-chaining.cpp2"
-[[nodiscard]] auto main() -> int;
 
 #line 26 "pure2-ufcs-member-access-and-chaining.cpp2"
 auto no_return([[maybe_unused]] auto const& unnamed_param_1) -> void;
@@ -1,5 +1,6 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
@@ -71,10 +72,6 @@ public: auto operator=(name_or_other&& that) noexcept -> name_or_other& ;
 #line 17 "pure2-union.cpp2"
 };
 
-auto print_name(cpp2::impl::in<name_or_number> non) -> void;
-
-#line 28 "pure2-union.cpp2"
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -1,11 +1,16 @@
 
 #define CPP2_IMPORT_STD          Yes
+#define CPP2_INCLUDE_USED_STD    Yes
 
 //=== Cpp2 type declarations ====================================================
 
 
 #include "cpp2util.h"
 
+#ifndef __cpp_lib_modules
+#include <ostream>
+#endif
+
 #line 1 "pure2-variadics.cpp2"
 
 #line 3 "pure2-variadics.cpp2"
@@ -70,17 +75,6 @@ template<auto ...UnnamedTypeParam1_2> class t2 {
   public: template<int UnnamedTypeParam1_5> [[nodiscard]] static auto f() -> cpp2::i32;
 };
 
-template<typename ...Args> auto left_fold_print(std::ostream& out, Args const& ...args) -> void;
-
-#line 35 "pure2-variadics.cpp2"
-template<typename ...Args> [[nodiscard]] auto all(Args const& ...args) -> bool;
-
-#line 39 "pure2-variadics.cpp2"
-template     <typename ...Args> [[nodiscard]] auto make_string(Args&& ...args) -> auto;
-
-template  <typename T, typename ...Args> [[nodiscard]] auto make(Args&& ...args) -> auto;
-
-auto main() -> int;
 
 //=== Cpp2 function definitions =================================================
 
@@ -0,0 +1,73 @@
+#!/bin/bash
+
+################
+# Time the definite initialization analysis on one function with many
+# deferred-initialized locals, to check that it scales about linearly
+#
+# Each function declares N locals and then initializes them in order,
+# either straight-line or on both branches of an if/else each. The
+# analysis time comes from a CPP2_DEBUG_BUILD of cppfront, which reports
+# its scope timers with -verbose
+usage() {
+    echo "Usage: $0 [-c <compiler>] [<number of locals> ...]"
+    echo "    -c <compiler>  The C++ compiler to build cppfront with (default: g++)"
+    echo "    The default numbers of locals are 1000 2000 4000 8000"
+    exit 1
+}
+
+compiler=g++
+while getopts ":c:" opt; do
+    case ${opt} in
+        c)
+            compiler=$OPTARG
+            ;;
+        *)
+            usage
+            ;;
+    esac
+done
+shift $((OPTIND -1))
+
+counts=("$@")
+if [[ ${#counts[@]} -eq 0 ]]; then
+    counts=(1000 2000 4000 8000)
+fi
+
+script_dir=$(cd "$(dirname "$0")" && pwd)
+work_dir=$(mktemp -d)
+trap 'rm -rf "$work_dir"' EXIT
+
+echo "Building cppfront with $compiler"
+"$compiler" -std=c++20 -O1 -DCPP2_DEBUG_BUILD "$script_dir/../source/cppfront.cpp" -o "$work_dir/cppfront" || exit 1
+
+# Write a function with $1 deferred-initialized locals, initialized
+# straight-line ($2 = line) or on both branches of an if/else ($2 = if)
+generate() {
+    echo "main: (args) = {"
+    echo "    mode := args.ssize();"
+    for ((i = 0; i < $1; i++)); do
+        echo "    x$i: int;"
+    done
+    for ((i = 0; i < $1; i++)); do
+        if [[ $2 == line ]]; then
+            echo "    x$i = $i;"
+        else
+            echo "    if mode > $i { x$i = 1; } else { x$i = 2; }"
+        fi
+    done
+    echo "    std::cout << x0;"
+    echo "}"
+}
+
+# The analysis time in ms, from -verbose
+analysis_time() {
+    "$work_dir/cppfront" -p -verbose "$1" -o "$work_dir/out.cpp" \
+        | sed -n 's/^ *\([0-9,]*\) ms in find_definite_initializations$/\1/p'
+}
+
+printf "%-10s %14s %14s\n" "locals" "straight-line" "if/else each"
+for n in "${counts[@]}"; do
+    generate "$n" line > "$work_dir/line.cpp2"
+    generate "$n" if   > "$work_dir/if.cpp2"
+    printf "%-10s %11s ms %11s ms\n" "$n" "$(analysis_time "$work_dir/line.cpp2")" "$(analysis_time "$work_dir/if.cpp2")"
+done
@@ -48,9 +48,12 @@
 #include <iterator>
 #include <memory>
 #include <map>
+#include <set>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace cpp2 {
@@ -994,27 +997,34 @@ struct error_entry
 template <typename T>
 class stable_vector
 {
-    static constexpr size_t PageSize = 1'000;
+    //  Segments hold a power of two elements, so indexing is a shift and a
+    //  mask, and each is reserved up front so its elements never move
+    static constexpr size_t SegmentShift = 10;
+    static constexpr size_t SegmentSize  = size_t{1} << SegmentShift;
+    static constexpr size_t SegmentMask  = SegmentSize - 1;
 
     std::vector< std::vector<T> > data;
+    size_t                        count = 0;
 
-    auto add_segment( std::initializer_list<T> init = {} ) -> void {
-        data.push_back( init );
-        data.back().reserve(PageSize);
+    auto add_segment() -> void {
+        data.emplace_back();
+        data.back().reserve(SegmentSize);
     }
 
 public:
     stable_vector( std::initializer_list<T> init = {}) {
-        add_segment( init);
+        add_segment();
+        for (auto const& t : init) {
+            push_back(t);
+        }
     }
 
     auto empty() const -> bool {
-        return data.size() == 1 && data.back().empty();
+        return count == 0;
     }
 
     auto size() const -> size_t {
-        testing.enforce(!data.empty());
-        return (data.size() - 1) * PageSize + data.back().size();
+        return count;
     }
 
     auto ssize() const -> ptrdiff_t {
@@ -1023,12 +1033,12 @@ public:
 
     auto operator[](size_t idx) -> T& {
         bounds_safety.enforce(idx < size());
-        return data[idx / PageSize][idx % PageSize];
+        return data[idx >> SegmentShift][idx & SegmentMask];
     }
 
     auto operator[](size_t idx) const -> T const& {
         bounds_safety.enforce(idx < size());
-        return data[idx / PageSize][idx % PageSize];
+        return data[idx >> SegmentShift][idx & SegmentMask];
     }
 
     auto back() -> T& {
@@ -1036,18 +1046,21 @@ public:
     }
 
     auto push_back(T const& t) -> void {
-        if (data.back().size() == data.back().capacity()) {
+        if (data.back().size() == SegmentSize) {
             add_segment();
         }
         data.back().push_back(t);
+        ++count;
     }
 
     template< class... Args >
     auto emplace_back( Args&&... args ) -> T& {
-        if (data.back().size() == data.back().capacity()) {
+        if (data.back().size() == SegmentSize) {
             add_segment();
         }
-        return data.back().emplace_back(CPP2_FORWARD(args)...);
+        auto& ret = data.back().emplace_back(CPP2_FORWARD(args)...);
+        ++count;
+        return ret;
     }
 
     auto pop_back() -> void {
@@ -1060,8 +1073,45 @@ public:
             data.pop_back();
         }
         data.back().pop_back();
+        --count;
     }
 
+    //-------------------------------------------------------------------
+    //  for_each_segment: Call f with each nonempty segment in order, as a
+    //  contiguous std::span, so that linear scans can run over contiguous
+    //  memory. If f returns bool, returning false stops the iteration.
+    //
+    template <typename F>
+    auto for_each_segment(F&& f) -> void {
+        for (auto& segment : data) {
+            if (!segment.empty() && !call_segment_function(f, std::span<T>{segment})) {
+                return;
+            }
+        }
+    }
+
+    template <typename F>
+    auto for_each_segment(F&& f) const -> void {
+        for (auto const& segment : data) {
+            if (!segment.empty() && !call_segment_function(f, std::span<T const>{segment})) {
+                return;
+            }
+        }
+    }
+
+private:
+    template <typename F, typename Span>
+    static auto call_segment_function(F& f, Span segment) -> bool {
+        if constexpr (std::is_same_v<decltype(f(segment)), bool>) {
+            return f(segment);
+        }
+        else {
+            f(segment);
+            return true;
+        }
+    }
+
+public:
     //-------------------------------------------------------------------
     //  Debug interface
     //
@@ -1194,9 +1244,9 @@ class stackinstr
             , ptr       { p }
         { }
     };
-    static std::vector<entry> entries;
-    static std::vector<entry> deepest;
-    static std::vector<entry> largest;
+    static thread_local std::vector<entry> entries;
+    static thread_local std::vector<entry> deepest;
+    static thread_local std::vector<entry> largest;
 
     static auto print(auto&& ee, std::string_view label) {
         std::cout << "\n=== Stack debug information: " << label << " stack ===\n";
@@ -1236,9 +1286,9 @@ public:
     static auto print_largest() { print( largest, "Largest" ); }
 };
 
-std::vector<stackinstr::entry> stackinstr::entries;
-std::vector<stackinstr::entry> stackinstr::deepest;
-std::vector<stackinstr::entry> stackinstr::largest;
+thread_local std::vector<stackinstr::entry> stackinstr::entries;
+thread_local std::vector<stackinstr::entry> stackinstr::deepest;
+thread_local std::vector<stackinstr::entry> stackinstr::largest;
 
 #define STACKINSTR stackinstr::guard _s_guard{ __func__, __FILE__, __LINE__, reinterpret_cast<char*>(&_s_guard) };
 
@@ -1284,7 +1334,7 @@ public:
     }
 };
 
-static std::unordered_map<std::string_view, timer> timers;  // global named timers
+thread_local std::unordered_map<std::string_view, timer> timers;  // named timers, per thread
 
 auto scope_timer(std::string_view name) {
     timers[name].start();
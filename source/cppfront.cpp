@@ -16,6 +16,7 @@
 //===========================================================================
 
 #include "to_cpp1.h"
+#include <random>
 
 static auto flag_debug_output = false;
 static cpp2::cmdline_processor::register_flag cmd_debug(
@@ -25,6 +26,23 @@ static cpp2::cmdline_processor::register_flag cmd_debug(
     []{ flag_debug_output = true; }
 );
 
+static auto flag_report_purity = false;
+static cpp2::cmdline_processor::register_flag cmd_report_purity(
+    9,
+    "report-purity",
+    "Explain why -mark-purity marks each function const, pure, or neither",
+    []{ flag_report_purity = true; cpp2::cmdline_options.infer_purity = true; }
+);
+
+static auto flag_safety_report = std::string{};
+static cpp2::cmdline_processor::register_flag cmd_safety_report(
+    9,
+    "safety-report file",
+    "Write a JSON census of the safety checks emitted and elided in each function to 'file'",
+    nullptr,
+    [](std::string const& file) { flag_safety_report = file; cpp2::cmdline_options.report_checks = true; }
+);
+
 static auto flag_quiet = false;
 static cpp2::cmdline_processor::register_flag cmd_quiet(
     9,
@@ -33,6 +51,354 @@ static cpp2::cmdline_processor::register_flag cmd_quiet(
     []{ flag_quiet = true; }
 );
 
+static auto flag_cache_dir = std::string{};
+static cpp2::cmdline_processor::register_flag cmd_cache_dir(
+    9,
+    "translation-cache dir",
+    "Reuse the Cpp1 output of identical earlier translations cached in 'dir'",
+    nullptr,
+    [](std::string const& dir) { flag_cache_dir = dir; }
+);
+
+static auto flag_max_cache_mb = std::uintmax_t{1'000};
+static cpp2::cmdline_processor::register_flag cmd_max_cache_size(
+    9,
+    "max-cache-size n",
+    "Evict least recently used -translation-cache entries above n MB (default 1000)",
+    nullptr,
+    [](std::string const& n) {
+        auto mb = std::uintmax_t{};
+        if (std::from_chars(n.data(), n.data() + n.size(), mb).ec == std::errc{}) {
+            flag_max_cache_mb = mb;
+        }
+    }
+);
+
+
+//-----------------------------------------------------------------------
+//
+//  translation_cache: Reuses the Cpp1 output of earlier successful
+//  translations with the same inputs (see -translation-cache)
+//
+//-----------------------------------------------------------------------
+//
+//  An entry's key is a 128-bit hash of everything that affects the output:
+//  the source text and filename, the output filename, the translation
+//  options, and the cppfront version and build. Each entry is a `key.meta`
+//  file (the results and output filenames) plus one `key.N` file per output.
+//  The .meta also records those inputs, with each file's contents replaced
+//  by its size, and a lookup uses the entry only if they match exactly, so
+//  a hash collision alone can't replay another translation's output.
+//  Each file is written to a unique temporary name and atomically renamed
+//  into place, with the .meta last, so concurrent cppfronts sharing a cache
+//  only ever see complete entries. The .meta file's write time is its last
+//  use, for LRU eviction.
+//
+class translation_cache
+{
+    std::filesystem::path dir;
+    std::uintmax_t        max_size;
+    int                   hits   = 0;
+    int                   misses = 0;
+
+    //  128-bit FNV-1a, with the multiplication by the FNV prime 2^88 + 0x13b
+    //  done in 64-bit halves so it doesn't need a 128-bit integer type
+    struct hash
+    {
+        std::uint64_t hi = 0x6c62272e07bb0142ull;
+        std::uint64_t lo = 0x62b821756295c58dull;
+
+        auto add(std::string_view s)
+            -> void
+        {
+            for (auto c : s) {
+                lo ^= static_cast<unsigned char>(c);
+                auto carry = ((lo >> 32) * 0x13b + (((lo & 0xffffffff) * 0x13b) >> 32)) >> 32;
+                hi = hi * 0x13b + carry + (lo << 24);
+                lo = lo * 0x13b;
+            }
+        }
+
+        auto to_string() const
+            -> std::string
+        {
+            auto ret = std::ostringstream{};
+            ret << std::hex << std::setfill('0') << std::setw(16) << hi << std::setw(16) << lo;
+            return ret.str();
+        }
+    };
+
+    auto path_for(std::string const& name, std::string_view ext) const
+        -> std::filesystem::path
+    {
+        return dir / (name + std::string{ext});
+    }
+
+    //  Write to a unique temporary name and rename it into place
+    static auto write_atomically(
+        std::filesystem::path const& path,
+        std::string_view             text
+    )
+        -> bool
+    {
+        auto tmp = path;
+        tmp += ".tmp" + std::to_string(std::random_device{}());
+        {
+            auto out = std::ofstream{ tmp, std::ios::binary };
+            out.write( text.data(), std::ssize(text) );
+            if (!out) {
+                return false;
+            }
+        }
+        auto ec = std::error_code{};
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    static auto read(std::filesystem::path const& path)
+        -> std::optional<std::string>
+    {
+        auto in = std::ifstream{ path, std::ios::binary };
+        if (!in) {
+            return {};
+        }
+        return std::string{ std::istreambuf_iterator<char>{in}, {} };
+    }
+
+    //  Remove least recently used entries until we're under 90% of max_size
+    auto evict()
+        -> void
+    {
+        auto ec         = std::error_code{};
+        auto total_size = std::uintmax_t{0};
+        auto entries    = std::vector<std::pair<std::filesystem::file_time_type, std::string>>{};
+        auto sizes      = std::unordered_map<std::string, std::uintmax_t>{};
+
+        for (auto const& f : std::filesystem::directory_iterator{dir, ec}) {
+            auto size = f.file_size(ec);
+            if (ec) {
+                continue;
+            }
+            total_size += size;
+            auto name = f.path().filename().string();
+            auto stem = name.substr(0, name.find('.'));
+            sizes[stem] += size;
+            if (f.path().extension() == ".meta") {
+                entries.emplace_back(f.last_write_time(ec), stem);
+            }
+        }
+        if (total_size <= max_size) {
+            return;
+        }
+
+        std::sort(entries.begin(), entries.end());
+        for (auto const& [time, stem] : entries) {
+            if (total_size <= max_size / 10 * 9) {
+                break;
+            }
+            //  Remove the .meta first, so nobody uses a partial entry
+            std::filesystem::remove(path_for(stem, ".meta"), ec);
+            for (auto i = 0; std::filesystem::remove(path_for(stem, "." + std::to_string(i)), ec); ++i) { }
+            total_size -= sizes[stem];
+        }
+    }
+
+public:
+    translation_cache(
+        std::string const& dir_,
+        std::uintmax_t     max_size_mb
+    )
+        : dir     { dir_ }
+        , max_size{ max_size_mb * 1'000'000 }
+    {
+        auto ec = std::error_code{};
+        std::filesystem::create_directories(dir, ec);
+    }
+
+    //  An entry's key: the hash that names its files, and the inputs
+    //  that its .meta records, to check on lookup
+    struct key {
+        std::string name   = {};
+        std::string inputs = {};
+
+        auto empty() const -> bool { return name.empty(); }
+    };
+
+    //  Get the key for translating sourcefile to cpp1_filename, or
+    //  empty if the source can't be read
+    //
+    static auto key_for(
+        std::string const&               sourcefile,
+        std::string const&               cpp1_filename,
+        cpp2::translation_options const& options
+    )
+        -> key
+    {
+        auto source = read(sourcefile);
+        if (!source) {
+            return {};
+        }
+
+        auto h      = hash{};
+        auto inputs = std::string{};
+        auto add    = [&](std::string_view s) {
+            h.add(s);
+            inputs += s;
+        };
+        auto add_file = [&](std::string const& filename, std::string const& text) {
+            add(filename);
+            add("\n" + std::to_string(text.size()) + "\n");
+            h.add(text);
+        };
+
+        add_file(sourcefile, *source);
+        add(cpp1_filename + "\n");
+        add(
+            #include "version.info"
+            #include "build.info"
+        );
+
+        //  Every option except lowering_jobs and report_checks, which don't affect the output
+        auto opts = std::string{};
+        for (auto b : {
+            options.emit_cppfront_info, options.clean_cpp1,
+            options.line_paths, options.import_std, options.include_std,
+            options.cpp2_only, options.safe_null_pointers, options.safe_subscripts,
+            options.safe_comparisons, options.use_source_location, options.use_source_sites,
+            options.no_exceptions, options.no_rtti, options.string_view_params,
+            options.infer_purity
+        })
+        {
+            opts += b ? '1' : '0';
+        }
+        if (options.line_paths) {
+            opts += std::filesystem::absolute(sourcefile).string();
+        }
+        add("\n" + opts + "\n");
+
+        //  With -whole-program, the output depends on all of the program's files
+        if (!options.whole_program.empty()) {
+            auto files = cpp2::whole_program_index::files_in(options.whole_program);
+            if (!files) {
+                return {};
+            }
+            add(options.whole_program + "\n");
+            for (auto const& file : *files) {
+                auto text = read(file);
+                if (!text) {
+                    return {};
+                }
+                add_file(file.string(), *text);
+            }
+        }
+
+        return { h.to_string(), std::move(inputs) };
+    }
+
+    //  What we remember about a translation, to report it again
+    struct result {
+        bool                     has_cpp1   = false;
+        bool                     has_cpp2   = false;
+        cpp2::lineno_t           cpp1_lines = 0;
+        cpp2::lineno_t           cpp2_lines = 0;
+        std::vector<std::string> cpp1_filenames = {};
+    };
+
+    //  If key is cached, copy its outputs into place and return its result
+    //
+    auto get(key const& k)
+        -> std::optional<result>
+    {
+        auto inputs = std::to_string(k.inputs.size()) + "\n" + k.inputs + "\n";
+        auto meta   = read(path_for(k.name, ".meta"));
+        if (
+            meta
+            && meta->starts_with(inputs)
+            )
+        {
+            auto in  = std::istringstream{ meta->substr(inputs.size()) };
+            auto ret = result{};
+            auto num_files = 0;
+            in >> ret.has_cpp1 >> ret.has_cpp2 >> ret.cpp1_lines >> ret.cpp2_lines >> num_files;
+            in.ignore();
+            for (auto i = 0; i < num_files; ++i) {
+                auto& filename = ret.cpp1_filenames.emplace_back();
+                std::getline(in, filename);
+            }
+
+            //  Copy, not hard link, so the outputs get fresh timestamps for
+            //  build systems, and editing an output can't corrupt the cache
+            auto ec = std::error_code{};
+            for (auto i = 0; i < num_files && in; ++i) {
+                std::filesystem::copy_file(
+                    path_for(k.name, "." + std::to_string(i)),
+                    ret.cpp1_filenames[i],
+                    std::filesystem::copy_options::overwrite_existing,
+                    ec
+                );
+                if (ec) {
+                    break;
+                }
+            }
+            if (in && !ec) {
+                std::filesystem::last_write_time(
+                    path_for(k.name, ".meta"),
+                    std::filesystem::file_time_type::clock::now(),
+                    ec
+                );
+                ++hits;
+                return ret;
+            }
+        }
+        ++misses;
+        return {};
+    }
+
+    //  Cache a translation's outputs under key
+    //
+    auto put(
+        key const&    k,
+        result const& r
+    )
+        -> void
+    {
+        for (auto i = 0; i < std::ssize(r.cpp1_filenames); ++i) {
+            auto text = read(r.cpp1_filenames[i]);
+            if (
+                !text
+                || !write_atomically(path_for(k.name, "." + std::to_string(i)), *text)
+                )
+            {
+                return;
+            }
+        }
+
+        auto meta = std::ostringstream{};
+        meta << k.inputs.size() << '\n' << k.inputs << '\n';
+        meta << r.has_cpp1 << ' ' << r.has_cpp2 << ' '
+             << r.cpp1_lines << ' ' << r.cpp2_lines << ' '
+             << r.cpp1_filenames.size() << '\n';
+        for (auto const& filename : r.cpp1_filenames) {
+            meta << filename << '\n';
+        }
+        if (write_atomically(path_for(k.name, ".meta"), meta.str())) {
+            evict();
+        }
+    }
+
+    auto print_stats(std::ostream& o) const
+        -> void
+    {
+        o << "Translation cache: "
+          << hits << " hit" << (hits != 1 ? "s" : "") << ", "
+          << misses << " miss" << (misses != 1 ? "es" : "") << "\n";
+    }
+};
+
 auto main(
     int   argc,
     char* argv[]
@@ -53,96 +419,181 @@ auto main(
         return EXIT_FAILURE;
     }
 
+    //  If requested, reuse earlier translations (but not when we need debug
+    //  output, -report-purity, or -safety-report, which require doing the
+    //  translation)
+    auto cache = std::optional<translation_cache>{};
+    if (
+        !flag_cache_dir.empty()
+        && !flag_debug_output
+        && !flag_report_purity
+        && flag_safety_report.empty()
+        )
+    {
+        cache.emplace(flag_cache_dir, flag_max_cache_mb);
+    }
+
     //  For each Cpp2 source file
     int exit_status = EXIT_SUCCESS;
+    auto safety_report = std::ostringstream{};
     for (auto const& arg : cmdline.arguments())
     {
         cpp2::timer t;
         t.start();
 
-        auto& out = flag_cpp1_filename != "stdout" ? std::cout : std::cerr;
+        auto& out = cmdline_options.cpp1_filename != "stdout" ? std::cout : std::cerr;
 
         if (!flag_quiet) {
             out << arg.text << "...";
         }
 
-        //  Load + lex + parse + sema
-        cppfront c(arg.text);
-
-        //  Generate Cpp1 (this may catch additional late errors)
-        auto count = c.lower_to_cpp1();
+        //  Look for a cached translation
+        auto cache_key = translation_cache::key{};
+        auto result    = std::optional<translation_cache::result>{};
+        if (
+            cache
+            && cmdline_options.cpp1_filename != "stdout"
+            && (arg.text.ends_with(".cpp2") || arg.text.ends_with(".h2"))
+            )
+        {
+            auto cpp1_filename = arg.text.substr(0, arg.text.size() - 1);
+            if (!cmdline_options.cpp1_filename.empty()) {
+                cpp1_filename = cmdline_options.cpp1_filename;
+            }
+            cache_key = translation_cache::key_for(arg.text, cpp1_filename, cmdline_options);
+            if (!cache_key.empty()) {
+                result = cache->get(cache_key);
+            }
+        }
 
-        //  If there were no errors, say so and generate Cpp1
-        if (c.had_no_errors())
+        auto count         = cppfront::lower_to_cpp1_ret{};
+        auto purity_report = std::ostringstream{};
+        if (!result)
         {
-            if (!flag_quiet)
+            //  Load + lex + parse + sema
+            cppfront c(arg.text);
+
+            //  Generate Cpp1 (this may catch additional late errors)
+            count = c.lower_to_cpp1();
+
+            //  If there were no errors, remember the results (and cache them)
+            if (c.had_no_errors())
             {
-                if (!c.has_cpp1()) {
-                    out << " ok (all Cpp2, passes safety checks)\n";
-                }
-                else if (c.has_cpp2()) {
-                    out << " ok (mixed Cpp1/Cpp2, Cpp2 code passes safety checks)\n";
-                }
-                else {
-                    out << " ok (all Cpp1)\n";
+                result = { c.has_cpp1(), c.has_cpp2(), count.cpp1_lines, count.cpp2_lines, count.cpp1_filenames };
+                if (!cache_key.empty()) {
+                    cache->put(cache_key, *result);
                 }
+            }
+            //  Otherwise, print the errors
+            else
+            {
+                std::cerr << "\n";
+                c.print_errors();
+                std::cerr << "\n";
+                exit_status = EXIT_FAILURE;
+            }
 
-                if (flag_verbose) {
-                    auto total = count.cpp1_lines + count.cpp2_lines;
-                    auto total_lines = print_with_thousands(total);
-                    out << "   Cpp1  "
-                        << std::right << std::setw(total_lines.size())
-                        << print_with_thousands(count.cpp1_lines) << " line" << (count.cpp1_lines != 1 ? "s" : "");
-                    out << "\n   Cpp2  "
-                        << std::right << std::setw(total_lines.size())
-                        << print_with_thousands(count.cpp2_lines) << " line" << (count.cpp2_lines != 1 ? "s" : "");
-                    if (total > 0) {
-                        out << " (";
-                        if (count.cpp1_lines == 0) {
-                            out << 100;
-                        }
-                        else if (count.cpp2_lines / count.cpp1_lines > 25) {
-                            out << std::setprecision(3)
-                                << 100.0 * count.cpp2_lines / total;
-                        }
-                        else {
-                            out << 100 * count.cpp2_lines / total;
-                        }
-                        out << "%)";
-                    }
+            //  And, if requested, the debug information
+            if (flag_debug_output) {
+                c.debug_print();
+            }
+            if (flag_report_purity) {
+                c.print_purity_report(purity_report);
+            }
+            if (!flag_safety_report.empty()) {
+                safety_report << (safety_report.tellp() > 0 ? ",\n" : "");
+                c.print_safety_report(safety_report);
+            }
+        }
 
-                    t.stop();
-                    auto total_time = print_with_thousands(t.elapsed().count());
-                    std::cout << "\n   Time  " << total_time << " ms";
+        //  If there were no errors, say so
+        if (
+            result
+            && !flag_quiet
+            )
+        {
+            if (!result->has_cpp1) {
+                out << " ok (all Cpp2, passes safety checks)\n";
+            }
+            else if (result->has_cpp2) {
+                out << " ok (mixed Cpp1/Cpp2, Cpp2 code passes safety checks)\n";
+            }
+            else {
+                out << " ok (all Cpp1)\n";
+            }
 
-                    std::multimap< long long, std::string_view, std::greater<long long> > sorted_timers;
-                    for (auto [name, t] : timers) {
-                        sorted_timers.insert({t.elapsed().count(), name});
+            if (flag_verbose) {
+                auto total = result->cpp1_lines + result->cpp2_lines;
+                auto total_lines = print_with_thousands(total);
+                out << "   Cpp1  "
+                    << std::right << std::setw(total_lines.size())
+                    << print_with_thousands(result->cpp1_lines) << " line" << (result->cpp1_lines != 1 ? "s" : "");
+                out << "\n   Cpp2  "
+                    << std::right << std::setw(total_lines.size())
+                    << print_with_thousands(result->cpp2_lines) << " line" << (result->cpp2_lines != 1 ? "s" : "");
+                if (total > 0) {
+                    out << " (";
+                    if (result->cpp1_lines == 0) {
+                        out << 100;
                     }
-
-                    for (auto [elapsed, name] : sorted_timers) {
-                        std::cout
-                            << "\n         "
-                            << std::right << std::setw(total_time.size())
-                            << print_with_thousands(elapsed) << " ms" << " in " << name;
+                    else if (result->cpp2_lines / result->cpp1_lines > 25) {
+                        out << std::setprecision(3)
+                            << 100.0 * result->cpp2_lines / total;
+                    }
+                    else {
+                        out << 100 * result->cpp2_lines / total;
                     }
+                    out << "%)";
                 }
 
-                out << "\n";
+                if (count.phase2_jobs > 1) {
+                    out << "\n   Jobs  " << count.phase2_jobs << " threads lowered "
+                        << count.phase2_declarations << " declarations, "
+                        << count.phase2_relowered << " redone serially";
+                }
+
+                t.stop();
+                auto total_time = print_with_thousands(t.elapsed().count());
+                std::cout << "\n   Time  " << total_time << " ms";
+
+                std::multimap< long long, std::string_view, std::greater<long long> > sorted_timers;
+                for (auto [name, t] : timers) {
+                    sorted_timers.insert({t.elapsed().count(), name});
+                }
+
+                for (auto [elapsed, name] : sorted_timers) {
+                    std::cout
+                        << "\n         "
+                        << std::right << std::setw(total_time.size())
+                        << print_with_thousands(elapsed) << " ms" << " in " << name;
+                }
             }
+
+            out << "\n";
         }
-        //  Otherwise, print the errors
-        else
-        {
-            std::cerr << "\n";
-            c.print_errors();
-            std::cerr << "\n";
-            exit_status = EXIT_FAILURE;
-        }
 
-        //  And, if requested, the debug information
-        if (flag_debug_output) {
-            c.debug_print();
+        out << purity_report.str();
+    }
+
+    if (
+        cache
+        && !flag_quiet
+        )
+    {
+        cache->print_stats(std::cout);
+    }
+
+    if (!flag_safety_report.empty())
+    {
+        auto out = std::ofstream{ flag_safety_report };
+        out << "{\n"
+            << "  \"translation_units\": [\n"
+            << safety_report.str() << (safety_report.tellp() > 0 ? "\n" : "")
+            << "  ]\n"
+            << "}\n";
+        if (!out) {
+            std::cerr << "cppfront: error: could not write safety report '" << flag_safety_report << "'\n";
+            exit_status = EXIT_FAILURE;
         }
     }
 
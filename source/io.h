@@ -871,7 +871,20 @@ public:
         if (!in.is_open()) {
             return false;
         }
+        return load(in);
+    }
+
 
+    //-----------------------------------------------------------------------
+    //  load: Read a line-by-line view of the source text in 'in'
+    //
+    //  in                      the source text (e.g., a file or a string)
+    //
+    auto load(
+        std::istream&       in
+    )
+        -> bool
+    {
         auto in_comment            = false;
         auto in_string_literal     = false;
         auto in_raw_string_literal = false;
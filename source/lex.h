@@ -335,29 +335,51 @@ private:
 static_assert (CHAR_BIT == 8);
 
 
-auto labelized_position(token const* t)
-    -> std::string
+//-----------------------------------------------------------------------
+//  position_labels: Short labels for token positions, numbered in
+//  first-use order within a translation
+//
+class position_labels
 {
-    struct label {
-        std::string text;
-        label() {
-            static auto ordinal = 0;                                        // TODO: static
-            text = std::to_string(++ordinal);
+    std::unordered_map<token const*, std::string> labels;
+
+public:
+    //  Get t's label, assigning the next one if it doesn't have one yet
+    //
+    auto get(token const* t)
+        -> std::string
+    {
+        assert (t);
+        auto [iter, inserted] = labels.try_emplace(t);
+        if (inserted) {
+            iter->second = std::to_string(std::ssize(labels));
         }
-    };
-    static auto labels = std::unordered_map<token const*, label const>{};   // TODO: static
+        return iter->second;
+    }
 
-    assert (t);
-    return labels[t].text;
-}
+    //  Get t's label only if it already has one, else empty
+    //
+    auto find(token const* t) const
+        -> std::string
+    {
+        assert (t);
+        if (auto iter = labels.find(t);
+            iter != labels.end()
+            )
+        {
+            return iter->second;
+        }
+        return {};
+    }
+};
 
-auto unnamed_type_param_name(int ordinal, token const* t)
+auto unnamed_type_param_name(int ordinal, std::string_view label)
     -> std::string
 {
     return "UnnamedTypeParam"
             + std::to_string(ordinal)
             + "_"
-            + labelized_position(t);
+            + std::string{label};
 }
 
 
@@ -489,17 +511,24 @@ auto expand_string_literal(
                 return {};
             }
 
-            //  If there's a :formatter suffix, decorate it as: ,"{:formatter}"
+            //  If there's a :formatter suffix, lower it as: cpp2::impl::format("{:formatter}", capture_text)
+            //  so that the format string is a literal that can be checked (and parsed) at compile time
             if (auto colon = chunk.find_last_of(':');
                 colon != chunk.npos
                 && chunk[colon-1] != ':'    // ignore :: scope resolution
                 )
             {
-                chunk.insert(colon, ",\"{");
-                chunk.insert(chunk.size()-1, "}\"");
+                parts.add_code(
+                    "cpp2::impl::format(\"{"
+                    + chunk.substr(colon, chunk.size()-1-colon)
+                    + "}\", "
+                    + chunk.substr(1, colon-1)
+                    + ")"
+                );
+            }
+            else {
+                parts.add_code("cpp2::to_string" + chunk);
             }
-
-            parts.add_code("cpp2::to_string" + chunk);
 
             current_start = pos+1;
             expanded_interpolation = true;
@@ -608,27 +637,22 @@ auto expand_raw_string_literal(
 //  comments                the comment token list to add to
 //  errors                  the error message list to use for reporting problems
 //  raw_string_multiline    the current optional raw_string state
+//  generated_text          a stable place to store the text of merged tokens
+//  multiline_raw_strings   a stable place to store multiline raw strings
 //
 
-//  A stable place to store additional text for source tokens that are merged
-//  into a whitespace-containing token (to merge the Cpp1 multi-token keywords)
-//  -- this isn't about tokens generated later, that's tokens::generated_tokens
-static auto generated_text  = stable_vector<std::string>{};                // TODO: static
-static auto generated_lines = stable_vector<std::vector<source_line>>{};   // TODO: static
-
-
-static auto multiline_raw_strings = stable_vector<multiline_raw_string>{}; // TODO: static
-
 auto lex_line(
-    std::string&               mutable_line,
-    int const                  lineno,
-    bool&                      in_comment,
-    std::string&               current_comment,
-    source_position&           current_comment_start,
-    std::vector<token>&        tokens,
-    std::vector<comment>&      comments,
-    std::vector<error_entry>&  errors,
-    std::optional<raw_string>& raw_string_multiline
+    std::string&                         mutable_line,
+    int const                            lineno,
+    bool&                                in_comment,
+    std::string&                         current_comment,
+    source_position&                     current_comment_start,
+    std::vector<token>&                  tokens,
+    std::vector<comment>&                comments,
+    std::vector<error_entry>&            errors,
+    std::optional<raw_string>&           raw_string_multiline,
+    stable_vector<std::string>&          generated_text,
+    stable_vector<multiline_raw_string>& multiline_raw_strings
 )
     -> bool
 {
@@ -1886,6 +1910,14 @@ class tokens
     //  A stable place to store additional tokens that are synthesized later
     stable_vector<token> generated_tokens;
 
+    //  A stable place to store additional text for source tokens that are merged
+    //  into a whitespace-containing token (to merge the Cpp1 multi-token keywords)
+    //  -- this isn't about tokens generated later, that's generated_tokens
+    stable_vector<std::string> generated_text;
+
+    //  A stable place to store the text of raw strings that span lines
+    stable_vector<multiline_raw_string> multiline_raw_strings;
+
 public:
     //-----------------------------------------------------------------------
     //  Constructor
@@ -1951,7 +1983,8 @@ public:
                     line->text, lineno,
                     in_comment, current_comment, current_comment_start,
                     entry, comments, errors,
-                    raw_string_multiline
+                    raw_string_multiline,
+                    generated_text, multiline_raw_strings
                 );
 
                 //  Check whether all the tokens on this line were consecutive
@@ -2069,7 +2102,17 @@ public:
 
 };
 
-static auto generated_lexers = stable_vector<tokens>{};    // TODO: static
+
+//-----------------------------------------------------------------------
+//  generated_source: A stable place to store the source lines and tokens
+//  of code that is generated while parsing (e.g., by metafunctions),
+//  which must live as long as the parse tree that refers to them
+//
+struct generated_source
+{
+    stable_vector<std::vector<source_line>> lines;
+    stable_vector<tokens>                   lexers;
+};
 
 }
 
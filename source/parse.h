@@ -23,8 +23,6 @@
 
 namespace cpp2 {
 
-auto violates_lifetime_safety = false;
-
 //-----------------------------------------------------------------------
 //  Operator categorization
 //
@@ -506,7 +504,7 @@ struct expression_statement_node;
 
 struct expression_node
 {
-    static inline std::vector<expression_node*> current_expressions = {};   // TODO: static ?
+    static inline thread_local std::vector<expression_node*> current_expressions = {};   // TODO: static ?
 
     std::unique_ptr<assignment_expression_node> expr;
     int num_subexpressions = 0;
@@ -759,7 +757,7 @@ auto primary_expression_node::get_literal() const
 
 struct expression_statement_node
 {
-    static inline std::vector<expression_statement_node*> current_expression_statements = {};   // TODO: static ?
+    static inline thread_local std::vector<expression_statement_node*> current_expression_statements = {};   // TODO: static ?
 
     std::unique_ptr<expression_node> expr;
     bool has_semicolon = false;
@@ -2712,6 +2710,7 @@ struct declaration_node
     //  Attributes currently configurable only via metafunction API,
     //  not directly in the base language grammar
     bool member_function_generation = true;
+    bool definition_out_of_line     = false;
 
     //  Cache some context
     bool is_a_template_parameter = false;
@@ -2738,6 +2737,12 @@ struct declaration_node
         return is_a_parameter;
     }
 
+    auto has_template_parameters() const
+        -> bool
+    {
+        return template_parameters != nullptr;
+    }
+
     auto type_member_mark_for_removal()
         -> bool
     {
@@ -2789,6 +2794,50 @@ struct declaration_node
         member_function_generation = false;
     }
 
+    //  A nested type whose definition is emitted with the function
+    //  definitions instead of inside its enclosing type, which then
+    //  only forward-declares it (e.g., a @pimpl type's implementation)
+    auto type_define_out_of_line()
+        -> void
+    {
+        assert (is_type() && parent_is_type());
+        definition_out_of_line = true;
+    }
+
+    auto is_type_defined_out_of_line() const
+        -> bool
+    {
+        return definition_out_of_line;
+    }
+
+    //  Move one of this type's members into another type, keeping
+    //  the member's parse tree (and so its source positions) intact
+    auto type_move_member_to(
+        declaration_node const& member,
+        declaration_node&       target
+    )
+        -> bool
+    {
+        assert (is_type() && initializer && initializer->is_compound());
+        auto compound_stmt = initializer->get_if<compound_statement_node>();
+        assert (compound_stmt);
+
+        for (auto i = compound_stmt->statements.begin(); i != compound_stmt->statements.end(); ++i)
+        {
+            if ((*i)->get_if<declaration_node>() == &member)
+            {
+                auto stmt = std::move(*i);
+                compound_stmt->statements.erase(i);
+                stmt->get_if<declaration_node>()->parent_declaration = nullptr;
+                if (target.is_type() && target.initializer) {
+                    stmt->compound_parent = target.initializer->get_if<compound_statement_node>();
+                }
+                return target.add_type_member( std::move(stmt) );
+            }
+        }
+        return false;
+    }
+
     auto object_type() const
         -> std::string
     {
@@ -4458,7 +4507,7 @@ auto pretty_print_visualize(type_node const& n, int indent)
     -> std::string;
 auto pretty_print_visualize(namespace_node const& n, int indent)
     -> std::string;
-auto pretty_print_visualize(declaration_node const& n, int indent, bool include_metafunctions_list = false)
+auto pretty_print_visualize(declaration_node const& n, int indent, bool include_metafunctions_list = false, bool include_initializer = true)
     -> std::string;
 
 
@@ -4466,8 +4515,12 @@ auto pretty_print_visualize(declaration_node const& n, int indent, bool include_
 //-----------------------------------------------------------------------
 //  pre: Get an indentation prefix
 //
-inline static int         indent_spaces  = 2;
-inline static std::string indent_str     = std::string( 1024, ' ' );    // "1K should be enough for everyone"
+//  indent_spaces is set by each kind of printing, which can run on several
+//  threads at once (e.g., metafunctions calling print_signature), so each
+//  thread has its own
+//
+inline thread_local int         indent_spaces  = 2;
+inline static std::string const indent_str     = std::string( 1024, ' ' );    // "1K should be enough for everyone"
 
 auto pre(int indent)
     -> std::string_view
@@ -5125,7 +5178,7 @@ auto pretty_print_visualize(namespace_node const&)
 }
 
 
-auto pretty_print_visualize(declaration_node const& n, int indent, bool include_metafunctions_list /* = false */ )
+auto pretty_print_visualize(declaration_node const& n, int indent, bool include_metafunctions_list /* = false */, bool include_initializer /* = true */ )
     -> std::string
 {
     indent_spaces = 4;
@@ -5159,7 +5212,11 @@ auto pretty_print_visualize(declaration_node const& n, int indent, bool include_
     }
 
     auto initializer = std::string{};
-    if (n.initializer) {
+    if (
+        n.initializer
+        && include_initializer
+        )
+    {
         auto adjusted_indent = indent;
         if (!n.name()) {
             ++adjusted_indent;
@@ -5189,7 +5246,7 @@ auto pretty_print_visualize(declaration_node const& n, int indent, bool include_
         && !n.is_parameter()
         )
     {
-        static declaration_node const* last_parent_type = {};
+        thread_local declaration_node const* last_parent_type = {};
         if (n.parent_is_type()) {
             if (last_parent_type != n.get_parent()) {
                 last_parent_type = n.get_parent();
@@ -5377,6 +5434,9 @@ class parser
 
     std::vector<token> const* tokens = {};
     stable_vector<token>*     generated_tokens = {};
+
+    //  A stable place to store source code generated while parsing
+    generated_source          generated = {};
     int pos = 0;
     std::string parse_kind = {};
 
@@ -5394,7 +5454,16 @@ class parser
     mutable std::vector<function_body_extent> function_body_extents;
     mutable bool                              is_function_body_extents_sorted = false;
 
+    //  Set when we report an error that's a lifetime safety violation
+    bool found_lifetime_safety_violation = false;
+
 public:
+    auto violates_lifetime_safety() const
+        -> bool
+    {
+        return found_lifetime_safety_violation;
+    }
+
     auto is_within_function_body(source_position p) const
     {
         //  Short circuit the empty case, so that the rest of the function
@@ -5576,6 +5645,16 @@ public:
     }
 
 
+    //-----------------------------------------------------------------------
+    //  Get the lexers of the code generated while parsing (e.g., by metafunctions)
+    //
+    auto get_generated_lexers() const
+        -> auto const&
+    {
+        return generated.lexers;
+    }
+
+
     //-----------------------------------------------------------------------
     //  visit
     //
@@ -8234,13 +8313,7 @@ private:
             )
         {
             //  So invent the "type" token
-            generated_text.push_back("type");
-            generated_tokens->push_back({
-                generated_text.back().c_str(),
-                std::ssize(generated_text.back()),
-                start,
-                lexeme::Identifier
-            });
+            generated_tokens->emplace_back( "type", start, lexeme::Identifier );
 
             //  So we can create the type_node
 
@@ -8276,13 +8349,7 @@ private:
             )
         {
             //  So invent the "_" token
-            generated_text.push_back("_");
-            generated_tokens->push_back({
-                generated_text.back().c_str(),
-                std::ssize(generated_text.back()),
-                start,
-                lexeme::Identifier
-            });
+            generated_tokens->emplace_back( "_", start, lexeme::Identifier );
 
             //  So we can create the typeid_id_node and its unqualified_id_node
 
@@ -8550,7 +8617,7 @@ private:
                         )
                     {
                         error("pointer cannot be initialized to null or int - leave it uninitialized and then set it to a non-null value when you have one");
-                        violates_lifetime_safety = true;
+                        found_lifetime_safety_violation = true;
                         throw std::runtime_error("null initialization detected");
                     }
                 }
@@ -18,28 +18,35 @@ namespace meta {
 #line 32 "reflect.h2"
 class compiler_services;
 
-#line 223 "reflect.h2"
+#line 226 "reflect.h2"
 class declaration_base;
 
-#line 249 "reflect.h2"
+#line 252 "reflect.h2"
 class declaration;
 
-#line 331 "reflect.h2"
+#line 343 "reflect.h2"
 class function_declaration;
 
-#line 421 "reflect.h2"
+#line 435 "reflect.h2"
 class object_declaration;
 
-#line 457 "reflect.h2"
+#line 471 "reflect.h2"
 class type_declaration;
 
-#line 592 "reflect.h2"
+#line 608 "reflect.h2"
 class alias_declaration;
 
-#line 965 "reflect.h2"
+#line 1230 "reflect.h2"
+class bitpacked_member_info;
+
+#line 1567 "reflect.h2"
+class forwarding_call;
+    
+
+#line 1971 "reflect.h2"
 class value_member_info;
 
-#line 1483 "reflect.h2"
+#line 2510 "reflect.h2"
 }
 
 }
@@ -87,6 +94,7 @@ class compiler_services
     private: std::vector<error_entry>* errors; 
     private: int errors_original_size; 
     private: stable_vector<token>* generated_tokens; 
+    private: generated_source* generated; 
     private: cpp2::parser parser; 
     private: std::string metafunction_name {}; 
     private: std::vector<std::string> metafunction_args {}; 
@@ -97,37 +105,38 @@ class compiler_services
     public: explicit compiler_services(
 
         std::vector<error_entry>* errors_, 
-        stable_vector<token>* generated_tokens_
+        stable_vector<token>* generated_tokens_, 
+        generated_source* generated_
     );
 
-#line 58 "reflect.h2"
+#line 61 "reflect.h2"
     //  Common API
     //
     public: auto set_metafunction_name(cpp2::impl::in<std::string_view> name, cpp2::impl::in<std::vector<std::string>> args) & -> void;
 
-#line 66 "reflect.h2"
+#line 69 "reflect.h2"
     public: [[nodiscard]] auto get_metafunction_name() const& -> std::string_view;
 
     public: [[nodiscard]] auto get_argument(cpp2::impl::in<int> index) & -> std::string;
 
-#line 76 "reflect.h2"
+#line 79 "reflect.h2"
     public: [[nodiscard]] auto get_arguments() & -> std::vector<std::string>;
 
-#line 81 "reflect.h2"
+#line 84 "reflect.h2"
     public: [[nodiscard]] auto arguments_were_used() const& -> bool;
 using parse_statement_ret = std::unique_ptr<statement_node>;
 
 
-#line 83 "reflect.h2"
+#line 86 "reflect.h2"
     protected: [[nodiscard]] auto parse_statement(
 
         std::string_view source
     ) & -> parse_statement_ret;
 
-#line 136 "reflect.h2"
+#line 139 "reflect.h2"
     public: [[nodiscard]] virtual auto position() const -> source_position;
 
-#line 142 "reflect.h2"
+#line 145 "reflect.h2"
     //  Error diagnosis and handling, integrated with compiler output
     //  Unlike a contract violation, .requires continues further processing
     //
@@ -137,24 +146,24 @@ using parse_statement_ret = std::unique_ptr<statement_node>;
         cpp2::impl::in<std::string_view> msg
     ) const& -> void;
 
-#line 156 "reflect.h2"
+#line 159 "reflect.h2"
     public: auto error(cpp2::impl::in<std::string_view> msg) const& -> void;
 
-#line 165 "reflect.h2"
+#line 168 "reflect.h2"
     //  Enable custom contracts on this object, integrated with compiler output
     //  Unlike .requires, a contract violation stops further processing
     //
     public: auto report_violation(auto const& msg) const& -> void;
 
-#line 173 "reflect.h2"
+#line 176 "reflect.h2"
     public: [[nodiscard]] auto is_active() const& -> auto;
     public: virtual ~compiler_services() noexcept;
 public: compiler_services(compiler_services const& that);
 
-#line 174 "reflect.h2"
+#line 177 "reflect.h2"
 };
 
-#line 177 "reflect.h2"
+#line 180 "reflect.h2"
 /*
 //-----------------------------------------------------------------------
 //
@@ -191,7 +200,7 @@ type_id: @polymorphic_base @copyable type =
 }
 */
 
-#line 214 "reflect.h2"
+#line 217 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //  Declarations
@@ -204,7 +213,7 @@ type_id: @polymorphic_base @copyable type =
 class declaration_base
 : public compiler_services {
 
-#line 227 "reflect.h2"
+#line 230 "reflect.h2"
     protected: declaration_node* n; 
 
     protected: explicit declaration_base(
@@ -213,31 +222,31 @@ class declaration_base
         cpp2::impl::in<compiler_services> s
     );
 
-#line 240 "reflect.h2"
+#line 243 "reflect.h2"
     public: [[nodiscard]] auto position() const -> source_position override;
 
     public: [[nodiscard]] auto print() const& -> std::string;
     public: virtual ~declaration_base() noexcept;
 public: declaration_base(declaration_base const& that);
 
-#line 243 "reflect.h2"
+#line 246 "reflect.h2"
 };
 
-#line 246 "reflect.h2"
+#line 249 "reflect.h2"
 //-----------------------------------------------------------------------
 //  All declarations
 //
 class declaration
 : public declaration_base {
 
-#line 253 "reflect.h2"
+#line 256 "reflect.h2"
     public: explicit declaration(
 
         declaration_node* n_, 
         cpp2::impl::in<compiler_services> s
     );
 
-#line 262 "reflect.h2"
+#line 265 "reflect.h2"
     public: [[nodiscard]] auto is_public() const& -> bool;
     public: [[nodiscard]] auto is_protected() const& -> bool;
     public: [[nodiscard]] auto is_private() const& -> bool;
@@ -256,9 +265,11 @@ class declaration
 
     public: [[nodiscard]] auto name() const& -> std::string_view;
 
-#line 283 "reflect.h2"
+#line 286 "reflect.h2"
     public: [[nodiscard]] auto has_initializer() const& -> bool;
 
+    public: [[nodiscard]] auto has_template_parameters() const& -> bool;
+
     public: [[nodiscard]] auto is_global() const& -> bool;
     public: [[nodiscard]] auto is_function() const& -> bool;
     public: [[nodiscard]] auto is_object() const& -> bool;
@@ -294,29 +305,33 @@ class declaration
     public: [[nodiscard]] auto parent_is_polymorphic() const& -> bool;
 
     public: auto mark_for_removal_from_enclosing_type() & -> void;
+                                                    // this precondition should be sufficient ...
+
+#line 331 "reflect.h2"
+    public: auto move_to_type(type_declaration& target) & -> void;
     public: virtual ~declaration() noexcept;
 public: declaration(declaration const& that);
 
                                                     // this precondition should be sufficient ...
 
-#line 325 "reflect.h2"
+#line 337 "reflect.h2"
 };
 
-#line 328 "reflect.h2"
+#line 340 "reflect.h2"
 //-----------------------------------------------------------------------
 //  Function declarations
 //
 class function_declaration
 : public declaration {
 
-#line 335 "reflect.h2"
+#line 347 "reflect.h2"
     public: explicit function_declaration(
 
         declaration_node* n_, 
         cpp2::impl::in<compiler_services> s
     );
 
-#line 345 "reflect.h2"
+#line 357 "reflect.h2"
     public: [[nodiscard]] auto index_of_parameter_named(cpp2::impl::in<std::string_view> s) const& -> int;
     public: [[nodiscard]] auto has_parameter_named(cpp2::impl::in<std::string_view> s) const& -> bool;
     public: [[nodiscard]] auto has_in_parameter_named(cpp2::impl::in<std::string_view> s) const& -> bool;
@@ -354,9 +369,11 @@ class function_declaration
 
     public: [[nodiscard]] auto unnamed_return_type() const& -> std::string;
 
+    public: [[nodiscard]] auto print_signature() const& -> std::string;
+
     public: [[nodiscard]] auto get_parameters() const& -> std::vector<object_declaration>;
 
-#line 392 "reflect.h2"
+#line 406 "reflect.h2"
     public: [[nodiscard]] auto is_binary_comparison_function() const& -> bool;
 
     public: auto default_to_virtual() & -> void;
@@ -367,103 +384,105 @@ class function_declaration
     public: function_declaration(function_declaration const& that);
 
 
-#line 415 "reflect.h2"
+#line 429 "reflect.h2"
 };
 
-#line 418 "reflect.h2"
+#line 432 "reflect.h2"
 //-----------------------------------------------------------------------
 //  Object declarations
 //
 class object_declaration
 : public declaration {
 
-#line 425 "reflect.h2"
+#line 439 "reflect.h2"
     public: explicit object_declaration(
 
         declaration_node* n_, 
         cpp2::impl::in<compiler_services> s
     );
 
-#line 435 "reflect.h2"
+#line 449 "reflect.h2"
     public: [[nodiscard]] auto is_const() const& -> bool;
     public: [[nodiscard]] auto has_wildcard_type() const& -> bool;
 
     public: [[nodiscard]] auto type() const& -> std::string;
 
-#line 445 "reflect.h2"
+#line 459 "reflect.h2"
     public: [[nodiscard]] auto initializer() const& -> std::string;
     public: object_declaration(object_declaration const& that);
 
 
-#line 451 "reflect.h2"
+#line 465 "reflect.h2"
 };
 
-#line 454 "reflect.h2"
+#line 468 "reflect.h2"
 //-----------------------------------------------------------------------
 //  Type declarations
 //
 class type_declaration
 : public declaration {
 
-#line 461 "reflect.h2"
+#line 475 "reflect.h2"
     public: explicit type_declaration(
 
         declaration_node* n_, 
         cpp2::impl::in<compiler_services> s
     );
 
-#line 471 "reflect.h2"
+#line 485 "reflect.h2"
     public: auto reserve_names(cpp2::impl::in<std::string_view> name, auto&& ...etc) const& -> void;
 
-#line 483 "reflect.h2"
+#line 497 "reflect.h2"
     public: [[nodiscard]] auto is_polymorphic() const& -> bool;
     public: [[nodiscard]] auto is_final() const& -> bool;
     public: [[nodiscard]] auto make_final() & -> bool;
 
     public: [[nodiscard]] auto get_member_functions() const& -> std::vector<function_declaration>;
 
-#line 498 "reflect.h2"
+#line 512 "reflect.h2"
     public: [[nodiscard]] auto get_member_functions_needing_initializer() const& -> std::vector<function_declaration>;
 
-#line 513 "reflect.h2"
+#line 527 "reflect.h2"
     public: [[nodiscard]] auto get_member_objects() const& -> std::vector<object_declaration>;
 
-#line 523 "reflect.h2"
+#line 537 "reflect.h2"
     public: [[nodiscard]] auto get_member_types() const& -> std::vector<type_declaration>;
 
-#line 533 "reflect.h2"
+#line 547 "reflect.h2"
     public: [[nodiscard]] auto get_member_aliases() const& -> std::vector<alias_declaration>;
 
-#line 543 "reflect.h2"
+#line 557 "reflect.h2"
     public: [[nodiscard]] auto get_members() const& -> std::vector<declaration>;
 struct query_declared_value_set_functions_ret { bool out_this_in_that; bool out_this_move_that; bool inout_this_in_that; bool inout_this_move_that; };
 
 
 
-#line 553 "reflect.h2"
+#line 567 "reflect.h2"
     public: [[nodiscard]] auto query_declared_value_set_functions() const& -> query_declared_value_set_functions_ret;
 
-#line 568 "reflect.h2"
+#line 582 "reflect.h2"
     public: auto add_member(cpp2::impl::in<std::string_view> source) & -> void;
 
-#line 582 "reflect.h2"
+#line 596 "reflect.h2"
     public: auto remove_marked_members() & -> void;
     public: auto remove_all_members() & -> void;
 
     public: auto disable_member_function_generation() & -> void;
+
+    public: auto define_out_of_line() & -> void;
     public: type_declaration(type_declaration const& that);
 
-#line 586 "reflect.h2"
+#line 602 "reflect.h2"
 };
 
-#line 589 "reflect.h2"
+#line 605 "reflect.h2"
 //-----------------------------------------------------------------------
 //  Alias declarations
 //
 class alias_declaration
 : public declaration {
 
-#line 596 "reflect.h2"
+#line 612 "reflect.h2"
     public: explicit alias_declaration(
 
         declaration_node* n_, 
@@ -472,10 +491,10 @@ class alias_declaration
     public: alias_declaration(alias_declaration const& that);
 
 
-#line 605 "reflect.h2"
+#line 621 "reflect.h2"
 };
 
-#line 608 "reflect.h2"
+#line 624 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //  Metafunctions - these are hardwired for now until we get to the
@@ -490,7 +509,7 @@ class alias_declaration
 //
 auto add_virtual_destructor(meta::type_declaration& t) -> void;
 
-#line 626 "reflect.h2"
+#line 642 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //      "... an abstract base class defines an interface ..."
@@ -505,7 +524,7 @@ auto add_virtual_destructor(meta::type_declaration& t) -> void;
 //
 auto interface(meta::type_declaration& t) -> void;
 
-#line 665 "reflect.h2"
+#line 681 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //     "C.35: A base class destructor should be either public and
@@ -527,7 +546,7 @@ auto interface(meta::type_declaration& t) -> void;
 //
 auto polymorphic_base(meta::type_declaration& t) -> void;
 
-#line 709 "reflect.h2"
+#line 725 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //     "... A totally ordered type ... requires operator<=> that
@@ -548,12 +567,18 @@ auto polymorphic_base(meta::type_declaration& t) -> void;
 //-----------------------------------------------------------------------
 //
 
+//  The size of 'type' if it's an unsigned integer type or an array of
+//  bytes, so that its values order the same way as their big-endian
+//  bytes, and otherwise 0
+[[nodiscard]] auto unsigned_key_type_size(cpp2::impl::in<std::string_view> type) -> int;
+
+#line 812 "reflect.h2"
 auto ordered_impl(
     meta::type_declaration& t, 
     cpp2::impl::in<std::string_view> ordering// must be "strong_ordering" etc.
 ) -> void;
 
-#line 753 "reflect.h2"
+#line 922 "reflect.h2"
 //-----------------------------------------------------------------------
 //  ordered - a totally ordered type
 //
@@ -561,19 +586,19 @@ auto ordered_impl(
 //
 auto ordered(meta::type_declaration& t) -> void;
 
-#line 763 "reflect.h2"
+#line 932 "reflect.h2"
 //-----------------------------------------------------------------------
 //  weakly_ordered - a weakly ordered type
 //
 auto weakly_ordered(meta::type_declaration& t) -> void;
 
-#line 771 "reflect.h2"
+#line 940 "reflect.h2"
 //-----------------------------------------------------------------------
 //  partially_ordered - a partially ordered type
 //
 auto partially_ordered(meta::type_declaration& t) -> void;
 
-#line 780 "reflect.h2"
+#line 949 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //     "A value is ... a regular type. It must have all public
@@ -592,7 +617,7 @@ auto partially_ordered(meta::type_declaration& t) -> void;
 //
 auto copyable(meta::type_declaration& t) -> void;
 
-#line 817 "reflect.h2"
+#line 986 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //  basic_value
@@ -602,7 +627,7 @@ auto copyable(meta::type_declaration& t) -> void;
 //
 auto basic_value(meta::type_declaration& t) -> void;
 
-#line 842 "reflect.h2"
+#line 1011 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //     "A 'value' is a totally ordered basic_value..."
@@ -615,13 +640,13 @@ auto basic_value(meta::type_declaration& t) -> void;
 //
 auto value(meta::type_declaration& t) -> void;
 
-#line 858 "reflect.h2"
+#line 1027 "reflect.h2"
 auto weakly_ordered_value(meta::type_declaration& t) -> void;
 
-#line 864 "reflect.h2"
+#line 1033 "reflect.h2"
 auto partially_ordered_value(meta::type_declaration& t) -> void;
 
-#line 871 "reflect.h2"
+#line 1040 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //     C.20: If you can avoid defining default operations, do
@@ -646,7 +671,7 @@ auto partially_ordered_value(meta::type_declaration& t) -> void;
 //
 auto cpp1_rule_of_zero(meta::type_declaration& t) -> void;
 
-#line 905 "reflect.h2"
+#line 1074 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //     "By definition, a `struct` is a `class` in which members
@@ -674,7 +699,139 @@ auto cpp1_rule_of_zero(meta::type_declaration& t) -> void;
 //
 auto cpp2_struct(meta::type_declaration& t) -> void;
 
-#line 948 "reflect.h2"
+#line 1117 "reflect.h2"
+//-----------------------------------------------------------------------
+//
+//  trivially_relocatable
+//
+//  a type whose objects can be relocated by copying their bytes, because
+//  every base and data member can be -- containers like
+//  cpp2::relocating_vector then grow with memcpy instead of moving and
+//  destroying each object
+//
+//  Note: applying this is also a promise that the type's own copy/move
+//  functions don't depend on the object's address, which we can't check
+//
+auto trivially_relocatable(meta::type_declaration& t) -> void;
+
+#line 1180 "reflect.h2"
+//-----------------------------------------------------------------------
+//
+//  slot_map
+//
+//  a type whose objects are kept in a cpp2::slot_map: adds 'slots', a
+//  container with dense storage and O(1) checked lookup, and 'handle',
+//  the generational handle it gives out instead of an index or pointer
+//
+auto slot_map(meta::type_declaration& t) -> void;
+
+#line 1217 "reflect.h2"
+//-----------------------------------------------------------------------
+//
+//  bitpacked
+//
+//  a type whose data members are packed into as few bits as they need:
+//  each member has type bool, cpp2::bits<N> (an unsigned N-bit value), or
+//  cpp2::signed_bits<N>, and is replaced by a range-checked getter and
+//  setter over the packed storage
+//
+//  Members are packed from the most significant bit down, with signed
+//  values stored offset by 2^(N-1), so comparing the storage words
+//  compares the members in declaration order
+//
+class bitpacked_member_info {
+    public: std::string name; 
+    public: std::string type; 
+    public: int width; 
+    public: bool is_signed; 
+    public: int word; 
+    public: int shift; 
+    public: std::string initializer; 
+};
+
+auto bitpacked(meta::type_declaration& t) -> void;
+
+#line 1439 "reflect.h2"
+//-----------------------------------------------------------------------
+//
+//  simd_vector
+//
+//  a small fixed-size vector of numbers, like a vec3 or rgba: all data
+//  members have the same arithmetic type, and it gets elementwise
+//  arithmetic, dot/min/max/abs, and a structure-of-arrays 'batch' type
+//  whose bulk operations run a SIMD vector at a time
+//
+auto simd_vector(meta::type_declaration& t) -> void;
+
+#line 1559 "reflect.h2"
+//-----------------------------------------------------------------------
+//
+//  forwarding_call_for
+//
+//  the parts of a function that forwards to a member function 'mf' of
+//  another object: mf's signature on one line, and the arguments to pass
+//  along, where 'that' is passed as 'that_arg'
+//
+class forwarding_call {
+    public: std::string signature; 
+    public: std::string args; 
+    public: bool is_generic; 
+};
+
+[[nodiscard]] auto forwarding_call_for(
+    cpp2::impl::in<meta::function_declaration> mf, 
+    cpp2::impl::in<std::string> that_arg
+    ) -> forwarding_call;
+
+#line 1627 "reflect.h2"
+//-----------------------------------------------------------------------
+//
+//  pimpl
+//
+//  a type that keeps its data members in a separately allocated '_impl'
+//  object, so that code that uses the type doesn't depend on them: the
+//  data members and the functions that use 'this' move into '_impl', the
+//  public functions are replaced by functions that forward to it, and
+//  '_impl' is defined together with the function definitions (for a .h2
+//  file, in the .hpp instead of the .h that other files include)
+//
+//  Like any type, it's copyable only if it declares operator=: (out this,
+//  that), e.g., from @copyable applied before @pimpl. A moved-from object
+//  can only be assigned to or destroyed
+//
+auto pimpl(meta::type_declaration& t) -> void;
+
+#line 1758 "reflect.h2"
+//-----------------------------------------------------------------------
+//
+//  copy_on_write
+//
+//  a basic_value whose data members are kept in a shared '_data' block,
+//  so that copying is O(1): the data members and the functions that use
+//  'this' move into '_data', public functions with 'in this' are replaced
+//  by functions that forward to the shared block, and ones with 'inout
+//  this' first copy the block if another object still shares it
+//
+//  A moved-from object can only be assigned to or destroyed
+//
+auto copy_on_write(meta::type_declaration& t) -> void;
+
+#line 1892 "reflect.h2"
+//-----------------------------------------------------------------------
+//
+//  interned
+//
+//  an immutable value type whose distinct values are each stored once:
+//  'intern()' returns a 'handle', a pointer-sized cpp2::interned that
+//  compares and hashes by address in O(1) and refers to the one shared
+//  object with the same value, and orders by the type's own <=>
+//
+//  All data members must be const, so the type follows the rule of zero
+//  and its data members are made public (they can only be read)
+//
+auto interned(meta::type_declaration& t) -> void;
+
+#line 1954 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //     "C enumerations constitute a curiously half-baked concept. ...
@@ -704,7 +861,7 @@ auto basic_enum(
     cpp2::impl::in<bool> bitwise
     ) -> void;
 
-#line 1155 "reflect.h2"
+#line 2161 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //    "An enum[...] is a totally ordered value type that stores a
@@ -716,7 +873,7 @@ auto basic_enum(
 //
 auto cpp2_enum(meta::type_declaration& t) -> void;
 
-#line 1181 "reflect.h2"
+#line 2187 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //     "flag_enum expresses an enumeration that stores values
@@ -729,7 +886,7 @@ auto cpp2_enum(meta::type_declaration& t) -> void;
 //
 auto flag_enum(meta::type_declaration& t) -> void;
 
-#line 1213 "reflect.h2"
+#line 2219 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //     "As with void*, programmers should know that unions [...] are
@@ -756,14 +913,14 @@ auto flag_enum(meta::type_declaration& t) -> void;
 
 auto cpp2_union(meta::type_declaration& t) -> void;
 
-#line 1366 "reflect.h2"
+#line 2372 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //  print - output a pretty-printed visualization of t
 //
 auto print(cpp2::impl::in<meta::type_declaration> t) -> void;
 
-#line 1376 "reflect.h2"
+#line 2382 "reflect.h2"
 //-----------------------------------------------------------------------
 //
 //  apply_metafunctions
@@ -774,7 +931,7 @@ auto print(cpp2::impl::in<meta::type_declaration> t) -> void;
     auto const& error
     ) -> bool;
 
-#line 1483 "reflect.h2"
+#line 2510 "reflect.h2"
 }
 
 }
@@ -789,33 +946,35 @@ namespace cpp2 {
 
 namespace meta {
 
-#line 46 "reflect.h2"
+#line 47 "reflect.h2"
     compiler_services::compiler_services(
 
         std::vector<error_entry>* errors_, 
-        stable_vector<token>* generated_tokens_
+        stable_vector<token>* generated_tokens_, 
+        generated_source* generated_
     )
         : errors{ errors_ }
         , errors_original_size{ cpp2::unsafe_narrow<int>(std::ssize(*cpp2::impl::assert_not_null(errors))) }
         , generated_tokens{ generated_tokens_ }
+        , generated{ generated_ }
         , parser{ *cpp2::impl::assert_not_null(errors) }
-#line 51 "reflect.h2"
+#line 53 "reflect.h2"
     {
 
-#line 56 "reflect.h2"
+#line 59 "reflect.h2"
     }
 
-#line 60 "reflect.h2"
+#line 63 "reflect.h2"
     auto compiler_services::set_metafunction_name(cpp2::impl::in<std::string_view> name, cpp2::impl::in<std::vector<std::string>> args) & -> void{
         metafunction_name  = name;
         metafunction_args  = args;
         metafunctions_used = CPP2_UFCS(empty)(args);
     }
 
-#line 66 "reflect.h2"
+#line 69 "reflect.h2"
     [[nodiscard]] auto compiler_services::get_metafunction_name() const& -> std::string_view { return metafunction_name;  }
 
-#line 68 "reflect.h2"
+#line 71 "reflect.h2"
     [[nodiscard]] auto compiler_services::get_argument(cpp2::impl::in<int> index) & -> std::string{
         metafunctions_used = true;
         if (([_0 = 0, _1 = index, _2 = CPP2_UFCS(ssize)(metafunction_args)]{ return cpp2::impl::cmp_less_eq(_0,_1) && cpp2::impl::cmp_less(_1,_2); }())) {
@@ -824,16 +983,16 @@ namespace meta {
         return ""; 
     }
 
-#line 76 "reflect.h2"
+#line 79 "reflect.h2"
     [[nodiscard]] auto compiler_services::get_arguments() & -> std::vector<std::string>{
         metafunctions_used = true;
         return metafunction_args; 
     }
 
-#line 81 "reflect.h2"
+#line 84 "reflect.h2"
     [[nodiscard]] auto compiler_services::arguments_were_used() const& -> bool { return metafunctions_used;  }
 
-#line 83 "reflect.h2"
+#line 86 "reflect.h2"
     [[nodiscard]] auto compiler_services::parse_statement(
 
         std::string_view source
@@ -841,11 +1000,11 @@ namespace meta {
 
     {
             cpp2::impl::deferred_init<std::unique_ptr<statement_node>> ret;
-#line 89 "reflect.h2"
+#line 92 "reflect.h2"
         auto original_source {source}; 
 
-        CPP2_UFCS(push_back)(generated_lines, std::vector<source_line>());
-        auto lines {&CPP2_UFCS(back)(generated_lines)}; 
+        CPP2_UFCS(push_back)((*cpp2::impl::assert_not_null(generated)).lines, std::vector<source_line>());
+        auto lines {&CPP2_UFCS(back)((*cpp2::impl::assert_not_null(generated)).lines)}; 
 
         auto add_line {[&, _1 = lines](cpp2::impl::in<std::string_view> s) mutable -> void{
             static_cast<void>(CPP2_UFCS(emplace_back)((*cpp2::impl::assert_not_null(_1)), s, source_line::category::cpp2));
@@ -856,7 +1015,7 @@ auto newline_pos{CPP2_UFCS(find)(source, '\n')};
         //  First split this string into source_lines
         //
 
-#line 101 "reflect.h2"
+#line 104 "reflect.h2"
         if ( cpp2::impl::cmp_greater(CPP2_UFCS(ssize)(source),1) 
             && newline_pos != source.npos) 
         {
@@ -869,7 +1028,7 @@ auto newline_pos{CPP2_UFCS(find)(source, '\n')};
         }
 }
 
-#line 112 "reflect.h2"
+#line 115 "reflect.h2"
         if (!(CPP2_UFCS(empty)(source))) {
             cpp2::move(add_line)(cpp2::move(source));
         }
@@ -877,8 +1036,8 @@ auto newline_pos{CPP2_UFCS(find)(source, '\n')};
         //  Now lex this source fragment to generate
         //  a single grammar_map entry, whose .second
         //  is the vector of tokens
-        static_cast<void>(CPP2_UFCS(emplace_back)(generated_lexers, *cpp2::impl::assert_not_null(errors)));
-        auto tokens {&CPP2_UFCS(back)(generated_lexers)}; 
+        static_cast<void>(CPP2_UFCS(emplace_back)((*cpp2::impl::assert_not_null(generated)).lexers, *cpp2::impl::assert_not_null(errors)));
+        auto tokens {&CPP2_UFCS(back)((*cpp2::impl::assert_not_null(generated)).lexers)}; 
         CPP2_UFCS(lex)((*cpp2::impl::assert_not_null(tokens)), *cpp2::impl::assert_not_null(cpp2::move(lines)), true);
 
         if (cpp2::cpp2_default.is_active() && !(std::ssize(CPP2_UFCS(get_map)((*cpp2::impl::assert_not_null(tokens)))) == 1) ) { cpp2::cpp2_default.report_violation(""); }
@@ -894,14 +1053,14 @@ auto newline_pos{CPP2_UFCS(find)(source, '\n')};
         }return std::move(ret.value()); 
     }
 
-#line 136 "reflect.h2"
+#line 139 "reflect.h2"
     [[nodiscard]] auto compiler_services::position() const -> source_position
 
     {
         return {  }; 
     }
 
-#line 145 "reflect.h2"
+#line 148 "reflect.h2"
     auto compiler_services::require(
 
         cpp2::impl::in<bool> b, 
@@ -913,7 +1072,7 @@ auto newline_pos{CPP2_UFCS(find)(source, '\n')};
         }
     }
 
-#line 156 "reflect.h2"
+#line 159 "reflect.h2"
     auto compiler_services::error(cpp2::impl::in<std::string_view> msg) const& -> void
     {
         auto message {cpp2::impl::as_<std::string>(msg)}; 
@@ -923,13 +1082,13 @@ auto newline_pos{CPP2_UFCS(find)(source, '\n')};
         static_cast<void>(CPP2_UFCS(emplace_back)((*cpp2::impl::assert_not_null(errors)), position(), cpp2::move(message)));
     }
 
-#line 168 "reflect.h2"
+#line 171 "reflect.h2"
     auto compiler_services::report_violation(auto const& msg) const& -> void{
         error(msg);
         throw(std::runtime_error(("  ==> programming bug found in metafunction @" + cpp2::to_string(metafunction_name) + " - contract violation - see previous errors")));
     }
 
-#line 173 "reflect.h2"
+#line 176 "reflect.h2"
     [[nodiscard]] auto compiler_services::is_active() const& -> auto { return true;  }
 
     compiler_services::~compiler_services() noexcept{}
@@ -937,12 +1096,13 @@ compiler_services::compiler_services(compiler_services const& that)
                                 : errors{ that.errors }
                                 , errors_original_size{ that.errors_original_size }
                                 , generated_tokens{ that.generated_tokens }
+                                , generated{ that.generated }
                                 , parser{ that.parser }
                                 , metafunction_name{ that.metafunction_name }
                                 , metafunction_args{ that.metafunction_args }
                                 , metafunctions_used{ that.metafunctions_used }{}
 
-#line 229 "reflect.h2"
+#line 232 "reflect.h2"
     declaration_base::declaration_base(
 
         declaration_node* n_, 
@@ -950,17 +1110,17 @@ compiler_services::compiler_services(compiler_services const& that)
     )
         : compiler_services{ s }
         , n{ n_ }
-#line 234 "reflect.h2"
+#line 237 "reflect.h2"
     {
 
-#line 237 "reflect.h2"
+#line 240 "reflect.h2"
         if (cpp2::cpp2_default.is_active() && !(n) ) { cpp2::cpp2_default.report_violation(CPP2_CONTRACT_MSG("a meta::declaration must point to a valid declaration_node, not null")); }
     }
 
-#line 240 "reflect.h2"
+#line 243 "reflect.h2"
     [[nodiscard]] auto declaration_base::position() const -> source_position { return CPP2_UFCS(position)((*cpp2::impl::assert_not_null(n)));  }
 
-#line 242 "reflect.h2"
+#line 245 "reflect.h2"
     [[nodiscard]] auto declaration_base::print() const& -> std::string { return CPP2_UFCS(pretty_print_visualize)((*cpp2::impl::assert_not_null(n)), 0);  }
 
     declaration_base::~declaration_base() noexcept{}
@@ -968,211 +1128,227 @@ declaration_base::declaration_base(declaration_base const& that)
                                 : compiler_services{ static_cast<compiler_services const&>(that) }
                                 , n{ that.n }{}
 
-#line 253 "reflect.h2"
+#line 256 "reflect.h2"
     declaration::declaration(
 
         declaration_node* n_, 
         cpp2::impl::in<compiler_services> s
     )
         : declaration_base{ n_, s }
-#line 258 "reflect.h2"
+#line 261 "reflect.h2"
     {
 
     }
 
-#line 262 "reflect.h2"
+#line 265 "reflect.h2"
     [[nodiscard]] auto declaration::is_public() const& -> bool { return CPP2_UFCS(is_public)((*cpp2::impl::assert_not_null(n))); }
-#line 263 "reflect.h2"
+#line 266 "reflect.h2"
     [[nodiscard]] auto declaration::is_protected() const& -> bool { return CPP2_UFCS(is_protected)((*cpp2::impl::assert_not_null(n))); }
-#line 264 "reflect.h2"
+#line 267 "reflect.h2"
     [[nodiscard]] auto declaration::is_private() const& -> bool { return CPP2_UFCS(is_private)((*cpp2::impl::assert_not_null(n))); }
-#line 265 "reflect.h2"
+#line 268 "reflect.h2"
     [[nodiscard]] auto declaration::is_default_access() const& -> bool { return CPP2_UFCS(is_default_access)((*cpp2::impl::assert_not_null(n)));  }
 
-#line 267 "reflect.h2"
+#line 270 "reflect.h2"
     auto declaration::default_to_public() & -> void { static_cast<void>(CPP2_UFCS(make_public)((*cpp2::impl::assert_not_null(n)))); }
-#line 268 "reflect.h2"
+#line 271 "reflect.h2"
     auto declaration::default_to_protected() & -> void { static_cast<void>(CPP2_UFCS(make_protected)((*cpp2::impl::assert_not_null(n))));  }
-#line 269 "reflect.h2"
+#line 272 "reflect.h2"
     auto declaration::default_to_private() & -> void { static_cast<void>(CPP2_UFCS(make_private)((*cpp2::impl::assert_not_null(n)))); }
 
-#line 271 "reflect.h2"
+#line 274 "reflect.h2"
     [[nodiscard]] auto declaration::make_public() & -> bool { return CPP2_UFCS(make_public)((*cpp2::impl::assert_not_null(n))); }
-#line 272 "reflect.h2"
+#line 275 "reflect.h2"
     [[nodiscard]] auto declaration::make_protected() & -> bool { return CPP2_UFCS(make_protected)((*cpp2::impl::assert_not_null(n))); }
-#line 273 "reflect.h2"
+#line 276 "reflect.h2"
     [[nodiscard]] auto declaration::make_private() & -> bool { return CPP2_UFCS(make_private)((*cpp2::impl::assert_not_null(n))); }
 
-#line 275 "reflect.h2"
+#line 278 "reflect.h2"
     [[nodiscard]] auto declaration::has_name() const& -> bool { return CPP2_UFCS(has_name)((*cpp2::impl::assert_not_null(n))); }
-#line 276 "reflect.h2"
+#line 279 "reflect.h2"
     [[nodiscard]] auto declaration::has_name(cpp2::impl::in<std::string_view> s) const& -> bool { return CPP2_UFCS(has_name)((*cpp2::impl::assert_not_null(n)), s); }
 
-#line 278 "reflect.h2"
+#line 281 "reflect.h2"
     [[nodiscard]] auto declaration::name() const& -> std::string_view{
         if (has_name()) {return CPP2_UFCS(as_string_view)((*cpp2::impl::assert_not_null(CPP2_UFCS(name)(*cpp2::impl::assert_not_null(n))))); }
         else          { return ""; }
     }
 
-#line 283 "reflect.h2"
+#line 286 "reflect.h2"
     [[nodiscard]] auto declaration::has_initializer() const& -> bool { return CPP2_UFCS(has_initializer)((*cpp2::impl::assert_not_null(n)));  }
 
-#line 285 "reflect.h2"
+#line 288 "reflect.h2"
+    [[nodiscard]] auto declaration::has_template_parameters() const& -> bool { return CPP2_UFCS(has_template_parameters)((*cpp2::impl::assert_not_null(n)));  }
+
+#line 290 "reflect.h2"
     [[nodiscard]] auto declaration::is_global() const& -> bool { return CPP2_UFCS(is_global)((*cpp2::impl::assert_not_null(n))); }
-#line 286 "reflect.h2"
+#line 291 "reflect.h2"
     [[nodiscard]] auto declaration::is_function() const& -> bool { return CPP2_UFCS(is_function)((*cpp2::impl::assert_not_null(n))); }
-#line 287 "reflect.h2"
+#line 292 "reflect.h2"
     [[nodiscard]] auto declaration::is_object() const& -> bool { return CPP2_UFCS(is_object)((*cpp2::impl::assert_not_null(n))); }
-#line 288 "reflect.h2"
+#line 293 "reflect.h2"
     [[nodiscard]] auto declaration::is_base_object() const& -> bool { return CPP2_UFCS(is_base_object)((*cpp2::impl::assert_not_null(n))); }
-#line 289 "reflect.h2"
+#line 294 "reflect.h2"
     [[nodiscard]] auto declaration::is_member_object() const& -> bool { return CPP2_UFCS(is_member_object)((*cpp2::impl::assert_not_null(n)));  }
-#line 290 "reflect.h2"
+#line 295 "reflect.h2"
     [[nodiscard]] auto declaration::is_type() const& -> bool { return CPP2_UFCS(is_type)((*cpp2::impl::assert_not_null(n))); }
-#line 291 "reflect.h2"
+#line 296 "reflect.h2"
     [[nodiscard]] auto declaration::is_namespace() const& -> bool { return CPP2_UFCS(is_namespace)((*cpp2::impl::assert_not_null(n))); }
-#line 292 "reflect.h2"
+#line 297 "reflect.h2"
     [[nodiscard]] auto declaration::is_alias() const& -> bool { return CPP2_UFCS(is_alias)((*cpp2::impl::assert_not_null(n))); }
 
-#line 294 "reflect.h2"
+#line 299 "reflect.h2"
     [[nodiscard]] auto declaration::is_type_alias() const& -> bool { return CPP2_UFCS(is_type_alias)((*cpp2::impl::assert_not_null(n))); }
-#line 295 "reflect.h2"
+#line 300 "reflect.h2"
     [[nodiscard]] auto declaration::is_namespace_alias() const& -> bool { return CPP2_UFCS(is_namespace_alias)((*cpp2::impl::assert_not_null(n)));  }
-#line 296 "reflect.h2"
+#line 301 "reflect.h2"
     [[nodiscard]] auto declaration::is_object_alias() const& -> bool { return CPP2_UFCS(is_object_alias)((*cpp2::impl::assert_not_null(n))); }
 
-#line 298 "reflect.h2"
+#line 303 "reflect.h2"
     [[nodiscard]] auto declaration::is_function_expression() const& -> bool { return CPP2_UFCS(is_function_expression)((*cpp2::impl::assert_not_null(n)));  }
 
-#line 300 "reflect.h2"
+#line 305 "reflect.h2"
     [[nodiscard]] auto declaration::as_function() const& -> function_declaration { return function_declaration(n, (*this));  }
-#line 301 "reflect.h2"
+#line 306 "reflect.h2"
     [[nodiscard]] auto declaration::as_object() const& -> object_declaration { return object_declaration(n, (*this)); }
-#line 302 "reflect.h2"
+#line 307 "reflect.h2"
     [[nodiscard]] auto declaration::as_type() const& -> type_declaration { return type_declaration(n, (*this)); }
-#line 303 "reflect.h2"
+#line 308 "reflect.h2"
     [[nodiscard]] auto declaration::as_alias() const& -> alias_declaration { return alias_declaration(n, (*this)); }
 
-#line 305 "reflect.h2"
+#line 310 "reflect.h2"
     [[nodiscard]] auto declaration::get_parent() const& -> declaration { return declaration((*cpp2::impl::assert_not_null(n)).parent_declaration, (*this)); }
 
-#line 307 "reflect.h2"
+#line 312 "reflect.h2"
     [[nodiscard]] auto declaration::parent_is_function() const& -> bool { return CPP2_UFCS(parent_is_function)((*cpp2::impl::assert_not_null(n))); }
-#line 308 "reflect.h2"
+#line 313 "reflect.h2"
     [[nodiscard]] auto declaration::parent_is_object() const& -> bool { return CPP2_UFCS(parent_is_object)((*cpp2::impl::assert_not_null(n))); }
-#line 309 "reflect.h2"
+#line 314 "reflect.h2"
     [[nodiscard]] auto declaration::parent_is_type() const& -> bool { return CPP2_UFCS(parent_is_type)((*cpp2::impl::assert_not_null(n))); }
-#line 310 "reflect.h2"
+#line 315 "reflect.h2"
     [[nodiscard]] auto declaration::parent_is_namespace() const& -> bool { return CPP2_UFCS(parent_is_namespace)((*cpp2::impl::assert_not_null(n))); }
-#line 311 "reflect.h2"
+#line 316 "reflect.h2"
     [[nodiscard]] auto declaration::parent_is_alias() const& -> bool { return CPP2_UFCS(parent_is_alias)((*cpp2::impl::assert_not_null(n))); }
 
-#line 313 "reflect.h2"
+#line 318 "reflect.h2"
     [[nodiscard]] auto declaration::parent_is_type_alias() const& -> bool { return CPP2_UFCS(parent_is_type_alias)((*cpp2::impl::assert_not_null(n))); }
-#line 314 "reflect.h2"
+#line 319 "reflect.h2"
     [[nodiscard]] auto declaration::parent_is_namespace_alias() const& -> bool { return CPP2_UFCS(parent_is_namespace_alias)((*cpp2::impl::assert_not_null(n)));  }
-#line 315 "reflect.h2"
+#line 320 "reflect.h2"
     [[nodiscard]] auto declaration::parent_is_object_alias() const& -> bool { return CPP2_UFCS(parent_is_object_alias)((*cpp2::impl::assert_not_null(n))); }
 
-#line 317 "reflect.h2"
+#line 322 "reflect.h2"
     [[nodiscard]] auto declaration::parent_is_polymorphic() const& -> bool { return CPP2_UFCS(parent_is_polymorphic)((*cpp2::impl::assert_not_null(n)));  }
 
-#line 319 "reflect.h2"
+#line 324 "reflect.h2"
     auto declaration::mark_for_removal_from_enclosing_type() & -> void
 
     {
         if (cpp2::type_safety.is_active() && !(parent_is_type()) ) { cpp2::type_safety.report_violation(""); }
-#line 322 "reflect.h2"
+#line 327 "reflect.h2"
         auto test {CPP2_UFCS(type_member_mark_for_removal)((*cpp2::impl::assert_not_null(n)))}; 
         if (cpp2::cpp2_default.is_active() && !(cpp2::move(test)) ) { cpp2::cpp2_default.report_violation(""); }// ... to ensure this assert is true
     }
 
+#line 331 "reflect.h2"
+    auto declaration::move_to_type(type_declaration& target) & -> void
+
+    {
+        if (cpp2::type_safety.is_active() && !(parent_is_type()) ) { cpp2::type_safety.report_violation(""); }
+#line 334 "reflect.h2"
+        auto test {CPP2_UFCS(type_move_member_to)((*cpp2::impl::assert_not_null((*cpp2::impl::assert_not_null(n)).parent_declaration)), *cpp2::impl::assert_not_null(n), *cpp2::impl::assert_not_null(target.n))}; 
+        if (cpp2::cpp2_default.is_active() && !(cpp2::move(test)) ) { cpp2::cpp2_default.report_violation(""); }// ... to ensure this assert is true
+    }
+
     declaration::~declaration() noexcept{}
 declaration::declaration(declaration const& that)
                                 : declaration_base{ static_cast<declaration_base const&>(that) }{}
 
-#line 335 "reflect.h2"
+#line 347 "reflect.h2"
     function_declaration::function_declaration(
 
         declaration_node* n_, 
         cpp2::impl::in<compiler_services> s
     )
         : declaration{ n_, s }
-#line 340 "reflect.h2"
+#line 352 "reflect.h2"
     {
 
         if (cpp2::cpp2_default.is_active() && !(CPP2_UFCS(is_function)((*cpp2::impl::assert_not_null(n)))) ) { cpp2::cpp2_default.report_violation(""); }
     }
 
-#line 345 "reflect.h2"
+#line 357 "reflect.h2"
     [[nodiscard]] auto function_declaration::index_of_parameter_named(cpp2::impl::in<std::string_view> s) const& -> int { return CPP2_UFCS(index_of_parameter_named)((*cpp2::impl::assert_not_null(n)), s); }
-#line 346 "reflect.h2"
+#line 358 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_parameter_named(cpp2::impl::in<std::string_view> s) const& -> bool { return CPP2_UFCS(has_parameter_named)((*cpp2::impl::assert_not_null(n)), s); }
-#line 347 "reflect.h2"
+#line 359 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_in_parameter_named(cpp2::impl::in<std::string_view> s) const& -> bool { return CPP2_UFCS(has_in_parameter_named)((*cpp2::impl::assert_not_null(n)), s); }
-#line 348 "reflect.h2"
+#line 360 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_copy_parameter_named(cpp2::impl::in<std::string_view> s) const& -> bool { return CPP2_UFCS(has_copy_parameter_named)((*cpp2::impl::assert_not_null(n)), s); }
-#line 349 "reflect.h2"
+#line 361 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_inout_parameter_named(cpp2::impl::in<std::string_view> s) const& -> bool { return CPP2_UFCS(has_inout_parameter_named)((*cpp2::impl::assert_not_null(n)), s); }
-#line 350 "reflect.h2"
+#line 362 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_out_parameter_named(cpp2::impl::in<std::string_view> s) const& -> bool { return CPP2_UFCS(has_out_parameter_named)((*cpp2::impl::assert_not_null(n)), s); }
-#line 351 "reflect.h2"
+#line 363 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_move_parameter_named(cpp2::impl::in<std::string_view> s) const& -> bool { return CPP2_UFCS(has_move_parameter_named)((*cpp2::impl::assert_not_null(n)), s); }
-#line 352 "reflect.h2"
+#line 364 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_forward_parameter_named(cpp2::impl::in<std::string_view> s) const& -> bool { return CPP2_UFCS(has_forward_parameter_named)((*cpp2::impl::assert_not_null(n)), s); }
-#line 353 "reflect.h2"
+#line 365 "reflect.h2"
     [[nodiscard]] auto function_declaration::first_parameter_name() const& -> std::string { return CPP2_UFCS(first_parameter_name)((*cpp2::impl::assert_not_null(n))); }
 
-#line 355 "reflect.h2"
+#line 367 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_parameter_with_name_and_pass(cpp2::impl::in<std::string_view> s, cpp2::impl::in<passing_style> pass) const& -> bool { 
                                                   return CPP2_UFCS(has_parameter_with_name_and_pass)((*cpp2::impl::assert_not_null(n)), s, pass);  }
-#line 357 "reflect.h2"
+#line 369 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_function_with_this() const& -> bool { return CPP2_UFCS(is_function_with_this)((*cpp2::impl::assert_not_null(n))); }
-#line 358 "reflect.h2"
+#line 370 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_virtual() const& -> bool { return CPP2_UFCS(is_virtual_function)((*cpp2::impl::assert_not_null(n))); }
-#line 359 "reflect.h2"
+#line 371 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_defaultable() const& -> bool { return CPP2_UFCS(is_defaultable_function)((*cpp2::impl::assert_not_null(n))); }
-#line 360 "reflect.h2"
+#line 372 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_constructor() const& -> bool { return CPP2_UFCS(is_constructor)((*cpp2::impl::assert_not_null(n))); }
-#line 361 "reflect.h2"
+#line 373 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_default_constructor() const& -> bool { return CPP2_UFCS(is_default_constructor)((*cpp2::impl::assert_not_null(n))); }
-#line 362 "reflect.h2"
+#line 374 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_move() const& -> bool { return CPP2_UFCS(is_move)((*cpp2::impl::assert_not_null(n))); }
-#line 363 "reflect.h2"
+#line 375 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_swap() const& -> bool { return CPP2_UFCS(is_swap)((*cpp2::impl::assert_not_null(n))); }
-#line 364 "reflect.h2"
+#line 376 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_constructor_with_that() const& -> bool { return CPP2_UFCS(is_constructor_with_that)((*cpp2::impl::assert_not_null(n))); }
-#line 365 "reflect.h2"
+#line 377 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_constructor_with_in_that() const& -> bool { return CPP2_UFCS(is_constructor_with_in_that)((*cpp2::impl::assert_not_null(n))); }
-#line 366 "reflect.h2"
+#line 378 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_constructor_with_move_that() const& -> bool { return CPP2_UFCS(is_constructor_with_move_that)((*cpp2::impl::assert_not_null(n)));  }
-#line 367 "reflect.h2"
+#line 379 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_assignment() const& -> bool { return CPP2_UFCS(is_assignment)((*cpp2::impl::assert_not_null(n))); }
-#line 368 "reflect.h2"
+#line 380 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_assignment_with_that() const& -> bool { return CPP2_UFCS(is_assignment_with_that)((*cpp2::impl::assert_not_null(n))); }
-#line 369 "reflect.h2"
+#line 381 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_assignment_with_in_that() const& -> bool { return CPP2_UFCS(is_assignment_with_in_that)((*cpp2::impl::assert_not_null(n))); }
-#line 370 "reflect.h2"
+#line 382 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_assignment_with_move_that() const& -> bool { return CPP2_UFCS(is_assignment_with_move_that)((*cpp2::impl::assert_not_null(n)));  }
-#line 371 "reflect.h2"
+#line 383 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_destructor() const& -> bool { return CPP2_UFCS(is_destructor)((*cpp2::impl::assert_not_null(n))); }
 
-#line 373 "reflect.h2"
+#line 385 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_copy_or_move() const& -> bool { return is_constructor_with_that() || is_assignment_with_that(); }
 
-#line 375 "reflect.h2"
+#line 387 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_declared_return_type() const& -> bool { return CPP2_UFCS(has_declared_return_type)((*cpp2::impl::assert_not_null(n))); }
-#line 376 "reflect.h2"
+#line 388 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_deduced_return_type() const& -> bool { return CPP2_UFCS(has_deduced_return_type)((*cpp2::impl::assert_not_null(n))); }
-#line 377 "reflect.h2"
+#line 389 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_bool_return_type() const& -> bool { return CPP2_UFCS(has_bool_return_type)((*cpp2::impl::assert_not_null(n))); }
-#line 378 "reflect.h2"
+#line 390 "reflect.h2"
     [[nodiscard]] auto function_declaration::has_non_void_return_type() const& -> bool { return CPP2_UFCS(has_non_void_return_type)((*cpp2::impl::assert_not_null(n))); }
 
-#line 380 "reflect.h2"
+#line 392 "reflect.h2"
     [[nodiscard]] auto function_declaration::unnamed_return_type() const& -> std::string { return CPP2_UFCS(unnamed_return_type_to_string)((*cpp2::impl::assert_not_null(n))); }
 
-#line 382 "reflect.h2"
+#line 394 "reflect.h2"
+    [[nodiscard]] auto function_declaration::print_signature() const& -> std::string { return CPP2_UFCS(pretty_print_visualize)((*cpp2::impl::assert_not_null(n)), 0, false, false); }
+
+#line 396 "reflect.h2"
     [[nodiscard]] auto function_declaration::get_parameters() const& -> std::vector<object_declaration>
 
     {
@@ -1183,19 +1359,19 @@ declaration::declaration(declaration const& that)
         return ret; 
     }
 
-#line 392 "reflect.h2"
+#line 406 "reflect.h2"
     [[nodiscard]] auto function_declaration::is_binary_comparison_function() const& -> bool { return CPP2_UFCS(is_binary_comparison_function)((*cpp2::impl::assert_not_null(n)));  }
 
-#line 394 "reflect.h2"
+#line 408 "reflect.h2"
     auto function_declaration::default_to_virtual() & -> void { static_cast<void>(CPP2_UFCS(make_function_virtual)((*cpp2::impl::assert_not_null(n)))); }
 
-#line 396 "reflect.h2"
+#line 410 "reflect.h2"
     [[nodiscard]] auto function_declaration::make_virtual() & -> bool { return CPP2_UFCS(make_function_virtual)((*cpp2::impl::assert_not_null(n))); }
 
-#line 398 "reflect.h2"
+#line 412 "reflect.h2"
     auto function_declaration::add_initializer(cpp2::impl::in<std::string_view> source) & -> void
 
-#line 401 "reflect.h2"
+#line 415 "reflect.h2"
     {
         if ((*this).is_active() && !(!(has_initializer())) ) { (*this).report_violation(CPP2_CONTRACT_MSG("cannot add an initializer to a function that already has one")); }
         if ((*this).is_active() && !(parent_is_type()) ) { (*this).report_violation(CPP2_CONTRACT_MSG("cannot add an initializer to a function that isn't in a type scope")); }
@@ -1204,7 +1380,7 @@ declaration::declaration(declaration const& that)
         //require( parent_is_type(),
         //         "cannot add an initializer to a function that isn't in a type scope");
 
-#line 407 "reflect.h2"
+#line 421 "reflect.h2"
         auto stmt {parse_statement(source)}; 
         if (!((cpp2::impl::as_<bool>(stmt)))) {
             error("cannot add an initializer that is not a valid statement");
@@ -1217,25 +1393,25 @@ declaration::declaration(declaration const& that)
     function_declaration::function_declaration(function_declaration const& that)
                                 : declaration{ static_cast<declaration const&>(that) }{}
 
-#line 425 "reflect.h2"
+#line 439 "reflect.h2"
     object_declaration::object_declaration(
 
         declaration_node* n_, 
         cpp2::impl::in<compiler_services> s
     )
         : declaration{ n_, s }
-#line 430 "reflect.h2"
+#line 444 "reflect.h2"
     {
 
         if (cpp2::cpp2_default.is_active() && !(CPP2_UFCS(is_object)((*cpp2::impl::assert_not_null(n)))) ) { cpp2::cpp2_default.report_violation(""); }
     }
 
-#line 435 "reflect.h2"
+#line 449 "reflect.h2"
     [[nodiscard]] auto object_declaration::is_const() const& -> bool { return CPP2_UFCS(is_const)((*cpp2::impl::assert_not_null(n))); }
-#line 436 "reflect.h2"
+#line 450 "reflect.h2"
     [[nodiscard]] auto object_declaration::has_wildcard_type() const& -> bool { return CPP2_UFCS(has_wildcard_type)((*cpp2::impl::assert_not_null(n)));  }
 
-#line 438 "reflect.h2"
+#line 452 "reflect.h2"
     [[nodiscard]] auto object_declaration::type() const& -> std::string{
         auto ret {CPP2_UFCS(object_type)((*cpp2::impl::assert_not_null(n)))}; 
         require(!(contains(ret, "(*ERROR*)")), 
@@ -1243,7 +1419,7 @@ declaration::declaration(declaration const& that)
         return ret; 
     }
 
-#line 445 "reflect.h2"
+#line 459 "reflect.h2"
     [[nodiscard]] auto object_declaration::initializer() const& -> std::string{
         auto ret {CPP2_UFCS(object_initializer)((*cpp2::impl::assert_not_null(n)))}; 
         require(!(contains(ret, "(*ERROR*)")), 
@@ -1254,20 +1430,20 @@ declaration::declaration(declaration const& that)
     object_declaration::object_declaration(object_declaration const& that)
                                 : declaration{ static_cast<declaration const&>(that) }{}
 
-#line 461 "reflect.h2"
+#line 475 "reflect.h2"
     type_declaration::type_declaration(
 
         declaration_node* n_, 
         cpp2::impl::in<compiler_services> s
     )
         : declaration{ n_, s }
-#line 466 "reflect.h2"
+#line 480 "reflect.h2"
     {
 
         if (cpp2::cpp2_default.is_active() && !(CPP2_UFCS(is_type)((*cpp2::impl::assert_not_null(n)))) ) { cpp2::cpp2_default.report_violation(""); }
     }
 
-#line 471 "reflect.h2"
+#line 485 "reflect.h2"
     auto type_declaration::reserve_names(cpp2::impl::in<std::string_view> name, auto&& ...etc) const& -> void
     {                           // etc is not declared ':string_view' for compatibility with GCC 10.x
         for ( 
@@ -1280,14 +1456,14 @@ declaration::declaration(declaration const& that)
         }
     }
 
-#line 483 "reflect.h2"
+#line 497 "reflect.h2"
     [[nodiscard]] auto type_declaration::is_polymorphic() const& -> bool { return CPP2_UFCS(is_polymorphic)((*cpp2::impl::assert_not_null(n))); }
-#line 484 "reflect.h2"
+#line 498 "reflect.h2"
     [[nodiscard]] auto type_declaration::is_final() const& -> bool { return CPP2_UFCS(is_type_final)((*cpp2::impl::assert_not_null(n))); }
-#line 485 "reflect.h2"
+#line 499 "reflect.h2"
     [[nodiscard]] auto type_declaration::make_final() & -> bool { return CPP2_UFCS(make_type_final)((*cpp2::impl::assert_not_null(n))); }
 
-#line 487 "reflect.h2"
+#line 501 "reflect.h2"
     [[nodiscard]] auto type_declaration::get_member_functions() const& -> std::vector<function_declaration>
 
     {
@@ -1299,7 +1475,7 @@ declaration::declaration(declaration const& that)
         return ret; 
     }
 
-#line 498 "reflect.h2"
+#line 512 "reflect.h2"
     [[nodiscard]] auto type_declaration::get_member_functions_needing_initializer() const& -> std::vector<function_declaration>
 
     {
@@ -1315,7 +1491,7 @@ declaration::declaration(declaration const& that)
         return ret; 
     }
 
-#line 513 "reflect.h2"
+#line 527 "reflect.h2"
     [[nodiscard]] auto type_declaration::get_member_objects() const& -> std::vector<object_declaration>
 
     {
@@ -1326,7 +1502,7 @@ declaration::declaration(declaration const& that)
         return ret; 
     }
 
-#line 523 "reflect.h2"
+#line 537 "reflect.h2"
     [[nodiscard]] auto type_declaration::get_member_types() const& -> std::vector<type_declaration>
 
     {
@@ -1337,7 +1513,7 @@ declaration::declaration(declaration const& that)
         return ret; 
     }
 
-#line 533 "reflect.h2"
+#line 547 "reflect.h2"
     [[nodiscard]] auto type_declaration::get_member_aliases() const& -> std::vector<alias_declaration>
 
     {
@@ -1348,7 +1524,7 @@ declaration::declaration(declaration const& that)
         return ret; 
     }
 
-#line 543 "reflect.h2"
+#line 557 "reflect.h2"
     [[nodiscard]] auto type_declaration::get_members() const& -> std::vector<declaration>
 
     {
@@ -1359,16 +1535,16 @@ declaration::declaration(declaration const& that)
         return ret; 
     }
 
-#line 553 "reflect.h2"
+#line 567 "reflect.h2"
     [[nodiscard]] auto type_declaration::query_declared_value_set_functions() const& -> query_declared_value_set_functions_ret
 
-#line 560 "reflect.h2"
+#line 574 "reflect.h2"
     {
             cpp2::impl::deferred_init<bool> out_this_in_that;
             cpp2::impl::deferred_init<bool> out_this_move_that;
             cpp2::impl::deferred_init<bool> inout_this_in_that;
             cpp2::impl::deferred_init<bool> inout_this_move_that;
-#line 561 "reflect.h2"
+#line 575 "reflect.h2"
         auto declared {CPP2_UFCS(find_declared_value_set_functions)((*cpp2::impl::assert_not_null(n)))}; 
         out_this_in_that.construct(declared.out_this_in_that != nullptr);
         out_this_move_that.construct(declared.out_this_move_that != nullptr);
@@ -1376,7 +1552,7 @@ declaration::declaration(declaration const& that)
         inout_this_move_that.construct(cpp2::move(declared).inout_this_move_that != nullptr);
     return  { std::move(out_this_in_that.value()), std::move(out_this_move_that.value()), std::move(inout_this_in_that.value()), std::move(inout_this_move_that.value()) }; }
 
-#line 568 "reflect.h2"
+#line 582 "reflect.h2"
     auto type_declaration::add_member(cpp2::impl::in<std::string_view> source) & -> void
     {
         auto decl {parse_statement(source)}; 
@@ -1391,25 +1567,28 @@ declaration::declaration(declaration const& that)
                  std::string("unexpected error while attempting to add member:\n") + source);
     }
 
-#line 582 "reflect.h2"
+#line 596 "reflect.h2"
     auto type_declaration::remove_marked_members() & -> void { CPP2_UFCS(type_remove_marked_members)((*cpp2::impl::assert_not_null(n)));  }
-#line 583 "reflect.h2"
+#line 597 "reflect.h2"
     auto type_declaration::remove_all_members() & -> void { CPP2_UFCS(type_remove_all_members)((*cpp2::impl::assert_not_null(n))); }
 
-#line 585 "reflect.h2"
+#line 599 "reflect.h2"
     auto type_declaration::disable_member_function_generation() & -> void { CPP2_UFCS(type_disable_member_function_generation)((*cpp2::impl::assert_not_null(n)));  }
 
+#line 601 "reflect.h2"
+    auto type_declaration::define_out_of_line() & -> void { CPP2_UFCS(type_define_out_of_line)((*cpp2::impl::assert_not_null(n)));  }
+
     type_declaration::type_declaration(type_declaration const& that)
                                 : declaration{ static_cast<declaration const&>(that) }{}
 
-#line 596 "reflect.h2"
+#line 612 "reflect.h2"
     alias_declaration::alias_declaration(
 
         declaration_node* n_, 
         cpp2::impl::in<compiler_services> s
     )
         : declaration{ n_, s }
-#line 601 "reflect.h2"
+#line 617 "reflect.h2"
     {
 
         if (cpp2::cpp2_default.is_active() && !(CPP2_UFCS(is_alias)((*cpp2::impl::assert_not_null(n)))) ) { cpp2::cpp2_default.report_violation(""); }
@@ -1418,13 +1597,13 @@ declaration::declaration(declaration const& that)
     alias_declaration::alias_declaration(alias_declaration const& that)
                                 : declaration{ static_cast<declaration const&>(that) }{}
 
-#line 620 "reflect.h2"
+#line 636 "reflect.h2"
 auto add_virtual_destructor(meta::type_declaration& t) -> void
 {
     CPP2_UFCS(add_member)(t, "operator=: (virtual move this) = { }");
 }
 
-#line 638 "reflect.h2"
+#line 654 "reflect.h2"
 auto interface(meta::type_declaration& t) -> void
 {
     auto has_dtor {false}; 
@@ -1451,7 +1630,7 @@ auto interface(meta::type_declaration& t) -> void
     }
 }
 
-#line 684 "reflect.h2"
+#line 700 "reflect.h2"
 auto polymorphic_base(meta::type_declaration& t) -> void
 {
     auto has_dtor {false}; 
@@ -1476,13 +1655,79 @@ auto polymorphic_base(meta::type_declaration& t) -> void
     }
 }
 
-#line 729 "reflect.h2"
+#line 748 "reflect.h2"
+[[nodiscard]] auto unsigned_key_type_size(cpp2::impl::in<std::string_view> type) -> int
+{
+    auto name {type}; 
+    if (CPP2_UFCS(starts_with)(name, "const ")) {
+        CPP2_UFCS(remove_prefix)(name, 6);
+    }
+    if (CPP2_UFCS(starts_with)(name, "::")) {
+        CPP2_UFCS(remove_prefix)(name, 2);
+    }
+    if (CPP2_UFCS(starts_with)(name, "cpp2::")) {
+        CPP2_UFCS(remove_prefix)(name, 6);
+    }
+
+    std::vector<std::string_view> bytes {
+        "u8", "_uchar", "unsigned char", "std::uint8_t", "std::byte", "bool"}; 
+
+    if (CPP2_UFCS(starts_with)(name, "std::array<") && CPP2_UFCS(ends_with)(name, ">")) {
+        auto element {CPP2_UFCS(substr)(name, 11, CPP2_UFCS(size)(name) - 12)}; 
+        auto comma {CPP2_UFCS(rfind)(element, ',')}; 
+        if (comma == element.npos) {
+            return 0; 
+        }
+        auto count {CPP2_UFCS(substr)(element, comma + 1)}; 
+        while( CPP2_UFCS(starts_with)(count, " ") ) {
+            CPP2_UFCS(remove_prefix)(count, 1);
+        }
+        element = CPP2_UFCS(substr)(element, 0, cpp2::move(comma));
+        while( CPP2_UFCS(ends_with)(element, " ") ) {
+            CPP2_UFCS(remove_suffix)(element, 1);
+        }
+        if ( CPP2_UFCS(empty)(count) 
+            || !(is_empty_or_a_decimal_number(count)) 
+            || std::find(CPP2_UFCS(begin)(bytes), CPP2_UFCS(end)(bytes), element) == CPP2_UFCS(end)(bytes) 
+            || element == "bool") 
+        {
+            return 0; 
+        }
+        return std::atoi(CPP2_UFCS(data)(cpp2::move(count))); 
+    }
+
+    if (std::find(CPP2_UFCS(begin)(bytes), CPP2_UFCS(end)(bytes), name) != CPP2_UFCS(end)(bytes)) {
+        return 1; 
+    }
+    std::vector<std::string_view> twos {
+        "u16", "ushort", "unsigned short", "std::uint16_t"}; 
+
+    if (std::find(CPP2_UFCS(begin)(twos), CPP2_UFCS(end)(twos), name) != CPP2_UFCS(end)(twos)) {
+        return 2; 
+    }
+    std::vector<std::string_view> fours {
+        "u32", "uint", "unsigned", "unsigned int", "std::uint32_t"}; 
+
+    if (std::find(CPP2_UFCS(begin)(fours), CPP2_UFCS(end)(fours), name) != CPP2_UFCS(end)(fours)) {
+        return 4; 
+    }
+    std::vector<std::string_view> eights {
+        "u64", "ulonglong", "unsigned long long", "std::uint64_t", "std::size_t"}; 
+
+    if (std::find(CPP2_UFCS(begin)(eights), CPP2_UFCS(end)(eights), cpp2::move(name)) != CPP2_UFCS(end)(eights)) {
+        return 8; 
+    }
+    return 0; 
+}
+
+#line 812 "reflect.h2"
 auto ordered_impl(
     meta::type_declaration& t, 
     cpp2::impl::in<std::string_view> ordering
 ) -> void
 {
     auto has_spaceship {false}; 
+    auto has_equality {false}; 
 
     for ( auto& mf : CPP2_UFCS(get_member_functions)(t) ) 
     {
@@ -1494,32 +1739,117 @@ auto ordered_impl(
                 CPP2_UFCS(error)(mf, "operator<=> must return std::" + cpp2::impl::as_<std::string>(ordering));
             }
         }
+        has_equality |= CPP2_UFCS(has_name)(mf, "operator==");
     }
 
-    if (!(cpp2::move(has_spaceship))) {
-        CPP2_UFCS(add_member)(t, "operator<=>: (this, that) -> std::" + (cpp2::impl::as_<std::string>(ordering)) + ";");
+    //  @ordered<packed> (etc.) opts in to comparing packed keys, below
+    auto packed {false}; 
+    for ( auto const& arg : CPP2_UFCS(get_arguments)(t) ) {
+        if (arg == "packed") {
+            packed = true;
+        }
+        else {
+            CPP2_UFCS(error)(t, ("unknown argument '" + cpp2::to_string(arg) + "' for '" + cpp2::to_string(CPP2_UFCS(get_metafunction_name)(t)) + "' - the only argument it takes is 'packed'"));
+            return ; 
+        }
+    }
+
+    if (cpp2::move(has_spaceship)) {
+        return ; 
+    }
+
+    //  When the data members are all unsigned integers or arrays of bytes,
+    //  comparing them in order is the same as comparing one big-endian
+    //  key, a word at a time instead of a member at a time -- which can
+    //  pay off when several members share a word, and the key is a word
+    //  or two, but it's slower than a defaulted <=> for some uses (e.g.,
+    //  std::map lookups), so only with 'packed'; == just compares the
+    //  objects' bytes when they have no padding, which is never slower
+    std::string this_members {}; 
+    std::string that_members {}; 
+    auto is_key {true}; 
+    auto member_count {0}; 
+    auto words {1}; 
+    auto word_bytes {0}; 
+    for ( auto const& m : CPP2_UFCS(get_members)(t) ) {
+        if (CPP2_UFCS(is_base_object)(m)) {
+            is_key = false;
+        }
+        else {if (CPP2_UFCS(is_member_object)(m)) {
+            auto mo {CPP2_UFCS(as_object)(m)}; 
+            std::string name {CPP2_UFCS(name)(mo)}; 
+            auto size {0}; 
+            if (!(CPP2_UFCS(has_wildcard_type)(mo))) {
+                size = unsigned_key_type_size(CPP2_UFCS(type)(cpp2::move(mo)));
+            }
+            is_key = is_key && cpp2::impl::cmp_greater(size,0);
+
+            //  Parts of up to 8 bytes, each in the next word if it
+            //  doesn't fit in the rest of this one, as key_compare packs
+            //  them
+            while( cpp2::impl::cmp_greater(size,0) ) {
+                auto part {std::min(size, 8)}; 
+                if (cpp2::impl::cmp_greater(word_bytes + part,8)) {
+                    ++words;
+                    word_bytes = 0;
+                }
+                word_bytes += part;
+                size -= cpp2::move(part);
+            }
+            if (!(CPP2_UFCS(empty)(this_members))) {
+                this_members += ", ";
+                that_members += ", ";
+            }
+            this_members += name;
+            that_members += "that." + cpp2::move(name);
+            ++member_count;
+        }}
+    }
+
+    if ( !(cpp2::move(is_key)) 
+        || cpp2::impl::cmp_less_eq(cpp2::move(member_count),words) 
+        || cpp2::impl::cmp_greater(words,2)) 
+    {
+        CPP2_UFCS(add_member)(t, "operator<=>: (this, that) -> std::" + (cpp2::impl::as_<std::string>(ordering)) + ";");
+        return ; 
+    }
+
+    if (packed) {
+        CPP2_UFCS(add_member)(t, ("operator<=>: (this, that) -> std::" + cpp2::to_string(ordering) + " = cpp2::key_compare(std::tie(" + cpp2::to_string(this_members) + "), std::tie(" + cpp2::to_string(that_members) + "));"));
+    }
+    else {
+        CPP2_UFCS(add_member)(t, "operator<=>: (this, that) -> std::" + (cpp2::impl::as_<std::string>(ordering)) + ";");
+    }
+
+    //  The defaulted <=> would also have declared ==
+    if (!(cpp2::move(has_equality))) {
+        std::string equal {"key_equal"}; 
+        if (cpp2::move(packed)) {
+            equal = "packed_key_equal";
+        }
+        CPP2_UFCS(add_member)(t, ("operator==: (this, that) -> bool = cpp2::" + cpp2::to_string(cpp2::move(equal)) + "(this, that, std::tie(" + cpp2::to_string(cpp2::move(this_members)) + "), std::tie(" + cpp2::to_string(cpp2::move(that_members)) + "));"));
     }
 }
 
-#line 758 "reflect.h2"
+#line 927 "reflect.h2"
 auto ordered(meta::type_declaration& t) -> void
 {
     ordered_impl(t, "strong_ordering");
 }
 
-#line 766 "reflect.h2"
+#line 935 "reflect.h2"
 auto weakly_ordered(meta::type_declaration& t) -> void
 {
     ordered_impl(t, "weak_ordering");
 }
 
-#line 774 "reflect.h2"
+#line 943 "reflect.h2"
 auto partially_ordered(meta::type_declaration& t) -> void
 {
     ordered_impl(t, "partial_ordering");
 }
 
-#line 796 "reflect.h2"
+#line 965 "reflect.h2"
 auto copyable(meta::type_declaration& t) -> void
 {
     //  If the user explicitly wrote any of the copy/move functions,
@@ -1541,7 +1871,7 @@ auto copyable(meta::type_declaration& t) -> void
     }}
 }
 
-#line 824 "reflect.h2"
+#line 993 "reflect.h2"
 auto basic_value(meta::type_declaration& t) -> void
 {
     CPP2_UFCS(copyable)(t);
@@ -1560,28 +1890,28 @@ auto basic_value(meta::type_declaration& t) -> void
     }
 }
 
-#line 852 "reflect.h2"
+#line 1021 "reflect.h2"
 auto value(meta::type_declaration& t) -> void
 {
     CPP2_UFCS(ordered)(t);
     CPP2_UFCS(basic_value)(t);
 }
 
-#line 858 "reflect.h2"
+#line 1027 "reflect.h2"
 auto weakly_ordered_value(meta::type_declaration& t) -> void
 {
     CPP2_UFCS(weakly_ordered)(t);
     CPP2_UFCS(basic_value)(t);
 }
 
-#line 864 "reflect.h2"
+#line 1033 "reflect.h2"
 auto partially_ordered_value(meta::type_declaration& t) -> void
 {
     CPP2_UFCS(partially_ordered)(t);
     CPP2_UFCS(basic_value)(t);
 }
 
-#line 893 "reflect.h2"
+#line 1062 "reflect.h2"
 auto cpp1_rule_of_zero(meta::type_declaration& t) -> void
 {
     for ( auto& mf : CPP2_UFCS(get_member_functions)(t) ) 
@@ -1594,7 +1924,7 @@ auto cpp1_rule_of_zero(meta::type_declaration& t) -> void
     CPP2_UFCS(disable_member_function_generation)(t);
 }
 
-#line 930 "reflect.h2"
+#line 1099 "reflect.h2"
 auto cpp2_struct(meta::type_declaration& t) -> void
 {
     for ( auto& m : CPP2_UFCS(get_members)(t) ) 
@@ -1612,7 +1942,741 @@ auto cpp2_struct(meta::type_declaration& t) -> void
     CPP2_UFCS(cpp1_rule_of_zero)(t);
 }
 
-#line 971 "reflect.h2"
+#line 1129 "reflect.h2"
+auto trivially_relocatable(meta::type_declaration& t) -> void
+{
+    //  Standard types that point into their own objects on at least one
+    //  major implementation (e.g., the SSO buffer, or a node container's
+    //  sentinel), so we can diagnose those here instead of later
+    std::vector<std::string_view> not_relocatable {
+        "std::string", "std::wstring", "std::u8string", "std::u16string", "std::u32string", 
+        "std::basic_string", "std::list", "std::map", "std::multimap", "std::set", "std::multiset", 
+        "std::unordered_map", "std::unordered_multimap", "std::unordered_set", "std::unordered_multiset", 
+        "std::function", "std::any"}; 
+
+#line 1141 "reflect.h2"
+    std::string member_types {}; 
+    for ( auto& mo : CPP2_UFCS(get_member_objects)(t) ) 
+    {
+        std::string what {"data member '" + cpp2::to_string(CPP2_UFCS(name)(mo)) + "'"}; 
+        if (CPP2_UFCS(name)(mo) == "this") {
+            what = "base class";
+        }
+
+        if (CPP2_UFCS(has_wildcard_type)(mo)) {
+            CPP2_UFCS(error)(mo, ("a trivially relocatable type's " + cpp2::to_string(what) + " must have an explicit type"));
+            return ; 
+        }
+
+        auto type {mo.type()}; 
+        std::string_view type_name {type}; 
+        if (CPP2_UFCS(starts_with)(type_name, "::")) {
+            CPP2_UFCS(remove_prefix)(type_name, 2);
+        }
+        for ( auto const& std_type : not_relocatable ) {
+            if ( CPP2_UFCS(starts_with)(type_name, std_type) 
+                && (
+                    CPP2_UFCS(ssize)(type_name) == CPP2_UFCS(ssize)(std_type) 
+                    || CPP2_ASSERT_IN_BOUNDS(type_name, CPP2_UFCS(ssize)(std_type)) == '<')) 
+
+            {
+                CPP2_UFCS(error)(mo, ("a trivially relocatable type's " + cpp2::to_string(what) + " cannot have type " + cpp2::to_string(type) + ", because its objects may point into themselves"));
+                return ; 
+            }
+        }
+
+        member_types += ", " + cpp2::move(type);
+    }
+
+    //  The rest (including other types' @trivially_relocatable) are
+    //  checked by the static_assert in cpp2::trivially_relocatable_tag
+    CPP2_UFCS(add_member)(t, ("    _trivially_relocatable: type == cpp2::trivially_relocatable_tag<" + cpp2::to_string(CPP2_UFCS(name)(t)) + cpp2::to_string(cpp2::move(member_types)) + ">;"));
+}
+
+#line 1188 "reflect.h2"
+auto slot_map(meta::type_declaration& t) -> void
+{
+    CPP2_UFCS(reserve_names)(t, "slots", "handle");
+
+    //  Erasing moves the last element into the hole, so if the user
+    //  didn't write a move or copy, generate the memberwise move (and
+    //  keep the default constructor a type with no constructors has)
+    auto smfs {CPP2_UFCS(query_declared_value_set_functions)(t)}; 
+    if ( !(smfs.out_this_in_that) 
+        && !(smfs.out_this_move_that)) 
+    {
+        CPP2_UFCS(require)(t, !(smfs.inout_this_in_that) && !(smfs.inout_this_move_that), 
+                   "a slot_map type must be movable - when you provide an assignment operator=, you must also provide operator=: (out this, move that) or (out this, that)");
+
+        auto has_ctor {false}; 
+        for ( auto const& mf : CPP2_UFCS(get_member_functions)(t) ) {
+            has_ctor |= CPP2_UFCS(is_constructor)(mf);
+        }
+        if (!(cpp2::move(has_ctor))) {
+            CPP2_UFCS(add_member)(t, "operator=: (out this) = { }");
+        }
+        CPP2_UFCS(add_member)(t, "operator=: (out this, move that) = { }");
+    }
+
+    CPP2_UFCS(add_member)(t, ("    public slots : type == cpp2::slot_map<" + cpp2::to_string(CPP2_UFCS(name)(t)) + ">;"));
+    CPP2_UFCS(add_member)(t, ("    public handle: type == cpp2::slot_handle<" + cpp2::to_string(CPP2_UFCS(name)(t)) + ">;"));
+}
+
+#line 1240 "reflect.h2"
+auto bitpacked(meta::type_declaration& t) -> void
+{
+    std::vector<bitpacked_member_info> members {}; 
+
+    //  1. Gather: The widths of all the user-written data members
+
+    for ( 
+         auto const& m : CPP2_UFCS(get_members)(t) ) 
+    if ( CPP2_UFCS(is_member_object)(m)) 
+    {
+        auto mo {CPP2_UFCS(as_object)(m)}; 
+        CPP2_UFCS(require)(m, !(CPP2_UFCS(starts_with)(CPP2_UFCS(name)(m), "set_")), 
+                   "a bitpacked member's name cannot start with 'set_' - that could cause user confusion with the 'set_member' generated functions");
+
+        if (CPP2_UFCS(has_wildcard_type)(mo) || CPP2_UFCS(name)(mo) == "this") {
+            CPP2_UFCS(error)(mo, "a bitpacked type's members must each have type bool, cpp2::bits<N>, or cpp2::signed_bits<N>");
+            return ; 
+        }
+
+        auto type {mo.type()}; 
+        auto width {0}; 
+        auto is_signed {false}; 
+        if (type == "bool") {
+            width = 1;
+        }
+        else {
+            std::string_view type_name {type}; 
+            if (CPP2_UFCS(starts_with)(type_name, "::")) {
+                CPP2_UFCS(remove_prefix)(type_name, 2);
+            }
+            if (CPP2_UFCS(starts_with)(type_name, "cpp2::signed_bits<")) {
+                is_signed = true;
+                CPP2_UFCS(remove_prefix)(type_name, 18);
+            }
+            else {if (CPP2_UFCS(starts_with)(type_name, "cpp2::bits<")) {
+                CPP2_UFCS(remove_prefix)(type_name, 11);
+            }}
+            if ( CPP2_UFCS(ends_with)(type_name, ">") 
+                && is_empty_or_a_decimal_number(CPP2_UFCS(substr)(type_name, 0, CPP2_UFCS(size)(type_name) - 1))) 
+            {
+                width = std::atoi(CPP2_UFCS(data)(cpp2::move(type_name)));
+            }
+            if (cpp2::impl::cmp_less(width,1) || cpp2::impl::cmp_less(64,width)) {
+                CPP2_UFCS(error)(mo, ("a bitpacked type's members must each have type bool, cpp2::bits<N>, or cpp2::signed_bits<N>, where N is a literal from 1 to 64 - '" + cpp2::to_string(CPP2_UFCS(name)(mo)) + "' has type " + cpp2::to_string(type)));
+                return ; 
+            }
+        }
+
+        bitpacked_member_info e {cpp2::impl::as_<std::string>(CPP2_UFCS(name)(mo)), cpp2::move(type), cpp2::move(width), cpp2::move(is_signed), 0, 0, CPP2_UFCS(initializer)(mo)}; 
+        CPP2_UFCS(push_back)(members, cpp2::move(e));
+
+        CPP2_UFCS(mark_for_removal_from_enclosing_type)(mo);
+        static_cast<void>(cpp2::move(mo));
+    }
+
+    if (CPP2_UFCS(empty)(members)) {
+        CPP2_UFCS(error)(t, "a bitpacked type must have at least one data member");
+        return ; 
+    }
+
+    //  Lay out the members from the most significant bit down, starting
+    //  a new 64-bit word when a member doesn't fit in the current one
+    auto total_bits {0}; 
+    auto words {1}; 
+    for ( auto& e : members ) {
+        if ((cpp2::impl::cmp_greater(total_bits + e.width,64))) {
+            ++words;
+            total_bits = 0;
+        }
+        e.word = words - 1;
+        total_bits += e.width;
+        e.shift = 64 - total_bits;
+    }
+
+    //  A single word can be smaller, then the shifts are relative to that
+    std::string word_type {"u64"}; 
+    auto word_bits {64}; 
+    if (words == 1) {
+        if (cpp2::impl::cmp_less_eq(total_bits,8)) {
+            word_type = "u8";
+            word_bits = 8;
+        }
+        else {if (cpp2::impl::cmp_less_eq(total_bits,16)) {
+            word_type = "u16";
+            word_bits = 16;
+        }
+        else {if (cpp2::impl::cmp_less_eq(cpp2::move(total_bits),32)) {
+            word_type = "u32";
+            word_bits = 32;
+        }}}
+        for ( auto& e : members ) {
+            e.shift -= 64 - word_bits;
+        }
+    }
+
+    //  The zero value of each member: signed members store 2^(N-1)
+    std::vector<cpp2::u64> zero {}; 
+    CPP2_UFCS(resize)(zero, cpp2::unsafe_narrow<std::size_t>(words));
+    for ( auto const& e : members ) {
+        if (e.is_signed) {
+            CPP2_ASSERT_IN_BOUNDS(zero, e.word) |= (cpp2::impl::as_<cpp2::u64, 1>()) << (e.shift + e.width - 1);
+        }
+    }
+
+#line 1345 "reflect.h2"
+    //  2. Replace: Erase the contents and replace with modified contents
+
+    CPP2_UFCS(remove_marked_members)(t);
+
+    if (words == 1) {
+        CPP2_UFCS(add_member)(t, ("    _bits: " + cpp2::to_string(word_type) + " = " + cpp2::to_string(CPP2_ASSERT_IN_BOUNDS_LITERAL(cpp2::move(zero), 0)) + "u;"));
+    }
+    else {
+        std::string storage {"    _bits: std::array<u64, " + cpp2::to_string(words) + "> = ("}; 
+        for ( auto const& z : cpp2::move(zero) ) {
+            storage += (" " + cpp2::to_string(z) + "u,");
+        }
+        CPP2_UFCS(back)(storage) = ' ';
+        storage += ");";
+        CPP2_UFCS(add_member)(t, cpp2::move(storage));
+    }
+
+    for ( 
+         auto const& e : members ) 
+    {
+        std::string bits {"_bits"}; 
+        if (cpp2::impl::cmp_greater(words,1)) {
+            bits = { "std::get<" + cpp2::to_string(e.word) + ">(_bits)" };
+        }
+        auto mask_value {std::numeric_limits<cpp2::u64>::max() >> (64 - e.width)}; 
+        auto mask {std::to_string(mask_value) + "u"}; 
+        auto clear {std::to_string(std::numeric_limits<cpp2::u64>::max() ^ (cpp2::move(mask_value) << e.shift)) + "u"}; 
+        auto field {"((" + cpp2::to_string(bits) + " as u64 >> " + cpp2::to_string(e.shift) + "u) & " + cpp2::to_string(mask) + ")"}; 
+
+        if (e.type == "bool") {
+            CPP2_UFCS(add_member)(t, ("    " + cpp2::to_string(e.name) + ": (this) -> bool == " + cpp2::to_string(cpp2::move(field)) + " != 0u;"));
+        }
+        else {if (e.is_signed) {
+            auto sign {std::to_string((cpp2::impl::as_<cpp2::u64, 1>()) << (e.width - 1)) + "u"}; 
+            CPP2_UFCS(add_member)(t, ("    " + cpp2::to_string(e.name) + ": (this) -> " + cpp2::to_string(e.type) + " == cpp2::unsafe_narrow<" + cpp2::to_string(e.type) + ">( cpp2::unsafe_narrow<i64>( " + cpp2::to_string(cpp2::move(field)) + " - " + cpp2::to_string(cpp2::move(sign)) + " ) );"));
+        }
+        else {
+            CPP2_UFCS(add_member)(t, ("    " + cpp2::to_string(e.name) + ": (this) -> " + cpp2::to_string(e.type) + " == cpp2::unsafe_narrow<" + cpp2::to_string(e.type) + ">( " + cpp2::to_string(cpp2::move(field)) + " );"));
+        }}
+
+        //  Check the range unless the member is a bool or uses all of its
+        //  type's bits (a cpp2::bits<1> is a u8, so it's checked)
+        std::string check {""}; 
+        if (e.type != "bool" && e.width != 8 && e.width != 16 && e.width != 32 && e.width != 64) {
+            if (e.is_signed) {
+                auto limit {(cpp2::impl::as_<cpp2::i64, 1>()) << (e.width - 1)}; 
+                check = { " pre<cpp2::type_safety>( " + cpp2::to_string(-limit) + " <= value && value <= " + cpp2::to_string(limit - 1) + ", \"value is out of range for the " + cpp2::to_string(e.width) + "-bit signed member '" + cpp2::to_string(e.name) + "'\" )" };
+            }
+            else {
+                check = { " pre<cpp2::type_safety>( value <= " + cpp2::to_string(mask) + ", \"value is out of range for the " + cpp2::to_string(e.width) + "-bit member '" + cpp2::to_string(e.name) + "'\" )" };
+            }
+        }
+
+        std::string encoded {"((value as u64) & " + cpp2::to_string(mask) + ")"}; 
+        if (e.type == "bool") {
+            encoded = "cpp2::unsafe_narrow<u64>(value)";
+        }
+        else {if (e.is_signed) {
+            encoded = { "((cpp2::unsafe_narrow<u64>(value) + " + cpp2::to_string(std::to_string((cpp2::impl::as_<cpp2::u64, 1>()) << (e.width - 1))) + "u) & " + cpp2::to_string(cpp2::move(mask)) + ")" };
+        }}
+        CPP2_UFCS(add_member)(t, ("    set_" + cpp2::to_string(e.name) + ": (inout this, value: " + cpp2::to_string(e.type) + ")" + cpp2::to_string(cpp2::move(check)) + " == { " + cpp2::to_string(bits) + " = cpp2::unsafe_narrow<" + cpp2::to_string(word_type) + ">( (" + cpp2::to_string(bits) + " as u64 & " + cpp2::to_string(cpp2::move(clear)) + ") | (" + cpp2::to_string(cpp2::move(encoded)) + " << " + cpp2::to_string(e.shift) + "u) ); }"));
+    }
+
+    //  Members that have initializers are set by the default constructor
+    auto has_default_ctor {false}; 
+    for ( auto const& mf : CPP2_UFCS(get_member_functions)(t) ) {
+        has_default_ctor |= CPP2_UFCS(is_default_constructor)(mf);
+    }
+    std::string initializers {""}; 
+    for ( auto const& e : cpp2::move(members) ) {
+        if (!(CPP2_UFCS(empty)(e.initializer))) {
+            initializers += (" set_" + cpp2::to_string(e.name) + "( " + cpp2::to_string(e.initializer) + " );");
+        }
+    }
+    if (!(cpp2::move(has_default_ctor))) {
+        CPP2_UFCS(add_member)(t, ("    operator=: (out this) = {" + cpp2::to_string(cpp2::move(initializers)) + " }"));
+    }
+    else {if (!(CPP2_UFCS(empty)(cpp2::move(initializers)))) {
+        CPP2_UFCS(error)(t, "a bitpacked type with a user-written default constructor cannot have member initializers - set the members in the constructor instead");
+    }}
+    CPP2_UFCS(copyable)(t);
+
+    //  Comparing the storage compares the members in order
+    auto has_comparison {false}; 
+    for ( auto const& mf : CPP2_UFCS(get_member_functions)(t) ) {
+        has_comparison |= CPP2_UFCS(has_name)(mf, "operator<=>") || CPP2_UFCS(has_name)(mf, "operator==");
+    }
+    if (!(cpp2::move(has_comparison))) {
+        CPP2_UFCS(add_member)(t, "    operator<=>: (this, that) -> std::strong_ordering = _bits <=> that._bits;");
+        CPP2_UFCS(add_member)(t, "    operator== : (this, that) -> bool                 = _bits ==  that._bits;");
+    }
+}
+
+#line 1448 "reflect.h2"
+auto simd_vector(meta::type_declaration& t) -> void
+{
+    CPP2_UFCS(reserve_names)(t, "value_type", "batch", "dot", "min", "max", "abs");
+
+    std::vector<std::string> names {}; 
+    std::string value_type {}; 
+    for ( auto& mo : CPP2_UFCS(get_member_objects)(t) ) 
+    {
+        if (CPP2_UFCS(name)(mo) == "this") {
+            CPP2_UFCS(error)(mo, "a simd_vector type cannot have a base class");
+            return ; 
+        }
+        if (CPP2_UFCS(has_wildcard_type)(mo)) {
+            CPP2_UFCS(error)(mo, "a simd_vector type's data members must have an explicit type");
+            return ; 
+        }
+        if (CPP2_UFCS(empty)(value_type)) {
+            value_type = CPP2_UFCS(type)(mo);
+        }
+        else {if (CPP2_UFCS(type)(mo) != value_type) {
+            CPP2_UFCS(error)(mo, ("a simd_vector type's data members must all have the same type - '" + cpp2::to_string(CPP2_UFCS(name)(mo)) + "' has type " + cpp2::to_string(CPP2_UFCS(type)(mo)) + ", but the first data member has type " + cpp2::to_string(value_type)));
+            return ; 
+        }}
+        CPP2_UFCS(push_back)(names, cpp2::impl::as_<std::string>(CPP2_UFCS(name)(mo)));
+    }
+
+    if (CPP2_UFCS(empty)(names)) {
+        CPP2_UFCS(error)(t, "a simd_vector type must have at least one data member");
+        return ; 
+    }
+
+    auto type {CPP2_UFCS(name)(t)}; 
+
+    //  Applies 'stmt' to each member, with '@' replaced by its name
+    auto each {[_0 = names](cpp2::impl::in<std::string_view> stmt) mutable -> std::string{
+        std::string ret {}; 
+        for ( auto const& name : _0 ) {
+            ret += "\n            ";
+            for ( auto const& c : stmt ) {
+                if (c == '@') {ret += name; }
+                else        { ret += c; }
+            }
+        }
+        return ret; 
+    }}; 
+
+    CPP2_UFCS(add_member)(t, ("    public value_type: type == cpp2::simd_element<" + cpp2::to_string(cpp2::move(value_type)) + ">;"));
+
+    std::vector<std::string> arithmetic_ops {"+", "-", "*", "/"}; 
+    std::vector<std::string> scaling_ops {"*", "/"}; 
+
+    //  Elementwise and scalar arithmetic
+    for ( auto const& op : arithmetic_ops ) {
+        auto body {each("@ " + op + "= that.@;")}; 
+        CPP2_UFCS(add_member)(t, ("    operator" + cpp2::to_string(op) + "=: (inout this, that) = {" + cpp2::to_string(cpp2::move(body)) + " }"));
+        CPP2_UFCS(add_member)(t, ("    operator" + cpp2::to_string(op) + ": (this, that) -> " + cpp2::to_string(type) + " = { ret: " + cpp2::to_string(type) + " = this; ret " + cpp2::to_string(op) + "= that; return ret; }"));
+    }
+    for ( auto const& op : scaling_ops ) {
+        auto body {each("@ " + op + "= s;")}; 
+        CPP2_UFCS(add_member)(t, ("    operator" + cpp2::to_string(op) + "=: (inout this, s: value_type) = {" + cpp2::to_string(cpp2::move(body)) + " }"));
+        CPP2_UFCS(add_member)(t, ("    operator" + cpp2::to_string(op) + ": (this, s: value_type) -> " + cpp2::to_string(type) + " = { ret: " + cpp2::to_string(type) + " = this; ret " + cpp2::to_string(op) + "= s; return ret; }"));
+    }
+    auto negate {each("ret.@ = -@;")}; 
+    CPP2_UFCS(add_member)(t, ("    operator-: (this) -> " + cpp2::to_string(type) + " = { ret: " + cpp2::to_string(type) + " = this;" + cpp2::to_string(cpp2::move(negate)) + " return ret; }"));
+
+    //  dot, min, max, abs
+    std::string dot {"    dot: (this, that) -> value_type = value_type()"}; 
+    for ( auto const& name : names ) {
+        dot += (" + " + cpp2::to_string(name) + " * that." + cpp2::to_string(name));
+    }
+    CPP2_UFCS(add_member)(t, cpp2::move(dot) + ";");
+    auto min {each("ret.@ = std::min(@, that.@);")}; 
+    auto max {each("ret.@ = std::max(@, that.@);")}; 
+    CPP2_UFCS(add_member)(t, ("    min: (this, that) -> " + cpp2::to_string(type) + " = { ret: " + cpp2::to_string(type) + " = this;" + cpp2::to_string(cpp2::move(min)) + " return ret; }"));
+    CPP2_UFCS(add_member)(t, ("    max: (this, that) -> " + cpp2::to_string(type) + " = { ret: " + cpp2::to_string(type) + " = this;" + cpp2::to_string(cpp2::move(max)) + " return ret; }"));
+    auto abs {each("ret.@ = cpp2::abs_value(@);")}; 
+    CPP2_UFCS(add_member)(t, ("    abs: (this) -> " + cpp2::to_string(type) + " = { ret: " + cpp2::to_string(type) + " = this;" + cpp2::to_string(cpp2::move(abs)) + " return ret; }"));
+
+    //  The structure-of-arrays form: one array per data member
+    auto first {CPP2_UFCS(front)(cpp2::move(names))}; 
+    std::string batch {"    batch: type = {\n"}; 
+    batch += each("public @: std::vector<value_type> = ();");
+    batch += ("\n        size : (this) -> std::size_t    = " + cpp2::to_string(first) + ".size();");
+    batch += ("\n        ssize: (this) -> std::ptrdiff_t = std::ssize(" + cpp2::to_string(cpp2::move(first)) + ");");
+    batch += "\n        resize : (inout this, n: std::size_t) = {" + each("@.resize(n);") + " }";
+    batch += "\n        reserve: (inout this, n: std::size_t) = {" + each("@.reserve(n);") + " }";
+    batch += ("\n        push_back: (inout this, v: " + cpp2::to_string(type) + ") = {") + each("@.push_back(v.@);") + " }";
+    batch += ("\n        get: (this, i: std::ptrdiff_t) -> " + cpp2::to_string(type) + " = { ret: " + cpp2::to_string(type) + " = ();") + each("ret.@ = @[i];") + " return ret; }";
+    batch += ("\n        set: (inout this, i: std::ptrdiff_t, v: " + cpp2::to_string(cpp2::move(type)) + ") = {") + each("@[i] = v.@;") + " }";
+    std::map<std::string,std::string> functors {
+        std::pair("+", "std::plus()"), std::pair("-", "std::minus()"), 
+        std::pair("*", "std::multiplies()"), std::pair("/", "std::divides()")}; 
+
+    for ( auto const& op : cpp2::move(arithmetic_ops) ) {
+        batch += ("\n        operator" + cpp2::to_string(op) + "=: (inout this, that) pre<bounds_safety>( that.size() == size() ) = {");
+        batch += each("cpp2::elementwise( @.size(), " + CPP2_ASSERT_IN_BOUNDS(functors, op) + ", @.data(), @.data(), that.@.data() );");
+        batch += " }";
+    }
+    for ( auto const& op : cpp2::move(scaling_ops) ) {
+        batch += ("\n        operator" + cpp2::to_string(op) + "=: (inout this, s: value_type) = {");
+        batch += each("cpp2::elementwise( @.size(), " + CPP2_ASSERT_IN_BOUNDS(functors, op) + ", @.data(), @.data(), s );");
+        batch += " }";
+    }
+    batch += "\n        add_scaled: (inout this, other: batch, s: value_type) pre<bounds_safety>( other.size() == size() ) = {";
+    batch += cpp2::move(each)("cpp2::elementwise( @.size(), cpp2::multiply_add, @.data(), @.data(), other.@.data(), s );");
+    batch += " }";
+    batch += "\n    }";
+    CPP2_UFCS(add_member)(t, cpp2::move(batch));
+}
+
+#line 1573 "reflect.h2"
+[[nodiscard]] auto forwarding_call_for(
+    cpp2::impl::in<meta::function_declaration> mf, 
+    cpp2::impl::in<std::string> that_arg
+    ) -> forwarding_call
+
+{
+    std::string signature {}; 
+    auto indentation {true}; 
+    for ( auto const& c : CPP2_UFCS(print_signature)(mf) ) {
+        if (c == '\n') {
+            if (!(CPP2_UFCS(empty)(signature)) && !(CPP2_UFCS(ends_with)(signature, " "))) {
+                signature += " ";
+            }
+            indentation = true;
+        }
+        else {if (c != ' ' || !(indentation)) {
+            signature += c;
+            indentation = false;
+        }}
+    }
+    if (CPP2_UFCS(ends_with)(signature, ";")) {
+        CPP2_UFCS(pop_back)(signature);
+    }
+
+    std::string args {}; 
+    bool is_generic {CPP2_UFCS(has_template_parameters)(mf)}; 
+    for ( auto const& param : CPP2_UFCS(get_parameters)(mf) ) {
+        std::string name {CPP2_UFCS(name)(param)}; 
+        if (name == "this") {
+            continue;
+        }
+        if (!(CPP2_UFCS(empty)(args))) {
+            args += ", ";
+        }
+        if (name == "that") {
+            args += that_arg;
+            continue;
+        }
+        is_generic |= CPP2_UFCS(has_wildcard_type)(param);
+        if (CPP2_UFCS(has_parameter_with_name_and_pass)(mf, name, passing_style::out)) {
+            args += "out " + cpp2::move(name);
+        }
+        else {if (CPP2_UFCS(has_parameter_with_name_and_pass)(mf, name, passing_style::move)) {
+            args += "move " + cpp2::move(name);
+        }
+        else {
+            args += cpp2::move(name);
+        }}
+    }
+
+    return { cpp2::move(signature), cpp2::move(args), cpp2::move(is_generic) }; 
+}
+
+#line 1642 "reflect.h2"
+auto pimpl(meta::type_declaration& t) -> void
+{
+    CPP2_UFCS(reserve_names)(t, "_impl", "_pimpl");
+
+    if (CPP2_UFCS(has_template_parameters)(t)) {
+        CPP2_UFCS(error)(t, "a pimpl type cannot be a template, because its implementation would have to be visible wherever the template is used");
+        return ; 
+    }
+
+    CPP2_UFCS(add_member)(t, "    private _impl: type = { }");
+    auto impl {CPP2_UFCS(back)(CPP2_UFCS(get_member_types)(t))}; 
+    CPP2_UFCS(define_out_of_line)(impl);
+
+    auto has_ctor {false}; 
+    for ( 
+         auto& m : CPP2_UFCS(get_members)(t) ) 
+    {
+        if (CPP2_UFCS(is_base_object)(m)) {
+            CPP2_UFCS(error)(m, "a pimpl type cannot have a base class");
+            return ; 
+        }
+
+        if (CPP2_UFCS(is_member_object)(m)) 
+        {
+            CPP2_UFCS(require)(m, CPP2_UFCS(is_private)(m) || CPP2_UFCS(is_default_access)(m), 
+                       "a pimpl type's data members must be private");
+            CPP2_UFCS(move_to_type)(m, impl);
+            continue;
+        }
+
+        if (!(CPP2_UFCS(is_function)(m))) {
+            continue;
+        }
+        auto mf {CPP2_UFCS(as_function)(m)}; 
+        if (CPP2_UFCS(is_virtual)(mf)) {
+            CPP2_UFCS(error)(m, "a pimpl type cannot have a virtual function");
+            return ; 
+        }
+        if (!(CPP2_UFCS(is_function_with_this)(mf))) {
+            continue;
+        }
+        if (CPP2_UFCS(is_protected)(m)) {
+            CPP2_UFCS(error)(m, "a pimpl type cannot have a protected function - make it public or private");
+            return ; 
+        }
+
+        //  The destructor and private functions are used only by the
+        //  implementation, so they move without leaving anything behind
+        if ( CPP2_UFCS(is_destructor)(mf) 
+            || (CPP2_UFCS(is_private)(m) && !(CPP2_UFCS(has_name)(m, "operator=")))) 
+        {
+            CPP2_UFCS(move_to_type)(m, impl);
+            continue;
+        }
+
+        auto call {forwarding_call_for(mf, "that._pimpl*")}; 
+
+        //  Constructors and assignments make a new implementation object,
+        //  or take the other one's
+        if (CPP2_UFCS(has_name)(m, "operator=")) 
+        {
+            CPP2_UFCS(require)(m, !(CPP2_UFCS(is_private)(m)), 
+                       "a pimpl type's constructors and assignment operators must be public");
+            has_ctor |= CPP2_UFCS(is_constructor)(mf);
+            if (CPP2_UFCS(has_parameter_with_name_and_pass)(cpp2::move(mf), "that", passing_style::move)) {
+                CPP2_UFCS(add_member)(t, ("    " + cpp2::to_string(cpp2::move(call).signature) + " = { _pimpl = that._pimpl; }"));
+            }
+            else {
+                CPP2_UFCS(add_member)(t, ("    " + cpp2::to_string(call.signature) + " = { _pimpl = unique.new<_impl>(" + cpp2::to_string(call.args) + "); }"));
+            }
+        }
+
+        //  Other functions forward to the implementation, so their
+        //  signatures can't depend on its definition
+        else 
+        {
+            std::string name {CPP2_UFCS(name)(m)}; 
+            std::string what {"function '" + name + "'"}; 
+            if (call.is_generic) {
+                CPP2_UFCS(error)(m, ("a pimpl type's public " + cpp2::to_string(what) + " cannot be a template, because its definition would have to be visible wherever it is used"));
+                return ; 
+            }
+            if ( CPP2_UFCS(has_declared_return_type)(mf) 
+                && (CPP2_UFCS(has_deduced_return_type)(mf) || CPP2_UFCS(empty)(CPP2_UFCS(unnamed_return_type)(mf)))) 
+            {
+                CPP2_UFCS(error)(m, ("a pimpl type's public " + cpp2::to_string(what) + " must declare a single return type"));
+                return ; 
+            }
+            if ( CPP2_UFCS(has_move_parameter_named)(mf, "this") 
+                || CPP2_UFCS(has_move_parameter_named)(mf, "that")) 
+            {
+                CPP2_UFCS(error)(m, ("a pimpl type's public " + cpp2::to_string(cpp2::move(what)) + " cannot have a 'move this' or 'move that' parameter"));
+                return ; 
+            }
+            CPP2_UFCS(add_member)(t, ("    " + cpp2::to_string(call.signature) + " = _pimpl*." + cpp2::to_string(CPP2_UFCS_MOVE(name)(m)) + "(" + cpp2::to_string(call.args) + ");"));
+        }
+
+        CPP2_UFCS(move_to_type)(m, impl);
+    }
+
+    if (!(cpp2::move(has_ctor))) {
+        CPP2_UFCS(add_member)(t, "    operator=: (out this) = { _pimpl = unique.new<_impl>(); }");
+    }
+
+    //  Moving just takes the other implementation object
+    auto smfs {CPP2_UFCS(query_declared_value_set_functions)(t)}; 
+    if ( smfs.out_this_in_that 
+        && !(smfs.out_this_move_that)) 
+    {
+        CPP2_UFCS(add_member)(t, "    operator=: (out this, move that) = { _pimpl = that._pimpl; }");
+    }
+    CPP2_UFCS(add_member)(t, "    operator=: (move this) = { }");
+    CPP2_UFCS(add_member)(t, "    private _pimpl: std::unique_ptr<_impl> = ();");
+}
+
+#line 1770 "reflect.h2"
+auto copy_on_write(meta::type_declaration& t) -> void
+{
+    CPP2_UFCS(reserve_names)(t, "_data", "_cow", "_write");
+
+    CPP2_UFCS(add_member)(t, "    private _data: type = { }");
+    auto data {CPP2_UFCS(back)(CPP2_UFCS(get_member_types)(t))}; 
+
+    auto has_default_spaceship {false}; 
+    auto has_equality {false}; 
+    for ( 
+         auto& m : CPP2_UFCS(get_members)(t) ) 
+    {
+        if (CPP2_UFCS(is_base_object)(m)) {
+            CPP2_UFCS(error)(m, "a copy_on_write type cannot have a base class");
+            return ; 
+        }
+
+        if (CPP2_UFCS(is_member_object)(m)) 
+        {
+            CPP2_UFCS(require)(m, CPP2_UFCS(is_private)(m) || CPP2_UFCS(is_default_access)(m), 
+                       "a copy_on_write type's data members must be private, so that all changes go through functions with 'inout this'");
+            CPP2_UFCS(move_to_type)(m, data);
+            continue;
+        }
+
+        if (!(CPP2_UFCS(is_function)(m))) {
+            continue;
+        }
+        auto mf {CPP2_UFCS(as_function)(m)}; 
+        if (CPP2_UFCS(is_virtual)(mf)) {
+            CPP2_UFCS(error)(m, "a copy_on_write type cannot have a virtual function");
+            return ; 
+        }
+        if (!(CPP2_UFCS(is_function_with_this)(mf))) {
+            continue;
+        }
+        if (CPP2_UFCS(is_protected)(m)) {
+            CPP2_UFCS(error)(m, "a copy_on_write type cannot have a protected function - make it public or private");
+            return ; 
+        }
+        has_default_spaceship |= CPP2_UFCS(has_name)(m, "operator<=>") && !(CPP2_UFCS(has_initializer)(m));
+        has_equality          |= CPP2_UFCS(has_name)(m, "operator==");
+
+        //  Copying, moving, and destroying are done on the block, and
+        //  private functions are only used by the other functions
+        if ( CPP2_UFCS(is_constructor_with_that)(mf) 
+            || CPP2_UFCS(is_assignment_with_that)(mf) 
+            || CPP2_UFCS(is_destructor)(mf) 
+            || (CPP2_UFCS(is_private)(m) && !(CPP2_UFCS(has_name)(m, "operator=")))) 
+        {
+            CPP2_UFCS(move_to_type)(m, data);
+            continue;
+        }
+
+        std::string name {CPP2_UFCS(name)(m)}; 
+        CPP2_UFCS(require)(m, !(CPP2_UFCS(is_private)(m)), 
+                   "a copy_on_write type's constructors and assignment operators must be public");
+        if ( CPP2_UFCS(has_move_parameter_named)(mf, "this") 
+            || CPP2_UFCS(has_move_parameter_named)(mf, "that")) 
+        {
+            CPP2_UFCS(error)(m, ("a copy_on_write type's function '" + cpp2::to_string(name) + "' cannot have a 'move this' or 'move that' parameter"));
+            return ; 
+        }
+        if ( CPP2_UFCS(has_declared_return_type)(mf) 
+            && CPP2_UFCS(empty)(CPP2_UFCS(unnamed_return_type)(mf))) 
+        {
+            CPP2_UFCS(error)(m, ("a copy_on_write type's function '" + cpp2::to_string(name) + "' cannot have named return values"));
+            return ; 
+        }
+
+        std::string that_arg {"that._cow*"}; 
+        if (CPP2_UFCS(has_parameter_with_name_and_pass)(mf, "that", passing_style::inout)) {
+            that_arg = "that._write()";
+        }
+        auto call {forwarding_call_for(mf, cpp2::move(that_arg))}; 
+
+        if (CPP2_UFCS(is_constructor)(mf)) {
+            CPP2_UFCS(add_member)(t, ("    " + cpp2::to_string(call.signature) + " = { _cow = shared.new<_data>(" + cpp2::to_string(call.args) + "); }"));
+        }
+        else {if (CPP2_UFCS(has_parameter_with_name_and_pass)(cpp2::move(mf), "this", passing_style::inout)) {
+            CPP2_UFCS(add_member)(t, ("    " + cpp2::to_string(call.signature) + " = _write()." + cpp2::to_string(cpp2::move(name)) + "(" + cpp2::to_string(call.args) + ");"));
+        }
+        else {
+            CPP2_UFCS(add_member)(t, ("    " + cpp2::to_string(call.signature) + " = _cow*." + cpp2::to_string(cpp2::move(name)) + "(" + cpp2::to_string(call.args) + ");"));
+        }}
+
+        CPP2_UFCS(move_to_type)(m, data);
+    }
+
+    //  A defaulted <=> also declares ==, but the forwarding <=> doesn't
+    if ( cpp2::move(has_default_spaceship) 
+        && !(cpp2::move(has_equality))) 
+    {
+        CPP2_UFCS(add_member)(t, "    operator==: (this, that) -> bool = _cow* == that._cow*;");
+    }
+
+    //  The block is copied when it's shared, and the type itself is
+    //  copied by sharing the block
+    for ( 
+         auto& mt : CPP2_UFCS(get_member_types)(t) ) 
+    if ( CPP2_UFCS(has_name)(mt, "_data")) 
+    {
+        CPP2_UFCS(basic_value)(mt);
+    }
+
+    CPP2_UFCS(add_member)(t, "    private _cow: std::shared_ptr<_data> = shared.new<_data>();");
+    //  If another object just stopped sharing the block, the fence makes
+    //  its reads of the block happen before this object's writes
+    std::string write {"    private _write: (inout this) -> forward _data = {"}; 
+    write += "\n        if _cow.use_count() == 1 {";
+    write += "\n            std::atomic_thread_fence(std::memory_order_acquire);";
+    write += "\n        }";
+    write += "\n        else {";
+    write += "\n            _cow = shared.new<_data>(_cow*);";
+    write += "\n        }";
+    write += "\n        return _cow*;";
+    write += "\n    }";
+    CPP2_UFCS(add_member)(t, cpp2::move(write));
+
+    CPP2_UFCS(basic_value)(t);
+}
+
+#line 1904 "reflect.h2"
+auto interned(meta::type_declaration& t) -> void
+{
+    CPP2_UFCS(reserve_names)(t, "handle", "intern");
+
+    std::vector<std::string> members {}; 
+    for ( auto& m : CPP2_UFCS(get_members)(t) ) 
+    {
+        if (CPP2_UFCS(is_base_object)(m)) {
+            CPP2_UFCS(error)(m, "an interned type cannot have a base class");
+            return ; 
+        }
+        if (CPP2_UFCS(is_member_object)(m)) {
+            std::string name {CPP2_UFCS(name)(m)}; 
+            if (!(CPP2_UFCS(is_const)(CPP2_UFCS(as_object)(m)))) {
+                CPP2_UFCS(error)(m, ("an interned type's data members must all be const - '" + cpp2::to_string(name) + "' is not"));
+                return ; 
+            }
+            CPP2_UFCS(require)(m, CPP2_UFCS(make_public)(m), 
+                       ("an interned type's data members must be public - '" + cpp2::to_string(name) + "' is not"));
+            CPP2_UFCS(push_back)(members, cpp2::move(name));
+        }
+    }
+
+    auto has_hash {false}; 
+    auto has_equality {false}; 
+    for ( auto const& mf : CPP2_UFCS(get_member_functions)(t) ) 
+    {
+        CPP2_UFCS(require)(mf, !(CPP2_UFCS(is_virtual)(mf)), 
+                    "an interned type may not have a virtual function");
+        has_hash     |= CPP2_UFCS(has_name)(mf, "hash");
+        has_equality |= CPP2_UFCS(has_name)(mf, "operator==");
+    }
+    CPP2_UFCS(cpp1_rule_of_zero)(t);
+
+    if (!(cpp2::move(has_hash))) {
+        std::string hash {"    hash: (this) -> std::size_t = {\n        ret: std::size_t = 0;"}; 
+        for ( auto const& name : cpp2::move(members) ) {
+            hash += ("\n        ret = cpp2::hash_combine(ret, " + cpp2::to_string(name) + ");");
+        }
+        hash += "\n        return ret;\n    }";
+        CPP2_UFCS(add_member)(t, cpp2::move(hash));
+    }
+    if (!(cpp2::move(has_equality))) {
+        CPP2_UFCS(add_member)(t, "    operator==: (this, that) -> bool;");
+    }
+
+    CPP2_UFCS(add_member)(t, ("    public handle: type == cpp2::interned<" + cpp2::to_string(CPP2_UFCS(name)(t)) + ">;"));
+    CPP2_UFCS(add_member)(t, ("    intern: (this) -> handle = cpp2::intern_table<" + cpp2::to_string(CPP2_UFCS(name)(t)) + ", std::shared_mutex>::instance().intern(this);"));
+}
+
+#line 1977 "reflect.h2"
 auto basic_enum(
     meta::type_declaration& t, 
     auto const& nextval, 
@@ -1637,7 +2701,7 @@ auto basic_enum(
 {
 std::string value{"-1"};
 
-#line 994 "reflect.h2"
+#line 2000 "reflect.h2"
     for ( 
           auto const& m : CPP2_UFCS(get_members)(t) ) 
     if (  CPP2_UFCS(is_member_object)(m)) 
@@ -1676,7 +2740,7 @@ std::string value{"-1"};
     }
 }
 
-#line 1031 "reflect.h2"
+#line 2037 "reflect.h2"
     if ((CPP2_UFCS(empty)(enumerators))) {
         CPP2_UFCS(error)(t, "an enumeration must contain at least one enumerator value");
         return ; 
@@ -1722,7 +2786,7 @@ std::string value{"-1"};
         }
     }
 
-#line 1077 "reflect.h2"
+#line 2083 "reflect.h2"
     //  2. Replace: Erase the contents and replace with modified contents
     //
     //  Note that most values and functions are declared as '==' compile-time values, i.e. Cpp1 'constexpr'
@@ -1770,7 +2834,7 @@ std::string to_string{"    to_string: (this) -> std::string = { \n"};
 
     //  Provide a 'to_string' function to print enumerator name(s)
 
-#line 1122 "reflect.h2"
+#line 2128 "reflect.h2"
     {
         if (bitwise) {
             to_string += "    _ret   : std::string = \"(\";\n";
@@ -1802,10 +2866,10 @@ std::string to_string{"    to_string: (this) -> std::string = { \n"};
         CPP2_UFCS(add_member)(t, cpp2::move(to_string));
     }
 }
-#line 1152 "reflect.h2"
+#line 2158 "reflect.h2"
 }
 
-#line 1164 "reflect.h2"
+#line 2170 "reflect.h2"
 auto cpp2_enum(meta::type_declaration& t) -> void
 {
     //  Let basic_enum do its thing, with an incrementing value generator
@@ -1822,7 +2886,7 @@ auto cpp2_enum(meta::type_declaration& t) -> void
     );
 }
 
-#line 1191 "reflect.h2"
+#line 2197 "reflect.h2"
 auto flag_enum(meta::type_declaration& t) -> void
 {
     //  Let basic_enum do its thing, with a power-of-two value generator
@@ -1844,7 +2908,7 @@ auto flag_enum(meta::type_declaration& t) -> void
     );
 }
 
-#line 1237 "reflect.h2"
+#line 2243 "reflect.h2"
 auto cpp2_union(meta::type_declaration& t) -> void
 {
     std::vector<value_member_info> alternatives {}; 
@@ -1853,7 +2917,7 @@ auto value{0};
 
     //  1. Gather: All the user-written members, and find/compute the max size
 
-#line 1244 "reflect.h2"
+#line 2250 "reflect.h2"
     for ( 
 
            auto const& m : CPP2_UFCS(get_members)(t) )  { do 
@@ -1879,7 +2943,7 @@ auto value{0};
     } while (false); ++value; }
 }
 
-#line 1268 "reflect.h2"
+#line 2274 "reflect.h2"
     std::string discriminator_type {}; 
     if (cpp2::impl::cmp_less(CPP2_UFCS(ssize)(alternatives),std::numeric_limits<cpp2::i8>::max())) {
         discriminator_type = "i8";
@@ -1894,7 +2958,7 @@ auto value{0};
         discriminator_type = "i64";
     }}}
 
-#line 1283 "reflect.h2"
+#line 2289 "reflect.h2"
     //  2. Replace: Erase the contents and replace with modified contents
 
     CPP2_UFCS(remove_marked_members)(t);
@@ -1903,7 +2967,7 @@ std::string storage{"    _storage: cpp2::aligned_storage<cpp2::max( "};
 
     //  Provide storage
 
-#line 1289 "reflect.h2"
+#line 2295 "reflect.h2"
     {
         for ( 
               auto const& e : alternatives ) {
@@ -1923,7 +2987,7 @@ std::string storage{"    _storage: cpp2::aligned_storage<cpp2::max( "};
 }
 
     //  Provide discriminator
-#line 1307 "reflect.h2"
+#line 2313 "reflect.h2"
     CPP2_UFCS(add_member)(t, ("    _discriminator: " + cpp2::to_string(cpp2::move(discriminator_type)) + " = -1;\n"));
 
     //  Add the alternatives: is_alternative, get_alternative, and set_alternative
@@ -1945,7 +3009,7 @@ std::string destroy{"    private _destroy: (inout this) = {\n"};
 
     //  Add destroy
 
-#line 1326 "reflect.h2"
+#line 2332 "reflect.h2"
     {
         for ( 
               auto const& a : alternatives ) {
@@ -1959,7 +3023,7 @@ std::string destroy{"    private _destroy: (inout this) = {\n"};
 }
 
     //  Add the destructor
-#line 1338 "reflect.h2"
+#line 2344 "reflect.h2"
     CPP2_UFCS(add_member)(t, "    operator=: (move this) = { _destroy(); _ = this; }");
 
     //  Add default constructor
@@ -1969,7 +3033,7 @@ std::string value_set{""};
 
     //  Add copy/move construction and assignment
 
-#line 1345 "reflect.h2"
+#line 2351 "reflect.h2"
     {
         for ( 
               auto const& a : cpp2::move(alternatives) ) {
@@ -1989,16 +3053,16 @@ std::string value_set{""};
                     );
     }
 }
-#line 1363 "reflect.h2"
+#line 2369 "reflect.h2"
 }
 
-#line 1370 "reflect.h2"
+#line 2376 "reflect.h2"
 auto print(cpp2::impl::in<meta::type_declaration> t) -> void
 {
     std::cout << CPP2_UFCS(print)(t) << "\n";
 }
 
-#line 1380 "reflect.h2"
+#line 2386 "reflect.h2"
 [[nodiscard]] auto apply_metafunctions(
     declaration_node& n, 
     type_declaration& rtype, 
@@ -2079,14 +3143,35 @@ auto print(cpp2::impl::in<meta::type_declaration> t) -> void
         else {if (name == "union") {
             cpp2_union(rtype);
         }
+        else {if (name == "trivially_relocatable") {
+            trivially_relocatable(rtype);
+        }
+        else {if (name == "slot_map") {
+            slot_map(rtype);
+        }
+        else {if (name == "bitpacked") {
+            bitpacked(rtype);
+        }
+        else {if (name == "simd_vector") {
+            simd_vector(rtype);
+        }
+        else {if (name == "pimpl") {
+            pimpl(rtype);
+        }
+        else {if (name == "copy_on_write") {
+            copy_on_write(rtype);
+        }
+        else {if (name == "interned") {
+            interned(rtype);
+        }
         else {if (name == "print") {
             print(rtype);
         }
         else {
             error("unrecognized metafunction name: " + name);
-            error("(temporary alpha limitation) currently the supported names are: interface, polymorphic_base, ordered, weakly_ordered, partially_ordered, copyable, basic_value, value, weakly_ordered_value, partially_ordered_value, struct, enum, flag_enum, union, cpp1_rule_of_zero, print");
+            error("(temporary alpha limitation) currently the supported names are: interface, polymorphic_base, ordered, weakly_ordered, partially_ordered, copyable, basic_value, value, weakly_ordered_value, partially_ordered_value, struct, enum, flag_enum, union, cpp1_rule_of_zero, trivially_relocatable, slot_map, bitpacked, simd_vector, pimpl, copy_on_write, interned, print");
             return false; 
-        }}}}}}}}}}}}}}}}
+        }}}}}}}}}}}}}}}}}}}}}}}
 
         if ((
             !(CPP2_UFCS(empty)(args)) 
@@ -2101,7 +3186,7 @@ auto print(cpp2::impl::in<meta::type_declaration> t) -> void
     return true; 
 }
 
-#line 1483 "reflect.h2"
+#line 2510 "reflect.h2"
 }
 
 }
@@ -29,7 +29,7 @@ auto parser::apply_type_metafunctions( declaration_node& n )
     assert(n.is_type());
 
     //  Get the reflection state ready to pass to the function
-    auto cs = meta::compiler_services{ &errors, generated_tokens };
+    auto cs = meta::compiler_services{ &errors, generated_tokens, &generated };
     auto rtype = meta::type_declaration{ &n, cs };
 
     return apply_metafunctions(
@@ -91,6 +91,7 @@ struct identifier_sym {
     enum kind { use, using_declaration, deactivation } kind_ = use;
     bool standalone_assignment_to = false;
     bool is_captured = false;
+    bool is_deferred = false;   // a non-captured use in a postcondition, evaluated on exit
     bool is_after_dot = false;
     bool safe_to_move = true;
     int safe_to_move_context = 0;
@@ -300,28 +301,8 @@ struct symbol {
 };
 
 
-//  Keep a list of all token*'s found that are definite first uses
-//  of the form "x = expr;" for an uninitialized local variable x,
-//  which we will rewrite to construct the local variable.
-//
-std::vector<token const*> definite_initializations;
-
-auto is_definite_initialization(token const* t)
-    -> bool
-{
-    return
-        std::find(
-            definite_initializations.begin(),
-            definite_initializations.end(),
-            t
-            )
-        != definite_initializations.end();
-}
-
-
-//  Keep a list of all token*'s found that are definite last uses
-//  for a local variable or copy or forward parameter x, which we
-//   will rewrite to move or forward from the variable.
+//  A definite last use for a local variable or copy or forward
+//  parameter x, which we will rewrite to move or forward from the variable
 //
 struct last_use {
     token const* t;
@@ -338,25 +319,8 @@ struct last_use {
         , safe_to_move{safe_to_move_}
     { }
 
-    bool operator==(last_use const& that) { return t == that.t; }
+    bool operator==(last_use const& that) const { return t == that.t; }
 };
-std::vector<last_use> definite_last_uses;
-
-auto is_definite_last_use(token const* t)
-    -> last_use const*
-{
-    auto iter = std::find(
-            definite_last_uses.begin(),
-            definite_last_uses.end(),
-            t
-            );
-    if (iter != definite_last_uses.end()) {
-        return &*iter;
-    }
-    else {
-        return {};
-    }
-}
 
 
 //-----------------------------------------------------------------------
@@ -383,6 +347,18 @@ public:
     };
     std::unordered_map< token const*, declaration_of_t > declaration_of;
 
+    //  Keep the set of all token*'s found that are definite first uses
+    //  of the form "x = expr;" for an uninitialized local variable x,
+    //  which we will rewrite to construct the local variable.
+    //
+    std::unordered_set<token const*> definite_initializations;
+
+    //  Keep a list of all token*'s found that are definite last uses
+    //  for a local variable or copy or forward parameter x, which we
+    //  will rewrite to move or forward from the variable.
+    //
+    std::vector<last_use> definite_last_uses;
+
 public:
     //-----------------------------------------------------------------------
     //  Constructor
@@ -396,6 +372,32 @@ public:
     {
     }
 
+    //  Is t a definite first use of the form "x = expr;"
+    //
+    auto is_definite_initialization(token const* t) const
+        -> bool
+    {
+        return definite_initializations.contains(t);
+    }
+
+    //  Is t a definite last use, and if so which kind
+    //
+    auto is_definite_last_use(token const* t) const
+        -> last_use const*
+    {
+        auto iter = std::find(
+                definite_last_uses.begin(),
+                definite_last_uses.end(),
+                t
+                );
+        if (iter != definite_last_uses.end()) {
+            return &*iter;
+        }
+        else {
+            return {};
+        }
+    }
+
     //  Get the declaration of t within the same named function or beyond it
     //  For a this parameter, optionally include uses of implicit this
     //
@@ -546,14 +548,17 @@ public:
 
         //  First find the position the query is coming from
         //  and remember its depth
-        auto i = symbols.cbegin();
-        while (
-            i != symbols.cend()
-            && i->get_global_token_order() < t.get_global_token_order()
-            )
-        {
-            ++i;
-        }
+        auto pos = 0;
+        symbols.for_each_segment( [&](std::span<symbol const> segment) -> bool {
+            for (auto const& s : segment) {
+                if (s.get_global_token_order() >= t.get_global_token_order()) {
+                    return false;
+                }
+                ++pos;
+            }
+            return true;
+        });
+        auto i = symbols.cbegin() + pos;
 
         if (i == symbols.cbegin()) {
             return nullptr;
@@ -729,16 +734,24 @@ public:
         -> bool
     {
         //  TODO Use 'std::lower_bound' by filtering final positions of 0.
-        auto it = std::find_if(
-            symbols.begin(),
-            symbols.end(),
-            [&](symbol const& s) -> bool {
-                return s.get_global_token_order() == t.get_global_token_order();
-            });
+        symbol const* found = nullptr;
+        symbols.for_each_segment( [&](std::span<symbol const> segment) -> bool {
+            auto it = std::find_if(
+                segment.begin(),
+                segment.end(),
+                [&](symbol const& s) -> bool {
+                    return s.get_global_token_order() == t.get_global_token_order();
+                });
+            if (it != segment.end()) {
+                found = &*it;
+                return false;
+            }
+            return true;
+        });
 
         if (identifier_sym const* sym = nullptr;
-            it != symbols.end()
-            && (sym = std::get_if<symbol::active::identifier>(&it->sym))
+            found
+            && (sym = std::get_if<symbol::active::identifier>(&found->sym))
             && sym->is_use()
             )
         {
@@ -968,21 +981,36 @@ public:
         };
 
         //-----------------------------------------------------------------------
-        //  Function logic: For each entry in the table...
+        //  Function logic: Check all the uninitialized local variables
+        //  together in one pass, then for each entry in the table...
         //
+        auto uninitialized = std::vector<int>{};
+        for (auto sympos = 0; sympos < std::ssize(symbols); ++sympos) {
+            if (is_uninitialized_variable_decl(symbols[sympos])) {
+                uninitialized.push_back(sympos);
+            }
+        }
+        auto initialization_results = find_definite_initializations(uninitialized);
+        auto next_result = std::ssize(initialization_results) - 1;
+
         for (auto sympos = unsafe_narrow<int>(std::ssize(symbols) - 1); sympos >= 0; --sympos)
         {
-            //  If this is an uninitialized local variable,
-            //  ensure it is definitely initialized and tag those initializations
+            //  If this is an uninitialized local variable, report whether
+            //  it is definitely initialized and tag those initializations
+            //  (stopping at the first one that isn't)
             //
             if (auto decl = is_uninitialized_variable_decl(symbols[sympos])) {
                 assert(
                     decl->identifier
                     && !decl->initializer
                 );
-                ret = ret
-                    && ensure_definitely_initialized(decl, sympos+1, symbols[sympos].depth)
-                    ;
+                auto const& result = initialization_results[next_result--];
+                assert (result.pos == sympos);
+                if (ret) {
+                    errors.insert( errors.end(), result.errors.begin(), result.errors.end() );
+                    definite_initializations.insert( result.initializations.begin(), result.initializations.end() );
+                    ret = result.ok;
+                }
             }
 
             //  If this is a copy, move, or forward parameter or a local variable,
@@ -1012,7 +1040,7 @@ private:
         int                          pos,
         std::optional<passing_style> pass,
         bool                         is_parameter
-    ) const
+    )
         -> void
     {
         auto is_a_use = [&](identifier_sym const* sym) -> bool {
@@ -1155,6 +1183,16 @@ private:
             ++i
             )
         {
+            //  A non-captured use in a postcondition is evaluated on exit, after
+            //  everything else, so no other use is a last use we can move from
+            if (auto sym = std::get_if<symbol::active::identifier>(&symbols[i].sym);
+                is_a_use(sym)
+                && sym->is_deferred
+                )
+            {
+                return;
+            }
+
             //  While we're here, if this is a non-parameter local, check for
             //  any uses before the end of the initializer
             if (
@@ -1391,262 +1429,422 @@ private:
     }
 
 
-    //  Check that local variable *id is initialized before use on all paths
-    //  starting at the given position and depth in the symbol/scope table
+    //  The outcome of checking one uninitialized local variable, which
+    //  apply_local_rules reports in its usual (last-declared-first) order
     //
-    //  TODO: After writing the first version of this, I realized that it could be
-    //        simplified a lot by using a sentinel value to represent the base case like
-    //        the others instead of as a special case. It's tempting to rewrite this now
-    //        to do that cleanup, but the code is working and fully localized, so
-    //        rewriting it wouldn't give any benefit, and I need to resist the urge to
-    //        be distracted by goldplating when I could be implementing a new feature.
+    struct definite_initialization_result
+    {
+        int                       pos = 0;  // position of the declaration
+        bool                      ok  = false;
+        std::vector<error_entry>  errors          = {};
+        std::vector<token const*> initializations = {};
+    };
+
+    //  Check that each uninitialized local variable declared at the given
+    //  (ascending) positions in the symbol/scope table is initialized before
+    //  use on all paths
     //
-    auto ensure_definitely_initialized(
-        declaration_sym const* decl,
-        int                    pos,
-        int                    depth
-    ) const
-        -> bool
+    //  This is a single forward pass over the table for all of the locals at
+    //  once. A local's selection statements are the ones opened since its
+    //  declaration, so they are kept once on a shared stack, and each branch
+    //  lists just the locals it initializes. A local only has to look at the
+    //  symbols that can change its state: declarations and uses of its name,
+    //  ends of the selection statements it initialized something in, and
+    //  initializations of locals declared after it. A local that is done with
+    //  the current branch sleeps until the branch ends, and a local that is
+    //  done altogether drops out.
+    //
+    //  A local must be initialized before any local declared after it, so at
+    //  each use the locals of that name are visited newest-first, and if one
+    //  of them takes the use as its initialization then every older local
+    //  that is still looking has been initialized out of order
+    //
+    auto find_definite_initializations(
+        std::vector<int> const& decl_positions
+    )
+        -> std::vector<definite_initialization_result>
     {
-        auto name = decl->identifier->to_string();
+        CPP2_SCOPE_TIMER("find_definite_initializations");
 
-        struct stack_entry{
+        struct open_selection {
             int pos;    // start of this selection statement
 
             struct branch {
-                int  start;
-                bool result = false;
+                int              start;
+                std::vector<int> initialized = {};  // locals this branch initializes
 
-                branch(int s, bool r) : start{s}, result{r} { }
+                branch(int s) : start{s} { }
             };
-            std::vector<branch> branches;
+            std::vector<branch> branches = {};
+
+            open_selection(int p) : pos{p} { }
+        };
+
+        struct pending_local {
+            declaration_sym const* decl;
+            int                    depth;
+            std::string            name;
+            int                    base = 0;    // its selections are the ones above this
+            enum { waiting, scanning, skipping, done } state = waiting;
+
+            //  The last branch result set, which a later use in the
+            //  same branch can overwrite
+            std::pair<int, int> last_result_at = { -1, -1 };
+            bool                last_result    = false;
+        };
+
+        //  Locals filed by depth, to pick up the ones past their scope
+        //  (or past the branch they are skipping) when the depth drops
+        struct depth_buckets {
+            std::vector<std::vector<int>> buckets;
+            int top = -1;
 
-            stack_entry(int p) : pos{p} { }
+            auto add(int depth, int i)
+                -> void
+            {
+                depth = std::max(depth, 0);
+                buckets[depth].push_back(i);
+                top = std::max(top, depth);
+            }
 
-            auto debug_print(std::ostream& o) const -> void
+            auto take_deeper_than(int depth)
+                -> std::vector<int>
             {
-                o << "Stack entry: " << pos << "\n";
-                for (auto const& e : branches) {
-                    o << "  ( " << e.start << " , " << e.result << " )\n";
+                auto ret = std::vector<int>{};
+                for ( ; top > depth; --top) {
+                    ret.insert(ret.end(), buckets[top].begin(), buckets[top].end());
+                    buckets[top].clear();
                 }
+                return ret;
             }
         };
-        std::vector<stack_entry> selection_stack;
 
-        for (
-            ;
-            pos < std::ssize(symbols) && symbols[pos].depth >= depth;
-            ++pos
-            )
+        auto results = std::vector<definite_initialization_result>{};
+        auto locals  = std::vector<pending_local>{};
+        for (auto pos : decl_positions) {
+            auto const& sym = std::get<symbol::active::declaration>(symbols[pos].sym);
+            assert (sym.identifier);
+            results.push_back({ pos });
+            locals.push_back({ &sym, symbols[pos].depth, sym.identifier->to_string() });
+        }
+
+        auto max_depth = 0;
+        for (auto pos = 0; pos < std::ssize(symbols); ++pos) {
+            max_depth = std::max(max_depth, symbols[pos].depth);
+        }
+
+        auto selections = std::vector<open_selection>{};
+        auto scanning   = std::set<int>{};   // looking at every symbol, oldest first
+        auto by_name    = std::unordered_map<std::string_view, std::vector<int>>{};
+        auto scope_ends = depth_buckets{ std::vector<std::vector<int>>(max_depth + 2) };
+        auto wake_ups   = depth_buckets{ std::vector<std::vector<int>>(max_depth + 2) };
+
+        auto error = [&](int i, source_position where, std::string const& msg)
         {
-            switch (symbols[pos].sym.index()) {
+            results[i].errors.emplace_back( where, msg );
+        };
 
-            break;case symbol::active::declaration: {
-                auto const& sym = std::get<symbol::active::declaration>(symbols[pos].sym);
-                if (
-                    sym.start
-                    && sym.identifier
-                    && *sym.identifier == *decl->identifier
-                    )
-                {
-                    errors.emplace_back(
-                        sym.identifier->position(),
-                        "local variable " + sym.identifier->to_string()
-                            + " cannot have the same name as an uninitialized"
-                              " variable in the same function");
+        auto finish = [&](int i, bool ok)
+        {
+            locals[i].state = pending_local::done;
+            results[i].ok = ok;
+            scanning.erase(i);
+            auto& same = by_name[*locals[i].decl->identifier];
+            same.erase( std::find(same.begin(), same.end(), i) );
+        };
+
+        //  Skip ahead to the first symbol that is less deep than wake_depth
+        auto skip = [&](int i, int wake_depth)
+        {
+            locals[i].state = pending_local::skipping;
+            scanning.erase(i);
+            wake_ups.add(wake_depth, i);
+        };
+
+        auto not_initialized_on_every_path = [&](int i)
+        {
+            error(
+                i,
+                locals[i].decl->identifier->position(),
+                locals[i].name
+                + " - variable must be initialized on every branch path");
+            finish(i, false);
+        };
+
+        //  Set the local's result for the current branch of selections[s]
+        auto set_result = [&](int i, int s, bool result)
+        {
+            auto& l           = locals[i];
+            auto& initialized = selections[s].branches.back().initialized;
+            auto  at          = std::pair{ selections[s].pos, unsafe_narrow<int>(std::ssize(selections[s].branches)) };
+
+            if (l.last_result_at == at && l.last_result) {
+                if (!result) {
+                    initialized.erase( std::find(initialized.begin(), initialized.end(), i) );
                 }
             }
+            else if (result) {
+                initialized.push_back(i);
+            }
+            l.last_result_at = at;
+            l.last_result    = result;
+        };
 
-            break;case symbol::active::identifier: {
-                auto const& sym = std::get<symbol::active::identifier>(symbols[pos].sym);
-                assert (sym.identifier);
+        //  Handle a use of the local's own name, and return whether
+        //  it is a definite initialization
+        auto use_of = [&](int i, int pos, identifier_sym const& sym)
+            -> bool
+        {
+            auto const& name    = locals[i].name;
+            auto        nesting = std::ssize(selections) - locals[i].base;
+            assert (nesting >= 0);
 
-                if (
-                    sym.is_use()
-                    && is_definite_initialization(sym.identifier)
-                    )
-                {
-                    errors.emplace_back(
+            auto initialize_or_report = [&](std::string const& where)
+            {
+                if (sym.standalone_assignment_to) {
+                    results[i].initializations.push_back( sym.identifier );
+                }
+                else {
+                    error(
+                        i,
                         sym.identifier->position(),
-                        "local variable " + name
-                            + " must be initialized before " + sym.identifier->to_string()
-                            + " (local variables must be initialized in the order they are declared)"
-                    );
+                        "local variable " + name + " is used " + where + "before it was initialized");
+                }
+            };
+
+            //  If we're not inside a selection statement, we're at the top level --
+            //  just succeed if it's an assignment to it, else fail
+            if (nesting == 0) {
+                initialize_or_report("");
+                finish(i, sym.standalone_assignment_to);
+                return sym.standalone_assignment_to;
+            }
+
+            //  Else if we're inside a selection statement but still in the condition
+            //  portion (there are no branches entered yet)
+            else if (std::ssize(selections.back().branches) == 0) {
+                //  If this is a top-level selection statement, handle it the same as
+                //  if we weren't an a selection statement
+                if (nesting == 1) {
+                    initialize_or_report("in a condition ");
+                    finish(i, sym.standalone_assignment_to);
+                    return sym.standalone_assignment_to;
+                }
+                //  Else we can skip the rest of this selection statement, and record
+                //  this as the result of the next outer selection statement's current branch
+                else {
+                    auto outer = std::ssize(selections) - 2;
+                    assert (std::ssize(selections[outer].branches) > 0);
+                    set_result(i, outer, sym.standalone_assignment_to);
+                    skip(i, symbols[pos].depth);
                     return false;
                 }
+            }
 
-                //  If we find a use of this identifier
-                if (*sym.identifier == *decl->identifier) {
+            //  Else we're in a selection branch and can skip the rest of this branch
+            //  and record this as the result for the current branch
+            else {
+                initialize_or_report("in a branch ");
+                set_result(i, std::ssize(selections) - 1, sym.standalone_assignment_to);
 
-                    //  If we're not inside a selection statement, we're at the top level --
-                    //  just return true if it's an assignment to it, else return false
-                    if (std::ssize(selection_stack) == 0) {
-                        if (sym.standalone_assignment_to) {
-                            definite_initializations.push_back( sym.identifier );
-                        }
-                        else {
-                            errors.emplace_back(
-                                sym.identifier->position(),
-                                "local variable " + name
-                                    + " is used before it was initialized");
-                        }
-                        return sym.standalone_assignment_to;
-                    }
+                //  The depth of this branch should always be the depth of
+                //  the current selection statement + 1
+                skip(i, symbols[selections.back().pos].depth + 2);
+                return sym.standalone_assignment_to;
+            }
+        };
 
-                    //  Else if we're inside a selection statement but still in the condition
-                    //  portion (there are no branches entered yet)
-                    else if (std::ssize(selection_stack.back().branches) == 0) {
-                        //  If this is a top-level selection statement, handle it the same as
-                        //  if we weren't an a selection statement
-                        if (std::ssize(selection_stack) == 1) {
-                            if (sym.standalone_assignment_to) {
-                                definite_initializations.push_back( sym.identifier );
-                            }
-                            else {
-                                errors.emplace_back(
-                                    sym.identifier->position(),
-                                    "local variable " + name
-                                        + " is used in a condition before it was initialized");
-                            }
-                            return sym.standalone_assignment_to;
-                        }
-                        //  Else we can skip the rest of this selection statement, and record
-                        //  this as the result of the next outer selection statement's current branch
-                        else {
-                            selection_stack.pop_back();
-                            assert (std::ssize(selection_stack.back().branches) > 0);
-                            selection_stack.back().branches.back().result = sym.standalone_assignment_to;
+        //  At the end of a selection statement, look at the partial results
+        //  of the locals it initialized on some branch -- they must all be
+        //  true, if they're a mix we are missing initializations on some
+        //  path(s) (the locals it didn't initialize at all can just continue)
+        auto end_of_selection = [&](int pos, selection_sym const& sym)
+        {
+            assert (!selections.empty());
+            auto const& ending = selections.back();
+            auto const  s      = std::ssize(selections) - 1;
+
+            auto true_branches_of = std::map<int, std::vector<bool>>{};
+            for (auto b = 0; b < std::ssize(ending.branches); ++b) {
+                for (auto i : ending.branches[b].initialized) {
+                    auto& branch_results = true_branches_of[i];
+                    branch_results.resize(ending.branches.size());
+                    branch_results[b] = true;
+                }
+            }
 
-                            int this_depth = symbols[pos].depth;
-                            while (symbols[pos + 1].depth >= this_depth) {
-                                ++pos;
-                            }
-                        }
-                    }
+            for (auto const& [i, branch_results] : true_branches_of)
+            {
+                if (locals[i].state != pending_local::scanning) {
+                    continue;
+                }
+                assert (locals[i].base <= s);
 
-                    //  Else we're in a selection branch and can skip the rest of this branch
-                    //  and record this as the result for the current branch
+                //  If all of the branches were true
+                if (std::find(branch_results.begin(), branch_results.end(), false) == branch_results.end())
+                {
+                    //  If this is a top-level selection statement, handle it the same as
+                    //  if we weren't an a selection statement
+                    if (locals[i].base == s) {
+                        finish(i, true);
+                    }
+                    //  Else record this as the result of the next outer
+                    //  selection statement's current branch
                     else {
-                        if (sym.standalone_assignment_to) {
-                            definite_initializations.push_back( sym.identifier );
-                        }
-                        else {
-                            errors.emplace_back(
-                                sym.identifier->position(),
-                                "local variable " + name
-                                    + " is used in a branch before it was initialized");
-                        }
-                        selection_stack.back().branches.back().result = sym.standalone_assignment_to;
+                        assert (std::ssize(selections[s-1].branches) > 0);
+                        set_result(i, s-1, true);
 
-                        //  The depth of this branch should always be the depth of
-                        //  the current selection statement + 1
-                        int branch_depth = symbols[selection_stack.back().pos].depth + 1;
-                        while (symbols[pos + 1].depth > branch_depth) {
-                            ++pos;
-                        }
+                        //  And skip the rest of this branch
+                        skip(i, symbols[pos].depth - 1);
                     }
-
-                }
-            }
-
-            break;case symbol::active::selection: {
-                auto const& sym = std::get<symbol::active::selection>(symbols[pos].sym);
-
-                //  If we're starting a new selection statement, add a stack entry for it
-                if (sym.start) {
-                    selection_stack.emplace_back( pos );
                 }
 
-                //  If we're ending a selection statement, look at the partial results --
-                //  they must all be false or all true, if they're a mix we are missing
-                //  initializations on some path(s)
-                else {
-                    assert (std::ssize(selection_stack) > 0);
-
+                //  Else we found a missing initializion, report it and fail
+                else
+                {
                     auto true_branches  = std::string{};
                     auto false_branches = std::string{};
-                    for (auto const& b : selection_stack.back().branches)
+                    for (auto b = 0; b < std::ssize(ending.branches); ++b)
                     {
+                        auto start = ending.branches[b].start;
+
                         //  If this is not an implicit 'else' branch (i.e., if lineno > 0)
-                        if (symbols[b.start].position().lineno > 0) {
-                            (b.result ? true_branches : false_branches)
+                        if (symbols[start].position().lineno > 0) {
+                            (branch_results[b] ? true_branches : false_branches)
                                 += "\n  branch starting at line "
-                                    + std::to_string(symbols[b.start].position().lineno);
+                                    + std::to_string(symbols[start].position().lineno);
                         }
                         else {
-                            (b.result ? true_branches : false_branches)
+                            (branch_results[b] ? true_branches : false_branches)
                                 += "\n  implicit else branch";
                         }
                     }
 
-                    //  If none of the branches was true
-                    if (true_branches.length() == 0)
-                    {
-                        selection_stack.pop_back();
-                        //  Nothing else to do, just continue
+                    auto const& name = locals[i].name;
+                    error(
+                        i,
+                        locals[i].decl->identifier->position(),
+                        "local variable " + name
+                            + " must be initialized on both branches or neither branch");
+
+                    assert (symbols[ending.pos].sym.index() == symbol::active::selection);
+                    error(
+                        i,
+                        sym.selection->identifier->position(),
+                        "\"" + sym.selection->identifier->to_string()
+                            + "\" initializes " + name
+                            + " on:" + true_branches
+                            + "\nbut not on:" + false_branches
+                    );
+
+                    finish(i, false);
+                }
+            }
+
+            selections.pop_back();
+        };
+
+        auto next_local = 0;
+        for (auto pos = 0; pos < std::ssize(symbols); ++pos)
+        {
+            auto depth = symbols[pos].depth;
+
+            //  Resume the locals that skipped to here, then retire the
+            //  ones whose scope ended before they were initialized
+            for (auto i : wake_ups.take_deeper_than(depth)) {
+                locals[i].state = pending_local::scanning;
+                scanning.insert(i);
+                scope_ends.add(locals[i].depth, i);
+            }
+            for (auto i : scope_ends.take_deeper_than(depth)) {
+                if (locals[i].state == pending_local::scanning) {
+                    not_initialized_on_every_path(i);
+                }
+            }
+
+            switch (symbols[pos].sym.index()) {
+
+            break;case symbol::active::declaration: {
+                auto const& sym = std::get<symbol::active::declaration>(symbols[pos].sym);
+                if (!sym.start || !sym.identifier) {
+                    break;
+                }
+
+                if (auto same = by_name.find(*sym.identifier); same != by_name.end()) {
+                    for (auto i : same->second) {
+                        if (locals[i].state == pending_local::scanning) {
+                            error(
+                                i,
+                                sym.identifier->position(),
+                                "local variable " + sym.identifier->to_string()
+                                    + " cannot have the same name as an uninitialized"
+                                      " variable in the same function");
+                        }
                     }
+                }
+            }
 
-                    //  Else if all of the branches were true
-                    else if (false_branches.length() == 0)
-                    {
-                        //  If this is a top-level selection statement, handle it the same as
-                        //  if we weren't an a selection statement
-                        if (std::ssize(selection_stack) == 1) {
-                            return true;
+            break;case symbol::active::identifier: {
+                auto const& sym = std::get<symbol::active::identifier>(symbols[pos].sym);
+                assert (sym.identifier);
+
+                auto out_of_order = [&](int i)
+                {
+                    error(
+                        i,
+                        sym.identifier->position(),
+                        "local variable " + locals[i].name
+                            + " must be initialized before " + sym.identifier->to_string()
+                            + " (local variables must be initialized in the order they are declared)"
+                    );
+                    finish(i, false);
+                };
+
+                auto initialized_by = -1;
+                if (auto same = by_name.find(*sym.identifier); same != by_name.end()) {
+                    auto const candidates = same->second;
+                    for (auto i = candidates.rbegin(); i != candidates.rend(); ++i) {
+                        if (locals[*i].state != pending_local::scanning) {
+                            continue;
                         }
-                        //  Else pop this selection statement, and record this as the result
-                        //  of the next outer selection statement's current branch
-                        else {
-                            selection_stack.pop_back();
-                            assert (std::ssize(selection_stack.back().branches) > 0);
-                            selection_stack.back().branches.back().result = true;
-
-                            //  And skip the rest of this branch
-                            auto skip_depth = symbols[pos].depth - 1;
-                            while (symbols[pos + 1].depth >= skip_depth) {
-                                ++pos;
-                            }
+                        if (initialized_by >= 0 && sym.is_use()) {
+                            out_of_order(*i);
+                        }
+                        else if (use_of(*i, pos, sym)) {
+                            initialized_by = *i;
                         }
                     }
+                }
 
-                    //  Else we found a missing initializion, report it and return false
-                    else
-                    {
-                        errors.emplace_back(
-                            decl->identifier->position(),
-                            "local variable " + name
-                                    + " must be initialized on both branches or neither branch");
-
-                        assert (symbols[selection_stack.back().pos].sym.index() == symbol::active::selection);
-                        auto const& sym = std::get<symbol::active::selection>(symbols[pos].sym);
-                        errors.emplace_back(
-                            sym.selection->identifier->position(),
-                            "\"" + sym.selection->identifier->to_string()
-                                + "\" initializes " + name
-                                + " on:" + true_branches
-                                + "\nbut not on:" + false_branches
-                        );
-
-                        return false;
+                if (initialized_by >= 0 && sym.is_use()) {
+                    while (!scanning.empty() && *scanning.begin() < initialized_by) {
+                        out_of_order(*scanning.begin());
                     }
+                }
+            }
 
+            break;case symbol::active::selection: {
+                auto const& sym = std::get<symbol::active::selection>(symbols[pos].sym);
+                if (sym.start) {
+                    selections.emplace_back( pos );
+                }
+                else {
+                    end_of_selection(pos, sym);
                 }
             }
 
             break;case symbol::active::compound: {
                 auto const& sym = std::get<symbol::active::compound>(symbols[pos].sym);
 
-                //  If we're in a selection
-                if (std::ssize(selection_stack) > 0) {
-                    //  If this is a compound start with the current selection's depth
-                    //  plus one, it's the start of one of the branches of that selection
-                    if (
-                        sym.start
-                        && symbols[pos].depth == symbols[selection_stack.back().pos].depth+1
-                        )
-                    {
-                        selection_stack.back().branches.emplace_back( pos, false );
-                    }
+                //  If this is a compound start with the current selection's depth
+                //  plus one, it's the start of one of the branches of that selection
+                if (
+                    sym.start
+                    && !selections.empty()
+                    && depth == symbols[selections.back().pos].depth+1
+                    )
+                {
+                    selections.back().branches.emplace_back( pos );
                 }
             }
 
@@ -1654,13 +1852,30 @@ private:
                 assert (!"illegal symbol");
             }
 
+            //  If an uninitialized local is declared here, it starts looking
+            //  at the next symbol
+            if (
+                next_local < std::ssize(locals)
+                && results[next_local].pos == pos
+                )
+            {
+                auto& l = locals[next_local];
+                l.state = pending_local::scanning;
+                l.base  = unsafe_narrow<int>(std::ssize(selections));
+                scanning.insert(next_local);
+                by_name[*l.decl->identifier].push_back(next_local);
+                scope_ends.add(depth, next_local);
+                ++next_local;
+            }
         }
 
-        errors.emplace_back(
-            decl->identifier->position(),
-            name
-            + " - variable must be initialized on every branch path");
-        return false;
+        for (auto i = 0; i < std::ssize(locals); ++i) {
+            if (locals[i].state != pending_local::done) {
+                not_initialized_on_every_path(i);
+            }
+        }
+
+        return results;
     }
 
 
@@ -1668,8 +1883,15 @@ public:
     //-----------------------------------------------------------------------
     //  Per-node sema rules
     //
+    //  These report to the caller's error list (and don't modify sema),
+    //  so that lowering can call them from more than one thread
+    //
 
-    auto check(qualified_id_node const& n)
+    auto check(
+        qualified_id_node const&  n,
+        std::vector<error_entry>& out_errors
+    ) const
+        -> bool
     {
         //  Check for some incorrect uses of .
         if (auto decl = get_declaration_of(n.get_first_token(), true);
@@ -1684,7 +1906,7 @@ public:
                 && n.ids[1].scope_op->type() == lexeme::Scope
                 )
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "use '" + decl->identifier->to_string() + ".' to refer to an object member"
                 );
@@ -1696,7 +1918,11 @@ public:
     }
 
 
-    auto check(postfix_expression_node const& n)
+    auto check(
+        postfix_expression_node const& n,
+        std::vector<error_entry>&      out_errors
+    ) const
+        -> bool
     {
         //  Check for some incorrect uses of :: or .
         if (auto decl = get_declaration_of(n.get_first_token_ignoring_this(), true);
@@ -1711,7 +1937,7 @@ public:
                 && n.ops[0].op->type() == lexeme::Dot
                 )
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "use '" + decl->identifier->to_string() + "::' to refer to a type member"
                 );
@@ -1723,7 +1949,10 @@ public:
     }
 
 
-    auto check(parameter_declaration_node const& n)
+    auto check(
+        parameter_declaration_node const& n,
+        std::vector<error_entry>&         out_errors
+    ) const
         -> bool
     {
         auto type_name = std::string{};
@@ -1741,7 +1970,7 @@ public:
             && type_name == *n.declaration->parent_declaration->parent_declaration->name()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "if an 'operator=' second parameter is of the same type (here '" + type_name + "'), it must be named 'that'"
             );
@@ -1751,11 +1980,14 @@ public:
         return true;
     }
 
-    auto check(declaration_node const& n)
+    auto check(
+        declaration_node const&   n,
+        std::vector<error_entry>& out_errors
+    ) const
         -> bool
     {
         if (n.has_name("operator")) {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "the name 'operator' is incomplete - did you mean to write an overloaded operator name like 'operator*' or 'operator++'?"
             );
@@ -1769,7 +2001,7 @@ public:
             && !n.has_initializer()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "an object with a deduced type must have an = initializer"
             );
@@ -1783,7 +2015,7 @@ public:
             && !n.initializer->is_expression()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "an object initializer must be an expression"
             );
@@ -1799,7 +2031,7 @@ public:
                 )
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "a namespace must be = initialized with a { } body containing declarations"
             );
@@ -1813,7 +2045,7 @@ public:
             && n.initializer->is_return()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "a function with a single-expression body doesn't need to say 'return' - either omit 'return' or write a full { }-enclosed function body"
             );
@@ -1828,7 +2060,7 @@ public:
             && !n.has_initializer()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "a function must have a body ('=' initializer), unless it is virtual (has a 'virtual this' parameter) or is defaultable (operator== or operator<=>)"
             );
@@ -1841,7 +2073,7 @@ public:
             && !n.parent_is_type()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "(temporary alpha limitation) a type must be in a namespace or type scope - function-local types are not yet supported"
             );
@@ -1854,7 +2086,7 @@ public:
             && n.has_wildcard_type()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "a type scope variable must have a declared type"
             );
@@ -1872,7 +2104,7 @@ public:
                     )
                 )
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.identifier->position(),
                     "'this' may only be declared as an ordinary function parameter or type-scope (base) object"
                 );
@@ -1886,14 +2118,14 @@ public:
 
             if (this_index >= 0) {
                 if (!n.parent_is_type()) {
-                    errors.emplace_back(
+                    out_errors.emplace_back(
                         n.position(),
                         "'this' must be the first parameter of a type-scope function"
                     );
                     return false;
                 }
                 if (this_index != 0) {
-                    errors.emplace_back(
+                    out_errors.emplace_back(
                         n.position(),
                         "'this' must be the first parameter"
                     );
@@ -1903,14 +2135,14 @@ public:
 
             if (that_index >= 0) {
                 if (!n.parent_is_type()) {
-                    errors.emplace_back(
+                    out_errors.emplace_back(
                         n.position(),
                         "'that' must be the second parameter of a type-scope function"
                     );
                     return false;
                 }
                 if (that_index != 1) {
-                    errors.emplace_back(
+                    out_errors.emplace_back(
                         n.position(),
                         "'that' must be the second parameter"
                     );
@@ -1925,7 +2157,7 @@ public:
             && n.parent_is_namespace()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.identifier->position(),
                 "namespace scope objects must have a concrete type, not a deduced type"
             );
@@ -1939,7 +2171,7 @@ public:
             && !n.is_object_alias()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.identifier->position(),
                 "'_' (wildcard) may not be the name of a function or type - it may only be used as the name of an anonymous object, object alias, or namespace"
             );
@@ -1952,7 +2184,7 @@ public:
             )
         {
             if (!n.is_object()) {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "a member named 'this' declares a base subobject, and must be followed by a base type name"
                 );
@@ -1964,7 +2196,7 @@ public:
                 && !n.is_default_access()
                 )
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "a base type must be public (the default)"
                 );
@@ -1973,7 +2205,7 @@ public:
 
             if (n.has_wildcard_type())
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "a base type must be a specific type, not a deduced type (omitted or '_'-wildcarded)"
                 );
@@ -1986,7 +2218,7 @@ public:
             && !n.parent_is_type()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "an access-specifier is only allowed on a type-scope (member) declaration"
             );
@@ -2001,7 +2233,7 @@ public:
                 && (*func->parameters)[0]->has_name("this")
             );
             if ((*func->parameters)[0]->is_polymorphic()) {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "a constructor may not be declared virtual, override, or final"
                 );
@@ -2017,7 +2249,7 @@ public:
         {
             assert (n.identifier->get_token());
             auto name = n.identifier->get_token()->to_string();
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "(temporary alpha limitation) local functions like '" + name + ": (/*params*/) = {/*body*/}' are not currently supported - write a local variable initialized with an unnamed function like '" + name + " := :(/*params*/) = {/*body*/};' instead (add '=' and ';')"
             );
@@ -2036,7 +2268,7 @@ public:
                 )
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "overloading '" + n.name()->to_string() + "' is not allowed"
             );
@@ -2064,7 +2296,7 @@ public:
                 )
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 n.name()->to_string() + " must have 'this' as the first parameter"
             );
@@ -2101,7 +2333,7 @@ public:
             //  ... and if it isn't that, then complain
             else
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     params[0]->position(),
                     "'main' must be declared as 'main: ()' with zero parameters, or 'main: (args)' with one parameter named 'args' for which the type 'std::vector<std::string_view>' will be deduced"
                 );
@@ -2113,7 +2345,7 @@ public:
         {
             if (!n.is_function())
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "'operator=' must be a function"
                 );
@@ -2123,7 +2355,7 @@ public:
 
             if (func->has_declared_return_type())
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     func->parameters->parameters[0]->position(),
                     "'operator=' may not have a declared return type"
                 );
@@ -2132,7 +2364,7 @@ public:
 
             if (func->parameters->ssize() == 0)
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "an operator= function must have a parameter"
                 );
@@ -2145,7 +2377,7 @@ public:
                 && (*func->parameters)[0]->pass != passing_style::move
                 )
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "an operator= function's 'this' parameter must be inout, out, or move"
                 );
@@ -2159,7 +2391,7 @@ public:
                 && (*func->parameters)[1]->pass != passing_style::move
                 )
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "an operator= function's 'that' parameter must be in or move"
                 );
@@ -2172,7 +2404,7 @@ public:
                 && (*func->parameters)[0]->pass == passing_style::move
                 )
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "a destructor may not have other parameters besides 'this'"
                 );
@@ -2184,7 +2416,7 @@ public:
         {
             if (decl->has_name("that"))
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "'that' may not be used as a type scope name"
                 );
@@ -2197,7 +2429,7 @@ public:
             && !n.has_bool_return_type()
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 n.name()->to_string() + " must return bool"
             );
@@ -2213,7 +2445,7 @@ public:
                 && return_name.find("partial_ordering") == return_name.npos
                 )
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "operator<=> must return std::strong_ordering, std::weak_ordering, or std::partial_ordering"
                 );
@@ -2230,7 +2462,7 @@ public:
                     && !stmt->is_using()
                     )
                 {
-                    errors.emplace_back(
+                    out_errors.emplace_back(
                         stmt->position(),
                         "a user-defined type body must contain only declarations or 'using' statements, not other code"
                     );
@@ -2243,7 +2475,10 @@ public:
     }
 
 
-    auto check(function_type_node const& n)
+    auto check(
+        function_type_node const& n,
+        std::vector<error_entry>& out_errors
+    ) const
         -> bool
     {
         assert(n.parameters);
@@ -2260,7 +2495,7 @@ public:
                 || (*n.parameters)[0]->direction() != passing_style::inout
                 )
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "a user-defined " + n.my_decl->name()->to_string() + " must have a single 'inout' parameter"
                 );
@@ -2268,7 +2503,7 @@ public:
             }
 
             if (n.has_deduced_return_type()) {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "a user-defined " + n.my_decl->name()->to_string() + " must have a specific (not deduced) return type"
                 );
@@ -2280,7 +2515,7 @@ public:
                 && n.my_decl->parent_declaration->cannot_be_a_copy_constructible_type()
                 )
             {
-                errors.emplace_back(
+                out_errors.emplace_back(
                     n.position(),
                     "a user-defined " + n.my_decl->name()->to_string() + " in type scope must be a member of a copyable type"
                 );
@@ -2292,7 +2527,10 @@ public:
     }
 
 
-    auto check(statement_node const& n)
+    auto check(
+        statement_node const&     n,
+        std::vector<error_entry>& out_errors
+    ) const
         -> bool
     {
         if (auto expr_stmt = n.get_if<expression_statement_node>();
@@ -2305,7 +2543,7 @@ public:
                 )
             )
         {
-            errors.emplace_back(
+            out_errors.emplace_back(
                 n.position(),
                 "unused literal or identifier"
             );
@@ -2327,6 +2565,7 @@ public:
     bool                              started_prefix_operators                 = false;
     bool                              is_out_expression                        = false;
     bool                              inside_next_expression                   = false;
+    bool                              inside_postcondition                     = false;
     bool                              inside_parameter_list                    = false;
     bool                              inside_parameter_identifier              = false;
     bool                              inside_returns_list                      = false;
@@ -2403,6 +2642,8 @@ public:
         assert(sym.is_use());
         assert(sym.identifier);
 
+        sym.is_deferred = inside_postcondition;
+
         indices_of_uses_per_scope.back().push_back(cpp2::unsafe_narrow<int>(std::ssize(symbols)));
         symbols.emplace_back(scope_depth, sym);
     }
@@ -2484,6 +2725,17 @@ public:
         inside_next_expression = false;
     }
 
+    auto start(contract_node const& n, int) -> void
+    {
+        assert(n.kind);
+        inside_postcondition = *n.kind == "post";
+    }
+
+    auto end(contract_node const&, int) -> void
+    {
+        inside_postcondition = false;
+    }
+
     auto start(parameter_declaration_list_node const&, int) -> void
     {
         inside_parameter_list = true;
@@ -2704,6 +2956,7 @@ public:
                 auto& sym = std::get<symbol::active::identifier>(symbols[i].sym);
                 assert(sym.is_use());
                 sym.is_captured = true;
+                sym.is_deferred = false;
             }
         }
 
@@ -0,0 +1,533 @@
+//  Copyright (c) Herb Sutter
+//  SPDX-License-Identifier: CC-BY-NC-ND-4.0
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+//===========================================================================
+//  Standard library name -> header table (for -include-std/-import-std)
+//===========================================================================
+
+#ifndef CPP2_STD_HEADERS_H
+#define CPP2_STD_HEADERS_H
+
+#include "common.h"
+
+namespace cpp2 {
+
+//-----------------------------------------------------------------------
+//  std_header: A standard header, and the names directly in std:: that
+//  it declares
+//
+//  header      the header name, e.g. "<vector>"
+//  guard       the feature test cpp2util.h also uses to #include it, if any
+//  in_cpp2util true if cpp2util.h always #includes it, so the Cpp1 file
+//              doesn't need to
+//  names       the names; a namespace (e.g., chrono) stands for all its names
+//
+//  A name that's in several headers is listed only once. A name that isn't
+//  here makes a file fall back to #including every header, so this only
+//  needs to be complete enough to cover the names commonly used
+//
+struct std_header
+{
+    std::string_view              header;
+    std::string_view              guard;
+    bool                          in_cpp2util;
+    std::vector<std::string_view> names;
+};
+
+inline auto std_headers()
+    -> std::vector<std_header> const&
+{
+    static auto const headers = std::vector<std_header>{
+        { "<algorithm>", "", true, {
+            "adjacent_find", "all_of", "any_of", "binary_search", "clamp", "copy",
+            "copy_backward", "copy_if", "copy_n", "count", "count_if", "equal",
+            "equal_range", "fill", "fill_n", "find", "find_end", "find_first_of",
+            "find_if", "find_if_not", "for_each", "for_each_n", "generate",
+            "generate_n", "includes", "inplace_merge", "is_heap", "is_heap_until",
+            "is_partitioned", "is_permutation", "is_sorted", "is_sorted_until",
+            "iter_swap", "lexicographical_compare",
+            "lexicographical_compare_three_way", "lower_bound", "make_heap", "max",
+            "max_element", "merge", "min", "min_element", "minmax", "minmax_element",
+            "mismatch", "move_backward", "next_permutation", "none_of", "nth_element",
+            "partial_sort", "partial_sort_copy", "partition", "partition_copy",
+            "partition_point", "pop_heap", "prev_permutation", "push_heap", "remove",
+            "remove_copy", "remove_copy_if", "remove_if", "replace", "replace_copy",
+            "replace_copy_if", "replace_if", "reverse", "reverse_copy", "rotate",
+            "rotate_copy", "sample", "search", "search_n", "set_difference",
+            "set_intersection", "set_symmetric_difference", "set_union", "shift_left",
+            "shift_right", "shuffle", "sort", "sort_heap", "stable_partition",
+            "stable_sort", "swap_ranges", "transform", "unique", "unique_copy",
+            "upper_bound"
+        } },
+        { "<any>", "", true, {
+            "any", "any_cast", "bad_any_cast", "make_any"
+        } },
+        { "<array>", "", false, {
+            "array", "to_array"
+        } },
+        { "<atomic>", "", false, {
+            "atomic", "atomic_bool", "atomic_flag", "atomic_int", "atomic_llong",
+            "atomic_long", "atomic_ref", "atomic_signal_fence", "atomic_size_t",
+            "atomic_thread_fence", "atomic_uint", "atomic_ullong", "atomic_ulong",
+            "kill_dependency", "memory_order"
+        } },
+        { "<barrier>", "__cpp_lib_barrier", false, {
+            "barrier"
+        } },
+        { "<bit>", "", false, {
+            "bit_cast", "bit_ceil", "bit_floor", "bit_width", "byteswap",
+            "countl_one", "countl_zero", "countr_one", "countr_zero", "endian",
+            "has_single_bit", "popcount", "rotl", "rotr"
+        } },
+        { "<bitset>", "", false, {
+            "bitset"
+        } },
+        { "<cctype>", "", false, {
+            "isalnum", "isalpha", "isblank", "iscntrl", "isdigit", "isgraph",
+            "islower", "isprint", "ispunct", "isspace", "isupper", "isxdigit",
+            "tolower", "toupper"
+        } },
+        { "<charconv>", "", false, {
+            "chars_format", "from_chars", "from_chars_result", "to_chars",
+            "to_chars_result"
+        } },
+        { "<chrono>", "", false, {
+            "chrono", "chrono_literals"
+        } },
+        { "<cinttypes>", "", false, {
+            "imaxabs", "imaxdiv", "strtoimax", "strtoumax"
+        } },
+        { "<clocale>", "", false, {
+            "localeconv", "setlocale"
+        } },
+        { "<cmath>", "", false, {
+            "abs", "acos", "acosh", "asin", "asinh", "atan", "atan2", "atanh",
+            "cbrt", "ceil", "copysign", "cos", "cosh", "erf", "erfc", "exp", "exp2",
+            "expm1", "fabs", "fdim", "floor", "fma", "fmax", "fmin", "fmod",
+            "fpclassify", "frexp", "hypot", "ilogb", "isfinite", "isinf", "isnan",
+            "isnormal", "ldexp", "lerp", "lgamma", "llround", "log", "log10", "log1p",
+            "log2", "logb", "lrint", "lround", "modf", "nearbyint", "nextafter", "pow",
+            "remainder", "remquo", "rint", "round", "scalbn", "signbit", "sin", "sinh",
+            "sqrt", "tan", "tanh", "tgamma", "trunc"
+        } },
+        { "<compare>", "", true, {
+            "compare_three_way", "compare_three_way_result", "is_eq", "is_gt",
+            "is_gteq", "is_lt", "is_lteq", "is_neq", "partial_order",
+            "partial_ordering", "strong_order", "strong_ordering",
+            "three_way_comparable", "three_way_comparable_with", "weak_order",
+            "weak_ordering"
+        } },
+        { "<complex>", "", false, {
+            "complex", "complex_literals"
+        } },
+        { "<concepts>", "", true, {
+            "assignable_from", "common_reference_with", "common_with",
+            "constructible_from", "convertible_to", "copy_constructible", "copyable",
+            "default_initializable", "derived_from", "destructible",
+            "equality_comparable", "equality_comparable_with", "equivalence_relation",
+            "floating_point", "integral", "invocable", "movable", "move_constructible",
+            "predicate", "regular", "regular_invocable", "relation", "same_as",
+            "semiregular", "signed_integral", "strict_weak_order", "swappable",
+            "swappable_with", "totally_ordered", "totally_ordered_with",
+            "unsigned_integral"
+        } },
+        { "<condition_variable>", "", false, {
+            "condition_variable", "condition_variable_any", "cv_status",
+            "notify_all_at_thread_exit"
+        } },
+        { "<coroutine>", "__cpp_lib_coroutine", false, {
+            "coroutine_handle", "coroutine_traits", "noop_coroutine", "suspend_always",
+            "suspend_never"
+        } },
+        { "<cstddef>", "", true, {
+            "byte", "max_align_t", "nullptr_t", "ptrdiff_t", "size_t", "to_integer"
+        } },
+        { "<cstdint>", "", true, {
+            "int16_t", "int32_t", "int64_t", "int8_t", "int_fast16_t", "int_fast32_t",
+            "int_fast64_t", "int_fast8_t", "int_least16_t", "int_least32_t",
+            "int_least64_t", "int_least8_t", "intmax_t", "intptr_t", "uint16_t",
+            "uint32_t", "uint64_t", "uint8_t", "uint_fast16_t", "uint_fast32_t",
+            "uint_fast64_t", "uint_fast8_t", "uint_least16_t", "uint_least32_t",
+            "uint_least64_t", "uint_least8_t", "uintmax_t", "uintptr_t"
+        } },
+        { "<cstdio>", "", true, {
+            "FILE", "fclose", "fflush", "fgets", "fopen", "fprintf", "fputs", "fread",
+            "fwrite", "getchar", "perror", "printf", "putchar", "puts", "scanf",
+            "snprintf", "sprintf", "sscanf"
+        } },
+        { "<cstdlib>", "", false, {
+            "abort", "atexit", "atof", "atoi", "atol", "atoll", "bsearch", "calloc",
+            "div", "exit", "free", "getenv", "labs", "llabs", "malloc", "qsort",
+            "quick_exit", "rand", "realloc", "srand", "strtod", "strtof", "strtol",
+            "strtold", "strtoll", "strtoul", "strtoull", "system"
+        } },
+        { "<cstring>", "", false, {
+            "memchr", "memcmp", "memcpy", "memmove", "memset", "strcat", "strchr",
+            "strcmp", "strcpy", "strerror", "strlen", "strncmp", "strncpy", "strrchr",
+            "strstr", "strtok"
+        } },
+        { "<ctime>", "", false, {
+            "clock", "clock_t", "difftime", "gmtime", "localtime", "mktime",
+            "strftime", "time", "time_t", "tm"
+        } },
+        { "<debugging>", "__cpp_lib_debugging", false, {
+            "breakpoint", "breakpoint_if_debugging", "is_debugger_present"
+        } },
+        { "<deque>", "", false, {
+            "deque"
+        } },
+        { "<exception>", "", true, {
+            "bad_exception", "current_exception", "exception", "exception_ptr",
+            "make_exception_ptr", "nested_exception", "rethrow_exception",
+            "rethrow_if_nested", "set_terminate", "terminate", "throw_with_nested",
+            "uncaught_exceptions"
+        } },
+        { "<expected>", "", true, {
+            "bad_expected_access", "expected", "unexpect", "unexpected"
+        } },
+        { "<filesystem>", "", false, {
+            "filesystem"
+        } },
+        { "<flat_map>", "__cpp_lib_flat_map", false, {
+            "flat_map", "flat_multimap"
+        } },
+        { "<flat_set>", "__cpp_lib_flat_set", false, {
+            "flat_multiset", "flat_set"
+        } },
+        { "<format>", "", true, {
+            "basic_format_string", "format", "format_context", "format_error",
+            "format_string", "format_to", "format_to_n", "formatted_size", "formatter",
+            "make_format_args", "vformat", "vformat_to"
+        } },
+        { "<forward_list>", "", false, {
+            "forward_list"
+        } },
+        { "<fstream>", "", false, {
+            "basic_filebuf", "basic_fstream", "basic_ifstream", "basic_ofstream",
+            "filebuf", "fstream", "ifstream", "ofstream"
+        } },
+        { "<functional>", "", true, {
+            "bad_function_call", "bind", "bind_front", "bit_and", "bit_not", "bit_or",
+            "bit_xor", "boyer_moore_horspool_searcher", "boyer_moore_searcher", "cref",
+            "default_searcher", "divides", "equal_to", "function", "greater",
+            "greater_equal", "hash", "identity", "invoke", "invoke_r", "less",
+            "less_equal", "logical_and", "logical_not", "logical_or", "mem_fn", "minus",
+            "modulus", "move_only_function", "multiplies", "negate", "not_equal_to",
+            "not_fn", "placeholders", "plus", "ref", "reference_wrapper"
+        } },
+        { "<future>", "", false, {
+            "async", "future", "future_error", "future_status", "launch",
+            "packaged_task", "promise", "shared_future"
+        } },
+        { "<generator>", "__cpp_lib_generator", false, {
+            "generator"
+        } },
+        { "<initializer_list>", "", false, {
+            "initializer_list"
+        } },
+        { "<iomanip>", "", false, {
+            "get_money", "get_time", "put_money", "put_time", "quoted",
+            "resetiosflags", "setbase", "setfill", "setiosflags", "setprecision", "setw"
+        } },
+        { "<ios>", "", false, {
+            "basic_ios", "boolalpha", "dec", "defaultfloat", "fixed", "hex", "hexfloat",
+            "internal", "ios", "ios_base", "left", "noboolalpha", "noshowbase", "oct",
+            "right", "scientific", "showbase", "showpoint", "showpos", "skipws",
+            "streamoff", "streamsize", "unitbuf", "uppercase"
+        } },
+        { "<iostream>", "", true, {
+            "cerr", "cin", "clog", "cout", "wcerr", "wcin", "wclog", "wcout"
+        } },
+        { "<istream>", "", false, {
+            "basic_iostream", "basic_istream", "iostream", "istream", "ws"
+        } },
+        { "<iterator>", "", true, {
+            "advance", "back_insert_iterator", "back_inserter", "begin", "bidirectional_iterator",
+            "bidirectional_iterator_tag", "cbegin", "cend", "common_iterator",
+            "contiguous_iterator", "contiguous_iterator_tag", "counted_iterator",
+            "crbegin", "crend", "data", "default_sentinel", "default_sentinel_t",
+            "distance", "empty", "end", "forward_iterator", "forward_iterator_tag",
+            "front_insert_iterator", "front_inserter", "incrementable", "indirectly_readable",
+            "input_iterator", "input_iterator_tag", "insert_iterator", "inserter",
+            "istream_iterator", "istreambuf_iterator", "iter_difference_t",
+            "iter_reference_t", "iter_value_t", "iterator_traits", "make_move_iterator",
+            "make_reverse_iterator", "mergeable", "move_iterator", "next",
+            "ostream_iterator", "ostreambuf_iterator", "output_iterator",
+            "output_iterator_tag", "permutable", "prev", "projected",
+            "random_access_iterator", "random_access_iterator_tag", "rbegin", "rend",
+            "reverse_iterator", "sentinel_for", "size", "sortable", "ssize",
+            "unreachable_sentinel", "weakly_incrementable"
+        } },
+        { "<latch>", "__cpp_lib_latch", false, {
+            "latch"
+        } },
+        { "<limits>", "", true, {
+            "numeric_limits"
+        } },
+        { "<list>", "", false, {
+            "list"
+        } },
+        { "<locale>", "", false, {
+            "ctype", "has_facet", "locale", "numpunct", "use_facet"
+        } },
+        { "<map>", "", false, {
+            "map", "multimap"
+        } },
+        { "<mdspan>", "__cpp_lib_mdspan", false, {
+            "default_accessor", "dextents", "extents", "layout_left", "layout_right",
+            "layout_stride", "mdspan"
+        } },
+        { "<memory>", "", true, {
+            "addressof", "align", "allocate_shared", "allocator", "allocator_traits",
+            "assume_aligned", "bad_weak_ptr", "const_pointer_cast", "construct_at",
+            "default_delete", "destroy", "destroy_at", "dynamic_pointer_cast",
+            "enable_shared_from_this", "inout_ptr", "make_shared", "make_unique",
+            "make_unique_for_overwrite", "out_ptr", "owner_less", "pointer_traits",
+            "reinterpret_pointer_cast", "shared_ptr", "static_pointer_cast",
+            "to_address", "uninitialized_copy", "uninitialized_default_construct",
+            "uninitialized_fill", "uninitialized_move", "uninitialized_value_construct",
+            "unique_ptr", "weak_ptr"
+        } },
+        { "<mutex>", "", false, {
+            "adopt_lock", "call_once", "defer_lock", "lock", "lock_guard", "mutex",
+            "once_flag", "recursive_mutex", "recursive_timed_mutex", "scoped_lock",
+            "timed_mutex", "try_lock", "try_to_lock", "unique_lock"
+        } },
+        { "<new>", "", true, {
+            "align_val_t", "bad_alloc", "bad_array_new_length",
+            "hardware_constructive_interference_size",
+            "hardware_destructive_interference_size", "launder", "nothrow"
+        } },
+        { "<numbers>", "", false, {
+            "numbers"
+        } },
+        { "<numeric>", "", false, {
+            "accumulate", "adjacent_difference", "exclusive_scan", "gcd",
+            "inclusive_scan", "inner_product", "iota", "lcm", "midpoint",
+            "partial_sum", "reduce", "transform_exclusive_scan",
+            "transform_inclusive_scan", "transform_reduce"
+        } },
+        { "<optional>", "", true, {
+            "bad_optional_access", "make_optional", "nullopt", "nullopt_t", "optional"
+        } },
+        { "<ostream>", "", false, {
+            "basic_ostream", "endl", "ends", "flush", "ostream"
+        } },
+        { "<print>", "__cpp_lib_print", false, {
+            "print", "println", "vprint_nonunicode", "vprint_unicode"
+        } },
+        { "<queue>", "", false, {
+            "priority_queue", "queue"
+        } },
+        { "<random>", "", true, {
+            "bernoulli_distribution", "binomial_distribution", "default_random_engine",
+            "discrete_distribution", "exponential_distribution", "generate_canonical",
+            "knuth_b", "minstd_rand", "mt19937", "mt19937_64", "normal_distribution",
+            "poisson_distribution", "random_device", "ranlux24", "ranlux48", "seed_seq",
+            "uniform_int_distribution", "uniform_real_distribution"
+        } },
+        { "<ranges>", "", false, {
+            "ranges", "views"
+        } },
+        { "<ratio>", "", false, {
+            "giga", "kilo", "mega", "micro", "milli", "nano", "ratio", "ratio_add",
+            "ratio_divide", "ratio_multiply", "ratio_subtract"
+        } },
+        { "<regex>", "", false, {
+            "basic_regex", "cmatch", "match_results", "regex", "regex_constants",
+            "regex_error", "regex_match", "regex_replace", "regex_search",
+            "smatch", "sregex_iterator", "sregex_token_iterator", "sub_match", "wregex"
+        } },
+        { "<scoped_allocator>", "", false, {
+            "scoped_allocator_adaptor"
+        } },
+        { "<semaphore>", "__cpp_lib_semaphore", false, {
+            "binary_semaphore", "counting_semaphore"
+        } },
+        { "<set>", "", false, {
+            "multiset", "set"
+        } },
+        { "<shared_mutex>", "", false, {
+            "shared_lock", "shared_mutex", "shared_timed_mutex"
+        } },
+        { "<source_location>", "__cpp_lib_source_location", false, {
+            "source_location"
+        } },
+        { "<span>", "", true, {
+            "as_bytes", "as_writable_bytes", "dynamic_extent", "span"
+        } },
+        { "<spanstream>", "__cpp_lib_spanstream", false, {
+            "ispanstream", "ospanstream", "spanbuf", "spanstream"
+        } },
+        { "<sstream>", "", false, {
+            "basic_istringstream", "basic_ostringstream", "basic_stringstream",
+            "istringstream", "ostringstream", "stringbuf", "stringstream"
+        } },
+        { "<stack>", "", false, {
+            "stack"
+        } },
+        { "<stacktrace>", "__cpp_lib_stacktrace", false, {
+            "basic_stacktrace", "stacktrace", "stacktrace_entry"
+        } },
+        { "<stdexcept>", "", false, {
+            "domain_error", "invalid_argument", "length_error", "logic_error",
+            "out_of_range", "overflow_error", "range_error", "runtime_error",
+            "underflow_error"
+        } },
+        { "<stop_token>", "__cpp_lib_jthread", false, {
+            "nostopstate", "stop_callback", "stop_source", "stop_token"
+        } },
+        { "<streambuf>", "", false, {
+            "basic_streambuf", "streambuf", "wstreambuf"
+        } },
+        { "<string>", "", true, {
+            "basic_string", "char_traits", "getline", "stod", "stof", "stoi", "stol",
+            "stold", "stoll", "stoul", "stoull", "string", "string_literals",
+            "to_string", "to_wstring", "u16string", "u32string", "u8string", "wstring"
+        } },
+        { "<string_view>", "", true, {
+            "basic_string_view", "string_view", "string_view_literals",
+            "u16string_view", "u32string_view", "u8string_view", "wstring_view"
+        } },
+        { "<syncstream>", "__cpp_lib_syncbuf", false, {
+            "basic_osyncstream", "osyncstream", "syncbuf"
+        } },
+        { "<system_error>", "", true, {
+            "errc", "error_category", "error_code", "error_condition",
+            "generic_category", "make_error_code", "system_category", "system_error"
+        } },
+        { "<text_encoding>", "__cpp_lib_text_encoding", false, {
+            "text_encoding"
+        } },
+        { "<thread>", "", false, {
+            "jthread", "this_thread", "thread"
+        } },
+        { "<tuple>", "", true, {
+            "apply", "forward_as_tuple", "ignore", "make_from_tuple", "make_tuple",
+            "tie", "tuple", "tuple_cat", "tuple_element", "tuple_size"
+        } },
+        //  Also covers each trait's _v and _t forms (see std_header_for)
+        { "<type_traits>", "", true, {
+            "add_const", "add_cv", "add_lvalue_reference", "add_pointer",
+            "add_rvalue_reference", "add_volatile", "aligned_storage", "alignment_of",
+            "bool_constant", "common_reference", "common_type", "conditional",
+            "conjunction", "decay", "disjunction", "enable_if", "extent", "false_type",
+            "has_unique_object_representations", "has_virtual_destructor",
+            "integral_constant", "invoke_result", "is_abstract", "is_aggregate",
+            "is_arithmetic", "is_array", "is_assignable", "is_base_of",
+            "is_bounded_array", "is_class", "is_compound", "is_const",
+            "is_constant_evaluated", "is_constructible", "is_convertible",
+            "is_copy_assignable", "is_copy_constructible", "is_default_constructible",
+            "is_destructible", "is_empty", "is_enum", "is_final", "is_floating_point",
+            "is_function", "is_fundamental", "is_integral", "is_invocable",
+            "is_invocable_r", "is_lvalue_reference", "is_member_function_pointer",
+            "is_member_object_pointer", "is_member_pointer", "is_move_assignable",
+            "is_move_constructible", "is_nothrow_assignable",
+            "is_nothrow_constructible", "is_nothrow_convertible",
+            "is_nothrow_copy_assignable", "is_nothrow_copy_constructible",
+            "is_nothrow_default_constructible", "is_nothrow_destructible",
+            "is_nothrow_invocable", "is_nothrow_move_assignable",
+            "is_nothrow_move_constructible", "is_nothrow_swappable", "is_null_pointer",
+            "is_object", "is_pointer", "is_polymorphic", "is_reference",
+            "is_rvalue_reference", "is_same", "is_scalar", "is_scoped_enum",
+            "is_signed", "is_standard_layout", "is_swappable", "is_trivial",
+            "is_trivially_assignable", "is_trivially_constructible",
+            "is_trivially_copy_assignable", "is_trivially_copy_constructible",
+            "is_trivially_copyable", "is_trivially_default_constructible",
+            "is_trivially_destructible", "is_trivially_move_assignable",
+            "is_trivially_move_constructible", "is_unbounded_array", "is_union",
+            "is_unsigned", "is_void", "is_volatile", "make_signed", "make_unsigned",
+            "negation", "rank", "remove_all_extents", "remove_const", "remove_cv",
+            "remove_cvref", "remove_extent", "remove_pointer", "remove_reference",
+            "remove_volatile", "true_type", "type_identity", "underlying_type", "void_t"
+        } },
+        { "<typeindex>", "", false, {
+            "type_index"
+        } },
+        { "<typeinfo>", "", true, {
+            "bad_cast", "bad_typeid", "type_info"
+        } },
+        { "<unordered_map>", "", false, {
+            "unordered_map", "unordered_multimap"
+        } },
+        { "<unordered_set>", "", false, {
+            "unordered_multiset", "unordered_set"
+        } },
+        { "<utility>", "", true, {
+            "as_const", "cmp_equal", "cmp_greater", "cmp_greater_equal", "cmp_less",
+            "cmp_less_equal", "cmp_not_equal", "declval", "exchange", "forward",
+            "forward_like", "get", "in_place", "in_place_index", "in_place_t",
+            "in_place_type", "in_range", "index_sequence", "index_sequence_for",
+            "integer_sequence", "make_index_sequence", "make_integer_sequence",
+            "make_pair", "move", "move_if_noexcept", "pair", "piecewise_construct",
+            "swap", "to_underlying", "unreachable"
+        } },
+        { "<valarray>", "", false, {
+            "gslice", "slice", "valarray"
+        } },
+        { "<variant>", "", true, {
+            "bad_variant_access", "get_if", "holds_alternative", "monostate", "variant",
+            "variant_alternative", "variant_npos", "variant_size", "visit"
+        } },
+        { "<vector>", "", true, {
+            "vector"
+        } }
+    };
+    return headers;
+}
+
+
+//-----------------------------------------------------------------------
+//  std_header_for: The header that declares std::name, or null if the
+//  name isn't in the table
+//
+inline auto std_header_for(std::string_view name)
+    -> std_header const*
+{
+    static auto const by_name = []{
+        auto ret = std::unordered_map<std::string_view, std_header const*>{};
+        for (auto const& h : std_headers()) {
+            for (auto n : h.names) {
+                [[maybe_unused]] auto inserted = ret.emplace(n, &h).second;
+                assert(inserted && "each name must be listed only once");
+            }
+        }
+        return ret;
+    }();
+
+    if (auto i = by_name.find(name); i != by_name.end()) {
+        return i->second;
+    }
+
+    //  A type trait's _v or _t form
+    if (
+        name.ends_with("_v")
+        || name.ends_with("_t")
+        )
+    {
+        name.remove_suffix(2);
+        if (
+            auto i = by_name.find(name);
+            i != by_name.end()
+            && i->second->header == "<type_traits>"
+            )
+        {
+            return i->second;
+        }
+    }
+
+    return {};
+}
+
+}
+
+#endif
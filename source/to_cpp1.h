@@ -19,7 +19,15 @@
 #define CPP2_TO_CPP1_H
 
 #include "sema.h"
+#include "std_headers.h"
+#include <atomic>
+#include <charconv>
 #include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
 
 namespace cpp2 {
 
@@ -71,4862 +79,7880 @@ auto multi_return_type_name(declaration_node const& n)
 
 //-----------------------------------------------------------------------
 //
-//  positional_printer: a Syntax 1 pretty printer
+//  translation_options: Options that control how a file is lowered
 //
 //-----------------------------------------------------------------------
 //
-static auto flag_emit_cppfront_info = false;
+//  The command line flags below set cmdline_options, which the command
+//  line compiler uses for all its files; library users pass their own
+//
+struct translation_options
+{
+    bool        emit_cppfront_info  = false;
+    bool        clean_cpp1          = false;
+    bool        line_paths          = false;
+    bool        import_std          = false;
+    bool        include_std         = false;
+    bool        cpp2_only           = false;
+    bool        safe_null_pointers  = true;
+    bool        safe_subscripts     = true;
+    bool        safe_comparisons    = true;
+    bool        use_source_location = false;
+    bool        use_source_sites    = false;
+    std::string cpp1_filename       = {};
+    bool        no_exceptions       = false;
+    bool        no_rtti             = false;
+    bool        string_view_params  = false;
+    std::string whole_program       = {};   // manifest of the program's source files
+    bool        infer_purity        = false;
+    bool        report_checks       = false;    // record the checks for print_safety_report
+    int         lowering_jobs       = 1;
+};
+
+static auto cmdline_options = translation_options{};
+
 static cmdline_processor::register_flag cmd_emit_cppfront_info(
     8,
     "emit-cppfront-info",
     "Emit cppfront version/build in Cpp1 file",
-    []{ flag_emit_cppfront_info = true; }
+    []{ cmdline_options.emit_cppfront_info = true; }
 );
 
-static auto flag_clean_cpp1 = false;
 static cmdline_processor::register_flag cmd_clean_cpp1(
     8,
     "clean-cpp1",
     "Emit clean Cpp1 without #line directives",
-    []{ flag_clean_cpp1 = true; }
+    []{ cmdline_options.clean_cpp1 = true; }
 );
 
-static auto flag_line_paths = false;
 static cmdline_processor::register_flag cmd_line_paths(
     8,
     "line-paths",
     "Emit absolute paths in #line directives",
-    [] { flag_line_paths = true; }
+    [] { cmdline_options.line_paths = true; }
 );
 
-static auto flag_import_std = false;
 static cmdline_processor::register_flag cmd_import_std(
     0,
     "import-std",
     "import all std:: via 'import std;' - ignored if -include-std is set",
-    []{ flag_import_std = true; }
+    []{ cmdline_options.import_std = true; }
 );
 
-static auto flag_include_std = false;
 static cmdline_processor::register_flag cmd_include_std(
     0,
     "include-std",
-    "#include all std:: headers",
-    []{ flag_include_std = true; }
+    "#include the std:: headers used (all, if any are unknown)",
+    []{ cmdline_options.include_std = true; }
 );
 
-static auto flag_cpp2_only = false;
 static cmdline_processor::register_flag cmd_cpp2_only(
     0,
     "pure-cpp2",
     "Allow Cpp2 syntax only - also sets -import-std",
-    []{ flag_cpp2_only = true; flag_import_std = true; }
+    []{ cmdline_options.cpp2_only = true; cmdline_options.import_std = true; }
 );
 
-static auto flag_safe_null_pointers = true;
 static cmdline_processor::register_flag cmd_safe_null_pointers(
     2,
     "no-null-checks",
     "Disable null safety checks",
-    []{ flag_safe_null_pointers = false; }
+    []{ cmdline_options.safe_null_pointers = false; }
 );
 
-static auto flag_safe_subscripts = true;
 static cmdline_processor::register_flag cmd_safe_subscripts(
     2,
     "no-subscript-checks",
     "Disable subscript safety checks",
-    []{ flag_safe_subscripts = false; }
+    []{ cmdline_options.safe_subscripts = false; }
 );
 
-static auto flag_safe_comparisons = true;
 static cmdline_processor::register_flag cmd_safe_comparisons(
     2,
     "no-comparison-checks",
     "Disable mixed-sign comparison safety checks",
-    []{ flag_safe_comparisons = false; }
+    []{ cmdline_options.safe_comparisons = false; }
 );
 
-static auto flag_use_source_location = false;
 static cmdline_processor::register_flag cmd_enable_source_info(
     2,
     "add-source-info",
     "Enable source_location information for contract checks",
-    []{ flag_use_source_location = true; }
+    []{ cmdline_options.use_source_location = true; }
+);
+
+static cmdline_processor::register_flag cmd_source_sites(
+    2,
+    "source-sites",
+    "Report check locations from a per-file table - cheaper than -add-source-info",
+    []{ cmdline_options.use_source_sites = true; }
 );
 
-static auto flag_cpp1_filename = std::string{};
 static cmdline_processor::register_flag cmd_cpp1_filename(
     8,
     "output filename",
     "Output to 'filename' (can be 'stdout') - default is *.cpp/*.h",
     nullptr,
-    [](std::string const& name) { flag_cpp1_filename = name; }
+    [](std::string const& name) { cmdline_options.cpp1_filename = name; }
 );
 
-static auto flag_no_exceptions = false;
 static cmdline_processor::register_flag cmd_no_exceptions(
     4,
     "fno-exceptions",
     "Disable C++ EH - failed 'as' for 'variant' will assert",
-    []{ flag_no_exceptions = true; }
+    []{ cmdline_options.no_exceptions = true; }
 );
 
-static auto flag_no_rtti = false;
 static cmdline_processor::register_flag cmd_no_rtti(
     4,
     "fno-rtti",
     "Disable C++ RTTI - using 'as' for '*'/'std::any' will assert",
-    []{ flag_no_rtti = true; }
+    []{ cmdline_options.no_rtti = true; }
 );
 
-struct text_with_pos{
-    std::string     text;
-    source_position pos;
-    text_with_pos(std::string const& t, source_position p) : text{t}, pos{p} { }
-};
+static cmdline_processor::register_flag cmd_string_view_params(
+    8,
+    "string-view-params",
+    "Emit std::string_view for 'in std::string' parameters used only as views",
+    []{ cmdline_options.string_view_params = true; }
+);
 
-class positional_printer
-{
-public:
-    positional_printer()                          = default;
-private:
-    positional_printer(positional_printer const&) = delete;
-    void operator=(positional_printer const&)     = delete;
+static cmdline_processor::register_flag cmd_whole_program(
+    8,
+    "whole-program manifest",
+    "Infer internal linkage and 'final' from all sources listed in 'manifest'",
+    nullptr,
+    [](std::string const& manifest) { cmdline_options.whole_program = manifest; }
+);
 
-    //  Core information
-    std::ofstream               out_file        = {}; // Cpp1 syntax output file
-    std::ostream*               out             = {}; // will point to out_file or cout
-    std::string                 cpp2_filename   = {};
-    std::string                 cpp1_filename   = {};
-    std::vector<comment> const* pcomments       = {}; // Cpp2 comments data
-    source const*               psource         = {};
-    parser const*               pparser         = {};
+static cmdline_processor::register_flag cmd_mark_purity(
+    8,
+    "mark-purity",
+    "Mark functions that have no effects and don't throw as const or pure",
+    []{ cmdline_options.infer_purity = true; }
+);
 
-    source_position curr_pos                    = {}; // current (line,col) in output
-    lineno_t        generated_pos_line          = {}; // current line in generated output
-    int             last_line_indentation       = {};
-    int             next_comment                = 0;  // index of the next comment not yet printed
-    bool            last_was_empty              = false;
-    int             empty_lines_suppressed      = 0;
-    bool            just_printed_line_directive = false;
-    bool            printed_extra               = false;
-    char            last_printed_char           = {};
+static cmdline_processor::register_flag cmd_lowering_jobs(
+    9,
+    "jobs n",
+    "Lower function definitions using n threads (0 = one per core)",
+    nullptr,
+    [](std::string const& n) {
+        auto jobs = 0;
+        if (
+            std::from_chars(n.data(), n.data() + n.size(), jobs).ec == std::errc{}
+            && jobs >= 0
+            )
+        {
+            cmdline_options.lowering_jobs = jobs;
+        }
+    }
+);
 
-    struct req_act_info {
-        colno_t requested;
-        colno_t offset;
 
-        req_act_info(colno_t r, colno_t o) : requested{r}, offset{o} { }
-    };
-    struct {
-        lineno_t line = {};
-        std::vector<req_act_info> requests = {};
-    } prev_line_info = {};
+//-----------------------------------------------------------------------
+//
+//  string_view_param_finder: Finds the 'in std::string' parameters
+//  that -string-view-params can lower to std::string_view
+//
+//-----------------------------------------------------------------------
+//
+//  A parameter qualifies only if every use of it is one that
+//  std::string_view supports with the same meaning: a call to one of
+//  the read-only member functions below, a subscript, a comparison,
+//  an operand of <<, the range of a for loop, a string interpolation, or
+//  an argument to a search such as 'other_param.starts_with(param)'.
+//  Anything else (passing it on, returning it, capturing it, taking its
+//  address, ...) leaves the parameter as cpp2::impl::in<std::string>.
+//
+//  The function's signature changes too, so its name also has to be used
+//  only to call it directly, as in 'f(x)'. An overload, taking its
+//  address, passing it as an argument or template argument, or calling it
+//  as a member ('x.f()') could depend on the exact signature.
+//
+class string_view_param_finder
+{
+    enum class context { transparent, comparison, stream, for_range, view_argument, other };
 
-    //  Position override information
-    std::vector<source_position> preempt_pos = {};  // use this position instead of the next supplied one
-    int             pad_for_this_line   = 0;        // extra padding to add/subtract for this line only
-    bool            ignore_align        = false;
-    int             ignore_align_indent = 0;
-    lineno_t        ignore_align_lineno = 0;
-    bool            enable_indent_heuristic = true;
+    struct candidate {
+        parameter_declaration_node const* param;
+        bool                              ok = true;
+    };
 
-public:
-    //  Modal information
-    enum phases {
-        phase0_type_decls           = 0,
-        phase1_type_defs_func_decls = 1,
-        phase2_func_defs            = 2
+    struct function_frame {
+        declaration_node const* decl;
+        std::vector<candidate>  candidates;
     };
-    auto get_phase() const { return phase; }
 
-private:
-    phases phase = phase0_type_decls;
+    std::vector<context>                            contexts  = {};
+    std::vector<function_frame>                     functions = {};
+    expression_node const*                          for_range = {};
+    std::vector<parameter_declaration_node const*>& found;
 
-    auto inc_phase() -> void {
-        switch (phase) {
-        break;case phase0_type_decls          : phase = phase1_type_defs_func_decls;
-        break;case phase1_type_defs_func_decls: phase = phase2_func_defs;
-        break;default                         : assert(!"ICE: invalid lowering phase");
+    //  For each name, how many of its tokens are anything other than the
+    //  callee of a direct call (including any declarations of it), and the
+    //  text that isn't tokenized but could still use a name
+    std::unordered_map<std::string_view, int>       non_call_uses = {};
+    std::vector<std::string_view>                   opaque_text   = {};
+
+    auto count_non_call_uses(std::map<lineno_t, std::vector<token>> const& map)
+        -> void
+    {
+        for (auto const& [line, toks] : map) {
+            for (auto i = std::ptrdiff_t{0}; i < std::ssize(toks); ++i)
+            {
+                auto const& t = toks[i];
+                if (t.type() == lexeme::StringLiteral) {
+                    opaque_text.push_back(t.as_string_view());
+                }
+                if (t.type() != lexeme::Identifier) {
+                    continue;
+                }
+                auto direct_call =
+                    i + 1 < std::ssize(toks)
+                    && toks[i + 1].type() == lexeme::LeftParen
+                    && (
+                        i == 0
+                        || (
+                            toks[i - 1].type() != lexeme::Dot
+                            && toks[i - 1].type() != lexeme::Scope
+                            )
+                        );
+                if (!direct_call) {
+                    ++non_call_uses[t.as_string_view()];
+                }
+            }
         }
-        curr_pos     = {};
-        next_comment = 0;   // start over with the comments
     }
 
-    std::vector<std::string*>                emit_string_targets;       // option to emit to string instead of out file
-    std::vector<std::vector<text_with_pos>*> emit_text_chunks_targets;  // similar for vector<text_pos>
+    auto is_only_called_directly(declaration_node const& n) const
+        -> bool
+    {
+        assert(n.name());
+        auto name = n.name()->as_string_view();
 
-    enum class target_type { string, chunks };
-    std::vector<target_type>                 emit_target_stack;         // to interleave them sensibly
+        //  Its own declaration is the one use that isn't a call
+        if (
+            auto uses = non_call_uses.find(name);
+            uses != non_call_uses.end()
+            && uses->second > 1
+            )
+        {
+            return false;
+        }
+        return std::ranges::none_of(opaque_text, [&](std::string_view text) {
+            return text.find(name) != std::string_view::npos;
+        });
+    }
 
+    static auto is_view_member_function(std::string_view name)
+        -> bool
+    {
+        static constexpr std::string_view names[] = {
+            "at", "back", "begin", "cbegin", "cend", "compare", "contains", "copy",
+            "crbegin", "crend", "empty", "end", "ends_with", "find", "find_first_not_of",
+            "find_first_of", "find_last_not_of", "find_last_of", "front", "length",
+            "max_size", "rbegin", "rend", "rfind", "size", "ssize", "starts_with"
+        };
+        return std::find(std::begin(names), std::end(names), name) != std::end(names);
+    }
 
-    //-----------------------------------------------------------------------
-    //  Print text
-    //
-    auto print(
-        std::string_view s,
-        source_position  pos = source_position{},
-        bool             track_curr_pos = true,
-        bool             is_known_empty = false
-    )
-        -> void
+    static auto is_view_search_function(std::string_view name)
+        -> bool
     {
-        //  Take ownership of (and reset) just_printed_line_directive value
-        auto line_directive_already_done = std::exchange(just_printed_line_directive, false);
+        return
+            name == "compare" || name == "contains" || name == "starts_with" || name == "ends_with"
+            || name == "find" || name == "rfind" || name.starts_with("find_");
+    }
 
-        //  If the caller is capturing this output, emit to the
-        //  current target instead and skip most positioning logic
-        if (!emit_target_stack.empty())
-        {
-            //  If capturing to a string, emit to the specified string
-            if (emit_target_stack.back() == target_type::string) {
-                assert(!emit_string_targets.empty());
-                *emit_string_targets.back() += s;
+    auto is_candidate_name(token const& name) const
+        -> bool
+    {
+        for (auto const& f : functions) {
+            for (auto const& c : f.candidates) {
+                if (c.param->has_name(name.as_string_view())) {
+                    return true;
+                }
             }
+        }
+        return false;
+    }
 
-            //  If capturing to a vector of chunks, emit to that
-            else {
-                assert(!emit_text_chunks_targets.empty());
-                emit_text_chunks_targets.back()->insert( emit_text_chunks_targets.back()->begin(), text_with_pos(std::string(s), pos) );
+    auto is_view_compatible_use(postfix_expression_node const& n) const
+        -> bool
+    {
+        //  A bare use is decided by the nearest enclosing expression that does something
+        if (n.ops.empty()) {
+            for (auto c = contexts.rbegin(); c != contexts.rend(); ++c) {
+                if (*c != context::transparent) {
+                    return *c != context::other;
+                }
             }
-
-            return;
+            return false;
         }
 
-        //  Otherwise, we'll actually print the string to the output file
-        //  and update our curr_pos position
-
-        if (s.length() > 0) {
-            last_printed_char = s.back();
+        auto const& op = n.ops.front();
+        if (op.op->type() == lexeme::LeftBracket) {
+            return true;
         }
+        return
+            op.op->type() == lexeme::Dot
+            && op.id_expr
+            && op.id_expr->is_unqualified()
+            && is_view_member_function(op.id_expr->to_string())
+            && std::ssize(n.ops) > 1
+            && n.ops[1].op->type() == lexeme::LeftParen;
+    }
 
-        //  Reject consecutive empty lines: If this line is empty
-        if (
-            ( s == "\n" || is_known_empty )
-            && curr_pos.colno <= 1
-            )
-        {
-            //  And so was the last one, update logical position only
-            //  and increment empty_lines_suppressed instead of printing
-            if (last_was_empty) {
-                if (track_curr_pos) {
-                    ++curr_pos.lineno;
-                    curr_pos.colno = 1;
+    auto reject_named(token const& name, declaration_node const* except = {})
+        -> void
+    {
+        for (auto& f : functions) {
+            for (auto& c : f.candidates) {
+                if (
+                    c.param->declaration.get() != except
+                    && c.param->has_name(name.as_string_view())
+                    )
+                {
+                    c.ok = false;
                 }
-                ++empty_lines_suppressed;
-                return;
             }
-            //  If this is the first consecutive empty, remember and continue
-            last_was_empty = true;
         }
-        //  Otherwise, if this line is not empty
-        else {
-            //  Remember that this line was not empty
-            last_was_empty = false;
+    }
 
-            //  And if we did suppress any empties, emit a #line to resync
-            if (empty_lines_suppressed > 0) {
-                if (!line_directive_already_done) {
-                    print_line_directive(curr_pos.lineno);
-                }
-                empty_lines_suppressed = 0;
+public:
+    string_view_param_finder(
+        std::vector<parameter_declaration_node const*>& found_,
+        source const&                                   source_,
+        tokens const&                                   tokens_,
+        parser const&                                   parser_
+    )
+        : found{found_}
+    {
+        for (auto const& line : source_.get_lines()) {
+            if (line.cat == source_line::category::cpp1) {
+                opaque_text.push_back(line.text);
             }
         }
+        count_non_call_uses(tokens_.get_map());
+        for (auto const& lexer : parser_.get_generated_lexers()) {
+            count_non_call_uses(lexer.get_map());
+        }
+    }
 
-        //  Output the string
-        assert (out);
-        *out << s;
+    auto start(declaration_node const& n, int) -> void
+    {
+        //  Any other declaration of a candidate's name hides it somewhere
+        if (auto name = n.name()) {
+            reject_named(*name, &n);
+        }
 
-        //  Update curr_pos by finding how many line breaks s contained,
-        //  and where the last one was which determines our current colno
-        if (track_curr_pos)
+        auto frame = function_frame{ &n, {} };
+        if (
+            n.is_function()
+            && n.initializer
+            && !n.is_virtual_function()
+            && !n.parent_is_polymorphic()
+            && n.name()
+            && is_only_called_directly(n)
+            )
         {
-            auto last_newline = std::string::npos;  // the last newline we found in the string
-            auto newline_pos  = std::size_t(0);     // the current newline we found in the string
-            while ((newline_pos = s.find('\n', newline_pos)) != std::string::npos)
+            auto const& func = std::get<declaration_node::a_function>(n.type);
+            assert(func && func->parameters);
+            for (auto const& param : func->parameters->parameters)
             {
-                //  For each line break we find, reset pad and inc current lineno
-                pad_for_this_line = 0;
-                ++curr_pos.lineno;
-                last_newline = newline_pos;
-                ++newline_pos;
-            }
-
-            //  Now also adjust the colno
-            if (last_newline != std::string::npos) {
-                //  If we found a newline, it's the distance from the last newline to EOL
-                curr_pos.colno = unsafe_narrow<colno_t>(s.length() - last_newline);
-            }
-            else {
-                //  Else add the length of the string
-                curr_pos.colno += unsafe_narrow<colno_t>(s.length());
+                assert(param && param->declaration);
+                if (
+                    param->pass == passing_style::in
+                    && param->declaration->is_object()
+                    && !param->declaration->is_variadic
+                    && param->has_name()
+                    && !param->has_name("_")
+                    && std::get<declaration_node::an_object>(param->declaration->type)->to_string() == "std::string"
+                    )
+                {
+                    frame.candidates.push_back({ param.get() });
+                }
             }
         }
+        functions.push_back(std::move(frame));
+        contexts.push_back(context::other);
     }
 
-
-    //-----------------------------------------------------------------------
-    //  Internal helpers
-
-    //  Start a new line if we're not in col 1 already
-    //
-    auto ensure_at_start_of_new_line()
-        -> void
+    auto end(declaration_node const& n, int) -> void
     {
-        if (curr_pos.colno > 1) {
-            auto old_pos = curr_pos;
-            print( "\n" );
-            assert(curr_pos.lineno == old_pos.lineno+1);
-            assert(curr_pos.colno == 1);
+        assert(!functions.empty() && functions.back().decl == &n);
+        for (auto const& c : functions.back().candidates) {
+            if (c.ok) {
+                found.push_back(c.param);
+            }
         }
+        functions.pop_back();
+        contexts.pop_back();
     }
 
-    //  Print a #line directive
-    //
-    auto print_line_directive( lineno_t line )
-        -> void
+    auto start(postfix_expression_node const& n, int) -> void
     {
-        //  Ignore requests from generated code (negative line numbers)
-        if (line < 1) {
-            return;
+        assert(n.expr);
+        auto id = n.expr->get_token();
+        if (
+            id
+            && (n.expr->is_identifier() || n.expr->is_unqualified_id())
+            && n.expr->template_arguments().empty()
+            )
+        {
+            if (!is_view_compatible_use(n)) {
+                reject_named(*id);
+            }
+        }
+        else {
+            id = nullptr;
         }
 
-        //  Otherwise, implement the request
-        prev_line_info = { curr_pos.lineno, { } };
-        ensure_at_start_of_new_line();
-
-        //  Not using print() here because this is transparent to the curr_pos
-        if (!flag_clean_cpp1) {
-            assert (out);
-            *out << "#line " << line << " " << std::quoted(cpp2_filename) << "\n";
+        //  The arguments of these calls can be views: string interpolations
+        //  lower to the first two, and std::string has the same overloads
+        //  taking a view as std::string_view has for the rest
+        auto c = context::other;
+        if (
+            std::ssize(n.ops) == 1
+            && n.ops.front().op->type() == lexeme::LeftParen
+            && (
+                n.expr->to_string() == "cpp2::to_string"
+                || n.expr->to_string() == "cpp2::impl::format"
+                )
+            )
+        {
+            c = context::view_argument;
         }
-        just_printed_line_directive = true;
+        else if (
+            id
+            && is_candidate_name(*id)
+            && std::ssize(n.ops) == 2
+            && n.ops[0].op->type() == lexeme::Dot
+            && n.ops[1].op->type() == lexeme::LeftParen
+            && is_view_search_function(n.ops[0].id_expr->to_string())
+            )
+        {
+            c = context::view_argument;
+        }
+        contexts.push_back(c);
     }
 
-    //  Catch up with comment/blank lines
-    //
-    auto print_comment(comment const& c)
-        -> void
+    auto start(iteration_statement_node const& n, int) -> void
     {
-        //  For a line comment, start it at the right indentation and print it
-        //  with a newline end
-        if (c.kind == comment::comment_kind::line_comment) {
-            print( pad( c.start.colno - curr_pos.colno + 1 ) );
-            print( c.text );
-            assert( c.text.find("\n") == std::string::npos );  // we shouldn't have newlines
-            print("\n");
-        }
+        for_range = n.range.get();
+        contexts.push_back(context::other);
+    }
 
-        //  For a stream comment, pad out to its column (if we haven't passed it already)
-        //  and emit it there
-        else {
-            print( pad( c.start.colno - curr_pos.colno ) );
-            print( c.text );
+    auto start(expression_node const& n, int) -> void
+    {
+        contexts.push_back(&n == for_range ? context::for_range : context::transparent);
+    }
+
+    template<String Name, typename Term>
+    auto start(binary_expression_node<Name, Term> const& n, int) -> void
+    {
+        constexpr auto name = std::string_view{Name.value};
+        auto c = context::other;
+        if (n.terms.empty()) {
+            c = context::transparent;
+        }
+        else if (name == "equality" || name == "relational" || name == "compare") {
+            c = context::comparison;
         }
+        else if (
+            name == "shift"
+            && std::ranges::all_of(n.terms, [](auto const& t) { return *t.op == "<<"; })
+            )
+        {
+            c = context::stream;
+        }
+        contexts.push_back(c);
+    }
 
-        c.dbg_was_printed = true;
+    auto start(is_as_expression_node const& n, int) -> void
+    {
+        contexts.push_back(n.ops.empty() ? context::transparent : context::other);
     }
 
-    auto flush_comments( source_position pos )
-        -> void
+    auto start(prefix_expression_node const& n, int) -> void
     {
-        if (!pcomments) {
-            return;
-        }
+        contexts.push_back(n.ops.empty() ? context::transparent : context::other);
+    }
 
-        //  For convenience
-        auto& comments = *pcomments;
+    template<typename T>
+    auto start(T const&, int) -> void
+        requires std::is_same_v<T, primary_expression_node>
+                 || std::is_same_v<T, expression_list_node>
+                 || std::is_same_v<T, expression_list_node::term>
+    {
+        contexts.push_back(context::transparent);
+    }
 
-        //  Add unprinted comments and blank lines as needed to catch up vertically
-        //
-        while (curr_pos.lineno < pos.lineno)
-        {
-            //  If a comment goes on this line, print it
-            if (
-                next_comment < std::ssize(comments)
-                && comments[next_comment].start.lineno <= curr_pos.lineno
-                )
-            {
-                //  Emit non-function body comments in phase1_type_defs_func_decls,
-                //  and emit function body comments in phase2_func_defs
-                assert(pparser);
-                if (
-                    (
-                        phase == phase1_type_defs_func_decls
-                        && !pparser->is_within_function_body( comments[next_comment].start.lineno )
-                        )
-                    ||
-                    (
-                        phase == phase2_func_defs
-                        && pparser->is_within_function_body( comments[next_comment].start.lineno )
-                        )
-                    )
-                {
-                    print_comment( comments[next_comment] );
-                    assert(curr_pos.lineno <= pos.lineno);  // we shouldn't have overshot
-                }
+    auto start(token const&, int) -> void
+    {
+    }
 
-                ++next_comment;
-            }
+    auto start(auto const&, int) -> void
+    {
+        contexts.push_back(context::other);
+    }
 
-            //  Otherwise, just print a blank line
-            else {
-                print("\n");
-            }
-        }
+    auto end(auto const&, int) -> void
+    {
+        assert(!contexts.empty());
+        contexts.pop_back();
     }
+};
 
-    auto print_unprinted_comments()
+
+//-----------------------------------------------------------------------
+//
+//  out_of_line_token_finder: Finds the tokens in the nested types that are
+//  defined out of line (see declaration_node::type_define_out_of_line),
+//  whose names a .h2's .h doesn't need declared
+//
+//-----------------------------------------------------------------------
+//
+class out_of_line_token_finder
+{
+    int                               depth = 0;    // of out-of-line types we're in
+    std::unordered_set<token const*>& found;
+
+public:
+    out_of_line_token_finder(std::unordered_set<token const*>& found_)
+        : found{found_}
+    { }
+
+    auto start(declaration_node const& n, int) -> void
     {
-        for (auto const& c : *pcomments) {
-            if (!c.dbg_was_printed) {
-                print_comment(c);
-            }
+        if (n.is_type_defined_out_of_line()) {
+            ++depth;
         }
     }
 
-    //  Position ourselves as close to pos as possible,
-    //  and catch up with displaying comments
-    //
-    auto align_to( source_position pos )
-        -> void
+    auto end(declaration_node const& n, int) -> void
     {
-        auto on_same_line = curr_pos.lineno == pos.lineno;
+        if (n.is_type_defined_out_of_line()) {
+            --depth;
+        }
+    }
 
-        //  Ignoring this logic is used when we're generating new code sections,
-        //  such as return value structs, and emitting raw string literals
-        if (ignore_align) {
-            print( pad( ignore_align_indent - curr_pos.colno ) );
-            return;
+    auto start(token const& t, int) -> void
+    {
+        if (depth > 0) {
+            found.insert(&t);
         }
+    }
 
-        //  Otherwise, we need to apply our usual alignment logic
+    auto start(auto const&, int) -> void { }
+    auto end  (auto const&, int) -> void { }
+};
 
-        //  Catch up with displaying comments
-        flush_comments( pos );
 
-        //  If we're not on the right line
-        if (
-            printed_extra
-            && !on_same_line
-            )
-        {
-            print_line_directive(pos.lineno);
-            curr_pos.lineno = pos.lineno;
-            printed_extra = false;
+//-----------------------------------------------------------------------
+//
+//  whole_program_index: What -whole-program knows about all of the
+//  program's source files, as listed in its manifest
+//
+//-----------------------------------------------------------------------
+//
+//  The manifest lists one source file per line (.cpp2, .h2, or Cpp1),
+//  relative to the manifest's directory; blank lines and lines starting
+//  with # are ignored.
+//
+//  The index is textual and deliberately conservative: every identifier
+//  anywhere in a file, including in comments and strings, counts as a
+//  use from that file, and every identifier in a base list (Cpp2 'this:'
+//  members and Cpp1 'class D : B') counts as a type that has derived types
+//
+class whole_program_index
+{
+    struct source_file {
+        std::filesystem::path           path;
+        std::unordered_set<std::string> names;
+    };
+    std::vector<source_file>        files;
+    std::unordered_set<std::string> base_names;
+
+    //  The manifest and each file it lists, as they were when read
+    struct stamp {
+        std::filesystem::path           path;
+        std::filesystem::file_time_type time;
+        std::uintmax_t                  size;
+
+        auto operator==(stamp const&) const -> bool = default;
+    };
+    std::vector<stamp> inputs;
+
+    static auto stamp_of(std::filesystem::path const& path)
+        -> std::optional<stamp>
+    {
+        auto ec   = std::error_code{};
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) {
+            return {};
         }
-        else if (curr_pos.lineno < pos.lineno)
-        {
-            //  In case we're just one away, try a blank line
-            //  (this might get ignored and we'll get the line directive)
-            print( "\n" );
-            if (curr_pos.lineno != pos.lineno) {
-                print_line_directive(pos.lineno);
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return {};
+        }
+        return stamp{ path, time, size };
+    }
+
+    //  Are the manifest and the files it lists unchanged since they were read?
+    auto is_current() const
+        -> bool
+    {
+        for (auto const& input : inputs) {
+            if (stamp_of(input.path) != input) {
+                return false;
             }
-            curr_pos.lineno = pos.lineno;
         }
+        return true;
+    }
 
-        //  Finally, align to the target column, if we're on the right line
-        //  and not one-past-the-end on the extra line at section end)
-        assert(
-            psource
-            && 0 <= curr_pos.lineno
-            && curr_pos.lineno < std::ssize(psource->get_lines())+1
-        );
-        if (
-            curr_pos.lineno == pos.lineno
-            && curr_pos.lineno < std::ssize(psource->get_lines())
-            )
-        {
-            //  Record this line's indentation as the 'last' line for next time
-            last_line_indentation = psource->get_lines()[curr_pos.lineno].indent();
+    static auto same_file(
+        std::filesystem::path const& a,
+        std::filesystem::path const& b
+    )
+        -> bool
+    {
+        auto ec = std::error_code{};
+        return std::filesystem::equivalent(a, b, ec);
+    }
 
-            //  If this line was originally densely spaced (had <2 whitespace
-            //  between all tokens), then the programmer likely wasn't doing a lot
-            //  of special formatting...
-            if (psource->get_lines()[curr_pos.lineno].all_tokens_are_densely_spaced)
-            {
-                //  For the first token in a line, use the line's original indentation
-                if (curr_pos.colno <= 1)
-                {
-                    print( pad( psource->get_lines()[curr_pos.lineno].indent() ) );
+    static auto is_identifier_start(char c)
+        -> bool
+    {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    static auto is_identifier_continue(char c)
+        -> bool
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    //  Scan the text of one source file
+    auto scan(
+        std::string_view text,
+        source_file&     file
+    )
+        -> void
+    {
+        auto i = size_t{0};
+
+        auto skip_space = [&] {
+            while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) {
+                ++i;
+            }
+        };
+        auto next_identifier = [&]() -> std::string_view {
+            auto start = i;
+            while (i < text.size() && is_identifier_continue(text[i])) {
+                ++i;
+            }
+            return text.substr(start, i - start);
+        };
+        auto at_single_colon = [&] {
+            return
+                i < text.size()
+                && text[i] == ':'
+                && (i+1 == text.size() || text[i+1] != ':')
+                ;
+        };
+
+        //  Record the identifiers up to the end of a base list
+        auto scan_bases = [&](std::string_view terminators) {
+            while (i < text.size() && terminators.find(text[i]) == text.npos) {
+                if (is_identifier_start(text[i])) {
+                    auto id = next_identifier();
+                    file.names.emplace(id);
+                    base_names.emplace(id);
                 }
-                //  For later tokens, don't try to add padding
                 else {
-                    if (
-                        last_printed_char == ';'
-                        && on_same_line
-                        )
-                    {
-                        print( " " );
-                    }
+                    ++i;
                 }
             }
-            //  Otherwise, make a best effort to adjust position with some padding
-            else
+        };
+
+        while (i < text.size())
+        {
+            if (!is_identifier_continue(text[i])) {
+                ++i;
+                continue;
+            }
+            if (!is_identifier_start(text[i])) {    // a number
+                next_identifier();
+                continue;
+            }
+
+            auto id = next_identifier();
+            file.names.emplace(id);
+
+            //  Cpp2 base:  this: B = ...;
+            if (id == "this") {
+                skip_space();
+                if (at_single_colon()) {
+                    ++i;
+                    scan_bases("=;{");
+                }
+            }
+
+            //  Cpp1 base:  class D final : public B {
+            else if (
+                id == "class"
+                || id == "struct"
+                )
             {
-                pos.colno = std::max( 1, pos.colno + pad_for_this_line );
-                print( pad( pos.colno - curr_pos.colno ) );
+                skip_space();
+                while (i < text.size() && is_identifier_start(text[i])) {
+                    file.names.emplace(next_identifier());
+                    skip_space();
+                }
+                if (at_single_colon()) {
+                    ++i;
+                    scan_bases(";{");
+                }
             }
         }
     }
 
-
-public:
-    //-----------------------------------------------------------------------
-    //  Finalize phase
+    static auto read(std::filesystem::path const& path)
+        -> std::optional<std::string>
+    {
+        auto in = std::ifstream{ path, std::ios::binary };
+        if (!in) {
+            return {};
+        }
+        return std::string{ std::istreambuf_iterator<char>{in}, {} };
+    }
+
+public:
+    //  The files a manifest lists, or nullopt if it can't be read
     //
-    auto finalize_phase(bool print_remaining_comments = false)
+    static auto files_in(std::string const& manifest)
+        -> std::optional<std::vector<std::filesystem::path>>
+    {
+        auto list = read(manifest);
+        if (!list) {
+            return {};
+        }
+
+        auto ret   = std::vector<std::filesystem::path>{};
+        auto dir   = std::filesystem::path{manifest}.parent_path();
+        auto lines = std::istringstream{*list};
+        for (auto line = std::string{}; std::getline(lines, line); )
+        {
+            while (
+                !line.empty()
+                && std::isspace(static_cast<unsigned char>(line.back()))
+                )
+            {
+                line.pop_back();
+            }
+            auto first = line.find_first_not_of(" \t");
+            if (
+                first == line.npos
+                || line[first] == '#'
+                )
+            {
+                continue;
+            }
+            ret.push_back(dir / line.substr(first));
+        }
+        return ret;
+    }
+
+    //  Get the index for a manifest, reading it and the files it lists
+    //  the first time it's needed and again whenever any of them has
+    //  changed since, or null if any of them can't be read
+    //
+    //  The index is shared, so a caller still using an index that was
+    //  replaced by a newer one keeps it alive
+    //
+    static auto get(std::string const& manifest)
+        -> std::shared_ptr<whole_program_index const>
     {
+        static auto mutex   = std::mutex{};
+        static auto indexes = std::unordered_map<std::string, std::shared_ptr<whole_program_index const>>{};
+
+        auto lock    = std::lock_guard{mutex};
+        auto& cached = indexes[manifest];
         if (
-            is_open()
-            && psource
-            && psource->has_cpp2()
+            cached
+            && cached->is_current()
             )
         {
-            flush_comments( {curr_pos.lineno+1, 1} );
+            return cached;
+        }
+        cached = {};
 
-            if (print_remaining_comments) {
-                print_unprinted_comments();
-            }
+        //  Stamp each file before reading it, so a change made while
+        //  it's being read is seen by the next call
+        auto index          = whole_program_index{};
+        auto manifest_stamp = stamp_of(manifest);
+        if (!manifest_stamp) {
+            return {};
+        }
+        index.inputs.push_back(*manifest_stamp);
 
-            //  Always make sure the very last line ends with a newline
-            //  (not really necessary but makes some tools quieter)
-            //  -- but only if there's any Cpp2, otherwise don't
-            //  because passing through all-Cpp1 code should always
-            //  remain diff-identical
-            if (phase == phase2_func_defs) {
-                print_extra("\n");
+        auto paths = files_in(manifest);
+        if (!paths) {
+            return {};
+        }
+
+        for (auto const& path : *paths) {
+            auto file_stamp = stamp_of(path);
+            auto text       = read(path);
+            if (
+                !file_stamp
+                || !text
+                )
+            {
+                return {};
             }
+            index.inputs.push_back(*file_stamp);
+            index.files.push_back({ path, {} });
+            index.scan(*text, index.files.back());
         }
-    }
 
+        cached = std::make_shared<whole_program_index const>(std::move(index));
+        return cached;
+    }
 
-    //-----------------------------------------------------------------------
-    //  Open
-    //
-    auto open(
-        std::string                 cpp2_filename_,
-        std::string                 cpp1_filename_,
-        std::vector<comment> const& comments,
-        cpp2::source const&         source,
-        cpp2::parser const&         parser
-    )
-        -> void
+    //  The position of path in the manifest, or -1 if it isn't listed
+    auto find(std::filesystem::path const& path) const
+        -> std::ptrdiff_t
     {
-        cpp2_filename = (flag_line_paths) ?
-            std::filesystem::absolute(std::filesystem::path(cpp2_filename_)).string() :
-            cpp2_filename_;
-        assert(
-            !is_open()
-            && !pcomments
-            && "ICE: tried to call .open twice"
-        );
-        cpp1_filename = cpp1_filename_;
-        if (cpp1_filename == "stdout") {
-            out = &std::cout;
+        for (auto i = std::ptrdiff_t{0}; i < std::ssize(files); ++i) {
+            if (same_file(files[i].path, path)) {
+                return i;
+            }
         }
-        else {
-            out_file.open(cpp1_filename);
-            out = &out_file;
+        return -1;
+    }
+
+    //  Is name used in any file other than the one at position self?
+    auto is_used_outside(
+        std::ptrdiff_t     self,
+        std::string const& name
+    ) const
+        -> bool
+    {
+        for (auto i = std::ptrdiff_t{0}; i < std::ssize(files); ++i) {
+            if (
+                i != self
+                && files[i].names.contains(name)
+                )
+            {
+                return true;
+            }
         }
-        pcomments = &comments;
-        psource   = &source;
-        pparser   = &parser;
+        return false;
     }
 
-    auto reopen()
-        -> void
+    //  Might a type with this name have derived types?
+    auto may_be_a_base(std::string const& name) const
+        -> bool
     {
-        assert(
-            is_open()
-            && "ICE: tried to call .reopen without first calling .open"
-        );
-        assert(cpp1_filename.ends_with(".h"));
-        out_file.close();
-        out_file.open(cpp1_filename + "pp");
+        return base_names.contains(name);
     }
+};
+
+
+//-----------------------------------------------------------------------
+//
+//  purity_finder: Classifies a function body as const, pure, or neither
+//  for -mark-purity
+//
+//-----------------------------------------------------------------------
+//
+//  A const function's result depends only on its parameters' values,
+//  and a pure function's can also depend on the object it's called on.
+//  Neither has any other effect or throws, so the Cpp1 compiler can use
+//  one call's result for another with the same arguments, such as by
+//  hoisting the call out of a loop.
+//
+//  The rules are deliberately conservative. The parameters, result, and
+//  locals must be of fundamental types, and the body may only apply
+//  built-in operators to them, assign to locals, branch and loop, read
+//  fundamental data members of 'this' (which makes it pure at most), and
+//  call functions defined in the same file. Anything else, including a
+//  subscript, a dereference, a member of anything but 'this', a string
+//  literal, 'is' or 'as', 'inspect', a range 'for', a lambda, a contract,
+//  or a qualified name, makes it neither.
+//
+//  Loops and recursion are allowed, and the attributes let the compiler
+//  assume the function returns. That's documented for -mark-purity: a
+//  function that can recurse without bound shouldn't be translated with it.
+//
+//  This classifies the body by itself and returns the functions it could
+//  call, for the caller to take into account (see find_function_purity)
+//
+enum class function_purity : std::uint8_t { none, pure, const_ };
+
+class purity_finder
+{
+public:
+    struct result {
+        function_purity                      purity  = function_purity::const_;
+        std::string                          reason  = {};  // why it isn't const, if it isn't
+        std::vector<declaration_node const*> callees = {};
+    };
 
-    auto is_open()
+    using names_map = std::unordered_multimap<std::string_view, declaration_node const*>;
+
+private:
+    declaration_node const&       function;
+    names_map const&              namespace_names;
+    result&                       ret;
+    std::vector<std::string_view> locals = {};
+    std::vector<std::size_t>      scopes = {};
+
+    //  Only these are passed by value as 'in' parameters on every platform
+    //  (see cpp2::impl::in), so 'long double' isn't one of them
+    static auto is_fundamental_type(std::string_view name)
         -> bool
     {
-        if (out) {
-            assert(
-                pcomments
-                && "ICE: if is_open, pcomments should also be set"
-            );
-        }
-        return out;
+        static constexpr std::string_view names[] = {
+            "bool", "char", "char8_t", "char16_t", "char32_t", "wchar_t",
+            "signed char", "unsigned char", "short", "unsigned short", "short int", "unsigned short int",
+            "int", "signed", "unsigned", "signed int", "unsigned int",
+            "long", "unsigned long", "long int", "unsigned long int",
+            "long long", "unsigned long long", "long long int", "unsigned long long int",
+            "float", "double",
+            "i8", "i16", "i32", "i64", "u8", "u16", "u32", "u64",
+            "_schar", "_uchar", "ushort", "ulong", "longlong", "ulonglong",
+            "std::int8_t", "std::int16_t", "std::int32_t", "std::int64_t",
+            "std::uint8_t", "std::uint16_t", "std::uint32_t", "std::uint64_t",
+            "std::size_t", "std::ptrdiff_t", "std::intptr_t", "std::uintptr_t"
+        };
+        return std::find(std::begin(names), std::end(names), name) != std::end(names);
     }
 
+    static auto object_type(declaration_node const& n)
+        -> std::string
+    {
+        assert(n.is_object());
+        return std::get<declaration_node::an_object>(n.type)->to_string();
+    }
 
-    //-----------------------------------------------------------------------
-    //  Abandon: close and delete
-    //
-    auto abandon()
-        -> void
+    //  A 'name: type == value' of a fundamental type, or whose value is a
+    //  numeric or character literal
+    static auto is_fundamental_constant(declaration_node const& n)
+        -> bool
     {
-        if (!is_open()) {
-            return;
+        if (!n.is_object_alias()) {
+            return false;
         }
-        if (out_file.is_open()) {
-            out_file.close();
-            std::remove(cpp1_filename.c_str());
+        auto const& alias = std::get<declaration_node::an_alias>(n.type);
+        if (alias->type_id) {
+            return is_fundamental_type(alias->type_id->to_string());
         }
+        auto literal = std::get<alias_node::an_object>(alias->initializer)->get_literal();
+        return
+            literal
+            && literal->get_token()->type() != lexeme::StringLiteral
+            && !literal->user_defined_suffix
+            ;
     }
 
-
-    //-----------------------------------------------------------------------
-    //  Print extra text and don't track positions
-    //  Used for Cpp2 boundary comment and prelude and final newline
-    //
-    auto print_extra( std::string_view s )
+    auto downgrade(
+        function_purity    purity,
+        std::string const& why
+    )
         -> void
     {
-        assert(
-            is_open()
-            && "ICE: printer must be open before printing"
-        );
-        print( s, source_position{}, false );
-        printed_extra = true;
+        if (purity < ret.purity) {
+            ret.purity = purity;
+            ret.reason = why;
+        }
     }
 
-
-    //-----------------------------------------------------------------------
-    //  Print a Cpp1 line, which should be at lineno
-    //
-    auto print_cpp1( std::string_view s, lineno_t line )
+    auto reject(std::string const& why)
         -> void
     {
-        assert(
-            is_open()
-            && line >= 0
-            && "ICE: printer must be open before printing, and line number must not be negative (Cpp1 code is never generated)"
-        );
-
-        //  Always start a Cpp1 line on its own new line
-        ensure_at_start_of_new_line();
-
-        //  If we are out of sync with the current logical line number,
-        //  emit a #line directive to re-sync
-        if (curr_pos.lineno != line) {
-            print_line_directive( line );
-            curr_pos.lineno = line;
-        }
-
-        //  Print the line
-        assert (curr_pos.colno == 1);
-        print( s );
-        print( "\n" );
+        downgrade(function_purity::none, why);
     }
 
+    auto is_local(std::string_view name) const
+        -> bool
+    {
+        return std::find(locals.begin(), locals.end(), name) != locals.end();
+    }
 
-    //-----------------------------------------------------------------------
-    //  Used when we start a new Cpp2 section, or when we emit the same item
-    //  more than once (notably when we emit operator= more than once)
-    //
-    auto reset_line_to(lineno_t line, bool force = false)
-        -> void
+    auto has_this() const
+        -> bool
     {
-        //  Always start a Cpp2 section on its own new line
-        ensure_at_start_of_new_line();
+        return std::get<declaration_node::a_function>(function.type)->is_function_with_this();
+    }
 
-        //  If we are out of sync with the current logical line number,
-        //  emit a #line directive to re-sync
+    //  The declarations an unqualified name in the body could find, where
+    //  the members of the function's type hide namespace-scope names
+    auto lookup(
+        std::string_view name,
+        bool             members_only
+    ) const
+        -> std::vector<declaration_node const*>
+    {
+        auto found = std::vector<declaration_node const*>{};
+        if (function.parent_is_type()) {
+            for (auto member : function.parent_declaration->get_type_scope_declarations()) {
+                if (member->has_name(name)) {
+                    found.push_back(member);
+                }
+            }
+        }
         if (
-            force
-            || curr_pos.lineno != line
+            found.empty()
+            && !members_only
             )
         {
-            print_line_directive( line );
-            curr_pos.lineno = line;
+            auto [first, last] = namespace_names.equal_range(name);
+            for (; first != last; ++first) {
+                found.push_back(first->second);
+            }
         }
-
-        assert (curr_pos.colno == 1);
+        return found;
     }
 
-
-    //-----------------------------------------------------------------------
-    //  Print a Cpp2 item, which should be at pos
-    //
-    auto print_cpp2(
-        std::string_view s,
-        source_position  pos,
-        bool             leave_newlines_alone = false,
-        bool             is_known_empty = false
-
+    //  A use of name followed by the operators from n.ops[op] on
+    auto use_declared_name(
+        postfix_expression_node const& n,
+        std::size_t                    op,
+        std::string const&             name,
+        bool                           members_only
     )
         -> void
     {
-        //  If we're printing for real (not to a string target)
-        if (emit_target_stack.empty())
+        auto found = lookup(name, members_only);
+        if (found.empty()) {
+            reject("it uses '" + name + "', which isn't a parameter, local, or declared in this file");
+            return;
+        }
+
+        if (std::ranges::all_of(found, [](auto d) { return d->is_function(); }))
         {
-            //  If we're in a generated text region (signified by negative
-            //  line numbers), then shunt this call to print_extra instead
-            if (pos.lineno < 1) {
-                if (generated_pos_line != pos.lineno) {
-                    *out << "\n" + std::string(last_line_indentation, ' ');
-                    generated_pos_line = pos.lineno;
-                }
-                print_extra(s);
-                return;
+            if (
+                n.ops.size() != op + 1
+                || n.ops[op].op->type() != lexeme::LeftParen
+                )
+            {
+                reject("it uses function '" + name + "' other than by calling it");
             }
-
-            //  Otherwise, we're no longer in generated code, so reset the
-            //  generated code counter
-            generated_pos_line = {};
+            else if (std_header_for(name)) {
+                reject("it calls '" + name + "', which could also find a standard library function");
+            }
+            else {
+                ret.callees.insert(ret.callees.end(), found.begin(), found.end());
+            }
+            return;
         }
 
-        assert(
-            is_open()
-            && "ICE: printer must be open before printing"
-        );
-
-        //  If there are any embedded newlines, split this string into
-        //  separate print_cpp2 calls
-        if (auto newline_pos = s.find('\n');
-            !leave_newlines_alone
-            && s.length() > 1
-            && newline_pos != s.npos
+        auto decl = found.front();
+        if (
+            std::ssize(found) == 1
+            && n.ops.empty()
+            && is_fundamental_constant(*decl)
             )
         {
-            while (newline_pos != std::string_view::npos)
-            {
-                //  Print the text before the next newline
-                if (newline_pos > 0) {
-                    print_cpp2( s.substr(0, newline_pos), pos );
-                }
-
-                //  Emit the newline as a positioned empty string
-                assert (s[newline_pos] == '\n');
-                ++pos.lineno;
-                pos.colno = 1;
-                print_cpp2( "", pos, false, curr_pos.colno <= 1 );
-
-                s.remove_prefix( newline_pos+1 );
-                newline_pos = s.find('\n');
+            return;
+        }
+        if (
+            std::ssize(found) != 1
+            || !decl->is_object()
+            || n.ops.size() != op
+            || !is_fundamental_type(object_type(*decl))
+            )
+        {
+            reject("it uses '" + name + "'");
+        }
+        else if (decl->parent_is_type()) {
+            if (has_this()) {
+                downgrade(function_purity::pure, "it reads member '" + name + "'");
             }
-            //  Print any tail following the last newline
-            if (!s.empty()) {
-                print_cpp2( s, pos );
+            else {
+                reject("it uses member '" + name + "'");
             }
-            return;
         }
+        else {
+            reject("it uses '" + name + "', which isn't a constant");
+        }
+    }
 
-        //  The rest of this call handles a single chunk that's either a
-        //  standalone "\n" or a piece of text that doesn't have a newline
+public:
+    purity_finder(
+        declaration_node const& function_,
+        names_map const&        namespace_names_,
+        result&                 ret_
+    )
+        : function{function_}
+        , namespace_names{namespace_names_}
+        , ret{ret_}
+    {
+        auto const& func = std::get<declaration_node::a_function>(function.type);
+        for (auto const& param : func->parameters->parameters) {
+            if (auto name = param->declaration->name()) {
+                locals.push_back(name->as_string_view());
+            }
+        }
+    }
 
-        //  Skip alignment work if we're capturing emitted text
-        if (emit_target_stack.empty())
-        {
-            //  Remember where we are
-            auto last_pos = curr_pos;
+    //  Why a function can't be const or pure whatever its body does,
+    //  or empty if it might be
+    //
+    static auto why_not_a_candidate(declaration_node const& n)
+        -> std::string
+    {
+        assert(n.is_function());
+        auto const& func = std::get<declaration_node::a_function>(n.type);
 
-            //  We may want to adjust the position based on (1) a position preemption request
-            //  or else (2) to repeat a similar adjustment we discovered on the previous line
-            auto adjusted_pos = pos;
+        if (n.has_name("main")) {
+            return "it is main";
+        }
+        for (auto p = &n; p; p = p->parent_declaration) {
+            if (p->template_parameters) {
+                return "it is a template or a member of one";
+            }
+        }
+        if (func->throws) {
+            return "it is declared 'throws'";
+        }
+        if (!func->contracts.empty()) {
+            return "it has a contract";
+        }
 
-            //  (1) See if there's a position preemption request, if so use it up
-            //      For now, the preempt position use cases are about overriding colno
-            //      and only on the same line. In the future, we might have more use cases.
-            if (!preempt_pos.empty()) {
-                if (preempt_pos.back().lineno == pos.lineno) {
-                    adjusted_pos.colno = preempt_pos.back().colno;
+        auto id = std::get_if<function_type_node::single_type_id>(&func->returns);
+        if (
+            !func->has_non_void_return_type()
+            || !id
+            )
+        {
+            return func->has_non_void_return_type()
+                ? "it has named return values"
+                : "it returns void";
+        }
+        if (id->pass != passing_style::move) {
+            return "it returns by reference";
+        }
+        if (!is_fundamental_type(id->type->to_string())) {
+            return "it returns '" + id->type->to_string() + "', which isn't a fundamental type";
+        }
+
+        for (auto const& param : func->parameters->parameters)
+        {
+            auto const& decl = *param->declaration;
+            auto name = decl.name() ? decl.name()->to_string() : std::string{"_"};
+            if (name == "this") {
+                if (param->mod != parameter_declaration_node::modifier::none) {
+                    return "it is virtual";
                 }
+                if (param->pass != passing_style::in) {
+                    return "it takes 'this' as '" + std::string{to_string_view(param->pass)} + "'";
+                }
+                continue;
             }
-
-            //  (2) Otherwise, see if there's a previous line's offset to repeat
-            //      If we moved to a new line, then this is the first
-            //      non-comment non-whitespace text on the new line
-            else if (
-                last_pos.lineno == pos.lineno-1
-                && enable_indent_heuristic
+            if (
+                param->pass != passing_style::in
+                && param->pass != passing_style::copy
                 )
             {
-                //  If the last line had a request for this colno, remember its actual offset
-                constexpr int sentinel = -100;
-                auto last_line_offset = sentinel;
-                for(auto i = 0;
-                    i < std::ssize(prev_line_info.requests)
-                        && prev_line_info.requests[i].requested <= pos.colno;
-                    ++i
-                    )
-                {
-                    if (prev_line_info.requests[i].requested == pos.colno)
-                    {
-                        last_line_offset = prev_line_info.requests[i].offset;
-                        break;
-                    }
-                }
-
-                //  If there was one, apply the actual column number offset
-                if (last_line_offset > sentinel) {
-                    adjusted_pos.colno += last_line_offset;
-                }
+                return "it takes '" + name + "' as '" + std::string{to_string_view(param->pass)} + "'";
             }
-            enable_indent_heuristic = true;
-
-            //  If we're changing lines, start accumulating this new line's request/actual adjustment info
-            if (last_pos.lineno < adjusted_pos.lineno) {
-                prev_line_info = { curr_pos.lineno, { } };
+            if (
+                decl.is_variadic
+                || !decl.is_object()
+                || !is_fundamental_type(object_type(decl))
+                )
+            {
+                return "it takes '" + name + "', which isn't of a fundamental type";
             }
-
-            align_to(adjusted_pos);
-
-            //  Remember the requested and actual offset columns for this item
-            prev_line_info.requests.push_back( req_act_info( pos.colno /*requested*/ , curr_pos.colno /*actual*/ - pos.colno ) );
         }
-
-        print(s, pos, true, is_known_empty );
+        return {};
     }
 
-
-    //-----------------------------------------------------------------------
-    //  Position override control functions
-    //
-
-    //  Use this position instead of the next supplied one
-    //  Useful when Cpp1 syntax is emitted in a different order/verbosity
-    //  than Cpp2 such as with declarations
-    //
-    auto preempt_position_push(source_position pos)
-        -> void
+    auto start(declaration_node const& n, int) -> void
     {
-        preempt_pos.push_back( pos );
+        if (
+            n.is_object()
+            && n.name()
+            && (
+                n.has_wildcard_type()
+                || is_fundamental_type(object_type(n))
+                )
+            )
+        {
+            locals.push_back(n.name()->as_string_view());
+        }
+        else if (n.is_object()) {
+            reject("it declares '" + (n.name() ? n.name()->to_string() : std::string{"_"}) + "', which isn't of a fundamental type");
+        }
+        else {
+            reject("it declares a local function, type, namespace, or alias");
+        }
     }
 
-    auto preempt_position_pop()
-        -> void
+    auto start(parameter_declaration_node const& n, int) -> void
     {
-        assert(!preempt_pos.empty());
-        preempt_pos.pop_back();
+        //  A statement parameter
+        if (
+            n.pass != passing_style::in
+            && n.pass != passing_style::copy
+            )
+        {
+            reject("it declares a statement parameter as '" + std::string{to_string_view(n.pass)} + "'");
+        }
     }
 
-    //  Add (or, if negative, subtract) padding for the current line only
-    //
-    auto add_pad_in_this_line(colno_t extra)
-        -> void
+    //  Locals go out of scope at the end of their block, and statement
+    //  parameters at the end of their statement
+    auto start(compound_statement_node const&, int) -> void
     {
-        pad_for_this_line += extra;
+        scopes.push_back(locals.size());
     }
 
-    //  Enable indent heuristic for just this line
-    //
-    auto disable_indent_heuristic_for_next_text()
-        -> void
+    auto end(compound_statement_node const&, int) -> void
     {
-        enable_indent_heuristic = false;
+        assert(!scopes.empty());
+        locals.resize(scopes.back());
+        scopes.pop_back();
     }
 
-    //  Ignore position information, usually when emitting generated code
-    //  such as generated multi-return type structs
-    //
-    auto ignore_alignment(
-        bool ignore,
-        int  indent = 0
-    )
-        -> void
+    auto start(statement_node const& n, int) -> void
     {
-        //  We'll only ever call this in local non-nested true/false pairs.
-        //  If we ever want to generalize (support nesting, or make it non-brittle),
-        //  wrap this in a push/pop stack.
-        if (ignore) {
-            ignore_align        = true;
-            ignore_align_indent = indent;
-            ignore_align_lineno = curr_pos.lineno;      // push state
-        }
-        else {
-            ignore_align        = false;
-            ignore_align_indent = 0;
-            curr_pos.lineno     = ignore_align_lineno;  // pop state
+        if (n.parameters) {
+            scopes.push_back(locals.size());
         }
     }
 
-
-    //-----------------------------------------------------------------------
-    //  Modal state control functions
-    //
-
-    auto next_phase()
-        -> void
+    auto end(statement_node const& n, int) -> void
     {
-        inc_phase();
+        if (n.parameters) {
+            assert(!scopes.empty());
+            locals.resize(scopes.back());
+            scopes.pop_back();
+        }
     }
 
-    //  Provide an option to store to a given string instead, which is
-    //  useful for capturing Cpp1-formatted output for generated code
-    //
-    auto emit_to_string( std::string* target = {} )
-        -> void
+    auto start(postfix_expression_node const& n, int) -> void
     {
-        if (target) {
-            emit_string_targets.push_back( target );
-            emit_target_stack.push_back(target_type::string);
+        assert(n.expr);
+        auto const& primary = *n.expr;
+
+        //  Any operator that isn't in an allowed use below
+        auto reject_op = [&](std::size_t op, std::string const& what) {
+            reject("it applies '" + n.ops[op].op->to_string() + "' to " + what);
+        };
+
+        if (auto literal = primary.get_literal())
+        {
+            auto t = literal->get_token();
+            if (t->type() == lexeme::StringLiteral) {
+                reject("it uses a string literal");
+            }
+            else if (literal->user_defined_suffix) {
+                reject("it uses a user-defined literal");
+            }
+            else if (!n.ops.empty()) {
+                reject_op(0, "a literal");
+            }
+            return;
+        }
+
+        if (primary.is_expression_list()) {
+            if (!n.ops.empty()) {
+                reject_op(0, "a parenthesized expression");
+            }
+            return;
+        }
+
+        //  Lambdas and inspect are rejected by their own start()
+        if (
+            primary.expr.index() == primary_expression_node::declaration
+            || primary.expr.index() == primary_expression_node::inspect
+            )
+        {
+            return;
+        }
+
+        auto id = primary.get_token();
+        if (
+            !id
+            || !(primary.is_identifier() || primary.is_unqualified_id())
+            || !primary.template_arguments().empty()
+            )
+        {
+            reject("it uses '" + primary.to_string() + "'");
+            return;
+        }
+        auto name = id->as_string_view();
+
+        if (
+            name == "true"
+            || name == "false"
+            )
+        {
+            if (!n.ops.empty()) {
+                reject_op(0, std::string{name});
+            }
+        }
+        else if (name == "this") {
+            if (
+                n.ops.empty()
+                || n.ops.front().op->type() != lexeme::Dot
+                || !n.ops.front().id_expr
+                || !n.ops.front().id_expr->is_unqualified()
+                || !n.ops.front().id_expr->template_arguments().empty()
+                )
+            {
+                reject("it uses 'this' other than to name a member");
+            }
+            else {
+                use_declared_name(n, 1, n.ops.front().id_expr->to_string(), true);
+            }
+        }
+        else if (
+            is_local(name)
+            || name == "_"
+            )
+        {
+            for (auto i = std::size_t{0}; i < n.ops.size(); ++i) {
+                if (
+                    n.ops[i].op->type() != lexeme::PlusPlus
+                    && n.ops[i].op->type() != lexeme::MinusMinus
+                    )
+                {
+                    reject_op(i, "'" + std::string{name} + "'");
+                }
+            }
         }
         else {
-            emit_string_targets.pop_back();
-            emit_target_stack.pop_back();
+            use_declared_name(n, 0, std::string{name}, false);
         }
     }
 
-    //  Provide an option to store to a vector<text_with_pos>, which is
-    //  useful for postfix expression which have to mix unwrapping operators
-    //  with emitting sub-elements such as expression lists
-    //
-    auto emit_to_text_chunks( std::vector<text_with_pos>* target = {} )
-        -> void
+    template<String Name, typename Term>
+    auto start(binary_expression_node<Name, Term> const& n, int) -> void
     {
-        if (target) {
-            emit_text_chunks_targets.push_back( target );
-            emit_target_stack.push_back(target_type::chunks);
-        }
-        else {
-            emit_text_chunks_targets.pop_back();
-            emit_target_stack.pop_back();
+        if constexpr (std::string_view{Name.value} == "assignment")
+        {
+            //  Each term but the last is assigned to
+            for (auto i = std::ssize(n.terms); i > 0; --i)
+            {
+                auto target = i == 1
+                    ? n.get_postfix_expression_node()
+                    : n.terms[i-2].expr->get_postfix_expression_node();
+                if (
+                    !target
+                    || !target->ops.empty()
+                    || !target->expr->get_token()
+                    || !(
+                        is_local(target->expr->get_token()->as_string_view())
+                        || *target->expr->get_token() == "_"
+                        )
+                    )
+                {
+                    reject("it assigns to something other than a local");
+                }
+            }
         }
     }
 
+    auto start(expression_list_node::term const& n, int) -> void
+    {
+        if (
+            n.pass == passing_style::out
+            || n.pass == passing_style::inout
+            )
+        {
+            reject("it passes an argument as '" + std::string{to_string_view(n.pass)} + "'");
+        }
+    }
+
+    auto start(is_as_expression_node const& n, int) -> void
+    {
+        if (!n.ops.empty()) {
+            reject("it uses 'is' or 'as'");
+        }
+    }
+
+    auto start(iteration_statement_node const& n, int) -> void
+    {
+        if (n.range) {
+            reject("it uses a range 'for'");
+        }
+    }
+
+    auto start(inspect_expression_node const&, int) -> void
+    {
+        reject("it uses 'inspect'");
+    }
+
+    auto start(contract_node const&, int) -> void
+    {
+        reject("it has a contract check");
+    }
+
+    auto start(using_statement_node const&, int) -> void
+    {
+        reject("it has a 'using' statement");
+    }
+
+    auto start(auto const&, int) -> void
+    {
+    }
+
+    auto end(auto const&, int) -> void
+    {
+    }
 };
 
 
 //-----------------------------------------------------------------------
 //
-//  cppfront: a compiler instance
+//  append_parts: append strings, tokens, characters, and integers to s,
+//  growing it at most once, instead of building temporaries with +
 //
 //-----------------------------------------------------------------------
 //
-struct function_prolog {
-    std::vector<std::string> mem_inits  = {};
-    std::vector<std::string> statements = {};
-};
+template<typename Part>
+auto part_size(Part const& part)
+    -> std::size_t
+{
+    if constexpr (std::is_same_v<Part, char>) {
+        return 1;
+    }
+    else if constexpr (std::is_integral_v<Part>) {
+        return 20;
+    }
+    else {
+        return std::string_view{part}.size();
+    }
+}
 
-class cppfront
+template<typename Part>
+auto append_part(
+    std::string& s,
+    Part const&  part
+)
+    -> void
 {
-    std::string              sourcefile;
-    std::vector<error_entry> errors;
+    if constexpr (std::is_same_v<Part, char>) {
+        s.push_back(part);
+    }
+    else if constexpr (std::is_integral_v<Part>) {
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof buf, part);
+        assert(res.ec == std::errc{});
+        s.append(buf, res.ptr);
+    }
+    else {
+        s.append(std::string_view{part});
+    }
+}
 
-    //  For building
-    //
-    cpp2::source source;
-    cpp2::tokens tokens;
-    cpp2::parser parser;
-    cpp2::sema   sema;
+template<typename... Parts>
+auto append_parts(
+    std::string&    s,
+    Parts const&... parts
+)
+    -> void
+{
+    s.reserve(s.size() + (part_size(parts) + ...));
+    (append_part(s, parts), ...);
+}
 
-    bool source_loaded                  = true;
-    bool last_postfix_expr_was_pointer  = false;
-    bool violates_bounds_safety         = false;
-    bool violates_initialization_safety = false;
-    bool suppress_move_from_last_use    = false;
 
-    declaration_node const* having_signature_emitted = {};
+//-----------------------------------------------------------------------
+//
+//  positional_printer: a Syntax 1 pretty printer
+//
+//-----------------------------------------------------------------------
+//
+struct text_with_pos{
+    std::string     text;
+    source_position pos;
+    text_with_pos(std::string t, source_position p) : text{std::move(t)}, pos{p} { }
+};
 
-    declaration_node const*   generating_assignment_from      = {};
-    declaration_node const*   generating_move_from            = {};
-    declaration_node const*   generating_postfix_inc_dec_from = {};
-    bool                      emitting_that_function          = false;
-    bool                      emitting_move_that_function     = false;
-    std::vector<token const*> already_moved_that_members      = {};
+class positional_printer
+{
+public:
+    positional_printer()                          = default;
+private:
+    positional_printer(positional_printer const&) = delete;
+    void operator=(positional_printer const&)     = delete;
 
-    struct arg_info {
-        passing_style pass   = passing_style::in;
-        token const*  ptoken = {};
-    };
-    std::vector<arg_info> current_args  = { {} };
+    //  Core information
+    std::ofstream               out_file        = {}; // Cpp1 syntax output file
+    std::ostringstream          out_buffer      = {}; // Cpp1 syntax output buffer, see open_buffer
+    std::ostream*               out             = {}; // will point to out_file, out_buffer, or cout
+    bool                        in_memory       = false; // printing files to out_buffer
+    std::vector<std::string>    memory_files    = {}; // finished in-memory files
+    std::string                 cpp2_filename   = {};
+    std::string                 cpp1_filename   = {};
+    std::vector<comment> const* pcomments       = {}; // Cpp2 comments data
+    source const*               psource         = {};
+    parser const*               pparser         = {};
+    translation_options const*  poptions        = {};
 
-    struct active_using_declaration {
-        token const* identifier = {};
+    source_position curr_pos                    = {}; // current (line,col) in output
+    lineno_t        generated_pos_line          = {}; // current line in generated output
+    int             last_line_indentation       = {};
+    int             next_comment                = 0;  // index of the next comment not yet printed
+    bool            last_was_empty              = false;
+    int             empty_lines_suppressed      = 0;
+    bool            just_printed_line_directive = false;
+    bool            printed_extra               = false;
+    char            last_printed_char           = {};
 
-        explicit active_using_declaration(using_statement_node const& n) {
-          if (auto id = get_if<id_expression_node::qualified>(&n.id->id)) {
-              identifier = (*id)->ids.back().id->identifier;
-          }
-        }
+    struct req_act_info {
+        colno_t requested;
+        colno_t offset;
+
+        req_act_info(colno_t r, colno_t o) : requested{r}, offset{o} { }
+        auto operator==(req_act_info const&) const -> bool = default;
     };
+    struct {
+        lineno_t line = {};
+        std::vector<req_act_info> requests = {};
+    } prev_line_info = {};
 
-    using source_order_name_lookup_res =
-        std::optional<std::variant<declaration_node const*, active_using_declaration>>;
+    //  Position override information
+    std::vector<source_position> preempt_pos = {};  // use this position instead of the next supplied one
+    int             pad_for_this_line   = 0;        // extra padding to add/subtract for this line only
+    bool            ignore_align        = false;
+    int             ignore_align_indent = 0;
+    lineno_t        ignore_align_lineno = 0;
+    bool            enable_indent_heuristic = true;
 
-    //  Stack of the currently active nested declarations we're inside
-    std::vector<declaration_node const*> current_declarations = { {} };
+    //  When printing to out_buffer, the comments we printed (to mark them
+    //  as printed later, if and when the buffer's text is actually used)
+    std::vector<comment const*> buffered_comments = {};
 
-    //  Stack of the currently active names for source order name lookup:
-    //  Like 'current_declarations' + also parameters and using declarations
-    std::vector<source_order_name_lookup_res::value_type> current_names = { {} };
+    //  Comments outside function bodies that go with a function that phase 1
+    //  doesn't declare, so phase 2 prints them with its definition instead
+    std::unordered_set<comment const*> deferred_comments = {};
 
-    //  Maintain a stack of the functions we're currently processing, which can
-    //  be up to MaxNestedFunctions in progress (if we run out, bump the Max).
-    //  The main reason for this is to be able to pass function_info's, especially
-    //  their .epilog, by reference for performance while still having lifetime safety
-    struct function_info
-    {
-        declaration_node const*                    decl                         = {};
-        function_type_node const*                  func                         = {};
-        declaration_node::declared_value_set_funcs declared_value_set_functions = {};
-        function_prolog                            prolog                       = {};
-        std::vector<std::string>                   epilog                       = {};
-        int                                        ordinal                      = {};
+    //  Reused by the variadic print_cpp2 to join its parts without allocating
+    std::string parts_buffer = {};
 
-        function_info(
-            declaration_node const*                    decl_,
-            function_type_node const*                  func_,
-            declaration_node::declared_value_set_funcs declared_value_set_functions_
-        )
-            : decl{decl_}
-            , func{func_}
-            , declared_value_set_functions{declared_value_set_functions_}
-        { }
+public:
+    //  Modal information
+    enum phases {
+        phase0_type_decls           = 0,
+        phase1_type_defs_func_decls = 1,
+        phase2_func_defs            = 2
     };
-    class current_functions_
-    {
-        stable_vector<function_info> list = { {} };
-    public:
-        auto push(
-            declaration_node const*                    decl,
-            function_type_node const*                  func,
-            declaration_node::declared_value_set_funcs thats
-        ) {
-            list.emplace_back(decl, func, thats);
-        }
+    auto get_phase() const { return lowering_phase.value_or(phase); }
 
-        auto pop() {
-            list.pop_back();
-        }
-
-        auto back() -> function_info& {
-            assert(!empty());
-            return list.back();
-        }
+    auto get_cpp2_filename() const -> std::string const& { return cpp2_filename; }
 
-        auto empty() -> bool {
-            return list.empty();
-        }
-    };
-    current_functions_ current_functions;
+private:
+    phases phase = phase0_type_decls;
 
-    //  For lowering
-    //
-    positional_printer printer;
-    bool               in_definite_init  = false;
-    bool               in_parameter_list = false;
+    //  Set while lowering something in another phase's form than the
+    //  phase we're printing (see lower_as_phase), which affects what is
+    //  lowered but not which comments are printed
+    std::optional<phases> lowering_phase = {};
 
-    struct function_return {
-        parameter_declaration_list_node* param_list;
-        passing_style                    pass;
-        bool                             is_deduced;
+    auto inc_phase() -> void {
+        switch (phase) {
+        break;case phase0_type_decls          : phase = phase1_type_defs_func_decls;
+        break;case phase1_type_defs_func_decls: phase = phase2_func_defs;
+        break;default                         : assert(!"ICE: invalid lowering phase");
+        }
+        curr_pos     = {};
+        next_comment = 0;   // start over with the comments
+    }
 
-        function_return(
-            parameter_declaration_list_node* param_list_,
-            passing_style                    pass_ = passing_style::invalid,
-            bool                             is_deduced_ = false
-        )
-            : param_list{param_list_}
-            , pass{pass_}
-            , is_deduced{is_deduced_}
-        { }
-    };
-    std::vector<function_return>         function_returns;
-    parameter_declaration_list_node      single_anon;
-        //  special value - hack for now to note single-anon-return type kind in this function_returns working list
-    std::vector<std::string>                      function_requires_conditions;
+    std::vector<std::string*>                emit_string_targets;       // option to emit to string instead of out file
+    std::vector<std::vector<text_with_pos>*> emit_text_chunks_targets;  // similar for vector<text_pos>
 
-    struct iter_info {
-        iteration_statement_node const* stmt;
-        bool used = false;
-    };
-    std::vector<iter_info> iteration_statements;
+    enum class target_type { string, chunks };
+    std::vector<target_type>                 emit_target_stack;         // to interleave them sensibly
 
-    std::vector<bool>                             in_non_rvalue_context   = { false };
-    std::vector<bool>                             in_single_unqualified_id_return  = { false };
-    std::vector<bool>                             need_expression_list_parens = { true };
-    auto push_need_expression_list_parens( bool b ) -> void { need_expression_list_parens.push_back(b);            }
-    auto pop_need_expression_list_parens()          -> void { assert(std::ssize(need_expression_list_parens) > 1);
-                                                              need_expression_list_parens.pop_back();              }
-    auto should_add_expression_list_parens()        -> bool { assert(!need_expression_list_parens.empty());
-                                                              return need_expression_list_parens.back();           }
-    auto consumed_expression_list_parens()          -> void { if( std::ssize(need_expression_list_parens) > 1 )
-                                                                  need_expression_list_parens.back() = false;      }
 
-public:
     //-----------------------------------------------------------------------
-    //  Constructor
-    //
-    //  filename    the source file to be processed
+    //  Print text
     //
-    cppfront(std::string const& filename)
-        : sourcefile{ filename }
-        , source    { errors }
-        , tokens    { errors }
-        , parser    { errors }
-        , sema      { errors }
+    auto print(
+        std::string_view s,
+        source_position  pos = source_position{},
+        bool             track_curr_pos = true,
+        bool             is_known_empty = false
+    )
+        -> void
     {
-        //  "Constraints enable creativity in the right directions"
-        //  sort of applies here
-        //
-        if (
-            !sourcefile.ends_with(".cpp2")
-            && !sourcefile.ends_with(".h2")
-            )
-        {
-            errors.emplace_back(
-                source_position(-1, -1),
-                "source filename must end with .cpp2 or .h2: " + sourcefile
-            );
-        }
+        //  Take ownership of (and reset) just_printed_line_directive value
+        auto line_directive_already_done = std::exchange(just_printed_line_directive, false);
 
-        //  Load the program file into memory
-        //
-        else if (!source.load(sourcefile))
+        //  If the caller is capturing this output, emit to the
+        //  current target instead and skip most positioning logic
+        if (!emit_target_stack.empty())
         {
-            if (errors.empty()) {
-                errors.emplace_back(
-                    source_position(-1, -1),
-                    "file not found: " + sourcefile
-                );
+            //  If capturing to a string, emit to the specified string
+            if (emit_target_stack.back() == target_type::string) {
+                assert(!emit_string_targets.empty());
+                *emit_string_targets.back() += s;
             }
-            source_loaded = false;
-        }
-
-        else
-        {
-            //  Tokenize
-            //
-            tokens.lex(source.get_lines());
-
-            //  Parse
-            //
-            try
-            {
-                for (auto const& [line, entry] : tokens.get_map()) {
-                    if (!parser.parse(entry, tokens.get_generated())) {
-                        errors.emplace_back(
-                            source_position(line, 0),
-                            "parse failed for section starting here",
-                            false,
-                            true    // a noisy fallback error message
-                        );
-                    }
-                }
 
-                //  Sema
-                parser.visit(sema);
-                if (!sema.apply_local_rules()) {
-                    violates_initialization_safety = true;
-                }
-            }
-            catch (std::runtime_error& e) {
-                errors.emplace_back(
-                    source_position(-1, -1),
-                    e.what()
-                );
+            //  If capturing to a vector of chunks, emit to that
+            else {
+                assert(!emit_text_chunks_targets.empty());
+                emit_text_chunks_targets.back()->insert( emit_text_chunks_targets.back()->begin(), text_with_pos(std::string(s), pos) );
             }
-        }
-    }
-
-
-    //-----------------------------------------------------------------------
-    //  lower_to_cpp1
-    //
-    //  Emits the target file with the last '2' stripped
-    //
-    struct lower_to_cpp1_ret {
-        lineno_t cpp1_lines = 0;
-        lineno_t cpp2_lines = 0;
-    };
-    auto lower_to_cpp1()
-        -> lower_to_cpp1_ret
-    {
-        auto ret = lower_to_cpp1_ret{};
 
-        //  Only lower to Cpp1 if we haven't already encountered errors
-        if (!errors.empty()) {
-            return {};
+            return;
         }
 
-        //  Now we'll open the Cpp1 file
-        auto cpp1_filename = sourcefile.substr(0, std::ssize(sourcefile) - 1);
-        if (!flag_cpp1_filename.empty()) {
-            cpp1_filename = flag_cpp1_filename; // use override if present
-        }
+        //  Otherwise, we'll actually print the string to the output file
+        //  and update our curr_pos position
 
-        printer.open(
-            sourcefile,
-            cpp1_filename,
-            tokens.get_comments(),
-            source,
-            parser
-        );
-        if (!printer.is_open()) {
-            errors.emplace_back(
-                source_position{},
-                "could not open output file " + cpp1_filename
-            );
-            return {};
+        if (s.length() > 0) {
+            last_printed_char = s.back();
         }
 
-        //  Generate a reasonable macroized name
-        auto cpp1_FILENAME = to_upper_and_underbar(cpp1_filename);
-
-
-        //---------------------------------------------------------------------
-        //  Do lowered file prolog
-        //
-        //  Only emit extra lines if we actually have Cpp2, because
-        //  we want Cpp1-only files to pass through with zero changes
-        //  (unless the user requested import/include of std)
+        //  Reject consecutive empty lines: If this line is empty
         if (
-            source.has_cpp2()
-            || flag_import_std
-            || flag_include_std
+            ( s == "\n" || is_known_empty )
+            && curr_pos.colno <= 1
             )
         {
-            if (flag_emit_cppfront_info) {
-                printer.print_extra(
-                    "\n// Generated by cppfront "
-                    #include "version.info"
-                    " build "
-                    #include "build.info"
-                );
+            //  And so was the last one, update logical position only
+            //  and increment empty_lines_suppressed instead of printing
+            if (last_was_empty) {
+                if (track_curr_pos) {
+                    ++curr_pos.lineno;
+                    curr_pos.colno = 1;
+                }
+                ++empty_lines_suppressed;
+                return;
             }
-            printer.print_extra( "\n" );
-            if (cpp1_filename.back() == 'h') {
-                printer.print_extra( "#ifndef " + cpp1_FILENAME+"_CPP2\n");
-                printer.print_extra( "#define " + cpp1_FILENAME+"_CPP2" + "\n\n" );
+            //  If this is the first consecutive empty, remember and continue
+            last_was_empty = true;
+        }
+        //  Otherwise, if this line is not empty
+        else {
+            //  Remember that this line was not empty
+            last_was_empty = false;
+
+            //  And if we did suppress any empties, emit a #line to resync
+            if (empty_lines_suppressed > 0) {
+                if (!line_directive_already_done) {
+                    print_line_directive(curr_pos.lineno);
+                }
+                empty_lines_suppressed = 0;
             }
+        }
 
-            if (flag_use_source_location) {
-                printer.print_extra( "#define CPP2_USE_SOURCE_LOCATION Yes\n" );
+        //  Output the string
+        assert (out);
+        *out << s;
+
+        //  Update curr_pos by finding how many line breaks s contained,
+        //  and where the last one was which determines our current colno
+        if (track_curr_pos)
+        {
+            auto last_newline = std::string::npos;  // the last newline we found in the string
+            auto newline_pos  = std::size_t(0);     // the current newline we found in the string
+            while ((newline_pos = s.find('\n', newline_pos)) != std::string::npos)
+            {
+                //  For each line break we find, reset pad and inc current lineno
+                pad_for_this_line = 0;
+                ++curr_pos.lineno;
+                last_newline = newline_pos;
+                ++newline_pos;
             }
 
-            if (flag_include_std) {
-                printer.print_extra( "#define CPP2_INCLUDE_STD         Yes\n" );
+            //  Now also adjust the colno
+            if (last_newline != std::string::npos) {
+                //  If we found a newline, it's the distance from the last newline to EOL
+                curr_pos.colno = unsafe_narrow<colno_t>(s.length() - last_newline);
             }
-            else if (flag_import_std) {
-                printer.print_extra( "#define CPP2_IMPORT_STD          Yes\n" );
+            else {
+                //  Else add the length of the string
+                curr_pos.colno += unsafe_narrow<colno_t>(s.length());
             }
+        }
+    }
 
-            if (flag_no_exceptions) {
-                printer.print_extra( "#define CPP2_NO_EXCEPTIONS       Yes\n" );
-            }
 
-            if (flag_no_rtti) {
-                printer.print_extra( "#define CPP2_NO_RTTI             Yes\n" );
-            }
+    //-----------------------------------------------------------------------
+    //  Internal helpers
+
+    //  Start a new line if we're not in col 1 already
+    //
+    auto ensure_at_start_of_new_line()
+        -> void
+    {
+        if (curr_pos.colno > 1) {
+            auto old_pos = curr_pos;
+            print( "\n" );
+            assert(curr_pos.lineno == old_pos.lineno+1);
+            assert(curr_pos.colno == 1);
         }
+    }
 
-        auto map_iter = tokens.get_map().cbegin();
-        auto hpp_includes = std::string{};
+    //  Print a #line directive
+    //
+    auto print_line_directive( lineno_t line )
+        -> void
+    {
+        //  Ignore requests from generated code (negative line numbers)
+        if (line < 1) {
+            return;
+        }
 
+        //  Otherwise, implement the request
+        prev_line_info = { curr_pos.lineno, { } };
+        ensure_at_start_of_new_line();
 
-        //---------------------------------------------------------------------
-        //  Do phase0_type_decls
-        assert(printer.get_phase() == printer.phase0_type_decls);
+        //  Not using print() here because this is transparent to the curr_pos
+        if (!poptions->clean_cpp1) {
+            assert (out);
+            *out << "#line " << line << " " << std::quoted(cpp2_filename) << "\n";
+        }
+        just_printed_line_directive = true;
+    }
 
-        if (
-            source.has_cpp2()
-            && !flag_clean_cpp1
-            )
-        {
-            printer.print_extra( "\n//=== Cpp2 type declarations ====================================================\n\n" );
+    //  Catch up with comment/blank lines
+    //
+    auto print_comment(comment const& c)
+        -> void
+    {
+        //  For a line comment, start it at the right indentation and print it
+        //  with a newline end
+        if (c.kind == comment::comment_kind::line_comment) {
+            print( pad( c.start.colno - curr_pos.colno + 1 ) );
+            print( c.text );
+            assert( c.text.find("\n") == std::string::npos );  // we shouldn't have newlines
+            print("\n");
         }
 
-        if (
-            !tokens.get_map().empty()
-            || flag_import_std
-            || flag_include_std
-            )
-        {
-            printer.print_extra( "\n#include \"cpp2util.h\"\n\n" );
+        //  For a stream comment, pad out to its column (if we haven't passed it already)
+        //  and emit it there
+        else {
+            print( pad( c.start.colno - curr_pos.colno ) );
+            print( c.text );
         }
 
         if (
-            source.has_cpp2()
-            && !flag_clean_cpp1
+            out == &out_buffer
+            && !in_memory
             )
         {
-            printer.reset_line_to(1, true);
+            buffered_comments.push_back( &c );
         }
+        else {
+            c.dbg_was_printed = true;
+        }
+    }
 
-        for (auto& section : tokens.get_map())
-        {
-            assert (!section.second.empty());
+    auto flush_comments( source_position pos )
+        -> void
+    {
+        if (!pcomments) {
+            return;
+        }
 
-            //  Get the parse tree for this section and emit each forward declaration
-            auto decls = parser.get_parse_tree_declarations_in_range(section.second);
-            for (auto& decl : decls) {
-                assert(decl);
-                emit(*decl);
+        //  For convenience
+        auto& comments = *pcomments;
+
+        //  Add unprinted comments and blank lines as needed to catch up vertically
+        //
+        while (curr_pos.lineno < pos.lineno)
+        {
+            //  If a comment goes on this line, print it
+            if (
+                next_comment < std::ssize(comments)
+                && comments[next_comment].start.lineno <= curr_pos.lineno
+                )
+            {
+                //  Emit non-function body comments in phase1_type_defs_func_decls,
+                //  and emit function body comments in phase2_func_defs
+                //  (and also the deferred comments, see defer_comments_before)
+                assert(pparser);
+                auto in_phase2 =
+                    pparser->is_within_function_body( comments[next_comment].start.lineno )
+                    || deferred_comments.contains( &comments[next_comment] );
+                if (
+                    (
+                        phase == phase1_type_defs_func_decls
+                        && !in_phase2
+                        )
+                    ||
+                    (
+                        phase == phase2_func_defs
+                        && in_phase2
+                        )
+                    )
+                {
+                    print_comment( comments[next_comment] );
+                    assert(curr_pos.lineno <= pos.lineno);  // we shouldn't have overshot
+                }
+
+                ++next_comment;
+            }
+
+            //  Otherwise, just print a blank line
+            else {
+                print("\n");
+            }
+        }
+    }
+
+    auto print_unprinted_comments()
+    {
+        for (auto const& c : *pcomments) {
+            if (!c.dbg_was_printed) {
+                print_comment(c);
             }
         }
+    }
 
+    //  Position ourselves as close to pos as possible,
+    //  and catch up with displaying comments
+    //
+    auto align_to( source_position pos )
+        -> void
+    {
+        auto on_same_line = curr_pos.lineno == pos.lineno;
 
-        //---------------------------------------------------------------------
-        //  Do phase1_type_defs_func_decls
-        //
-        printer.finalize_phase();
-        printer.next_phase();
+        //  Ignoring this logic is used when we're generating new code sections,
+        //  such as return value structs, and emitting raw string literals
+        if (ignore_align) {
+            print( pad( ignore_align_indent - curr_pos.colno ) );
+            return;
+        }
+
+        //  Otherwise, we need to apply our usual alignment logic
+
+        //  Catch up with displaying comments
+        flush_comments( pos );
 
+        //  If we're not on the right line
         if (
-            source.has_cpp2()
-            && !flag_clean_cpp1
+            printed_extra
+            && !on_same_line
             )
         {
-            printer.print_extra( "\n//=== Cpp2 type definitions and function declarations ===========================\n\n" );
-            printer.reset_line_to(1, true);
+            print_line_directive(pos.lineno);
+            curr_pos.lineno = pos.lineno;
+            printed_extra = false;
+        }
+        else if (curr_pos.lineno < pos.lineno)
+        {
+            //  In case we're just one away, try a blank line
+            //  (this might get ignored and we'll get the line directive)
+            print( "\n" );
+            if (curr_pos.lineno != pos.lineno) {
+                print_line_directive(pos.lineno);
+            }
+            curr_pos.lineno = pos.lineno;
         }
 
-        assert (printer.get_phase() == positional_printer::phase1_type_defs_func_decls);
-        for (
-            lineno_t curr_lineno = 0;
-            auto const& line : source.get_lines()
+        //  Finally, align to the target column, if we're on the right line
+        //  and not one-past-the-end on the extra line at section end)
+        assert(
+            psource
+            && 0 <= curr_pos.lineno
+            && curr_pos.lineno < std::ssize(psource->get_lines())+1
+        );
+        if (
+            curr_pos.lineno == pos.lineno
+            && curr_pos.lineno < std::ssize(psource->get_lines())
             )
         {
-            //  Skip dummy line we added to make 0-vs-1-based offsets readable
-            if (curr_lineno != 0)
+            //  Record this line's indentation as the 'last' line for next time
+            last_line_indentation = psource->get_lines()[curr_pos.lineno].indent();
+
+            //  If this line was originally densely spaced (had <2 whitespace
+            //  between all tokens), then the programmer likely wasn't doing a lot
+            //  of special formatting...
+            if (psource->get_lines()[curr_pos.lineno].all_tokens_are_densely_spaced)
             {
-                //  If it's a Cpp1 line, emit it
-                if (line.cat != source_line::category::cpp2)
+                //  For the first token in a line, use the line's original indentation
+                if (curr_pos.colno <= 1)
                 {
-                    if (
-                        source.has_cpp2()
-                        && line.cat != source_line::category::preprocessor
-                        )
-                    {
-                        ++ret.cpp2_lines;
-                    }
-                    else
-                    {
-                        ++ret.cpp1_lines;
-                    }
-
-                    if (
-                        flag_cpp2_only
-                        && !line.text.empty()
-                        && line.cat != source_line::category::comment
-                        && line.cat != source_line::category::import
-                        )
-                    {
-                        if (line.cat == source_line::category::preprocessor) {
-                            if (!line.text.ends_with(".h2\"")) {
-                                errors.emplace_back(
-                                    source_position(curr_lineno, 1),
-                                    "pure-cpp2 switch disables the preprocessor, including #include (except of .h2 files) - use import instead (note: 'import std;' is implicit in -pure-cpp2)"
-                                );
-                                return {};
-                            }
-                        }
-                        else {
-                            errors.emplace_back(
-                                source_position(curr_lineno, 1),
-                                "pure-cpp2 switch disables Cpp1 syntax"
-                            );
-                            return {};
-                        }
-                    }
-
-                    if (
-                        line.cat == source_line::category::preprocessor
-                        && line.text.ends_with(".h2\"")
-                        )
-                    {
-                        //  Strip off the 2"
-                        auto h_include = line.text.substr(0, line.text.size()-2);
-                        printer.print_cpp1( h_include + "\"", curr_lineno );
-                        hpp_includes += h_include + "pp\"\n";
-                    }
-                    else {
-                        printer.print_cpp1( line.text, curr_lineno );
-                    }
+                    print( pad( psource->get_lines()[curr_pos.lineno].indent() ) );
                 }
-
-                //  If it's a Cpp2 line...
+                //  For later tokens, don't try to add padding
                 else {
-                    ++ret.cpp2_lines;
-
-                    //  We should be in a position to emit a set of Cpp2 declarations
                     if (
-                        map_iter != tokens.get_map().cend()
-                        && map_iter->first /*line*/ <= curr_lineno
+                        last_printed_char == ';'
+                        && on_same_line
                         )
                     {
-                        //  We should be here only when we're at exactly the first line of a Cpp2 section
-                        assert (map_iter->first == curr_lineno);
-                        assert (!map_iter->second.empty());
-
-                        //  Get the parse tree for this section and emit each forward declaration
-                        auto decls = parser.get_parse_tree_declarations_in_range(map_iter->second);
-                        for (auto& decl : decls) {
-                            assert(decl);
-                            emit(*decl);
-                        }
-                        ++map_iter;
+                        print( " " );
                     }
                 }
             }
-            ++curr_lineno;
+            //  Otherwise, make a best effort to adjust position with some padding
+            else
+            {
+                pos.colno = std::max( 1, pos.colno + pad_for_this_line );
+                print( pad( pos.colno - curr_pos.colno ) );
+            }
         }
+    }
 
-        //  We can stop here if there's no Cpp2 code -- a file with no Cpp2
-        //  should have perfect passthrough verifiable with diff, including
-        //  that we didn't misidentify anything as Cpp2 (even in the
-        //  presence of nonstandard vendor extensions)
-        //
-        if (!source.has_cpp2()) {
-            assert(ret.cpp2_lines == 0);
-            return ret;
+
+public:
+    //  Called in phase 1 instead of printing a function declaration: the
+    //  not-yet-printed comments before pos belong to that function, so
+    //  leave them for phase 2 to print with its definition
+    //
+    auto defer_comments_before( source_position pos )
+        -> void
+    {
+        if (!pcomments) {
+            return;
+        }
+        assert(
+            phase == phase1_type_defs_func_decls
+            && pparser
+        );
+        for (
+            auto i = next_comment;
+            i < std::ssize(*pcomments) && (*pcomments)[i].start < pos;
+            ++i
+            )
+        {
+            auto const& c = (*pcomments)[i];
+            if (!pparser->is_within_function_body( c.start.lineno )) {
+                deferred_comments.insert( &c );
+            }
         }
+    }
 
-        //  If there is Cpp2 code, we have more to do...
 
-        //  First, if this is a .h2 and in a -pure-cpp2 compilation,
-        //  we need to switch filenames
+    //-----------------------------------------------------------------------
+    //  Finalize phase
+    //
+    auto finalize_phase(bool print_remaining_comments = false)
+    {
         if (
-            cpp1_filename.back() == 'h'
-            && flag_cpp2_only
+            is_open()
+            && psource
+            && psource->has_cpp2()
             )
         {
-            printer.print_extra( "\n#endif\n" );
+            flush_comments( {curr_pos.lineno+1, 1} );
 
-            printer.reopen();
-            if (!printer.is_open()) {
-                errors.emplace_back(
-                    source_position{},
-                    "could not open second output file " + cpp1_filename
-                );
-                return {};
+            if (print_remaining_comments) {
+                print_unprinted_comments();
             }
 
-            printer.print_extra( "\n#ifndef " + cpp1_FILENAME+"_CPP2" );
-            printer.print_extra( "\n#error This file is part of a '.h2' header compiled to be consumed from another -pure-cpp2 file. To use this file, write '#include \"" + cpp1_filename + "2\"' in a '.h2' or '.cpp2' file compiled with -pure-cpp2."  );
-            printer.print_extra( "\n#endif\n" );
-
-            cpp1_FILENAME += "PP";
-            printer.print_extra( "\n#ifndef " + cpp1_FILENAME+"_CPP2" );
-            printer.print_extra( "\n#define " + cpp1_FILENAME+"_CPP2" + "\n\n" );
-
-            printer.print_extra( hpp_includes );
+            //  Always make sure the very last line ends with a newline
+            //  (not really necessary but makes some tools quieter)
+            //  -- but only if there's any Cpp2, otherwise don't
+            //  because passing through all-Cpp1 code should always
+            //  remain diff-identical
+            if (phase == phase2_func_defs) {
+                print_extra("\n");
+            }
         }
+    }
 
 
-        //---------------------------------------------------------------------
-        //  Do phase2_func_defs
-        //
-        printer.finalize_phase();
-        printer.next_phase();
-
-        if (
-            source.has_cpp2()
-            && !flag_clean_cpp1
-            )
-        {
-            printer.print_extra( "\n//=== Cpp2 function definitions =================================================\n\n" );
-            printer.reset_line_to(1, true);
+    //-----------------------------------------------------------------------
+    //  Open
+    //
+    //  in_memory_  print to memory instead of files, see take_memory_files
+    //
+    auto open(
+        std::string                 cpp2_filename_,
+        std::string                 cpp1_filename_,
+        std::vector<comment> const& comments,
+        cpp2::source const&         source,
+        cpp2::parser const&         parser,
+        translation_options const&  options,
+        bool                        in_memory_ = false
+    )
+        -> void
+    {
+        cpp2_filename = (options.line_paths) ?
+            std::filesystem::absolute(std::filesystem::path(cpp2_filename_)).string() :
+            cpp2_filename_;
+        assert(
+            !is_open()
+            && !pcomments
+            && "ICE: tried to call .open twice"
+        );
+        cpp1_filename = cpp1_filename_;
+        in_memory     = in_memory_;
+        if (in_memory) {
+            out = &out_buffer;
         }
-
-        for (auto& section : tokens.get_map())
-        {
-            assert (!section.second.empty());
-
-            //  Get the parse tree for this section and emit each forward declaration
-            auto decls = parser.get_parse_tree_declarations_in_range(section.second);
-            for (auto& decl : decls) {
-                assert(decl);
-                emit(*decl);
-            }
+        else if (cpp1_filename == "stdout") {
+            out = &std::cout;
+        }
+        else {
+            out_file.open(cpp1_filename);
+            out = &out_file;
         }
+        pcomments = &comments;
+        psource   = &source;
+        pparser   = &parser;
+        poptions  = &options;
+    }
 
-        if (cpp1_filename.back() == 'h') {
-            printer.print_extra( "\n#endif" );
+    auto reopen()
+        -> void
+    {
+        assert(
+            is_open()
+            && "ICE: tried to call .reopen without first calling .open"
+        );
+        assert(cpp1_filename.ends_with(".h"));
+        if (in_memory) {
+            memory_files.push_back( out_buffer.str() );
+            out_buffer.str({});
+        }
+        else {
+            out_file.close();
+            out_file.open(cpp1_filename + "pp");
         }
+    }
 
-        printer.finalize_phase( true );
+    //  Flush the output, so the files can be read while still open
+    //
+    auto flush()
+        -> void
+    {
+        if (out) {
+            out->flush();
+        }
+    }
 
-        //  Finally, some debug checks
+    //  Take the files printed in memory, in the order they were opened
+    //
+    auto take_memory_files()
+        -> std::vector<std::string>
+    {
         assert(
-            (!errors.empty() || tokens.num_unprinted_comments() == 0)
-            && "ICE: not all comments were printed"
+            in_memory
+            && "ICE: tried to take memory files from a printer opened for files"
         );
+        memory_files.push_back( out_buffer.str() );
+        out_buffer.str({});
+        return std::move(memory_files);
+    }
 
-        return ret;
+    auto is_open() const
+        -> bool
+    {
+        if (out) {
+            assert(
+                pcomments
+                && "ICE: if is_open, pcomments should also be set"
+            );
+        }
+        return out;
     }
 
 
     //-----------------------------------------------------------------------
+    //  Abandon: close and delete
     //
-    //  emit() functions - each emits a kind of node
-    //
-    //  The body often mirrors the node's visit() function, unless customization
-    //  is needed where Cpp1 and Cpp2 have different grammar orders
-    //
-
-    void print_to_string(
-        std::string* str,
-        auto&        i,
-        auto...      more
-    )
+    auto abandon()
+        -> void
     {
-        //  Quick special-purpose state preservation... this tactical hack
-        //  is fine for now, but if needed more then generalize this
-        auto state1 = need_expression_list_parens;
-        auto state2 = already_moved_that_members;
+        if (!is_open()) {
+            return;
+        }
+        if (out_file.is_open()) {
+            out_file.close();
+            std::remove(cpp1_filename.c_str());
+        }
+    }
 
-        printer.emit_to_string(str);
-        emit(i, more...);
-        printer.emit_to_string();
 
-        //  Restore state
-        need_expression_list_parens.swap(state1);
-        already_moved_that_members .swap(state2);
+    //-----------------------------------------------------------------------
+    //  Position state: Everything that carries over from one printed item
+    //  to the next, so that a declaration can be printed by another printer
+    //  that starts from the same state, and the results spliced back in
+    //
+    struct state
+    {
+        phases                       phase                       = {};
+        source_position              curr_pos                    = {};
+        lineno_t                     generated_pos_line          = {};
+        int                          last_line_indentation       = {};
+        int                          next_comment                = {};
+        bool                         last_was_empty              = {};
+        int                          empty_lines_suppressed      = {};
+        bool                         just_printed_line_directive = {};
+        bool                         printed_extra               = {};
+        char                         last_printed_char           = {};
+        lineno_t                     prev_line                   = {};
+        std::vector<req_act_info>    prev_line_requests          = {};
+        std::vector<source_position> preempt_pos                 = {};
+        int                          pad_for_this_line           = {};
+        bool                         ignore_align                = {};
+        bool                         enable_indent_heuristic     = {};
+
+        auto operator==(state const&) const -> bool = default;
     };
 
-    auto print_to_string(
-        auto&   i,
-        auto... more
-    )
-        -> std::string
+    auto get_state() const
+        -> state
     {
-        auto print = std::string{};
-        print_to_string(&print, i, more...);
-        return print;
-    };
+        assert(
+            emit_target_stack.empty()
+            && "ICE: printer state should not be captured while emitting to a string"
+        );
+        return {
+            phase,
+            curr_pos,
+            generated_pos_line,
+            last_line_indentation,
+            next_comment,
+            last_was_empty,
+            empty_lines_suppressed,
+            just_printed_line_directive,
+            printed_extra,
+            last_printed_char,
+            prev_line_info.line,
+            prev_line_info.requests,
+            preempt_pos,
+            pad_for_this_line,
+            ignore_align,
+            enable_indent_heuristic
+        };
+    }
 
-    //-----------------------------------------------------------------------
-    //  try_emit
-    //
-    //  Helper to emit whatever is in a variant where each
-    //  alternative is a smart pointer
-    //
-    template <int I>
-    auto try_emit(
-        auto&     v,
-        auto&&... more
-    )
+    auto set_state(state const& s)
         -> void
     {
-        if (v.index() == I) {
-            auto const& alt = std::get<I>(v);
-            assert (alt);
-            emit (*alt, CPP2_FORWARD(more)...);
-        }
+        phase                       = s.phase;
+        curr_pos                    = s.curr_pos;
+        generated_pos_line          = s.generated_pos_line;
+        last_line_indentation       = s.last_line_indentation;
+        next_comment                = s.next_comment;
+        last_was_empty              = s.last_was_empty;
+        empty_lines_suppressed      = s.empty_lines_suppressed;
+        just_printed_line_directive = s.just_printed_line_directive;
+        printed_extra               = s.printed_extra;
+        last_printed_char           = s.last_printed_char;
+        prev_line_info              = { s.prev_line, s.prev_line_requests };
+        preempt_pos                 = s.preempt_pos;
+        pad_for_this_line           = s.pad_for_this_line;
+        ignore_align                = s.ignore_align;
+        enable_indent_heuristic     = s.enable_indent_heuristic;
     }
 
 
     //-----------------------------------------------------------------------
+    //  Buffered printing: Open this printer to print to memory instead of
+    //  a file, using the same source information as 'that' printer
     //
-    auto emit(
-        token const&    n,
-        bool            is_qualified = false,
-        source_position pos          = {}
-    )
+    struct buffered_text
+    {
+        std::string                 text     = {};
+        std::vector<comment const*> comments = {};
+    };
+
+    auto open_buffer(positional_printer const& that)
         -> void
-    {   STACKINSTR
-        if (pos == source_position{}) {
-            pos = n.position();
-        }
+    {
+        assert(
+            !is_open()
+            && that.is_open()
+            && "ICE: tried to open a buffer for an unopened printer"
+        );
+        cpp2_filename     = that.cpp2_filename;
+        cpp1_filename     = that.cpp1_filename;
+        out               = &out_buffer;
+        pcomments         = that.pcomments;
+        deferred_comments = that.deferred_comments;
+        psource           = that.psource;
+        pparser           = that.pparser;
+        poptions          = that.poptions;
+    }
 
-        //  Implicit "cpp2::" qualification of Cpp2 fixed-width type aliases
-        //  and cpp2::finally
-        if (
-            !is_qualified
-            && (
-                n.type() == lexeme::Cpp2FixedType
-                || n == "finally"
-                )
-            )
-        {
-            printer.print_cpp2("cpp2::", pos);
-        }
+    //  Take (and reset) everything printed to the buffer so far
+    //
+    auto take_buffer()
+        -> buffered_text
+    {
+        assert(out == &out_buffer);
+        auto ret = buffered_text{ out_buffer.str(), std::move(buffered_comments) };
+        out_buffer.str({});
+        buffered_comments.clear();
+        return ret;
+    }
 
-        //  'this' is not a pointer
-        if (n == "this") {
-            printer.print_cpp2("(*this)", pos);
-        }
-        //  Reclaim the alternative names and some keywords for users
-        else if (
-            n == "and"
-            || n == "and_eq"
-            || n == "bitand"
-            || n == "bitor"
-            || n == "compl"
-            || n == "not"
-            || n == "not_eq"
-            || n == "or"
-            || n == "or_eq"
-            || n == "xor"
-            || n == "xor_eq"
-            || n == "new"
-            || n == "class"
-            || n == "struct"
-            || n == "enum"
-            || n == "union"
-            || n == "default"
-            )
-        {
-            printer.print_cpp2("cpp2_"+n.to_string(), pos);
-        }
-        else {
-            printer.print_cpp2(n, pos, true);
+    //  Print text that another printer already positioned (the caller
+    //  then continues from the state that printer was in afterwards)
+    //
+    auto print_buffered(buffered_text const& b)
+        -> void
+    {
+        assert(
+            is_open()
+            && emit_target_stack.empty()
+            && "ICE: printer must be open and not emitting to a string to print a buffer"
+        );
+        *out << b.text;
+        for (auto c : b.comments) {
+            assert(c);
+            c->dbg_was_printed = true;
         }
-
-        in_definite_init = is_definite_initialization(&n);
     }
 
 
     //-----------------------------------------------------------------------
+    //  Print extra text and don't track positions
+    //  Used for Cpp2 boundary comment and prelude and final newline
     //
-    auto emit(
-        literal_node const& n,
-        source_position     pos = {}
-    )
+    auto print_extra( std::string_view s )
         -> void
-    {   STACKINSTR
-        if (pos == source_position{}) {
-            pos = n.position();
-        }
-
-        assert(n.literal);
-        emit(*n.literal);
-        if (n.user_defined_suffix) {
-            emit(*n.user_defined_suffix);
-        }
+    {
+        assert(
+            is_open()
+            && "ICE: printer must be open before printing"
+        );
+        print( s, source_position{}, false );
+        printed_extra = true;
     }
 
 
     //-----------------------------------------------------------------------
+    //  Print a Cpp1 line, which should be at lineno
     //
-    auto emit(
-        unqualified_id_node const& n,
-        int                        synthesized_multi_return_size = 0,
-        bool                       is_local_name                 = true,
-        bool                       is_qualified                  = false,
-        bool                       is_class_member_access        = false
-    )
+    auto print_cpp1( std::string_view s, lineno_t line )
         -> void
-    {   STACKINSTR
-        assert( n.identifier );
-        auto last_use = is_definite_last_use(n.identifier);
-
-        auto decl = sema.get_declaration_of(*n.identifier, false, true);
+    {
+        assert(
+            is_open()
+            && line >= 0
+            && "ICE: printer must be open before printing, and line number must not be negative (Cpp1 code is never generated)"
+        );
 
-        bool add_forward =
-            last_use
-            && last_use->is_forward
-            && last_use->safe_to_move
-            && !in_non_rvalue_context.back()
-            && !is_class_member_access;
+        //  Always start a Cpp1 line on its own new line
+        ensure_at_start_of_new_line();
 
-        //  We always want to std::move from named return values,
-        //  regardless of their types, so use std::move for that
-        bool add_std_move =
-            synthesized_multi_return_size > 1
-            || (
-                synthesized_multi_return_size == 1
-                && decl
-                && !decl->initializer
-                );
+        //  If we are out of sync with the current logical line number,
+        //  emit a #line directive to re-sync
+        if (curr_pos.lineno != line) {
+            print_line_directive( line );
+            curr_pos.lineno = line;
+        }
 
-        //  Otherwise we'll use cpp2::move
-        bool add_move =
-            !add_forward
-            && (
-                !last_use
-                || last_use->safe_to_move
-                )
-            && (
-                add_std_move
-                || (last_use && !suppress_move_from_last_use)
-                )
-            && !in_non_rvalue_context.back()
-            && !is_class_member_access;
+        //  Print the line
+        assert (curr_pos.colno == 1);
+        print( s );
+        print( "\n" );
+    }
 
-        //  Add `cpp2::move(*this).` when implicitly moving a member on last use
-        //  This way, members of lvalue reference type won't be implicitly moved
-        bool add_this =
-            add_move
-            && decl
-            && decl->identifier
-            && *decl->identifier == "this"
-            && *n.identifier != "this";
 
-        if (
-            add_move
-            && in_single_unqualified_id_return.size() > 0
-            && in_single_unqualified_id_return.back()
-            && (
-                !decl
-                || decl->initializer
-                )
-            )
-        {
-            add_move = false;
-        }
+    //-----------------------------------------------------------------------
+    //  Used when we start a new Cpp2 section, or when we emit the same item
+    //  more than once (notably when we emit operator= more than once)
+    //
+    auto reset_line_to(lineno_t line, bool force = false)
+        -> void
+    {
+        //  Always start a Cpp2 section on its own new line
+        ensure_at_start_of_new_line();
 
+        //  If we are out of sync with the current logical line number,
+        //  emit a #line directive to re-sync
         if (
-            emitting_move_that_function
-            && *n.identifier == "that"
+            force
+            || curr_pos.lineno != line
             )
         {
-            add_move = true;
-        }
-
-        //  For an explicit 'forward' apply forwarding to correct identifier
-        assert (!current_args.empty());
-        if (current_args.back().pass == passing_style::forward) {
-            add_forward = current_args.back().ptoken == n.identifier;
-        }
-
-        if (add_std_move) {
-            printer.print_cpp2("std::move(", n.position());
-        }
-        else if (add_move) {
-            printer.print_cpp2("cpp2::move(", n.position());
+            print_line_directive( line );
+            curr_pos.lineno = line;
         }
 
-        if (add_forward) {
-            printer.print_cpp2("CPP2_FORWARD(", {n.position().lineno, n.position().colno - 8});
-        }
+        assert (curr_pos.colno == 1);
+    }
 
-        if (add_this) {
-            printer.print_cpp2("*this).", n.position());
-        }
 
-        assert(n.identifier);
-        emit(*n.identifier, is_qualified);  // inform the identifier if we know this is qualified
+    //-----------------------------------------------------------------------
+    //  Print a Cpp2 item, which should be at pos
+    //
+    auto print_cpp2(
+        std::string_view s,
+        source_position  pos,
+        bool             leave_newlines_alone = false,
+        bool             is_known_empty = false
 
-        if (n.open_angle != source_position{}) {
-            printer.print_cpp2("<", n.open_angle);
-            auto first = true;
-            for (auto& a : n.template_args) {
-                if (!first) {
-                    printer.print_cpp2(",", a.comma);
+    )
+        -> void
+    {
+        //  If we're printing for real (not to a string target)
+        if (emit_target_stack.empty())
+        {
+            //  If we're in a generated text region (signified by negative
+            //  line numbers), then shunt this call to print_extra instead
+            if (pos.lineno < 1) {
+                if (generated_pos_line != pos.lineno) {
+                    *out << "\n" + std::string(last_line_indentation, ' ');
+                    generated_pos_line = pos.lineno;
                 }
-                first = false;
-                try_emit<template_argument::expression>(a.arg);
-                try_emit<template_argument::type_id   >(a.arg);
+                print_extra(s);
+                return;
             }
-            printer.print_cpp2(">", n.close_angle);
-        }
 
-        in_definite_init = is_definite_initialization(n.identifier);
-        if (
-            !in_definite_init
-            && !in_parameter_list
-            )
-        {
-            if (
-                is_local_name
-                && !(*n.identifier == "this")
-                && !(*n.identifier == "that")
-                && decl
-                && (
-                    synthesized_multi_return_size != 0
-                    //  note pointer equality: if we're not in the actual declaration of n.identifier
-                    || decl->identifier != n.identifier
-                    )
-                //  and this variable was uninitialized
-                && !decl->initializer
-                //  and it's either a non-parameter or an out parameter
-                && (
-                    !decl->parameter
-                    || (
-                        decl->parameter
-                        && decl->parameter->pass == passing_style::out
-                        )
-                    )
-                )
-            {
-                printer.print_cpp2(".value()", n.position());
-            }
-        }
-        else if (synthesized_multi_return_size != 0) {
-            printer.print_cpp2(".value()", n.position());
+            //  Otherwise, we're no longer in generated code, so reset the
+            //  generated code counter
+            generated_pos_line = {};
         }
 
-        if (
-            !add_this
-            && (
-                add_move
-                || add_std_move
-                || add_forward
-                )
+        assert(
+            is_open()
+            && "ICE: printer must be open before printing"
+        );
+
+        //  If there are any embedded newlines, split this string into
+        //  separate print_cpp2 calls
+        if (auto newline_pos = s.find('\n');
+            !leave_newlines_alone
+            && s.length() > 1
+            && newline_pos != s.npos
             )
         {
-            printer.print_cpp2(")", n.position());
-        }
-    }
+            while (newline_pos != std::string_view::npos)
+            {
+                //  Print the text before the next newline
+                if (newline_pos > 0) {
+                    print_cpp2( s.substr(0, newline_pos), pos );
+                }
 
+                //  Emit the newline as a positioned empty string
+                assert (s[newline_pos] == '\n');
+                ++pos.lineno;
+                pos.colno = 1;
+                print_cpp2( "", pos, false, curr_pos.colno <= 1 );
 
-    //-----------------------------------------------------------------------
-    //
-    auto emit(
-        qualified_id_node const& n,
-        bool include_unqualified_id = true
-        )
-        -> void
-    {   STACKINSTR
-        if (!sema.check(n)) {
+                s.remove_prefix( newline_pos+1 );
+                newline_pos = s.find('\n');
+            }
+            //  Print any tail following the last newline
+            if (!s.empty()) {
+                print_cpp2( s, pos );
+            }
             return;
         }
 
-        auto ident = std::string{};
-        printer.emit_to_string(&ident);
+        //  The rest of this call handles a single chunk that's either a
+        //  standalone "\n" or a piece of text that doesn't have a newline
 
-        for (auto const& id : std::span{n.ids}.first(n.ids.size() - !include_unqualified_id))
+        //  Skip alignment work if we're capturing emitted text
+        if (emit_target_stack.empty())
         {
-            if (id.scope_op) {
-                emit(*id.scope_op);
-            }
-            emit(*id.id, 0, true, true);    // inform the unqualified-id that it's qualified
-        }
-
-        printer.emit_to_string();
-        printer.print_cpp2( ident, n.position() );
-    }
+            //  Remember where we are
+            auto last_pos = curr_pos;
 
+            //  We may want to adjust the position based on (1) a position preemption request
+            //  or else (2) to repeat a similar adjustment we discovered on the previous line
+            auto adjusted_pos = pos;
 
-    //-----------------------------------------------------------------------
-    //
-    auto emit(
-        type_id_node const& n,
-        source_position     pos = {}
-    )
-        -> void
-    {   STACKINSTR
-        if (pos == source_position{}) {
-            pos = n.position();
-        }
+            //  (1) See if there's a position preemption request, if so use it up
+            //      For now, the preempt position use cases are about overriding colno
+            //      and only on the same line. In the future, we might have more use cases.
+            if (!preempt_pos.empty()) {
+                if (preempt_pos.back().lineno == pos.lineno) {
+                    adjusted_pos.colno = preempt_pos.back().colno;
+                }
+            }
 
-        if (n.is_wildcard()) {
-            printer.print_cpp2("auto", pos);
-        }
-        else {
-            try_emit<type_id_node::unqualified>(n.id, 0, false);
-            try_emit<type_id_node::qualified  >(n.id);
-            try_emit<type_id_node::keyword    >(n.id);
-        }
+            //  (2) Otherwise, see if there's a previous line's offset to repeat
+            //      If we moved to a new line, then this is the first
+            //      non-comment non-whitespace text on the new line
+            else if (
+                last_pos.lineno == pos.lineno-1
+                && enable_indent_heuristic
+                )
+            {
+                //  If the last line had a request for this colno, remember its actual offset
+                constexpr int sentinel = -100;
+                auto last_line_offset = sentinel;
+                for(auto i = 0;
+                    i < std::ssize(prev_line_info.requests)
+                        && prev_line_info.requests[i].requested <= pos.colno;
+                    ++i
+                    )
+                {
+                    if (prev_line_info.requests[i].requested == pos.colno)
+                    {
+                        last_line_offset = prev_line_info.requests[i].offset;
+                        break;
+                    }
+                }
 
-        for (auto i = n.pc_qualifiers.rbegin(); i != n.pc_qualifiers.rend(); ++i) {
-            if ((**i) == "const") { printer.print_cpp2(" ", pos); }
-            emit(**i, false, pos);
+                //  If there was one, apply the actual column number offset
+                if (last_line_offset > sentinel) {
+                    adjusted_pos.colno += last_line_offset;
+                }
+            }
+            enable_indent_heuristic = true;
+
+            //  If we're changing lines, start accumulating this new line's request/actual adjustment info
+            //  (reusing the requests vector's capacity, this runs for nearly every line)
+            if (last_pos.lineno < adjusted_pos.lineno) {
+                prev_line_info.line = curr_pos.lineno;
+                prev_line_info.requests.clear();
+            }
+
+            align_to(adjusted_pos);
+
+            //  Remember the requested and actual offset columns for this item
+            prev_line_info.requests.push_back( req_act_info( pos.colno /*requested*/ , curr_pos.colno /*actual*/ - pos.colno ) );
         }
+
+        print(s, pos, true, is_known_empty );
     }
 
 
     //-----------------------------------------------------------------------
+    //  Print a Cpp2 item made of several parts, which should be at pos
     //
-    auto emit(
-        id_expression_node const& n,
-        bool                      is_local_name          = true,
-        bool                      is_class_member_access = false
+    //  Equivalent to print_cpp2(part1 + part2 + ..., pos), but the parts
+    //  (strings, tokens, characters, and integers) are joined directly
+    //  into a reused buffer instead of into std::string temporaries
+    //
+    template<typename... Parts>
+        requires (sizeof...(Parts) > 1)
+    auto print_cpp2(
+        source_position pos,
+        Parts const&... parts
     )
         -> void
-    {   STACKINSTR
-        try_emit<id_expression_node::qualified  >(n.id);
-        try_emit<id_expression_node::unqualified>(n.id, 0, is_local_name, false, is_class_member_access);
+    {
+        parts_buffer.clear();
+        append_parts(parts_buffer, parts...);
+        print_cpp2(parts_buffer, pos);
     }
 
 
-    auto emit_prolog_mem_inits(
-        function_prolog const& prolog,
-        colno_t                indent
-    )
+    //-----------------------------------------------------------------------
+    //  Position override control functions
+    //
+
+    //  Use this position instead of the next supplied one
+    //  Useful when Cpp1 syntax is emitted in a different order/verbosity
+    //  than Cpp2 such as with declarations
+    //
+    auto preempt_position_push(source_position pos)
         -> void
-    {   STACKINSTR
-        for (auto& line : prolog.mem_inits) {
-            printer.print_extra("\n");
-            printer.print_extra(pad(indent-1));
-            printer.print_extra(line);
-        }
+    {
+        preempt_pos.push_back( pos );
     }
 
-    auto emit_prolog_statements(
-        function_prolog const& prolog,
-        colno_t                indent
-    )
+    auto preempt_position_pop()
         -> void
-    {   STACKINSTR
-        for (auto& line : prolog.statements) {
-            printer.print_extra("\n");
-            printer.print_extra(pad(indent-1));
-            printer.print_extra(line);
-        }
+    {
+        assert(!preempt_pos.empty());
+        preempt_pos.pop_back();
     }
 
-    auto emit_epilog_statements(
-        std::vector<std::string> const& epilog,
-        colno_t                         indent
-    )
+    //  Add (or, if negative, subtract) padding for the current line only
+    //
+    auto add_pad_in_this_line(colno_t extra)
         -> void
-    {   STACKINSTR
-        for (auto& line : epilog) {
-            printer.print_extra("\n");
-            printer.print_extra(pad(indent-1));
-            printer.print_extra(line);
-        }
+    {
+        pad_for_this_line += extra;
     }
 
-    //-----------------------------------------------------------------------
+    //  Enable indent heuristic for just this line
     //
-    auto emit(
-        compound_statement_node  const& n,
-        function_prolog          const& function_prolog = {},
-        std::vector<std::string> const& function_epilog = {}
-    )
+    auto disable_indent_heuristic_for_next_text()
         -> void
-    {   STACKINSTR
-        emit_prolog_mem_inits(function_prolog, n.body_indent+1);
-
-        printer.print_cpp2( "{", n.open_brace );
-
-        emit_prolog_statements(function_prolog, n.body_indent+1);
+    {
+        enable_indent_heuristic = false;
+    }
 
-        for (auto const& x : n.statements) {
-            assert(x);
-            emit(*x);
+    //  Ignore position information, usually when emitting generated code
+    //  such as generated multi-return type structs
+    //
+    auto ignore_alignment(
+        bool ignore,
+        int  indent = 0
+    )
+        -> void
+    {
+        //  We'll only ever call this in local non-nested true/false pairs.
+        //  If we ever want to generalize (support nesting, or make it non-brittle),
+        //  wrap this in a push/pop stack.
+        if (ignore) {
+            ignore_align        = true;
+            ignore_align_indent = indent;
+            ignore_align_lineno = curr_pos.lineno;      // push state
+        }
+        else {
+            ignore_align        = false;
+            ignore_align_indent = 0;
+            curr_pos.lineno     = ignore_align_lineno;  // pop state
         }
+    }
 
-        emit_epilog_statements( function_epilog, n.body_indent+1);
 
-        printer.print_cpp2( "}", n.close_brace );
+    //-----------------------------------------------------------------------
+    //  Modal state control functions
+    //
+
+    auto next_phase()
+        -> void
+    {
+        inc_phase();
     }
 
+    //  Lower the next declaration(s) as if in phase p, e.g., to emit the
+    //  class definition of a nested type that is defined out of line
+    //  (see type_define_out_of_line) among the phase 2 function definitions;
+    //  returns the previous setting, to restore afterwards
+    auto lower_as_phase(std::optional<phases> p)
+        -> std::optional<phases>
+    {
+        return std::exchange(lowering_phase, p);
+    }
 
-    //-----------------------------------------------------------------------
+    //  Provide an option to store to a given string instead, which is
+    //  useful for capturing Cpp1-formatted output for generated code
     //
-    auto emit(
-        inspect_expression_node const& n,
-        bool                           is_expression
-    )
+    auto emit_to_string( std::string* target = {} )
         -> void
-    {   STACKINSTR
-        auto constexpr_qualifier = std::string{};
-        if (n.is_constexpr) {
-            constexpr_qualifier = "constexpr ";
+    {
+        if (target) {
+            emit_string_targets.push_back( target );
+            emit_target_stack.push_back(target_type::string);
         }
-
-        //  If this is an expression, it will have an explicit result type,
-        //  and we need to start the lambda that we'll immediately invoke
-        auto result_type = std::string{};
-        if (is_expression) {
-            assert(n.result_type);
-            printer.emit_to_string(&result_type);
-            emit(*n.result_type);
-            printer.emit_to_string();
-            printer.print_cpp2("[&] () -> " + result_type + " ", n.position());
+        else {
+            emit_string_targets.pop_back();
+            emit_target_stack.pop_back();
         }
-        printer.print_cpp2("{ " + constexpr_qualifier + "auto&& _expr = ", n.position());
+    }
 
-        assert(n.expression);
-        emit(*n.expression);
-        printer.print_cpp2(";", n.position());
+    //  Provide an option to store to a vector<text_with_pos>, which is
+    //  useful for postfix expression which have to mix unwrapping operators
+    //  with emitting sub-elements such as expression lists
+    //
+    auto emit_to_text_chunks( std::vector<text_with_pos>* target = {} )
+        -> void
+    {
+        if (target) {
+            emit_text_chunks_targets.push_back( target );
+            emit_target_stack.push_back(target_type::chunks);
+        }
+        else {
+            emit_text_chunks_targets.pop_back();
+            emit_target_stack.pop_back();
+        }
+    }
 
-        assert(
-            n.identifier
-            && *n.identifier == "inspect"
-        );
+};
 
-        assert(!n.alternatives.empty());
-        auto found_wildcard = false;
 
-        for (auto first = true; auto&& alt : n.alternatives)
-        {
-            assert(alt && alt->is_as_keyword);
-            if (!first) {
-                printer.print_cpp2("else ", alt->position());
-            }
-            first = false;
+//-----------------------------------------------------------------------
+//
+//  cppfront: a compiler instance
+//
+//-----------------------------------------------------------------------
+//
+struct function_prolog {
+    std::vector<std::string> mem_inits  = {};
+    std::vector<std::string> statements = {};
+};
 
-            auto id = std::string{};
-            printer.emit_to_string(&id);
+class cppfront
+{
+    std::string              sourcefile;
+    translation_options      options;
+    bool                     in_memory = false;     // see take_output_files
+    std::vector<error_entry> errors;
 
-            if (alt->type_id) {
-                emit(*alt->type_id);
-            }
-            else {
-                assert(alt->value);
-                emit(*alt->value);
-            }
-            printer.emit_to_string();
+    //  For building
+    //
+    //  The primary instance owns the front end, and phase 2 lowering
+    //  workers share it read-only (see lower_phase2_in_parallel)
+    //
+    struct front_end {
+        cpp2::source source;
+        cpp2::tokens tokens;
+        cpp2::parser parser;
+        cpp2::sema   sema;
+
+        //  The 'in std::string' parameters to lower as std::string_view
+        std::vector<parameter_declaration_node const*> view_params;
+
+        front_end(std::vector<error_entry>& errors)
+            : source{ errors }
+            , tokens{ errors }
+            , parser{ errors }
+            , sema  { errors }
+        { }
+    };
+    std::unique_ptr<front_end> owned_front_end;
 
-            assert (
-                *alt->is_as_keyword == "is"
-                || *alt->is_as_keyword == "as"
-            );
-            // TODO: pick up 'as' next, for now just do 'is'
+    cpp2::source& source;
+    cpp2::tokens& tokens;
+    cpp2::parser& parser;
+    cpp2::sema&   sema;
 
-            if (*alt->is_as_keyword == "is")
-            {
-                //  Stringize the expression-statement now...
-                auto statement = std::string{};
-                printer.emit_to_string(&statement);
-                emit(*alt->statement);
-                printer.emit_to_string();
-                //  ... and jettison the final ; for an expression-statement
-                while (
-                    !statement.empty()
-                    && (
-                        statement.back() == ';'
-                        || isspace(statement.back())
-                        )
-                    )
-                {
-                    statement.pop_back();
-                }
+    std::vector<parameter_declaration_node const*> const& view_params;
 
-                replace_all( statement, "cpp2::impl::as_<", "cpp2::impl::as<" );
+    bool source_loaded                  = true;
+    bool last_postfix_expr_was_pointer  = false;
+    bool violates_lifetime_safety       = false;
+    bool violates_bounds_safety         = false;
+    bool violates_initialization_safety = false;
+    bool suppress_move_from_last_use    = false;
 
-                //  If this is an inspect-expression, we'll have to wrap each alternative
-                //  in an 'if constexpr' so that its type is ignored for mismatches with
-                //  the inspect-expression's type
-                auto return_prefix = std::string{};
-                auto return_suffix = std::string{";"};   // use this to tack the ; back on in the alternative body
-                if (is_expression) {
-                    return_prefix = "{ if constexpr( requires{" + statement + ";} ) if constexpr( std::is_convertible_v<CPP2_TYPEOF((" + statement + "))," + result_type + "> ) return ";
-                    return_suffix += " }";
-                }
+    declaration_node const* having_signature_emitted = {};
 
-                if (id == "auto") {
-                    found_wildcard = true;
-                    if (is_expression) {
-                        printer.print_cpp2("return ", alt->position());
-                    }
-                }
-                else {
-                    printer.print_cpp2("if " + constexpr_qualifier, alt->position());
-                    if (alt->type_id) {
-                        printer.print_cpp2("(cpp2::impl::is<" + id + ">(_expr)) ", alt->position());
-                    }
-                    else {
-                        assert (alt->value);
-                        printer.print_cpp2("(cpp2::impl::is(_expr, " + id + ")) ", alt->position());
-                    }
-                    printer.print_cpp2(return_prefix, alt->position());
-                }
+    //  The nested type whose out-of-line definition is being emitted
+    //  (see emit_out_of_line_type_definition), and its qualification
+    declaration_node const* defining_out_of_line      = {};
+    std::string             out_of_line_qualification = {};
 
-                printer.print_cpp2(statement, alt->position());
+    declaration_node const*   generating_assignment_from      = {};
+    declaration_node const*   generating_move_from            = {};
+    declaration_node const*   generating_postfix_inc_dec_from = {};
+    bool                      emitting_that_function          = false;
+    bool                      emitting_move_that_function     = false;
+    std::vector<token const*> already_moved_that_members      = {};
 
-                if (
-                    is_expression
-                    && id != "auto"
-                    )
-                {
-                    assert(alt->statement->is_expression());
-                    printer.print_cpp2("; else return " + result_type + "{}", alt->position());
-                    printer.print_cpp2("; else return " + result_type + "{}", alt->position());
-                }
+    struct arg_info {
+        passing_style pass   = passing_style::in;
+        token const*  ptoken = {};
 
-                printer.print_cpp2(return_suffix, alt->position());
-            }
-            else {
-                errors.emplace_back(
-                    alt->position(),
-                    "(temporary alpha limitation) cppfront is still learning 'inspect' - only simple 'is' alternatives are currently supported"
-                );
-                return;
-            }
+        auto operator==(arg_info const&) const -> bool = default;
+    };
+    std::vector<arg_info> current_args  = { {} };
+
+    struct active_using_declaration {
+        token const* identifier = {};
+
+        explicit active_using_declaration(using_statement_node const& n) {
+          if (auto id = get_if<id_expression_node::qualified>(&n.id->id)) {
+              identifier = (*id)->ids.back().id->identifier;
+          }
         }
 
-        if (is_expression) {
-            if (!found_wildcard) {
-                errors.emplace_back(
-                    n.position(),
-                    "an inspect expression must have an `is _` match-anything wildcard alternative"
-                );
-                return;
-            }
+        auto operator==(active_using_declaration const&) const -> bool = default;
+    };
+
+    using source_order_name_lookup_res =
+        std::optional<std::variant<declaration_node const*, active_using_declaration>>;
+
+    //  Stack of the currently active nested declarations we're inside
+    std::vector<declaration_node const*> current_declarations = { {} };
+
+    //  Stack of the currently active names for source order name lookup:
+    //  Like 'current_declarations' + also parameters and using declarations
+    std::vector<source_order_name_lookup_res::value_type> current_names = { {} };
+
+    //  Maintain a stack of the functions we're currently processing, which can
+    //  be up to MaxNestedFunctions in progress (if we run out, bump the Max).
+    //  The main reason for this is to be able to pass function_info's, especially
+    //  their .epilog, by reference for performance while still having lifetime safety
+    struct function_info
+    {
+        declaration_node const*                    decl                         = {};
+        function_type_node const*                  func                         = {};
+        declaration_node::declared_value_set_funcs declared_value_set_functions = {};
+        function_prolog                            prolog                       = {};
+        std::vector<std::string>                   epilog                       = {};
+        int                                        ordinal                      = {};
+
+        function_info(
+            declaration_node const*                    decl_,
+            function_type_node const*                  func_,
+            declaration_node::declared_value_set_funcs declared_value_set_functions_
+        )
+            : decl{decl_}
+            , func{func_}
+            , declared_value_set_functions{declared_value_set_functions_}
+        { }
+    };
+    class current_functions_
+    {
+        stable_vector<function_info> list = { {} };
+    public:
+        auto push(
+            declaration_node const*                    decl,
+            function_type_node const*                  func,
+            declaration_node::declared_value_set_funcs thats
+        ) {
+            list.emplace_back(decl, func, thats);
         }
-        else {
-            printer.print_cpp2("}", n.close_brace);
+
+        auto pop() {
+            list.pop_back();
         }
 
-        //  If this is an expression, finally actually invoke the lambda
-        if (is_expression) {
-            printer.print_cpp2("()", n.close_brace);
+        auto back() -> function_info& {
+            assert(!empty());
+            return list.back();
         }
-    }
 
+        auto empty() -> bool {
+            return list.empty();
+        }
+    };
+    current_functions_ current_functions;
 
-    //-----------------------------------------------------------------------
+    //  For lowering
     //
-    auto emit(selection_statement_node const& n)
-        -> void
-    {   STACKINSTR
-        assert(n.identifier);
-        emit(*n.identifier);
+    positional_printer printer;
+    bool               in_definite_init  = false;
+    bool               in_parameter_list = false;
 
-        if (n.is_constexpr) {
-            printer.print_cpp2(" constexpr", n.position());
-        }
+    struct function_return {
+        parameter_declaration_list_node* param_list;
+        passing_style                    pass;
+        bool                             is_deduced;
 
-        printer.print_cpp2(" (", n.position());
-        printer.add_pad_in_this_line(1);
+        function_return(
+            parameter_declaration_list_node* param_list_,
+            passing_style                    pass_ = passing_style::invalid,
+            bool                             is_deduced_ = false
+        )
+            : param_list{param_list_}
+            , pass{pass_}
+            , is_deduced{is_deduced_}
+        { }
 
-        assert(n.expression);
-        emit(*n.expression);
+        auto operator==(function_return const&) const -> bool = default;
+    };
+    std::vector<function_return>         function_returns;
+    parameter_declaration_list_node      single_anon;
+        //  special value - hack for now to note single-anon-return type kind in this function_returns working list
+    std::vector<std::string>                      function_requires_conditions;
 
-        printer.print_cpp2(") ", n.position());
-        printer.add_pad_in_this_line(1);
+    struct iter_info {
+        iteration_statement_node const* stmt;
+        bool used = false;
 
-        assert(n.true_branch);
-        emit(*n.true_branch);
+        auto operator==(iter_info const&) const -> bool = default;
+    };
+    std::vector<iter_info> iteration_statements;
 
-        if (n.has_source_false_branch) {
-            printer.print_cpp2("else ", n.else_pos);
-            emit(*n.false_branch);
-        }
-    }
+    std::vector<bool>                             in_non_rvalue_context   = { false };
+    std::vector<bool>                             in_single_unqualified_id_return  = { false };
+    std::vector<bool>                             need_expression_list_parens = { true };
+    auto push_need_expression_list_parens( bool b ) -> void { need_expression_list_parens.push_back(b);            }
+    auto pop_need_expression_list_parens()          -> void { assert(std::ssize(need_expression_list_parens) > 1);
+                                                              need_expression_list_parens.pop_back();              }
+    auto should_add_expression_list_parens()        -> bool { assert(!need_expression_list_parens.empty());
+                                                              return need_expression_list_parens.back();           }
+    auto consumed_expression_list_parens()          -> void { if( std::ssize(need_expression_list_parens) > 1 )
+                                                                  need_expression_list_parens.back() = false;      }
 
+    //  For -source-sites, the checks given a site ID so far. Unlike the
+    //  lowering state, these are collected from the phase 2 workers like
+    //  errors are, because each ID depends only on the check's position
+    //
+    struct source_site {
+        std::uint32_t   id;
+        source_position pos;
+        std::string     function;
+    };
+    std::vector<source_site> source_sites;
 
-    //-----------------------------------------------------------------------
+    //  For -safety-report, the safety checks emitted or elided so far,
+    //  collected from the phase 2 workers like source_sites are
     //
-    auto emit(iteration_statement_node const& n)
-        -> void
-    {   STACKINSTR
-        assert(n.identifier);
+    struct check_record {
+        std::string_view kind;
+        source_position  pos;
+        std::string      function;
+        std::string_view elided_by;     // the flag that disabled it, or empty
+    };
+    std::vector<check_record> checks;
 
-        iteration_statements.push_back({ &n, false});
-        auto labelname = std::string{};
-        if (n.label) {
-            labelname = n.label->to_string();
-        }
+    //  Namespace-scope functions that phase 1 doesn't forward-declare,
+    //  because nothing uses them before their definitions
+    //  (see find_functions_declared_by_definition)
+    //
+    std::unordered_set<declaration_node const*> declared_by_definition;
 
-        //  Handle while
-        //
-        if (*n.identifier == "while") {
-            assert(
-                n.condition
-                && n.statements
-                && !n.range
-                && !n.body
-            );
+    //  For -whole-program, the functions and types that get internal
+    //  linkage and the types that get 'final'
+    //  (see find_whole_program_inferences)
+    //
+    std::unordered_set<declaration_node const*> internal_linkage;
+    std::unordered_set<declaration_node const*> inferred_final;
 
-            //  We emit Cpp2 while loops as Cpp2 for loops if there's a "next" clause
-            if (!n.next_expression) {
-                printer.print_cpp2("while( ", n.position());
-                emit(*n.condition);
-            }
-            else {
-                printer.print_cpp2("for( ; ", n.position());
-                emit(*n.condition);
-                printer.print_cpp2("; ", n.position());
-                printer.add_pad_in_this_line(-10);
-                emit(*n.next_expression);
-            }
-            printer.print_cpp2(" ) ", n.position());
-            if (!labelname.empty()) {
-                printer.print_extra("{");
-            }
-            emit(*n.statements);
-            if (!labelname.empty()) {
-                printer.print_extra(" CPP2_CONTINUE_BREAK("+labelname+") }");
-            }
+    //  For -source-sites, the 'new' names that are Cpp2's own unique.new,
+    //  shared.new, or new, which get their call site as extra template
+    //  arguments (a user-defined new<T> doesn't)
+    //
+    std::unordered_set<token const*> source_site_news;
+
+    //  For -mark-purity, the functions marked const or pure, and what was
+    //  concluded about each function and why (see find_function_purity)
+    //
+    struct purity_note {
+        source_position pos;
+        std::string     msg;
+    };
+    std::unordered_map<declaration_node const*, function_purity> inferred_purity;
+    std::vector<purity_note>                                     purity_notes;
+
+    //  For phase 2 lowering workers (see lower_phase2_in_parallel)
+    //
+    position_labels labels;
+    bool            is_lowering_worker    = false;
+    bool            needs_serial_lowering = false;  // set by a worker that can't lower its declaration out of order
+
+    //  Everything that carries over from lowering one declaration to the next
+    struct lowering_state
+    {
+        positional_printer::state                             printer                         = {};
+        bool                                                  last_postfix_expr_was_pointer   = {};
+        bool                                                  suppress_move_from_last_use     = {};
+        bool                                                  in_definite_init                = {};
+        bool                                                  in_parameter_list               = {};
+        bool                                                  emitting_that_function          = {};
+        bool                                                  emitting_move_that_function     = {};
+        declaration_node const*                               having_signature_emitted        = {};
+        declaration_node const*                               generating_assignment_from      = {};
+        declaration_node const*                               generating_move_from            = {};
+        declaration_node const*                               generating_postfix_inc_dec_from = {};
+        std::vector<token const*>                             already_moved_that_members      = {};
+        std::vector<arg_info>                                 current_args                    = {};
+        std::vector<declaration_node const*>                  current_declarations            = {};
+        std::vector<source_order_name_lookup_res::value_type> current_names                   = {};
+        std::vector<function_return>                          function_returns                = {};
+        std::vector<std::string>                              function_requires_conditions    = {};
+        std::vector<iter_info>                                iteration_statements            = {};
+        std::vector<bool>                                     in_non_rvalue_context           = {};
+        std::vector<bool>                                     in_single_unqualified_id_return = {};
+        std::vector<bool>                                     need_expression_list_parens     = {};
+
+        auto operator==(lowering_state const&) const -> bool = default;
+    };
+
+    auto get_lowering_state() const
+        -> lowering_state
+    {
+        return {
+            printer.get_state(),
+            last_postfix_expr_was_pointer,
+            suppress_move_from_last_use,
+            in_definite_init,
+            in_parameter_list,
+            emitting_that_function,
+            emitting_move_that_function,
+            having_signature_emitted,
+            generating_assignment_from,
+            generating_move_from,
+            generating_postfix_inc_dec_from,
+            already_moved_that_members,
+            current_args,
+            current_declarations,
+            current_names,
+            function_returns,
+            function_requires_conditions,
+            iteration_statements,
+            in_non_rvalue_context,
+            in_single_unqualified_id_return,
+            need_expression_list_parens
+        };
+    }
+
+    auto set_lowering_state(lowering_state const& s)
+        -> void
+    {
+        printer.set_state(s.printer);
+        last_postfix_expr_was_pointer   = s.last_postfix_expr_was_pointer;
+        suppress_move_from_last_use     = s.suppress_move_from_last_use;
+        in_definite_init                = s.in_definite_init;
+        in_parameter_list               = s.in_parameter_list;
+        emitting_that_function          = s.emitting_that_function;
+        emitting_move_that_function     = s.emitting_move_that_function;
+        having_signature_emitted        = s.having_signature_emitted;
+        generating_assignment_from      = s.generating_assignment_from;
+        generating_move_from            = s.generating_move_from;
+        generating_postfix_inc_dec_from = s.generating_postfix_inc_dec_from;
+        already_moved_that_members      = s.already_moved_that_members;
+        current_args                    = s.current_args;
+        current_declarations            = s.current_declarations;
+        current_names                   = s.current_names;
+        function_returns                = s.function_returns;
+        function_requires_conditions    = s.function_requires_conditions;
+        iteration_statements            = s.iteration_statements;
+        in_non_rvalue_context           = s.in_non_rvalue_context;
+        in_single_unqualified_id_return = s.in_single_unqualified_id_return;
+        need_expression_list_parens     = s.need_expression_list_parens;
+    }
+
+    //  Position labels are numbered in first-use order, which a worker
+    //  can't know, so it can only use labels that were already assigned
+    //
+    auto position_label(token const* t)
+        -> std::string
+    {
+        if (!is_lowering_worker) {
+            return labels.get(t);
         }
+        auto label = labels.find(t);
+        if (label.empty()) {
+            needs_serial_lowering = true;
+        }
+        return label;
+    }
 
-        //  Handle do
+    //-----------------------------------------------------------------------
+    //  load_and_analyze: Load the source (from the file, or from in_text
+    //  if not null), then lex, parse, and run sema on it
+    //
+    auto load_and_analyze(std::istream* in_text)
+        -> void
+    {
+        //  "Constraints enable creativity in the right directions"
+        //  sort of applies here
         //
-        else if (*n.identifier == "do") {
-            assert(
-                n.condition
-                && n.statements
-                && !n.range
-                && !n.body
+        if (
+            !sourcefile.ends_with(".cpp2")
+            && !sourcefile.ends_with(".h2")
+            )
+        {
+            errors.emplace_back(
+                source_position(-1, -1),
+                "source filename must end with .cpp2 or .h2: " + sourcefile
             );
+        }
 
-            printer.print_cpp2("do ", n.position());
-            if (!labelname.empty()) {
-                printer.print_extra("{");
+        //  Load the program file into memory
+        //
+        else if (!(in_text ? source.load(*in_text) : source.load(sourcefile)))
+        {
+            if (errors.empty()) {
+                errors.emplace_back(
+                    source_position(-1, -1),
+                    "file not found: " + sourcefile
+                );
             }
-            emit(*n.statements);
-            if (!labelname.empty()) {
-                printer.print_extra(" CPP2_CONTINUE_BREAK("+labelname+") }");
+            source_loaded = false;
+        }
+
+        else
+        {
+            //  Tokenize
+            //
+            tokens.lex(source.get_lines());
+
+            //  Parse
+            //
+            try
+            {
+                for (auto const& [line, entry] : tokens.get_map()) {
+                    if (!parser.parse(entry, tokens.get_generated())) {
+                        errors.emplace_back(
+                            source_position(line, 0),
+                            "parse failed for section starting here",
+                            false,
+                            true    // a noisy fallback error message
+                        );
+                    }
+                }
+
+                //  Sema
+                parser.visit(sema);
+                if (!sema.apply_local_rules()) {
+                    violates_initialization_safety = true;
+                }
+
+                if (options.string_view_params) {
+                    auto finder = string_view_param_finder{owned_front_end->view_params, source, tokens, parser};
+                    parser.visit(finder);
+                }
             }
-            printer.print_cpp2(" while ( ", n.position());
-            if (n.next_expression) {
-                //  Gotta say, this feels kind of nifty... short-circuit eval
-                //  and smuggling work into a condition via a lambda, O my...
-                printer.print_cpp2("[&]{ ", n.position());
-                emit(*n.next_expression);
-                printer.print_cpp2(" ; return true; }() && ", n.position());
+            catch (std::runtime_error& e) {
+                errors.emplace_back(
+                    source_position(-1, -1),
+                    e.what()
+                );
             }
-            emit(*n.condition);
-            printer.print_cpp2(");", n.position());
         }
+    }
 
-        //  Handle for
-        //
-        else if (*n.identifier == "for") {
-            assert(
-                !n.condition
-                && !n.statements
-                && n.range
-                && n.parameter
-                && n.body
-            );
-
-            //  Note: This used to emit cpp2_range as a range-for-loop scope variable,
-            //        but some major compilers seem to have random troubles with that;
-            //        the workaround to avoid their bugs for now is to emit a { } block
-            //        around the Cpp1 range-for and make the scope variable a normal local
+public:
+    //-----------------------------------------------------------------------
+    //  Constructor
+    //
+    //  filename    the source file to be processed
+    //  options_    the options to use
+    //
+    cppfront(
+        std::string const&         filename,
+        translation_options const& options_ = cmdline_options
+    )
+        : sourcefile     { filename }
+        , options        { options_ }
+        , owned_front_end{ std::make_unique<front_end>(errors) }
+        , source         { owned_front_end->source }
+        , tokens         { owned_front_end->tokens }
+        , parser         { owned_front_end->parser }
+        , sema           { owned_front_end->sema }
+        , view_params    { owned_front_end->view_params }
+    {
+        load_and_analyze(nullptr);
+    }
 
-            printer.print_cpp2("for ( ", n.position());
+    //-----------------------------------------------------------------------
+    //  Constructor for translating in memory, without any file access:
+    //  lower_to_cpp1 prints to memory, see take_output_files
+    //
+    //  filename    the name of the source (must end with .cpp2 or .h2), used
+    //              to name the outputs and in #line directives
+    //  text        the source text
+    //  options_    the options to use (options_.cpp1_filename is ignored)
+    //
+    cppfront(
+        std::string const&         filename,
+        std::string_view           text,
+        translation_options const& options_
+    )
+        : sourcefile     { filename }
+        , options        { options_ }
+        , in_memory      { true }
+        , owned_front_end{ std::make_unique<front_end>(errors) }
+        , source         { owned_front_end->source }
+        , tokens         { owned_front_end->tokens }
+        , parser         { owned_front_end->parser }
+        , sema           { owned_front_end->sema }
+        , view_params    { owned_front_end->view_params }
+    {
+        options.cpp1_filename.clear();
+        auto in = std::istringstream{ std::string{text} };
+        load_and_analyze(&in);
+    }
 
-            emit(*n.parameter);
+private:
+    //-----------------------------------------------------------------------
+    //  Constructor for a phase 2 lowering worker
+    //
+    //  primary     the instance whose front end results to share
+    //  start       the lowering state to start from
+    //
+    cppfront(
+        cppfront const&       primary,
+        lowering_state const& start
+    )
+        : sourcefile        { primary.sourcefile }
+        , options           { primary.options }
+        , source            { primary.source }
+        , tokens            { primary.tokens }
+        , parser            { primary.parser }
+        , sema              { primary.sema }
+        , view_params       { primary.view_params }
+        , internal_linkage  { primary.internal_linkage }
+        , inferred_final    { primary.inferred_final }
+        , inferred_purity   { primary.inferred_purity }
+        , labels            { primary.labels }
+        , is_lowering_worker{ true }
+    {
+        printer.open_buffer(primary.printer);
+        set_lowering_state(start);
+    }
 
-            printer.print_cpp2(" : ", n.position());
+public:
 
-            //  If this expression is just a single expression-list, we can
-            //  take over direct control of emitting it without needing to
-            //  go through the whole grammar, and surround it with braces
-            if (n.range->is_expression_list()) {
-                printer.print_cpp2( "{ ", n.position() );
-                emit(*n.range->get_expression_list(), false);
-                printer.print_cpp2( " }", n.position() );
-            }
-            //  Otherwise, just emit the general expression as usual
-            else {
-                emit(*n.range);
-            }
 
-            printer.print_cpp2(" ) ", n.position());
-            if (!labelname.empty()) {
-                printer.print_extra("{");
-            }
+    //-----------------------------------------------------------------------
+    //  lower_to_cpp1
+    //
+    //  Emits the target file with the last '2' stripped
+    //
+    struct lower_to_cpp1_ret {
+        lineno_t cpp1_lines = 0;
+        lineno_t cpp2_lines = 0;
 
-            //  If there's a next-expression, smuggle it in via a nested do/while(false) loop
-            //  (nested "continue" will work, but "break" won't until we do extra work to implement
-            //  that using a flag and implementing "break" as "_for_break = true; continue;")
-            if (n.next_expression) {
-                printer.print_cpp2(" { do ", n.position());
-            }
+        //  The files written, flushed (empty if printing to stdout or memory)
+        std::vector<std::string> cpp1_filenames = {};
 
-            assert(n.body);
-            emit(*n.body);
+        //  If phase 2 was lowered in parallel
+        int phase2_jobs          = 1;
+        int phase2_declarations  = 0;
+        int phase2_relowered     = 0;   // redone serially
+    };
+    auto lower_to_cpp1()
+        -> lower_to_cpp1_ret
+    {
+        auto ret = lower_to_cpp1_ret{};
 
-            if (n.next_expression) {
-                printer.print_cpp2(" while (false); ", n.position());
-                emit(*n.next_expression);
-                printer.print_cpp2("; }", n.position());
-            }
+        //  Only lower to Cpp1 if we haven't already encountered errors
+        if (!errors.empty()) {
+            return {};
+        }
 
-            printer.print_cpp2("", n.position());
-            if (!labelname.empty()) {
-                printer.print_extra(" CPP2_CONTINUE_BREAK("+labelname+") }");
-            }
+        if (!find_whole_program_inferences()) {
+            errors.emplace_back(
+                source_position{},
+                "could not read -whole-program manifest " + options.whole_program + " or a file it lists"
+            );
+            return {};
         }
 
-        else {
-            assert(!"ICE: unexpected case");
+        find_function_purity();
+
+        //  Now we'll open the Cpp1 file
+        auto cpp1_filename = sourcefile.substr(0, std::ssize(sourcefile) - 1);
+        if (!options.cpp1_filename.empty()) {
+            cpp1_filename = options.cpp1_filename; // use override if present
         }
 
-        assert (iteration_statements.back().stmt);
+        printer.open(
+            sourcefile,
+            cpp1_filename,
+            tokens.get_comments(),
+            source,
+            parser,
+            options,
+            in_memory
+        );
+        if (!printer.is_open()) {
+            errors.emplace_back(
+                source_position{},
+                "could not open output file " + cpp1_filename
+            );
+            return {};
+        }
         if (
-            iteration_statements.back().stmt->label
-            && !iteration_statements.back().used
+            !in_memory
+            && cpp1_filename != "stdout"
             )
         {
-            auto name = iteration_statements.back().stmt->label->to_string();
-            errors.emplace_back(
-                iteration_statements.back().stmt->position(),
-                name + ": a named loop must have its name used (did you forget 'break " + name + ";' or 'continue " + name + "';?)"
-            );
+            ret.cpp1_filenames.push_back(cpp1_filename);
         }
 
-        iteration_statements.pop_back();
-    }
+        //  Generate a reasonable macroized name
+        auto cpp1_FILENAME = to_upper_and_underbar(cpp1_filename);
 
 
-    //-----------------------------------------------------------------------
-    //
-    auto emit(return_statement_node const& n)
-        -> void
-    {   STACKINSTR
-        assert (!current_functions.empty());
-        if (current_functions.back().func->has_postconditions()) {
-            printer.print_cpp2( "cpp2_finally_presuccess.run(); ", n.position() );
-        }
-
-        assert(n.identifier);
-        assert(*n.identifier == "return");
-        printer.print_cpp2("return ", n.position());
-
-        in_single_unqualified_id_return.push_back(
-            n.expression
-            && n.expression->is_unqualified_id()
-        );
-        auto guard = finally([&]{ in_single_unqualified_id_return.pop_back(); });
-
-        //  Return with expression == single anonymous return type
-        //
-        if (n.expression)
+        //  Instead of all the standard headers, #include just the ones used
+        //  after cpp2util.h (if 'import std;' isn't available)
+        auto std_includes = std::optional<std::vector<std_header const*>>{};
+        auto hpp_std_includes = std::vector<std_header const*>{};
+        if (
+            options.include_std
+            || options.import_std
+            )
         {
-            assert(!current_functions.empty());
-            auto is_forward_return =
-                !function_returns.empty()
-                && function_returns.back().pass == passing_style::forward;
-            auto is_deduced_return =
-                !function_returns.empty()
-                && function_returns.back().is_deduced;
+            std_includes = used_std_headers();
 
-            //  If we're doing a forward return of a single-token name
-            if (auto tok = n.expression->expr->get_postfix_expression_node()->expr->get_token();
-                tok
-                && is_forward_return
+            //  A .h2's .h doesn't need the ones that only out-of-line type
+            //  definitions use, they're needed only where the .hpp is
+            if (
+                std_includes
+                && cpp1_filename.back() == 'h'
+                && options.cpp2_only
                 )
             {
-                //  Ensure we're not returning a local or an in/move parameter
-                auto is_parameter_name = current_functions.back().decl->has_parameter_named(*tok);
-                if (
-                    is_parameter_name
-                    && (
-                        current_functions.back().decl->has_in_parameter_named(*tok)
-                        || current_functions.back().decl->has_copy_parameter_named(*tok)
-                        || current_functions.back().decl->has_move_parameter_named(*tok)
-                        )
-                    )
-                {
-                    errors.emplace_back(
-                        n.position(),
-                        "a 'forward' return type cannot return an 'in', 'copy', or 'move' parameter"
-                    );
-                    return;
-                }
-                else if (
-                    !is_parameter_name
-                    && sema.get_declaration_of(*tok)
-                    && !sema.is_captured(*tok)
-                    )
-                {
-                    errors.emplace_back(
-                        n.position(),
-                        "a 'forward' return type cannot return a local variable"
-                    );
-                    return;
-                } else if (
-                    is_literal(tok->type()) || n.expression->expr->is_result_a_temporary_variable()
-                )
-                {
-                    errors.emplace_back(
-                        n.position(),
-                        "a 'forward' return type must return an 'inout', 'out', or 'forward' parameter; it cannot return a complex expression -- for example: for a function that takes a stream object 'output`, instead of 'return output << data;' write 'output << data; return output;'"
-                    );
-                    return;
-                }
+                auto h_std_includes = used_std_headers(true);
+                assert(h_std_includes);
+                std::ranges::set_difference(*std_includes, *h_std_includes, std::back_inserter(hpp_std_includes));
+                std_includes = std::move(h_std_includes);
             }
-
-            //  If this expression is just a single expression-list, we can
-            //  take over direct control of emitting it without needing to
-            //  go through the whole grammar, and surround it with braces
-            if (n.expression->is_expression_list()) {
-                if (!is_deduced_return) {
-                    printer.print_cpp2( "{ ", n.position() );
+        }
+        auto print_std_includes = [&](std::vector<std_header const*> const& headers)
+        {
+            if (headers.empty()) {
+                return;
+            }
+            auto includes = std::string{};
+            for (auto h : headers) {
+                if (h->guard.empty()) {
+                    includes += "#include " + std::string{h->header} + "\n";
                 }
-                emit(*n.expression->get_expression_list(), false);
-                if (!is_deduced_return) {
-                    printer.print_cpp2( " }", n.position() );
+                else {
+                    includes += "#ifdef " + std::string{h->guard} + "\n"
+                              + "    #include " + std::string{h->header} + "\n"
+                              + "#endif\n";
                 }
             }
-            //  Otherwise, just emit the general expression as usual
-            else {
-                emit(*n.expression);
-            }
-
-            if (
-                function_returns.empty()
-                || function_returns.back().param_list != &single_anon
-                )
-            {
-                errors.emplace_back(
-                    n.position(),
-                    "return statement with expression must be in a function with a single anonymous return value"
-                );
-                return;
+            if (!options.include_std) {
+                includes = "#ifndef __cpp_lib_modules\n" + includes + "#endif\n";
             }
-        }
-
-        else if (
-            !function_returns.empty()
-            && function_returns.back().param_list == &single_anon
-            )
-        {
-            errors.emplace_back(
-                n.position(),
-                "return statement must have an expression in a function with a single anonymous return value"
-            );
-        }
+            printer.print_extra( includes + "\n" );
+        };
 
-        //  Return without expression, could be assignment operator
-        //
-        else if (generating_assignment_from == current_functions.back().decl)
-        {
-            printer.print_cpp2("*this", n.position());
-        }
 
-        //  Otherwise, zero or named return values
+        //---------------------------------------------------------------------
+        //  Do lowered file prolog
         //
-        else if (
-            !function_returns.empty()
-            && function_returns.back().param_list
+        //  Only emit extra lines if we actually have Cpp2, because
+        //  we want Cpp1-only files to pass through with zero changes
+        //  (unless the user requested import/include of std)
+        if (
+            source.has_cpp2()
+            || options.import_std
+            || options.include_std
             )
         {
-            auto& parameters = function_returns.back().param_list->parameters;
-
-            auto stmt = std::string{};
-
-            //  Put braces only around multiple named returns, which are a struct
-            //  - single named returns are emitted as ordinary returns, and extra
-            //  { } would be legal but generate a noisy warning on some compilers
-            if (std::ssize(parameters) > 1) {
-                stmt += std::string(" { ");
+            if (options.emit_cppfront_info) {
+                printer.print_extra(
+                    "\n// Generated by cppfront "
+                    #include "version.info"
+                    " build "
+                    #include "build.info"
+                );
+            }
+            printer.print_extra( "\n" );
+            if (cpp1_filename.back() == 'h') {
+                printer.print_extra( "#ifndef " + cpp1_FILENAME+"_CPP2\n");
+                printer.print_extra( "#define " + cpp1_FILENAME+"_CPP2" + "\n\n" );
             }
 
-            for (bool first = true; auto& param : parameters) {
-                if (!first) {
-                    stmt += ", ";
-                }
-                first = false;
-                assert(param->declaration->identifier);
+            if (uses_source_sites()) {
+                printer.print_extra( "#define CPP2_USE_SOURCE_SITES    Yes\n" );
+            }
+            else if (options.use_source_location) {
+                printer.print_extra( "#define CPP2_USE_SOURCE_LOCATION Yes\n" );
+            }
 
-                printer.emit_to_string(&stmt);
-                emit(*param->declaration->identifier, cpp2::unsafe_narrow<int>(parameters.size()));
-                printer.emit_to_string();
+            if (options.include_std) {
+                printer.print_extra( "#define CPP2_INCLUDE_STD         Yes\n" );
+            }
+            else if (options.import_std) {
+                printer.print_extra( "#define CPP2_IMPORT_STD          Yes\n" );
+            }
+            if (std_includes) {
+                printer.print_extra( "#define CPP2_INCLUDE_USED_STD    Yes\n" );
             }
 
-            if (std::ssize(parameters) > 1) {
-                stmt += std::string(" }");
+            if (options.no_exceptions) {
+                printer.print_extra( "#define CPP2_NO_EXCEPTIONS       Yes\n" );
             }
 
-            printer.print_cpp2(stmt, n.position());
+            if (options.no_rtti) {
+                printer.print_extra( "#define CPP2_NO_RTTI             Yes\n" );
+            }
         }
 
-        printer.print_cpp2("; ", n.position());
-    }
+        auto map_iter = tokens.get_map().cbegin();
+        auto hpp_includes = std::string{};
 
+        //  The names each top-level declaration leaves in current_names
+        //  (i.e., namespaces), recorded in phase 1 to predict phase 2's
+        auto leftover_names = std::vector<std::vector<source_order_name_lookup_res::value_type>>{};
 
-    //-----------------------------------------------------------------------
-    //
-    auto emit(jump_statement_node const& n)
-        -> void
-    {   STACKINSTR
-        assert(n.keyword);
 
-        if (n.label) {
-            auto iter_stmt =
-                std::find_if(
-                    iteration_statements.begin(),
-                    iteration_statements.end(),
-                    [&](auto& s){
-                        assert(s.stmt);
-                        return
-                            s.stmt->label
-                            && std::string_view{*s.stmt->label} == std::string_view{*n.label}
-                            ;
-                    }
-                );
-            if (iter_stmt == iteration_statements.end())
-            {
-                errors.emplace_back(
-                    n.position(),
-                    "a named " + n.keyword->to_string() + " must use the name of an enclosing local loop label"
-                );
-                return;
-            }
-            iter_stmt->used = true;
-            assert((*iter_stmt).stmt->label);
-            printer.print_cpp2(
-                "goto " + to_upper_and_underbar(*n.keyword) + "_" + (*iter_stmt).stmt->label->to_string() + ";",
-                n.position()
-            );
-        }
-        else {
-            emit(*n.keyword);
-            printer.print_cpp2(";", n.position());
+        //---------------------------------------------------------------------
+        //  Do phase0_type_decls
+        assert(printer.get_phase() == printer.phase0_type_decls);
+
+        if (
+            source.has_cpp2()
+            && !options.clean_cpp1
+            )
+        {
+            printer.print_extra( "\n//=== Cpp2 type declarations ====================================================\n\n" );
         }
-    }
 
+        if (
+            !tokens.get_map().empty()
+            || options.import_std
+            || options.include_std
+            )
+        {
+            printer.print_extra( "\n#include \"cpp2util.h\"\n\n" );
 
-    //-----------------------------------------------------------------------
-    //
-    auto emit(using_statement_node const& n)
-        -> void
-    {   STACKINSTR
-        assert(n.keyword);
-        emit(*n.keyword);
+            if (std_includes) {
+                print_std_includes( *std_includes );
+            }
+        }
 
-        if (n.for_namespace) {
-            printer.print_cpp2(" namespace", n.position());
-        } else {
-            current_names.push_back(active_using_declaration{n});
+        if (
+            source.has_cpp2()
+            && !options.clean_cpp1
+            )
+        {
+            printer.reset_line_to(1, true);
         }
 
-        printer.print_cpp2(" " + print_to_string(*n.id) + ";", n.position());
-    }
+        for (auto& section : tokens.get_map())
+        {
+            assert (!section.second.empty());
 
+            //  Get the parse tree for this section and emit each forward declaration
+            auto decls = parser.get_parse_tree_declarations_in_range(section.second);
+            for (auto& decl : decls) {
+                assert(decl);
+                emit(*decl);
+            }
+        }
 
-    //-----------------------------------------------------------------------
-    //
-    auto build_capture_lambda_intro_for(
-        capture_group&  captures,
-        source_position pos,
-        bool            include_default_reference_capture = false
-    )
-        -> std::string
-    {
-        //  First calculate the stringized version of each capture expression
-        //  This will let us compare and de-duplicate repeated capture expressions
-        for (auto& cap : captures.members)
+
+        //---------------------------------------------------------------------
+        //  Do phase1_type_defs_func_decls
+        //
+        printer.finalize_phase();
+        printer.next_phase();
+
+        declared_by_definition = find_functions_declared_by_definition();
+
+        if (
+            source.has_cpp2()
+            && !options.clean_cpp1
+            )
         {
-            assert(cap.capture_expr->cap_grp == &captures);
-            if (cap.str.empty()) {
-                print_to_string(&cap.str, *cap.capture_expr, true);
-                suppress_move_from_last_use = true;
-                print_to_string(&cap.str_suppressed_move, *cap.capture_expr, true);
-                suppress_move_from_last_use = false;
-            }
+            printer.print_extra( "\n//=== Cpp2 type definitions and function declarations ===========================\n\n" );
+            printer.reset_line_to(1, true);
         }
 
-        // If move from last use was used on the variable we need to rewrite the str to add std::move
-        // to earlier use of the variable. That will save us from capturing one variable two times
-        // (one with copy and one with std::move).
-        for (auto rit = captures.members.rbegin(); rit != captures.members.rend(); ++rit)
+        assert (printer.get_phase() == positional_printer::phase1_type_defs_func_decls);
+        for (
+            lineno_t curr_lineno = 0;
+            auto const& line : source.get_lines()
+            )
         {
-            auto is_same_str_suppressed_move = [s=rit->str_suppressed_move](auto& cap){
-                return cap.str_suppressed_move == s;
-            };
-
-            auto rit2 = std::find_if(rit+1, captures.members.rend(), is_same_str_suppressed_move);
-            while (rit2 != captures.members.rend())
+            //  Skip dummy line we added to make 0-vs-1-based offsets readable
+            if (curr_lineno != 0)
             {
-                rit2->str = rit->str;
-                rit2 = std::find_if(rit2+1, captures.members.rend(), is_same_str_suppressed_move);
+                //  If it's a Cpp1 line, emit it
+                if (line.cat != source_line::category::cpp2)
+                {
+                    if (
+                        source.has_cpp2()
+                        && line.cat != source_line::category::preprocessor
+                        )
+                    {
+                        ++ret.cpp2_lines;
+                    }
+                    else
+                    {
+                        ++ret.cpp1_lines;
+                    }
+
+                    if (
+                        options.cpp2_only
+                        && !line.text.empty()
+                        && line.cat != source_line::category::comment
+                        && line.cat != source_line::category::import
+                        )
+                    {
+                        if (line.cat == source_line::category::preprocessor) {
+                            if (!line.text.ends_with(".h2\"")) {
+                                errors.emplace_back(
+                                    source_position(curr_lineno, 1),
+                                    "pure-cpp2 switch disables the preprocessor, including #include (except of .h2 files) - use import instead (note: 'import std;' is implicit in -pure-cpp2)"
+                                );
+                                return {};
+                            }
+                        }
+                        else {
+                            errors.emplace_back(
+                                source_position(curr_lineno, 1),
+                                "pure-cpp2 switch disables Cpp1 syntax"
+                            );
+                            return {};
+                        }
+                    }
+
+                    if (
+                        line.cat == source_line::category::preprocessor
+                        && line.text.ends_with(".h2\"")
+                        )
+                    {
+                        //  Strip off the 2"
+                        auto h_include = line.text.substr(0, line.text.size()-2);
+                        printer.print_cpp1( h_include + "\"", curr_lineno );
+                        hpp_includes += h_include + "pp\"\n";
+                    }
+                    else {
+                        printer.print_cpp1( line.text, curr_lineno );
+                    }
+                }
+
+                //  If it's a Cpp2 line...
+                else {
+                    ++ret.cpp2_lines;
+
+                    //  We should be in a position to emit a set of Cpp2 declarations
+                    if (
+                        map_iter != tokens.get_map().cend()
+                        && map_iter->first /*line*/ <= curr_lineno
+                        )
+                    {
+                        //  We should be here only when we're at exactly the first line of a Cpp2 section
+                        assert (map_iter->first == curr_lineno);
+                        assert (!map_iter->second.empty());
+
+                        //  Get the parse tree for this section and emit each forward declaration
+                        auto decls = parser.get_parse_tree_declarations_in_range(map_iter->second);
+                        for (auto& decl : decls) {
+                            assert(decl);
+                            auto names_before = std::ssize(current_names);
+                            emit(*decl);
+                            leftover_names.emplace_back(
+                                current_names.begin() + std::min(names_before, std::ssize(current_names)),
+                                current_names.end()
+                            );
+                        }
+                        ++map_iter;
+                    }
+                }
             }
+            ++curr_lineno;
         }
 
-        //  Then build the capture list, ignoring duplicated expressions
-        auto lambda_intro = std::string("[");
-        auto num_captures = 0;
+        //  We can stop here if there's no Cpp2 code -- a file with no Cpp2
+        //  should have perfect passthrough verifiable with diff, including
+        //  that we didn't misidentify anything as Cpp2 (even in the
+        //  presence of nonstandard vendor extensions)
+        //
+        if (!source.has_cpp2()) {
+            assert(ret.cpp2_lines == 0);
+            printer.flush();
+            return ret;
+        }
+
+        //  If there is Cpp2 code, we have more to do...
 
+        //  First, if this is a .h2 and in a -pure-cpp2 compilation,
+        //  we need to switch filenames
         if (
-            (!current_functions.empty()
-                && current_functions.back().decl->is_function_with_this()
-                && !current_functions.back().decl->parent_is_namespace()
-                )
-            || include_default_reference_capture
+            cpp1_filename.back() == 'h'
+            && options.cpp2_only
             )
         {
-            //  Note: & is needed (when allowed, not at namespace scope) because a
-            //  nested UFCS might be viewed as trying to capture 'this'
-            lambda_intro += "&";
-            ++num_captures;
+            printer.print_extra( "\n#endif\n" );
+
+            printer.reopen();
+            if (!printer.is_open()) {
+                errors.emplace_back(
+                    source_position{},
+                    "could not open second output file " + cpp1_filename
+                );
+                return {};
+            }
+            if (!in_memory) {
+                ret.cpp1_filenames.push_back(cpp1_filename + "pp");
+            }
+
+            printer.print_extra( "\n#ifndef " + cpp1_FILENAME+"_CPP2" );
+            printer.print_extra( "\n#error This file is part of a '.h2' header compiled to be consumed from another -pure-cpp2 file. To use this file, write '#include \"" + cpp1_filename + "2\"' in a '.h2' or '.cpp2' file compiled with -pure-cpp2."  );
+            printer.print_extra( "\n#endif\n" );
+
+            cpp1_FILENAME += "PP";
+            printer.print_extra( "\n#ifndef " + cpp1_FILENAME+"_CPP2" );
+            printer.print_extra( "\n#define " + cpp1_FILENAME+"_CPP2" + "\n\n" );
+
+            print_std_includes( hpp_std_includes );
+            printer.print_extra( hpp_includes );
         }
 
-        printer.emit_to_string(&lambda_intro);
 
-        auto handled = std::vector<std::string>{};
-        for (auto& cap : captures.members)
+        //---------------------------------------------------------------------
+        //  Do phase2_func_defs
+        //
+        printer.finalize_phase();
+        printer.next_phase();
+
+        if (
+            source.has_cpp2()
+            && !options.clean_cpp1
+            )
         {
-            //  If we haven't handled a capture that looks like this one
-            if (std::find(handled.begin(), handled.end(), cap.str) == handled.end())
+            printer.print_extra( "\n//=== Cpp2 function definitions =================================================\n\n" );
+            printer.reset_line_to(1, true);
+        }
+
+        if (lowering_jobs() > 1) {
+            lower_phase2_in_parallel(leftover_names, ret);
+        }
+        else {
+            for (auto& section : tokens.get_map())
             {
-                //  Remember it
-                handled.push_back(cap.str);
+                assert (!section.second.empty());
 
-                //  And handle it
-                if (num_captures != 0) { // not first
-                    lambda_intro += ", ";
+                //  Get the parse tree for this section and emit each forward declaration
+                auto decls = parser.get_parse_tree_declarations_in_range(section.second);
+                for (auto& decl : decls) {
+                    assert(decl);
+                    emit(*decl);
                 }
-                cap.cap_sym = "_"+std::to_string(num_captures);
-                printer.print_cpp2(cap.cap_sym + " = " + cap.str, pos);
             }
-            ++num_captures;
         }
-        printer.emit_to_string();
-        lambda_intro += "]";
 
-        return lambda_intro;
+        if (uses_source_sites()) {
+            emit_source_site_table();
+        }
+
+        if (cpp1_filename.back() == 'h') {
+            printer.print_extra( "\n#endif" );
+        }
+
+        printer.finalize_phase( true );
+
+        //  Finally, some debug checks
+        assert(
+            (!errors.empty() || tokens.num_unprinted_comments() == 0)
+            && "ICE: not all comments were printed"
+        );
+
+        printer.flush();
+        return ret;
     }
 
 
     //-----------------------------------------------------------------------
+    //  lower_phase2_in_parallel
     //
-    auto emit(primary_expression_node const& n)
-        -> void
-    {   STACKINSTR
-        try_emit<primary_expression_node::identifier     >(n.expr);
-        try_emit<primary_expression_node::expression_list>(n.expr);
-        try_emit<primary_expression_node::id_expression  >(n.expr);
-        try_emit<primary_expression_node::inspect        >(n.expr, true);
-        try_emit<primary_expression_node::literal        >(n.expr);
+    //  Emits phase 2 (function definitions) for the top-level declarations
+    //  using -jobs threads. Each declaration's function bodies can be lowered
+    //  independently once sema is done, except for the printer position and
+    //  other lowering state that flows from one declaration to the next.
+    //  So each worker predicts the state it will start in, by lowering the
+    //  previous declaration first and discarding that output, and then
+    //  lowers its own declaration into a buffer. Then we splice the buffers
+    //  in source order, and redo serially any declaration whose predicted
+    //  starting state doesn't match the actual state at that point, so the
+    //  result is always identical to serial lowering.
+    //
+    //  leftover_names  the names each declaration left in current_names in
+    //                  phase 1, which phase 2 will leave again
+    //
+    auto lowering_jobs() const
+        -> int
+    {
+#ifdef CPP2_DEBUG_BUILD
+        //  The scope timers are per thread, and only the main thread's are reported
+        return 1;
+#else
+        if (options.lowering_jobs == 0) {
+            return std::max(1, unsafe_narrow<int>(std::thread::hardware_concurrency()));
+        }
+        return options.lowering_jobs;
+#endif
+    }
 
-        if (n.expr.index() == primary_expression_node::declaration)
-        {
-            //  This must be an anonymous declaration
-            auto& decl = std::get<primary_expression_node::declaration>(n.expr);
-            assert(
-                decl
-                && !decl->identifier
-            );
+    struct phase2_result {
+        lowering_state                    start                    = {};
+        lowering_state                    end                      = {};
+        positional_printer::buffered_text text                     = {};
+        std::vector<error_entry>          errors                   = {};
+        std::vector<source_site>          source_sites             = {};
+        std::vector<check_record>         checks                   = {};
+        bool                              violates_lifetime_safety = false;
+        bool                              violates_bounds_safety   = false;
+        bool                              valid                    = false;
+    };
 
-            //  Handle an anonymous function
-            if (decl->is_function()) {
-                auto lambda_intro = build_capture_lambda_intro_for(decl->captures, n.position());
+    auto lower_phase2_in_parallel(
+        std::vector<std::vector<source_order_name_lookup_res::value_type>> const& leftover_names,
+        lower_to_cpp1_ret&                                                        ret
+    )
+        -> void
+    {
+        auto decls = std::vector<declaration_node const*>{};
+        for (auto& section : tokens.get_map()) {
+            assert (!section.second.empty());
+            for (auto decl : parser.get_parse_tree_declarations_in_range(section.second)) {
+                assert(decl);
+                decls.push_back(decl);
+            }
+        }
+        assert(std::ssize(leftover_names) == std::ssize(decls));
+
+        //  Compute each worker's starting state for lowering the previous
+        //  declaration: where phase 2 starts, plus the names left behind
+        //  by the declarations before that
+        auto warmup_states = std::vector<lowering_state>{};
+        auto state = get_lowering_state();
+        for (auto i = 0; i < std::ssize(decls); ++i) {
+            warmup_states.push_back(state);
+            if (i > 0) {
+                state.current_names.insert(
+                    state.current_names.end(),
+                    leftover_names[i-1].begin(),
+                    leftover_names[i-1].end()
+                );
+            }
+        }
 
-                // Handle an anonymous generic function with explicit type list
-                if (decl->template_parameters) {
-                    print_to_string(&lambda_intro, *decl->template_parameters, false, true);
-                }
-
-                emit(*decl, lambda_intro);
-            }
-            //  Else an anonymous object as 'typeid { initializer }'
-            else {
-                assert(decl->is_object());
-                auto& type_id = std::get<declaration_node::an_object>(decl->type);
-
-                printer.add_pad_in_this_line( -5 );
-
-                emit(*type_id);
-                printer.print_cpp2("{", decl->position());
+        //  Make sure the parser's lazily sorted data is sorted before
+        //  it's shared with the workers
+        (void)parser.is_within_function_body({});
 
-                if (!decl->initializer) {
-                    errors.emplace_back(
-                        decl->position(),
-                        "an anonymous object declaration must have '=' and an initializer"
-                    );
-                    return;
+        auto results   = std::vector<phase2_result>(decls.size());
+        auto next      = std::atomic<int>{0};
+        auto do_worker = [&]
+        {
+            for (auto i = next++; i < std::ssize(decls); i = next++)
+            {
+                auto& r = results[i];
+                try {
+                    auto worker = cppfront(*this, warmup_states[i]);
+                    if (i > 0) {
+                        worker.emit(*decls[i-1]);
+                        (void)worker.printer.take_buffer();
+                        worker.errors.clear();
+                        worker.source_sites.clear();
+                        worker.checks.clear();
+                        worker.violates_lifetime_safety = false;
+                        worker.violates_bounds_safety   = false;
+                        worker.needs_serial_lowering    = false;
+                    }
+                    r.start = worker.get_lowering_state();
+                    worker.emit(*decls[i]);
+                    r.end                      = worker.get_lowering_state();
+                    r.text                     = worker.printer.take_buffer();
+                    r.errors                   = std::move(worker.errors);
+                    r.source_sites             = std::move(worker.source_sites);
+                    r.checks                   = std::move(worker.checks);
+                    r.violates_lifetime_safety = worker.violates_lifetime_safety;
+                    r.violates_bounds_safety   = worker.violates_bounds_safety;
+                    r.valid                    = !worker.needs_serial_lowering;
+                }
+                catch (...) {
+                    //  Leave it for the serial redo, which will rethrow
+                    r.valid = false;
                 }
+            }
+        };
 
-                emit(*decl->initializer, false);
+        auto threads = std::vector<std::thread>{};
+        auto jobs    = std::min(lowering_jobs(), unsafe_narrow<int>(std::ssize(decls)));
+        for (auto i = 1; i < jobs; ++i) {
+            threads.emplace_back(do_worker);
+        }
+        do_worker();
+        for (auto& t : threads) {
+            t.join();
+        }
 
-                printer.print_cpp2("}", decl->position());
+        //  Splice in source order, redoing serially where needed
+        state = get_lowering_state();
+        for (auto i = 0; i < std::ssize(decls); ++i)
+        {
+            auto& r = results[i];
+            if (
+                r.valid
+                && r.start == state
+                )
+            {
+                printer.print_buffered(r.text);
+                set_lowering_state(r.end);
+                errors.insert(errors.end(), r.errors.begin(), r.errors.end());
+                source_sites.insert(source_sites.end(), r.source_sites.begin(), r.source_sites.end());
+                checks.insert(checks.end(), r.checks.begin(), r.checks.end());
+                violates_lifetime_safety = violates_lifetime_safety || r.violates_lifetime_safety;
+                violates_bounds_safety   = violates_bounds_safety   || r.violates_bounds_safety;
+            }
+            else
+            {
+                emit(*decls[i]);
+                ++ret.phase2_relowered;
             }
+            state = get_lowering_state();
         }
+
+        ret.phase2_jobs         = jobs;
+        ret.phase2_declarations = unsafe_narrow<int>(std::ssize(decls));
     }
 
-    //  Not yet implemented. TODO: finalize deducing pointer types from parameter lists
-    auto is_pointer_declaration(
-        parameter_declaration_list_node const*,
-        int,
-        int
+
+    //-----------------------------------------------------------------------
+    //
+    //  emit() functions - each emits a kind of node
+    //
+    //  The body often mirrors the node's visit() function, unless customization
+    //  is needed where Cpp1 and Cpp2 have different grammar orders
+    //
+
+    void print_to_string(
+        std::string* str,
+        auto&        i,
+        auto...      more
     )
-        -> bool
     {
-        return false;
-    }
+        //  Quick special-purpose state preservation... this tactical hack
+        //  is fine for now, but if needed more then generalize this
+        auto state1 = need_expression_list_parens;
+        auto state2 = already_moved_that_members;
 
-    auto is_pointer_declaration(
-        declaration_node const* decl_node,
-        int                     deref_cnt,
-        int                     addr_cnt
+        printer.emit_to_string(str);
+        emit(i, more...);
+        printer.emit_to_string();
+
+        //  Restore state
+        need_expression_list_parens.swap(state1);
+        already_moved_that_members .swap(state2);
+    };
+
+    auto print_to_string(
+        auto&   i,
+        auto... more
     )
-        -> bool
+        -> std::string
     {
-        if (!decl_node) {
-            return false;
-        }
-        if (addr_cnt > deref_cnt) {
-            return true;
-        }
-
-        return std::visit([&](auto const& type){
-            return is_pointer_declaration(type.get(), deref_cnt, addr_cnt);
-        }, decl_node->type);
-    }
+        auto print = std::string{};
+        print_to_string(&print, i, more...);
+        return print;
+    };
 
-    auto is_pointer_declaration(
-        function_type_node const* fun_node,
-        int                       deref_cnt,
-        int                       addr_cnt
+    //-----------------------------------------------------------------------
+    //  try_emit
+    //
+    //  Helper to emit whatever is in a variant where each
+    //  alternative is a smart pointer
+    //
+    template <int I>
+    auto try_emit(
+        auto&     v,
+        auto&&... more
     )
-        -> bool
+        -> void
     {
-        if (!fun_node) {
-            return false;
-        }
-        if (addr_cnt > deref_cnt) {
-            return true;
+        if (v.index() == I) {
+            auto const& alt = std::get<I>(v);
+            assert (alt);
+            emit (*alt, CPP2_FORWARD(more)...);
         }
-
-        return std::visit([&]<typename T>(T const& type){
-            if constexpr (std::is_same_v<T, std::monostate>) {
-                return false;
-            }
-            else if constexpr (std::is_same_v<T, function_type_node::single_type_id>) {
-                return is_pointer_declaration(type.type.get(),  deref_cnt, addr_cnt);
-            }
-            else {
-                return is_pointer_declaration(type.get(),  deref_cnt, addr_cnt);
-            }
-        }, fun_node->returns);
     }
 
-    auto is_pointer_declaration(
-        type_id_node const* type_id_node,
-        int                 deref_cnt,
-        int                 addr_cnt
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        token const&    n,
+        bool            is_qualified = false,
+        source_position pos          = {}
     )
-        -> bool
-    {
-        if (!type_id_node) {
-            return false;
-        }
-        if (addr_cnt > deref_cnt) {
-            return true;
+        -> void
+    {   STACKINSTR
+        if (pos == source_position{}) {
+            pos = n.position();
         }
 
-        if ( type_id_node->dereference_of ) {
-            return is_pointer_declaration(type_id_node->dereference_of, deref_cnt + type_id_node->dereference_cnt, addr_cnt);
-        } else if ( type_id_node->address_of ) {
-            return is_pointer_declaration(type_id_node->address_of, deref_cnt, addr_cnt + 1);
+        //  Implicit "cpp2::" qualification of Cpp2 fixed-width type aliases
+        //  and cpp2::finally
+        if (
+            !is_qualified
+            && (
+                n.type() == lexeme::Cpp2FixedType
+                || n == "finally"
+                )
+            )
+        {
+            printer.print_cpp2("cpp2::", pos);
         }
 
-        auto pointer_declarators_cnt = std::count_if(std::cbegin(type_id_node->pc_qualifiers), std::cend(type_id_node->pc_qualifiers), [](auto* q) {
-            return q->type() == lexeme::Multiply;
-        });
-
-        if (
-            pointer_declarators_cnt == 0
-            && type_id_node->suspicious_initialization
+        //  'this' is not a pointer
+        if (n == "this") {
+            printer.print_cpp2("(*this)", pos);
+        }
+        //  Reclaim the alternative names and some keywords for users
+        else if (
+            n == "and"
+            || n == "and_eq"
+            || n == "bitand"
+            || n == "bitor"
+            || n == "compl"
+            || n == "not"
+            || n == "not_eq"
+            || n == "or"
+            || n == "or_eq"
+            || n == "xor"
+            || n == "xor_eq"
+            || n == "new"
+            || n == "class"
+            || n == "struct"
+            || n == "enum"
+            || n == "union"
+            || n == "default"
             )
         {
-            return is_pointer_declaration(type_id_node->suspicious_initialization, deref_cnt, addr_cnt);
+            printer.print_cpp2(pos, "cpp2_", n);
+        }
+        else {
+            printer.print_cpp2(n, pos, true);
         }
 
-        return (unsafe_narrow<int>(pointer_declarators_cnt) + addr_cnt - deref_cnt) > 0;
+        in_definite_init = sema.is_definite_initialization(&n);
     }
 
-    auto is_pointer_declaration(
-        type_node const*,
-        int,
-        int
-    )
-        -> bool
-    {
-        return false;
-    }
 
-    auto is_pointer_declaration(
-        namespace_node const*,
-        int,
-        int
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        literal_node const& n,
+        source_position     pos = {}
     )
-        -> bool
-    {
-        return false;
-    }
+        -> void
+    {   STACKINSTR
+        if (pos == source_position{}) {
+            pos = n.position();
+        }
 
-    auto is_pointer_declaration(
-        alias_node const*,
-        int,
-        int
-    )
-        -> bool
-    {
-        return false;
+        assert(n.literal);
+        emit(*n.literal);
+        if (n.user_defined_suffix) {
+            emit(*n.user_defined_suffix);
+        }
     }
 
-    auto is_pointer_declaration(
-        declaration_sym const* decl,
-        int                    deref_cnt,
-        int                    addr_cnt
-    )
-        -> bool
-    {
-        if (!decl) {
-            return false;
-        }
-        if (addr_cnt > deref_cnt) {
-            return true;
-        }
-        return is_pointer_declaration(decl->declaration, deref_cnt, addr_cnt);
-    }
 
-    auto is_pointer_declaration(
-        token const* t,
-        int          deref_cnt = 0,
-        int          addr_cnt = 0
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        unqualified_id_node const& n,
+        int                        synthesized_multi_return_size = 0,
+        bool                       is_local_name                 = true,
+        bool                       is_qualified                  = false,
+        bool                       is_class_member_access        = false
     )
-        -> bool
-    {
-        if (!t) {
-            return false;
-        }
-        if (addr_cnt > deref_cnt) {
-            return true;
-        }
-        auto decl = sema.get_declaration_of(*t, true);
-        return is_pointer_declaration(decl, deref_cnt, addr_cnt);
-    }
+        -> void
+    {   STACKINSTR
+        assert( n.identifier );
+        auto last_use = sema.is_definite_last_use(n.identifier);
+
+        auto decl = sema.get_declaration_of(*n.identifier, false, true);
 
+        bool add_forward =
+            last_use
+            && last_use->is_forward
+            && last_use->safe_to_move
+            && !in_non_rvalue_context.back()
+            && !is_class_member_access;
 
-    auto source_order_name_lookup(std::string_view identifier)
-        -> source_order_name_lookup_res
-    {
-        for (
-            auto first = current_names.rbegin(), last = current_names.rend() - 1;
-            first != last;
-            ++first
-            )
-        {
-            if (
-                auto decl = get_if<declaration_node const*>(&*first);
-                decl
-                && *decl
-                && (*decl)->has_name(identifier)
+        //  We always want to std::move from named return values,
+        //  regardless of their types, so use std::move for that
+        bool add_std_move =
+            synthesized_multi_return_size > 1
+            || (
+                synthesized_multi_return_size == 1
+                && decl
+                && !decl->initializer
+                );
+
+        //  Otherwise we'll use cpp2::move
+        bool add_move =
+            !add_forward
+            && (
+                !last_use
+                || last_use->safe_to_move
                 )
-            {
-                return *decl;
-            }
-            else if (
-                auto using_ = get_if<active_using_declaration>(&*first);
-                using_
-                && using_->identifier
-                && *using_->identifier == identifier
+            && (
+                add_std_move
+                || (last_use && !suppress_move_from_last_use)
                 )
-            {
-                return *using_;
-            }
-        }
+            && !in_non_rvalue_context.back()
+            && !is_class_member_access;
 
-        return {};
-    }
+        //  Add `cpp2::move(*this).` when implicitly moving a member on last use
+        //  This way, members of lvalue reference type won't be implicitly moved
+        bool add_this =
+            add_move
+            && decl
+            && decl->identifier
+            && *decl->identifier == "this"
+            && *n.identifier != "this";
 
-    auto lookup_finds_type_scope_function(id_expression_node const& n)
-        -> bool
-    {
-        if (!n.is_unqualified())
+        if (
+            add_move
+            && in_single_unqualified_id_return.size() > 0
+            && in_single_unqualified_id_return.back()
+            && (
+                !decl
+                || decl->initializer
+                )
+            )
         {
-            return false;
+            add_move = false;
         }
 
-        auto const& id = *get<id_expression_node::unqualified>(n.id);
-        auto lookup = source_order_name_lookup(*id.identifier);
-
         if (
-            !lookup
-            || get_if<active_using_declaration>(&*lookup)
+            emitting_move_that_function
+            && *n.identifier == "that"
             )
         {
-            return false;
+            add_move = true;
         }
 
-        auto decl = get<declaration_node const*>(*lookup);
+        //  For an explicit 'forward' apply forwarding to correct identifier
+        assert (!current_args.empty());
+        if (current_args.back().pass == passing_style::forward) {
+            add_forward = current_args.back().ptoken == n.identifier;
+        }
 
-        if (
-            !decl->is_function()
-            || !decl->has_name()
-            || !decl->parent_is_type()
-            )
-        {
-            return false;
+        if (add_std_move) {
+            printer.print_cpp2("std::move(", n.position());
+        }
+        else if (add_move) {
+            printer.print_cpp2("cpp2::move(", n.position());
         }
 
-        return true;
-    }
+        if (add_forward) {
+            printer.print_cpp2("CPP2_FORWARD(", {n.position().lineno, n.position().colno - 8});
+        }
 
-    auto lookup_finds_variable_with_placeholder_type_under_initialization(id_expression_node const& n)
-        -> bool
-    {
-        if (!n.is_unqualified())
-        {
-            return false;
+        if (add_this) {
+            printer.print_cpp2("*this).", n.position());
         }
 
-        auto const& id = *get<id_expression_node::unqualified>(n.id);
-        auto lookup = source_order_name_lookup(*id.identifier);
+        assert(n.identifier);
+        emit(*n.identifier, is_qualified);  // inform the identifier if we know this is qualified
 
-        if (
-            !lookup
-            || get_if<active_using_declaration>(&*lookup)
-            )
-        {
-            return false;
+        if (n.open_angle != source_position{}) {
+            printer.print_cpp2("<", n.open_angle);
+            auto first = true;
+            for (auto& a : n.template_args) {
+                if (!first) {
+                    printer.print_cpp2(",", a.comma);
+                }
+                first = false;
+                try_emit<template_argument::expression>(a.arg);
+                try_emit<template_argument::type_id   >(a.arg);
+            }
+
+            //  With -source-sites, pass a unique.new/shared.new/new call's
+            //  site too, for allocation sampling (see CPP2_SAMPLE_ALLOCATIONS)
+            if (
+                std::ssize(n.template_args) == 1
+                && source_site_news.contains(n.identifier)
+                )
+            {
+                printer.print_cpp2(", " + source_site_id(n.identifier->position()) + ", cpp2::impl::file_sites", n.close_angle);
+            }
+            printer.print_cpp2(">", n.close_angle);
         }
 
-        auto decl = get<declaration_node const*>(*lookup);
+        in_definite_init = sema.is_definite_initialization(n.identifier);
         if (
-            decl
-            && decl->has_name(*id.identifier)
+            !in_definite_init
+            && !in_parameter_list
             )
         {
             if (
-                !decl->is_object()
-                && !decl->is_object_alias()
+                is_local_name
+                && !(*n.identifier == "this")
+                && !(*n.identifier == "that")
+                && decl
+                && (
+                    synthesized_multi_return_size != 0
+                    //  note pointer equality: if we're not in the actual declaration of n.identifier
+                    || decl->identifier != n.identifier
+                    )
+                //  and this variable was uninitialized
+                && !decl->initializer
+                //  and it's either a non-parameter or an out parameter
+                && (
+                    !decl->parameter
+                    || (
+                        decl->parameter
+                        && decl->parameter->pass == passing_style::out
+                        )
+                    )
                 )
             {
-                return false;
-            }
-
-            if (decl->is_object()) {
-                auto type = &**get_if<declaration_node::an_object>(&decl->type);
-                return type->is_wildcard()
-                       && contains(current_declarations, decl);
+                printer.print_cpp2(".value()", n.position());
             }
-            auto const& type = (**get_if<declaration_node::an_alias>(&decl->type)).type_id;
-            return (
-                    !type
-                    || type->is_wildcard()
-                    )
-                   && contains(current_declarations, decl);
+        }
+        else if (synthesized_multi_return_size != 0) {
+            printer.print_cpp2(".value()", n.position());
         }
 
-        return false;
+        if (
+            !add_this
+            && (
+                add_move
+                || add_std_move
+                || add_forward
+                )
+            )
+        {
+            printer.print_cpp2(")", n.position());
+        }
     }
 
+
     //-----------------------------------------------------------------------
     //
     auto emit(
-        //  Note: parameter is not const as we'll fill in the capture .str info
-        postfix_expression_node& n,
-        bool                     for_lambda_capture = false
-    )
+        qualified_id_node const& n,
+        bool include_unqualified_id = true
+        )
         -> void
     {   STACKINSTR
-        if (!sema.check(n)) {
+        if (!sema.check(n, errors)) {
             return;
         }
 
-        assert(n.expr);
-        last_postfix_expr_was_pointer = false;
+        auto ident = std::string{};
+        printer.emit_to_string(&ident);
 
-        //  For a 'move that' parameter, track the members we already moved from
-        //  so we can diagnose attempts to move from the same member twice
-        if (
-            emitting_move_that_function
-            && n.expr->get_token()
-            && *n.expr->get_token() == "that"
-            )
+        for (auto const& id : std::span{n.ids}.first(n.ids.size() - !include_unqualified_id))
         {
-            if (n.ops.empty()) {
-                if (!already_moved_that_members.empty()) {
-                    errors.emplace_back(
+            if (id.scope_op) {
+                emit(*id.scope_op);
+            }
+            emit(*id.id, 0, true, true);    // inform the unqualified-id that it's qualified
+        }
+
+        printer.emit_to_string();
+        printer.print_cpp2( ident, n.position() );
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        type_id_node const& n,
+        source_position     pos = {}
+    )
+        -> void
+    {   STACKINSTR
+        if (pos == source_position{}) {
+            pos = n.position();
+        }
+
+        if (n.is_wildcard()) {
+            printer.print_cpp2("auto", pos);
+        }
+        else {
+            try_emit<type_id_node::unqualified>(n.id, 0, false);
+            try_emit<type_id_node::qualified  >(n.id);
+            try_emit<type_id_node::keyword    >(n.id);
+        }
+
+        for (auto i = n.pc_qualifiers.rbegin(); i != n.pc_qualifiers.rend(); ++i) {
+            if ((**i) == "const") { printer.print_cpp2(" ", pos); }
+            emit(**i, false, pos);
+        }
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        id_expression_node const& n,
+        bool                      is_local_name          = true,
+        bool                      is_class_member_access = false
+    )
+        -> void
+    {   STACKINSTR
+        try_emit<id_expression_node::qualified  >(n.id);
+        try_emit<id_expression_node::unqualified>(n.id, 0, is_local_name, false, is_class_member_access);
+    }
+
+
+    auto emit_prolog_mem_inits(
+        function_prolog const& prolog,
+        colno_t                indent
+    )
+        -> void
+    {   STACKINSTR
+        for (auto& line : prolog.mem_inits) {
+            printer.print_extra("\n");
+            printer.print_extra(pad(indent-1));
+            printer.print_extra(line);
+        }
+    }
+
+    auto emit_prolog_statements(
+        function_prolog const& prolog,
+        colno_t                indent
+    )
+        -> void
+    {   STACKINSTR
+        for (auto& line : prolog.statements) {
+            printer.print_extra("\n");
+            printer.print_extra(pad(indent-1));
+            printer.print_extra(line);
+        }
+    }
+
+    auto emit_epilog_statements(
+        std::vector<std::string> const& epilog,
+        colno_t                         indent
+    )
+        -> void
+    {   STACKINSTR
+        for (auto& line : epilog) {
+            printer.print_extra("\n");
+            printer.print_extra(pad(indent-1));
+            printer.print_extra(line);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        compound_statement_node  const& n,
+        function_prolog          const& function_prolog = {},
+        std::vector<std::string> const& function_epilog = {}
+    )
+        -> void
+    {   STACKINSTR
+        emit_prolog_mem_inits(function_prolog, n.body_indent+1);
+
+        printer.print_cpp2( "{", n.open_brace );
+
+        emit_prolog_statements(function_prolog, n.body_indent+1);
+
+        for (auto const& x : n.statements) {
+            assert(x);
+            emit(*x);
+        }
+
+        emit_epilog_statements( function_epilog, n.body_indent+1);
+
+        printer.print_cpp2( "}", n.close_brace );
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        inspect_expression_node const& n,
+        bool                           is_expression
+    )
+        -> void
+    {   STACKINSTR
+        auto constexpr_qualifier = std::string_view{};
+        if (n.is_constexpr) {
+            constexpr_qualifier = "constexpr ";
+        }
+
+        //  If this is an expression, it will have an explicit result type,
+        //  and we need to start the lambda that we'll immediately invoke
+        auto result_type = std::string{};
+        if (is_expression) {
+            assert(n.result_type);
+            printer.emit_to_string(&result_type);
+            emit(*n.result_type);
+            printer.emit_to_string();
+            printer.print_cpp2(n.position(), "[&] () -> ", result_type, " ");
+        }
+        printer.print_cpp2(n.position(), "{ ", constexpr_qualifier, "auto&& _expr = ");
+
+        assert(n.expression);
+        emit(*n.expression);
+        printer.print_cpp2(";", n.position());
+
+        assert(
+            n.identifier
+            && *n.identifier == "inspect"
+        );
+
+        assert(!n.alternatives.empty());
+        auto found_wildcard = false;
+
+        for (auto first = true; auto&& alt : n.alternatives)
+        {
+            assert(alt && alt->is_as_keyword);
+            if (!first) {
+                printer.print_cpp2("else ", alt->position());
+            }
+            first = false;
+
+            auto id = std::string{};
+            printer.emit_to_string(&id);
+
+            if (alt->type_id) {
+                emit(*alt->type_id);
+            }
+            else {
+                assert(alt->value);
+                emit(*alt->value);
+            }
+            printer.emit_to_string();
+
+            assert (
+                *alt->is_as_keyword == "is"
+                || *alt->is_as_keyword == "as"
+            );
+            // TODO: pick up 'as' next, for now just do 'is'
+
+            if (*alt->is_as_keyword == "is")
+            {
+                //  Stringize the expression-statement now...
+                auto statement = std::string{};
+                printer.emit_to_string(&statement);
+                emit(*alt->statement);
+                printer.emit_to_string();
+                //  ... and jettison the final ; for an expression-statement
+                while (
+                    !statement.empty()
+                    && (
+                        statement.back() == ';'
+                        || isspace(statement.back())
+                        )
+                    )
+                {
+                    statement.pop_back();
+                }
+
+                replace_all( statement, "cpp2::impl::as_<", "cpp2::impl::as<" );
+
+                //  If this is an inspect-expression, we'll have to wrap each alternative
+                //  in an 'if constexpr' so that its type is ignored for mismatches with
+                //  the inspect-expression's type
+                auto return_suffix = std::string_view{";"};   // use this to tack the ; back on in the alternative body
+                if (is_expression) {
+                    return_suffix = "; }";
+                }
+
+                if (id == "auto") {
+                    found_wildcard = true;
+                    if (is_expression) {
+                        printer.print_cpp2("return ", alt->position());
+                    }
+                }
+                else {
+                    printer.print_cpp2(alt->position(), "if ", constexpr_qualifier);
+                    if (alt->type_id) {
+                        printer.print_cpp2(alt->position(), "(cpp2::impl::is<", id, ">(_expr)) ");
+                    }
+                    else {
+                        assert (alt->value);
+                        printer.print_cpp2(alt->position(), "(cpp2::impl::is(_expr, ", id, ")) ");
+                    }
+                    if (is_expression) {
+                        printer.print_cpp2(
+                            alt->position(),
+                            "{ if constexpr( requires{", statement, ";} ) if constexpr( std::is_convertible_v<CPP2_TYPEOF((",
+                            statement, "))," , result_type, "> ) return "
+                        );
+                    }
+                }
+
+                printer.print_cpp2(statement, alt->position());
+
+                if (
+                    is_expression
+                    && id != "auto"
+                    )
+                {
+                    assert(alt->statement->is_expression());
+                    printer.print_cpp2(alt->position(), "; else return ", result_type, "{}");
+                    printer.print_cpp2(alt->position(), "; else return ", result_type, "{}");
+                }
+
+                printer.print_cpp2(return_suffix, alt->position());
+            }
+            else {
+                errors.emplace_back(
+                    alt->position(),
+                    "(temporary alpha limitation) cppfront is still learning 'inspect' - only simple 'is' alternatives are currently supported"
+                );
+                return;
+            }
+        }
+
+        if (is_expression) {
+            if (!found_wildcard) {
+                errors.emplace_back(
+                    n.position(),
+                    "an inspect expression must have an `is _` match-anything wildcard alternative"
+                );
+                return;
+            }
+        }
+        else {
+            printer.print_cpp2("}", n.close_brace);
+        }
+
+        //  If this is an expression, finally actually invoke the lambda
+        if (is_expression) {
+            printer.print_cpp2("()", n.close_brace);
+        }
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(selection_statement_node const& n)
+        -> void
+    {   STACKINSTR
+        assert(n.identifier);
+        emit(*n.identifier);
+
+        if (n.is_constexpr) {
+            printer.print_cpp2(" constexpr", n.position());
+        }
+
+        printer.print_cpp2(" (", n.position());
+        printer.add_pad_in_this_line(1);
+
+        assert(n.expression);
+        emit(*n.expression);
+
+        printer.print_cpp2(") ", n.position());
+        printer.add_pad_in_this_line(1);
+
+        assert(n.true_branch);
+        emit(*n.true_branch);
+
+        if (n.has_source_false_branch) {
+            printer.print_cpp2("else ", n.else_pos);
+            emit(*n.false_branch);
+        }
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(iteration_statement_node const& n)
+        -> void
+    {   STACKINSTR
+        assert(n.identifier);
+
+        iteration_statements.push_back({ &n, false});
+        auto labelname = std::string{};
+        if (n.label) {
+            labelname = n.label->to_string();
+        }
+
+        //  Handle while
+        //
+        if (*n.identifier == "while") {
+            assert(
+                n.condition
+                && n.statements
+                && !n.range
+                && !n.body
+            );
+
+            //  We emit Cpp2 while loops as Cpp2 for loops if there's a "next" clause
+            if (!n.next_expression) {
+                printer.print_cpp2("while( ", n.position());
+                emit(*n.condition);
+            }
+            else {
+                printer.print_cpp2("for( ; ", n.position());
+                emit(*n.condition);
+                printer.print_cpp2("; ", n.position());
+                printer.add_pad_in_this_line(-10);
+                emit(*n.next_expression);
+            }
+            printer.print_cpp2(" ) ", n.position());
+            if (!labelname.empty()) {
+                printer.print_extra("{");
+            }
+            emit(*n.statements);
+            if (!labelname.empty()) {
+                printer.print_extra(" CPP2_CONTINUE_BREAK("+labelname+") }");
+            }
+        }
+
+        //  Handle do
+        //
+        else if (*n.identifier == "do") {
+            assert(
+                n.condition
+                && n.statements
+                && !n.range
+                && !n.body
+            );
+
+            printer.print_cpp2("do ", n.position());
+            if (!labelname.empty()) {
+                printer.print_extra("{");
+            }
+            emit(*n.statements);
+            if (!labelname.empty()) {
+                printer.print_extra(" CPP2_CONTINUE_BREAK("+labelname+") }");
+            }
+            printer.print_cpp2(" while ( ", n.position());
+            if (n.next_expression) {
+                //  Gotta say, this feels kind of nifty... short-circuit eval
+                //  and smuggling work into a condition via a lambda, O my...
+                printer.print_cpp2("[&]{ ", n.position());
+                emit(*n.next_expression);
+                printer.print_cpp2(" ; return true; }() && ", n.position());
+            }
+            emit(*n.condition);
+            printer.print_cpp2(");", n.position());
+        }
+
+        //  Handle for
+        //
+        else if (*n.identifier == "for") {
+            assert(
+                !n.condition
+                && !n.statements
+                && n.range
+                && n.parameter
+                && n.body
+            );
+
+            //  Note: This used to emit cpp2_range as a range-for-loop scope variable,
+            //        but some major compilers seem to have random troubles with that;
+            //        the workaround to avoid their bugs for now is to emit a { } block
+            //        around the Cpp1 range-for and make the scope variable a normal local
+
+            printer.print_cpp2("for ( ", n.position());
+
+            emit(*n.parameter);
+
+            printer.print_cpp2(" : ", n.position());
+
+            //  If this expression is just a single expression-list, we can
+            //  take over direct control of emitting it without needing to
+            //  go through the whole grammar, and surround it with braces
+            if (n.range->is_expression_list()) {
+                printer.print_cpp2( "{ ", n.position() );
+                emit(*n.range->get_expression_list(), false);
+                printer.print_cpp2( " }", n.position() );
+            }
+            //  Otherwise, just emit the general expression as usual
+            else {
+                emit(*n.range);
+            }
+
+            printer.print_cpp2(" ) ", n.position());
+            if (!labelname.empty()) {
+                printer.print_extra("{");
+            }
+
+            //  If there's a next-expression, smuggle it in via a nested do/while(false) loop
+            //  (nested "continue" will work, but "break" won't until we do extra work to implement
+            //  that using a flag and implementing "break" as "_for_break = true; continue;")
+            if (n.next_expression) {
+                printer.print_cpp2(" { do ", n.position());
+            }
+
+            assert(n.body);
+            emit(*n.body);
+
+            if (n.next_expression) {
+                printer.print_cpp2(" while (false); ", n.position());
+                emit(*n.next_expression);
+                printer.print_cpp2("; }", n.position());
+            }
+
+            printer.print_cpp2("", n.position());
+            if (!labelname.empty()) {
+                printer.print_extra(" CPP2_CONTINUE_BREAK("+labelname+") }");
+            }
+        }
+
+        else {
+            assert(!"ICE: unexpected case");
+        }
+
+        assert (iteration_statements.back().stmt);
+        if (
+            iteration_statements.back().stmt->label
+            && !iteration_statements.back().used
+            )
+        {
+            auto name = iteration_statements.back().stmt->label->to_string();
+            errors.emplace_back(
+                iteration_statements.back().stmt->position(),
+                name + ": a named loop must have its name used (did you forget 'break " + name + ";' or 'continue " + name + "';?)"
+            );
+        }
+
+        iteration_statements.pop_back();
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(return_statement_node const& n)
+        -> void
+    {   STACKINSTR
+        assert (!current_functions.empty());
+        if (current_functions.back().func->has_postconditions()) {
+            printer.print_cpp2( "cpp2_finally_presuccess.run(); ", n.position() );
+        }
+
+        assert(n.identifier);
+        assert(*n.identifier == "return");
+        printer.print_cpp2("return ", n.position());
+
+        in_single_unqualified_id_return.push_back(
+            n.expression
+            && n.expression->is_unqualified_id()
+        );
+        auto guard = finally([&]{ in_single_unqualified_id_return.pop_back(); });
+
+        //  Return with expression == single anonymous return type
+        //
+        if (n.expression)
+        {
+            assert(!current_functions.empty());
+            auto is_forward_return =
+                !function_returns.empty()
+                && function_returns.back().pass == passing_style::forward;
+            auto is_deduced_return =
+                !function_returns.empty()
+                && function_returns.back().is_deduced;
+
+            //  If we're doing a forward return of a single-token name
+            if (auto tok = n.expression->expr->get_postfix_expression_node()->expr->get_token();
+                tok
+                && is_forward_return
+                )
+            {
+                //  Ensure we're not returning a local or an in/move parameter
+                auto is_parameter_name = current_functions.back().decl->has_parameter_named(*tok);
+                if (
+                    is_parameter_name
+                    && (
+                        current_functions.back().decl->has_in_parameter_named(*tok)
+                        || current_functions.back().decl->has_copy_parameter_named(*tok)
+                        || current_functions.back().decl->has_move_parameter_named(*tok)
+                        )
+                    )
+                {
+                    errors.emplace_back(
+                        n.position(),
+                        "a 'forward' return type cannot return an 'in', 'copy', or 'move' parameter"
+                    );
+                    return;
+                }
+                else if (
+                    !is_parameter_name
+                    && sema.get_declaration_of(*tok)
+                    && !sema.is_captured(*tok)
+                    )
+                {
+                    errors.emplace_back(
+                        n.position(),
+                        "a 'forward' return type cannot return a local variable"
+                    );
+                    return;
+                } else if (
+                    is_literal(tok->type()) || n.expression->expr->is_result_a_temporary_variable()
+                )
+                {
+                    errors.emplace_back(
+                        n.position(),
+                        "a 'forward' return type must return an 'inout', 'out', or 'forward' parameter; it cannot return a complex expression -- for example: for a function that takes a stream object 'output`, instead of 'return output << data;' write 'output << data; return output;'"
+                    );
+                    return;
+                }
+            }
+
+            //  If this expression is just a single expression-list, we can
+            //  take over direct control of emitting it without needing to
+            //  go through the whole grammar, and surround it with braces
+            if (n.expression->is_expression_list()) {
+                if (!is_deduced_return) {
+                    printer.print_cpp2( "{ ", n.position() );
+                }
+                emit(*n.expression->get_expression_list(), false);
+                if (!is_deduced_return) {
+                    printer.print_cpp2( " }", n.position() );
+                }
+            }
+            //  Otherwise, just emit the general expression as usual
+            else {
+                emit(*n.expression);
+            }
+
+            if (
+                function_returns.empty()
+                || function_returns.back().param_list != &single_anon
+                )
+            {
+                errors.emplace_back(
+                    n.position(),
+                    "return statement with expression must be in a function with a single anonymous return value"
+                );
+                return;
+            }
+        }
+
+        else if (
+            !function_returns.empty()
+            && function_returns.back().param_list == &single_anon
+            )
+        {
+            errors.emplace_back(
+                n.position(),
+                "return statement must have an expression in a function with a single anonymous return value"
+            );
+        }
+
+        //  Return without expression, could be assignment operator
+        //
+        else if (generating_assignment_from == current_functions.back().decl)
+        {
+            printer.print_cpp2("*this", n.position());
+        }
+
+        //  Otherwise, zero or named return values
+        //
+        else if (
+            !function_returns.empty()
+            && function_returns.back().param_list
+            )
+        {
+            auto& parameters = function_returns.back().param_list->parameters;
+
+            auto stmt = std::string{};
+
+            //  Put braces only around multiple named returns, which are a struct
+            //  - single named returns are emitted as ordinary returns, and extra
+            //  { } would be legal but generate a noisy warning on some compilers
+            if (std::ssize(parameters) > 1) {
+                stmt += std::string(" { ");
+            }
+
+            for (bool first = true; auto& param : parameters) {
+                if (!first) {
+                    stmt += ", ";
+                }
+                first = false;
+                assert(param->declaration->identifier);
+
+                printer.emit_to_string(&stmt);
+                emit(*param->declaration->identifier, cpp2::unsafe_narrow<int>(parameters.size()));
+                printer.emit_to_string();
+            }
+
+            if (std::ssize(parameters) > 1) {
+                stmt += std::string(" }");
+            }
+
+            printer.print_cpp2(stmt, n.position());
+        }
+
+        printer.print_cpp2("; ", n.position());
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(jump_statement_node const& n)
+        -> void
+    {   STACKINSTR
+        assert(n.keyword);
+
+        if (n.label) {
+            auto iter_stmt =
+                std::find_if(
+                    iteration_statements.begin(),
+                    iteration_statements.end(),
+                    [&](auto& s){
+                        assert(s.stmt);
+                        return
+                            s.stmt->label
+                            && std::string_view{*s.stmt->label} == std::string_view{*n.label}
+                            ;
+                    }
+                );
+            if (iter_stmt == iteration_statements.end())
+            {
+                errors.emplace_back(
+                    n.position(),
+                    "a named " + n.keyword->to_string() + " must use the name of an enclosing local loop label"
+                );
+                return;
+            }
+            iter_stmt->used = true;
+            assert((*iter_stmt).stmt->label);
+            printer.print_cpp2(
+                "goto " + to_upper_and_underbar(*n.keyword) + "_" + (*iter_stmt).stmt->label->to_string() + ";",
+                n.position()
+            );
+        }
+        else {
+            emit(*n.keyword);
+            printer.print_cpp2(";", n.position());
+        }
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(using_statement_node const& n)
+        -> void
+    {   STACKINSTR
+        assert(n.keyword);
+        emit(*n.keyword);
+
+        if (n.for_namespace) {
+            printer.print_cpp2(" namespace", n.position());
+        } else {
+            current_names.push_back(active_using_declaration{n});
+        }
+
+        printer.print_cpp2(n.position(), " ", print_to_string(*n.id), ";");
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto build_capture_lambda_intro_for(
+        capture_group&  captures,
+        source_position pos,
+        bool            include_default_reference_capture = false
+    )
+        -> std::string
+    {
+        //  First calculate the stringized version of each capture expression
+        //  This will let us compare and de-duplicate repeated capture expressions
+        for (auto& cap : captures.members)
+        {
+            assert(cap.capture_expr->cap_grp == &captures);
+            if (cap.str.empty()) {
+                print_to_string(&cap.str, *cap.capture_expr, true);
+                suppress_move_from_last_use = true;
+                print_to_string(&cap.str_suppressed_move, *cap.capture_expr, true);
+                suppress_move_from_last_use = false;
+            }
+        }
+
+        // If move from last use was used on the variable we need to rewrite the str to add std::move
+        // to earlier use of the variable. That will save us from capturing one variable two times
+        // (one with copy and one with std::move).
+        for (auto rit = captures.members.rbegin(); rit != captures.members.rend(); ++rit)
+        {
+            auto is_same_str_suppressed_move = [s=rit->str_suppressed_move](auto& cap){
+                return cap.str_suppressed_move == s;
+            };
+
+            auto rit2 = std::find_if(rit+1, captures.members.rend(), is_same_str_suppressed_move);
+            while (rit2 != captures.members.rend())
+            {
+                rit2->str = rit->str;
+                rit2 = std::find_if(rit2+1, captures.members.rend(), is_same_str_suppressed_move);
+            }
+        }
+
+        //  Then build the capture list, ignoring duplicated expressions
+        auto lambda_intro = std::string("[");
+        auto num_captures = 0;
+
+        if (
+            (!current_functions.empty()
+                && current_functions.back().decl->is_function_with_this()
+                && !current_functions.back().decl->parent_is_namespace()
+                )
+            || include_default_reference_capture
+            )
+        {
+            //  Note: & is needed (when allowed, not at namespace scope) because a
+            //  nested UFCS might be viewed as trying to capture 'this'
+            lambda_intro += "&";
+            ++num_captures;
+        }
+
+        printer.emit_to_string(&lambda_intro);
+
+        auto handled = std::vector<std::string>{};
+        for (auto& cap : captures.members)
+        {
+            //  If we haven't handled a capture that looks like this one
+            if (std::find(handled.begin(), handled.end(), cap.str) == handled.end())
+            {
+                //  Remember it
+                handled.push_back(cap.str);
+
+                //  And handle it
+                if (num_captures != 0) { // not first
+                    lambda_intro += ", ";
+                }
+                cap.cap_sym = "_"+std::to_string(num_captures);
+                printer.print_cpp2(pos, cap.cap_sym, " = ", cap.str);
+            }
+            ++num_captures;
+        }
+        printer.emit_to_string();
+        lambda_intro += "]";
+
+        return lambda_intro;
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(primary_expression_node const& n)
+        -> void
+    {   STACKINSTR
+        try_emit<primary_expression_node::identifier     >(n.expr);
+        try_emit<primary_expression_node::expression_list>(n.expr);
+        try_emit<primary_expression_node::id_expression  >(n.expr);
+        try_emit<primary_expression_node::inspect        >(n.expr, true);
+        try_emit<primary_expression_node::literal        >(n.expr);
+
+        if (n.expr.index() == primary_expression_node::declaration)
+        {
+            //  This must be an anonymous declaration
+            auto& decl = std::get<primary_expression_node::declaration>(n.expr);
+            assert(
+                decl
+                && !decl->identifier
+            );
+
+            //  Handle an anonymous function
+            if (decl->is_function()) {
+                auto lambda_intro = build_capture_lambda_intro_for(decl->captures, n.position());
+
+                // Handle an anonymous generic function with explicit type list
+                if (decl->template_parameters) {
+                    print_to_string(&lambda_intro, *decl->template_parameters, false, true);
+                }
+
+                emit(*decl, lambda_intro);
+            }
+            //  Else an anonymous object as 'typeid { initializer }'
+            else {
+                assert(decl->is_object());
+                auto& type_id = std::get<declaration_node::an_object>(decl->type);
+
+                printer.add_pad_in_this_line( -5 );
+
+                emit(*type_id);
+                printer.print_cpp2("{", decl->position());
+
+                if (!decl->initializer) {
+                    errors.emplace_back(
+                        decl->position(),
+                        "an anonymous object declaration must have '=' and an initializer"
+                    );
+                    return;
+                }
+
+                emit(*decl->initializer, false);
+
+                printer.print_cpp2("}", decl->position());
+            }
+        }
+    }
+
+    //  Not yet implemented. TODO: finalize deducing pointer types from parameter lists
+    auto is_pointer_declaration(
+        parameter_declaration_list_node const*,
+        int,
+        int
+    )
+        -> bool
+    {
+        return false;
+    }
+
+    auto is_pointer_declaration(
+        declaration_node const* decl_node,
+        int                     deref_cnt,
+        int                     addr_cnt
+    )
+        -> bool
+    {
+        if (!decl_node) {
+            return false;
+        }
+        if (addr_cnt > deref_cnt) {
+            return true;
+        }
+
+        return std::visit([&](auto const& type){
+            return is_pointer_declaration(type.get(), deref_cnt, addr_cnt);
+        }, decl_node->type);
+    }
+
+    auto is_pointer_declaration(
+        function_type_node const* fun_node,
+        int                       deref_cnt,
+        int                       addr_cnt
+    )
+        -> bool
+    {
+        if (!fun_node) {
+            return false;
+        }
+        if (addr_cnt > deref_cnt) {
+            return true;
+        }
+
+        return std::visit([&]<typename T>(T const& type){
+            if constexpr (std::is_same_v<T, std::monostate>) {
+                return false;
+            }
+            else if constexpr (std::is_same_v<T, function_type_node::single_type_id>) {
+                return is_pointer_declaration(type.type.get(),  deref_cnt, addr_cnt);
+            }
+            else {
+                return is_pointer_declaration(type.get(),  deref_cnt, addr_cnt);
+            }
+        }, fun_node->returns);
+    }
+
+    auto is_pointer_declaration(
+        type_id_node const* type_id_node,
+        int                 deref_cnt,
+        int                 addr_cnt
+    )
+        -> bool
+    {
+        if (!type_id_node) {
+            return false;
+        }
+        if (addr_cnt > deref_cnt) {
+            return true;
+        }
+
+        if ( type_id_node->dereference_of ) {
+            return is_pointer_declaration(type_id_node->dereference_of, deref_cnt + type_id_node->dereference_cnt, addr_cnt);
+        } else if ( type_id_node->address_of ) {
+            return is_pointer_declaration(type_id_node->address_of, deref_cnt, addr_cnt + 1);
+        }
+
+        auto pointer_declarators_cnt = std::count_if(std::cbegin(type_id_node->pc_qualifiers), std::cend(type_id_node->pc_qualifiers), [](auto* q) {
+            return q->type() == lexeme::Multiply;
+        });
+
+        if (
+            pointer_declarators_cnt == 0
+            && type_id_node->suspicious_initialization
+            )
+        {
+            return is_pointer_declaration(type_id_node->suspicious_initialization, deref_cnt, addr_cnt);
+        }
+
+        return (unsafe_narrow<int>(pointer_declarators_cnt) + addr_cnt - deref_cnt) > 0;
+    }
+
+    auto is_pointer_declaration(
+        type_node const*,
+        int,
+        int
+    )
+        -> bool
+    {
+        return false;
+    }
+
+    auto is_pointer_declaration(
+        namespace_node const*,
+        int,
+        int
+    )
+        -> bool
+    {
+        return false;
+    }
+
+    auto is_pointer_declaration(
+        alias_node const*,
+        int,
+        int
+    )
+        -> bool
+    {
+        return false;
+    }
+
+    auto is_pointer_declaration(
+        declaration_sym const* decl,
+        int                    deref_cnt,
+        int                    addr_cnt
+    )
+        -> bool
+    {
+        if (!decl) {
+            return false;
+        }
+        if (addr_cnt > deref_cnt) {
+            return true;
+        }
+        return is_pointer_declaration(decl->declaration, deref_cnt, addr_cnt);
+    }
+
+    auto is_pointer_declaration(
+        token const* t,
+        int          deref_cnt = 0,
+        int          addr_cnt = 0
+    )
+        -> bool
+    {
+        if (!t) {
+            return false;
+        }
+        if (addr_cnt > deref_cnt) {
+            return true;
+        }
+        auto decl = sema.get_declaration_of(*t, true);
+        return is_pointer_declaration(decl, deref_cnt, addr_cnt);
+    }
+
+
+    auto source_order_name_lookup(std::string_view identifier)
+        -> source_order_name_lookup_res
+    {
+        for (
+            auto first = current_names.rbegin(), last = current_names.rend() - 1;
+            first != last;
+            ++first
+            )
+        {
+            if (
+                auto decl = get_if<declaration_node const*>(&*first);
+                decl
+                && *decl
+                && (*decl)->has_name(identifier)
+                )
+            {
+                return *decl;
+            }
+            else if (
+                auto using_ = get_if<active_using_declaration>(&*first);
+                using_
+                && using_->identifier
+                && *using_->identifier == identifier
+                )
+            {
+                return *using_;
+            }
+        }
+
+        return {};
+    }
+
+    auto lookup_finds_type_scope_function(id_expression_node const& n)
+        -> bool
+    {
+        if (!n.is_unqualified())
+        {
+            return false;
+        }
+
+        auto const& id = *get<id_expression_node::unqualified>(n.id);
+        auto lookup = source_order_name_lookup(*id.identifier);
+
+        if (
+            !lookup
+            || get_if<active_using_declaration>(&*lookup)
+            )
+        {
+            return false;
+        }
+
+        auto decl = get<declaration_node const*>(*lookup);
+
+        if (
+            !decl->is_function()
+            || !decl->has_name()
+            || !decl->parent_is_type()
+            )
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    auto lookup_finds_variable_with_placeholder_type_under_initialization(id_expression_node const& n)
+        -> bool
+    {
+        if (!n.is_unqualified())
+        {
+            return false;
+        }
+
+        auto const& id = *get<id_expression_node::unqualified>(n.id);
+        auto lookup = source_order_name_lookup(*id.identifier);
+
+        if (
+            !lookup
+            || get_if<active_using_declaration>(&*lookup)
+            )
+        {
+            return false;
+        }
+
+        auto decl = get<declaration_node const*>(*lookup);
+        if (
+            decl
+            && decl->has_name(*id.identifier)
+            )
+        {
+            if (
+                !decl->is_object()
+                && !decl->is_object_alias()
+                )
+            {
+                return false;
+            }
+
+            if (decl->is_object()) {
+                auto type = &**get_if<declaration_node::an_object>(&decl->type);
+                return type->is_wildcard()
+                       && contains(current_declarations, decl);
+            }
+            auto const& type = (**get_if<declaration_node::an_alias>(&decl->type)).type_id;
+            return (
+                    !type
+                    || type->is_wildcard()
+                    )
+                   && contains(current_declarations, decl);
+        }
+
+        return false;
+    }
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        //  Note: parameter is not const as we'll fill in the capture .str info
+        postfix_expression_node& n,
+        bool                     for_lambda_capture = false
+    )
+        -> void
+    {   STACKINSTR
+        if (!sema.check(n, errors)) {
+            return;
+        }
+
+        assert(n.expr);
+        last_postfix_expr_was_pointer = false;
+
+        //  For a 'move that' parameter, track the members we already moved from
+        //  so we can diagnose attempts to move from the same member twice
+        if (
+            emitting_move_that_function
+            && n.expr->get_token()
+            && *n.expr->get_token() == "that"
+            )
+        {
+            if (n.ops.empty()) {
+                if (!already_moved_that_members.empty()) {
+                    errors.emplace_back(
                         n.position(),
                         "attempting to move from whole 'that' object after a 'that.member' was already moved from"
                     );
                     return;
                 }
-                //  push a sentinel for "all members"
-                already_moved_that_members.push_back(nullptr);
+                //  push a sentinel for "all members"
+                already_moved_that_members.push_back(nullptr);
+            }
+            else {
+                auto member = n.ops[0].id_expr->get_token();
+                assert(member);
+
+                for (
+                    auto i = already_moved_that_members.begin();
+                    i != already_moved_that_members.end();
+                    ++i
+                    )
+                {
+                    if (
+                        !*i
+                        || **i == *member
+                        )
+                    {
+                        errors.emplace_back(
+                            n.position(),
+                            "attempting to move twice from 'that." + member->to_string() + "'"
+                        );
+                        return;
+                    }
+                }
+
+                already_moved_that_members.push_back(member);
+            }
+        }
+
+        //  Ensure that forwarding postfix-expressions start with a forwarded parameter name
+        //
+        assert (!current_args.empty());
+        if (current_args.back().pass == passing_style::forward)
+        {
+            assert (n.expr->get_token());
+            assert (!current_args.back().ptoken);
+            current_args.back().ptoken = n.expr->get_token();
+            auto decl = sema.get_declaration_of(*current_args.back().ptoken);
+            if (!(decl && decl->parameter && decl->parameter->pass == passing_style::forward))
+            {
+                errors.emplace_back(
+                    n.position(),
+                    n.expr->get_token()->to_string() + " is not a forwarding parameter name"
+                );
+            }
+        }
+
+        //  Check that this isn't pointer arithmentic
+        //      (initial partial implementation)
+        if (n.expr->expr.index() == primary_expression_node::id_expression)
+        {
+            auto& id = std::get<primary_expression_node::id_expression>(n.expr->expr);
+            assert(id);
+            if (id->id.index() == id_expression_node::unqualified)
+            {
+                auto& unqual = std::get<id_expression_node::unqualified>(id->id);
+                assert(unqual);
+                //  TODO: Generalize this:
+                //        - we don't recognize pointer types from Cpp1
+                //        - we don't deduce pointer types from parameter_declaration_list_node
+                if ( is_pointer_declaration(unqual->identifier) ) {
+                    if (n.ops.empty()) {
+                        last_postfix_expr_was_pointer = true;
+                    }
+                    else
+                    {
+                        auto op = [&]{
+                            if (
+                                n.ops.size() >= 2
+                                && n.ops[0].op->type() == lexeme::LeftParen
+                                )
+                            {
+                                return n.ops[1].op;
+                            }
+                            else
+                            {
+                                return n.ops.front().op;
+                            }
+                        }();
+
+                        if (
+                            op->type() == lexeme::PlusPlus
+                            || op->type() == lexeme::MinusMinus
+                            || op->type() == lexeme::LeftBracket
+                            )
+                        {
+                            errors.emplace_back(
+                                op->position(),
+                                op->to_string() + " - pointer arithmetic is illegal - use std::span or gsl::span instead"
+                            );
+                            violates_bounds_safety = true;
+                        }
+                        else if (
+                            op->type() == lexeme::Tilde
+                            )
+                        {
+                            errors.emplace_back(
+                                op->position(),
+                                op->to_string() + " - pointer bitwise manipulation is illegal - use std::bit_cast to convert to raw bytes first"
+                            );
+                        }
+                    }
+                }
+            }
+        }
+
+        //  With -source-sites, remember whether this is a call to Cpp2's own
+        //  new (not found by name lookup), or a unique.new or shared.new,
+        //  so that only those get a site (see emit(unqualified_id_node))
+        if (uses_source_sites())
+        {
+            auto identifier_of = [](id_expression_node const& id) -> token const* {
+                if (id.is_unqualified()) {
+                    return get<id_expression_node::unqualified>(id.id)->identifier;
+                }
+                return {};
+            };
+
+            if (n.expr->is_id_expression())
+            {
+                auto name = identifier_of(*get<primary_expression_node::id_expression>(n.expr->expr));
+                if (
+                    name
+                    && *name == "new"
+                    && !source_order_name_lookup(*name)
+                    )
+                {
+                    source_site_news.insert(name);
+                }
+            }
+            if (
+                !n.ops.empty()
+                && n.ops.front().op->type() == lexeme::Dot
+                && n.ops.front().id_expr
+                )
+            {
+                auto name     = identifier_of(*n.ops.front().id_expr);
+                auto receiver = n.expr->to_string();
+                if (
+                    name
+                    && *name == "new"
+                    && (
+                        receiver == "unique"
+                        || receiver == "shared"
+                        || receiver == "cpp2::unique"
+                        || receiver == "cpp2::shared"
+                        )
+                    )
+                {
+                    source_site_news.insert(name);
+                }
+            }
+        }
+
+        //  Simple case: If there are no .ops, just emit the expression
+        if (n.ops.empty()) {
+            emit(*n.expr);
+            return;
+        }
+
+        //  Check to see if it's a capture expression that contains $,
+        //  and if we're not capturing the expression for the lambda
+        //  introducer replace it with the capture name
+        auto captured_part = std::string{};
+        if (
+            n.cap_grp
+            && !for_lambda_capture
+            )
+        {
+            //  First stringize ourselves so that we compare equal against
+            //  the first *cap_grp .str_suppressed_move that matches us (which is what the
+            //  lambda introducer generator used to create a lambda capture)
+            suppress_move_from_last_use = true;
+            auto my_sym = print_to_string(n, true);
+            suppress_move_from_last_use = false;
+
+            auto found = std::find_if(n.cap_grp->members.cbegin(), n.cap_grp->members.cend(), [my_sym](auto& cap) {
+                return cap.str_suppressed_move == my_sym;
+            });
+
+            assert(
+                found != n.cap_grp->members.cend()
+                && "ICE: could not find this postfix-expression in capture group"
+            );
+            //  And then emit that capture symbol with number
+            assert (!found->cap_sym.empty());
+            captured_part += found->cap_sym;
+        }
+
+        //  Otherwise, we're going to have to potentially do some work to change
+        //  some Cpp2 postfix operators to Cpp1 prefix operators, so let's set up...
+        auto prefix            = std::vector<text_with_pos>{};
+        auto suffix            = std::vector<text_with_pos>{};
+        suffix.reserve(4 * n.ops.size());   // typically ~2 per op plus any arguments
+
+        auto last_was_prefixed = false;
+        auto saw_dollar        = false;
+
+        struct text_chunks_with_parens_position {
+            std::vector<text_with_pos> text_chunks;
+            source_position            open_pos;
+            source_position            close_pos;
+        };
+
+        auto args = std::optional<text_chunks_with_parens_position>{};
+
+        auto flush_args = [&] {
+            if (args) {
+                suffix.emplace_back(")", args.value().close_pos);
+                for (auto&& e: args.value().text_chunks) {
+                    suffix.push_back(std::move(e));
+                }
+                suffix.emplace_back("(", args.value().open_pos);
+                args.reset();
+            }
+        };
+
+        auto print_to_text_chunks = [&](auto& i, auto... more) {
+            auto text = std::vector<text_with_pos>{};
+            printer.emit_to_text_chunks(&text);
+            push_need_expression_list_parens(false);
+            emit(i, more...);
+            pop_need_expression_list_parens();
+            printer.emit_to_text_chunks();
+            return text;
+        };
+
+        for (auto i = n.ops.rbegin(); i != n.ops.rend(); ++i)
+        {
+            assert(i->op);
+
+            //  If we already captured a part as a _## lambda capture,
+            //  skip the part of this expression before the $ symbol
+            //
+            if (!captured_part.empty()) {
+                if (i->op->type() == lexeme::Dollar) {
+                    break;
+                }
+            }
+            //  Else skip the part of this expression after the $ symbol
+            else if (for_lambda_capture) {
+                if (i->op->type() == lexeme::Dollar) {
+                    saw_dollar = true;
+                    continue;
+                }
+                if (!saw_dollar) {
+                    continue;
+                }
+            }
+
+            //  Going backwards if we found LeftParen it might be UFCS
+            //  expr_list is emitted to 'args' for future use
+            if (i->op->type() == lexeme::LeftParen) {
+
+                assert(i->op);
+                assert(i->op_close);
+                auto local_args = text_chunks_with_parens_position{{}, i->op->position(), i->op_close->position()};
+
+                assert (i->expr_list);
+                if (!i->expr_list->expressions.empty()) {
+                    local_args.text_chunks = print_to_text_chunks(*i->expr_list);
+                }
+
+                flush_args();
+                args.emplace(std::move(local_args));
+            }
+            //  Going backwards if we found Dot and there is args variable
+            //  it means that it should be handled by UFCS
+            else if(
+                i->op->type() == lexeme::Dot
+                && args
+                //  Disable UFCS if name lookup would hard-error (#550).
+                //  That happens when it finds that the function identifier being called is the name
+                //  of a variable with deduced type and we are in its initializer (e.g., x := y.x();)
+                //  So lower it to a member call instead, the only possible valid meaning.
+                && !lookup_finds_variable_with_placeholder_type_under_initialization(*i->id_expr)
+                )
+            {
+                //  The function name is the argument to the macro
+                auto funcname = print_to_string(*i->id_expr);
+
+                //  First, build the UFCS macro name
+
+                auto ufcs_string = std::string("CPP2_UFCS");
+                record_check("ufcs", i->op->position());
+
+                //  If there are template arguments, use the _TEMPLATE version
+                if (std::ssize(i->id_expr->template_arguments()) > 0) {
+                    //  If it is qualified, use the _QUALIFIED version
+                    if (i->id_expr->is_qualified()) {
+                        ufcs_string += "_QUALIFIED";
+                        //  And split the unqualified id in the function name as two macro arguments
+                        auto& id = *get<id_expression_node::qualified>(i->id_expr->id);
+                        funcname =
+                            "("
+                            + print_to_string(id, false)
+                            + "::),"
+                            + print_to_string(*cpp2::impl::assert_not_null(id.ids.back().id), 0, true, true);
+                    }
+                    ufcs_string += "_TEMPLATE";
+                }
+
+                //  If we're in an object declaration (i.e., initializer)
+                //  at namespace scope, use the _NONLOCAL version
+                //
+                //  Note: If there are other cases where code could execute
+                //  in a non-local scope where a capture-default for the UFCS
+                //  lambda would not be allowed, then add them here
+                if (
+                    current_declarations.back()->is_namespace()
+                    || (
+                        current_declarations.back()->is_object()
+                        && current_declarations.back()->parent_is_namespace()
+                        )
+                    || (
+                        (
+                         current_declarations.back()->is_alias()
+                         || (
+                             current_declarations.back()->is_function()
+                             && current_declarations.back() == having_signature_emitted
+                             )
+                         )
+                        && (
+                            current_declarations.back()->parent_is_namespace()
+                            || current_declarations.back()->parent_is_type()
+                            )
+                        )
+                    )
+                {
+                    ufcs_string += "_NONLOCAL";
+                }
+
+                //  If it's a last use, emit as part of the macro name
+                //
+                //  Note: This ensures a valid member call is still prioritized
+                //  by leveraging the last use only in the non-member branch
+                //  For example, `x.f()` won't emit as 'CPP2_UFCS(cpp2::move(f))(x)'
+                //  to never take the branch that wants to call `x.cpp2::move(f)()`
+                if (auto last_use = sema.is_definite_last_use(i->id_expr->get_token());
+                    last_use
+                    && last_use->safe_to_move
+                    && !lookup_finds_type_scope_function(*i->id_expr)
+                    )
+                {
+                    if (last_use->is_forward) {
+                        ufcs_string += "_FORWARD";
+                    }
+                    else {
+                        ufcs_string += "_MOVE";
+                    }
+
+                    in_non_rvalue_context.push_back(true);
+                    funcname = print_to_string(*i->id_expr);
+                    in_non_rvalue_context.pop_back();
+                }
+
+                //  Second, emit the UFCS argument list
+
+                //  If the computed function name is an explicit member access
+                //  we don't need to go through the UFCS macro
+                //  Note: This also works around compiler bugs
+                if (funcname.starts_with("cpp2::move(*this).")) {
+                    funcname += '(';
+                    prefix.emplace_back(std::move(funcname), args.value().open_pos );
+                }
+                else {
+                    append_parts(ufcs_string, '(', funcname, ")(");
+                    prefix.emplace_back(std::move(ufcs_string), args.value().open_pos );
+                }
+                suffix.emplace_back(")", args.value().close_pos );
+                if (!args.value().text_chunks.empty()) {
+                    for (auto&& e: args.value().text_chunks) {
+                        suffix.push_back(std::move(e));
+                    }
+                    suffix.emplace_back(", ", i->op->position());
+                }
+                args.reset();
+            }
+
+            //  Handle the Cpp2 postfix operators that are prefix in Cpp1
+            //
+            else if (
+                i->op->type() == lexeme::MinusMinus
+                || i->op->type() == lexeme::PlusPlus
+                || i->op->type() == lexeme::Multiply
+                || i->op->type() == lexeme::Ampersand
+                || i->op->type() == lexeme::Tilde
+                )
+            {
+                // omit some needless parens
+                if (
+                    !last_was_prefixed
+                    && i != n.ops.rbegin()
+                    )
+                {
+                    prefix.emplace_back( "(", i->op->position() );
+                }
+                prefix.emplace_back( i->op->to_string(), i->op->position());
+
+                //  Enable null dereference checks
+                if (i->op->type() == lexeme::Multiply) {
+                    record_check("null", i->op->position(), options.safe_null_pointers ? "" : "-no-null-checks");
+                }
+                if (
+                    options.safe_null_pointers
+                    && i->op->type() == lexeme::Multiply
+                    )
+                {
+                    //  The parentheses keep the template argument list's comma
+                    //  from splitting an enclosing macro argument
+                    if (uses_source_sites()) {
+                        auto text = std::string{};
+                        append_parts(text, "(cpp2::impl::assert_not_null<", source_site_id(i->op->position()), ", cpp2::impl::file_sites>)(");
+                        prefix.emplace_back( std::move(text), i->op->position() );
+                    }
+                    else {
+                        prefix.emplace_back( "cpp2::impl::assert_not_null(", i->op->position() );
+                    }
+                }
+                if (
+                    options.safe_null_pointers
+                    && i->op->type() == lexeme::Multiply
+                    )
+                {
+                    suffix.emplace_back( ")", i->op->position() );
+                }
+
+                // omit some needless parens
+                if (
+                    !last_was_prefixed
+                    && i != n.ops.rbegin()
+                    )
+                {
+                    suffix.emplace_back( ")", i->op->position() );
+                }
+                last_was_prefixed = true;
+            }
+
+            //  Handle the other Cpp2 postfix operators that stay postfix in Cpp1 (currently: '...')
+            else if (is_postfix_operator(i->op->type())) {
+                flush_args();
+                suffix.emplace_back( i->op->to_string(), i->op->position());
+            }
+
+            //  Handle the suffix operators that remain suffix
+            //
+            else {
+                flush_args();
+
+                assert(i->op);
+                last_was_prefixed = false;
+
+                //  Enable subscript bounds checks
+                if (
+                    options.safe_subscripts
+                    && i->op->type() == lexeme::LeftBracket
+                    && std::ssize(i->expr_list->expressions) == 1
+                    )
+                {
+                    suffix.emplace_back( ")", i->op->position() );
+                }
+                else if (i->op_close) {
+                    suffix.emplace_back( i->op_close->to_string(), i->op_close->position() );
+                }
+
+                if (i->id_expr)
+                {
+                    if (args) {
+                        //  If args are stored it means that this is function or method
+                        //  that is not handled by UFCS and args need to be printed
+                        suffix.emplace_back(")", args.value().close_pos);
+                        for (auto&& e: args.value().text_chunks) {
+                            suffix.push_back(std::move(e));
+                        }
+                        suffix.emplace_back("(", args.value().open_pos);
+                        args.reset();
+                    }
+
+                    auto print = print_to_string(*i->id_expr, false /*not a local name*/, i->op->type() == lexeme::Dot);
+                    suffix.emplace_back( std::move(print), i->id_expr->position() );
+                }
+
+                if (i->expr_list) {
+                    auto text = print_to_text_chunks(*i->expr_list);
+                    for (auto&& e: text) {
+                        suffix.push_back(std::move(e));
+                    }
+                }
+
+                //  Enable subscript bounds checks
+                if (
+                    i->op->type() == lexeme::LeftBracket
+                    && std::ssize(i->expr_list->expressions) == 1
+                    )
+                {
+                    record_check("subscript", i->op->position(), options.safe_subscripts ? "" : "-no-subscript-checks");
+                }
+                if (
+                    options.safe_subscripts
+                    && i->op->type() == lexeme::LeftBracket
+                    && std::ssize(i->expr_list->expressions) == 1
+                    )
+                {
+                    auto text = std::string{};
+                    if (auto lit = i->expr_list->expressions.front().expr->get_literal();
+                        lit
+                        && lit->literal->type() == lexeme::DecimalLiteral
+                        )
+                    {
+                        text = "CPP2_ASSERT_IN_BOUNDS_LITERAL";
+                    }
+                    else
+                    {
+                        text = "CPP2_ASSERT_IN_BOUNDS";
+                    }
+
+                    if (uses_source_sites()) {
+                        append_parts(text, "_AT(", source_site_id(i->op->position()), ", ");
+                    }
+                    else {
+                        text += '(';
+                    }
+                    prefix.emplace_back( std::move(text), i->op->position() );
+                    suffix.emplace_back( ", ", i->op->position() );
+                }
+                else {
+                    suffix.emplace_back( i->op->to_string(), i->op->position() );
+                }
+            }
+        }
+
+        //  Print the prefixes (in forward order)
+        for (auto& e : prefix) {
+            printer.print_cpp2(e.text, n.position());
+        }
+
+        //  If this is an --, ++, or &, don't add cpp2::move on the lhs
+        //  even if this is a definite last use (only do that when an rvalue is okay)
+        if (
+            n.ops.front().op->type() == lexeme::MinusMinus
+            || n.ops.front().op->type() == lexeme::PlusPlus
+            || n.ops.front().op->type() == lexeme::Ampersand
+            )
+        {
+            suppress_move_from_last_use = true;
+        }
+
+        //  Now print the core expression -- or the captured_part in its place
+        if (captured_part.empty()) {
+            emit(*n.expr);
+        }
+        else {
+            printer.print_cpp2(captured_part, n.position());
+        }
+        suppress_move_from_last_use = false;
+
+        flush_args();
+
+        //  Print the suffixes (in reverse order)
+        while (!suffix.empty()) {
+            printer.print_cpp2(suffix.back().text, suffix.back().pos);
+            suffix.pop_back();
+        }
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(prefix_expression_node const& n)
+        -> void
+    {   STACKINSTR
+        auto suffix = std::string{};
+        for (auto const& x : n.ops) {
+            assert(x);
+            if (x->type() == lexeme::Not) {
+                printer.print_cpp2("!(", n.position());
+                printer.add_pad_in_this_line(-3);
+                suffix += ")";
             }
             else {
-                auto member = n.ops[0].id_expr->get_token();
-                assert(member);
+                printer.print_cpp2(*x, x->position());
+            }
+        }
+        assert(n.expr);
+        push_need_expression_list_parens(true);
+        emit(*n.expr);
+        pop_need_expression_list_parens();
+        printer.print_cpp2(suffix, n.position());
+    }
 
-                for (
-                    auto i = already_moved_that_members.begin();
-                    i != already_moved_that_members.end();
-                    ++i
-                    )
-                {
-                    if (
-                        !*i
-                        || **i == *member
-                        )
-                    {
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(is_as_expression_node const& n)
+        -> void
+    {   STACKINSTR
+        std::string prefix = {};
+        std::string suffix = {};
+
+        auto wildcard_found = false;
+        bool as_on_literal  = false;
+
+        assert(
+            n.expr
+            && n.expr->get_postfix_expression_node()
+            && n.expr->get_postfix_expression_node()->expr
+        );
+        {
+            auto& p = n.expr->get_postfix_expression_node()->expr;
+            if (auto t = p->get_token();
+                t
+                && is_literal(t->type())
+                && t->type() != lexeme::StringLiteral
+                && t->type() != lexeme::FloatLiteral
+                && !std::get<primary_expression_node::literal>(p->expr)->user_defined_suffix
+                && std::ssize(n.ops) > 0
+                && *n.ops[0].op == "as"
+                )
+            {
+                as_on_literal = true;
+            }
+        }
+
+        for (
+            auto i = n.ops.rbegin();
+            i != n.ops.rend();
+            ++i
+            )
+        {
+            //  If it's "ISORAS type", emit "cpp2::impl::ISORAS<type>(expr)"
+            if (i->type)
+            {
+                if (i->type->is_wildcard()) {
+                    wildcard_found = true;
+                    if (*i->op != "is") {
                         errors.emplace_back(
                             n.position(),
-                            "attempting to move twice from 'that." + member->to_string() + "'"
+                            "'as _' wildcard is not allowed, specify a concrete target type instead"
                         );
-                        return;
+                    }
+                    else if (std::ssize(n.ops) > 1) {
+                        errors.emplace_back(
+                            n.position(),
+                            "an 'is _' wildcard may only be used on its own, not in a chain with other 'is'/'as' in the same subexpression"
+                        );
+                    }
+                }
+                else {
+                    auto op_name = i->op->to_string();
+                    if (op_name == "as") {
+                        record_check("as", i->op->position());
+                        op_name = "as_";    // use the static_assert-checked 'as' by default...
+                    }                       // we'll override this inside inspect-expressions
+                    prefix += "cpp2::impl::" + op_name + "<" + print_to_string(*i->type) + ">(";
+                    suffix = ")" + suffix;
+                }
+            }
+            //  Else it's "is value", emit "cpp2::impl::is(expr, value)"
+            else
+            {
+                assert(i->expr);
+                prefix += "cpp2::impl::" + i->op->to_string() + "(";
+                suffix = ", " + print_to_string(*i->expr) + ")" + suffix;
+            }
+        }
+
+        if (as_on_literal) {
+            auto last_pos = prefix.rfind('>'); assert(last_pos != prefix.npos);
+            prefix.insert(last_pos, ", " + print_to_string(*n.expr));
+        }
+
+        printer.print_cpp2(prefix, n.position());
+        if (wildcard_found) {
+            printer.print_cpp2("true", n.position());
+        }
+        else if(!as_on_literal) {
+            emit(*n.expr);
+        }
+        printer.print_cpp2(suffix, n.position());
+    }
+
+
+    //-----------------------------------------------------------------------
+    //
+    template<
+        String   Name,
+        typename Term
+    >
+    auto emit(binary_expression_node<Name,Term> const& n)
+        -> void
+    {   STACKINSTR
+        assert(n.expr);
+        assert(
+            n.terms.empty()
+            || n.terms.front().op
+        );
+
+        //  If this is relational comparison
+        if (
+            !n.terms.empty()
+            && (
+                n.terms.front().op->type() == lexeme::Less
+                || n.terms.front().op->type() == lexeme::LessEq
+                || n.terms.front().op->type() == lexeme::Greater
+                || n.terms.front().op->type() == lexeme::GreaterEq
+                || n.terms.front().op->type() == lexeme::EqualComparison
+                || n.terms.front().op->type() == lexeme::NotEqualComparison
+                )
+            )
+        {
+            auto const& op = *n.terms.front().op;
+
+            //  If this is one (non-chained) comparison, just emit it directly
+            if (std::ssize(n.terms) < 2)
+            {
+                assert (std::ssize(n.terms) == 1);
+
+                if (
+                    op.type() != lexeme::EqualComparison
+                    && op.type() != lexeme::NotEqualComparison
+                    )
+                {
+                    record_check("comparison", op.position(), options.safe_comparisons ? "" : "-no-comparison-checks");
+                }
+
+                //  emit < <= >= > as cmp_*(a,b) calls (if selected)
+                if (options.safe_comparisons) {
+                    switch (op.type()) {
+                    break;case lexeme::Less:
+                        printer.print_cpp2( "cpp2::impl::cmp_less(", n.position());
+                    break;case lexeme::LessEq:
+                        printer.print_cpp2( "cpp2::impl::cmp_less_eq(", n.position());
+                    break;case lexeme::Greater:
+                        printer.print_cpp2( "cpp2::impl::cmp_greater(", n.position());
+                    break;case lexeme::GreaterEq:
+                        printer.print_cpp2( "cpp2::impl::cmp_greater_eq(", n.position());
+                    break;default:
+                        ;
+                    }
+                }
+
+                emit(*n.expr);
+
+                //  emit == and != as infix a ? b operators (since we don't have
+                //  any checking/instrumentation we want to do for those)
+                if (options.safe_comparisons) {
+                    switch (op.type()) {
+                    break;case lexeme::EqualComparison:
+                          case lexeme::NotEqualComparison:
+                        printer.print_cpp2( " ", n.position() );
+                        emit(op);
+                        printer.print_cpp2( " ", n.position() );
+                    break;default:
+                        printer.print_cpp2( ",", n.position() );
+                    }
+                }
+                else {
+                    emit(op);
+                }
+
+                emit(*n.terms.front().expr);
+
+                if (options.safe_comparisons) {
+                    switch (op.type()) {
+                    break;case lexeme::Less:
+                          case lexeme::LessEq:
+                          case lexeme::Greater:
+                          case lexeme::GreaterEq:
+                        printer.print_cpp2( ")", n.position() );
+                    break;default:
+                        ;
                     }
                 }
 
-                already_moved_that_members.push_back(member);
-            }
-        }
+                return;
+            }
+
+            //  Else if this is a chained comparison, emit it as a lambda,
+            //  to get single evaluation via the lambda capture
+            else
+            {
+                //  To check for the valid chains: all </<=, all >/>=, or all ==
+                auto found_lt = 0;  // < and <=
+                auto found_gt = 0;  // > and >=
+                auto found_eq = 0;  // ==
+                auto count    = 0;
+
+                auto const* lhs = n.expr.get();
+                auto lhs_name = "_" + std::to_string(count);
+
+                auto lambda_capture = lhs_name;
+                lambda_capture += " = ";
+                lambda_capture += print_to_string(*lhs);
+                auto lambda_body    = std::string{};
+
+                for (auto const& term : n.terms)
+                {
+                    assert(
+                        term.op
+                        && term.expr
+                    );
+                    ++count;
+                    auto rhs_name = "_" + std::to_string(count);
+
+                    //  Not the first expression? Insert a "&&"
+                    if (found_lt + found_gt + found_eq > 0) {
+                        lambda_body += " && ";
+                    }
 
-        //  Ensure that forwarding postfix-expressions start with a forwarded parameter name
-        //
-        assert (!current_args.empty());
-        if (current_args.back().pass == passing_style::forward)
-        {
-            assert (n.expr->get_token());
-            assert (!current_args.back().ptoken);
-            current_args.back().ptoken = n.expr->get_token();
-            auto decl = sema.get_declaration_of(*current_args.back().ptoken);
-            if (!(decl && decl->parameter && decl->parameter->pass == passing_style::forward))
-            {
-                errors.emplace_back(
-                    n.position(),
-                    n.expr->get_token()->to_string() + " is not a forwarding parameter name"
-                );
-            }
-        }
+                    //  Remember what we've seen
+                    switch (term.op->type()) {
+                    break;case lexeme::Less:
+                          case lexeme::LessEq:
+                        found_lt = 1;
+                    break;case lexeme::Greater:
+                          case lexeme::GreaterEq:
+                        found_gt = 1;
+                    break;case lexeme::EqualComparison:
+                        found_eq = 1;
+                    break;default:
+                        ;
+                    }
 
-        //  Check that this isn't pointer arithmentic
-        //      (initial partial implementation)
-        if (n.expr->expr.index() == primary_expression_node::id_expression)
-        {
-            auto& id = std::get<primary_expression_node::id_expression>(n.expr->expr);
-            assert(id);
-            if (id->id.index() == id_expression_node::unqualified)
-            {
-                auto& unqual = std::get<id_expression_node::unqualified>(id->id);
-                assert(unqual);
-                //  TODO: Generalize this:
-                //        - we don't recognize pointer types from Cpp1
-                //        - we don't deduce pointer types from parameter_declaration_list_node
-                if ( is_pointer_declaration(unqual->identifier) ) {
-                    if (n.ops.empty()) {
-                        last_postfix_expr_was_pointer = true;
+                    //  emit < <= >= > as cmp_*(a,b) calls (if selected)
+                    if (term.op->type() != lexeme::EqualComparison) {
+                        record_check("comparison", term.op->position(), options.safe_comparisons ? "" : "-no-comparison-checks");
+                    }
+                    if (options.safe_comparisons) {
+                        switch (term.op->type()) {
+                        break;case lexeme::Less:
+                            lambda_body += "cpp2::impl::cmp_less(";
+                        break;case lexeme::LessEq:
+                            lambda_body += "cpp2::impl::cmp_less_eq(";
+                        break;case lexeme::Greater:
+                            lambda_body += "cpp2::impl::cmp_greater(";
+                        break;case lexeme::GreaterEq:
+                            lambda_body += "cpp2::impl::cmp_greater_eq(";
+                        break;default:
+                            ;
+                        }
                     }
-                    else
-                    {
-                        auto op = [&]{
-                            if (
-                                n.ops.size() >= 2
-                                && n.ops[0].op->type() == lexeme::LeftParen
-                                )
-                            {
-                                return n.ops[1].op;
-                            }
-                            else
-                            {
-                                return n.ops.front().op;
-                            }
-                        }();
 
-                        if (
-                            op->type() == lexeme::PlusPlus
-                            || op->type() == lexeme::MinusMinus
-                            || op->type() == lexeme::LeftBracket
-                            )
-                        {
+                    auto rhs_expr = print_to_string(*term.expr);
+
+                    lambda_body += lhs_name;
+
+                    //  emit == and != as infix a ? b operators (since we don't have
+                    //  any checking/instrumentation we want to do for those)
+                    if (options.safe_comparisons) {
+                        switch (term.op->type()) {
+                        break;case lexeme::EqualComparison:
+                            lambda_body += *term.op;
+                        break;case lexeme::NotEqualComparison:
                             errors.emplace_back(
-                                op->position(),
-                                op->to_string() + " - pointer arithmetic is illegal - use std::span or gsl::span instead"
+                                n.position(),
+                                "!= comparisons cannot appear in a comparison chain (see https://wg21.link/p0893)"
                             );
-                            violates_bounds_safety = true;
+                            return;
+                        break;default:
+                            lambda_body += ",";
                         }
-                        else if (
-                            op->type() == lexeme::Tilde
-                            )
-                        {
-                            errors.emplace_back(
-                                op->position(),
-                                op->to_string() + " - pointer bitwise manipulation is illegal - use std::bit_cast to convert to raw bytes first"
-                            );
+                    }
+                    else {
+                        lambda_body += *term.op;
+                    }
+
+                    lambda_capture += ", ";
+                    lambda_capture += rhs_name;
+                    lambda_capture += " = ";
+                    lambda_capture += rhs_expr;
+                    lambda_body    += rhs_name;
+
+                    lhs = term.expr.get();
+                    lhs_name = rhs_name;
+
+                    if (options.safe_comparisons) {
+                        switch (term.op->type()) {
+                        break;case lexeme::Less:
+                                case lexeme::LessEq:
+                                case lexeme::Greater:
+                                case lexeme::GreaterEq:
+                            lambda_body += ")";
+                        break;default:
+                            ;
                         }
                     }
                 }
+
+                assert(found_lt + found_gt + found_eq > 0);
+                if (found_lt + found_gt + found_eq != 1) {
+                    errors.emplace_back(
+                        n.position(),
+                        "a comparison chain must be all < and <=, all > and >=, or all == (see https://wg21.link/p0893)"
+                    );
+                    return;
+                }
+
+                printer.print_cpp2( n.position(), "[", lambda_capture, "]{ return ", lambda_body, "; }()" );
+
+                return;
             }
         }
 
-        //  Simple case: If there are no .ops, just emit the expression
-        if (n.ops.empty()) {
+        //  Else if this is an assignment expression, don't add cpp2::move on the lhs
+        //  even if this is a definite last use (only do that when an rvalue is okay)
+        if (
+            !n.terms.empty()
+            && is_assignment_operator(n.terms.front().op->type())
+            )
+        {
+            suppress_move_from_last_use = true;
+        }
+        //  If it's "_ =" then emit static_cast<void>()
+        bool emit_discard = false;
+        if (
+            !n.terms.empty()
+            && n.terms.front().op->type() == lexeme::Assignment
+            && n.expr->get_postfix_expression_node()
+            && n.expr->get_postfix_expression_node()->get_first_token_ignoring_this()
+            && *n.expr->get_postfix_expression_node()->get_first_token_ignoring_this() == "_"
+            )
+        {
+            printer.print_cpp2( "static_cast<void>(", n.position() );
+            emit_discard = true;
+        }
+        else
+        {
             emit(*n.expr);
-            return;
         }
+        suppress_move_from_last_use = false;
 
-        //  Check to see if it's a capture expression that contains $,
-        //  and if we're not capturing the expression for the lambda
-        //  introducer replace it with the capture name
-        auto captured_part = std::string{};
+        //  Check that this isn't an illegal pointer operation
+        //      (initial partial implementation)
         if (
-            n.cap_grp
-            && !for_lambda_capture
+            !n.terms.empty()
+            && last_postfix_expr_was_pointer
             )
         {
-            //  First stringize ourselves so that we compare equal against
-            //  the first *cap_grp .str_suppressed_move that matches us (which is what the
-            //  lambda introducer generator used to create a lambda capture)
-            suppress_move_from_last_use = true;
-            auto my_sym = print_to_string(n, true);
-            suppress_move_from_last_use = false;
+            auto rhs_post = n.get_second_postfix_expression_node();
+            assert(
+                rhs_post
+                && rhs_post->expr
+            );
+            auto rhs_tok = rhs_post->expr->get_token();
+            if (
+                is_assignment_operator(n.terms.front().op->type())
+                && rhs_tok
+                && (
+                    *rhs_tok == "nullptr"
+                    || is_digit((rhs_tok->as_string_view())[0])
+                    )
+                )
+            {
+                errors.emplace_back(
+                    n.terms.front().op->position(),
+                    n.terms.front().op->to_string() + " - pointer assignment from null or integer is illegal"
+                );
+                violates_lifetime_safety = true;
+            }
+            else if (
+                *n.terms.front().op == "+"
+                || *n.terms.front().op == "+="
+                || *n.terms.front().op == "-"
+                || *n.terms.front().op == "-="
+                )
+            {
+                errors.emplace_back(
+                    n.terms.front().op->position(),
+                    n.terms.front().op->to_string() + " - pointer arithmetic is illegal - use std::span or gsl::span instead"
+                );
+                violates_bounds_safety = true;
+            }
+        }
 
-            auto found = std::find_if(n.cap_grp->members.cbegin(), n.cap_grp->members.cend(), [my_sym](auto& cap) {
-                return cap.str_suppressed_move == my_sym;
-            });
+        auto first = true;
+        for (auto const& x : n.terms) {
+            assert(x.op);
+            assert(x.expr);
+
+            //  Normally we'll just emit the operator, but if this is an
+            //  assignment that's a definite initialization, change it to
+            //  a .construct() call
+            if (
+                x.op->type() == lexeme::Assignment
+                && in_definite_init
+                )
+            {
+                printer.print_cpp2( ".construct(", n.position() );
+                emit(*x.expr);
+                printer.print_cpp2( ")", n.position() );
+            }
+            else
+            {
+                //  For the first operator only, if we are emitting a "_ =" discard
+                //  then we don't need the =
+                if (
+                    !emit_discard
+                    || !first
+                ) {
+                    printer.print_cpp2(" ", n.position());
+                    emit(*x.op);
+                    printer.print_cpp2(" ", n.position());
+                }
 
-            assert(
-                found != n.cap_grp->members.cend()
-                && "ICE: could not find this postfix-expression in capture group"
-            );
-            //  And then emit that capture symbol with number
-            assert (!found->cap_sym.empty());
-            captured_part += found->cap_sym;
+                //  When assigning a single expression-list, we can
+                //  take over direct control of emitting it without needing to
+                //  go through the whole grammar, and surround it with braces
+                if (
+                    x.op->type() == lexeme::Assignment
+                    && x.expr->is_expression_list()
+                    )
+                {
+                    printer.print_cpp2( "{ ", n.position() );
+                    emit(*x.expr->get_expression_list(), false);
+                    printer.print_cpp2( " }", n.position() );
+                }
+                //  Otherwise, just emit the general expression as usual
+                else {
+                    emit(*x.expr);
+                }
+            }
+
+            first = false;
+        }
+        // Finish emitting the "_ =" discard.
+        if (emit_discard) {
+            printer.print_cpp2( ")", n.position() );
         }
+    }
 
-        //  Otherwise, we're going to have to potentially do some work to change
-        //  some Cpp2 postfix operators to Cpp1 prefix operators, so let's set up...
-        auto prefix            = std::vector<text_with_pos>{};
-        auto suffix            = std::vector<text_with_pos>{};
 
-        auto last_was_prefixed = false;
-        auto saw_dollar        = false;
+    //-----------------------------------------------------------------------
+    //
+    auto emit(expression_node const& n)
+        -> void
+    {   STACKINSTR
+        assert(n.expr);
+        push_need_expression_list_parens(true);
+        emit(*n.expr);
+        pop_need_expression_list_parens();
+    }
 
-        struct text_chunks_with_parens_position {
-            std::vector<text_with_pos> text_chunks;
-            source_position            open_pos;
-            source_position            close_pos;
-        };
 
-        auto args = std::optional<text_chunks_with_parens_position>{};
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        expression_list_node const& n,
+        bool                        parens_ok = true
+    )
+        -> void
+    {   STACKINSTR
+        auto add_parens =
+            should_add_expression_list_parens()
+            && !n.inside_initializer
+            && parens_ok
+            ;
+        add_parens |=
+            n.is_fold_expression() &&
+            !(n.inside_initializer && current_declarations.back()->initializer->position() != n.open_paren->position())
+            ;
+        if (add_parens) {
+            printer.print_cpp2( *n.open_paren, n.position());
+        }
 
-        auto flush_args = [&] {
-            if (args) {
-                suffix.emplace_back(")", args.value().close_pos);
-                for (auto&& e: args.value().text_chunks) {
-                    suffix.push_back(e);
-                }
-                suffix.emplace_back("(", args.value().open_pos);
-                args.reset();
+        auto first = true;
+        for (auto const& x : n.expressions) {
+            if (!first) {
+                printer.print_cpp2(", ", n.position());
             }
-        };
-
-        auto print_to_text_chunks = [&](auto& i, auto... more) {
-            auto text = std::vector<text_with_pos>{};
-            printer.emit_to_text_chunks(&text);
-            push_need_expression_list_parens(false);
-            emit(i, more...);
-            pop_need_expression_list_parens();
-            printer.emit_to_text_chunks();
-            return text;
-        };
-
-        for (auto i = n.ops.rbegin(); i != n.ops.rend(); ++i)
-        {
-            assert(i->op);
+            first = false;
+            auto is_out = false;
 
-            //  If we already captured a part as a _## lambda capture,
-            //  skip the part of this expression before the $ symbol
-            //
-            if (!captured_part.empty()) {
-                if (i->op->type() == lexeme::Dollar) {
-                    break;
-                }
-            }
-            //  Else skip the part of this expression after the $ symbol
-            else if (for_lambda_capture) {
-                if (i->op->type() == lexeme::Dollar) {
-                    saw_dollar = true;
-                    continue;
+            if (x.pass != passing_style::in) {
+                assert(
+                    x.pass == passing_style::out
+                    || x.pass == passing_style::move
+                    || x.pass == passing_style::forward
+                );
+                if (x.pass == passing_style::out) {
+                    is_out = true;
+                    printer.print_cpp2("cpp2::impl::out(&", n.position());
                 }
-                if (!saw_dollar) {
-                    continue;
+                else if (x.pass == passing_style::move) {
+                    printer.print_cpp2("std::move(", n.position());
                 }
             }
 
-            //  Going backwards if we found LeftParen it might be UFCS
-            //  expr_list is emitted to 'args' for future use
-            if (i->op->type() == lexeme::LeftParen) {
-
-                assert(i->op);
-                assert(i->op_close);
-                auto local_args = text_chunks_with_parens_position{{}, i->op->position(), i->op_close->position()};
+            if (is_out) {
+                in_non_rvalue_context.push_back(true);
+            }
 
-                assert (i->expr_list);
-                if (!i->expr_list->expressions.empty()) {
-                    local_args.text_chunks = print_to_text_chunks(*i->expr_list);
-                }
+            assert(x.expr);
+            current_args.push_back( {x.pass} );
+            emit(*x.expr);
+            current_args.pop_back();
 
-                flush_args();
-                args.emplace(std::move(local_args));
+            if (is_out) {
+                in_non_rvalue_context.pop_back();
             }
-            //  Going backwards if we found Dot and there is args variable
-            //  it means that it should be handled by UFCS
-            else if(
-                i->op->type() == lexeme::Dot
-                && args
-                //  Disable UFCS if name lookup would hard-error (#550).
-                //  That happens when it finds that the function identifier being called is the name
-                //  of a variable with deduced type and we are in its initializer (e.g., x := y.x();)
-                //  So lower it to a member call instead, the only possible valid meaning.
-                && !lookup_finds_variable_with_placeholder_type_under_initialization(*i->id_expr)
+
+            if (
+                x.pass == passing_style::move
+                || x.pass == passing_style::out
                 )
             {
-                //  The function name is the argument to the macro
-                auto funcname = print_to_string(*i->id_expr);
-
-                //  First, build the UFCS macro name
-
-                auto ufcs_string = std::string("CPP2_UFCS");
-
-                //  If there are template arguments, use the _TEMPLATE version
-                if (std::ssize(i->id_expr->template_arguments()) > 0) {
-                    //  If it is qualified, use the _QUALIFIED version
-                    if (i->id_expr->is_qualified()) {
-                        ufcs_string += "_QUALIFIED";
-                        //  And split the unqualified id in the function name as two macro arguments
-                        auto& id = *get<id_expression_node::qualified>(i->id_expr->id);
-                        funcname =
-                            "("
-                            + print_to_string(id, false)
-                            + "::),"
-                            + print_to_string(*cpp2::impl::assert_not_null(id.ids.back().id), 0, true, true);
-                    }
-                    ufcs_string += "_TEMPLATE";
-                }
-
-                //  If we're in an object declaration (i.e., initializer)
-                //  at namespace scope, use the _NONLOCAL version
-                //
-                //  Note: If there are other cases where code could execute
-                //  in a non-local scope where a capture-default for the UFCS
-                //  lambda would not be allowed, then add them here
-                if (
-                    current_declarations.back()->is_namespace()
-                    || (
-                        current_declarations.back()->is_object()
-                        && current_declarations.back()->parent_is_namespace()
-                        )
-                    || (
-                        (
-                         current_declarations.back()->is_alias()
-                         || (
-                             current_declarations.back()->is_function()
-                             && current_declarations.back() == having_signature_emitted
-                             )
-                         )
-                        && (
-                            current_declarations.back()->parent_is_namespace()
-                            || current_declarations.back()->parent_is_type()
-                            )
-                        )
-                    )
-                {
-                    ufcs_string += "_NONLOCAL";
-                }
+                printer.print_cpp2(")", n.position());
+            }
+        }
 
-                //  If it's a last use, emit as part of the macro name
-                //
-                //  Note: This ensures a valid member call is still prioritized
-                //  by leveraging the last use only in the non-member branch
-                //  For example, `x.f()` won't emit as 'CPP2_UFCS(cpp2::move(f))(x)'
-                //  to never take the branch that wants to call `x.cpp2::move(f)()`
-                if (auto last_use = is_definite_last_use(i->id_expr->get_token());
-                    last_use
-                    && last_use->safe_to_move
-                    && !lookup_finds_type_scope_function(*i->id_expr)
-                    )
-                {
-                    if (last_use->is_forward) {
-                        ufcs_string += "_FORWARD";
-                    }
-                    else {
-                        ufcs_string += "_MOVE";
-                    }
+        if (add_parens) {
+            printer.print_cpp2( *n.close_paren, n.position());
+        }
+        //  We want to consume only one of these
+        consumed_expression_list_parens();
+    }
 
-                    in_non_rvalue_context.push_back(true);
-                    funcname = print_to_string(*i->id_expr);
-                    in_non_rvalue_context.pop_back();
-                }
 
-                //  Second, emit the UFCS argument list
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        expression_statement_node const& n,
+        bool                             can_have_semicolon,
+        source_position                  function_body_start = {},
+        bool                             function_void_ret   = false,
+        function_prolog const&           function_prolog     = {},
+        std::vector<std::string> const&  function_epilog     = {},
+        bool                             emitted             = false
+    )
+        -> void
+    {   STACKINSTR
+        assert(n.expr);
+        auto generating_return = false;
 
-                //  If the computed function name is an explicit member access
-                //  we don't need to go through the UFCS macro
-                //  Note: This also works around compiler bugs
-                if (funcname.starts_with("cpp2::move(*this).")) {
-                    prefix.emplace_back(funcname + "(", args.value().open_pos );
-                }
-                else {
-                    prefix.emplace_back(ufcs_string + "(" + funcname + ")(", args.value().open_pos );
-                }
-                suffix.emplace_back(")", args.value().close_pos );
-                if (!args.value().text_chunks.empty()) {
-                    for (auto&& e: args.value().text_chunks) {
-                        suffix.push_back(e);
-                    }
-                    suffix.emplace_back(", ", i->op->position());
-                }
-                args.reset();
+        if (function_body_start != source_position{}) {
+            emit_prolog_mem_inits(function_prolog, n.position().colno);
+            printer.print_cpp2(" { ", function_body_start);
+            emit_prolog_statements(function_prolog, n.position().colno);
+            if (!function_void_ret) {
+                printer.print_cpp2("return ", n.position());
+                generating_return = true;
             }
+        }
 
-            //  Handle the Cpp2 postfix operators that are prefix in Cpp1
-            //
-            else if (
-                i->op->type() == lexeme::MinusMinus
-                || i->op->type() == lexeme::PlusPlus
-                || i->op->type() == lexeme::Multiply
-                || i->op->type() == lexeme::Ampersand
-                || i->op->type() == lexeme::Tilde
+        if (!emitted) {
+            //  When generating 'return' of a single expression-list, we can
+            //  take over direct control of emitting it without needing to
+            //  go through the whole grammar, and surround it with braces
+            if (
+                generating_return
+                && n.expr->is_expression_list()
+                && !n.expr->get_expression_list()->is_fold_expression()
                 )
             {
-                // omit some needless parens
-                if (
-                    !last_was_prefixed
-                    && i != n.ops.rbegin()
-                    )
-                {
-                    prefix.emplace_back( "(", i->op->position() );
-                }
-                prefix.emplace_back( i->op->to_string(), i->op->position());
+                auto is_deduced_return =
+                    !function_returns.empty()
+                    && function_returns.back().is_deduced;
 
-                //  Enable null dereference checks
-                if (
-                    flag_safe_null_pointers
-                    && i->op->type() == lexeme::Multiply
-                    )
-                {
-                    prefix.emplace_back( "cpp2::impl::assert_not_null(", i->op->position() );
-                }
-                if (
-                    flag_safe_null_pointers
-                    && i->op->type() == lexeme::Multiply
-                    )
-                {
-                    suffix.emplace_back( ")", i->op->position() );
+                if (!is_deduced_return) {
+                    printer.print_cpp2( "{ ", n.position() );
                 }
-
-                // omit some needless parens
-                if (
-                    !last_was_prefixed
-                    && i != n.ops.rbegin()
-                    )
-                {
-                    suffix.emplace_back( ")", i->op->position() );
+                emit(*n.expr->get_expression_list(), false);
+                if (!is_deduced_return) {
+                    printer.print_cpp2( " }", n.position() );
                 }
-                last_was_prefixed = true;
             }
-
-            //  Handle the other Cpp2 postfix operators that stay postfix in Cpp1 (currently: '...')
-            else if (is_postfix_operator(i->op->type())) {
-                flush_args();
-                suffix.emplace_back( i->op->to_string(), i->op->position());
+            //  Otherwise, just emit the general expression as usual
+            else {
+                emit(*n.expr);
+            }
+            if (can_have_semicolon) {
+                printer.print_cpp2(";", n.position());
             }
+        }
 
-            //  Handle the suffix operators that remain suffix
-            //
-            else {
-                flush_args();
+        if (function_body_start != source_position{}) {
+            emit_epilog_statements( function_epilog, n.position().colno);
+            printer.print_cpp2(" }", n.position());
+        }
+    }
 
-                assert(i->op);
-                last_was_prefixed = false;
 
-                //  Enable subscript bounds checks
-                if (
-                    flag_safe_subscripts
-                    && i->op->type() == lexeme::LeftBracket
-                    && std::ssize(i->expr_list->expressions) == 1
-                    )
-                {
-                    suffix.emplace_back( ")", i->op->position() );
-                }
-                else if (i->op_close) {
-                    suffix.emplace_back( i->op_close->to_string(), i->op_close->position() );
-                }
+    // Consider moving these `stack` functions to `common.h` to enable more general use.
 
-                if (i->id_expr)
-                {
-                    if (args) {
-                        //  If args are stored it means that this is function or method
-                        //  that is not handled by UFCS and args need to be printed
-                        suffix.emplace_back(")", args.value().close_pos);
-                        for (auto&& e: args.value().text_chunks) {
-                            suffix.push_back(e);
-                        }
-                        suffix.emplace_back("(", args.value().open_pos);
-                        args.reset();
-                    }
+    template<typename T>
+    auto stack_value(
+        T& var,
+        std::type_identity_t<T> const& value
+    )
+        -> auto
+    {
+        return finally([&var, old = std::exchange(var, value)]() {
+            var = old;
+        });
+    }
 
-                    auto print = print_to_string(*i->id_expr, false /*not a local name*/, i->op->type() == lexeme::Dot);
-                    suffix.emplace_back( print, i->id_expr->position() );
-                }
+    template<typename T>
+    auto stack_element(
+        std::vector<T>& cont,
+        std::type_identity_t<T> const& value
+    )
+        -> auto
+    {
+        cont.push_back(value);
+        return finally([&]{ cont.pop_back(); });
+    }
 
-                if (i->expr_list) {
-                    auto text = print_to_text_chunks(*i->expr_list);
-                    for (auto&& e: text) {
-                        suffix.push_back(e);
-                    }
-                }
+    template<typename T>
+    auto stack_size(std::vector<T>& cont)
+        -> auto
+    {
+        return finally([&, size = cont.size()]{ cont.resize(size); });
+    }
 
-                //  Enable subscript bounds checks
-                if (
-                    flag_safe_subscripts
-                    && i->op->type() == lexeme::LeftBracket
-                    && std::ssize(i->expr_list->expressions) == 1
-                    )
-                {
-                    if (auto lit = i->expr_list->expressions.front().expr->get_literal();
-                        lit
-                        && lit->literal->type() == lexeme::DecimalLiteral
-                        )
-                    {
-                        prefix.emplace_back( "CPP2_ASSERT_IN_BOUNDS_LITERAL(", i->op->position() );
-                    }
-                    else
-                    {
-                        prefix.emplace_back( "CPP2_ASSERT_IN_BOUNDS(", i->op->position() );
-                    }
-                    suffix.emplace_back( ", ", i->op->position() );
-                }
-                else {
-                    suffix.emplace_back( i->op->to_string(), i->op->position() );
-                }
-            }
+    template<typename T>
+    auto stack_size_if(
+        std::vector<T>& cont,
+        bool cond
+    )
+        -> std::optional<decltype(stack_size(cont))>
+    {
+        if (cond) {
+            return stack_size(cont);
+        }
+        return {};
+    }
+
+    //-----------------------------------------------------------------------
+    //
+    auto emit(
+        statement_node const&           n,
+        bool                            can_have_semicolon  = true,
+        source_position                 function_body_start = {},
+        bool                            function_void_ret   = false,
+        function_prolog const&          function_prolog     = {},
+        std::vector<std::string> const& function_epilog     = {}
+    )
+        -> void
+    {   STACKINSTR
+        if (!sema.check(n, errors)) {
+            return;
         }
 
-        //  Print the prefixes (in forward order)
-        for (auto& e : prefix) {
-            printer.print_cpp2(e.text, n.position());
+        auto emit_parameters =
+            !n.emitted
+            && n.parameters
+            ;
+
+        auto guard = stack_size_if(current_names, emit_parameters);
+        if (emit_parameters) {
+            printer.print_extra( "\n");
+            printer.print_extra( "{");
+            for (auto& param : n.parameters->parameters) {
+                printer.print_extra( "\n");
+                printer.print_extra( print_to_string(*param, false, false, true) );
+            }
         }
 
-        //  If this is an --, ++, or &, don't add cpp2::move on the lhs
-        //  even if this is a definite last use (only do that when an rvalue is okay)
-        if (
-            n.ops.front().op->type() == lexeme::MinusMinus
-            || n.ops.front().op->type() == lexeme::PlusPlus
-            || n.ops.front().op->type() == lexeme::Ampersand
-            )
-        {
-            suppress_move_from_last_use = true;
+        //  Do expression statement case first... it's the most complex
+        //  because it's used for single-statement function bodies
+        try_emit<statement_node::expression >(
+            n.statement,
+            can_have_semicolon,
+            function_body_start,
+            function_void_ret,
+            function_prolog,
+            function_epilog,
+            n.emitted
+        );
+
+        //  Otherwise, skip this one if it was already handled earlier (i.e., a constructor member init)
+        if (n.emitted) {
+            return;
         }
 
-        //  Now print the core expression -- or the captured_part in its place
-        if (captured_part.empty()) {
-            emit(*n.expr);
-        }
-        else {
-            printer.print_cpp2(captured_part, n.position());
-        }
-        suppress_move_from_last_use = false;
+        printer.disable_indent_heuristic_for_next_text();
+
+        try_emit<statement_node::compound   >(n.statement, function_prolog, function_epilog);
+
+        //  NOTE: Reset preemption here because
+        //  - for compound statements written as "= { ... }", we want to keep the
+        //    preempted position which moves the { to where the = was
+        //  - but for other statement types, we want to get rid of any leftover
+        //    preemption (ideally there wouldn't be any, but sometimes there is
+        //    and it should not apply to what we're about to emit)
+        printer.preempt_position_push({});
+        //  This only has a whitespace effect in the generated Cpp1 code, but it's
+        //  aesthetic and aesthetics are important in this case -- we want to keep
+        //  the original source's personal whitespace formatting style as much as we can
+
+        try_emit<statement_node::selection  >(n.statement);
+        try_emit<statement_node::declaration>(n.statement);
+        try_emit<statement_node::return_    >(n.statement);
+        try_emit<statement_node::iteration  >(n.statement);
+        try_emit<statement_node::using_     >(n.statement);
+        try_emit<statement_node::contract   >(n.statement);
+        try_emit<statement_node::inspect    >(n.statement, false);
+        try_emit<statement_node::jump       >(n.statement);
 
-        flush_args();
+        printer.preempt_position_pop();
 
-        //  Print the suffixes (in reverse order)
-        while (!suffix.empty()) {
-            printer.print_cpp2(suffix.back().text, suffix.back().pos);
-            suffix.pop_back();
+        if (emit_parameters) {
+            printer.print_extra( "\n");
+            printer.print_extra( "}");
         }
     }
 
 
     //-----------------------------------------------------------------------
+    //  Within a type scope implementation, disallow declaring a name that
+    //  is the same as (i.e., shadows) a type scope name... this is a
+    //  convenient place to check because we have the decls stack
     //
-    auto emit(prefix_expression_node const& n)
-        -> void
-    {   STACKINSTR
-        auto suffix = std::string{};
-        for (auto const& x : n.ops) {
-            assert(x);
-            if (x->type() == lexeme::Not) {
-                printer.print_cpp2("!(", n.position());
-                printer.add_pad_in_this_line(-3);
-                suffix += ")";
-            }
-            else {
-                printer.print_cpp2(*x, x->position());
-            }
+    auto check_shadowing_of_type_scope_names(
+        declaration_node const& decl
+    )
+        -> bool
+    {
+        if (
+            decl.has_name()                 // this is a named declaration
+            && !decl.has_name("this")       // that's not 'this'
+            && !decl.parent_is_type()       // and the type isn't the direct parent
+            && is_name_declared_in_current_type_scope(*decl.name())
+            )                               // and it shadows a name
+        {
+            errors.emplace_back(
+                decl.position(),
+                "a type's implementation may not declare a name that is the same as (i.e., shadows) a type scope name - for example, a type scope function's local variable may not have the same as one of the type's members"
+            );
+            return false;
         }
-        assert(n.expr);
-        push_need_expression_list_parens(true);
-        emit(*n.expr);
-        pop_need_expression_list_parens();
-        printer.print_cpp2(suffix, n.position());
+
+        return true;
     }
 
 
     //-----------------------------------------------------------------------
     //
-    auto emit(is_as_expression_node const& n)
+    auto emit(
+        parameter_declaration_node const& n,
+        bool                              is_returns            = false,
+        bool                              is_template_parameter = false,
+        bool                              is_statement          = false
+    )
         -> void
     {   STACKINSTR
-        std::string prefix = {};
-        std::string suffix = {};
+        if (!sema.check(n, errors)) {
+            return;
+        }
 
-        auto wildcard_found = false;
-        bool as_on_literal  = false;
+        //  Can't declare functions as parameters -- only pointers to functions which are objects
+        assert( n.declaration );
+        assert( !n.declaration->is_function() );
 
-        assert(
-            n.expr
-            && n.expr->get_postfix_expression_node()
-            && n.expr->get_postfix_expression_node()->expr
-        );
-        {
-            auto& p = n.expr->get_postfix_expression_node()->expr;
-            if (auto t = p->get_token();
-                t
-                && is_literal(t->type())
-                && t->type() != lexeme::StringLiteral
-                && t->type() != lexeme::FloatLiteral
-                && !std::get<primary_expression_node::literal>(p->expr)->user_defined_suffix
-                && std::ssize(n.ops) > 0
-                && *n.ops[0].op == "as"
-                )
-            {
-                as_on_literal = true;
-            }
+        if (!check_shadowing_of_type_scope_names(*n.declaration)) {
+            return;
         }
 
-        for (
-            auto i = n.ops.rbegin();
-            i != n.ops.rend();
-            ++i
-            )
+        assert( n.declaration->identifier );
+        auto identifier     = print_to_string( *n.declaration->identifier );
+        auto identifier_pos = n.position();
+
+        if (n.mod == parameter_declaration_node::modifier::implicit)
         {
-            //  If it's "ISORAS type", emit "cpp2::impl::ISORAS<type>(expr)"
-            if (i->type)
-            {
-                if (i->type->is_wildcard()) {
-                    wildcard_found = true;
-                    if (*i->op != "is") {
-                        errors.emplace_back(
-                            n.position(),
-                            "'as _' wildcard is not allowed, specify a concrete target type instead"
-                        );
-                    }
-                    else if (std::ssize(n.ops) > 1) {
-                        errors.emplace_back(
-                            n.position(),
-                            "an 'is _' wildcard may only be used on its own, not in a chain with other 'is'/'as' in the same subexpression"
-                        );
-                    }
-                }
-                else {
-                    auto op_name = i->op->to_string();
-                    if (op_name == "as") {
-                        op_name = "as_";    // use the static_assert-checked 'as' by default...
-                    }                       // we'll override this inside inspect-expressions
-                    prefix += "cpp2::impl::" + op_name + "<" + print_to_string(*i->type) + ">(";
-                    suffix = ")" + suffix;
-                }
-            }
-            //  Else it's "is value", emit "cpp2::impl::is(expr, value)"
-            else
+            assert(!current_functions.empty());
+            if (
+                n.pass != passing_style::out
+                || !current_functions.back().decl->has_name("operator=")
+                )
             {
-                assert(i->expr);
-                prefix += "cpp2::impl::" + i->op->to_string() + "(";
-                suffix = ", " + print_to_string(*i->expr) + ")" + suffix;
+                errors.emplace_back(
+                    n.position(),
+                    "only an 'out this' parameter of an 'operator=' function may be declared implicit"
+                );
             }
         }
 
-        if (as_on_literal) {
-            auto last_pos = prefix.rfind('>'); assert(last_pos != prefix.npos);
-            prefix.insert(last_pos, ", " + print_to_string(*n.expr));
-        }
-
-        printer.print_cpp2(prefix, n.position());
-        if (wildcard_found) {
-            printer.print_cpp2("true", n.position());
-        }
-        else if(!as_on_literal) {
-            emit(*n.expr);
-        }
-        printer.print_cpp2(suffix, n.position());
-    }
-
+        current_names.push_back(&*n.declaration);
 
-    //-----------------------------------------------------------------------
-    //
-    template<
-        String   Name,
-        typename Term
-    >
-    auto emit(binary_expression_node<Name,Term> const& n)
-        -> void
-    {   STACKINSTR
-        assert(n.expr);
-        assert(
-            n.terms.empty()
-            || n.terms.front().op
-        );
+        //-----------------------------------------------------------------------
+        //  Skip 'this' parameters
 
-        //  If this is relational comparison
-        if (
-            !n.terms.empty()
-            && (
-                n.terms.front().op->type() == lexeme::Less
-                || n.terms.front().op->type() == lexeme::LessEq
-                || n.terms.front().op->type() == lexeme::Greater
-                || n.terms.front().op->type() == lexeme::GreaterEq
-                || n.terms.front().op->type() == lexeme::EqualComparison
-                || n.terms.front().op->type() == lexeme::NotEqualComparison
-                )
-            )
+        if (n.declaration->has_name("this"))
         {
-            auto const& op = *n.terms.front().op;
-
-            //  If this is one (non-chained) comparison, just emit it directly
-            if (std::ssize(n.terms) < 2)
-            {
-                assert (std::ssize(n.terms) == 1);
+            //  Since we're skipping "out this," plus possibly "implicit " and
+            //  whitespace, any following parameters on the same line can shift left
+            printer.add_pad_in_this_line(-18);
 
-                //  emit < <= >= > as cmp_*(a,b) calls (if selected)
-                if (flag_safe_comparisons) {
-                    switch (op.type()) {
-                    break;case lexeme::Less:
-                        printer.print_cpp2( "cpp2::impl::cmp_less(", n.position());
-                    break;case lexeme::LessEq:
-                        printer.print_cpp2( "cpp2::impl::cmp_less_eq(", n.position());
-                    break;case lexeme::Greater:
-                        printer.print_cpp2( "cpp2::impl::cmp_greater(", n.position());
-                    break;case lexeme::GreaterEq:
-                        printer.print_cpp2( "cpp2::impl::cmp_greater_eq(", n.position());
-                    break;default:
-                        ;
-                    }
-                }
+            return;
+        }
 
-                emit(*n.expr);
+        //-----------------------------------------------------------------------
+        //  Handle 'that' parameters
 
-                //  emit == and != as infix a ? b operators (since we don't have
-                //  any checking/instrumentation we want to do for those)
-                if (flag_safe_comparisons) {
-                    switch (op.type()) {
-                    break;case lexeme::EqualComparison:
-                          case lexeme::NotEqualComparison:
-                        printer.print_cpp2( " ", n.position() );
-                        emit(op);
-                        printer.print_cpp2( " ", n.position() );
-                    break;default:
-                        printer.print_cpp2( ",", n.position() );
-                    }
-                }
-                else {
-                    emit(op);
-                }
+        if (n.declaration->has_name("that"))
+        {
+            emitting_that_function = true;
+            assert(
+                n.pass == passing_style::in
+                || n.pass == passing_style::move
+            );
+            auto pass = std::string{" const&"};
+            if (
+                n.pass == passing_style::move
+                || emitting_move_that_function
+                )
+            {
+                pass = "&&";
+            }
 
-                emit(*n.terms.front().expr);
+            auto func_name = get_enclosing_function_name();
+            assert(func_name);
 
-                if (flag_safe_comparisons) {
-                    switch (op.type()) {
-                    break;case lexeme::Less:
-                          case lexeme::LessEq:
-                          case lexeme::Greater:
-                          case lexeme::GreaterEq:
-                        printer.print_cpp2( ")", n.position() );
-                    break;default:
-                        ;
-                    }
-                }
+            auto type_name = get_enclosing_type_name();
+            assert(type_name);
 
-                return;
+            //  If we're in an empty type that has no member object, mark 'that' as
+            //  [[maybe_unused]] to silence Cpp1 compiler warnings
+            assert(!current_functions.empty());
+            auto maybe_unused = std::string{};
+            if (current_functions.back().decl->get_parent()->get_type_scope_declarations(declaration_node::objects).empty()) {
+                maybe_unused = "[[maybe_unused]] ";
             }
 
-            //  Else if this is a chained comparison, emit it as a lambda,
-            //  to get single evaluation via the lambda capture
-            else
-            {
-                //  To check for the valid chains: all </<=, all >/>=, or all ==
-                auto found_lt = 0;  // < and <=
-                auto found_gt = 0;  // > and >=
-                auto found_eq = 0;  // ==
-                auto count    = 0;
+            printer.print_cpp2(
+                maybe_unused + print_to_string( *type_name ) + pass + " that",
+                n.position()
+            );
+            return;
+        }
 
-                auto const* lhs = n.expr.get();
-                auto lhs_name = "_" + std::to_string(count);
+        //-----------------------------------------------------------------------
+        //  Handle type parameters
 
-                auto lambda_capture = lhs_name + " = " + print_to_string(*lhs);
-                auto lambda_body    = std::string{};
+        // Common template naming
+        auto emit_template_name = [&]() {
+            if (n.declaration->is_variadic) {
+                printer.print_cpp2(
+                    "...",
+                    identifier_pos
+                );
+            }
 
-                for (auto const& term : n.terms)
-                {
-                    assert(
-                        term.op
-                        && term.expr
-                    );
-                    ++count;
-                    auto rhs_name = "_" + std::to_string(count);
+            if (identifier == "_") {
+                printer.print_cpp2( unnamed_type_param_name(n.ordinal, position_label(n.declaration->identifier->get_token())),
+                                    identifier_pos );
+            }
+            else {
+                printer.print_cpp2( identifier, identifier_pos );
+            }
+        };
+        if (n.declaration->is_type()) {
+            assert( is_template_parameter );
+            printer.print_cpp2("typename ", identifier_pos);
 
-                    //  Not the first expression? Insert a "&&"
-                    if (found_lt + found_gt + found_eq > 0) {
-                        lambda_body += " && ";
-                    }
+            emit_template_name();
+            return;
+        }
 
-                    //  Remember what we've seen
-                    switch (term.op->type()) {
-                    break;case lexeme::Less:
-                          case lexeme::LessEq:
-                        found_lt = 1;
-                    break;case lexeme::Greater:
-                          case lexeme::GreaterEq:
-                        found_gt = 1;
-                    break;case lexeme::EqualComparison:
-                        found_eq = 1;
-                    break;default:
-                        ;
-                    }
+        //-----------------------------------------------------------------------
+        //  Else handle template non-type parameters
 
-                    //  emit < <= >= > as cmp_*(a,b) calls (if selected)
-                    if (flag_safe_comparisons) {
-                        switch (term.op->type()) {
-                        break;case lexeme::Less:
-                            lambda_body += "cpp2::impl::cmp_less(";
-                        break;case lexeme::LessEq:
-                            lambda_body += "cpp2::impl::cmp_less_eq(";
-                        break;case lexeme::Greater:
-                            lambda_body += "cpp2::impl::cmp_greater(";
-                        break;case lexeme::GreaterEq:
-                            lambda_body += "cpp2::impl::cmp_greater_eq(";
-                        break;default:
-                            ;
-                        }
-                    }
+        assert( n.declaration->is_object() );
+        auto const& type_id = *std::get<declaration_node::an_object>(n.declaration->type);
 
-                    auto rhs_expr = print_to_string(*term.expr);
+        if (is_template_parameter) {
+            emit( type_id );
+            printer.print_cpp2(" ", type_id.position());
 
-                    lambda_body += lhs_name;
+            emit_template_name();
+            return;
+        }
 
-                    //  emit == and != as infix a ? b operators (since we don't have
-                    //  any checking/instrumentation we want to do for those)
-                    if (flag_safe_comparisons) {
-                        switch (term.op->type()) {
-                        break;case lexeme::EqualComparison:
-                            lambda_body += *term.op;
-                        break;case lexeme::NotEqualComparison:
-                            errors.emplace_back(
-                                n.position(),
-                                "!= comparisons cannot appear in a comparison chain (see https://wg21.link/p0893)"
-                            );
-                            return;
-                        break;default:
-                            lambda_body += ",";
-                        }
-                    }
-                    else {
-                        lambda_body += *term.op;
-                    }
+        //-----------------------------------------------------------------------
+        //  Else handle ordinary parameters
 
-                    lambda_capture += ", " + rhs_name + " = " + rhs_expr;
-                    lambda_body    += rhs_name;
+        auto param_type = print_to_string(type_id);
 
-                    lhs = term.expr.get();
-                    lhs_name = rhs_name;
+        //  With -string-view-params, an 'in std::string' parameter that is only
+        //  used as a view becomes a std::string_view (see string_view_param_finder)
+        if (
+            !is_returns
+            && std::find(view_params.begin(), view_params.end(), &n) != view_params.end()
+            )
+        {
+            param_type = "std::string_view";
+        }
 
-                    if (flag_safe_comparisons) {
-                        switch (term.op->type()) {
-                        break;case lexeme::Less:
-                                case lexeme::LessEq:
-                                case lexeme::Greater:
-                                case lexeme::GreaterEq:
-                            lambda_body += ")";
-                        break;default:
-                            ;
-                        }
+        //  If there are template parameters on this function or its enclosing
+        //  type, see if this parameter's name is an unqualified-id with a
+        //  template parameter name, or mentions a template parameter as a
+        //  template argument
+        auto has_template_parameter_type_named = [](
+            declaration_node const& decl,
+            std::string_view        name
+            )
+            -> bool
+        {
+            if (decl.template_parameters) {
+                for (auto& tparam : decl.template_parameters->parameters)
+                {
+                    assert(
+                        tparam
+                        && tparam->name()
+                    );
+                    //  For now just do a quick string match
+                    auto tparam_name = tparam->name()->to_string();
+                    if (
+                        tparam->declaration->is_type()
+                        && (
+                            name == tparam_name
+                            || name.find("<"+tparam_name) != std::string_view::npos
+                            || name.find(","+tparam_name) != std::string_view::npos
+                        )
+                        )
+                    {
+                        return true;
                     }
                 }
+            }
+            return false;
+        };
 
-                assert(found_lt + found_gt + found_eq > 0);
-                if (found_lt + found_gt + found_eq != 1) {
-                    errors.emplace_back(
-                        n.position(),
-                        "a comparison chain must be all < and <=, all > and >=, or all == (see https://wg21.link/p0893)"
-                    );
-                    return;
-                }
+        assert( current_declarations.back() );
+        auto is_dependent_parameter_type =
+            has_template_parameter_type_named( *current_declarations.back(), param_type )
+            || (
+                current_declarations.back()->parent_is_type()
+                && current_declarations.back()->has_name("operator=")
+                && has_template_parameter_type_named( *current_declarations.back()->get_parent(), param_type)
+                )
+            ;
 
-                printer.print_cpp2( "[" + lambda_capture + "]{ return " + lambda_body + "; }()", n.position());
+        //  First any prefix
 
-                return;
-            }
+        if (identifier == "_") {
+            printer.print_cpp2( "[[maybe_unused]] ", identifier_pos );
+            identifier = "unnamed_param_" + std::to_string(n.ordinal);
         }
 
-        //  Else if this is an assignment expression, don't add cpp2::move on the lhs
-        //  even if this is a definite last use (only do that when an rvalue is okay)
         if (
-            !n.terms.empty()
-            && is_assignment_operator(n.terms.front().op->type())
+            !is_returns
+            && !n.declaration->is_variadic
+            && !type_id.is_wildcard()
+            && !is_dependent_parameter_type
+            && !type_id.is_pointer_qualified()
             )
         {
-            suppress_move_from_last_use = true;
+            switch (n.pass) {
+            break;case passing_style::in     : printer.print_cpp2( "cpp2::impl::in<",  n.position() );
+            break;case passing_style::out    : printer.print_cpp2( "cpp2::impl::out<", n.position() );
+            break;default: ;
+            }
         }
-        //  If it's "_ =" then emit static_cast<void>()
-        bool emit_discard = false;
+
+        printer.preempt_position_push( n.position() );
+
         if (
-            !n.terms.empty()
-            && n.terms.front().op->type() == lexeme::Assignment
-            && n.expr->get_postfix_expression_node()
-            && n.expr->get_postfix_expression_node()->get_first_token_ignoring_this()
-            && *n.expr->get_postfix_expression_node()->get_first_token_ignoring_this() == "_"
+            type_id.is_pointer_qualified()
+            && n.pass == passing_style::in
             )
         {
-            printer.print_cpp2( "static_cast<void>(", n.position() );
-            emit_discard = true;
-        }
-        else
-        {
-            emit(*n.expr);
-        }
-        suppress_move_from_last_use = false;
-
-        //  Check that this isn't an illegal pointer operation
-        //      (initial partial implementation)
-        if (
-            !n.terms.empty()
-            && last_postfix_expr_was_pointer
+            printer.print_cpp2( param_type, n.position() );
+        }
+        else if (
+            type_id.is_wildcard()
+            || is_dependent_parameter_type
+            || n.declaration->is_variadic
             )
         {
-            auto rhs_post = n.get_second_postfix_expression_node();
-            assert(
-                rhs_post
-                && rhs_post->expr
-            );
-            auto rhs_tok = rhs_post->expr->get_token();
-            if (
-                is_assignment_operator(n.terms.front().op->type())
-                && rhs_tok
-                && (
-                    *rhs_tok == "nullptr"
-                    || is_digit((rhs_tok->as_string_view())[0])
-                    )
-                )
-            {
-                errors.emplace_back(
-                    n.terms.front().op->position(),
-                    n.terms.front().op->to_string() + " - pointer assignment from null or integer is illegal"
-                );
-                violates_lifetime_safety = true;
+            auto name = std::string{"auto"};
+            if (is_dependent_parameter_type) {
+                name = param_type;
             }
             else if (
-                *n.terms.front().op == "+"
-                || *n.terms.front().op == "+="
-                || *n.terms.front().op == "-"
-                || *n.terms.front().op == "-="
+                n.declaration->is_variadic
+                && !type_id.is_wildcard()
                 )
             {
-                errors.emplace_back(
-                    n.terms.front().op->position(),
-                    n.terms.front().op->to_string() + " - pointer arithmetic is illegal - use std::span or gsl::span instead"
-                );
-                violates_bounds_safety = true;
+                auto name = n.declaration->identifier->get_token();
+                assert(name);
+                auto req = std::string{"(std::is_convertible_v<CPP2_TYPEOF("};
+                req += *name;
+                req += "), ";
+                req += param_type;
+                req += "> && ...)";
+                function_requires_conditions.push_back(req);
             }
-        }
 
-        auto first = true;
-        for (auto const& x : n.terms) {
-            assert(x.op);
-            assert(x.expr);
+            switch (n.pass) {
+            break;case passing_style::in     : printer.print_cpp2( n.position(), name, " const&" );
+            break;case passing_style::copy   : printer.print_cpp2( name,           n.position() );
+            break;case passing_style::inout  : printer.print_cpp2( n.position(), name, "&" );
 
-            //  Normally we'll just emit the operator, but if this is an
-            //  assignment that's a definite initialization, change it to
-            //  a .construct() call
-            if (
-                x.op->type() == lexeme::Assignment
-                && in_definite_init
-                )
-            {
-                printer.print_cpp2( ".construct(", n.position() );
-                emit(*x.expr);
-                printer.print_cpp2( ")", n.position() );
-            }
-            else
-            {
-                //  For the first operator only, if we are emitting a "_ =" discard
-                //  then we don't need the =
-                if (
-                    !emit_discard
-                    || !first
-                ) {
-                    printer.print_cpp2(" ", n.position());
-                    emit(*x.op);
-                    printer.print_cpp2(" ", n.position());
-                }
+            //  For generic out parameters, we take a pointer to anything with paramater named "identifier_"
+            //  and then generate the out<> as a stack local with the expected name "identifier"
+            break;case passing_style::out    : printer.print_cpp2( name,           n.position() );
+                                               current_functions.back().prolog.statements.push_back(
+                                                   "auto " + identifier + " = cpp2::impl::out(" + identifier + "_); "
+                                               );
+                                               identifier += "_";
 
-                //  When assigning a single expression-list, we can
-                //  take over direct control of emitting it without needing to
-                //  go through the whole grammar, and surround it with braces
-                if (
-                    x.op->type() == lexeme::Assignment
-                    && x.expr->is_expression_list()
-                    )
-                {
-                    printer.print_cpp2( "{ ", n.position() );
-                    emit(*x.expr->get_expression_list(), false);
-                    printer.print_cpp2( " }", n.position() );
-                }
-                //  Otherwise, just emit the general expression as usual
-                else {
-                    emit(*x.expr);
-                }
+            break;case passing_style::move   : printer.print_cpp2( n.position(), name, "&&" );
+            break;case passing_style::forward: printer.print_cpp2( n.position(), name, "&&" );
+            break;default: ;
             }
+        }
+        else if (n.pass == passing_style::forward) {
+            printer.print_cpp2("auto", n.position());
 
-            first = false;
+            auto name = n.declaration->identifier->get_token();
+            assert(name);
+            auto req = std::string{"std::is_same_v<"};
+            req += param_type;
+            req += ", CPP2_TYPEOF(";
+            req += *name;
+            req += ")>";
+            function_requires_conditions.push_back(req);
         }
-        // Finish emitting the "_ =" discard.
-        if (emit_discard) {
-            printer.print_cpp2( ")", n.position() );
+        else {
+            if (is_returns) {
+                printer.print_extra( param_type );
+            }
+            else {
+                printer.print_cpp2( param_type, type_id.position() );
+            }
         }
-    }
 
+        printer.preempt_position_pop();
 
-    //-----------------------------------------------------------------------
-    //
-    auto emit(expression_node const& n)
-        -> void
-    {   STACKINSTR
-        assert(n.expr);
-        push_need_expression_list_parens(true);
-        emit(*n.expr);
-        pop_need_expression_list_parens();
-    }
-
+        //  Then any suffix
 
-    //-----------------------------------------------------------------------
-    //
-    auto emit(
-        expression_list_node const& n,
-        bool                        parens_ok = true
-    )
-        -> void
-    {   STACKINSTR
-        auto add_parens =
-            should_add_expression_list_parens()
-            && !n.inside_initializer
-            && parens_ok
-            ;
-        add_parens |=
-            n.is_fold_expression() &&
-            !(n.inside_initializer && current_declarations.back()->initializer->position() != n.open_paren->position())
-            ;
-        if (add_parens) {
-            printer.print_cpp2( *n.open_paren, n.position());
+        if (
+            !is_returns
+            && !type_id.is_wildcard()
+            && !is_dependent_parameter_type
+            && !type_id.is_pointer_qualified()
+            && !n.declaration->is_variadic
+            )
+        {
+            switch (n.pass) {
+            break;case passing_style::in     : printer.print_cpp2( ">",  n.position() );
+            break;case passing_style::copy   : printer.print_cpp2( "",   n.position() );
+            break;case passing_style::inout  : printer.print_cpp2( "&",  n.position() );
+            break;case passing_style::out    : printer.print_cpp2( ">",  n.position() );
+            break;case passing_style::move   : printer.print_cpp2( "&&", n.position() );
+            break;case passing_style::forward: printer.print_cpp2( "&&", n.position() );
+            break;default: ;
+            }
         }
 
-        auto first = true;
-        for (auto const& x : n.expressions) {
-            if (!first) {
-                printer.print_cpp2(", ", n.position());
-            }
-            first = false;
-            auto is_out = false;
+        if (is_returns) {
+            printer.print_extra( " " + identifier );
+        }
+        else {
+            printer.print_cpp2( " ", identifier_pos );
+            if (n.declaration->is_variadic)
+            {
+                if (n.direction() == passing_style::out) {
+                    errors.emplace_back(
+                        n.declaration->position(),
+                        "a variadic parameter cannot be 'out'"
+                    );
+                    return;
+                }
 
-            if (x.pass != passing_style::in) {
-                assert(
-                    x.pass == passing_style::out
-                    || x.pass == passing_style::move
-                    || x.pass == passing_style::forward
+                printer.print_cpp2(
+                    "...",
+                    identifier_pos
                 );
-                if (x.pass == passing_style::out) {
-                    is_out = true;
-                    printer.print_cpp2("cpp2::impl::out(&", n.position());
-                }
-                else if (x.pass == passing_style::move) {
-                    printer.print_cpp2("std::move(", n.position());
-                }
             }
+            printer.print_cpp2( identifier, identifier_pos );
+        }
 
-            if (is_out) {
-                in_non_rvalue_context.push_back(true);
+        if (
+            !is_returns
+            && n.declaration->initializer
+            )
+        {
+            auto guard = stack_element(current_declarations, &*n.declaration);
+            if (is_statement) {
+                printer.print_cpp2( "{", n.declaration->initializer->position() );
             }
-
-            assert(x.expr);
-            current_args.push_back( {x.pass} );
-            emit(*x.expr);
-            current_args.pop_back();
-
-            if (is_out) {
-                in_non_rvalue_context.pop_back();
+            else {
+                printer.print_cpp2( " = ", n.declaration->initializer->position() );
             }
-
-            if (
-                x.pass == passing_style::move
-                || x.pass == passing_style::out
-                )
-            {
-                printer.print_cpp2(")", n.position());
+            emit(*n.declaration->initializer, !is_statement);
+            if (is_statement) {
+                printer.print_cpp2( "};", n.declaration->initializer->position() );
             }
         }
-
-        if (add_parens) {
-            printer.print_cpp2( *n.close_paren, n.position());
-        }
-        //  We want to consume only one of these
-        consumed_expression_list_parens();
     }
 
 
     //-----------------------------------------------------------------------
     //
     auto emit(
-        expression_statement_node const& n,
-        bool                             can_have_semicolon,
-        source_position                  function_body_start = {},
-        bool                             function_void_ret   = false,
-        function_prolog const&           function_prolog     = {},
-        std::vector<std::string> const&  function_epilog     = {},
-        bool                             emitted             = false
+        parameter_declaration_list_node const& n,
+        bool                                   is_returns                 = false,
+        bool                                   is_template_parameter      = false,
+        bool                                   generating_postfix_inc_dec = false
     )
         -> void
     {   STACKINSTR
-        assert(n.expr);
-        auto generating_return = false;
+        in_parameter_list = true;
 
-        if (function_body_start != source_position{}) {
-            emit_prolog_mem_inits(function_prolog, n.position().colno);
-            printer.print_cpp2(" { ", function_body_start);
-            emit_prolog_statements(function_prolog, n.position().colno);
-            if (!function_void_ret) {
-                printer.print_cpp2("return ", n.position());
-                generating_return = true;
-            }
+        if (is_returns) {
+            printer.print_extra( "{ " );
+        }
+        else {
+            assert(n.open_paren);
+            emit(*n.open_paren);
         }
 
-        if (!emitted) {
-            //  When generating 'return' of a single expression-list, we can
-            //  take over direct control of emitting it without needing to
-            //  go through the whole grammar, and surround it with braces
+        //  So we don't get cute about text-aligning the first parameter when it's on a new line
+        printer.disable_indent_heuristic_for_next_text();
+
+        auto prev_pos = n.position();
+        auto first    = true;
+        for (auto const& x : n.parameters) {
             if (
-                generating_return
-                && n.expr->is_expression_list()
-                && !n.expr->get_expression_list()->is_fold_expression()
+                !first
+                && !is_returns
                 )
             {
-                auto is_deduced_return =
-                    !function_returns.empty()
-                    && function_returns.back().is_deduced;
-
-                if (!is_deduced_return) {
-                    printer.print_cpp2( "{ ", n.position() );
-                }
-                emit(*n.expr->get_expression_list(), false);
-                if (!is_deduced_return) {
-                    printer.print_cpp2( " }", n.position() );
-                }
+                printer.print_cpp2( ", ", prev_pos );
             }
-            //  Otherwise, just emit the general expression as usual
-            else {
-                emit(*n.expr);
+            prev_pos = x->position();
+            assert(x);
+            emit(*x, is_returns, is_template_parameter);
+            if (!x->declaration->has_name("this")) {
+                first = false;
             }
-            if (can_have_semicolon) {
-                printer.print_cpp2(";", n.position());
+            if (is_returns) {
+                printer.print_extra( "; " );
             }
         }
 
-        if (function_body_start != source_position{}) {
-            emit_epilog_statements( function_epilog, n.position().colno);
-            printer.print_cpp2(" }", n.position());
+        if (is_returns) {
+            printer.print_extra( "};\n" );
         }
-    }
-
-
-    // Consider moving these `stack` functions to `common.h` to enable more general use.
-
-    template<typename T>
-    auto stack_value(
-        T& var,
-        std::type_identity_t<T> const& value
-    )
-        -> auto
-    {
-        return finally([&var, old = std::exchange(var, value)]() {
-            var = old;
-        });
-    }
+        else {
+            //  If we're generating Cpp1 postfix ++ or --, add the dummy int parameter
+            if (generating_postfix_inc_dec) {
+                if (!first) {
+                    printer.print_cpp2( ",", n.position() );
+                }
+                printer.print_cpp2( "int", n.position() );
+            }
 
-    template<typename T>
-    auto stack_element(
-        std::vector<T>& cont,
-        std::type_identity_t<T> const& value
-    )
-        -> auto
-    {
-        cont.push_back(value);
-        return finally([&]{ cont.pop_back(); });
-    }
+            //  Position heuristic (aka hack): Avoid emitting extra whitespace before )
+            //  beyond column 10
+            assert(n.close_paren);
+            auto col = std::min( n.close_paren->position().colno, colno_t{10});
+            printer.preempt_position_push({ n.close_paren->position().lineno, col});
+            emit(*n.close_paren);
+            printer.preempt_position_pop();
+        }
 
-    template<typename T>
-    auto stack_size(std::vector<T>& cont)
-        -> auto
-    {
-        return finally([&, size = cont.size()]{ cont.resize(size); });
+        in_parameter_list = false;
     }
 
-    template<typename T>
-    auto stack_size_if(
-        std::vector<T>& cont,
-        bool cond
-    )
-        -> std::optional<decltype(stack_size(cont))>
-    {
-        if (cond) {
-            return stack_size(cont);
-        }
-        return {};
-    }
 
     //-----------------------------------------------------------------------
     //
     auto emit(
-        statement_node const&           n,
-        bool                            can_have_semicolon  = true,
-        source_position                 function_body_start = {},
-        bool                            function_void_ret   = false,
-        function_prolog const&          function_prolog     = {},
-        std::vector<std::string> const& function_epilog     = {}
+        // note: parameter is deliberately not const because we will fill
+        //       in the capture .str information
+        contract_node& n
     )
         -> void
     {   STACKINSTR
-        if (!sema.check(n)) {
-            return;
-        }
-
-        auto emit_parameters =
-            !n.emitted
-            && n.parameters
-            ;
+        assert (n.kind);
 
-        auto guard = stack_size_if(current_names, emit_parameters);
-        if (emit_parameters) {
-            printer.print_extra( "\n");
-            printer.print_extra( "{");
-            for (auto& param : n.parameters->parameters) {
-                printer.print_extra( "\n");
-                printer.print_extra( print_to_string(*param, false, false, true) );
+        //  If this is one of Cpp2's predefined contract groups,
+        //  make it convenient to use without cpp2:: qualification
+        auto name = std::string{"cpp2::cpp2_default"};
+        if (n.group)
+        {
+            auto group = print_to_string(*n.group);
+            if (group != "_") {
+                name = group;
+            }
+            if (
+                name == "cpp2_default"
+                || name == "bounds_safety"
+                || name == "null_safety"
+                || name == "type_safety"
+                || name == "testing"
+                )
+            {
+                name.insert(0, "cpp2::");
             }
         }
 
-        //  Do expression statement case first... it's the most complex
-        //  because it's used for single-statement function bodies
-        try_emit<statement_node::expression >(
-            n.statement,
-            can_have_semicolon,
-            function_body_start,
-            function_void_ret,
-            function_prolog,
-            function_epilog,
-            n.emitted
-        );
-
-        //  Otherwise, skip this one if it was already handled earlier (i.e., a constructor member init)
-        if (n.emitted) {
+        //  "Unevaluated" is for static analysis only, and are never evaluated, so just skip them
+        //  (The only requirement for an Unevaluated condition is that it parses; and even that's
+        //  easy to relax if we ever want to allow arbitrary tokens in an Unevaluated condition)
+        if (n.group && n.group->to_string() == "unevaluated") {
+            record_check("contract", n.condition->position(), "unevaluated");
             return;
         }
+        record_check("contract", n.condition->position());
 
-        printer.disable_indent_heuristic_for_next_text();
-
-        try_emit<statement_node::compound   >(n.statement, function_prolog, function_epilog);
-
-        //  NOTE: Reset preemption here because
-        //  - for compound statements written as "= { ... }", we want to keep the
-        //    preempted position which moves the { to where the = was
-        //  - but for other statement types, we want to get rid of any leftover
-        //    preemption (ideally there wouldn't be any, but sometimes there is
-        //    and it should not apply to what we're about to emit)
-        printer.preempt_position_push({});
-        //  This only has a whitespace effect in the generated Cpp1 code, but it's
-        //  aesthetic and aesthetics are important in this case -- we want to keep
-        //  the original source's personal whitespace formatting style as much as we can
-
-        try_emit<statement_node::selection  >(n.statement);
-        try_emit<statement_node::declaration>(n.statement);
-        try_emit<statement_node::return_    >(n.statement);
-        try_emit<statement_node::iteration  >(n.statement);
-        try_emit<statement_node::using_     >(n.statement);
-        try_emit<statement_node::contract   >(n.statement);
-        try_emit<statement_node::inspect    >(n.statement, false);
-        try_emit<statement_node::jump       >(n.statement);
-
-        printer.preempt_position_pop();
-
-        if (emit_parameters) {
-            printer.print_extra( "\n");
-            printer.print_extra( "}");
+        //  For a postcondition, we'll wrap it in a lambda and register it
+        //
+        if (*n.kind == "post") {
+            auto lambda_intro = build_capture_lambda_intro_for(n.captures, n.position(), true);
+            printer.print_cpp2(
+                n.position(),
+                "cpp2_finally_presuccess.add(", lambda_intro, "{"
+            );
         }
-    }
 
+        //  Emit the contract group name, and report any violation to that group
+        //
+        assert(n.condition);
+        auto message = std::string{"\"\""};
+        if (n.message) {
+            message = "CPP2_CONTRACT_MSG(";
+            message += print_to_string(*n.message);
+            message += ')';
+        }
+        if (uses_source_sites()) {
+            message += ", cpp2::impl::source_site_at<cpp2::impl::file_sites>(";
+            message += source_site_id(n.condition->position());
+            message += ')';
+        }
 
-    //-----------------------------------------------------------------------
-    //  Within a type scope implementation, disallow declaring a name that
-    //  is the same as (i.e., shadows) a type scope name... this is a
-    //  convenient place to check because we have the decls stack
-    //
-    auto check_shadowing_of_type_scope_names(
-        declaration_node const& decl
-    )
-        -> bool
-    {
-        if (
-            decl.has_name()                 // this is a named declaration
-            && !decl.has_name("this")       // that's not 'this'
-            && !decl.parent_is_type()       // and the type isn't the direct parent
-            && is_name_declared_in_current_type_scope(*decl.name())
-            )                               // and it shadows a name
-        {
-            errors.emplace_back(
-                decl.position(),
-                "a type's implementation may not declare a name that is the same as (i.e., shadows) a type scope name - for example, a type scope function's local variable may not have the same as one of the type's members"
+        auto separator = std::string_view{""};
+        printer.print_cpp2(
+            "if (",
+            n.position()
+        );
+        for (auto const& flag : n.flags) {
+            printer.print_cpp2(
+                n.position(),
+                separator, print_to_string(*flag)
             );
-            return false;
+            separator = " && ";
         }
+        printer.print_cpp2(
+            n.position(),
+            separator, name, ".is_active()"
+        );
+        printer.print_cpp2(
+            n.position(),
+            " && !(", print_to_string(*n.condition), ") ) ",
+                "{ ", name, ".report_violation(", message, "); }"
+        );
 
-        return true;
+        //  For a postcondition, close out the lambda
+        //
+        if (*n.kind == "post") {
+            printer.print_cpp2( "} );", n.position()
+            );
+        }
     }
 
 
     //-----------------------------------------------------------------------
     //
     auto emit(
-        parameter_declaration_node const& n,
-        bool                              is_returns            = false,
-        bool                              is_template_parameter = false,
-        bool                              is_statement          = false
+        function_type_node const& n,
+        bool                      is_main                    = false,
+        bool                      is_ctor_or_dtor            = false,
+        std::string               suffix1                    = {},
+        bool                      generating_postfix_inc_dec = false
     )
         -> void
     {   STACKINSTR
-        if (!sema.check(n)) {
+        if (!sema.check(n, errors)) {
             return;
         }
 
-        //  Can't declare functions as parameters -- only pointers to functions which are objects
-        assert( n.declaration );
-        assert( !n.declaration->is_function() );
-
-        if (!check_shadowing_of_type_scope_names(*n.declaration)) {
-            return;
+        if (
+            is_main
+            && n.parameters->parameters.size() > 0
+            )
+        {
+            printer.print_cpp2(
+                "(int const argc_, char** argv_)",
+                n.parameters->position()
+            );
+            current_functions.back().prolog.statements.push_back(
+                "auto const args = cpp2::make_args(argc_, argv_); "
+            );
+        }
+        else {
+            emit(*n.parameters, false, false, generating_postfix_inc_dec);
         }
 
-        assert( n.declaration->identifier );
-        auto identifier     = print_to_string( *n.declaration->identifier );
-        auto identifier_pos = n.position();
-
-        if (n.mod == parameter_declaration_node::modifier::implicit)
+        //  For an anonymous function, the emitted lambda is 'constexpr' or 'mutable'
+        if (!n.my_decl->has_name())
         {
-            assert(!current_functions.empty());
-            if (
-                n.pass != passing_style::out
-                || !current_functions.back().decl->has_name("operator=")
-                )
-            {
-                errors.emplace_back(
-                    n.position(),
-                    "only an 'out this' parameter of an 'operator=' function may be declared implicit"
-                );
+            if (n.my_decl->is_constexpr) {
+                //  The current design path we're trying out is for all '==' functions to be
+                //  emitted as Cpp1 'constexpr', including anonymous functions. For anonymous
+                //  functions that have captures, the intent is that '==' implies "the result
+                //  always the same (depends only on the arguments)." Specifically, the result
+                //  doesn't depend on the captured state, so the captured state should be const.
+                //  But until we want to take a dependency on post-C++20 constexpr relaxation
+                //  to make more code work with 'constexpr' even when not invoked in constexpr
+                //  contexts, we will emit it as const/whitespace instead for now.
+                //
+                //  printer.print_cpp2( " constexpr", n.position() );
+                //      // consider enabling when P2242, P2280, and similar papers are widely implemented
+            }
+            else {
+                printer.print_cpp2( " mutable", n.position() );
             }
         }
 
-        current_names.push_back(&*n.declaration);
-
-        //-----------------------------------------------------------------------
-        //  Skip 'this' parameters
-
-        if (n.declaration->has_name("this"))
+        //  For now, adding implicit noexcept only for move/swap/dtor functions
+        if (
+            n.is_move()
+            || n.is_swap()
+            || n.is_destructor()
+            || generating_move_from == n.my_decl
+            )
         {
-            //  Since we're skipping "out this," plus possibly "implicit " and
-            //  whitespace, any following parameters on the same line can shift left
-            printer.add_pad_in_this_line(-18);
-
-            return;
+            printer.print_cpp2( " noexcept", n.position() );
         }
 
-        //-----------------------------------------------------------------------
-        //  Handle 'that' parameters
+        printer.print_cpp2( suffix1, n.position() );
 
-        if (n.declaration->has_name("that"))
+        //  Handle a special member function
+        if (
+            n.is_assignment()
+            || generating_assignment_from == n.my_decl
+            )
         {
-            emitting_that_function = true;
             assert(
-                n.pass == passing_style::in
-                || n.pass == passing_style::move
+                n.returns.index() == function_type_node::empty
+                && n.my_decl->parent_declaration->name()
             );
-            auto pass = std::string{" const&"};
-            if (
-                n.pass == passing_style::move
-                || emitting_move_that_function
-                )
-            {
-                pass = "&&";
-            }
-
-            auto func_name = get_enclosing_function_name();
-            assert(func_name);
-
-            auto type_name = get_enclosing_type_name();
-            assert(type_name);
-
-            //  If we're in an empty type that has no member object, mark 'that' as
-            //  [[maybe_unused]] to silence Cpp1 compiler warnings
-            assert(!current_functions.empty());
-            auto maybe_unused = std::string{};
-            if (current_functions.back().decl->get_parent()->get_type_scope_declarations(declaration_node::objects).empty()) {
-                maybe_unused = "[[maybe_unused]] ";
-            }
-
             printer.print_cpp2(
-                maybe_unused + print_to_string( *type_name ) + pass + " that",
+                " -> " + print_to_string( *n.my_decl->parent_declaration->name() ) + "& ",
                 n.position()
             );
-            return;
         }
 
-        //-----------------------------------------------------------------------
-        //  Handle type parameters
-
-        // Common template naming
-        auto emit_template_name = [&]() {
-            if (n.declaration->is_variadic) {
-                printer.print_cpp2(
-                    "...",
-                    identifier_pos
-                );
+        //  Otherwise, handle a default return type
+        else if (n.returns.index() == function_type_node::empty)
+        {
+            if (is_main)
+            {
+                printer.print_cpp2( " -> int", n.position() );
+            }
+            else if(!is_ctor_or_dtor)
+            {
+                printer.print_cpp2( " -> void", n.position() );
             }
+        }
 
-            if (identifier == "_") {
-                printer.print_cpp2( unnamed_type_param_name(n.ordinal, n.declaration->identifier->get_token()),
-                                    identifier_pos );
+        //  Otherwise, handle a single anonymous return type
+        else if (n.returns.index() == function_type_node::id)
+        {
+            auto is_type_scope_function_with_in_this =
+                n.my_decl->parent_is_type()
+                && n.parameters->ssize() > 0
+                && (*n.parameters)[0]->direction() == passing_style::in
+                ;
+
+            printer.print_cpp2( " -> ", n.position() );
+            auto& r = std::get<function_type_node::id>(n.returns);
+            assert(r.type);
+
+            auto return_type = print_to_string(*r.type);
+
+            if (r.pass == passing_style::forward) {
+                if (r.type->is_wildcard()) {
+                    printer.print_cpp2( "auto&&", n.position() );
+                }
+                else {
+                    printer.print_cpp2( return_type, n.position() );
+                    if (is_type_scope_function_with_in_this) {
+                        printer.print_cpp2( " const&", n.position() );
+                    }
+                    else if (!generating_postfix_inc_dec) {
+                        printer.print_cpp2( "&", n.position() );
+                    }
+                }
             }
             else {
-                printer.print_cpp2( identifier, identifier_pos );
+                printer.print_cpp2( return_type, n.position() );
             }
-        };
-        if (n.declaration->is_type()) {
-            assert( is_template_parameter );
-            printer.print_cpp2("typename ", identifier_pos);
+        }
 
-            emit_template_name();
-            return;
+        //  Otherwise, handle multiple/named returns
+        else {
+            printer.print_cpp2( " -> ", n.position() );
+            assert (n.my_decl);
+            printer.print_cpp2( multi_return_type_name(*n.my_decl), n.position());
         }
+    }
 
-        //-----------------------------------------------------------------------
-        //  Else handle template non-type parameters
 
-        assert( n.declaration->is_object() );
-        auto const& type_id = *std::get<declaration_node::an_object>(n.declaration->type);
+    //-----------------------------------------------------------------------
+    //
+    auto is_name_declared_in_current_type_scope(std::string_view s)
+        -> bool
+    {
+        if (!s.empty())
+        {
+            //  Navigate to the enclosing type, if there is one...
+            for (auto parent = current_declarations.rbegin();
+                parent != current_declarations.rend();
+                ++parent
+                )
+            {
+                if (
+                    *parent
+                    && (*parent)->is_namespace()
+                    )
+                {
+                    break;
+                }
+                //  ... and here it is, so...
+                if (
+                    *parent
+                    && (*parent)->is_type()
+                        )
+                        {
+                            //  ... for each of its type scope decls...
+                            for (auto const& decl : (*parent)->get_type_scope_declarations())
+                            {
+                                //  ... check the name
+                                if (decl->has_name(s))
+                                {
+                                    return true;
+                                }
+                            }
+                            break;
+                }
+            }
+        }
+        return false;
+    }
 
-        if (is_template_parameter) {
-            emit( type_id );
-            printer.print_cpp2(" ", type_id.position());
 
-            emit_template_name();
-            return;
+    //-----------------------------------------------------------------------
+    //  Forward declarations
+    //
+    //  Phase 1 forward-declares every function so that Cpp2 code doesn't
+    //  depend on declaration order. A namespace-scope function whose name
+    //  is used only in the bodies of namespace-scope functions at or after
+    //  its own definition (which phase 2 emits in source order) doesn't
+    //  need that, and is declared only by its definition.
+    //
+    //  This is conservative: any other use of the name, including by a
+    //  type, an overload, a Cpp1 or generated line, or a string that could
+    //  be an interpolation, keeps the forward declaration
+    //
+    auto find_functions_declared_by_definition() const
+        -> std::unordered_set<declaration_node const*>
+    {
+        auto ret = std::unordered_set<declaration_node const*>{};
+
+        //  Only for a .cpp2, whose functions aren't part of a header's
+        //  interface, and only if it has no Cpp1 code or macros
+        if (!sourcefile.ends_with(".cpp2")) {
+            return ret;
+        }
+        for (auto const& line : source.get_lines()) {
+            if (
+                line.cat == source_line::category::cpp1
+                || line.cat == source_line::category::import
+                || (
+                    line.cat == source_line::category::preprocessor
+                    && line.text.find("include") == std::string::npos
+                    )
+                )
+            {
+                return ret;
+            }
         }
 
-        //-----------------------------------------------------------------------
-        //  Else handle ordinary parameters
+        //  The namespace-scope declarations in source order, each of which
+        //  extends to the next one
+        struct entry {
+            declaration_node const* decl;
+            source_position         start;
+            source_position         body;   // or {} if not a function definition
+        };
+        auto entries = std::vector<entry>{};
 
-        auto param_type = print_to_string(type_id);
+        auto add_entries = [&](auto& self, declaration_node const* decl) -> void {
+            assert(decl);
+            auto body = source_position{};
+            if (
+                decl->is_function()
+                && decl->initializer
+                )
+            {
+                body = decl->initializer->position();
+            }
+            entries.push_back({ decl, decl->position(), body });
 
-        //  If there are template parameters on this function or its enclosing
-        //  type, see if this parameter's name is an unqualified-id with a
-        //  template parameter name, or mentions a template parameter as a
-        //  template argument
-        auto has_template_parameter_type_named = [](
-            declaration_node const& decl,
-            std::string_view        name
-            )
-            -> bool
-        {
-            if (decl.template_parameters) {
-                for (auto& tparam : decl.template_parameters->parameters)
-                {
-                    assert(
-                        tparam
-                        && tparam->name()
-                    );
-                    //  For now just do a quick string match
-                    auto tparam_name = tparam->name()->to_string();
-                    if (
-                        tparam->declaration->is_type()
-                        && (
-                            name == tparam_name
-                            || name.find("<"+tparam_name) != std::string_view::npos
-                            || name.find(","+tparam_name) != std::string_view::npos
-                        )
-                        )
-                    {
-                        return true;
+            if (
+                decl->is_namespace()
+                && decl->initializer
+                )
+            {
+                if (auto compound = decl->initializer->get_if<compound_statement_node>()) {
+                    for (auto& stmt : compound->statements) {
+                        if (auto d = stmt->get_if<declaration_node>()) {
+                            self(self, d);
+                        }
                     }
                 }
             }
-            return false;
         };
+        for (auto const& [line, toks] : tokens.get_map()) {
+            for (auto decl : parser.get_parse_tree_declarations_in_range(toks)) {
+                add_entries(add_entries, decl);
+            }
+        }
 
-        assert( current_declarations.back() );
-        auto is_dependent_parameter_type =
-            has_template_parameter_type_named( *current_declarations.back(), param_type )
-            || (
-                current_declarations.back()->parent_is_type()
-                && current_declarations.back()->has_name("operator=")
-                && has_template_parameter_type_named( *current_declarations.back()->get_parent(), param_type)
-                )
-            ;
+        //  The entry whose extent contains pos
+        auto entry_at = [&](source_position pos) -> std::ptrdiff_t {
+            auto i = std::ranges::upper_bound(entries, pos, {}, &entry::start);
+            return std::distance(entries.begin(), i) - 1;
+        };
 
-        //  First any prefix
+        //  Names that Cpp1 or cpp2util.h can call without spelling them
+        auto called_implicitly = [](std::string_view name) {
+            for (auto implicit : {
+                "begin", "end", "cbegin", "cend", "rbegin", "rend", "size", "ssize",
+                "data", "empty", "get", "swap", "to_string"
+            })
+            {
+                if (name == implicit) {
+                    return true;
+                }
+            }
+            return name.starts_with("operator");
+        };
 
-        if (identifier == "_") {
-            printer.print_cpp2( "[[maybe_unused]] ", identifier_pos );
-            identifier = "unnamed_param_" + std::to_string(n.ordinal);
+        //  Each token that could use each name
+        auto uses = std::unordered_map<std::string_view, std::vector<token const*>>{};
+        auto strings = std::vector<token const*>{};
+        for (auto const& [line, toks] : tokens.get_map()) {
+            for (auto const& t : toks) {
+                if (t.type() == lexeme::Identifier) {
+                    uses[t].push_back(&t);
+                }
+                else if (t.type() == lexeme::StringLiteral) {
+                    strings.push_back(&t);
+                }
+            }
         }
-
-        if (
-            !is_returns
-            && !n.declaration->is_variadic
-            && !type_id.is_wildcard()
-            && !is_dependent_parameter_type
-            && !type_id.is_pointer_qualified()
-            )
-        {
-            switch (n.pass) {
-            break;case passing_style::in     : printer.print_cpp2( "cpp2::impl::in<",  n.position() );
-            break;case passing_style::out    : printer.print_cpp2( "cpp2::impl::out<", n.position() );
-            break;default: ;
+        auto generated_names = std::unordered_set<std::string>{};
+        for (auto const& lexer : parser.get_generated_lexers()) {
+            for (auto const& [line, toks] : lexer.get_map()) {
+                for (auto const& t : toks) {
+                    generated_names.insert(t.to_string());
+                }
             }
         }
 
-        printer.preempt_position_push( n.position() );
-
-        if (
-            type_id.is_pointer_qualified()
-            && n.pass == passing_style::in
-            )
-        {
-            printer.print_cpp2( param_type, n.position() );
-        }
-        else if (
-            type_id.is_wildcard()
-            || is_dependent_parameter_type
-            || n.declaration->is_variadic
-            )
+        for (auto i = std::ptrdiff_t{0}; i < std::ssize(entries); ++i)
         {
-            auto name = std::string{"auto"};
-            if (is_dependent_parameter_type) {
-                name = param_type;
-            }
-            else if (
-                n.declaration->is_variadic
-                && !type_id.is_wildcard()
+            auto decl = entries[i].decl;
+            if (
+                !decl->is_function()
+                || !decl->initializer
+                || !decl->name()
+                || called_implicitly(decl->name()->as_string_view())
+                || generated_names.contains(decl->name()->to_string())
                 )
             {
-                auto name = n.declaration->identifier->get_token();
-                assert(name);
-                auto req = std::string{"(std::is_convertible_v<CPP2_TYPEOF("};
-                req += *name;
-                req += "), ";
-                req += param_type;
-                req += "> && ...)";
-                function_requires_conditions.push_back(req);
+                continue;
             }
+            auto name = decl->name()->as_string_view();
 
-            switch (n.pass) {
-            break;case passing_style::in     : printer.print_cpp2( name+" const&", n.position() );
-            break;case passing_style::copy   : printer.print_cpp2( name,           n.position() );
-            break;case passing_style::inout  : printer.print_cpp2( name+"&",       n.position() );
-
-            //  For generic out parameters, we take a pointer to anything with paramater named "identifier_"
-            //  and then generate the out<> as a stack local with the expected name "identifier"
-            break;case passing_style::out    : printer.print_cpp2( name,           n.position() );
-                                               current_functions.back().prolog.statements.push_back(
-                                                   "auto " + identifier + " = cpp2::impl::out(" + identifier + "_); "
-                                               );
-                                               identifier += "_";
+            auto used_only_after_definition = [&](token const* t) {
+                if (t->position() == decl->name()->position()) {
+                    return true;
+                }
+                auto user = entry_at(t->position());
+                return
+                    user >= i
+                    && entries[user].body != source_position{}
+                    && entries[user].body <= t->position()
+                    ;
+            };
 
-            break;case passing_style::move   : printer.print_cpp2( name+"&&",      n.position() );
-            break;case passing_style::forward: printer.print_cpp2( name+"&&",      n.position() );
-            break;default: ;
+            if (
+                std::ranges::all_of(uses[name], used_only_after_definition)
+                && std::ranges::all_of(strings, [&](token const* t) {
+                    return
+                        t->as_string_view().find(name) == std::string_view::npos
+                        || used_only_after_definition(t);
+                })
+                )
+            {
+                ret.insert(decl);
             }
         }
-        else if (n.pass == passing_style::forward) {
-            printer.print_cpp2("auto", n.position());
 
-            auto name = n.declaration->identifier->get_token();
-            assert(name);
-            auto req = std::string{"std::is_same_v<"};
-            req += param_type;
-            req += ", CPP2_TYPEOF(";
-            req += *name;
-            req += ")>";
-            function_requires_conditions.push_back(req);
+        return ret;
+    }
+
+
+    //-----------------------------------------------------------------------
+    //  Whole-program inferences (-whole-program)
+    //
+    //  Knowing all of the program's source files, a .cpp2's namespace-scope
+    //  functions and types that no other file names can have internal
+    //  linkage, and a type that overrides virtual functions without adding
+    //  any can be 'final' if no file derives from it. Both let the Cpp1
+    //  compiler inline and devirtualize more.
+    //
+    //  Returns false if the manifest or a file it lists can't be read
+    //
+    auto find_whole_program_inferences()
+        -> bool
+    {
+        if (options.whole_program.empty()) {
+            return true;
         }
-        else {
-            if (is_returns) {
-                printer.print_extra( param_type );
-            }
-            else {
-                printer.print_cpp2( param_type, type_id.position() );
-            }
+        auto index = whole_program_index::get(options.whole_program);
+        if (!index) {
+            return false;
         }
 
-        printer.preempt_position_pop();
-
-        //  Then any suffix
+        //  Only for a file that's part of the program
+        auto self = index->find(sourcefile);
+        if (self < 0) {
+            return true;
+        }
 
-        if (
-            !is_returns
-            && !type_id.is_wildcard()
-            && !is_dependent_parameter_type
-            && !type_id.is_pointer_qualified()
-            && !n.declaration->is_variadic
-            )
-        {
-            switch (n.pass) {
-            break;case passing_style::in     : printer.print_cpp2( ">",  n.position() );
-            break;case passing_style::copy   : printer.print_cpp2( "",   n.position() );
-            break;case passing_style::inout  : printer.print_cpp2( "&",  n.position() );
-            break;case passing_style::out    : printer.print_cpp2( ">",  n.position() );
-            break;case passing_style::move   : printer.print_cpp2( "&&", n.position() );
-            break;case passing_style::forward: printer.print_cpp2( "&&", n.position() );
-            break;default: ;
+        //  Names this file's Cpp1 code could declare or use
+        auto cpp1_text = std::string{};
+        for (auto const& line : source.get_lines()) {
+            if (
+                line.cat == source_line::category::cpp1
+                || line.cat == source_line::category::preprocessor
+                || line.cat == source_line::category::import
+                )
+            {
+                cpp1_text += line.text;
+                cpp1_text += '\n';
             }
         }
 
-        if (is_returns) {
-            printer.print_extra( " " + identifier );
-        }
-        else {
-            printer.print_cpp2( " ", identifier_pos );
-            if (n.declaration->is_variadic)
+        //  Only a .cpp2's declarations, because a header's are in many TUs
+        auto may_be_internal = [&](declaration_node const& decl) {
+            if (
+                !sourcefile.ends_with(".cpp2")
+                || !decl.name()
+                )
             {
-                if (n.direction() == passing_style::out) {
-                    errors.emplace_back(
-                        n.declaration->position(),
-                        "a variadic parameter cannot be 'out'"
-                    );
-                    return;
-                }
+                return false;
+            }
+            auto name = decl.name()->to_string();
+            return
+                name != "main"
+                && !name.starts_with("operator")
+                && cpp1_text.find(name) == std::string::npos
+                && !index->is_used_outside(self, name)
+                ;
+        };
 
-                printer.print_cpp2(
-                    "...",
-                    identifier_pos
-                );
+        auto may_be_final = [&](declaration_node const& decl) {
+            if (
+                decl.is_type_final()
+                || !decl.name()
+                || index->may_be_a_base(decl.name()->to_string())
+                )
+            {
+                return false;
             }
-            printer.print_cpp2( identifier, identifier_pos );
-        }
+            auto overrides = false;
+            for (auto member : decl.get_type_scope_declarations(declaration_node::functions)) {
+                if (member->is_virtual_function()) {
+                    return false;
+                }
+                auto& func = std::get<declaration_node::a_function>(member->type);
+                if (
+                    func->is_function_with_this()
+                    && (*func->parameters)[0]->is_override()
+                    )
+                {
+                    overrides = true;
+                }
+            }
+            return overrides;
+        };
 
-        if (
-            !is_returns
-            && n.declaration->initializer
-            )
-        {
-            auto guard = stack_element(current_declarations, &*n.declaration);
-            if (is_statement) {
-                printer.print_cpp2( "{", n.declaration->initializer->position() );
+        auto visit = [&](auto& self_, declaration_node const& decl, bool at_namespace_scope) -> void {
+            if (
+                at_namespace_scope
+                && (
+                    decl.is_type()
+                    || (decl.is_function() && decl.initializer)
+                    )
+                && may_be_internal(decl)
+                )
+            {
+                internal_linkage.insert(&decl);
             }
-            else {
-                printer.print_cpp2( " = ", n.declaration->initializer->position() );
+            if (
+                decl.is_type()
+                && may_be_final(decl)
+                )
+            {
+                inferred_final.insert(&decl);
             }
-            emit(*n.declaration->initializer, !is_statement);
-            if (is_statement) {
-                printer.print_cpp2( "};", n.declaration->initializer->position() );
+
+            if (
+                (decl.is_namespace() || decl.is_type())
+                && decl.initializer
+                )
+            {
+                if (auto compound = decl.initializer->get_if<compound_statement_node>()) {
+                    for (auto& stmt : compound->statements) {
+                        if (auto d = stmt->get_if<declaration_node>()) {
+                            self_(self_, *d, decl.is_namespace());
+                        }
+                    }
+                }
+            }
+        };
+        for (auto const& [line, toks] : tokens.get_map()) {
+            for (auto decl : parser.get_parse_tree_declarations_in_range(toks)) {
+                visit(visit, *decl, true);
             }
         }
-    }
 
+        return true;
+    }
 
     //-----------------------------------------------------------------------
+    //  Purity inference (-mark-purity)
     //
-    auto emit(
-        parameter_declaration_list_node const& n,
-        bool                                   is_returns                 = false,
-        bool                                   is_template_parameter      = false,
-        bool                                   generating_postfix_inc_dec = false
-    )
+    //  Classifies each function defined at namespace or type scope by its
+    //  body (see purity_finder), then lowers each to the least pure of the
+    //  functions it can call until nothing changes, so that recursion works
+    //  out. Only for a file with no Cpp1 code or preprocessor lines, which
+    //  could declare other overloads or macros with the same names
+    //
+    auto find_function_purity()
         -> void
-    {   STACKINSTR
-        in_parameter_list = true;
-
-        if (is_returns) {
-            printer.print_extra( "{ " );
+    {
+        if (!options.infer_purity) {
+            return;
         }
-        else {
-            assert(n.open_paren);
-            emit(*n.open_paren);
+
+        auto file_reason = std::string{};
+        for (auto const& line : source.get_lines()) {
+            if (
+                line.cat == source_line::category::cpp1
+                || line.cat == source_line::category::import
+                || line.cat == source_line::category::preprocessor
+                )
+            {
+                file_reason = "the file has Cpp1 code, which could declare the same names";
+                break;
+            }
         }
 
-        //  So we don't get cute about text-aligning the first parameter when it's on a new line
-        printer.disable_indent_heuristic_for_next_text();
+        struct entry {
+            declaration_node const* decl;
+            purity_finder::result   result;
+        };
+        auto entries         = std::vector<entry>{};
+        auto entry_for       = std::unordered_map<declaration_node const*, std::size_t>{};
+        auto namespace_names = purity_finder::names_map{};
 
-        auto prev_pos = n.position();
-        auto first    = true;
-        for (auto const& x : n.parameters) {
+        auto visit = [&](auto& self, declaration_node const& decl, bool at_namespace_scope) -> void {
             if (
-                !first
-                && !is_returns
+                at_namespace_scope
+                && decl.name()
                 )
             {
-                printer.print_cpp2( ", ", prev_pos );
+                namespace_names.emplace(decl.name()->as_string_view(), &decl);
             }
-            prev_pos = x->position();
-            assert(x);
-            emit(*x, is_returns, is_template_parameter);
-            if (!x->declaration->has_name("this")) {
-                first = false;
+            if (
+                decl.is_function()
+                && decl.initializer
+                && decl.name()
+                )
+            {
+                entry_for.emplace(&decl, entries.size());
+                entries.push_back({ &decl, {} });
             }
-            if (is_returns) {
-                printer.print_extra( "; " );
+
+            if (
+                (decl.is_namespace() || decl.is_type())
+                && decl.initializer
+                )
+            {
+                if (auto compound = decl.initializer->get_if<compound_statement_node>()) {
+                    for (auto& stmt : compound->statements) {
+                        if (auto d = stmt->get_if<declaration_node>()) {
+                            self(self, *d, decl.is_namespace());
+                        }
+                    }
+                }
+            }
+        };
+        for (auto const& [line, toks] : tokens.get_map()) {
+            for (auto decl : parser.get_parse_tree_declarations_in_range(toks)) {
+                visit(visit, *decl, true);
             }
         }
 
-        if (is_returns) {
-            printer.print_extra( "};\n" );
+        //  Each body by itself
+        for (auto& e : entries)
+        {
+            auto& r = e.result;
+            if (!file_reason.empty()) {
+                r = { function_purity::none, file_reason };
+            }
+            else if (auto why = purity_finder::why_not_a_candidate(*e.decl); !why.empty()) {
+                r = { function_purity::none, why };
+            }
+            else {
+                auto finder = purity_finder{ *e.decl, namespace_names, r };
+                e.decl->initializer->visit(finder, 0);
+            }
         }
-        else {
-            //  If we're generating Cpp1 postfix ++ or --, add the dummy int parameter
-            if (generating_postfix_inc_dec) {
-                if (!first) {
-                    printer.print_cpp2( ",", n.position() );
+
+        //  Then with the functions each one calls
+        for (auto changed = true; changed; )
+        {
+            changed = false;
+            for (auto& e : entries)
+            {
+                for (auto callee : e.result.callees)
+                {
+                    auto purity = function_purity::none;
+                    auto why    = std::string{};
+                    auto name   = callee->name()->to_string();
+                    if (auto i = entry_for.find(callee); i != entry_for.end()) {
+                        purity = entries[i->second].result.purity;
+                        why    = "it calls '" + name + "', which is " + (purity == function_purity::pure ? "pure" : "neither const nor pure");
+                    }
+                    else {
+                        why = "it calls '" + name + "', which isn't defined in this file";
+                    }
+                    if (purity < e.result.purity) {
+                        e.result.purity = purity;
+                        e.result.reason = why;
+                        changed = true;
+                    }
                 }
-                printer.print_cpp2( "int", n.position() );
             }
-
-            //  Position heuristic (aka hack): Avoid emitting extra whitespace before )
-            //  beyond column 10
-            assert(n.close_paren);
-            auto col = std::min( n.close_paren->position().colno, colno_t{10});
-            printer.preempt_position_push({ n.close_paren->position().lineno, col});
-            emit(*n.close_paren);
-            printer.preempt_position_pop();
         }
 
-        in_parameter_list = false;
+        for (auto const& e : entries)
+        {
+            auto msg = "'" + e.decl->name()->to_string() + "' is ";
+            switch (e.result.purity) {
+            break;case function_purity::const_:
+                msg += "const";
+            break;case function_purity::pure:
+                msg += "pure, not const: " + e.result.reason;
+            break;case function_purity::none:
+                msg += "neither const nor pure: " + e.result.reason;
+            }
+            purity_notes.push_back({ e.decl->position(), std::move(msg) });
+
+            if (e.result.purity != function_purity::none) {
+                inferred_purity.emplace(e.decl, e.result.purity);
+            }
+        }
     }
 
 
+
     //-----------------------------------------------------------------------
+    //  Standard headers for -include-std and -import-std
     //
-    auto emit(
-        // note: parameter is deliberately not const because we will fill
-        //       in the capture .str information
-        contract_node& n
-    )
-        -> void
-    {   STACKINSTR
-        assert (n.kind);
-
-        //  If this is one of Cpp2's predefined contract groups,
-        //  make it convenient to use without cpp2:: qualification
-        auto name = std::string{"cpp2::cpp2_default"};
-        if (n.group)
-        {
-            auto group = print_to_string(*n.group);
-            if (group != "_") {
-                name = group;
-            }
+    //  The headers of the std:: names this file's Cpp2 code (including code
+    //  generated by metafunctions) uses, excluding those cpp2util.h always
+    //  includes, in std_headers() order. Returns nullopt if the file needs
+    //  all the headers, because it has Cpp1 code or a std:: name that isn't
+    //  in std_headers()
+    //
+    //  skip_out_of_line_types  leave out the names used only in nested types
+    //                          that are defined out of line
+    //
+    auto used_std_headers(bool skip_out_of_line_types = false) const
+        -> std::optional<std::vector<std_header const*>>
+    {
+        for (auto const& line : source.get_lines()) {
             if (
-                name == "cpp2_default"
-                || name == "bounds_safety"
-                || name == "null_safety"
-                || name == "type_safety"
-                || name == "testing"
+                line.cat == source_line::category::cpp1
+                || line.cat == source_line::category::import
                 )
             {
-                name.insert(0, "cpp2::");
+                return {};
             }
         }
 
-        //  "Unevaluated" is for static analysis only, and are never evaluated, so just skip them
-        //  (The only requirement for an Unevaluated condition is that it parses; and even that's
-        //  easy to relax if we ever want to allow arbitrary tokens in an Unevaluated condition)
-        if (n.group && n.group->to_string() == "unevaluated") {
-            return;
-        }
-
-        //  For a postcondition, we'll wrap it in a lambda and register it
-        //
-        if (*n.kind == "post") {
-            auto lambda_intro = build_capture_lambda_intro_for(n.captures, n.position(), true);
-            printer.print_cpp2(
-                "cpp2_finally_presuccess.add(" +
-                    lambda_intro + "{",
-                n.position()
-            );
+        auto skip = std::unordered_set<token const*>{};
+        if (skip_out_of_line_types) {
+            auto finder = out_of_line_token_finder{skip};
+            parser.visit(finder);
         }
 
-        //  Emit the contract group name, and report any violation to that group
-        //
-        assert(n.condition);
-        auto message = std::string{"\"\""};
-        if (n.message) {
-            message = "CPP2_CONTRACT_MSG(" + print_to_string(*n.message) + ")";
-        }
+        auto ret = std::vector<std_header const*>{};
+        auto add_names_in = [&](std::vector<token> const& toks)
+            -> bool
+        {
+            for (auto i = 0; i < std::ssize(toks); ++i)
+            {
+                if (skip.contains(&toks[i])) {
+                    continue;
+                }
 
-        auto separator = std::string{""};
-        printer.print_cpp2(
-            "if (",
-            n.position()
-        );
-        for (auto const& flag : n.flags) {
-            printer.print_cpp2(
-                separator + print_to_string(*flag),
-                n.position()
-            );
-            separator = " && ";
-        }
-        printer.print_cpp2(
-            separator + name + ".is_active()",
-            n.position()
-        );
-        printer.print_cpp2(
-            " && !(" + print_to_string(*n.condition) + ") ) " +
-                "{ " + name + ".report_violation(" + message + "); }",
-            n.position()
-        );
+                auto next_is = [&](int n, lexeme type) {
+                    return i+n < std::ssize(toks) && toks[i+n].type() == type;
+                };
 
-        //  For a postcondition, close out the lambda
-        //
-        if (*n.kind == "post") {
-            printer.print_cpp2( "} );", n.position()
-            );
-        }
-    }
+                //  A using-directive or using-declaration (or a namespace
+                //  alias) for std or a std sub-namespace makes std names
+                //  usable unqualified, so we can't tell which are used
+                if (
+                    toks[i] == "using"
+                    || (toks[i] == "namespace" && next_is(1, lexeme::EqualComparison))
+                    )
+                {
+                    auto j = i + 1;
+                    while (
+                        j < std::ssize(toks)
+                        && (
+                            toks[j] == "namespace"
+                            || toks[j].type() == lexeme::EqualComparison
+                            || toks[j].type() == lexeme::Scope
+                            )
+                        )
+                    {
+                        ++j;
+                    }
+                    if (j < std::ssize(toks) && toks[j] == "std") {
+                        return false;
+                    }
+                }
 
+                //  An unqualified call, which UFCS or ADL may resolve to a
+                //  standard function (or a C function in the global namespace)
+                if (
+                    toks[i].type() == lexeme::Identifier
+                    && next_is(1, lexeme::LeftParen)
+                    && (i == 0 || toks[i-1].type() != lexeme::Scope)
+                    )
+                {
+                    if (auto h = std_header_for(toks[i])) {
+                        ret.push_back(h);
+                    }
+                    continue;
+                }
 
-    //-----------------------------------------------------------------------
-    //
-    auto emit(
-        function_type_node const& n,
-        bool                      is_main                    = false,
-        bool                      is_ctor_or_dtor            = false,
-        std::string               suffix1                    = {},
-        bool                      generating_postfix_inc_dec = false
-    )
-        -> void
-    {   STACKINSTR
-        if (!sema.check(n)) {
-            return;
-        }
+                if (
+                    toks[i] != "std"
+                    || !next_is(1, lexeme::Scope)
+                    || (i > 0 && toks[i-1].type() == lexeme::Dot)
+                    )
+                {
+                    continue;
+                }
 
-        if (
-            is_main
-            && n.parameters->parameters.size() > 0
-            )
-        {
-            printer.print_cpp2(
-                "(int const argc_, char** argv_)",
-                n.parameters->position()
-            );
-            current_functions.back().prolog.statements.push_back(
-                "auto const args = cpp2::make_args(argc_, argv_); "
-            );
-        }
-        else {
-            emit(*n.parameters, false, false, generating_postfix_inc_dec);
-        }
+                auto h = std_header_for(i+2 < std::ssize(toks) ? toks[i+2] : std::string_view{});
+                if (
+                    !next_is(2, lexeme::Identifier)
+                    || !h
+                    )
+                {
+                    return false;
+                }
+                ret.push_back(h);
 
-        //  For an anonymous function, the emitted lambda is 'constexpr' or 'mutable'
-        if (!n.my_decl->has_name())
-        {
-            if (n.my_decl->is_constexpr) {
-                //  The current design path we're trying out is for all '==' functions to be
-                //  emitted as Cpp1 'constexpr', including anonymous functions. For anonymous
-                //  functions that have captures, the intent is that '==' implies "the result
-                //  always the same (depends only on the arguments)." Specifically, the result
-                //  doesn't depend on the captured state, so the captured state should be const.
-                //  But until we want to take a dependency on post-C++20 constexpr relaxation
-                //  to make more code work with 'constexpr' even when not invoked in constexpr
-                //  contexts, we will emit it as const/whitespace instead for now.
-                //
-                //  printer.print_cpp2( " constexpr", n.position() );
-                //      // consider enabling when P2242, P2280, and similar papers are widely implemented
-            }
-            else {
-                printer.print_cpp2( " mutable", n.position() );
+                //  E.g., std::ranges::iota also needs <numeric>
+                if (
+                    toks[i+2] == "ranges"
+                    && next_is(3, lexeme::Scope)
+                    && next_is(4, lexeme::Identifier)
+                    )
+                {
+                    if (auto h2 = std_header_for(toks[i+4])) {
+                        ret.push_back(h2);
+                    }
+                }
             }
-        }
+            return true;
+        };
 
-        //  For now, adding implicit noexcept only for move/swap/dtor functions
-        if (
-            n.is_move()
-            || n.is_swap()
-            || n.is_destructor()
-            || generating_move_from == n.my_decl
-            )
-        {
-            printer.print_cpp2( " noexcept", n.position() );
+        for (auto const& [line, toks] : tokens.get_map()) {
+            if (!add_names_in(toks)) {
+                return {};
+            }
+        }
+        for (auto const& lexer : parser.get_generated_lexers()) {
+            for (auto const& [line, toks] : lexer.get_map()) {
+                if (!add_names_in(toks)) {
+                    return {};
+                }
+            }
         }
 
-        printer.print_cpp2( suffix1, n.position() );
+        std::erase_if(ret, [](auto h) { return h->in_cpp2util; });
+        std::ranges::sort(ret);
+        auto [first, last] = std::ranges::unique(ret);
+        ret.erase(first, last);
+        return ret;
+    }
 
-        //  Handle a special member function
+
+    //-----------------------------------------------------------------------
+    //  Source sites for -source-sites (see CPP2_USE_SOURCE_SITES in cpp2util.h)
+    //
+    //  Only for a .cpp2, because the table is emitted at the end of its .cpp;
+    //  the checks in a .h2 report no site
+    //
+    auto uses_source_sites() const
+        -> bool
+    {
+        return
+            options.use_source_sites
+            && sourcefile.ends_with(".cpp2")
+            ;
+    }
+
+    //  Record a check site at pos and return its ID as text. The ID is the
+    //  position's line and column packed together, so that it's the same no
+    //  matter which order (or thread) the checks are lowered in; 0 means
+    //  "no site", e.g. for generated code
+    //
+    auto source_site_id(source_position pos)
+        -> std::string
+    {
         if (
-            n.is_assignment()
-            || generating_assignment_from == n.my_decl
+            pos.lineno < 1
+            || pos.lineno >= (1 << 20)
             )
         {
-            assert(
-                n.returns.index() == function_type_node::empty
-                && n.my_decl->parent_declaration->name()
-            );
-            printer.print_cpp2(
-                " -> " + print_to_string( *n.my_decl->parent_declaration->name() ) + "& ",
-                n.position()
-            );
-        }
-
-        //  Otherwise, handle a default return type
-        else if (n.returns.index() == function_type_node::empty)
-        {
-            if (is_main)
-            {
-                printer.print_cpp2( " -> int", n.position() );
-            }
-            else if(!is_ctor_or_dtor)
-            {
-                printer.print_cpp2( " -> void", n.position() );
-            }
+            return "0";
         }
 
-        //  Otherwise, handle a single anonymous return type
-        else if (n.returns.index() == function_type_node::id)
-        {
-            auto is_type_scope_function_with_in_this =
-                n.my_decl->parent_is_type()
-                && n.parameters->ssize() > 0
-                && (*n.parameters)[0]->direction() == passing_style::in
-                ;
-
-            printer.print_cpp2( " -> ", n.position() );
-            auto& r = std::get<function_type_node::id>(n.returns);
-            assert(r.type);
+        auto id =
+            unsafe_narrow<std::uint32_t>(pos.lineno) << 12
+            | unsafe_narrow<std::uint32_t>(std::clamp(pos.colno, 1, (1 << 12) - 1));
 
-            auto return_type = print_to_string(*r.type);
+        source_sites.push_back({ id, pos, current_function_name() });
+        return std::to_string(id);
+    }
 
-            if (r.pass == passing_style::forward) {
-                if (r.type->is_wildcard()) {
-                    printer.print_cpp2( "auto&&", n.position() );
-                }
-                else {
-                    printer.print_cpp2( return_type, n.position() );
-                    if (is_type_scope_function_with_in_this) {
-                        printer.print_cpp2( " const&", n.position() );
-                    }
-                    else if (!generating_postfix_inc_dec) {
-                        printer.print_cpp2( "&", n.position() );
-                    }
+    //  The innermost named function, qualified by its named parents
+    //
+    auto current_function_name() const
+        -> std::string
+    {
+        auto function = std::string{};
+        auto decl     = std::find_if(
+            current_declarations.rbegin(),
+            current_declarations.rend(),
+            [](auto d) { return d && d->is_function() && d->has_name(); }
+        );
+        if (decl != current_declarations.rend()) {
+            for (auto d = *decl; d; d = d->get_parent()) {
+                if (d->has_name()) {
+                    function.insert(0, d->name()->to_string() + (function.empty() ? "" : "::"));
                 }
             }
-            else {
-                printer.print_cpp2( return_type, n.position() );
-            }
         }
+        return function;
+    }
 
-        //  Otherwise, handle multiple/named returns
+    //  Emit the table of the sites, sorted by ID for source_site_at's lookup
+    //
+    auto emit_source_site_table()
+        -> void
+    {
+        std::ranges::sort(source_sites, {}, &source_site::id);
+        auto [first, last] = std::ranges::unique(source_sites, {}, &source_site::id);
+        source_sites.erase(first, last);
+
+        auto file = std::ostringstream{};
+        file << std::quoted(printer.get_cpp2_filename());
+
+        if (!options.clean_cpp1) {
+            printer.print_extra( "\n//=== Cpp2 source sites =========================================================\n" );
+        }
+        printer.print_extra( "\nnamespace cpp2::impl { namespace {\n" );
+        if (source_sites.empty()) {
+            printer.print_extra( "auto file_sites::table() -> std::span<source_site const> { return {}; }\n" );
+        }
         else {
-            printer.print_cpp2( " -> ", n.position() );
-            assert (n.my_decl);
-            printer.print_cpp2( multi_return_type_name(*n.my_decl), n.position());
+            printer.print_extra( "constexpr source_site source_sites[] = {\n" );
+            for (auto const& site : source_sites) {
+                printer.print_extra(
+                    "    { " + std::to_string(site.id)
+                    + ", " + file.str()
+                    + ", " + std::to_string(site.pos.lineno)
+                    + ", " + std::to_string(site.pos.colno)
+                    + ", \"" + site.function + "\" },\n"
+                );
+            }
+            printer.print_extra( "};\n" );
+            printer.print_extra( "auto file_sites::table() -> std::span<source_site const> { return source_sites; }\n" );
         }
+        printer.print_extra( "} }\n" );
     }
 
 
     //-----------------------------------------------------------------------
+    //  Check census for -safety-report (see print_safety_report)
     //
-    auto is_name_declared_in_current_type_scope(std::string_view s)
-        -> bool
+    //  kind        subscript, null, as, comparison, contract, or ufcs
+    //  elided_by   the flag that disabled the check, or empty if emitted
+    //
+    //  Checks in generated code without a source position aren't recorded
+    //
+    auto record_check(
+        std::string_view kind,
+        source_position  pos,
+        std::string_view elided_by = {}
+    )
+        -> void
     {
-        if (!s.empty())
+        if (
+            options.report_checks
+            && pos.lineno > 0
+            )
         {
-            //  Navigate to the enclosing type, if there is one...
-            for (auto parent = current_declarations.rbegin();
-                parent != current_declarations.rend();
-                ++parent
-                )
-            {
-                if (
-                    *parent
-                    && (*parent)->is_namespace()
-                    )
-                {
-                    break;
-                }
-                //  ... and here it is, so...
-                if (
-                    *parent
-                    && (*parent)->is_type()
-                        )
-                        {
-                            //  ... for each of its type scope decls...
-                            for (auto const& decl : (*parent)->get_type_scope_declarations())
-                            {
-                                //  ... check the name
-                                if (decl->has_name(s))
-                                {
-                                    return true;
-                                }
-                            }
-                            break;
-                }
-            }
+            checks.push_back({ kind, pos, current_function_name(), elided_by });
         }
-        return false;
     }
 
 
@@ -5024,7 +8050,7 @@ public:
                         list += separator;
                         if ("_" == tparam->name()->to_string()) {
                             list += unnamed_type_param_name(tparam->ordinal,
-                                                            tparam->declaration->identifier->get_token());
+                                                            position_label(tparam->declaration->identifier->get_token()));
                         }
                         else {
                             list += tparam->name()->to_string();
@@ -5044,6 +8070,37 @@ public:
         return ret;
     }
 
+
+    //-----------------------------------------------------------------------
+    //  Helper to emit the class definition of a nested type that is defined
+    //  out of line (see declaration_node::type_define_out_of_line), and then
+    //  its function definitions, in phase 2 where its enclosing type's
+    //  function definitions go, e.g., so that a .h2 file's @pimpl
+    //  implementation goes only in the .hpp
+    //
+    auto emit_out_of_line_type_definition(
+        declaration_node const& n
+    )
+        -> void
+    {
+        assert(
+            n.is_type_defined_out_of_line()
+            && printer.get_phase() == printer.phase2_func_defs
+        );
+
+        auto guard0 = stack_value(defining_out_of_line, &n);
+        auto guard1 = stack_value(out_of_line_qualification, type_qualification_if_any_for(n));
+
+        //  Lower it to a string, so that it doesn't consume the comments
+        //  that go with the function definitions that come after it
+        auto phase      = printer.lower_as_phase(printer.phase1_type_defs_func_decls);
+        auto definition = print_to_string(n);
+        printer.lower_as_phase(phase);
+
+        printer.print_extra( "\n" + definition );
+        emit(n);
+    }
+
     //-----------------------------------------------------------------------
     //  Constructors and assignment operators
     //
@@ -5397,7 +8454,7 @@ public:
             assert (!current_functions.empty());
             current_functions.back().epilog.push_back( "return *this;");
             printer.print_cpp2( prefix, n.position() );
-            printer.print_cpp2( "auto " + type_qualification_if_any_for(n) + print_to_string( *n.name() ), n.position());
+            printer.print_cpp2( n.position(), "auto ", type_qualification_if_any_for(n), print_to_string( *n.name() ));
             emit( *func );
         }
     }
@@ -5483,7 +8540,7 @@ public:
         //  but we only want to do the sema checks once
         if (
             printer.get_phase() == printer.phase2_func_defs
-            && !sema.check(n)
+            && !sema.check(n, errors)
             )
         {
             return;
@@ -5766,6 +8823,16 @@ public:
             }
         }
 
+        //  A function that isn't used before its definition is declared only there
+        if (
+            printer.get_phase() == printer.phase1_type_defs_func_decls
+            && declared_by_definition.contains(&n)
+            )
+        {
+            printer.defer_comments_before(n.position());
+            return;
+        }
+
         //  If this is a class definition that has data members before bases,
         //  first we need to emit the aggregate that contains the members
         if (
@@ -5817,7 +8884,10 @@ public:
 
         //  In class definitions, emit the explicit access specifier if there
         //  is one, or default to private for data and public for functions
-        if (printer.get_phase() == printer.phase1_type_defs_func_decls)
+        if (
+            printer.get_phase() == printer.phase1_type_defs_func_decls
+            && &n != defining_out_of_line
+            )
         {
             if (!n.is_default_access()) {
                 assert (is_in_type);
@@ -5857,6 +8927,17 @@ public:
             emit_parent_template_parameters();
         }
 
+        //  A type with internal linkage (see find_whole_program_inferences)
+        //  goes in an unnamed namespace, which starts before its template parameters
+        if (
+            n.is_type()
+            && printer.get_phase() < printer.phase2_func_defs
+            && internal_linkage.contains(&n)
+            )
+        {
+            printer.print_cpp2("namespace { ", n.position());
+        }
+
         //  Now, emit our own template parameters
         if (
             n.template_parameters
@@ -5899,17 +8980,34 @@ public:
                 }
 
                 printer.print_cpp2("class ", n.position());
+                if (&n == defining_out_of_line) {
+                    printer.print_cpp2(out_of_line_qualification, n.position());
+                }
                 emit(*n.identifier);
 
                 //  Type declaration
                 if (printer.get_phase() == printer.phase0_type_decls) {
-                    printer.print_cpp2( ";\n", n.position() );
+                    printer.print_cpp2( internal_linkage.contains(&n) ? "; }\n" : ";\n", n.position() );
+                    return;
+                }
+
+                //  A nested type that is defined out of line is only declared
+                //  inside its enclosing type (see emit_out_of_line_type_definition)
+                if (
+                    n.is_type_defined_out_of_line()
+                    && &n != defining_out_of_line
+                    )
+                {
+                    printer.print_cpp2(";\n", n.position());
                     return;
                 }
             }
 
             if (
-                n.is_type_final()
+                (
+                    n.is_type_final()
+                    || inferred_final.contains(&n)
+                    )
                 && printer.get_phase() == printer.phase1_type_defs_func_decls
                 )
             {
@@ -5934,6 +9032,22 @@ public:
                 }
             };
 
+            //  Define the nested types that are defined out of line first, along
+            //  with their functions, so they are complete in all of ours
+            if (printer.get_phase() == printer.phase2_func_defs)
+            {
+                for (auto& stmt : compound_stmt->statements) {
+                    auto decl = stmt->get_if<declaration_node>();
+                    if (
+                        decl
+                        && decl->is_type_defined_out_of_line()
+                        )
+                    {
+                        emit_out_of_line_type_definition(*decl);
+                    }
+                }
+            }
+
             for (auto& stmt : compound_stmt->statements)
             {
                 assert(stmt);
@@ -5997,7 +9111,7 @@ public:
                 {
                     //  Do the sema check for these declarations here, because we're
                     //  handling them here instead of going through emit() for them
-                    if (!sema.check(*decl)) {
+                    if (!sema.check(*decl, errors)) {
                         return;
                     }
 
@@ -6028,7 +9142,10 @@ public:
                     current_names.push_back(decl.get());
                 }
                 //  Then we'll switch to start the body == other members
-                else
+                else if (
+                    printer.get_phase() != printer.phase2_func_defs
+                    || !decl->is_type_defined_out_of_line()
+                    )
                 {
                     if (printer.get_phase() == printer.phase1_type_defs_func_decls) {
                         start_body();
@@ -6072,7 +9189,7 @@ public:
                     }
                 }
 
-                printer.print_cpp2("};\n", compound_stmt->close_brace);
+                printer.print_cpp2(internal_linkage.contains(&n) ? "}; }\n" : "};\n", compound_stmt->close_brace);
             }
         }
 
@@ -6194,6 +9311,10 @@ public:
                 std::string suffix1 = {};
                 std::string suffix2 = {};
 
+                if (internal_linkage.contains(&n)) {
+                    prefix += "static ";
+                }
+
                 if (n.is_constexpr) {
                     prefix += "constexpr ";
                 }
@@ -6284,6 +9405,19 @@ public:
                     }
                 }
 
+                //  -mark-purity's attributes go first, on every declaration
+                //  (see find_function_purity)
+                if (
+                    auto purity = inferred_purity.find(&n);
+                    purity != inferred_purity.end()
+                    )
+                {
+                    printer.print_cpp2(
+                        purity->second == function_purity::const_ ? "CPP2_CONST_FUNCTION " : "CPP2_PURE_FUNCTION ",
+                        n.position()
+                    );
+                }
+
                 //  If there's a return type, it's [[nodiscard]] implicitly and all the time
                 //  -- for now there's no opt-out, wait and see whether we actually need one
                 if (
@@ -6757,7 +9891,7 @@ public:
                     if (current_functions.empty()) {
                         //  Generate a globally unique label for non-function-locals,
                         //  so the declarations and definitions match
-                        return labelized_position( n.identifier->get_token() );
+                        return position_label( n.identifier->get_token() );
                     }
                     //  Else just use a per-function ordinal
                     return std::to_string( ++current_functions.back().ordinal );
@@ -6807,10 +9941,45 @@ public:
     }
 
 
+    //-----------------------------------------------------------------------
+    //  take_output_files
+    //
+    //  For an in-memory translation, the lowered Cpp1 files: the .cpp, or
+    //  for a .h2 the .h and then the .hpp
+    //
+    struct output_file {
+        std::string filename;
+        std::string text;
+    };
+    auto take_output_files()
+        -> std::vector<output_file>
+    {
+        assert(
+            in_memory
+            && "ICE: take_output_files is only for an in-memory translation"
+        );
+        auto ret = std::vector<output_file>{};
+        if (
+            !errors.empty()
+            || !printer.is_open()
+            )
+        {
+            return ret;
+        }
+
+        auto cpp1_filename = sourcefile.substr(0, std::ssize(sourcefile) - 1);
+        for (auto&& text : printer.take_memory_files()) {
+            ret.push_back({ cpp1_filename, std::move(text) });
+            cpp1_filename += "pp";
+        }
+        return ret;
+    }
+
+
     //-----------------------------------------------------------------------
     //  print_errors
     //
-    auto print_errors()
+    auto print_errors(std::ostream& o = std::cerr)
         -> void
     {
         if (!errors.empty()) {
@@ -6839,28 +10008,101 @@ public:
                 || error != *prev
                 )
             {
-                error.print(std::cerr, strip_path(sourcefile));
+                error.print(o, strip_path(sourcefile));
             }
             prev = &error;
         }
 
-        if (violates_lifetime_safety) {
-            std::cerr << "  ==> program violates lifetime safety guarantee - see previous errors\n";
+        if (
+            violates_lifetime_safety
+            || parser.violates_lifetime_safety()
+            )
+        {
+            o << "  ==> program violates lifetime safety guarantee - see previous errors\n";
         }
         if (violates_bounds_safety) {
-            std::cerr << "  ==> program violates bounds safety guarantee - see previous errors\n";
+            o << "  ==> program violates bounds safety guarantee - see previous errors\n";
         }
         if (violates_initialization_safety) {
-            std::cerr << "  ==> program violates initialization safety guarantee - see previous errors\n";
+            o << "  ==> program violates initialization safety guarantee - see previous errors\n";
+        }
+    }
+
+    //-----------------------------------------------------------------------
+    //  print_purity_report: for -report-purity, what -mark-purity concluded
+    //  about each function, and why
+    //
+    auto print_purity_report(std::ostream& o = std::cout) const
+        -> void
+    {
+        for (auto const& note : purity_notes) {
+            o << strip_path(sourcefile);
+            if (note.pos.lineno > 0) {     // else generated by a metafunction
+                o << "(" << note.pos.lineno << "," << note.pos.colno << ")";
+            }
+            o << ": note: " << note.msg << "\n";
         }
     }
 
+    //-----------------------------------------------------------------------
+    //  print_safety_report: for -safety-report, this file's entry in the
+    //  JSON census of the safety checks emitted and elided in each function
+    //
+    //  A check whose code was lowered more than once is counted once
+    //
+    auto print_safety_report(std::ostream& o) const
+        -> void
+    {
+        auto sorted = checks;
+        auto key    = [](check_record const& c) { return std::tuple{c.pos.lineno, c.pos.colno, c.kind}; };
+        std::ranges::sort(sorted, {}, key);
+        auto [first, last] = std::ranges::unique(sorted, {}, key);
+        sorted.erase(first, last);
+
+        o << "    {\n"
+          << "      \"file\": " << std::quoted(sourcefile) << ",\n"
+          << "      \"totals\": {";
+        auto separator = "\n";
+        for (auto kind : { "subscript", "null", "as", "comparison", "contract", "ufcs" })
+        {
+            auto emitted = std::ranges::count_if(sorted, [&](auto const& c) { return c.kind == kind &&  c.elided_by.empty(); });
+            auto elided  = std::ranges::count_if(sorted, [&](auto const& c) { return c.kind == kind && !c.elided_by.empty(); });
+            o << separator << "        \"" << kind << "\": { \"emitted\": " << emitted << ", \"elided\": " << elided << " }";
+            separator = ",\n";
+        }
+        o << "\n      },\n"
+          << "      \"checks\": [";
+        separator = "\n";
+        for (auto const& c : sorted)
+        {
+            o << separator
+              << "        { \"function\": " << std::quoted(c.function)
+              << ", \"line\": " << c.pos.lineno
+              << ", \"column\": " << c.pos.colno
+              << ", \"kind\": \"" << c.kind << "\""
+              << ", \"emitted\": " << (c.elided_by.empty() ? "true" : "false");
+            if (!c.elided_by.empty()) {
+                o << ", \"elided_by\": \"" << c.elided_by << "\"";
+            }
+            o << " }";
+            separator = ",\n";
+        }
+        o << (sorted.empty() ? "]\n" : "\n      ]\n")
+          << "    }";
+    }
+
     auto had_no_errors()
         -> bool
     {
         return errors.empty();
     }
 
+    auto get_errors() const
+        -> std::vector<error_entry> const&
+    {
+        return errors;
+    }
+
 
     //-----------------------------------------------------------------------
     //  debug_print
@@ -6907,6 +10149,53 @@ public:
     }
 };
 
+
+//-----------------------------------------------------------------------
+//
+//  translate: Translate a source file in memory
+//
+//-----------------------------------------------------------------------
+//
+//  This is the entry point for using cppfront as a library. It doesn't
+//  touch the file system or any shared state (except to read the files
+//  in options.whole_program, if set), so different sources can be
+//  translated concurrently on different threads.
+//
+//  filename    the name of the source (must end with .cpp2 or .h2), used
+//              to name the outputs and in #line directives
+//  text        the source text
+//  options     the options to use (options.cpp1_filename is ignored)
+//
+struct translation_result
+{
+    std::vector<error_entry>           errors      = {};    // empty if successful
+    std::string                        diagnostics = {};    // errors as the command line prints them
+    std::vector<cppfront::output_file> files       = {};    // the lowered Cpp1 files
+};
+
+auto translate(
+    std::string const&         filename,
+    std::string_view           text,
+    translation_options const& options = {}
+)
+    -> translation_result
+{
+    auto c = cppfront(filename, text, options);
+    c.lower_to_cpp1();
+
+    auto ret = translation_result{};
+    if (c.had_no_errors()) {
+        ret.files = c.take_output_files();
+    }
+    else {
+        auto diagnostics = std::ostringstream{};
+        c.print_errors(diagnostics);
+        ret.diagnostics = diagnostics.str();
+    }
+    ret.errors = c.get_errors();
+    return ret;
+}
+
 }
 
 